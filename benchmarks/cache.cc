@@ -0,0 +1,74 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#include "cache.h"
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "cc/kernel.h"
+
+// CacheModel::Set::find in a cache of 'n' ways; the cache is filled
+// and half of all lookups hit.
+static void BM_CacheSetFind(benchmark::State& state) {
+  cc::CacheModelConfig cfg;
+  cfg.sets_n = 256;
+  cfg.ways_n = state.range(0);
+  cfg.line_bytes_n = 64;
+  cc::CacheModel<std::uint64_t> cache(cfg);
+  const cc::CacheAddressHelper& ah = cache.ah();
+
+  // Fill every way of every set.
+  const std::size_t lines_n = cfg.lines();
+  for (std::size_t i = 0; i < lines_n; i++) {
+    const cc::addr_t addr = i * cfg.line_bytes_n;
+    cc::CacheModel<std::uint64_t>::Set set = cache.set(ah.set(addr));
+    for (auto it = set.begin(); it != set.end(); ++it) {
+      if (!it->valid()) {
+        set.install(it, ah.tag(addr), i);
+        break;
+      }
+    }
+  }
+
+  // Lookup addresses; resident and non-resident lines alternate.
+  cc::kernel::RandomSource rnd;
+  std::vector<cc::addr_t> addrs(4096);
+  for (std::size_t i = 0; i < addrs.size(); i++) {
+    const std::size_t line = rnd.uniform<std::size_t>(0, lines_n - 1);
+    addrs[i] = (line + ((i & 1) ? lines_n : 0)) * cfg.line_bytes_n;
+  }
+
+  std::size_t i = 0;
+  for (auto _ : state) {
+    const cc::addr_t addr = addrs[i++ & (addrs.size() - 1)];
+    cc::CacheModel<std::uint64_t>::Set set = cache.set(ah.set(addr));
+    benchmark::DoNotOptimize(set.find(ah.tag(addr)));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CacheSetFind)->RangeMultiplier(2)->Range(1, 32);
@@ -0,0 +1,103 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#include "cc/kernel.h"
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+namespace {
+
+// Action which is retained after evaluation such that it may be
+// rescheduled without allocation.
+struct NopAction : cc::kernel::Action {
+  explicit NopAction(cc::kernel::Kernel* k) : Action(k, "nop") {}
+  bool eval() override { return false; }
+};
+
+// Process which re-awaits 'e' upon each notification.
+struct AwaitProcess : cc::kernel::Process {
+  AwaitProcess(cc::kernel::Kernel* k, const std::string& name,
+               cc::kernel::Event* e)
+      : Process(k, name), e_(e) {}
+  void init() override { wait_on(e_); }
+  void eval() override { wait_on(e_); }
+  cc::kernel::Event* e_ = nullptr;
+};
+
+}  // namespace
+
+// Kernel::add_action/invoke_run; schedule 'n' actions at distinct
+// times and run to exhaustion, such that the event queue reaches a
+// depth of 'n'.
+static void BM_KernelRun(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  cc::kernel::Kernel k;
+  cc::kernel::TopModule top(&k, "top");
+  std::vector<NopAction*> as;
+  for (std::size_t i = 0; i < n; i++) as.push_back(new NopAction(&k));
+
+  const cc::kernel::ActionAdder aa(&k);
+  const cc::kernel::SimPhaseRunner runner(&k);
+  cc::kernel::RandomSource& rnd = k.random_source();
+  for (auto _ : state) {
+    const cc::kernel::Time::time_type now = k.time().time;
+    for (NopAction* a : as) {
+      const cc::kernel::Time::time_type dt = rnd.uniform<std::uint64_t>(1, n);
+      aa.add_action(cc::kernel::Time{now + dt, 0}, a);
+    }
+    runner.run();
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+  for (NopAction* a : as) delete a;
+}
+BENCHMARK(BM_KernelRun)->RangeMultiplier(8)->Range(8, 1 << 18);
+
+// Event::notify; wake 'n' processes awaiting a single event.
+static void BM_EventNotify(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  cc::kernel::Kernel k;
+  cc::kernel::TopModule top(&k, "top");
+  cc::kernel::Event* e = new cc::kernel::Event(&k, "e");
+  std::vector<AwaitProcess*> ps;
+  for (std::size_t i = 0; i < n; i++) {
+    ps.push_back(new AwaitProcess(&k, "p" + std::to_string(i), e));
+    top.add_child_process(ps.back());
+  }
+
+  const cc::kernel::SimPhaseRunner runner(&k);
+  runner.init();
+  for (auto _ : state) {
+    e->notify();
+    runner.run();
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+  delete e;
+  for (AwaitProcess* p : ps) delete p;
+}
+BENCHMARK(BM_EventNotify)->RangeMultiplier(4)->Range(1, 256);
@@ -0,0 +1,137 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#include "primitives.h"
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "l1cache.h"
+#include "utility.h"
+
+namespace {
+
+// Process which drains a queue upon each transition to non-empty.
+struct DrainProcess : cc::kernel::Process {
+  DrainProcess(cc::kernel::Kernel* k, cc::Queue<int>* q)
+      : Process(k, "drain"), q_(q) {}
+  void init() override { wait_on(q_->non_empty_event()); }
+  void eval() override {
+    int i;
+    while (q_->dequeue(i)) benchmark::DoNotOptimize(i);
+    wait_on(q_->non_empty_event());
+  }
+  cc::Queue<int>* q_ = nullptr;
+};
+
+// Minimal arbiter requester.
+struct Requester {
+  bool has_req() const { return has_req_; }
+  bool blocked() const { return false; }
+  cc::kernel::Event* non_empty_event() { return nullptr; }
+  bool has_req_ = false;
+};
+
+}  // namespace
+
+// Queue<T>::enqueue/dequeue; fill a queue of capacity 'n', after which
+// a process awoken by the non-empty event drains it.
+static void BM_QueueEnqueueDequeue(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  cc::kernel::Kernel k;
+  cc::kernel::TopModule top(&k, "top");
+  cc::Queue<int>* q = new cc::Queue<int>(&k, "q", n);
+  top.add_child_module(q);
+  DrainProcess* p = new DrainProcess(&k, q);
+  top.add_child_process(p);
+
+  const cc::kernel::SimPhaseRunner runner(&k);
+  runner.init();
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < n; i++) q->enqueue(static_cast<int>(i));
+    runner.run();
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+  delete q;
+  delete p;
+}
+BENCHMARK(BM_QueueEnqueueDequeue)->RangeMultiplier(4)->Range(4, 1024);
+
+// Arbiter::tournament; 'n' requesters, each requesting with
+// probability one half.
+static void BM_ArbiterTournament(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  cc::kernel::Kernel k;
+  cc::kernel::RandomSource& rnd = k.random_source();
+  cc::Arbiter<Requester> arb(&k, "arb");
+  std::vector<Requester> rs(n);
+  for (Requester& r : rs) {
+    r.has_req_ = rnd.random_bool();
+    arb.add_requester(&r);
+  }
+  rs.front().has_req_ = true;
+
+  for (auto _ : state) {
+    const cc::Arbiter<Requester>::Tournament t = arb.tournament();
+    benchmark::DoNotOptimize(t.winner());
+    t.advance();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ArbiterTournament)->RangeMultiplier(2)->Range(2, 256);
+
+// Table::install/find/remove of 'n' entries.
+static void BM_Table(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  cc::kernel::Kernel k;
+  cc::Table<std::uint64_t, std::uint64_t> tt(&k, "tt", n);
+
+  for (auto _ : state) {
+    for (std::uint64_t i = 0; i < n; i++) tt.install(i * 64, i);
+    for (std::uint64_t i = 0; i < n; i++) {
+      benchmark::DoNotOptimize(tt.find(i * 64));
+    }
+    for (std::uint64_t i = 0; i < n; i++) tt.remove(i * 64);
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_Table)->RangeMultiplier(4)->Range(4, 1024);
+
+// Pool<T>::construct/release of a batch of 'n' messages.
+static void BM_PoolConstructRelease(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  std::vector<const cc::L1CmdMsg*> msgs(n);
+
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < n; i++) {
+      msgs[i] = cc::Pool<cc::L1CmdMsg>::construct();
+    }
+    for (const cc::L1CmdMsg* msg : msgs) msg->release();
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_PoolConstructRelease)->RangeMultiplier(8)->Range(1, 512);
@@ -0,0 +1,213 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+// End-to-end scaling harness: each configuration is elaborated and
+// run to exhaustion, and the following is reported (as JSON):
+//
+//   elab_s          - host time (s) to construct, elaborate and
+//                     initialize the model.
+//   run_s           - host time (s) to run the simulation.
+//   events_n        - simulation events (kernel actions) evaluated.
+//   accesses_n      - commands issued by the stimulus.
+//   events_per_s    - simulation events per host second.
+//   accesses_per_s  - commands issued per host second.
+//   max_rss_kb      - host memory high-water mark (KB).
+//   fatal           - simulation terminated on a fatal error; figures
+//                     are then of the partial run.
+//   stalled         - simulation ran to quiescence with transactions
+//                     yet to retire (deadlock); figures are then of
+//                     the partial run.
+//   notes           - modelling limitations recorded by the
+//                     configuration ('notes'), where present.
+//
+// Simulation log output (to stdout) is discarded for the duration of
+// each run; the report is emitted thereafter.
+//
+// Usage: scaling [--label <label>] [--out <file>] <config.json>...
+//
+// Returns non-zero where any configuration terminated on a fatal
+// error or stalled.
+
+#include "driver/builder.h"
+#include "cc/cfgs.h"
+#include "cc/soc.h"
+#include "cc/stimulus.h"
+
+#include "nlohmann/json.hpp"
+#include <sys/resource.h>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace {
+
+// Reset the process' peak resident set size such that the high-water
+// mark may be attributed to an individual configuration (Linux only;
+// otherwise the high-water mark is that of the process).
+void reset_max_rss() {
+  std::ofstream os("/proc/self/clear_refs");
+  if (os) os << "5";
+}
+
+// Peak resident set size (in KB).
+std::size_t max_rss_kb() {
+  std::ifstream is("/proc/self/status");
+  std::string line;
+  while (std::getline(is, line)) {
+    if (line.compare(0, 6, "VmHWM:") == 0) {
+      return std::stoull(line.substr(6));
+    }
+  }
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return static_cast<std::size_t>(ru.ru_maxrss);
+}
+
+double seconds_since(std::chrono::steady_clock::time_point t) {
+  const std::chrono::duration<double> d =
+      std::chrono::steady_clock::now() - t;
+  return d.count();
+}
+
+double per_second(std::uint64_t n, double s) {
+  return (s > 0.0) ? static_cast<double>(n) / s : 0.0;
+}
+
+json run_config(const std::string& fn) {
+  cc::SocConfig cfg;
+  std::ifstream is(fn);
+  if (!is) throw cc::BuilderException("Unable to open: " + fn);
+  cc::build_soc_config(is, cfg);
+
+  // Discard log output; restored upon return.
+  struct CoutSuppressor {
+    CoutSuppressor() : sb(std::cout.rdbuf(nullptr)) {}
+    ~CoutSuppressor() { std::cout.rdbuf(sb); }
+    std::streambuf* sb;
+  } suppressor;
+
+  reset_max_rss();
+  const auto elab_start = std::chrono::steady_clock::now();
+  cc::Soc* soc = cc::construct_soc(cfg);
+  soc->initialize();
+  const double elab_s = seconds_since(elab_start);
+
+  const auto run_start = std::chrono::steady_clock::now();
+  soc->run();
+  const double run_s = seconds_since(run_start);
+  soc->finalize();
+
+  std::size_t cpu_n = 0;
+  for (const cc::CpuClusterConfig& ccl : cfg.ccls) {
+    cpu_n += ccl.cpu_configs.size();
+  }
+
+  json j;
+  j["config"] = fn;
+  j["cpu_n"] = cpu_n;
+  j["cluster_n"] = cfg.ccls.size();
+  j["dir_n"] = cfg.dcfgs.size();
+  j["sim_time"] = soc->time();
+  j["elab_s"] = elab_s;
+  j["run_s"] = run_s;
+  j["events_n"] = soc->evaluated_n();
+  j["accesses_n"] = soc->stimulus()->issue_n();
+  j["events_per_s"] = per_second(soc->evaluated_n(), run_s);
+  j["accesses_per_s"] = per_second(soc->stimulus()->issue_n(), run_s);
+  j["max_rss_kb"] = max_rss_kb();
+  j["fatal"] = soc->fatal();
+  j["stalled"] =
+      soc->stimulus()->retire_n() != soc->stimulus()->issue_n();
+  // Limitations of the configuration are carried into the report
+  // such that figures are not read out of context.
+  if (std::ifstream ns(fn); ns) {
+    const json cj = json::parse(ns, nullptr, false);
+    if (!cj.is_discarded() && cj.contains("notes")) j["notes"] = cj["notes"];
+  }
+  delete soc;
+  return j;
+}
+
+}  // namespace
+
+int main(int argc, const char** argv) {
+  std::string label;
+  std::string out;
+  std::vector<std::string> fns;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--label" && (i + 1) < argc) {
+      label = argv[++i];
+    } else if (arg == "--out" && (i + 1) < argc) {
+      out = argv[++i];
+    } else {
+      fns.push_back(arg);
+    }
+  }
+  if (fns.empty()) {
+    std::cerr << "Usage: " << argv[0]
+              << " [--label <label>] [--out <file>] <config.json>...\n";
+    return 1;
+  }
+
+  int ret = 0;
+  json report;
+  report["label"] = label;
+  report["results"] = json::array();
+  for (const std::string& fn : fns) {
+    try {
+      report["results"].push_back(run_config(fn));
+      // Figures of a partial run are not comparable; fail loudly
+      // rather than leaving the error to be found in the report.
+      if (report["results"].back()["fatal"]) {
+        std::cerr << "Configuration terminated on a fatal error: " << fn
+                  << "\n";
+        ret = 1;
+      } else if (report["results"].back()["stalled"]) {
+        std::cerr << "Configuration stalled with transactions in flight: "
+                  << fn << "\n";
+        ret = 1;
+      }
+    } catch (const cc::BuilderException& ex) {
+      std::cerr << "Failed to parse configuration file: " << fn << ": "
+                << ex.what() << "\n";
+      return 1;
+    }
+  }
+
+  if (out.empty()) {
+    std::cout << report.dump(2) << "\n";
+  } else {
+    std::ofstream os(out);
+    os << report.dump(2) << "\n";
+  }
+  return ret;
+}
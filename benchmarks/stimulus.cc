@@ -0,0 +1,72 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#include "cc/stimulus.h"
+
+#include <sstream>
+
+#include "benchmark/benchmark.h"
+#include "cc/kernel.h"
+#include "cc/soc.h"
+#include "test/builder.h"
+
+// TraceStimulus parse throughput; a trace of 'n' commands is parsed
+// during the elaboration of a single CPU SoC.
+static void BM_TraceStimulusParse(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  std::stringstream ss;
+  ss << "M:0,top.cluster0.cpu0\n";
+  for (std::size_t i = 0; i < n; i++) {
+    ss << "+10\n";
+    ss << "C:0," << ((i & 1) ? "ST" : "LD") << "," << (i * 64) << "\n";
+  }
+  const std::string trace = ss.str();
+
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(1);
+  cb.set_cpu_n(1);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    cb.set_stimulus(cc::TraceStimulus::from_string(trace));
+    const cc::SocConfig cfg = cb.construct();
+    cc::kernel::Kernel* k = new cc::kernel::Kernel;
+    cc::SocTop* top = new cc::SocTop(k, cfg);
+    state.ResumeTiming();
+
+    cc::kernel::SimPhaseRunner{k}.elab();
+
+    state.PauseTiming();
+    delete k;
+    delete top;
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetBytesProcessed(state.iterations() * trace.size());
+}
+BENCHMARK(BM_TraceStimulusParse)->RangeMultiplier(8)->Range(1 << 10, 1 << 16);
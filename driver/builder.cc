@@ -95,6 +95,12 @@ class SocConfigBuilderJson {
   void build(CpuConfig& c, json j) {
     // Set .name
     CHECK_AND_SET(name);
+    // Set .closed_loop
+    CHECK_AND_SET_OPTIONAL(closed_loop);
+    // Set .mlp_n
+    CHECK_AND_SET_OPTIONAL(mlp_n);
+    // Set .think_time
+    CHECK_AND_SET_OPTIONAL(think_time);
   }
 
   void build(L1CacheAgentConfig& c, json j) {
@@ -141,6 +147,14 @@ class SocConfigBuilderJson {
     CHECK_AND_SET_OPTIONAL(cmd_queue_n);
     // Set .rsp_queue_n
     CHECK_AND_SET_OPTIONAL(rsp_queue_n);
+    // Set .bank_n
+    CHECK_AND_SET_OPTIONAL(bank_n);
+    // Set .bank_interleave (InterleaveConfig)
+    if (j.contains("bank_interleave")) {
+      build(c.bank_interleave, j["bank_interleave"]);
+    }
+    // Set .access_latency
+    CHECK_AND_SET_OPTIONAL(access_latency);
   }
 
   void build(MemModelConfig& c, json j) {
@@ -148,6 +162,60 @@ class SocConfigBuilderJson {
     CHECK_AND_SET(name);
     // Set .epoch
     CHECK_AND_SET_OPTIONAL(epoch);
+    // Set .dram (DramConfig)
+    if (j.contains("dram")) {
+      build(c.dram, j["dram"]);
+    }
+  }
+
+  void build(DramConfig& c, json j) {
+    // Set .enable
+    CHECK_AND_SET_OPTIONAL(enable);
+    // Set .channel_n, .rank_n, .bank_n
+    CHECK_AND_SET_OPTIONAL(channel_n);
+    CHECK_AND_SET_OPTIONAL(rank_n);
+    CHECK_AND_SET_OPTIONAL(bank_n);
+    // Set .row_bytes, .line_bytes
+    CHECK_AND_SET_OPTIONAL(row_bytes);
+    CHECK_AND_SET_OPTIONAL(line_bytes);
+    // Set .page_policy
+    if (j.contains("page_policy")) {
+      const std::string s = j["page_policy"];
+      if (s == "open") {
+        c.page_policy = DramPagePolicy::Open;
+      } else if (s == "closed") {
+        c.page_policy = DramPagePolicy::Closed;
+      } else {
+        throw BuilderException("Unknown DRAM page policy: " + s);
+      }
+    }
+    // Set .address_map
+    if (j.contains("address_map")) {
+      const std::string s = j["address_map"];
+      if (s == "rorabachco") {
+        c.address_map = DramAddressMap::RoRaBaChCo;
+      } else if (s == "rocorabach") {
+        c.address_map = DramAddressMap::RoCoRaBaCh;
+      } else {
+        throw BuilderException("Unknown DRAM address map: " + s);
+      }
+    }
+    // Set .bank_xor
+    CHECK_AND_SET_OPTIONAL(bank_xor);
+    // Set timings
+    CHECK_AND_SET_OPTIONAL(tRCD);
+    CHECK_AND_SET_OPTIONAL(tCL);
+    CHECK_AND_SET_OPTIONAL(tRP);
+    CHECK_AND_SET_OPTIONAL(tRAS);
+    CHECK_AND_SET_OPTIONAL(tWR);
+    CHECK_AND_SET_OPTIONAL(tRFC);
+    CHECK_AND_SET_OPTIONAL(tREFI);
+    CHECK_AND_SET_OPTIONAL(tBURST);
+    // Set queue capacities and write drain watermarks
+    CHECK_AND_SET_OPTIONAL(rdq_n);
+    CHECK_AND_SET_OPTIONAL(wrq_n);
+    CHECK_AND_SET_OPTIONAL(wr_drain_hi);
+    CHECK_AND_SET_OPTIONAL(wr_drain_lo);
   }
 
   void build(DirAgentConfig& c, json j) {
@@ -161,6 +229,23 @@ class SocConfigBuilderJson {
     CHECK_AND_SET_OPTIONAL(rsp_queue_n);
     // Set .is_null_filter
     CHECK_AND_SET_OPTIONAL(is_null_filter);
+    // Set .sharer_encoding
+    if (j.contains("sharer_encoding")) {
+      const std::string s = j["sharer_encoding"];
+      if (s == "fullmap") {
+        c.sharer_encoding = SharerEncoding::FullMap;
+      } else if (s == "limitedpointer") {
+        c.sharer_encoding = SharerEncoding::LimitedPointer;
+      } else if (s == "coarsevector") {
+        c.sharer_encoding = SharerEncoding::CoarseVector;
+      } else {
+        throw BuilderException("Unknown sharer encoding: " + s);
+      }
+    }
+    // Set .sharer_pointer_n
+    CHECK_AND_SET_OPTIONAL(sharer_pointer_n);
+    // Set .sharer_group_n
+    CHECK_AND_SET_OPTIONAL(sharer_group_n);
     // Set .cconfig
     CHECK(cconfig);
     build(c.cconfig, j["cconfig"]);
@@ -208,18 +293,116 @@ class SocConfigBuilderJson {
     }
   }
 
+  void build(SyntheticCpuConfig& c, json j) {
+    // Set .cpu
+    CHECK_AND_SET(cpu);
+    // Set .command_n
+    CHECK_AND_SET_OPTIONAL(command_n);
+    // Set .addr_dist
+    if (j.contains("addr_dist")) {
+      const std::string s = j["addr_dist"];
+      if (s == "uniform") {
+        c.addr_dist = AddrDistribution::Uniform;
+      } else if (s == "zipf") {
+        c.addr_dist = AddrDistribution::Zipf;
+      } else if (s == "strided") {
+        c.addr_dist = AddrDistribution::Strided;
+      } else if (s == "pointer_chase") {
+        c.addr_dist = AddrDistribution::PointerChase;
+      } else {
+        throw BuilderException("Unknown address distribution: " + s);
+      }
+    }
+    // Set .zipf_s
+    CHECK_AND_SET_OPTIONAL(zipf_s);
+    // Set .stride
+    CHECK_AND_SET_OPTIONAL(stride);
+    // Set .store_ratio
+    CHECK_AND_SET_OPTIONAL(store_ratio);
+    // Set .shared_fraction
+    CHECK_AND_SET_OPTIONAL(shared_fraction);
+    // Set .sharing
+    if (j.contains("sharing")) {
+      const std::string s = j["sharing"];
+      if (s == "none") {
+        c.sharing = SharingPattern::None;
+      } else if (s == "producer") {
+        c.sharing = SharingPattern::Producer;
+      } else if (s == "consumer") {
+        c.sharing = SharingPattern::Consumer;
+      } else if (s == "migratory") {
+        c.sharing = SharingPattern::Migratory;
+      } else {
+        throw BuilderException("Unknown sharing pattern: " + s);
+      }
+    }
+    // Set .arrival_dist
+    if (j.contains("arrival_dist")) {
+      const std::string s = j["arrival_dist"];
+      if (s == "fixed") {
+        c.arrival_dist = ArrivalDistribution::Fixed;
+      } else if (s == "uniform") {
+        c.arrival_dist = ArrivalDistribution::Uniform;
+      } else if (s == "exponential") {
+        c.arrival_dist = ArrivalDistribution::Exponential;
+      } else {
+        throw BuilderException("Unknown arrival distribution: " + s);
+      }
+    }
+    // Set .arrival_mean
+    CHECK_AND_SET_OPTIONAL(arrival_mean);
+  }
+
   void build(StimulusConfig& c, json j) {
     // Set .name
     CHECK_AND_SET(name);
     // Set .type
     // Type is presently an enum; convert from string.
-    //CHECK_AND_SET(type);
+    if (j.contains("type")) {
+      const std::string type = j["type"];
+      if (type == "trace") {
+        c.type = StimulusType::Trace;
+      } else if (type == "binary_trace") {
+        c.type = StimulusType::BinaryTrace;
+      } else if (type == "synthetic") {
+        c.type = StimulusType::Synthetic;
+      } else {
+        throw BuilderException("Unknown stimulus type: " + type);
+      }
+    }
     // Parse type related options
-    if (c.type == StimulusType::Trace) {
+    if (c.type == StimulusType::BinaryTrace) {
+      // Set .filename
+      CHECK_AND_SET(filename);
+    } else if (c.type == StimulusType::Synthetic) {
+      // Set .seed
+      CHECK_AND_SET_OPTIONAL(seed);
+      // Set .line_bytes
+      CHECK_AND_SET_OPTIONAL(line_bytes);
+      // Set .shared_base
+      CHECK_AND_SET_OPTIONAL(shared_base);
+      // Set .shared_bytes
+      CHECK_AND_SET_OPTIONAL(shared_bytes);
+      // Set .private_base
+      CHECK_AND_SET_OPTIONAL(private_base);
+      // Set .private_bytes
+      CHECK_AND_SET_OPTIONAL(private_bytes);
+      // Set .synthetic
+      CHECK(synthetic);
+      for (const auto& item : j["synthetic"]) {
+        SyntheticCpuConfig scc;
+        build(scc, item);
+        c.synthetic.push_back(scc);
+      }
+    } else if (c.type == StimulusType::Trace) {
       // Set .filename
       CHECK(filename);
       const std::string filename = j["filename"];
       c.is = new std::ifstream(filename);
+      // Set .streaming
+      CHECK_AND_SET_OPTIONAL(streaming);
+      // Set .lookahead_n
+      CHECK_AND_SET_OPTIONAL(lookahead_n);
     } else {
       std::string reason = "Unknown/Invalid stimulus type: ";
       reason += to_string(c.type);
@@ -227,6 +410,37 @@ class SocConfigBuilderJson {
     }
   }
   
+  void build(InterleaveConfig& c, json j) {
+    // Set .type
+    if (j.contains("type")) {
+      const std::string s = j["type"];
+      if (s == "line") {
+        c.type = InterleaveType::Line;
+      } else if (s == "page") {
+        c.type = InterleaveType::Page;
+      } else if (s == "xor") {
+        c.type = InterleaveType::Xor;
+      } else {
+        throw BuilderException("Unknown interleave type: " + s);
+      }
+    }
+    // Set .line_bytes
+    CHECK_AND_SET_OPTIONAL(line_bytes);
+    // Set .page_bytes
+    CHECK_AND_SET_OPTIONAL(page_bytes);
+  }
+
+  void build(SamplerConfig& c, json j) {
+    // Set .interval
+    CHECK_AND_SET_OPTIONAL(interval);
+    // Set .filename
+    CHECK_AND_SET_OPTIONAL(filename);
+    // Set .select
+    CHECK_AND_SET_OPTIONAL(select);
+    // Set .depth
+    CHECK_AND_SET_OPTIONAL(depth);
+  }
+
   void build(SocConfig& c, json j) {
     // Set .name
     CHECK_AND_SET(name);
@@ -234,8 +448,16 @@ class SocConfigBuilderJson {
     CHECK(protocol);
     // Set .enable_verif
     CHECK_AND_SET(enable_verif);
+    // Set .verif_async
+    CHECK_AND_SET_OPTIONAL(verif_async);
     // Set .enable_stats
     CHECK_AND_SET(enable_stats);
+    // Set .stats_json_filename
+    CHECK_AND_SET_OPTIONAL(stats_json_filename);
+    // Set .stats_csv_filename
+    CHECK_AND_SET_OPTIONAL(stats_csv_filename);
+    // Set .sampler (SamplerConfig)
+    if (j.contains("sampler")) build(c.sampler, j["sampler"]);
     // Construct protocol definition.
     const std::string protocol = jtop_["protocol"];
     pb_ = construct_protocol_builder(protocol);
@@ -273,6 +495,14 @@ class SocConfigBuilderJson {
     if (c.mcfgs.empty()) {
       throw BuilderException("No Memories configured.");
     }
+    // Set .dir_interleave (InterleaveConfig)
+    if (j.contains("dir_interleave")) {
+      build(c.dir_interleave, j["dir_interleave"]);
+    }
+    // Set .mem_interleave (InterleaveConfig)
+    if (j.contains("mem_interleave")) {
+      build(c.mem_interleave, j["mem_interleave"]);
+    }
     // Set .scfg (StimulusConfig)
     CHECK(scfg);
     build(c.scfg, j["scfg"]);
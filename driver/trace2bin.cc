@@ -0,0 +1,61 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#include <fstream>
+#include <iostream>
+
+#include "cc/stimulus.h"
+
+// Convert a text trace file to the compact binary trace format.
+//
+//  trace2bin <input text trace> <output binary trace>
+//
+int main(int argc, const char** argv) {
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " <text trace> <binary trace>\n";
+    return 1;
+  }
+
+  std::ifstream is(argv[1]);
+  if (!is) {
+    std::cerr << "Cannot open input trace: " << argv[1] << "\n";
+    return 1;
+  }
+  std::ofstream os(argv[2], std::ios::binary);
+  if (!os) {
+    std::cerr << "Cannot open output trace: " << argv[2] << "\n";
+    return 1;
+  }
+
+  try {
+    cc::convert_trace_to_binary(is, os);
+  } catch (const cc::StimulusException& ex) {
+    std::cerr << "Failed to convert trace: " << ex.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -29,6 +29,7 @@
 #define CC_INCLUDE_CC_CFGS_H
 
 #include <cstddef>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -63,6 +64,23 @@ struct CacheModelConfig {
 struct CpuConfig {
   // Instance name
   std::string name = "cpu";
+
+  // Closed-loop mode: issue is gated by retirement. Commands issue no
+  // earlier than their stimulus time, but additionally only when
+  // fewer than 'mlp_n' commands are outstanding, when all prior Loads
+  // have retired for commands marked as load-to-use dependent, and
+  // no earlier than 'think_time' after the most recent retirement.
+  // Otherwise (open-loop), commands issue at their stimulus time,
+  // subject only to back-pressure from the L1 command queue.
+  bool closed_loop = false;
+
+  // Maximum number of outstanding commands (memory-level parallelism
+  // window) in closed-loop mode.
+  std::size_t mlp_n = 4;
+
+  // Compute time between retirement and subsequent issue in
+  // closed-loop mode.
+  time_t think_time = 0;
 };
 
 //
@@ -125,6 +143,34 @@ struct NocModelConfig {
   std::map<std::string, std::map<std::string, time_t> > edges;
 };
 
+// Address interleave of home agents (directories, memory controllers
+// or LLC banks).
+enum class InterleaveType {
+  // Consecutive lines map to consecutive agents.
+  Line,
+
+  // Consecutive pages map to consecutive agents.
+  Page,
+
+  // Agent is an XOR-fold of the line address such that power-of-two
+  // strided accesses are spread across agents.
+  Xor
+};
+
+// Interleave type to human readable string.
+const char* to_string(InterleaveType t);
+
+//
+//
+struct InterleaveConfig {
+  // Interleave type.
+  InterleaveType type = InterleaveType::Line;
+  // Line size (in bytes); power-of-two.
+  std::uint64_t line_bytes = 64;
+  // Page size (in bytes); power-of-two.
+  std::uint64_t page_bytes = 4096;
+};
+
 //
 //
 struct LLCAgentConfig {
@@ -139,6 +185,117 @@ struct LLCAgentConfig {
 
   // Response Queue size
   std::size_t rsp_queue_n = 4;
+
+  // Number of banks; each bank has an independent command queue,
+  // pipeline and transaction table.
+  std::size_t bank_n = 1;
+
+  // Address interleave of lines across banks. Where lines are also
+  // interleaved across directories, the bank interleave should differ
+  // from the directory interleave, otherwise some banks are unused (a
+  // warning is raised upon DRC).
+  InterleaveConfig bank_interleave;
+
+  // Bank access latency; delay applied to messages emitted upon
+  // accessing the bank.
+  time_t access_latency = 0;
+};
+
+// DRAM row buffer (page) management policy.
+enum class DramPagePolicy {
+  // Rows remain open after access until a conflicting access or
+  // refresh.
+  Open,
+
+  // Rows are precharged immediately after each access.
+  Closed
+};
+
+// DRAM page policy to human readable string.
+const char* to_string(DramPagePolicy p);
+
+// Mapping of line address to DRAM coordinates; fields are listed from
+// most to least significant.
+enum class DramAddressMap {
+  // Row:Rank:Bank:Channel:Column; consecutive lines fall within the
+  // same row (favours row buffer locality).
+  RoRaBaChCo,
+
+  // Row:Column:Rank:Bank:Channel; consecutive lines are spread across
+  // channels and banks (favours bank level parallelism).
+  RoCoRaBaCh
+};
+
+// DRAM address map to human readable string.
+const char* to_string(DramAddressMap m);
+
+// DRAM backend of a memory controller. Timings are expressed in
+// memory controller epochs.
+//
+struct DramConfig {
+  // DRAM timing model is enabled; otherwise, commands complete in
+  // the epoch in which they are received.
+  bool enable = false;
+
+  // Number of channels.
+  std::size_t channel_n = 1;
+
+  // Number of ranks per channel.
+  std::size_t rank_n = 1;
+
+  // Number of banks per rank.
+  std::size_t bank_n = 8;
+
+  // Row buffer size (in bytes); power-of-two.
+  std::size_t row_bytes = 8192;
+
+  // Line size (in bytes); power-of-two.
+  std::size_t line_bytes = 64;
+
+  // Row buffer management policy.
+  DramPagePolicy page_policy = DramPagePolicy::Open;
+
+  // Line address to DRAM coordinate map.
+  DramAddressMap address_map = DramAddressMap::RoRaBaChCo;
+
+  // Bank index is XOR-ed with the low-order row bits such that
+  // row-strided accesses are spread across banks.
+  bool bank_xor = false;
+
+  // Activate to column command delay.
+  time_t tRCD = 14;
+
+  // Column command to data delay (CAS latency).
+  time_t tCL = 14;
+
+  // Precharge to activate delay.
+  time_t tRP = 14;
+
+  // Activate to precharge delay (minimum row open time).
+  time_t tRAS = 32;
+
+  // Write recovery; end of write data to precharge delay.
+  time_t tWR = 15;
+
+  // Refresh cycle time; rank unavailable for the duration.
+  time_t tRFC = 260;
+
+  // Refresh interval; zero disables refresh.
+  time_t tREFI = 7800;
+
+  // Data burst duration of one line.
+  time_t tBURST = 4;
+
+  // Read queue capacity.
+  std::size_t rdq_n = 32;
+
+  // Write queue capacity.
+  std::size_t wrq_n = 32;
+
+  // Write drain begins when write queue occupancy reaches the high
+  // watermark and ends once it falls to the low watermark.
+  std::size_t wr_drain_hi = 24;
+  std::size_t wr_drain_lo = 8;
 };
 
 //
@@ -149,8 +306,28 @@ struct MemModelConfig {
 
   // Agent epoch (period)
   time_t epoch = 10;
+
+  // DRAM backend.
+  DramConfig dram;
 };
 
+// Directory sharer set encoding.
+enum class SharerEncoding {
+  // Bit-vector; one bit per agent (precise; at most 64 agents).
+  FullMap,
+
+  // Limited pointer (Dir_iB); up to 'i' agents are tracked precisely,
+  // beyond which snoops are broadcast to all agents.
+  LimitedPointer,
+
+  // Coarse vector; one bit per group of agents, snoops are issued to
+  // all agents in each group.
+  CoarseVector
+};
+
+// Sharer encoding to human readable string.
+const char* to_string(SharerEncoding e);
+
 //
 //
 struct DirAgentConfig {
@@ -176,6 +353,16 @@ struct DirAgentConfig {
   // CohCmd credits (number of Coherence Commands to CC agent).
   std::size_t coh_cmd_credits_n = 4;
 
+  // Sharer set encoding.
+  SharerEncoding sharer_encoding = SharerEncoding::FullMap;
+
+  // Precise pointers per line (LimitedPointer); at most 4.
+  std::size_t sharer_pointer_n = 4;
+
+  // Agents per bit (CoarseVector); zero selects the smallest group
+  // such that all agents are represented.
+  std::size_t sharer_group_n = 0;
+
   // Cache configuratioh (non-Null Filter case).
   CacheModelConfig cconfig;
 
@@ -232,6 +419,13 @@ enum class StimulusType {
   // Programmatic - stimulus is constructed through method calls.
   Programmatic,
 
+  // BinaryTrace - stimulus is defined in a compact, binary trace file.
+  BinaryTrace,
+
+  // Synthetic - stimulus is generated on the fly from a per-CPU
+  // workload specification.
+  Synthetic,
+
   // Invalid stimulus type (placeholder)
   Invalid
 };
@@ -239,6 +433,87 @@ enum class StimulusType {
 // Stimulus type to human readable string.
 const char* to_string(StimulusType t);
 
+// Synthetic workload address distribution.
+enum class AddrDistribution {
+  // Lines are selected uniformly from the region.
+  Uniform,
+
+  // Lines are selected according to a Zipf (power-law) distribution;
+  // lowest addressed lines are the most popular.
+  Zipf,
+
+  // Lines are selected according to a fixed stride.
+  Strided,
+
+  // Each line is a pseudo-random function of the prior line such
+  // that the region is traversed as a linked-list.
+  PointerChase
+};
+
+// Address distribution to human readable string.
+const char* to_string(AddrDistribution d);
+
+// Synthetic workload sharing pattern for accesses to the shared
+// region.
+enum class SharingPattern {
+  // Loads and Stores are issued according to the store ratio.
+  None,
+
+  // Agent is a producer; accesses to the shared region are Stores.
+  Producer,
+
+  // Agent is a consumer; accesses to the shared region are Loads.
+  Consumer,
+
+  // Accesses to the shared region are a Load followed by a Store to
+  // the same line (read-modify-write).
+  Migratory
+};
+
+// Sharing pattern to human readable string.
+const char* to_string(SharingPattern p);
+
+// Synthetic workload inter-arrival time distribution.
+enum class ArrivalDistribution {
+  // Fixed period of 'arrival_mean'.
+  Fixed,
+
+  // Uniform in the interval [0, 2 * 'arrival_mean'].
+  Uniform,
+
+  // Exponential of mean 'arrival_mean' (Poisson arrivals).
+  Exponential
+};
+
+// Arrival distribution to human readable string.
+const char* to_string(ArrivalDistribution d);
+
+//
+//
+struct SyntheticCpuConfig {
+  // Path to CPU in object hierarchy.
+  std::string cpu;
+  // Number of commands to generate.
+  std::size_t command_n = 1000;
+  // Address distribution.
+  AddrDistribution addr_dist = AddrDistribution::Uniform;
+  // Zipf exponent.
+  float zipf_s = 1.0f;
+  // Stride (in bytes) of Strided distribution.
+  std::uint64_t stride = 64;
+  // Fraction of commands which are Stores.
+  float store_ratio = 0.3f;
+  // Fraction of commands to the shared region (the remainder are to
+  // the CPU's private region).
+  float shared_fraction = 0.0f;
+  // Sharing pattern of commands to the shared region.
+  SharingPattern sharing = SharingPattern::None;
+  // Inter-arrival time distribution.
+  ArrivalDistribution arrival_dist = ArrivalDistribution::Fixed;
+  // Mean inter-arrival time.
+  std::uint64_t arrival_mean = 10;
+};
+
 //
 //
 struct StimulusConfig {
@@ -248,6 +523,45 @@ struct StimulusConfig {
   StimulusType type = StimulusType::Trace;
   // Input stream to stimulus.
   std::istream* is = nullptr;
+  // BinaryTrace: path to trace file (mapped into memory). If empty,
+  // trace is read from 'is'.
+  std::string filename;
+  // Trace: parse trace on demand, rather than in its entirety at
+  // elaboration.
+  bool streaming = false;
+  // Trace: per-CPU look-ahead window (in commands) when streaming.
+  std::size_t lookahead_n = 1024;
+  // Synthetic: random seed; generated workload is a function of the
+  // seed and the per-CPU specification alone.
+  std::uint64_t seed = 1;
+  // Synthetic: line size (in bytes); generated addresses are aligned.
+  std::uint64_t line_bytes = 64;
+  // Synthetic: base address of shared region.
+  std::uint64_t shared_base = 0;
+  // Synthetic: size (in bytes) of shared region.
+  std::uint64_t shared_bytes = 64 * 1024;
+  // Synthetic: base address of the private region of the first CPU;
+  // private regions are allocated contiguously by CPU.
+  std::uint64_t private_base = 0x10000000;
+  // Synthetic: size (in bytes) of each CPU's private region.
+  std::uint64_t private_bytes = 64 * 1024;
+  // Synthetic: per-CPU workload specification.
+  std::vector<SyntheticCpuConfig> synthetic;
+};
+
+// Periodic time-series sampler of simulation statistics.
+//
+struct SamplerConfig {
+  // Sample interval (in simulation time units); zero disables
+  // sampling.
+  time_t interval = 0;
+  // Output (CSV) filename.
+  std::string filename;
+  // Series to sample: those whose name ("<path>.<stat>") begins with
+  // any of the given prefixes; all series where empty.
+  std::vector<std::string> select;
+  // Samples retained in memory between flushes to file.
+  std::size_t depth = 1024;
 };
 
 //
@@ -264,6 +578,10 @@ struct SocConfig {
   std::vector<DirAgentConfig> dcfgs;
   // Memory configurations
   std::vector<MemModelConfig> mcfgs;
+  // Address interleave of lines across directories.
+  InterleaveConfig dir_interleave;
+  // Address interleave of lines across memory controllers.
+  InterleaveConfig mem_interleave;
   // Stimulus configuration.
   StimulusConfig scfg;
   // NOC/Interconnect configuration.
@@ -272,8 +590,16 @@ struct SocConfig {
   ProtocolBuilder* pbuilder = nullptr;
   // Enable self-checking verification routines.
   bool enable_verif = false;
+  // Offload verification checks to a background checker thread.
+  bool verif_async = false;
   // Enable statistic gathering.
   bool enable_stats = false;
+  // Statistics JSON report filename (where non-empty).
+  std::string stats_json_filename;
+  // Statistics CSV report filename (where non-empty).
+  std::string stats_csv_filename;
+  // Statistics sampler configuration.
+  SamplerConfig sampler;
 };
 
 }  // namespace cc
@@ -118,6 +118,9 @@ class RandomSource {
     return dist(mt_);
   };
 
+  // Emit a random real in the half-open interval [0, 1).
+  double uniform_real();
+
  private:
   seed_type seed_;
   mt_type mt_;
@@ -140,7 +143,7 @@ class LogContext {
 enum class RunMode { ToExhaustion, ForTime };
 
 // Simulation phasea
-enum class Phase { Build, PreElabDrc, Elab, Drc, Init, Run, Fini };
+enum class Phase { Build, PreElabDrc, Elab, Drc, Init, Run, Fini, Reset };
 
 // Phase to human readable string
 const char* to_string(Phase phases);
@@ -193,6 +196,9 @@ class Object {
   // Find item in object heirarchy from split list of paths.
   Object* find_path(std::vector<std::string>& path);
 
+  // Discard lazily constructed path of object and its descendents.
+  void invalidate_path();
+
   // Kernel
   Kernel* k_ = nullptr;
   // Parent object
@@ -336,6 +342,21 @@ class Action : public Loggable {
 
   // Release (deallocate) object.
   virtual void release();
+
+  // Action is retained across a kernel reset (it is owned by the
+  // simulation hierarchy rather than the scenario).
+  virtual bool persistent() const { return false; }
+
+  // Action was created before the most recent kernel reset and must no
+  // longer be evaluated.
+  bool stale() const;
+
+  // Discard action upon kernel reset; by default, release.
+  virtual void discard() { release(); }
+
+ private:
+  // Kernel reset generation at the time of construction.
+  std::size_t reset_n_ = 0;
 };
 
 
@@ -464,6 +485,8 @@ class Module : public ProcessHost {
   virtual bool elab() { return false; }
   // Run Design Rule Check.
   virtual void drc() {}
+  // Return to the post-elaboration state (Reset-Phase).
+  virtual void reset() {}
 
   // A child objects.
   void add_child_module(Module* m);
@@ -486,6 +509,9 @@ class Kernel : public Module {
   struct FrontierItem {
     Time time;
     Action* action;
+    // Order of insertion; actions scheduled at the same time are
+    // evaluated in the order in which they were added.
+    std::uint64_t seq;
   };
 
   struct FrontierItemComparer;
@@ -501,6 +527,9 @@ class Kernel : public Module {
   // Number of actions presently in the event queue.
   std::size_t events_n() const { return eq_.size(); }
 
+  // Number of actions evaluated since elaboration (or reset).
+  std::uint64_t evaluated_n() const { return evaluated_n_; }
+
   // Flag indicating that a fatal error has occurred.
   bool fatal() const { return fatal_; }
 
@@ -516,6 +545,9 @@ class Kernel : public Module {
   // Top-level module instance.
   Object* top() const { return top_; }
 
+  // Number of times the kernel has been reset.
+  std::size_t reset_n() const { return reset_n_; }
+
   void raise_fatal() { fatal_ = true; }
 
   // Set random ssed.
@@ -548,9 +580,13 @@ class Kernel : public Module {
   // Invoke finalization.
   void invoke_fini();
 
+  // Invoke reset; return to the post-elaboration state.
+  void invoke_reset();
 
   // Simulation event queue.
   std::vector<FrontierItem> eq_;
+  // Number of actions added to the event queue.
+  std::uint64_t eq_seq_{0};
   // Current simulation time.
   Time time_;
   // Flag denoting that a fatal error has occurred.
@@ -561,6 +597,10 @@ class Kernel : public Module {
   LogContext log_context_;
   // Current simulation phase.
   Phase phase_{Phase::Build};
+  // Reset generation.
+  std::size_t reset_n_{0};
+  // Number of actions evaluated.
+  std::uint64_t evaluated_n_{0};
   // Simulation top-level.
   Object* top_{nullptr};
 };
@@ -598,6 +638,9 @@ class SimPhaseRunner {
   // Invoke initialization.
   void fini() const;
 
+  // Invoke reset.
+  void reset() const;
+
  private:
   // Kernel instance
   Kernel* k_ = nullptr;
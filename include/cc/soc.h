@@ -65,10 +65,19 @@ class SocTop : public kernel::TopModule {
   // Stimulus instance.
   Stimulus* stimulus() const { return stimulus_; }
 
+  // Simulation statistics (nullptr if statistics are disabled).
+  Statistics* statistics() const { return statistics_; }
+
+  // Verification monitor (nullptr if verification is disabled).
+  Monitor* monitor() const { return monitor_; }
+
  private:
   // Build phase; construct simulation environment.
   void build(const SocConfig& cfg);
 
+  // Build phase; assign dense ids to the interconnect agents.
+  void build_agent_ids();
+
   // Elaborate
   bool elab() override;
 
@@ -78,6 +87,9 @@ class SocTop : public kernel::TopModule {
   // Compute credit counts
   void elab_credit_counts();
 
+  // Compute fan-in of queues not governed by credits
+  void elab_fanin_counts();
+
   // Annotate time edges for NOC.
   void elab_annotate_edges();
 
@@ -134,7 +146,14 @@ class Soc {
   // Current simulation time/epoch.
   cursor_t time() const { return kernel_->time().time; }
 
-  // Initialize simulation model.
+  // Number of simulation events (actions) evaluated.
+  std::uint64_t evaluated_n() const { return kernel_->evaluated_n(); }
+
+  // Simulation has terminated on a fatal error.
+  bool fatal() const { return kernel_->fatal(); }
+
+  // Initialize simulation model; the model is elaborated upon the
+  // first invocation only.
   void initialize();
 
   // Run/Invoke simulation.
@@ -144,6 +163,12 @@ class Soc {
   // Finalize simulation model.
   void finalize();
 
+  // Return the simulation model to its post-elaboration state: time,
+  // pending actions, caches, tables, queues, credits, stimulus and
+  // statistics. A subsequent scenario is then run by way of
+  // initialize, run and finalize without re-elaboration.
+  void reset();
+
   // Return instance (or nullptr) for object at path.
   kernel::Object* find_path(const std::string& path) const {
     return top_->find_path(path);
@@ -156,6 +181,8 @@ class Soc {
   kernel::Kernel* kernel_ = nullptr;
   // Top module instance.
   SocTop* top_ = nullptr;
+  // Model has been elaborated.
+  bool elaborated_ = false;
 };
 
 //
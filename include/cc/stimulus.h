@@ -28,11 +28,13 @@
 #ifndef CC_INCLUDE_CC_STIMULUS_H
 #define CC_INCLUDE_CC_STIMULUS_H
 
+#include <cstdint>
 #include <deque>
 #include <exception>
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "cfgs.h"
 #include "kernel.h"
@@ -56,8 +58,10 @@ class Command {
  public:
   explicit Command() = default;
 
-  // Construct Load/Store instruction to address
-  Command(CpuOpcode opcode, addr_t addr) : opcode_(opcode), addr_(addr) {}
+  // Construct Load/Store instruction to address; 'dep' denotes that
+  // the command consumes the result of all prior Loads (load-to-use).
+  Command(CpuOpcode opcode, addr_t addr, bool dep = false)
+      : addr_(addr), opcode_(opcode), dep_(dep) {}
 
   // Accessors:
   
@@ -67,12 +71,18 @@ class Command {
   // Command opcode.
   CpuOpcode opcode() const { return opcode_; }
 
+  // Command depends upon the completion of all prior Loads.
+  bool dep() const { return dep_; }
+
  private:
   // Command address
   addr_t addr_ = 0;
 
   // Opcode (Load/Store)
   CpuOpcode opcode_ = CpuOpcode::Invalid;
+
+  // Load-to-use dependence marker.
+  bool dep_ = false;
 };
 
 
@@ -138,6 +148,12 @@ class StimulusContext : public kernel::Module {
 // Forward of Dequee-based context
 class DequeueContext;
 
+// Forward of binary trace context
+class BinaryTraceContext;
+
+// Forward of synthetic workload context
+class SyntheticContext;
+
 // Abstract base class encapsulating the concept of a transaction
 // source; more specifically, a block response to model the issue of
 // of load or store instructions to a cache.
@@ -161,13 +177,19 @@ class Stimulus : public kernel::Module {
   // Total retire count
   std::size_t retire_n() const { return retire_n_; }
 
- private:
+  // Clear issue and retire counts. File-based stimulus is not
+  // rewound; programmatic stimulus may be reloaded, and synthetic
+  // stimulus is regenerated, after a reset.
+  void reset() override;
+
+ protected:
   // 'context' issues a transaction.
   virtual void issue(StimulusContext* context);
 
   // 'context' retires a transaction.
   virtual void retire(StimulusContext* context);
 
+ private:
   // Total issue count
   std::size_t issue_n_ = 0;
   // Total retire count
@@ -200,7 +222,23 @@ class Stimulus : public kernel::Module {
 //
 //    C:0:ST:1000 // CPu 0 issues a Store to 0x1000 at current time.
 //
+//  C:(A)INTEGER:{LD,ST}:(B)INTEGER:DEP
+//
+//  As above, but the command is marked as dependent upon the result
+//  of all prior Loads of CPU "A". A closed-loop CPU (CpuConfig::
+//  closed_loop) withholds issue of the command until all such Loads
+//  have retired; the marker is otherwise ignored.
+//
+// By default, the trace is parsed in its entirety at elaboration. When
+// StimulusConfig::streaming is set, the trace is instead parsed on
+// demand: each CPU context retains a look-ahead window of
+// StimulusConfig::lookahead_n commands, which is refilled from the
+// trace as commands are issued.
+//
 class TraceStimulus : public Stimulus {
+  // Incremental trace scanner state.
+  struct Scanner;
+
  public:
   // Construct appropriate trace configuration-file from some string.
   static StimulusConfig from_string(const std::string& s);
@@ -221,9 +259,20 @@ class TraceStimulus : public Stimulus {
   // Stimulus:
   StimulusContext* register_cpu(Cpu* cpu) override;
 
+  // Stimulus: 'context' issues a transaction.
+  void issue(StimulusContext* context) override;
+
   // Parse trace file
   void parse_tracefile();
 
+  // Parse trace until the next command has been enqueued in its
+  // context; returns false once the trace has been exhausted.
+  bool parse_next();
+
+  // Parse trace until the look-ahead window of 'ctxt' is full, or the
+  // trace has been exhausted.
+  void refill(DequeueContext* ctxt);
+
   // Parse trace file header mappping CPU ID to path.
   std::vector<DequeueContext*> compute_index_table();
 
@@ -233,6 +282,9 @@ class TraceStimulus : public Stimulus {
   // Trace input stream
   std::istream* is_ = nullptr;
 
+  // Trace scanner
+  Scanner* scanner_ = nullptr;
+
   // Current line in trace file
   std::size_t line_ = 0;
 
@@ -240,6 +292,114 @@ class TraceStimulus : public Stimulus {
   std::size_t col_ = 0;
 };
 
+// Binary trace file specification:
+//
+// Header:
+//
+//  "CCTB" VERSION(u8)
+//  CPU_N(varint)
+//  CPU_N x { PATH_LEN(varint) PATH(bytes) STREAM_LEN(varint) }
+//
+// Body:
+//
+//  CPU_N per-CPU streams, concatenated in header order, each of
+//  STREAM_LEN bytes. A stream is a sequence of command records:
+//
+//  (TIME_DELTA << 2 | DEP << 1 | IS_STORE)(varint)
+//  ZIGZAG(ADDR_DELTA)(varint)
+//
+//  where TIME_DELTA is the advance of the time cursor since the prior
+//  command of the same CPU (or since zero), and ADDR_DELTA is the
+//  signed difference to the address of the prior command of the same
+//  CPU (or to zero). DEP is the load-to-use dependence marker. Varints
+//  are unsigned LEB128.
+//
+// The trace is mapped into memory and records are decoded in place as
+// they are consumed; nothing is materialized at elaboration beyond the
+// header.
+//
+class BinaryTraceStimulus : public Stimulus {
+ public:
+  // Construct configuration for a binary trace held in string 's'.
+  static StimulusConfig from_string(const std::string& s);
+
+  BinaryTraceStimulus(kernel::Kernel* k, const StimulusConfig& config);
+  ~BinaryTraceStimulus();
+
+ private:
+  // Build phase
+  void build();
+
+  // Elaborate phase
+  bool elab() override;
+
+  // Design Rule Check (DRC) phase
+  void drc() override;
+
+  // Stimulus:
+  StimulusContext* register_cpu(Cpu* cpu) override;
+
+  // Map trace file into memory.
+  void map_tracefile();
+
+  // Parse trace header and bind per-CPU streams to their contexts.
+  void parse_header();
+
+  // Registered CPU -> Context mapping.
+  std::map<Cpu*, BinaryTraceContext*> cpumap_;
+
+  // Trace input stream (where trace is not mapped).
+  std::istream* is_ = nullptr;
+
+  // Trace image (where trace is not mapped).
+  std::string image_;
+
+  // Base of trace image.
+  const std::uint8_t* base_ = nullptr;
+
+  // Length of trace image (in bytes).
+  std::size_t len_ = 0;
+
+  // Trace image is mapped (and must be unmapped).
+  bool is_mapped_ = false;
+};
+
+// Convert text trace format (as accepted by TraceStimulus) read from
+// 'is' into the binary trace format (as accepted by
+// BinaryTraceStimulus) written to 'os'. Throws StimulusException on a
+// malformed trace.
+void convert_trace_to_binary(std::istream& is, std::ostream& os);
+
+// Synthetic workload stimulus: commands are generated on the fly
+// according to a per-CPU specification (StimulusConfig::synthetic)
+// comprising an address distribution, a store ratio, the fraction of
+// commands to a region shared by all CPU (the remainder being to a
+// region private to the CPU), a sharing pattern for the shared region
+// and an inter-arrival time distribution. The generated sequence is a
+// function of StimulusConfig::seed and the specification alone.
+//
+class SyntheticStimulus : public Stimulus {
+ public:
+  SyntheticStimulus(kernel::Kernel* k, const StimulusConfig& config);
+
+  // Rewind each context to the start of its sequence; the workload
+  // subsequently retraces the prior run exactly.
+  void reset() override;
+
+ private:
+  // Elaborate phase
+  bool elab() override;
+
+  // Design Rule Check (DRC) phase
+  void drc() override;
+
+  // Stimulus:
+  StimulusContext* register_cpu(Cpu* cpu) override;
+
+  // Registered CPU -> Context mapping.
+  std::map<Cpu*, SyntheticContext*> cpumap_;
+};
+
 // Basic programmatic stimulus source where stimulus is generated
 // explicitly according to method call.
 //
@@ -248,9 +408,10 @@ class TraceStimulus : public Stimulus {
 // Advance stimulus cursor (current time) to value. Subsequent
 // calls to push_stimulus are performed relative to this value.
 //
-// push_stimulus(ID, opcode, addr)
+// push_stimulus(ID, opcode, addr, dep = false)
 //
-// Assign new {opcode, addr} instruction to the CPU given by ID.
+// Assign new {opcode, addr} instruction to the CPU given by ID,
+// optionally marked as load-to-use dependent (see Command).
 //
 class ProgrammaticStimulus : public Stimulus {
  public:
@@ -265,13 +426,18 @@ class ProgrammaticStimulus : public Stimulus {
 
   // Push new stimulus item to cpu CPU_ID at the time denoted by the
   // current cursor.
-  void push_stimulus(std::uint64_t cpu_id, CpuOpcode opcode, addr_t addr);
+  void push_stimulus(std::uint64_t cpu_id, CpuOpcode opcode, addr_t addr,
+                     bool dep = false);
 
   // Advance the current stimulus cursor to the current simulation
   // time such that consequent stimulus definitions are relative to
   // the true stimulation time as seen by the kernel.
   void advance_cursor(time_t c) { cursor_ += c; }
 
+  // Discard pending stimulus and rewind the cursor to zero; new
+  // stimulus may then be pushed for the next scenario.
+  void reset() override;
+
  private:
   // Current simulation time cursor in terms of stimulus generation.
   // This potentially lags the true simuluation time if the end-user
@@ -56,7 +56,7 @@ addr_t CacheAddressHelper::line_id(const addr_t& a) const {
 addr_t CacheAddressHelper::addr_from_set_tag(const addr_t setid,
                                              const addr_t tag) const {
   // Reconstruct cache-line aligned address from Set ID and TAG.
-  return ((tag << line_bits_) + setid & mask<addr_t>(line_bits_))
+  return ((tag << line_bits_) | (setid & mask<addr_t>(line_bits_)))
          << offset_bits_;
 }
 
@@ -313,6 +313,9 @@ class CacheModel {
     // the owning cache.
     bool evict(LineIterator it) {
       it->valid(false);
+      if (CacheModel* cache = it.cache(); cache != nullptr) {
+        cache->stats().evictions++;
+      }
       return true;
     }
 
@@ -425,6 +428,17 @@ class CacheModel {
     for (Line& l : cache_) l.valid(false);
   }
 
+  // Invalidate all lines, passing the state of each valid line to
+  // 'fn' for reclamation, and clear statistics.
+  template <typename FN>
+  void reset(FN fn) {
+    for (Line& l : cache_) {
+      if (l.valid()) fn(l.t());
+      l.valid(false);
+    }
+    stats_ = CacheStatistics{};
+  }
+
  private:
   // Current cache configuration.
   CacheModelConfig config_;
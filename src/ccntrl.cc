@@ -27,12 +27,15 @@
 
 #include "ccntrl.h"
 
+#include "ccntrl_process.h"
+
 #include "amba.h"
 #include "dir.h"
 #include "msg.h"
 #include "noc.h"
 #include "primitives.h"
 #include "protocol.h"
+#include "stats.h"
 #include "utility.h"
 #include "verif.h"
 
@@ -101,12 +104,23 @@ CCCommand* CCCommandBuilder::build_transaction_end(Transaction* t) {
 }
 
 CCCommand* CCCommandBuilder::build_blocked_on_event(MessageQueue* mq,
-                                                    kernel::Event* evt) {
+                                                    kernel::Event* evt,
+                                                    BlockReason reason) {
   CCCommand* cmd = new CCCommand(CCOpcode::MqSetBlockedOnEvt);
   cmd->set_event(evt);
+  cmd->set_block_reason(reason);
   return cmd;
 }
 
+CCTState::CCTState(kernel::Kernel* k) {
+  transaction_end_ = new kernel::Event(k, "transaction_end");
+}
+
+CCTState::~CCTState() {
+  line_->release();
+  delete transaction_end_;
+}
+
 CCContext::~CCContext() {
   if (owns_line_) {
     line_->release();
@@ -152,42 +166,41 @@ void CCCommandList::next_and_do_consume(bool do_consume) {
 }
 
 std::size_t CCResources::coh_srt_n(const Agent* agent) const {
-  std::size_t ret = 0;
-  if (auto it = coh_srt_.find(agent); it != coh_srt_.end()) {
-    ret = it->second;
-  }
-  return ret;
+  return coh_srt_.count(agent);
 }
 
 std::size_t CCResources::coh_cmd_n(const Agent* agent) const {
-  std::size_t ret = 0;
-  if (auto it = coh_cmd_.find(agent); it != coh_cmd_.end()) {
-    ret = it->second;
-  }
-  return ret;
+  return coh_cmd_.count(agent);
 }
 
 std::size_t CCResources::dt_n(const Agent* agent) const {
-  std::size_t ret = 0;
-  if (auto it = dt_.find(agent); it != dt_.end()) {
-    ret = it->second;
-  }
-  return ret;
+  return dt_.count(agent);
 }
 
 void CCResources::set_coh_srt_n(const Agent* agent, std::size_t coh_srt_n) {
-  coh_srt_[agent] = coh_srt_n;
+  coh_srt_.set(agent, coh_srt_n);
 }
 
 void CCResources::set_coh_cmd_n(const Agent* agent, std::size_t coh_cmd_n) {
-  coh_cmd_[agent] = coh_cmd_n;
+  coh_cmd_.set(agent, coh_cmd_n);
 }
 
 void CCResources::set_dt_n(const Agent* agent, std::size_t dt_n) {
-  dt_[agent] = dt_n;
+  dt_.set(agent, dt_n);
 }
 
-void CCResources::build(const CCCommandList& cl) {}
+void CCResources::build(const CCCommandList& cl) {
+  for (const CCCommand* cmd : cl) {
+    switch (cmd->opcode()) {
+      case CCOpcode::InvokeCoherenceAction: {
+        cmd->action()->set_resources(*this);
+      } break;
+      default: {
+        // No resources required.
+      } break;
+    }
+  }
+}
 
 // Cache Controller Interpreter; execute the comand sequence and
 // update the associated architectural state in the agent.
@@ -228,7 +241,9 @@ class CCCommandInterpreter {
  private:
   void execute_transaction_start(CCContext& ctxt, const CCCommand* cmd) const {
     CCTTable* tt = ctxt.cc()->tt();
-    CCTState* st = new CCTState();
+    CCTState* st = new CCTState(ctxt.cc()->k());
+    // Transactions are initiated by the L2 command.
+    st->set_addr(static_cast<const AceCmdMsg*>(ctxt.msg())->addr());
     st->set_line(ctxt.line());
     tt->install(ctxt.msg()->t(), st);
     ctxt.set_owns_line(false);
@@ -238,8 +253,12 @@ class CCCommandInterpreter {
     CCTTable* tt = ctxt.cc()->tt();
     Transaction* t = cmd->t();
     if (auto it = tt->find(cmd->t()); it != tt->end()) {
+      CCTState* st = it->second;
       // Would prefer to remove iterator.
       tt->remove(t);
+      // Notify any agents awaiting the completion of the transaction.
+      st->transaction_end()->notify();
+      st->release();
     } else {
       throw std::runtime_error("Table entry for transaction does not exist.");
     }
@@ -255,6 +274,16 @@ class CCCommandInterpreter {
     // Dequeue and release the head message of the currently
     // addressed Message Queue.
     const Message* msg = ctxt.mq()->dequeue();
+    if (Transaction* t = msg->t(); t != nullptr) {
+      if (msg->cls() == MessageClass::AceCmd) {
+        t->stamp(TransactionStage::L2Miss, ctxt.cc()->k()->time());
+      } else if (msg->cls() == MessageClass::CohEnd) {
+        t->stamp(TransactionStage::CohEnd, ctxt.cc()->k()->time());
+      }
+    }
+    if (CCStatBlock* stats = ctxt.cc()->stats(); stats != nullptr) {
+      if (msg->cls() == MessageClass::AceCmd) stats->cmd_n.inc();
+    }
     msg->release();
     ctxt.t().advance();
   }
@@ -268,7 +297,7 @@ class CCCommandInterpreter {
 
   void execute_mq_set_blocked_on_evt(CCContext& ctxt,
                                      const CCCommand* cmd) const {
-    ctxt.mq()->set_blocked_until(cmd->event());
+    ctxt.mq()->set_blocked_until(cmd->event(), cmd->block_reason());
   }
 
   void execute_wait_next_epoch(CCContext& ctxt, const CCCommand* cmd) const {
@@ -276,248 +305,139 @@ class CCCommandInterpreter {
   }
 };
 
-//
-//
-class CCAgent::RdisProcess : public AgentProcess {
-  using cb = CCCommandBuilder;
-
- public:
-  RdisProcess(kernel::Kernel* k, const std::string& name, CCAgent* model)
-      : AgentProcess(k, name), model_(model) {}
-
- private:
-  // Initialization
-  void init() override {
-    CCContext ctxt;
-    ctxt.set_process(this);
-    ctxt.set_cc(model_);
-    CCCommandList cl;
-    cl.push_back(CCOpcode::WaitOnMsg);
-    execute(ctxt, cl);
-  }
-
-  // Evaluation
-  void eval() override {
-    CCCommandList cl;
-    CCContext ctxt;
-    ctxt.set_process(this);
-    ctxt.set_cc(model_);
-    MQArb* arb = model_->arb();
-    ctxt.set_t(arb->tournament());
-
-    // Check if requests are present, if not block until a new message
-    // arrives at the arbiter. Process should ideally not wake in the
-    // absence of requesters.
-    if (!ctxt.t().has_requester()) {
-      cl.push_back(CCOpcode::WaitOnMsg);
-      execute(ctxt, cl);
-      return;
-    }
-    // Fetch nominated message queue
-    ctxt.set_mq(ctxt.t().winner());
-
-    // Dispatch to appropriate message class
-    const Message* msg = ctxt.msg();
-    switch (msg->cls()) {
-      case MessageClass::AceCmd: {
-        process_acecmd(ctxt, cl);
-      } break;
-      case MessageClass::CohEnd: {
-        process_cohend(ctxt, cl);
-      } break;
-      case MessageClass::CohCmdRsp: {
-        process_cohcmdrsp(ctxt, cl);
-      } break;
-      case MessageClass::Dt: {
-        process_dt(ctxt, cl);
-      } break;
-      default: {
-        using cc::to_string;
+CCAgent::RdisProcessBase::RdisProcessBase(kernel::Kernel* k,
+                                          const std::string& name,
+                                          CCAgent* model)
+    : AgentProcess(k, name), model_(model) {}
 
-        LogMessage lmsg("Invalid message class received: ");
-        lmsg.append(to_string(ctxt.msg()->cls()));
-        lmsg.set_level(Level::Error);
-        log(lmsg);
-      } break;
-    }
-
-    if (check_resources(ctxt, cl)) {
-      LogMessage lm("Execute message: ");
-      lm.append(ctxt.msg()->to_string());
-      lm.set_level(Level::Debug);
-      log(lm);
-
-      // Execution is a two-phased process.
-      //
-      // Firstly, the current message is applied to the transactions
-      // state. Secondly, once the state has been updated, a second
-      // round is performed to determine whether the transaction has
-      // now reached a state where it can complete. If the transaction
-      // is complete, a response is passed to the originating L2 and
-      // transaction removed from the table.
-      //
-
-      // Execute completed sequence.
-      execute(ctxt, cl);
-
-      // After appling the compute state updates, check if the overall
-      // transaction has completed and if so, run the completion
-      // sequence.
-      //
-      // TODO: as part of the can_execute process; we should
-      // conservatively expect the termination sequence to run,
-      // therefore we should expect the AceCmdRsp MessageQueue to be
-      // non-full.
-      const CCProtocol* protocol = model_->protocol();
-      CCCommandList cs;
-      if (protocol->is_complete(ctxt, cs)) {
-        execute(ctxt, cs);
-      }
-    } else {
-      // Otherwise, insufficient resources. Execute the "Wait"
-      // sequence which the check_resources method has now placed in
-      // the CommandList object.
-      execute(ctxt, cl);
-    }
-  }
-
-  void process_acecmd(CCContext& ctxt, CCCommandList& cl) const {
-    const CCProtocol* protocol = model_->protocol();
-
-    ctxt.set_line(protocol->construct_line());
-    ctxt.set_owns_line(true);
-    protocol->apply(ctxt, cl);
-  }
-
-  void process_cohend(CCContext& ctxt, CCCommandList& cl) const {
-    const CCTState* st = lookup_state_or_fail(ctxt.msg()->t());
-    ctxt.set_line(st->line());
-    const CCProtocol* protocol = model_->protocol();
-    protocol->apply(ctxt, cl);
-  }
-
-  void process_cohcmdrsp(CCContext& ctxt, CCCommandList& cl) const {
-    const CCTState* st = lookup_state_or_fail(ctxt.msg()->t());
-    ctxt.set_line(st->line());
-    const CCProtocol* protocol = model_->protocol();
-    protocol->apply(ctxt, cl);
-  }
-
-  void process_dt(CCContext& ctxt, CCCommandList& cl) const {
-    const CCTState* st = lookup_state_or_fail(ctxt.msg()->t());
-    ctxt.set_line(st->line());
-    const CCProtocol* protocol = model_->protocol();
-    protocol->apply(ctxt, cl);
-  }
-
-  bool check_resources(const CCContext& ctxt, CCCommandList& cl) const {
-    const CCResources res(cl);
-
-    // Flag denoting whether resource requirement has been attained.
-    bool has_resources = true;
+void CCAgent::RdisProcessBase::init() {
+  CCContext ctxt;
+  ctxt.set_process(this);
+  ctxt.set_cc(model_);
+  CCCommandList cl;
+  cl.push_back(CCOpcode::WaitOnMsg);
+  execute(ctxt, cl);
+}
 
-    MessageQueue* mq = nullptr;
+bool CCAgent::RdisProcessBase::check_resources(const CCContext& ctxt,
+                                               CCCommandList& cl) const {
+  using cb = CCCommandBuilder;
 
-    // Check L2 Command Queue
-    mq = model_->cc_l2__cmd_q();
-    if (has_resources && !mq->has_at_least(res.cmd_q_n())) {
-      // Resources not attained.
+  const CCResources res(cl);
+
+  // Flag denoting whether resource requirement has been attained.
+  bool has_resources = true;
+
+  MessageQueue* mq = nullptr;
+
+  // Check L2 Command Queue
+  mq = model_->cc_l2__cmd_q();
+  if (has_resources && !mq->has_at_least(res.cmd_q_n())) {
+    // Resources not attained.
+    cl.clear();
+    cl.push_back(cb::build_blocked_on_event(ctxt.mq(), mq->dequeue_event(),
+                                            BlockReason::QueueFull));
+    has_resources = false;
+  }
+
+  // Check L2 Response Queue
+  mq = model_->cc_l2__rsp_q();
+  if (has_resources && !mq->has_at_least(res.rsp_q_n())) {
+    // Resources not attained.
+    cl.clear();
+    cl.push_back(cb::build_blocked_on_event(ctxt.mq(), mq->dequeue_event(),
+                                            BlockReason::QueueFull));
+    has_resources = false;
+  }
+
+  // Flag denoting whether queue resources had been attained.
+  const bool has_queue_resources = has_resources;
+
+  // Check if the credit counter for {cls, agent} has at least 'n'
+  // credits.
+  auto check_credits = [&](MessageClass cls, const Agent* agent,
+                           std::size_t n) -> bool {
+    bool success = true;
+    // If a credit exists for the destination agent, credit count
+    // requirement must be attained, otherwise the requirement is ignored.
+    if (CreditCounter* cc = model_->cc_by_cls_agent(cls, agent);
+        cc != nullptr && cc->i() < n) {
       cl.clear();
-      cl.push_back(cb::build_blocked_on_event(ctxt.mq(), mq->dequeue_event()));
-      has_resources = false;
+      cl.push_back(cb::build_blocked_on_event(ctxt.mq(), cc->credit_event(),
+                                              BlockReason::Credits));
+      success = false;
     }
+    return success;
+  };
 
-    // Check L2 Response Queue
-    mq = model_->cc_l2__rsp_q();
-    if (has_resources && !mq->has_at_least(res.rsp_q_n())) {
-      // Resources not attained.
-      cl.clear();
-      cl.push_back(cb::build_blocked_on_event(ctxt.mq(), mq->dequeue_event()));
-      has_resources = false;
-    }
+  auto check_credit_counter = [&](MessageClass cls, const auto& res) {
+    if (!has_resources) return;
 
-    // Check if the credit counter for agent 'agent' has at least 'n'
-    // credits.
-    auto check_credits = [&](const CCAgent::ccntr_map& ccntrs,
-                             const Agent* agent, std::size_t n) -> bool {
-      bool success = true;
-      // If a credit exists for the destination agent, credit count
-      // requirement must be attained, otherwise the requirement is ignored.
-      if (auto it = ccntrs.find(agent); it != ccntrs.end()) {
-        CreditCounter* cc = it->second;
-        if (cc->i() < n) {
-          cl.clear();
-          cl.push_back(
-              cb::build_blocked_on_event(ctxt.mq(), cc->credit_event()));
-          success = false;
-        }
+    for (const auto& resp : res) {
+      if (!check_credits(cls, resp.first, resp.second)) {
+        has_resources = false;
+        break;
       }
-      return success;
-    };
-
-    auto check_credit_counter = [&](MessageClass cls, const auto& res) {
-      if (!has_resources) return;
-
-      auto& ccntrs_map = model_->ccntrs_map();
-      if (auto it = ccntrs_map.find(cls); it != ccntrs_map.end()) {
-        for (const auto& resp : res) {
-          if (!check_credits(it->second, resp.first, resp.second)) {
-            has_resources = false;
-            break;
-          }
-        }
+    }
+  };
+
+  // Check NOC credit counter
+  // check_credit_counter(MessageClass::Noc, res.noc_credit_n());
+  // Check Coherence Start Command credits
+  check_credit_counter(MessageClass::CohSrt, res.coh_srt());
+  // Check Coherence Command credits
+  check_credit_counter(MessageClass::CohCmd, res.coh_cmd());
+  // Check Data Transfer credits
+  check_credit_counter(MessageClass::Dt, res.dt());
+
+  if (!has_resources) {
+    cl.push_back(CCOpcode::WaitNextEpoch);
+    if (CCStatBlock* stats = model_->stats(); stats != nullptr) {
+      if (has_queue_resources) {
+        stats->credit_stall_n.inc();
+      } else {
+        stats->queue_stall_n.inc();
       }
-    };
-
-    // Check NOC credit counter
-    // check_credit_counter(MessageClass::Noc, res.noc_credit_n());
-    // Check Coherence Start Command credits
-    check_credit_counter(MessageClass::CohSrt, res.coh_srt());
-    // Check Coherence Command credits
-    check_credit_counter(MessageClass::CohCmd, res.coh_cmd());
-    // Check Data Transfer credits
-    check_credit_counter(MessageClass::Dt, res.dt());
-
-    if (!has_resources) {
-      cl.push_back(CCOpcode::WaitNextEpoch);
     }
-
-    return has_resources;
   }
 
-  void execute(CCContext& ctxt, const CCCommandList& cl) {
-    try {
-      CCCommandInterpreter interpreter;
-      for (const CCCommand* cmd : cl) {
-        interpreter.execute(ctxt, cmd);
-      }
-    } catch (const std::runtime_error& ex) {
-      LogMessage lm("Interpreter encountered an error: ");
-      lm.append(ex.what());
-      lm.set_level(Level::Fatal);
-      log(lm);
+  return has_resources;
+}
+
+void CCAgent::RdisProcessBase::execute(CCContext& ctxt,
+                                       const CCCommandList& cl) {
+  try {
+    CCCommandInterpreter interpreter;
+    for (const CCCommand* cmd : cl) {
+      interpreter.execute(ctxt, cmd);
     }
+  } catch (const std::runtime_error& ex) {
+    LogMessage lm("Interpreter encountered an error: ");
+    lm.append(ex.what());
+    lm.set_level(Level::Fatal);
+    log(lm);
   }
+}
 
-  CCTState* lookup_state_or_fail(Transaction* t) const {
-    CCTTable* tt = model_->tt();
+CCTState* CCAgent::RdisProcessBase::lookup_state_or_fail(Transaction* t) const {
+  CCTTable* tt = model_->tt();
 
-    CCTState* tstate = nullptr;
-    if (auto it = tt->find(t); it != tt->end()) {
-      tstate = it->second;
-    } else {
-      // Expect to find a entry in the transaction table. If an entry
-      // is not present bail.
-      LogMessage msg("Transaction not found in table.");
-      msg.set_level(Level::Fatal);
-      log(msg);
-    }
-    return tstate;
+  CCTState* tstate = nullptr;
+  if (auto it = tt->find(t); it != tt->end()) {
+    tstate = it->second;
+  } else {
+    // Expect to find a entry in the transaction table. If an entry
+    // is not present bail.
+    LogMessage msg("Transaction not found in table.");
+    msg.set_level(Level::Fatal);
+    log(msg);
   }
+  return tstate;
+}
 
-  // Cache controller instance.
-  CCAgent* model_ = nullptr;
-};
+CCSnpTState::~CCSnpTState() {
+  if (owns_line_) line_->release();
+}
 
 const char* to_string(CCSnpOpcode opcode) {
   switch (opcode) {
@@ -529,6 +449,8 @@ const char* to_string(CCSnpOpcode opcode) {
       return "InvokeCoherenceAction";
     case CCSnpOpcode::MsgConsume:
       return "MsgConsume";
+    case CCSnpOpcode::MqSetBlockedOnEvt:
+      return "MqSetBlockedOnEvt";
     case CCSnpOpcode::WaitNextEpoch:
       return "WaitNextEpoch";
     case CCSnpOpcode::WaitOnMsg:
@@ -587,6 +509,15 @@ CCSnpCommand* CCSnpCommandBuilder::from_action(CCCoherenceAction* action) {
   return cmd;
 }
 
+CCSnpCommand* CCSnpCommandBuilder::build_blocked_on_event(
+    MessageQueue* mq, kernel::Event* evt, BlockReason reason) {
+  CCSnpCommand* cmd = new CCSnpCommand;
+  cmd->set_opcode(CCSnpOpcode::MqSetBlockedOnEvt);
+  cmd->set_event(evt);
+  cmd->set_block_reason(reason);
+  return cmd;
+}
+
 CCSnpCommandList::~CCSnpCommandList() {
   for (CCSnpCommand* cmd : cmds_) {
     cmd->release();
@@ -618,6 +549,9 @@ class CCSnpCommandInterpreter {
       case CCSnpOpcode::MsgConsume: {
         execute_msg_consume(ctxt, cmd);
       } break;
+      case CCSnpOpcode::MqSetBlockedOnEvt: {
+        execute_mq_set_blocked_on_evt(ctxt, cmd);
+      } break;
       case CCSnpOpcode::WaitNextEpoch: {
         execute_wait_next_epoch(ctxt, cmd);
       } break;
@@ -639,7 +573,9 @@ class CCSnpCommandInterpreter {
     CCSnpTTable* tt = model_->snp_tt();
     Transaction* t = ctxt.msg()->t();
     if (auto it = tt->find(t); it != tt->end()) {
+      CCSnpTState* tstate = it->second;
       tt->remove(t);
+      tstate->release();
     } else {
       throw std::runtime_error("Table entry for transaction does not exist.");
     }
@@ -653,10 +589,21 @@ class CCSnpCommandInterpreter {
 
   void execute_msg_consume(CCSnpContext& ctxt, const CCSnpCommand* cmd) {
     const Message* msg = ctxt.mq()->dequeue();
+    if (msg->cls() == MessageClass::CohSnp && msg->t() != nullptr) {
+      msg->t()->stamp(TransactionStage::SnoopIssue, model_->k()->time());
+    }
+    if (CCStatBlock* stats = model_->stats(); stats != nullptr) {
+      if (msg->cls() == MessageClass::CohSnp) stats->snoop_n.inc();
+    }
     msg->release();
     ctxt.t().advance();
   }
 
+  void execute_mq_set_blocked_on_evt(CCSnpContext& ctxt,
+                                     const CCSnpCommand* cmd) {
+    ctxt.mq()->set_blocked_until(cmd->event(), cmd->block_reason());
+  }
+
   void execute_wait_next_epoch(CCSnpContext& ctxt, const CCSnpCommand* cmd) {
     process_->wait_epoch();
   }
@@ -673,118 +620,40 @@ class CCSnpCommandInterpreter {
   AgentProcess* process_ = nullptr;
 };
 
-//
-//
-class CCAgent::SnpProcess : public AgentProcess {
-  using cb = CCSnpCommandBuilder;
-
- public:
-  SnpProcess(kernel::Kernel* k, const std::string& name, CCAgent* model)
-      : AgentProcess(k, name), model_(model) {}
-
-  void init() override {
-    CCSnpContext ctxt;
-    CCSnpCommandList cl;
-    cl.push_back(cb::from_opcode(CCSnpOpcode::WaitOnMsg));
-    execute(ctxt, cl);
-  }
-
-  void eval() override {
-    CCSnpCommandList cl;
-    CCSnpContext ctxt;
-    ctxt.set_process(this);
-    ctxt.set_cc(model_);
-    MQArb* arb = model_->snp_arb();
-    ctxt.set_t(arb->tournament());
-
-    // Check if requests are present, if not block until a new message
-    // arrives at the arbiter. Process should ideally not wake in the
-    // absence of requesters.
-    if (!ctxt.t().has_requester()) {
-      cl.push_back(CCSnpOpcode::WaitOnMsg);
-      execute(ctxt, cl);
-      return;
-    }
-    // Fetch nominated message queue
-    ctxt.set_mq(ctxt.t().winner());
-
-    const Message* msg = ctxt.msg();
-    switch (msg->cls()) {
-      case MessageClass::CohSnp: {
-        process_cohsnp(ctxt, cl);
-      } break;
-      case MessageClass::AceCmdRsp: {
-        process_in_flight(ctxt, cl);
-      } break;
-      case MessageClass::AceSnoopRsp: {
-        process_in_flight(ctxt, cl);
-      } break;
-      case MessageClass::DtRsp: {
-        process_in_flight(ctxt, cl);
-      } break;
-      default: {
-        using cc::to_string;
-
-        LogMessage lmsg("Invalid message class received: ");
-        lmsg.append(to_string(ctxt.msg()->cls()));
-        lmsg.set_level(Level::Fatal);
-        log(lmsg);
-      } break;
-    }
-    if (can_execute(cl)) {
-      LogMessage lm("Execute message: ");
-      lm.append(ctxt.msg()->to_string());
-      lm.set_level(Level::Debug);
-      log(lm);
+CCAgent::SnpProcessBase::SnpProcessBase(kernel::Kernel* k,
+                                        const std::string& name,
+                                        CCAgent* model)
+    : AgentProcess(k, name), model_(model) {}
 
-      execute(ctxt, cl);
-    }
-  }
-
-  void process_cohsnp(CCSnpContext& ctxt, CCSnpCommandList& cl) {
-    CCSnpTState* tstate = new CCSnpTState;
-    const CCProtocol* protocol = model_->protocol();
-    tstate->set_line(protocol->construct_snp_line());
-    tstate->set_owns_line(true);
-    ctxt.set_tstate(tstate);
-    ctxt.set_owns_tstate(true);
-    protocol->apply(ctxt, cl);
-  }
+void CCAgent::SnpProcessBase::init() {
+  using cb = CCSnpCommandBuilder;
 
-  void process_in_flight(CCSnpContext& ctxt, CCSnpCommandList& cl) {
-    CCSnpTTable* snp_tt = model_->snp_table();
-    const Message* msg = ctxt.msg();
-    if (auto it = snp_tt->find(msg->t()); it != snp_tt->end()) {
-      ctxt.set_tstate(it->second);
-      const CCProtocol* protocol = model_->protocol();
-      protocol->apply(ctxt, cl);
-    } else {
-      LogMessage lm("Transaction not found in Transaction table.");
-      lm.set_level(Level::Fatal);
-      log(lm);
-    }
-  }
+  CCSnpContext ctxt;
+  CCSnpCommandList cl;
+  cl.push_back(cb::from_opcode(CCSnpOpcode::WaitOnMsg));
+  execute(ctxt, cl);
+}
 
-  bool can_execute(const CCSnpCommandList& cl) const { return true; }
+bool CCAgent::SnpProcessBase::can_execute(const CCSnpCommandList& cl) const {
+  return true;
+}
 
-  void execute(CCSnpContext& ctxt, const CCSnpCommandList& cl) {
-    try {
-      CCSnpCommandInterpreter interpreter;
-      interpreter.set_cc(model_);
-      interpreter.set_process(this);
-      for (const CCSnpCommand* cmd : cl) {
-        interpreter.execute(ctxt, cmd);
-      }
-    } catch (const std::runtime_error& ex) {
-      LogMessage lm("Interpreter encountered an error: ");
-      lm.append(ex.what());
-      lm.set_level(Level::Fatal);
-      log(lm);
+void CCAgent::SnpProcessBase::execute(CCSnpContext& ctxt,
+                                      const CCSnpCommandList& cl) {
+  try {
+    CCSnpCommandInterpreter interpreter;
+    interpreter.set_cc(model_);
+    interpreter.set_process(this);
+    for (const CCSnpCommand* cmd : cl) {
+      interpreter.execute(ctxt, cmd);
     }
+  } catch (const std::runtime_error& ex) {
+    LogMessage lm("Interpreter encountered an error: ");
+    lm.append(ex.what());
+    lm.set_level(Level::Fatal);
+    log(lm);
   }
-
-  CCAgent* model_ = nullptr;
-};
+}
 
 // NOC endpoint. Forward ingress Messages from the NOC and redirect
 // messages to their associated MessageQueue in the controller
@@ -797,21 +666,16 @@ class CCNocEndpoint : public NocEndpoint {
       : NocEndpoint(k, name) {}
   //
   void register_endpoint(MessageClass cls, MessageQueue* p) {
-    endpoints_.insert(std::make_pair(cls, p));
+    endpoints_[static_cast<std::size_t>(cls)] = p;
   }
   //
-  MessageQueue* lookup_endpoint(MessageClass cls) {
-    MessageQueue* mq = nullptr;
-    if (auto it = endpoints_.find(cls); it != endpoints_.end()) {
-      mq = it->second;
-    }
-    return mq;
+  MessageQueue* lookup_endpoint(MessageClass cls) const {
+    return endpoints_[static_cast<std::size_t>(cls)];
   }
   //
   MessageQueue* lookup_mq(const Message* msg) const override {
-    if (auto it = endpoints_.find(msg->cls()); it != endpoints_.end()) {
-      return it->second;
-    } else {
+    MessageQueue* mq = lookup_endpoint(msg->cls());
+    if (mq == nullptr) {
       using cc::to_string;
 
       LogMessage lm("End point not register for class: ");
@@ -819,17 +683,22 @@ class CCNocEndpoint : public NocEndpoint {
       lm.set_level(Level::Fatal);
       log(lm);
     }
-    return nullptr;
+    return mq;
   }
 
  private:
-  //
-  std::map<MessageClass, MessageQueue*> endpoints_;
+  // Message Queue by MessageClass (nullptr where unregistered).
+  std::array<MessageQueue*, message_class_n> endpoints_{};
 };
 
 CCAgent::CCAgent(kernel::Kernel* k, const CCAgentConfig& config)
+    : CCAgent(k, config, &construct_rdis<CCProtocol>,
+              &construct_snp<CCProtocol>) {}
+
+CCAgent::CCAgent(kernel::Kernel* k, const CCAgentConfig& config,
+                 rdis_factory rf, snp_factory sf)
     : Agent(k, config.name), config_(config) {
-  build();
+  build(rf, sf);
 }
 
 CCAgent::~CCAgent() {
@@ -847,16 +716,13 @@ CCAgent::~CCAgent() {
   delete tt_;
   delete snp_tt_;
   delete protocol_;
-  for (const auto& class_map : ccntrs_map_) {
-    for (const auto& agent_counter : class_map.second) {
-      delete agent_counter.second;
-    }
-  }
+  ccntrs_.for_each([](CreditCounter* cc) { delete cc; });
 }
 
-void CCAgent::build() {
+void CCAgent::build(rdis_factory rf, snp_factory sf) {
   // Construct L2 to CC command queue
   l2_cc__cmd_q_ = new MessageQueue(k(), "l2_cc__cmd_q", 30);
+  l2_cc__cmd_q_->add_fanin(1);
   add_child_module(l2_cc__cmd_q_);
   // DIR -> CC response queue
   dir_cc__rsp_q_ = new MessageQueue(k(), "dir_cc__rsp_q", 30);
@@ -866,6 +732,7 @@ void CCAgent::build() {
   add_child_module(dir_cc__snpcmd_q_);
   // L2 -> CC Snoop Response Message Queue
   l2_cc__snprsp_q_ = new MessageQueue(k(), "l2_cc__snprsp_q", 30);
+  l2_cc__snprsp_q_->add_fanin(1);
   add_child_module(l2_cc__snprsp_q_);
   // CC -> CC response queue (intervention response).
   cc_cc__rsp_q_ = new MessageQueue(k(), "cc_cc__rsp_q", 30);
@@ -880,11 +747,11 @@ void CCAgent::build() {
   snp_arb_ = new MQArb(k(), "snp_arb");
   add_child_module(snp_arb_);
   // Dispatcher process
-  rdis_proc_ = new RdisProcess(k(), "rdis_proc", this);
+  rdis_proc_ = rf(k(), "rdis_proc", this);
   rdis_proc_->set_epoch(config_.epoch);
   add_child_process(rdis_proc_);
   // Snoop process.
-  snp_proc_ = new SnpProcess(k(), "snp_proc", this);
+  snp_proc_ = sf(k(), "snp_proc", this);
   snp_proc_->set_epoch(config_.epoch);
   add_child_process(snp_proc_);
   // NOC endpoint
@@ -909,6 +776,10 @@ void CCAgent::register_monitor(Monitor* monitor) {
   monitor->register_client(this);
 }
 
+void CCAgent::register_statistics(Statistics* statistics) {
+  statistics_ = statistics;
+}
+
 // Elaborate Cache controller instance.
 //
 bool CCAgent::elab() {
@@ -932,6 +803,10 @@ bool CCAgent::elab() {
   noc_endpoint_->register_endpoint(MessageClass::AceSnoopRsp, l2_cc__snprsp_q_);
   noc_endpoint_->register_endpoint(MessageClass::DtRsp, cc_cc__rsp_q_);
 
+  // Bind statistics block.
+  if (statistics_ != nullptr) {
+    stats_ = statistics_->register_block<CCStatBlock>(path());
+  }
   return false;
 }
 
@@ -962,8 +837,14 @@ void CCAgent::register_credit_counter(MessageClass cls, Agent* dest,
   CreditCounter* cc = new CreditCounter(k(), name);
   cc->set_n(n);
   add_child_module(cc);
+  if (dest->id() == Agent::npos) {
+    LogMessage msg("Credit counter destination has no agent id: ");
+    msg.append(dest->path());
+    msg.set_level(Level::Fatal);
+    log(msg);
+  }
   // Install credit counter.
-  ccntrs_map_[cls].insert(std::make_pair(dest, cc));
+  ccntrs_.install(cls, dest, cc);
 }
 
 //
@@ -980,6 +861,12 @@ void CCAgent::drc() {
   }
 }
 
+void CCAgent::reset() {
+  // Reclaim transaction state.
+  for (const auto& p : *tt_) p.second->release();
+  for (const auto& p : *snp_tt_) p.second->release();
+}
+
 MessageQueue* CCAgent::endpoint() const { return noc_endpoint_->ingress_mq(); }
 
 CreditCounter* CCAgent::cc_by_cls_agent(MessageClass cls,
@@ -988,11 +875,8 @@ CreditCounter* CCAgent::cc_by_cls_agent(MessageClass cls,
   if (cls == MessageClass::Noc) {
     // NOC ingress credit counter.
     ret = cc_noc__port_->ingress_cc();
-  } else if (auto i = ccntrs_map_.find(cls); i != ccntrs_map_.end()) {
-    const auto& agent_cc_map = i->second;
-    if (auto j = agent_cc_map.find(agent); j != agent_cc_map.end()) {
-      ret = j->second;
-    }
+  } else {
+    ret = ccntrs_.lookup(cls, agent);
   }
   return ret;
 }
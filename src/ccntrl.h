@@ -46,6 +46,8 @@ class CCAgent;
 class CCNocEndpoint;
 class CCCoherenceAction;
 class Monitor;
+class Statistics;
+struct CCStatBlock;
 
 enum class CCOpcode {
   // Raise notification that a new transaction has begun.
@@ -104,6 +106,9 @@ class CCCommand {
   // Associated event
   kernel::Event* event() const { return oprands_.e; }
 
+  // Reason for which the Message Queue is blocked on event.
+  BlockReason block_reason() const { return oprands_.block_reason; }
+
 
   // Setters:
 
@@ -113,6 +118,9 @@ class CCCommand {
   // Set event isntance.
   void set_event(kernel::Event* e) { oprands_.e = e; }
 
+  // Set reason for which the Message Queue is blocked on event.
+  void set_block_reason(BlockReason r) { oprands_.block_reason = r; }
+
  private:
   virtual ~CCCommand();
 
@@ -121,6 +129,7 @@ class CCCommand {
     CCCoherenceAction* action;
     Transaction* t;
     kernel::Event* e;
+    BlockReason block_reason;
   } oprands_;
 
   // Opcode
@@ -144,7 +153,8 @@ class CCCommandBuilder {
 
   // Construct "block on event" action.
   static CCCommand* build_blocked_on_event(MessageQueue* mq,
-                                           kernel::Event* evt);
+                                           kernel::Event* evt,
+                                           BlockReason reason);
 };
 
 
@@ -194,7 +204,7 @@ class CCCommandList {
 // perform a given command list.
 //
 class CCResources {
-  using key_map = std::map<const Agent*, std::size_t>;
+  using key_map = AgentCounts;
 
  public:
   CCResources(const CCCommandList& cl) { build(cl); }
@@ -286,7 +296,8 @@ class CCCoherenceAction {
   // Invoke/Execute coherence action
   virtual bool execute() = 0;
 
-  virtual void release() { delete this; }
+  // Release action back to pool, or destruct.
+  virtual void release() const { delete this; }
 
  protected:
   virtual ~CCCoherenceAction() = default;
@@ -296,10 +307,12 @@ class CCCoherenceAction {
 //
 class CCTState {
  public:
-  CCTState() = default;
+  explicit CCTState(kernel::Kernel* k);
   // Destruct/Return to pool
   void release() { delete this; }
 
+  // Transaction end event; notified on end of transaction.
+  kernel::Event* transaction_end() const { return transaction_end_; }
 
   // Protocol line
   CCLineState* line() const { return line_; }
@@ -315,10 +328,15 @@ class CCTState {
   void set_addr(addr_t addr) { addr_ = addr; }
 
  private:
+  // Destruct object using 'release' method
+  ~CCTState();
+
   // Address of current operation
   addr_t addr_ = 0;
   // 
   CCLineState* line_ = nullptr;
+  // Transaction end event.
+  kernel::Event* transaction_end_ = nullptr;
 };
 
 using CCTTable = Table<Transaction*, CCTState*>;
@@ -404,6 +422,10 @@ enum class CCSnpOpcode {
   // Consume message from nominated message queue.
   MsgConsume,
 
+  // Set blocked status of Message Queue awaiting notification of
+  // event.
+  MqSetBlockedOnEvt,
+
   // Re-evaluate agent after an 'Epoch' has elapsed.
   WaitNextEpoch,
 
@@ -433,16 +455,30 @@ class CCSnpCommand {
   CCSnpOpcode opcode() const { return opcode_; }
   CCCoherenceAction* action() const { return oprands_.action; }
 
+  // Associated event
+  kernel::Event* event() const { return oprands_.e; }
+
+  // Reason for which the Message Queue is blocked on event.
+  BlockReason block_reason() const { return oprands_.block_reason; }
+
   //
   void set_opcode(CCSnpOpcode opcode) { opcode_ = opcode; }
   void set_action(CCCoherenceAction* action) { oprands_.action = action; }
 
+  // Set event isntance.
+  void set_event(kernel::Event* e) { oprands_.e = e; }
+
+  // Set reason for which the Message Queue is blocked on event.
+  void set_block_reason(BlockReason r) { oprands_.block_reason = r; }
+
  private:
   virtual ~CCSnpCommand();
 
   //
   struct {
     CCCoherenceAction* action;
+    kernel::Event* e;
+    BlockReason block_reason;
   } oprands_;
   //
   CCSnpOpcode opcode_;
@@ -457,6 +493,11 @@ class CCSnpCommandBuilder {
 
   // Construct new command from a protocol-defined action.
   static CCSnpCommand* from_action(CCCoherenceAction* action);
+
+  // Construct "block on event" action.
+  static CCSnpCommand* build_blocked_on_event(MessageQueue* mq,
+                                              kernel::Event* evt,
+                                              BlockReason reason);
 };
 
 //
@@ -523,7 +564,7 @@ class CCSnpTState {
 
  private:
   // Destruct object using 'release' method
-  virtual ~CCSnpTState() = default;
+  virtual ~CCSnpTState();
 
   // Snoop line state.
   CCSnpLineState* line_ = nullptr;
@@ -621,12 +662,14 @@ class CCAgent : public Agent {
   friend class CCCommandInterpreter;
   friend class CCSnpCommandInterpreter;
 
+  class RdisProcessBase;
+  class SnpProcessBase;
+  template <typename>
   class RdisProcess;
+  template <typename>
   class SnpProcess;
 
  public:
-  using ccntr_map = std::map<const Agent*, CreditCounter*>;
-
   CCAgent(kernel::Kernel* k, const CCAgentConfig& config);
   ~CCAgent();
 
@@ -657,11 +700,6 @@ class CCAgent : public Agent {
   // L2 cache model
   L2CacheAgent* l2c() const { return l2c_; }
 
-  // Credit Counters
-  const std::map<MessageClass, ccntr_map>& ccntrs_map() const {
-    return ccntrs_map_;
-  }
-
   // Lookup Credit Counter by Message Class and agent
   CreditCounter* cc_by_cls_agent(MessageClass cls, const Agent* agent) const;
 
@@ -669,6 +707,29 @@ class CCAgent : public Agent {
   MessageQueue* mq_by_msg_cls(MessageClass cls) const;
 
  protected:
+  // Request dispatcher process factory.
+  using rdis_factory = RdisProcessBase* (*)(kernel::Kernel*, const std::string&,
+                                            CCAgent*);
+  // Snoop process factory.
+  using snp_factory = SnpProcessBase* (*)(kernel::Kernel*, const std::string&,
+                                          CCAgent*);
+
+  // Construct agent where the request dispatcher and snoop processes
+  // are constructed by 'rf' and 'sf' respectively.
+  CCAgent(kernel::Kernel* k, const CCAgentConfig& config, rdis_factory rf,
+          snp_factory sf);
+
+  // Construct request dispatcher specialized on protocol ProtocolT.
+  template <typename ProtocolT>
+  static RdisProcessBase* construct_rdis(kernel::Kernel* k,
+                                         const std::string& name,
+                                         CCAgent* model);
+
+  // Construct snoop process specialized on protocol ProtocolT.
+  template <typename ProtocolT>
+  static SnpProcessBase* construct_snp(kernel::Kernel* k,
+                                       const std::string& name, CCAgent* model);
+
   // Accessors:
 
   // Pointer to module arbiter instance:
@@ -686,12 +747,18 @@ class CCAgent : public Agent {
   // Snoop transactiont table.
   CCSnpTTable* snp_table() const { return snp_tt_; }
 
+  // Cache controller statistics (nullptr if statistics are disabled).
+  CCStatBlock* stats() const { return stats_; }
+
   // Construction
-  void build();
+  void build(rdis_factory rf, snp_factory sf);
 
   // Register Verification Monitor
   void register_monitor(Monitor* monitor);
 
+  // Register statistics.
+  void register_statistics(Statistics* statistics);
+
   // Elaboration
   bool elab() override;
 
@@ -723,6 +790,9 @@ class CCAgent : public Agent {
   // Design Rule Check (DRC)
   void drc() override;
 
+  // Reset
+  void reset() override;
+
  private:
   // L2 Cache Model to which this controller is bound.
   L2CacheAgent* l2c_ = nullptr;
@@ -754,8 +824,8 @@ class CCAgent : public Agent {
   // {LLC, CC} -> CC Data (dt) queue (cc owned)
   MessageQueue* cc__dt_q_ = nullptr;
 
-  // Agent credit counters (keyed on Message class)
-  std::map<MessageClass, ccntr_map> ccntrs_map_;
+  // Agent credit counters (keyed on Message class and agent id)
+  AgentClassTable<CreditCounter> ccntrs_;
 
   // Queue selection arbiter
   MQArb* arb_ = nullptr;
@@ -767,10 +837,10 @@ class CCAgent : public Agent {
   DirMapper* dm_ = nullptr;
 
   // Disatpcher process
-  RdisProcess* rdis_proc_ = nullptr;
+  RdisProcessBase* rdis_proc_ = nullptr;
 
   // Snoop process
-  SnpProcess* snp_proc_ = nullptr;
+  SnpProcessBase* snp_proc_ = nullptr;
 
   // NOC endpoint
   CCNocEndpoint* noc_endpoint_ = nullptr;
@@ -787,6 +857,12 @@ class CCAgent : public Agent {
   // Verification monitor instance.
   Monitor* monitor_ = nullptr;
 
+  // Statistics registry
+  Statistics* statistics_ = nullptr;
+
+  // Cache controller statistics
+  CCStatBlock* stats_ = nullptr;
+
   // Cache controller configuration.
   CCAgentConfig config_;
 };
@@ -0,0 +1,377 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#ifndef CC_SRC_CCNTRL_PROCESS_H
+#define CC_SRC_CCNTRL_PROCESS_H
+
+#include "ccntrl.h"
+#include "protocol.h"
+#include "utility.h"
+
+namespace cc {
+
+// Protocol independent component of the cache controller request
+// dispatcher process.
+//
+class CCAgent::RdisProcessBase : public AgentProcess {
+ public:
+  RdisProcessBase(kernel::Kernel* k, const std::string& name, CCAgent* model);
+
+ protected:
+  // Initialization
+  void init() override;
+
+  // Permute command list 'cl' to a wait list if the agent has
+  // insufficient resources to execute it; returns true on success.
+  bool check_resources(const CCContext& ctxt, CCCommandList& cl) const;
+
+  // Execute command list 'cl'.
+  void execute(CCContext& ctxt, const CCCommandList& cl);
+
+  // Lookup transaction state for 't'; fatal if not present.
+  CCTState* lookup_state_or_fail(Transaction* t) const;
+
+  // Cache controller instance.
+  CCAgent* model_ = nullptr;
+};
+
+// Protocol independent component of the cache controller snoop
+// process.
+//
+class CCAgent::SnpProcessBase : public AgentProcess {
+ public:
+  SnpProcessBase(kernel::Kernel* k, const std::string& name, CCAgent* model);
+
+ protected:
+  // Initialization
+  void init() override;
+
+  // Resource check for command list 'cl'.
+  bool can_execute(const CCSnpCommandList& cl) const;
+
+  // Execute command list 'cl'.
+  void execute(CCSnpContext& ctxt, const CCSnpCommandList& cl);
+
+  // Cache controller instance.
+  CCAgent* model_ = nullptr;
+};
+
+// Cache controller request dispatcher process specialized on the
+// protocol type (see L1CacheAgent::MainProcess).
+//
+template <typename ProtocolT>
+class CCAgent::RdisProcess : public CCAgent::RdisProcessBase {
+  using cb = CCCommandBuilder;
+
+ public:
+  RdisProcess(kernel::Kernel* k, const std::string& name, CCAgent* model)
+      : RdisProcessBase(k, name, model) {}
+
+ private:
+  // Protocol instance, as its specialized type.
+  const ProtocolT* protocol() const {
+    return static_cast<const ProtocolT*>(model_->protocol());
+  }
+
+  // Evaluation
+  void eval() override {
+    CCCommandList cl;
+    CCContext ctxt;
+    ctxt.set_process(this);
+    ctxt.set_cc(model_);
+    MQArb* arb = model_->arb();
+    ctxt.set_t(arb->tournament());
+
+    // Check if requests are present, if not block until a new message
+    // arrives at the arbiter. Process should ideally not wake in the
+    // absence of requesters.
+    if (!ctxt.t().has_requester()) {
+      cl.push_back(CCOpcode::WaitOnMsg);
+      execute(ctxt, cl);
+      return;
+    }
+    // Fetch nominated message queue
+    ctxt.set_mq(ctxt.t().winner());
+
+    // Dispatch to appropriate message class
+    const Message* msg = ctxt.msg();
+    switch (msg->cls()) {
+      case MessageClass::AceCmd: {
+        process_acecmd(ctxt, cl);
+      } break;
+      case MessageClass::CohEnd: {
+        process_cohend(ctxt, cl);
+      } break;
+      case MessageClass::CohCmdRsp: {
+        process_cohcmdrsp(ctxt, cl);
+      } break;
+      case MessageClass::Dt: {
+        process_dt(ctxt, cl);
+      } break;
+      default: {
+        using cc::to_string;
+
+        LogMessage lmsg("Invalid message class received: ");
+        lmsg.append(to_string(ctxt.msg()->cls()));
+        lmsg.set_level(Level::Error);
+        log(lmsg);
+      } break;
+    }
+
+    if (check_resources(ctxt, cl)) {
+      LogMessage lm("Execute message: ");
+      lm.append(ctxt.msg()->to_string());
+      lm.set_level(Level::Debug);
+      log(lm);
+
+      // Execution is a two-phased process.
+      //
+      // Firstly, the current message is applied to the transactions
+      // state. Secondly, once the state has been updated, a second
+      // round is performed to determine whether the transaction has
+      // now reached a state where it can complete. If the transaction
+      // is complete, a response is passed to the originating L2 and
+      // transaction removed from the table.
+      //
+
+      // Execute completed sequence.
+      execute(ctxt, cl);
+
+      // After appling the compute state updates, check if the overall
+      // transaction has completed and if so, run the completion
+      // sequence.
+      //
+      // TODO: as part of the can_execute process; we should
+      // conservatively expect the termination sequence to run,
+      // therefore we should expect the AceCmdRsp MessageQueue to be
+      // non-full.
+      const ProtocolT* protocol = this->protocol();
+      CCCommandList cs;
+      if (protocol->is_complete(ctxt, cs)) {
+        execute(ctxt, cs);
+      }
+    } else {
+      // Otherwise, insufficient resources. Execute the "Wait"
+      // sequence which the check_resources method has now placed in
+      // the CommandList object.
+      execute(ctxt, cl);
+    }
+  }
+
+  void process_acecmd(CCContext& ctxt, CCCommandList& cl) const {
+    const ProtocolT* protocol = this->protocol();
+
+    ctxt.set_line(protocol->construct_line());
+    ctxt.set_owns_line(true);
+    protocol->apply(ctxt, cl);
+  }
+
+  void process_cohend(CCContext& ctxt, CCCommandList& cl) const {
+    const CCTState* st = lookup_state_or_fail(ctxt.msg()->t());
+    ctxt.set_line(st->line());
+    const ProtocolT* protocol = this->protocol();
+    protocol->apply(ctxt, cl);
+  }
+
+  void process_cohcmdrsp(CCContext& ctxt, CCCommandList& cl) const {
+    const CCTState* st = lookup_state_or_fail(ctxt.msg()->t());
+    ctxt.set_line(st->line());
+    const ProtocolT* protocol = this->protocol();
+    protocol->apply(ctxt, cl);
+  }
+
+  void process_dt(CCContext& ctxt, CCCommandList& cl) const {
+    const CCTState* st = lookup_state_or_fail(ctxt.msg()->t());
+    ctxt.set_line(st->line());
+    const ProtocolT* protocol = this->protocol();
+    protocol->apply(ctxt, cl);
+  }
+};
+
+// Cache controller snoop process specialized on the protocol type
+// (see L1CacheAgent::MainProcess).
+//
+template <typename ProtocolT>
+class CCAgent::SnpProcess : public CCAgent::SnpProcessBase {
+  using cb = CCSnpCommandBuilder;
+
+ public:
+  SnpProcess(kernel::Kernel* k, const std::string& name, CCAgent* model)
+      : SnpProcessBase(k, name, model) {}
+
+  void eval() override {
+    CCSnpCommandList cl;
+    CCSnpContext ctxt;
+    ctxt.set_process(this);
+    ctxt.set_cc(model_);
+    MQArb* arb = model_->snp_arb();
+    ctxt.set_t(arb->tournament());
+
+    // Check if requests are present, if not block until a new message
+    // arrives at the arbiter. Process should ideally not wake in the
+    // absence of requesters.
+    if (!ctxt.t().has_requester()) {
+      cl.push_back(CCSnpOpcode::WaitOnMsg);
+      execute(ctxt, cl);
+      return;
+    }
+    // Fetch nominated message queue
+    ctxt.set_mq(ctxt.t().winner());
+
+    const Message* msg = ctxt.msg();
+    switch (msg->cls()) {
+      case MessageClass::CohSnp: {
+        process_cohsnp(ctxt, cl);
+      } break;
+      case MessageClass::AceCmdRsp: {
+        process_in_flight(ctxt, cl);
+      } break;
+      case MessageClass::AceSnoopRsp: {
+        process_in_flight(ctxt, cl);
+      } break;
+      case MessageClass::DtRsp: {
+        // No snoop state is retained for the data response.
+        protocol()->apply(ctxt, cl);
+      } break;
+      default: {
+        using cc::to_string;
+
+        LogMessage lmsg("Invalid message class received: ");
+        lmsg.append(to_string(ctxt.msg()->cls()));
+        lmsg.set_level(Level::Fatal);
+        log(lmsg);
+      } break;
+    }
+    if (can_execute(cl)) {
+      LogMessage lm("Execute message: ");
+      lm.append(ctxt.msg()->to_string());
+      lm.set_level(Level::Debug);
+      log(lm);
+
+      execute(ctxt, cl);
+    }
+  }
+
+ private:
+  // Protocol instance, as its specialized type.
+  const ProtocolT* protocol() const {
+    return static_cast<const ProtocolT*>(model_->protocol());
+  }
+
+  void process_cohsnp(CCSnpContext& ctxt, CCSnpCommandList& cl) {
+    const ProtocolT* protocol = this->protocol();
+    // Where the directory has accepted a transaction to the line which
+    // has yet to complete, the snoop belongs to some later transaction
+    // and would otherwise overtake the response to the L2; block the
+    // snoop queue until the transaction has completed. The directory's
+    // response precedes the snoop, but may yet to have been applied
+    // where the response queue is backlogged. Similarly, a response
+    // issued to the L2 must be consumed before the snoop is issued,
+    // otherwise the snoop may overtake it; block until the response
+    // queue has drained.
+    const CohSnpMsg* msg = static_cast<const CohSnpMsg*>(ctxt.msg());
+    if (const MessageQueue* rsp_q = model_->cc_l2__rsp_q();
+        rsp_q->inflight_n() != 0 || !rsp_q->empty()) {
+      cl.push_back(cb::build_blocked_on_event(
+          ctxt.mq(), rsp_q->dequeue_event(),
+          BlockReason::TransactionInFlight));
+      cl.next_and_do_consume(false);
+      return;
+    }
+    for (const auto& p : *model_->tt()) {
+      const CCTState* st = p.second;
+      if (st->addr() != msg->addr()) continue;
+
+      if (protocol->is_accepted(st->line()) || has_cohcmdrsp(p.first)) {
+        cl.push_back(cb::build_blocked_on_event(
+            ctxt.mq(), st->transaction_end(),
+            BlockReason::TransactionInFlight));
+        cl.next_and_do_consume(false);
+        return;
+      }
+    }
+    CCSnpTState* tstate = new CCSnpTState;
+    tstate->set_line(protocol->construct_snp_line());
+    tstate->set_owns_line(true);
+    ctxt.set_tstate(tstate);
+    ctxt.set_owns_tstate(true);
+    protocol->apply(ctxt, cl);
+  }
+
+  // A coherence command response for transaction 't' has arrived but
+  // has yet to be applied.
+  bool has_cohcmdrsp(const Transaction* t) const {
+    const MessageQueue* mq = model_->mq_by_msg_cls(MessageClass::CohCmdRsp);
+    for (std::size_t i = 0; i < mq->size(); i++) {
+      const Message* msg = mq->peek(i);
+      if (msg->cls() == MessageClass::CohCmdRsp && msg->t() == t) return true;
+    }
+    return false;
+  }
+
+  void process_in_flight(CCSnpContext& ctxt, CCSnpCommandList& cl) {
+    CCSnpTTable* snp_tt = model_->snp_table();
+    const Message* msg = ctxt.msg();
+    if (auto it = snp_tt->find(msg->t()); it != snp_tt->end()) {
+      ctxt.set_tstate(it->second);
+      const ProtocolT* protocol = this->protocol();
+      protocol->apply(ctxt, cl);
+    } else {
+      LogMessage lm("Transaction not found in Transaction table.");
+      lm.set_level(Level::Fatal);
+      log(lm);
+    }
+  }
+};
+
+template <typename ProtocolT>
+CCAgent::RdisProcessBase* CCAgent::construct_rdis(kernel::Kernel* k,
+                                                  const std::string& name,
+                                                  CCAgent* model) {
+  return new RdisProcess<ProtocolT>(k, name, model);
+}
+
+template <typename ProtocolT>
+CCAgent::SnpProcessBase* CCAgent::construct_snp(kernel::Kernel* k,
+                                                const std::string& name,
+                                                CCAgent* model) {
+  return new SnpProcess<ProtocolT>(k, name, model);
+}
+
+// Cache controller agent specialized on the protocol type ProtocolT.
+//
+template <typename ProtocolT>
+class CCAgentT : public CCAgent {
+ public:
+  CCAgentT(kernel::Kernel* k, const CCAgentConfig& config)
+      : CCAgent(k, config, &CCAgent::construct_rdis<ProtocolT>,
+                &CCAgent::construct_snp<ProtocolT>) {}
+};
+
+}  // namespace cc
+
+#endif
@@ -41,6 +41,10 @@ const char* to_string(StimulusType t) {
       return "Trace";
     case StimulusType::Programmatic:
       return "Programmatic";
+    case StimulusType::BinaryTrace:
+      return "BinaryTrace";
+    case StimulusType::Synthetic:
+      return "Synthetic";
     case StimulusType::Invalid:
       return "Invalid";
     default:
@@ -48,4 +52,95 @@ const char* to_string(StimulusType t) {
   }
 }
 
+const char* to_string(AddrDistribution d) {
+  switch (d) {
+    case AddrDistribution::Uniform:
+      return "Uniform";
+    case AddrDistribution::Zipf:
+      return "Zipf";
+    case AddrDistribution::Strided:
+      return "Strided";
+    case AddrDistribution::PointerChase:
+      return "PointerChase";
+    default:
+      return "Unknown";
+  }
+}
+
+const char* to_string(SharingPattern p) {
+  switch (p) {
+    case SharingPattern::None:
+      return "None";
+    case SharingPattern::Producer:
+      return "Producer";
+    case SharingPattern::Consumer:
+      return "Consumer";
+    case SharingPattern::Migratory:
+      return "Migratory";
+    default:
+      return "Unknown";
+  }
+}
+
+const char* to_string(ArrivalDistribution d) {
+  switch (d) {
+    case ArrivalDistribution::Fixed:
+      return "Fixed";
+    case ArrivalDistribution::Uniform:
+      return "Uniform";
+    case ArrivalDistribution::Exponential:
+      return "Exponential";
+    default:
+      return "Unknown";
+  }
+}
+
+const char* to_string(SharerEncoding e) {
+  switch (e) {
+    case SharerEncoding::FullMap:
+      return "FullMap";
+    case SharerEncoding::LimitedPointer:
+      return "LimitedPointer";
+    case SharerEncoding::CoarseVector:
+      return "CoarseVector";
+    default:
+      return "Unknown";
+  }
+}
+
+const char* to_string(InterleaveType t) {
+  switch (t) {
+    case InterleaveType::Line:
+      return "Line";
+    case InterleaveType::Page:
+      return "Page";
+    case InterleaveType::Xor:
+      return "Xor";
+    default:
+      return "Unknown";
+  }
+}
+
+const char* to_string(DramPagePolicy p) {
+  switch (p) {
+    case DramPagePolicy::Open:
+      return "Open";
+    case DramPagePolicy::Closed:
+      return "Closed";
+    default:
+      return "Unknown";
+  }
+}
+
+const char* to_string(DramAddressMap m) {
+  switch (m) {
+    case DramAddressMap::RoRaBaChCo:
+      return "RoRaBaChCo";
+    case DramAddressMap::RoCoRaBaCh:
+      return "RoCoRaBaCh";
+    default:
+      return "Unknown";
+  }
+}
+
 }  // namespace cc
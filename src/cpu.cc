@@ -27,6 +27,7 @@
 
 #include "cpu.h"
 
+#include <algorithm>
 #include <exception>
 #include <sstream>
 
@@ -76,11 +77,15 @@ class Cpu::ProducerProcess : public kernel::Process {
     Frontier f;
     if (!stimulus->front(f)) return;
 
+    // Closed-loop mode: await retirement and think time.
+    if (cpu_->config().closed_loop && !closed_loop_can_issue(f)) return;
+
     MessageQueue* mq = cpu_->cpu_l1__cmd_q();
-    if (mq->full()) {
-      // Cpu issue queue has backpressured, therefore await notification
-      // that the queue has become non-full.
-      wait_on(mq->non_full_event());
+    if (!mq->has_at_least(1)) {
+      // Cpu issue queue has backpressured (including commands issued
+      // but yet to arrive), therefore await notification that an entry
+      // has been dequeued.
+      wait_on(mq->dequeue_event());
       return;
     }
 
@@ -90,8 +95,9 @@ class Cpu::ProducerProcess : public kernel::Process {
     CpuMonitor* monitor = cpu_->monitor();
     if (monitor != nullptr) { monitor->start_transaction_event(cpu_, t); }
     // Update statistics
-    CpuStatistics* stat = cpu_->statistics();
-    if (stat != nullptr) { stat->start_transaction_event(cpu_); }
+    if (CpuStatBlock* stats = cpu_->stats(); stats != nullptr) {
+      stats->issue_n.inc();
+    }
     
     // Free space in the issue queue, form a message and issue.
     L1CmdMsg* msg = Pool<L1CmdMsg>::construct();
@@ -101,18 +107,54 @@ class Cpu::ProducerProcess : public kernel::Process {
     msg->set_t(t);
     // Issue message
     mq->issue(msg);
+    const bool is_ld = (cmd.opcode() == CpuOpcode::Load);
+    if (t->handle() >= cpu_->is_ld_.size()) {
+      cpu_->is_ld_.resize(cpu_->ts()->capacity());
+    }
+    cpu_->is_ld_[t->handle()] = is_ld;
+    if (cpu_->config().closed_loop) {
+      // Command now occupies a slot in the MLP window.
+      ++cpu_->outstanding_n_;
+      if (is_ld) ++cpu_->outstanding_ld_n_;
+    }
     // Consume stimulus.
     stimulus->issue();
     if (stimulus->done()) {
       // Stimulus has been exhausted, wait until further stimulus has
       // arrived.
       wait_on(stimulus->non_empty_event());
+    } else if (cpu_->config().closed_loop) {
+      // Re-evaluate issue conditions for the next command.
+      next_delta();
       // Await next command
     } else if (stimulus->front(f)) {
       wait_until(f.time);
     }
   }
 
+  // Closed-loop issue conditions for command 'f'; returns true if the
+  // command may issue, otherwise schedules the process to re-evaluate
+  // once the blocking condition may have cleared.
+  bool closed_loop_can_issue(const Frontier& f) {
+    const CpuConfig& config = cpu_->config();
+    if (cpu_->outstanding_n_ >= config.mlp_n ||
+        (f.cmd.dep() && cpu_->outstanding_ld_n_ != 0)) {
+      // MLP window is full or command consumes the result of an
+      // outstanding Load; await retirement.
+      wait_on(cpu_->retire_event());
+      return false;
+    }
+    // Command issues no earlier than its stimulus time, or the
+    // conclusion of the think time after the most recent retirement.
+    const kernel::Time::time_type time =
+        std::max(f.time.time, cpu_->ready_time_);
+    if (k()->time().time < time) {
+      wait_until(kernel::Time{time, 0});
+      return false;
+    }
+    return true;
+  }
+
   // Point to process owner module.
   Cpu* cpu_ = nullptr;
 };
@@ -143,13 +185,25 @@ class Cpu::ConsumerProcess : public kernel::Process {
           const L1CmdRspMsg* l1rspmsg = static_cast<const L1CmdRspMsg*>(msg);
 
           Transaction* t = l1rspmsg->t();
+          t->stamp(TransactionStage::L1Rsp, k()->time());
 
           // Update monitor state
           CpuMonitor* monitor = cpu_->monitor();
           if (monitor != nullptr) monitor->end_transaction_event(cpu_, t);
           // Update statistics
-          CpuStatistics* stat = cpu_->statistics();
-          if (stat != nullptr) { stat->end_transaction_event(cpu_); }
+          if (CpuStatBlock* stats = cpu_->stats(); stats != nullptr) {
+            stats->retire_n.inc();
+            stats->record_latency(t, cpu_->is_ld_[t->handle()]);
+          }
+          if (cpu_->config().closed_loop) {
+            // Retirement frees a slot in the MLP window and starts the
+            // think time; wake the producer if blocked.
+            --cpu_->outstanding_n_;
+            if (cpu_->is_ld_[t->handle()]) --cpu_->outstanding_ld_n_;
+            cpu_->ready_time_ =
+                k()->time().time + cpu_->config().think_time;
+            cpu_->retire_event()->notify();
+          }
           // Transaction is complete.
           cpu_->end_transaction(t);
           l1rspmsg->release();
@@ -192,6 +246,7 @@ Cpu::~Cpu() {
   }
   delete stimulus_;
   delete l1_cpu__rsp_q_;
+  delete retire_event_;
 }
 
 // Construct CPU agent
@@ -199,6 +254,8 @@ void Cpu::build() {
   // Response queue
   l1_cpu__rsp_q_ = new MessageQueue(k(), "l1_cpu__rsp_q", 3);
   add_child_module(l1_cpu__rsp_q_);
+  // Retirement event
+  retire_event_ = new kernel::Event(k(), "retire_event");
 }
 
 // Set stimulus source for the CPU instance.
@@ -223,14 +280,11 @@ void Cpu::set_stimulus(StimulusContext* stimulus) {
 void Cpu::register_monitor(Monitor* monitor) {
   if (monitor == nullptr) return;
 
-  monitor->register_client(this);
+  monitor_index_ = monitor->register_client(this);
   monitor_ = monitor;
 }
 
 void Cpu::register_statistics(Statistics* statistics) {
-  if (statistics == nullptr) return;
-
-  statistics->register_client(this);
   statistics_ = statistics;
 }
 
@@ -246,32 +300,68 @@ void Cpu::drc() {
     const LogMessage msg("L1Cache has no associated stimulus.", Level::Warning);
     log(msg);
   }
+  if (config_.closed_loop && config_.mlp_n == 0) {
+    // Closed-loop CPU could never issue.
+    LogMessage msg("Closed-loop CPU has zero MLP window.");
+    msg.set_level(Level::Fatal);
+    log(msg);
+  }
+}
+
+void Cpu::reset() {
+  // Reclaim in-flight transactions.
+  while (Transaction* t = ts_.inflight_head()) ts_.free(t);
+  outstanding_n_ = 0;
+  outstanding_ld_n_ = 0;
+  ready_time_ = 0;
+}
+
+bool Cpu::elab() {
+  // Size transaction slab to the maximum number of transactions which
+  // may be in flight: the MLP window in closed-loop mode, otherwise
+  // the capacity of the L1 (command queue, replay queue, transaction
+  // table and response queue).
+  std::size_t n = 0;
+  if (config_.closed_loop) {
+    n = config_.mlp_n;
+  } else if (l1c_ != nullptr) {
+    const L1CacheAgentConfig& l1cfg = l1c_->config();
+    n = l1cfg.cpu_l1__cmd_n + l1cfg.replay__cmd_n + l1cfg.tt_entries_n +
+        l1_cpu__rsp_q_->n();
+  }
+  ts_.reserve(n);
+  is_ld_.resize(ts_.capacity());
+  // Bind statistics block.
+  if (statistics_ != nullptr) {
+    stats_ = statistics_->register_block<CpuStatBlock>(path());
+  }
+  return false;
 }
 
 Transaction* Cpu::start_transaction() {
-  Transaction* t = new Transaction;
+  Transaction* t = ts_.allocate();
   t->set_start_time(k()->time());
-  ts_.insert(t);
 
-  LogMessage msg("Transaction starts: ");
-  msg.append(t->to_string());
-  msg.set_level(Level::Info);
-  log(msg);
+  if (level() >= Level::Info) {
+    LogMessage msg("Transaction starts: ");
+    msg.append(t->to_string());
+    msg.set_level(Level::Info);
+    log(msg);
+  }
 
   return t;
 }
 
 void Cpu::end_transaction(Transaction* t) {
-  std::set<Transaction*>::iterator it = ts_.find(t);
-  if (it != ts_.end()) {
-    // TODO:
-    LogMessage msg("Transaction ends: ");
-    msg.append(t->to_string());
-    msg.set_level(Level::Info);
-    log(msg);
+  if (ts_.is_inflight(t)) {
+    if (level() >= Level::Info) {
+      LogMessage msg("Transaction ends: ");
+      msg.append(t->to_string());
+      msg.set_level(Level::Info);
+      log(msg);
+    }
 
-    (*it)->release();
-    ts_.erase(it);
+    ts_.free(t);
   } else {
     LogMessage lmsg("Unknown transaction consumed!");
     lmsg.set_level(Level::Fatal);
@@ -28,7 +28,7 @@
 #ifndef CC_SRC_CPU_H
 #define CC_SRC_CPU_H
 
-#include <set>
+#include <vector>
 
 #include "cc/cfgs.h"
 #include "cc/kernel.h"
@@ -46,7 +46,7 @@ class StimulusContext;
 class Monitor;
 class CpuMonitor;
 class Statistics;
-class CpuStatistics;
+struct CpuStatBlock;
 class Stimulus;
 
 //
@@ -56,6 +56,7 @@ class Cpu : public Agent {
   class ConsumerProcess;
 
   friend class CpuCluster;
+  friend class Monitor;
 
  public:
   Cpu(kernel::Kernel* k, const CpuConfig& config);
@@ -63,6 +64,8 @@ class Cpu : public Agent {
 
   // Cache configuration
   const CpuConfig& config() const { return config_; }
+  // Current stimulus context instance.
+  StimulusContext* stimulus() const { return stimulus_; }
 
  protected:
   // Accessors;
@@ -71,14 +74,16 @@ class Cpu : public Agent {
   MessageQueue* cpu_l1__cmd_q() const { return cpu_l1__cmd_q_; }
   // L1 -> CPU response queue (CPU owned)
   MessageQueue* l1_cpu__rsp_q() const { return l1_cpu__rsp_q_; }
-  // Current stimulus context instance.
-  StimulusContext* stimulus() const { return stimulus_; }
-  // Transaction table
-  std::set<Transaction*>* ts() { return &ts_; }
+  // Transaction slab
+  TransactionSlab* ts() { return &ts_; }
   // CPU monitor instance.
   CpuMonitor* monitor() const { return monitor_; }
-  // CPU statistics.
-  CpuStatistics* statistics() const { return statistics_; }
+  // Index of CPU within the monitor (where registered).
+  std::size_t monitor_index() const { return monitor_index_; }
+  // CPU statistics (nullptr if statistics are disabled).
+  CpuStatBlock* stats() const { return stats_; }
+  // Event notified upon retirement (closed-loop mode).
+  kernel::Event* retire_event() const { return retire_event_; }
 
   // Construction:
   void build();
@@ -94,9 +99,15 @@ class Cpu : public Agent {
   // Set CPU -> L1 command queue
   void set_cpu_l1__cmd_q(MessageQueue* mq);
 
+  // Elaboration:
+  bool elab() override;
+
   // Design Rule Check (DRC):
   void drc() override;
 
+  // Reset:
+  void reset() override;
+
   // Registry:
   Transaction* start_transaction();
   void end_transaction(Transaction* t);
@@ -114,12 +125,27 @@ class Cpu : public Agent {
   ConsumerProcess* cp_ = nullptr;
   // L1Cache instance.
   L1CacheAgent* l1c_ = nullptr;
-  // Transaction table.
-  std::set<Transaction*> ts_;
+  // Transaction slab.
+  TransactionSlab ts_;
   // CPU Monitor instance.
   CpuMonitor* monitor_ = nullptr;
+  // Index of CPU within the monitor.
+  std::size_t monitor_index_ = 0;
+  // Statistics registry
+  Statistics* statistics_ = nullptr;
   // CPU statistics
-  CpuStatistics* statistics_ = nullptr;
+  CpuStatBlock* stats_ = nullptr;
+  // Retirement event (closed-loop mode).
+  kernel::Event* retire_event_ = nullptr;
+  // Number of outstanding commands (closed-loop mode).
+  std::size_t outstanding_n_ = 0;
+  // Number of outstanding Loads (closed-loop mode).
+  std::size_t outstanding_ld_n_ = 0;
+  // Transaction is a Load, by handle.
+  std::vector<bool> is_ld_;
+  // Earliest time of next issue following think time after most
+  // recent retirement (closed-loop mode).
+  kernel::Time::time_type ready_time_ = 0;
   // CPU Configuration.
   CpuConfig config_;
 };
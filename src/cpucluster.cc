@@ -55,11 +55,13 @@ CpuCluster::~CpuCluster() {
 //
 void CpuCluster::build() {
   // Construct cache controller.
-  cc_ = new CCAgent(k(), config_.cc_config);
+  const CCAgentConfig& cc_cfg = config_.cc_config;
+  cc_ = cc_cfg.pbuilder->create_cc_agent(k(), cc_cfg);
   add_child_module(cc_);
 
   // Construct L2 cache instance.
-  l2c_ = new L2CacheAgent(k(), config_.l2c_config);
+  const L2CacheAgentConfig& l2c_cfg = config_.l2c_config;
+  l2c_ = l2c_cfg.pbuilder->create_l2_agent(k(), l2c_cfg);
   add_child_module(l2c_);
 
   // Construct L1 cache instance(s).
@@ -67,11 +69,12 @@ void CpuCluster::build() {
     const L1CacheAgentConfig& l1c_cfg = config_.l1c_configs[i];
 
     // L1 Cache Model
-    L1CacheAgent* l1c = new L1CacheAgent(k(), l1c_cfg);
+    L1CacheAgent* l1c = l1c_cfg.pbuilder->create_l1_agent(k(), l1c_cfg);
     l1cs_.push_back(l1c);
     add_child_module(l1c);
 
     // Create instance on L2 for new L1 cache.
+    l1c->set_l2_id(i);
     l2c_->add_l1c(l1c);
 
     // Construct associated CPU instance.
@@ -99,6 +102,8 @@ void CpuCluster::register_monitor(Monitor* monitor) {
 void CpuCluster::register_statistics(Statistics* statistics) {
   if (statistics == nullptr) return;
 
+  cc_->register_statistics(statistics);
+  l2c_->register_statistics(statistics);
   for (std::size_t i = 0; i < config_.l1c_configs.size(); i++) {
     l1cs_[i]->register_statistics(statistics);
     cpus_[i]->register_statistics(statistics);
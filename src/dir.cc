@@ -27,6 +27,8 @@
 
 #include "dir.h"
 
+#include "dir_process.h"
+
 #include <sstream>
 
 #include "amba.h"
@@ -36,6 +38,7 @@
 #include "noc.h"
 #include "primitives.h"
 #include "protocol.h"
+#include "stats.h"
 #include "utility.h"
 #include "verif.h"
 
@@ -106,9 +109,11 @@ DirCommand* DirCommandBuilder::from_action(DirCoherenceAction* action) {
 }
 
 DirCommand* DirCommandBuilder::build_blocked_on_event(MessageQueue* mq,
-                                                      kernel::Event* e) {
+                                                      kernel::Event* e,
+                                                      BlockReason reason) {
   DirCommand* cmd = new DirCommand(DirOpcode::MqSetBlockedOnEvt);
   cmd->set_event(e);
+  cmd->set_block_reason(reason);
   return cmd;
 }
 
@@ -211,7 +216,7 @@ struct TStateUpdateAction : public DirCoherenceAction {
         tstate_->set_snoop_i(0);
       } break;
       case TStateUpdateOpcode::IncSnoopI: {
-        tstate_->set_snoop_i(tstate_->snoop_n() + 1);
+        tstate_->set_snoop_i(tstate_->snoop_i() + 1);
       } break;
       case TStateUpdateOpcode::IncDt: {
         tstate_->set_dt_i(tstate_->dt_i() + 1);
@@ -292,15 +297,11 @@ bool DirTState::is_final_snoop(bool is_snoop_rsp) const {
 }
 
 std::size_t DirResources::coh_snp_n(const Agent* agent) const {
-  std::size_t n = 0;
-  if (auto it = coh_snp_n_.find(agent); it != coh_snp_n_.end()) {
-    n = it->second;
-  }
-  return n;
+  return coh_snp_n_.count(agent);
 }
 
 void DirResources::set_coh_snp_n(const Agent* agent, std::size_t n) {
-  coh_snp_n_[agent] = n;
+  coh_snp_n_.set(agent, n);
 }
 
 DirContext::~DirContext() {
@@ -409,7 +410,11 @@ class DirCommandInterpreter {
     tt->install(ctxt.msg()->t(), tstate);
     ctxt.set_owns_tstate(false);
 
-    if (ctxt.owns_line()) {
+    if (ctxt.owns_line() && model_->config().is_null_filter) {
+      // Null Filter; line is not retained beyond the lifetime of the
+      // transaction and is therefore not installed in the cache.
+      ctxt.set_owns_line(false);
+    } else if (ctxt.owns_line()) {
       // Install line in the dache.
       CacheModel<DirLineState*>* cache = model_->cache();
       const CacheAddressHelper ah = cache->ah();
@@ -436,12 +441,19 @@ class DirCommandInterpreter {
   }
 
   void execute_end_transaction(DirContext& ctxt, const DirCommand* cmd) {
+    if (DirStatBlock* stats = model_->stats(); stats != nullptr) {
+      count_transaction(stats, ctxt.tstate());
+    }
     // Notify transaction event event; unblocks message queues
     // awaiting completion of current transaction.
     ctxt.tstate()->transaction_end()->notify();
     // Delete transaction from transaction table.
     Table<Transaction*, DirTState*>* tt = model_->tt();
     tt->remove(ctxt.msg()->t());
+    if (model_->config().is_null_filter) {
+      // Null Filter line state is owned by the transaction.
+      ctxt.tstate()->line()->release();
+    }
     ctxt.tstate()->release();
   }
 
@@ -449,15 +461,83 @@ class DirCommandInterpreter {
     // Dequeue and release the head message of the currently
     // addressed Message Queue.
     const Message* msg = ctxt.mq()->dequeue();
+    if (Transaction* t = msg->t(); t != nullptr) {
+      if (msg->cls() == MessageClass::CohSrt) {
+        t->stamp(TransactionStage::CohSrt, model_->k()->time());
+      } else if (msg->cls() == MessageClass::CohCmd) {
+        t->stamp(TransactionStage::DirAccept, model_->k()->time());
+      }
+    }
+    if (DirStatBlock* stats = model_->stats(); stats != nullptr) {
+      count_msg(stats, msg);
+    }
     msg->release();
     ctxt.t().advance();
   }
 
+  // Update directory statistics upon consumption of message 'msg'.
+  static void count_msg(DirStatBlock* stats, const Message* msg) {
+    switch (msg->cls()) {
+      case MessageClass::CohCmd: {
+        stats->cmd_n.inc();
+        const CohCmdMsg* cmd = static_cast<const CohCmdMsg*>(msg);
+        if (cmd->opcode() == AceCmdOpcode::WriteBack ||
+            cmd->opcode() == AceCmdOpcode::Evict) {
+          stats->writeback_n.inc();
+        }
+      } break;
+      case MessageClass::CohSnpRsp: {
+        stats->snoop_rsp_n.inc();
+      } break;
+      case MessageClass::LLCCmdRsp: {
+        stats->llc_rsp_n.inc();
+      } break;
+      default: {
+      } break;
+    }
+  }
+
+  // Update directory line activity upon completion of transaction
+  // 'tstate'.
+  void count_transaction(DirStatBlock* stats, const DirTState* tstate) const {
+    bool is_write = false;
+    switch (tstate->opcode()) {
+      case AceCmdOpcode::ReadUnique:
+      case AceCmdOpcode::CleanUnique:
+      case AceCmdOpcode::MakeUnique:
+      case AceCmdOpcode::WriteUnique:
+      case AceCmdOpcode::WriteLineUnique: {
+        is_write = true;
+      } break;
+      case AceCmdOpcode::WriteBack:
+      case AceCmdOpcode::WriteClean:
+      case AceCmdOpcode::Evict:
+      case AceCmdOpcode::Recall:
+      case AceCmdOpcode::Invalid: {
+        // Not indicative of contention.
+        return;
+      } break;
+      default: {
+      } break;
+    }
+    const CacheAddressHelper ah = model_->cache()->ah();
+    const addr_t offset = ah.offset(tstate->addr());
+    stats->record_transaction(tstate->addr() - offset, offset,
+                              tstate->origin(), is_write,
+                              tstate->snoop_issue_n());
+  }
+
   void execute_remove_line(DirContext& ctxt, const DirCommand* cmd) {
+    // Line has not been installed in the cache (transaction completes
+    // in the same cycle in which it started, or the directory is a
+    // Null Filter); there is nothing to remove.
+    if (ctxt.owns_line() || model_->config().is_null_filter) return;
+
     CacheModel<DirLineState*>* cache = model_->cache();
     const CacheAddressHelper ah = cache->ah();
-    auto set = cache->set(ah.set(ctxt.addr()));
-    if (auto it = set.find(ah.tag(ctxt.addr())); it != set.end()) {
+    const addr_t addr = ctxt.tstate()->addr();
+    auto set = cache->set(ah.set(addr));
+    if (auto it = set.find(ah.tag(addr)); it != set.end()) {
       set.evict(it);
     } else {
       throw std::runtime_error("Cannot remove line, line is not present.");
@@ -472,17 +552,19 @@ class DirCommandInterpreter {
 
   void execute_mq_set_blocked_on_transaction(DirContext& ctxt,
                                              const DirCommand* cmd) {
-    ctxt.mq()->set_blocked_until(ctxt.tstate()->transaction_end());
+    ctxt.mq()->set_blocked_until(ctxt.tstate()->transaction_end(),
+                                 BlockReason::TransactionInFlight);
   }
 
   void execute_mq_set_blocked_on_table(DirContext& ctxt,
                                        const DirCommand* cmd) {
-    ctxt.mq()->set_blocked_until(model_->tt()->non_full_event());
+    ctxt.mq()->set_blocked_until(model_->tt()->non_full_event(),
+                                 BlockReason::TableFull);
   }
 
   void execute_mq_set_blocked_on_event(DirContext& ctxt,
                                        const DirCommand* cmd) {
-    ctxt.mq()->set_blocked_until(cmd->event());
+    ctxt.mq()->set_blocked_until(cmd->event(), cmd->block_reason());
   }
 
   void execute_wait_on_msg(DirContext& ctxt, const DirCommand* cmd) const {
@@ -517,6 +599,17 @@ void DirResources::build(const DirCommandList& cl) {
       case DirOpcode::StartTransaction: {
         tt_entry_n_++;
       } break;
+      case DirOpcode::InvokeCoherenceAction: {
+        // Accumulate the action requirements and tally the snoops it
+        // emits.
+        DirResources r;
+        cmd->action()->set_resources(r);
+        noc_credit_n_ += r.noc_credit_n();
+        for (const auto& p : r.coh_snp_n()) {
+          set_coh_snp_n(p.first, coh_snp_n(p.first) + p.second);
+          snoop_issue_n_ += p.second;
+        }
+      } break;
       default: {
         // No resources required.
       } break;
@@ -524,287 +617,147 @@ void DirResources::build(const DirCommandList& cl) {
   }
 }
 
-//
-//
-class DirAgent::RdisProcess : public AgentProcess {
-  using cb = DirCommandBuilder;
-
- public:
-  RdisProcess(kernel::Kernel* k, const std::string& name, DirAgent* model)
-      : AgentProcess(k, name), model_(model) {}
+DirAgent::RdisProcessBase::RdisProcessBase(kernel::Kernel* k,
+                                           const std::string& name,
+                                           DirAgent* model)
+    : AgentProcess(k, name), model_(model) {}
 
- private:
-  // Initialization
-  void init() override {
-    DirContext ctxt;
-    DirCommandList cl;
-    cl.push_back(cb::from_opcode(DirOpcode::WaitOnMsg));
-    execute(ctxt, cl);
-  }
-
-  // Evaluation
-  void eval() override {
-    MQArb* arb = model_->arb();
-
-    // Construct and initialize current processing context.
-    DirCommandList cl;
-    DirContext ctxt;
-    ctxt.set_t(arb->tournament());
-
-    // Check if requests are present, if not block until a new message
-    // arrives at the arbiter. Process should ideally not wake in the
-    // absence of requesters.
-    if (!ctxt.t().has_requester()) {
-      cl.push_back(cb::from_opcode(DirOpcode::WaitOnMsg));
-      execute(ctxt, cl);
-      return;
-    }
+void DirAgent::RdisProcessBase::init() {
+  using cb = DirCommandBuilder;
 
-    // Fetch nominated message queue
-    ctxt.set_mq(ctxt.t().winner());
-    ctxt.set_dir(model_);
+  DirContext ctxt;
+  DirCommandList cl;
+  cl.push_back(cb::from_opcode(DirOpcode::WaitOnMsg));
+  execute(ctxt, cl);
+}
 
-    // Dispatch to appropriate message class
-    const Message* msg = ctxt.msg();
-    switch (msg->cls()) {
-      case MessageClass::CohSrt: {
-        process(ctxt, cl, static_cast<const CohSrtMsg*>(msg));
-      } break;
-      case MessageClass::CohCmd: {
-        process_in_flight(ctxt, cl);
-      } break;
-      case MessageClass::LLCCmdRsp: {
-        process_in_flight(ctxt, cl);
-      } break;
-      case MessageClass::CohSnpRsp: {
-        process_in_flight(ctxt, cl);
-      } break;
-      default: {
-        using cc::to_string;
+void DirAgent::RdisProcessBase::check_resources(const DirContext& ctxt,
+                                                DirCommandList& cl) const {
+  using cb = DirCommandBuilder;
 
-        LogMessage lmsg("Invalid message class received: ");
-        lmsg.append(to_string(ctxt.msg()->cls()));
-        lmsg.set_level(Level::Error);
-        log(lmsg);
-      } break;
-    }
+  const DirResources res(cl);
 
-    check_resources(ctxt, cl);
+  bool has_resources = true;
 
-    LogMessage lm("Execute message: ");
-    lm.append(ctxt.msg()->to_string());
-    lm.set_level(Level::Debug);
-    log(lm);
+  DirStatBlock* stats = model_->stats();
 
-    execute(ctxt, cl);
-  }
-
-  void process(DirContext& ctxt, DirCommandList& cl, const CohSrtMsg* msg) {
-    DirTState* tstate = lookup_state_or_fatal(msg->t(), false);
-    if (tstate == nullptr) {
-      // Transaction state is not already installed in the table
-      // (otherwise error). Now, need to consider if the line is
-      // already installed in the directory.
-      tstate = lookup_state_by_addr(msg->addr());
-      if (tstate != nullptr) {
-        // Transaction already in progress for the current line,
-        // command must be blocked until the completion of the current
-        // command.
-        ctxt.set_tstate(tstate);
-        cl.push_back(DirOpcode::MqSetBlockedOnTransaction);
-        // Advance
-        cl.next_and_do_consume(false);
-      } else if (Table<Transaction*, DirTState*>* tt = model_->tt(); !tt->full()) {
-        // Transaction has not already been initiated, there is no
-        // pending transaction to this line, AND, there are free
-        // entries in the transaction table: the command can proceed
-        // with execution.
-        process_new_transaction(ctxt, cl, msg);
-      } else {
-        // Otherwise, a transaction is not in progress and the
-        // transaction is full, therefore block Message Queue until
-        // the transaction table becomes non-full.
-        cl.push_back(DirOpcode::MqSetBlockedOnTable);
-        // Advance
-        cl.next_and_do_consume(false);
-      }
-    } else {
-      // Transaction is already present in the transaction table;
-      // attempting to reinstall the transaction.
-      LogMessage msg("Transation is already present in table.");
-      msg.set_level(Level::Fatal);
-      log(msg);
-    }
+  // Check table resources
+  Table<Transaction*, DirTState*>* tt = model_->tt();
+  if (!tt->has_at_least(res.tt_entry_n())) {
+    cl.clear();
+    // Blocks on table occupancy; wait until table becomes free.
+    cl.push_back(DirOpcode::MqSetBlockedOnTable);
+    has_resources = false;
+    if (stats != nullptr) stats->table_stall_n.inc();
   }
 
-  void process_new_transaction(DirContext& ctxt, DirCommandList& cl,
-                               const CohSrtMsg* msg) const {
-    // Otherwise, if there are free entries in the transaction table,
-    // the transaction can proceed. Issue.  Search for the line in the
-    // directory cache; if present, proceed, if not install new line,
-    // if set is full, need to consider either evicting a line
-    // presently in an evictable state, or blocking until one of the
-    // transactions in the set completes.
-    CacheModel<DirLineState*>* cache = model_->cache();
-    const CacheAddressHelper ah = cache->ah();
-    const DirProtocol* protocol = model_->protocol();
-    // Construct new transactions state object.
-    DirTState* tstate = new DirTState(k());
-    tstate->set_addr(msg->addr());
-    tstate->set_origin(msg->origin());
-    ctxt.set_owns_tstate(true);
-    ctxt.set_tstate(tstate);
-    const addr_t set_id = ah.set(msg->addr());
-    auto set = cache->set(set_id);
-    if (auto it = set.find(ah.tag(tstate->addr())); it == set.end()) {
-      // Line is not present in the cache.
-      CacheModel<DirLineState*>::Evictor evictor;
-      if (auto p = evictor.nominate(set.begin(), set.end()); p.second) {
-        // Eviction required.
-        tstate->set_addr(ah.addr_from_set_tag(set_id, p.first->tag()));
-        tstate->set_line(p.first->t());
-        protocol->recall(ctxt, cl);
-      } else {
-        // Free line, or able to be evicted.
-        tstate->set_line(protocol->construct_line());
-        ctxt.set_owns_line(true);
-        // Execute protocol update.
-        protocol->apply(ctxt, cl);
-      }
-    } else {
-      // Otherwise, lookup the line and assign to the new tstate.
-      tstate->set_line(it->t());
-      // Execute protocol update.
-      protocol->apply(ctxt, cl);
-    }
-  }
+  // Flag denoting whether table resources had been attained.
+  const bool has_table_resources = has_resources;
 
-  void process_in_flight(DirContext& ctxt, DirCommandList& cl) const {
-    // Lookup transaction table or bail if not found.
-    const DirProtocol* protocol = model_->protocol();
-    DirTState* tstate = lookup_state_or_fatal(ctxt.msg()->t());
-    if (const Message* msg = ctxt.mq()->peek();
-        msg->cls() == MessageClass::CohCmd) {
-      // Grab anciliary state on the Coherence Command message.
-      const CohCmdMsg* coh = static_cast<const CohCmdMsg*>(msg);
-      tstate->set_addr(coh->addr());
-      tstate->set_opcode(coh->opcode());
-    }
-    ctxt.set_tstate(tstate);
-    protocol->apply(ctxt, cl);
+  // Check NOC credits
+  NocPort* port = model_->dir_noc__port();
+  if (CreditCounter* cc = port->ingress_cc(); cc->empty()) {
+    // No NOC credits, block.
+    cl.push_back(cb::build_blocked_on_event(ctxt.mq(), cc->credit_event(),
+                                            BlockReason::Credits));
+    has_resources = false;
   }
 
-  void check_resources(const DirContext& ctxt, DirCommandList& cl) const {
-    const DirResources res(cl);
-
-    bool has_resources = true;
-
-    // Check table resources
-    Table<Transaction*, DirTState*>* tt = model_->tt();
-    if (!tt->has_at_least(res.tt_entry_n())) {
+  // Check if the credit counter for {cls, agent} has at least 'n'
+  // credits.
+  auto check_credits = [&](MessageClass cls, const Agent* agent,
+                           std::size_t n) -> bool {
+    bool success = true;
+    // If a credit exists for the destination agent, credit count
+    // requirement must be attained, otherwise the requirement is ignored.
+    if (CreditCounter* cc = model_->cc_by_cls_agent(cls, agent);
+        cc != nullptr && cc->i() < n) {
       cl.clear();
-      // Blocks on table occupancy; wait until table becomes free.
-      cl.push_back(DirOpcode::MqSetBlockedOnTable);
-      has_resources = false;
+      cl.push_back(cb::build_blocked_on_event(ctxt.mq(), cc->credit_event(),
+                                              BlockReason::Credits));
+      success = false;
     }
+    return success;
+  };
 
-    // Check NOC credits
-    NocPort* port = model_->dir_noc__port();
-    if (CreditCounter* cc = port->ingress_cc(); cc->empty()) {
-      // No NOC credits, block.
-      cl.push_back(cb::build_blocked_on_event(ctxt.mq(), cc->credit_event()));
-      has_resources = false;
-    }
+  auto check_credit_counter = [&](MessageClass cls, const auto& res) {
+    if (!has_resources) return;
 
-    // Check if the credit counter for agent 'agent' has at least 'n'
-    // credits.
-    auto check_credits = [&](const auto& ccntrs, const Agent* agent,
-                             std::size_t n) -> bool {
-      bool success = true;
-      // If a credit exists for the destination agent, credit count
-      // requirement must be attained, otherwise the requirement is ignored.
-      if (auto it = ccntrs.find(agent); it != ccntrs.end()) {
-        CreditCounter* cc = it->second;
-        if (cc->i() < n) {
-          cl.clear();
-          cl.push_back(
-              cb::build_blocked_on_event(ctxt.mq(), cc->credit_event()));
-          success = false;
-        }
-      }
-      return success;
-    };
-
-    auto check_credit_counter = [&](MessageClass cls, const auto& res) {
-      if (!has_resources) return;
-
-      auto& ccntrs_map = model_->ccntrs_map();
-      if (auto it = ccntrs_map.find(cls); it != ccntrs_map.end()) {
-        for (const auto& resp : res) {
-          if (!check_credits(it->second, resp.first, resp.second)) {
-            has_resources = false;
-            break;
-          }
-        }
+    for (const auto& resp : res) {
+      if (!check_credits(cls, resp.first, resp.second)) {
+        has_resources = false;
+        break;
       }
-    };
-
-    // Check Coherence Snoop credits
-    check_credit_counter(MessageClass::CohSnp, res.coh_snp_n());
-
-    if (!has_resources) {
-      cl.push_back(DirOpcode::WaitNextEpoch);
     }
-  }
-
-  void execute(DirContext& ctxt, const DirCommandList& cl) {
-    try {
-      DirCommandInterpreter interpreter(k());
-      interpreter.set_dir(model_);
-      interpreter.set_process(this);
-      for (const DirCommand* cmd : cl) {
-        LogMessage lm("Executing command: ");
-        lm.append(cmd->to_string());
-        lm.set_level(Level::Debug);
-        log(lm);
-
-        interpreter.execute(ctxt, cmd);
-      }
-    } catch (const std::runtime_error& ex) {
-      LogMessage lm("Interpreter encountered an error: ");
-      lm.append(ex.what());
-      lm.set_level(Level::Fatal);
+  };
+
+  // Check Coherence Snoop credits
+  check_credit_counter(MessageClass::CohSnp, res.coh_snp_n());
+
+  if (!has_resources) {
+    cl.push_back(DirOpcode::WaitNextEpoch);
+    if (stats != nullptr && has_table_resources) stats->credit_stall_n.inc();
+  } else if (DirTState* tstate = ctxt.tstate(); tstate != nullptr) {
+    // Command list proceeds; account snoops issued by the transaction.
+    tstate->set_snoop_issue_n(tstate->snoop_issue_n() + res.snoop_issue_n());
+  }
+}
+
+void DirAgent::RdisProcessBase::execute(DirContext& ctxt,
+                                        const DirCommandList& cl) {
+  try {
+    DirCommandInterpreter interpreter(k());
+    interpreter.set_dir(model_);
+    interpreter.set_process(this);
+    for (const DirCommand* cmd : cl) {
+      LogMessage lm("Executing command: ");
+      lm.append(cmd->to_string());
+      lm.set_level(Level::Debug);
       log(lm);
+
+      interpreter.execute(ctxt, cmd);
     }
+  } catch (const std::runtime_error& ex) {
+    LogMessage lm("Interpreter encountered an error: ");
+    lm.append(ex.what());
+    lm.set_level(Level::Fatal);
+    log(lm);
   }
+}
 
-  DirTState* lookup_state_or_fatal(Transaction* t,
-                                   bool allow_fatal = true) const {
-    Table<Transaction*, DirTState*>* tt = model_->tt();
-    DirTState* st = nullptr;
-    if (auto it = tt->find(t); it != tt->end()) {
-      st = it->second;
-    } else if (allow_fatal) {
-      // Expect to find a entry in the transaction table. If an entry
-      // is not present bail.
-      LogMessage msg("Transaction not found in table.");
-      msg.set_level(Level::Fatal);
-      log(msg);
-    }
-    return st;
+DirTState* DirAgent::RdisProcessBase::lookup_state_or_fatal(
+    Transaction* t, bool allow_fatal) const {
+  Table<Transaction*, DirTState*>* tt = model_->tt();
+  DirTState* st = nullptr;
+  if (auto it = tt->find(t); it != tt->end()) {
+    st = it->second;
+  } else if (allow_fatal) {
+    // Expect to find a entry in the transaction table. If an entry
+    // is not present bail.
+    LogMessage msg("Transaction not found in table.");
+    msg.set_level(Level::Fatal);
+    log(msg);
   }
+  return st;
+}
 
-  DirTState* lookup_state_by_addr(addr_t addr) const {
-    for (auto p : *model_->tt()) {
-      DirTState* entry = p.second;
-      if (entry->addr() == addr) return entry;
-    }
-    return nullptr;
+DirTState* DirAgent::RdisProcessBase::lookup_state_by_addr(addr_t addr) const {
+  const CacheAddressHelper ah = model_->cache()->ah();
+  for (auto p : *model_->tt()) {
+    DirTState* entry = p.second;
+    if (ah.line_id(entry->addr()) == ah.line_id(addr)) return entry;
   }
+  return nullptr;
+}
 
-  // Pointer to parent directory instance.
-  DirAgent* model_ = nullptr;
-};
+DirTState* DirAgent::RdisProcessBase::lookup_state_by_line(
+    const DirLineState* line) const {
+  for (auto p : *model_->tt()) {
+    DirTState* entry = p.second;
+    if (entry->line() == line) return entry;
+  }
+  return nullptr;
+}
 
 // NOC Endpoint class to accept a message from the NOC and forward the
 // message to the appropriate message queue. Nominally, this is done
@@ -820,25 +773,19 @@ class DirNocEndpoint : public NocEndpoint {
   //
   void register_endpoint(MessageClass cls, MessageQueue* mq) {
     // Register/install {cls} -> Message Queue mapping
-    cls_eps_.insert(std::make_pair(cls, mq));
+    cls_eps_[static_cast<std::size_t>(cls)] = mq;
   }
 
   void register_endpoint(MessageClass cls, const Agent* origin,
                          MessageQueue* mq) {
     // Register/install {cls, origin} -> Message Queue mapping
-    origin_eps_[cls][origin] = mq;
+    origin_eps_.install(cls, origin, mq);
   }
 
   // Lookup canonical MessageClass to MessageQueue mapping.
   MessageQueue* lookup_endpoint(MessageClass cls, const Agent* origin) const {
-    MessageQueue* mq = nullptr;
-    if (const auto it = cls_eps_.find(cls); it != cls_eps_.end()) {
-      mq = it->second;
-    } else if (const auto jt = origin_eps_.find(cls); jt != origin_eps_.end()) {
-      if (const auto kt = jt->second.find(origin); kt != jt->second.end()) {
-        mq = kt->second;
-      }
-    }
+    MessageQueue* mq = cls_eps_[static_cast<std::size_t>(cls)];
+    if (mq == nullptr) mq = origin_eps_.lookup(cls, origin);
     return mq;
   }
 
@@ -857,14 +804,18 @@ class DirNocEndpoint : public NocEndpoint {
 
  private:
   // {Cls} -> Message Queue mapping
-  std::map<MessageClass, MessageQueue*> cls_eps_;
+  std::array<MessageQueue*, message_class_n> cls_eps_{};
   // {Cls, Origin} -> Message Queue mapping
-  std::map<MessageClass, std::map<const Agent*, MessageQueue*> > origin_eps_;
+  AgentClassTable<MessageQueue> origin_eps_;
 };
 
 DirAgent::DirAgent(kernel::Kernel* k, const DirAgentConfig& config)
+    : DirAgent(k, config, &construct_rdis<DirProtocol>) {}
+
+DirAgent::DirAgent(kernel::Kernel* k, const DirAgentConfig& config,
+                   rdis_factory f)
     : Agent(k, config.name), config_(config) {
-  build();
+  build(f);
 }
 
 DirAgent::~DirAgent() {
@@ -873,6 +824,7 @@ DirAgent::~DirAgent() {
   }
   delete llc_dir__rsp_q_;
   delete cc_dir__snprsp_q_;
+  delete mem_dir__rsp_q_;
   delete arb_;
   delete cache_;
   delete noc_endpoint_;
@@ -880,20 +832,21 @@ DirAgent::~DirAgent() {
   delete protocol_;
   delete tt_;
   // Destroy credit counters.
-  for (const auto& cls_dest_cc : ccntrs_map_) {
-    for (const auto& dest_cc : cls_dest_cc.second) {
-      delete dest_cc.second;
-    }
-  }
+  ccntrs_.for_each([](CreditCounter* cc) { delete cc; });
 }
 
-void DirAgent::build() {
+void DirAgent::build(rdis_factory f) {
   // LLC -> DIR command queue
   llc_dir__rsp_q_ = new MessageQueue(k(), "llc_dir__rsp_q", 30);
   add_child_module(llc_dir__rsp_q_);
   // CC -> DIR snoop response queue.
   cc_dir__snprsp_q_ = new MessageQueue(k(), "cc_dir__snprsp_q", 30);
   add_child_module(cc_dir__snprsp_q_);
+  if (config_.is_null_filter) {
+    // MEM -> DIR response queue.
+    mem_dir__rsp_q_ = new MessageQueue(k(), "mem_dir__rsp_q", 30);
+    add_child_module(mem_dir__rsp_q_);
+  }
   // Construct arbiter
   arb_ = new MQArb(k(), "arb");
   add_child_module(arb_);
@@ -908,21 +861,27 @@ void DirAgent::build() {
   noc_endpoint_->set_epoch(config_.epoch);
   add_child_module(noc_endpoint_);
   // Construct request dispatcher thread
-  rdis_proc_ = new RdisProcess(k(), "rdis", this);
+  rdis_proc_ = f(k(), "rdis", this);
   rdis_proc_->set_epoch(config_.epoch);
   add_child_process(rdis_proc_);
   // Setup protocol
   protocol_ = config_.pbuilder->create_dir(k());
   add_child_module(protocol_);
+  // Setup sharer tracking
+  sharer_domain_.set_encoding(config_.sharer_encoding,
+                              config_.sharer_pointer_n,
+                              config_.sharer_group_n);
+  protocol_->set_sharer_domain(&sharer_domain_);
 }
 
 // Register (add) a child command queue.
 //
-void DirAgent::register_command_queue(const Agent* origin) {
+void DirAgent::register_command_queue(Agent* origin) {
   const std::string name = "cmdq" + std::to_string(cc_dir__cmd_q_.size());
   MessageQueue* mq = new MessageQueue(k(), name, config_.cmd_queue_n);
   add_child_module(mq);
   cc_dir__cmd_q_.insert(std::make_pair(origin, mq));
+  sharer_domain_.register_agent(origin);
 }
 
 // Register a verification monitor instance.
@@ -933,6 +892,12 @@ void DirAgent::register_monitor(Monitor* monitor) {
   monitor->register_client(this);
 }
 
+// Register statistics registry.
+//
+void DirAgent::register_statistics(Statistics* statistics) {
+  statistics_ = statistics;
+}
+
 // Elaborate Directory model
 //
 bool DirAgent::elab() {
@@ -943,6 +908,9 @@ bool DirAgent::elab() {
   }
   arb_->add_requester(llc_dir__rsp_q_);
   arb_->add_requester(cc_dir__snprsp_q_);
+  if (mem_dir__rsp_q_ != nullptr) {
+    arb_->add_requester(mem_dir__rsp_q_);
+  }
 
   // Register message queue end-points to NOC ingress
   for (auto& p : cc_dir__cmd_q_) {
@@ -954,7 +922,16 @@ bool DirAgent::elab() {
   }
   noc_endpoint_->register_endpoint(MessageClass::LLCCmdRsp, llc_dir__rsp_q_);
   noc_endpoint_->register_endpoint(MessageClass::CohSnpRsp, cc_dir__snprsp_q_);
+  if (mem_dir__rsp_q_ != nullptr) {
+    noc_endpoint_->register_endpoint(MessageClass::MemRsp, mem_dir__rsp_q_);
+  }
 
+  // Bind statistics block.
+  if (statistics_ != nullptr) {
+    stats_ = statistics_->register_block<DirStatBlock>(path());
+    stats_->bind_cache(cache_->stats());
+    stats_->hot_lines.set_offset_bits(cache_->ah().offset_bits());
+  }
   return false;
 }
 
@@ -970,6 +947,21 @@ void DirAgent::drc() {
     LogMessage lmsg("Dir to NOC message queue is unbound.", Level::Fatal);
     log(lmsg);
   }
+  if (config_.is_null_filter && mcs_.empty()) {
+    LogMessage lmsg("Null Filter has no memory controllers bound.",
+                    Level::Fatal);
+    log(lmsg);
+  }
+  if (const char* reason = sharer_domain_.validate(); reason != nullptr) {
+    LogMessage lmsg(reason, Level::Fatal);
+    log(lmsg);
+  }
+}
+
+void DirAgent::reset() {
+  // Reclaim line and transaction state.
+  cache_->reset([](DirLineState* line) { line->release(); });
+  for (const auto& p : *tt_) p.second->release();
 }
 
 void DirAgent::register_credit_counter(MessageClass cls, Agent* dest,
@@ -980,8 +972,14 @@ void DirAgent::register_credit_counter(MessageClass cls, Agent* dest,
   CreditCounter* cc = new CreditCounter(k(), name);
   cc->set_n(n);
   add_child_module(cc);
+  if (dest->id() == Agent::npos) {
+    LogMessage msg("Credit counter destination has no agent id: ");
+    msg.append(dest->path());
+    msg.set_level(Level::Fatal);
+    log(msg);
+  }
   // Install credit counter.
-  ccntrs_map_[cls].insert(std::make_pair(dest, cc));
+  ccntrs_.install(cls, dest, cc);
 }
 
 MessageQueue* DirAgent::endpoint() { return noc_endpoint_->ingress_mq(); }
@@ -991,11 +989,8 @@ CreditCounter* DirAgent::cc_by_cls_agent(MessageClass cls,
   CreditCounter* ret = nullptr;
   if (cls == MessageClass::Noc) {
     ret = dir_noc__port_->ingress_cc();
-  } else if (auto i = ccntrs_map_.find(cls); i != ccntrs_map_.end()) {
-    const auto& agent_cc_map = i->second;
-    if (auto j = agent_cc_map.find(agent); j != agent_cc_map.end()) {
-      ret = j->second;
-    }
+  } else {
+    ret = ccntrs_.lookup(cls, agent);
   }
   return ret;
 }
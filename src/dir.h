@@ -35,12 +35,15 @@
 #include "cc/kernel.h"
 #include "cc/types.h"
 #include "msg.h"
+#include "protocol.h"
 #include "sim.h"
+#include "utility.h"
 
 namespace cc {
 
 // Forwards
 class LLCAgent;
+class MemCntrlAgent;
 class DirAgent;
 class DirLineState;
 class NocPort;
@@ -51,6 +54,8 @@ class DirNocEndpoint;
 class DirResources;
 class DirProtocol;
 class Monitor;
+class Statistics;
+struct DirStatBlock;
 
 enum class DirOpcode {
 
@@ -117,11 +122,17 @@ class DirCommand {
   // Event oprand associated with command.
   kernel::Event* event() const { return oprands.e; }
 
+  // Reason for which the Message Queue is blocked on event.
+  BlockReason block_reason() const { return oprands.block_reason; }
+
   // Setters:
 
   // Set (blocked on) event instance
   void set_event(kernel::Event* e) { oprands.e = e; }
 
+  // Set reason for which the Message Queue is blocked on event.
+  void set_block_reason(BlockReason r) { oprands.block_reason = r; }
+
   // Set (error) reason message
   void set_reason(const std::string& reason) { oprands.reason = reason; }
 
@@ -136,6 +147,9 @@ class DirCommand {
     // Event oprand
     kernel::Event* e = nullptr;
 
+    // Blocked on event reason
+    BlockReason block_reason = BlockReason::Other;
+
     // Error reason message
     std::string reason;
   } oprands;
@@ -156,7 +170,8 @@ class DirCommandBuilder {
   static DirCommand* from_action(DirCoherenceAction* action);
 
   // Construct blocked on event instance.
-  static DirCommand* build_blocked_on_event(MessageQueue* mq, kernel::Event* e);
+  static DirCommand* build_blocked_on_event(MessageQueue* mq, kernel::Event* e,
+                                            BlockReason reason);
 
   // Construct error command instance.
   static DirCommand* build_error(const std::string& reason);
@@ -213,7 +228,8 @@ class DirCoherenceAction {
   // Invoke/Execute coherence action
   virtual bool execute() = 0;
 
-  virtual void release() { delete this; }
+  // Release action back to pool, or destruct.
+  virtual void release() const { delete this; }
 
  protected:
   virtual ~DirCoherenceAction() = default;
@@ -271,6 +287,9 @@ class DirTState {
   // The total number of snoop responses received.
   std::size_t snoop_i() const { return snoop_i_; }
 
+  // The total number of snoops issued.
+  std::size_t snoop_issue_n() const { return snoop_issue_n_; }
+
   // Data Transfer count associated with current transaction.
   std::size_t dt_i() const { return dt_i_; }
 
@@ -304,6 +323,9 @@ class DirTState {
   // Set number of snoop commands (received so far).
   void set_snoop_i(std::size_t snoop_i) { snoop_i_ = snoop_i; }
 
+  // Set number of snoop commands (issued so far).
+  void set_snoop_issue_n(std::size_t n) { snoop_issue_n_ = n; }
+
   // Set Data Transfer flag count.
   void set_dt_i(std::size_t dt_i) { dt_i_ = dt_i; }
 
@@ -356,6 +378,9 @@ class DirTState {
   // The total number of snoop responses received.
   std::size_t snoop_i_ = 0;
 
+  // The total number of snoops issued.
+  std::size_t snoop_issue_n_ = 0;
+
   // The total number of data transfers
   std::size_t dt_i_ = 0;
 
@@ -374,7 +399,7 @@ class DirTState {
 // given CommandList
 //
 class DirResources {
-  using key_map = std::map<const Agent*, std::size_t>;
+  using key_map = AgentCounts;
 
  public:
   // Construct (compute) resource set required by CommandList.
@@ -395,6 +420,9 @@ class DirResources {
   // Agent to credit count map.
   const key_map& coh_snp_n() const { return coh_snp_n_; }
 
+  // Total number of snoops emitted by the command list.
+  std::size_t snoop_issue_n() const { return snoop_issue_n_; }
+
   // Setters:
 
   // Set NOC credit count.
@@ -404,6 +432,9 @@ class DirResources {
   void set_coh_snp_n(const Agent* agent, std::size_t n);
 
  private:
+  // Empty resource set.
+  DirResources() = default;
+
   // Compute resource set.
   void build(const DirCommandList& cl);
 
@@ -413,6 +444,8 @@ class DirResources {
   std::size_t noc_credit_n_ = 0;
   // Coherence snoops requires to agent.
   key_map coh_snp_n_;
+  // Snoops emitted.
+  std::size_t snoop_issue_n_ = 0;
 };
 
 //
@@ -530,11 +563,11 @@ class DirAgent : public Agent {
   friend class SocTop;
   friend class DirCommandInterpreter;
 
+  class RdisProcessBase;
+  template <typename>
   class RdisProcess;
 
  public:
-  using ccntr_map = std::map<const Agent*, CreditCounter*>;
-
   DirAgent(kernel::Kernel* k, const DirAgentConfig& config);
   ~DirAgent();
 
@@ -546,6 +579,9 @@ class DirAgent : public Agent {
   // LLC owned by current directory
   LLCAgent* llc() const { return llc_; }
 
+  // Home memory controller of line 'addr' (Null Filter case).
+  MemCntrlAgent* mc(addr_t addr) const { return mcs_[mc_il_.index(addr)]; }
+
   // NOC -> DIR message queue
   MessageQueue* endpoint();
 
@@ -558,11 +594,6 @@ class DirAgent : public Agent {
   // Transaction table.
   Table<Transaction*, DirTState*>* tt() const { return tt_; }
 
-  // Credit Counters
-  const std::map<MessageClass, ccntr_map>& ccntrs_map() const {
-    return ccntrs_map_;
-  }
-
   // Lookup Credit Counter by Message Class and agent
   CreditCounter* cc_by_cls_agent(MessageClass cls, const Agent* agent) const;
 
@@ -574,20 +605,44 @@ class DirAgent : public Agent {
   const CacheModel<DirLineState*>* cache() const { return cache_; }
 
  protected:
+  // Request dispatcher process factory.
+  using rdis_factory = RdisProcessBase* (*)(kernel::Kernel*, const std::string&,
+                                            DirAgent*);
+
+  // Construct agent where the request dispatcher is constructed by 'f'.
+  DirAgent(kernel::Kernel* k, const DirAgentConfig& config, rdis_factory f);
+
+  // Construct request dispatcher specialized on protocol ProtocolT.
+  template <typename ProtocolT>
+  static RdisProcessBase* construct_rdis(kernel::Kernel* k,
+                                         const std::string& name,
+                                         DirAgent* model);
 
   // Build
-  void build();
+  void build(rdis_factory f);
 
   // Build phase; register new command queue (belonging to
-  // a distinct cache controller instance.
-  void register_command_queue(const Agent* origin);
+  // a distinct cache controller instance), and assign the cache
+  // controller an index in the sharer domain.
+  void register_command_queue(Agent* origin);
 
   // Register verification monitor.
   void register_monitor(Monitor* monitor);
 
+  // Register statistics.
+  void register_statistics(Statistics* statistics);
+
   // Set asscoiated LLC instance.
   void set_llc(LLCAgent* llc) { llc_ = llc; }
 
+  // Set memory controllers (Null Filter case); lines are interleaved
+  // across controllers as per 'cfg'.
+  void set_mcs(const std::vector<MemCntrlAgent*>& mcs,
+               const InterleaveConfig& cfg) {
+    mcs_ = mcs;
+    mc_il_ = AddrInterleaver(cfg, mcs.size());
+  }
+
   // Elaboration
   bool elab() override;
 
@@ -601,6 +656,9 @@ class DirAgent : public Agent {
   // Design Rule Check (DRC)
   void drc() override;
 
+  // Reset
+  void reset() override;
+
   // accessor(s)
 
   // Directory arbiter instance.
@@ -609,6 +667,12 @@ class DirAgent : public Agent {
   // Point to module cache instance.
   CacheModel<DirLineState*>* cache() { return cache_; }
 
+  // Directory statistics (nullptr if statistics are disabled).
+  DirStatBlock* stats() const { return stats_; }
+
+  // Cache controllers tracked by the directory.
+  const SharerDomain& sharer_domain() const { return sharer_domain_; }
+
  private:
   // Queue selection arbiter
   MQArb* arb_ = nullptr;
@@ -625,18 +689,27 @@ class DirAgent : public Agent {
   // CC -> DIR snoop response queue.
   MessageQueue* cc_dir__snprsp_q_ = nullptr;
 
-  // Agent credit counters (keyed on Message class)
-  std::map<MessageClass, ccntr_map> ccntrs_map_;
+  // MEM -> DIR response queue (Null Filter case).
+  MessageQueue* mem_dir__rsp_q_ = nullptr;
+
+  // Agent credit counters (keyed on Message class and agent id)
+  AgentClassTable<CreditCounter> ccntrs_;
 
   // NOC endpoint
   DirNocEndpoint* noc_endpoint_ = nullptr;
 
   // request dispatcher process
-  RdisProcess* rdis_proc_ = nullptr;
+  RdisProcessBase* rdis_proc_ = nullptr;
 
   // Last Level Cache instance (where applicable).
   LLCAgent* llc_ = nullptr;
 
+  // Memory controllers (Null Filter case).
+  std::vector<MemCntrlAgent*> mcs_;
+
+  // Line address to memory controller index map.
+  AddrInterleaver mc_il_;
+
   // Transaction table
   Table<Transaction*, DirTState*>* tt_ = nullptr;
 
@@ -646,9 +719,18 @@ class DirAgent : public Agent {
   // Coherence protocol
   DirProtocol* protocol_ = nullptr;
 
+  // Cache controllers tracked by the directory.
+  SharerDomain sharer_domain_;
+
   // Verification monitor instance, where applicable.
   Monitor* monitor_ = nullptr;
 
+  // Statistics registry
+  Statistics* statistics_ = nullptr;
+
+  // Directory statistics
+  DirStatBlock* stats_ = nullptr;
+
   // Current directory configuration.
   DirAgentConfig config_;
 };
@@ -680,6 +762,28 @@ class SingleDirMapper : public DirMapper {
   DirAgent* dm_ = nullptr;
 };
 
+// Directory mapper class used in the multiple directory case.
+// Lines are distributed across directories according to the
+// interleave configuration (by line, by page or XOR-hashed).
+//
+class InterleavedDirMapper : public DirMapper {
+ public:
+  InterleavedDirMapper(const std::vector<DirAgent*>& dms,
+                       const InterleaveConfig& cfg)
+      : dms_(dms), il_(cfg, dms.size()) {}
+
+  DirAgent* lookup(addr_t addr) const override {
+    return dms_[il_.index(addr)];
+  }
+
+ private:
+  // Dir end-point definitions.
+  std::vector<DirAgent*> dms_;
+
+  // Address to directory index map.
+  AddrInterleaver il_;
+};
+
 }  // namespace cc
 
 #endif
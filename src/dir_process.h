@@ -0,0 +1,339 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#ifndef CC_SRC_DIR_PROCESS_H
+#define CC_SRC_DIR_PROCESS_H
+
+#include "cache.h"
+#include "dir.h"
+#include "protocol.h"
+#include "utility.h"
+
+namespace cc {
+
+// Protocol independent component of the directory request dispatcher
+// process.
+//
+class DirAgent::RdisProcessBase : public AgentProcess {
+ public:
+  RdisProcessBase(kernel::Kernel* k, const std::string& name,
+                  DirAgent* model);
+
+ protected:
+  // Initialization
+  void init() override;
+
+  // Permute command list 'cl' to a wait list if the agent has
+  // insufficient resources to execute it.
+  void check_resources(const DirContext& ctxt, DirCommandList& cl) const;
+
+  // Execute command list 'cl'.
+  void execute(DirContext& ctxt, const DirCommandList& cl);
+
+  // Lookup transaction state for 't'; fatal if not present and
+  // 'allow_fatal'.
+  DirTState* lookup_state_or_fatal(Transaction* t,
+                                   bool allow_fatal = true) const;
+
+  // Lookup transaction state of any in-flight transaction to 'addr'.
+  DirTState* lookup_state_by_addr(addr_t addr) const;
+
+  // Lookup transaction state of any in-flight transaction to 'line'.
+  DirTState* lookup_state_by_line(const DirLineState* line) const;
+
+  // Pointer to parent directory instance.
+  DirAgent* model_ = nullptr;
+};
+
+// Directory request dispatcher process specialized on the protocol
+// type (see L1CacheAgent::MainProcess).
+//
+template <typename ProtocolT>
+class DirAgent::RdisProcess : public DirAgent::RdisProcessBase {
+  using cb = DirCommandBuilder;
+
+ public:
+  RdisProcess(kernel::Kernel* k, const std::string& name, DirAgent* model)
+      : RdisProcessBase(k, name, model) {}
+
+ private:
+  // Protocol instance, as its specialized type.
+  const ProtocolT* protocol() const {
+    return static_cast<const ProtocolT*>(model_->protocol());
+  }
+
+  // Evaluation
+  void eval() override {
+    MQArb* arb = model_->arb();
+
+    // Construct and initialize current processing context.
+    DirCommandList cl;
+    DirContext ctxt;
+    ctxt.set_t(arb->tournament());
+
+    // Check if requests are present, if not block until a new message
+    // arrives at the arbiter. Process should ideally not wake in the
+    // absence of requesters.
+    if (!ctxt.t().has_requester()) {
+      cl.push_back(cb::from_opcode(DirOpcode::WaitOnMsg));
+      execute(ctxt, cl);
+      return;
+    }
+
+    // Fetch nominated message queue
+    ctxt.set_mq(ctxt.t().winner());
+    ctxt.set_dir(model_);
+
+    // Dispatch to appropriate message class
+    const Message* msg = ctxt.msg();
+    switch (msg->cls()) {
+      case MessageClass::CohSrt: {
+        process(ctxt, cl, static_cast<const CohSrtMsg*>(msg));
+      } break;
+      case MessageClass::CohCmd: {
+        process_in_flight(ctxt, cl);
+      } break;
+      case MessageClass::LLCCmdRsp: {
+        process_in_flight(ctxt, cl);
+      } break;
+      case MessageClass::CohSnpRsp: {
+        process_in_flight(ctxt, cl);
+      } break;
+      case MessageClass::MemRsp: {
+        process_in_flight(ctxt, cl);
+      } break;
+      default: {
+        using cc::to_string;
+
+        LogMessage lmsg("Invalid message class received: ");
+        lmsg.append(to_string(ctxt.msg()->cls()));
+        lmsg.set_level(Level::Error);
+        log(lmsg);
+      } break;
+    }
+
+    check_resources(ctxt, cl);
+
+    LogMessage lm("Execute message: ");
+    lm.append(ctxt.msg()->to_string());
+    lm.set_level(Level::Debug);
+    log(lm);
+
+    execute(ctxt, cl);
+  }
+
+  void process(DirContext& ctxt, DirCommandList& cl, const CohSrtMsg* msg) {
+    DirTState* tstate = lookup_state_or_fatal(msg->t(), false);
+    if (tstate == nullptr) {
+      // Transaction state is not already installed in the table
+      // (otherwise error). Now, need to consider if the line is
+      // already installed in the directory.
+      tstate = lookup_state_by_addr(msg->addr());
+      if (tstate != nullptr) {
+        // Transaction already in progress for the current line,
+        // command must be blocked until the completion of the current
+        // command.
+        ctxt.set_tstate(tstate);
+        cl.push_back(DirOpcode::MqSetBlockedOnTransaction);
+        // Advance
+        cl.next_and_do_consume(false);
+      } else if (Table<Transaction*, DirTState*>* tt = model_->tt(); !tt->full()) {
+        // Transaction has not already been initiated, there is no
+        // pending transaction to this line, AND, there are free
+        // entries in the transaction table: the command can proceed
+        // with execution.
+        process_new_transaction(ctxt, cl, msg);
+      } else {
+        // Otherwise, a transaction is not in progress and the
+        // transaction is full, therefore block Message Queue until
+        // the transaction table becomes non-full.
+        cl.push_back(DirOpcode::MqSetBlockedOnTable);
+        // Advance
+        cl.next_and_do_consume(false);
+      }
+    } else {
+      // Transaction is already present in the transaction table;
+      // attempting to reinstall the transaction.
+      LogMessage msg("Transation is already present in table.");
+      msg.set_level(Level::Fatal);
+      log(msg);
+    }
+  }
+
+  void process_new_transaction(DirContext& ctxt, DirCommandList& cl,
+                               const CohSrtMsg* msg) const {
+    // Otherwise, if there are free entries in the transaction table,
+    // the transaction can proceed. Issue.  Search for the line in the
+    // directory cache; if present, proceed, if not install new line,
+    // if set is full, need to consider either evicting a line
+    // presently in an evictable state, or blocking until one of the
+    // transactions in the set completes.
+    CacheModel<DirLineState*>* cache = model_->cache();
+    const CacheAddressHelper ah = cache->ah();
+    const ProtocolT* protocol = this->protocol();
+    if (DirTState* inflight = lookup_victim_in_flight(msg);
+        inflight != nullptr) {
+      // A line must be evicted from the set before the command can
+      // proceed, but every candidate line presently has a transaction
+      // in flight; block until the nominated transaction completes.
+      ctxt.set_tstate(inflight);
+      cl.push_back(DirOpcode::MqSetBlockedOnTransaction);
+      // Advance
+      cl.next_and_do_consume(false);
+      return;
+    }
+    // Construct new transactions state object.
+    DirTState* tstate = new DirTState(k());
+    tstate->set_addr(msg->addr());
+    tstate->set_origin(msg->origin());
+    ctxt.set_owns_tstate(true);
+    ctxt.set_tstate(tstate);
+    if (model_->config().is_null_filter) {
+      // Null Filter; no line state is retained, therefore construct
+      // a line for the duration of the transaction.
+      tstate->set_line(protocol->construct_line());
+      ctxt.set_owns_line(true);
+      protocol->apply(ctxt, cl);
+      return;
+    }
+    const addr_t set_id = ah.set(msg->addr());
+    auto set = cache->set(set_id);
+    if (auto it = set.find(ah.tag(tstate->addr())); it == set.end()) {
+      // Line is not present in the cache.
+      CacheModel<DirLineState*>::Evictor evictor;
+      if (auto p = evictor.nominate(set.begin(), set.end()); p.second) {
+        // Eviction required.
+        DirTState* inflight = nullptr;
+        auto victim = nominate_victim(set, msg->origin(), inflight);
+        tstate->set_addr(ah.addr_from_set_tag(set_id, victim->tag()));
+        tstate->set_line(victim->t());
+        protocol->recall(ctxt, cl);
+      } else {
+        // Free line, or able to be evicted.
+        tstate->set_line(protocol->construct_line());
+        ctxt.set_owns_line(true);
+        // Execute protocol update.
+        protocol->apply(ctxt, cl);
+      }
+    } else {
+      // Otherwise, lookup the line and assign to the new tstate.
+      tstate->set_line(it->t());
+      // Execute protocol update.
+      protocol->apply(ctxt, cl);
+    }
+  }
+
+  // Where the line containing 'addr' is not present in the cache and
+  // its set is full, return the transaction which must complete before
+  // a line may be evicted, or nullptr if the line is present, a way is
+  // free, or a line may be recalled.
+  DirTState* lookup_victim_in_flight(const CohSrtMsg* msg) const {
+    if (model_->config().is_null_filter) return nullptr;
+
+    CacheModel<DirLineState*>* cache = model_->cache();
+    const CacheAddressHelper ah = cache->ah();
+    auto set = cache->set(ah.set(msg->addr()));
+    if (set.find(ah.tag(msg->addr())) != set.end()) return nullptr;
+
+    CacheModel<DirLineState*>::Evictor evictor;
+    if (const auto p = evictor.nominate(set.begin(), set.end());
+        p.first != set.end() && !p.second) {
+      // Free way is available.
+      return nullptr;
+    }
+    DirTState* inflight = nullptr;
+    if (nominate_victim(set, msg->origin(), inflight) != set.end()) {
+      return nullptr;
+    }
+    return inflight;
+  }
+
+  // Nominate the line to be recalled from the full 'set': the first
+  // line in a stable state without a transaction in flight. Otherwise,
+  // return end() and set 'inflight' to the transaction to await;
+  // preferably one which has left the stable state (its command has
+  // been received), else one from an agent other than 'origin', as
+  // the command of a transaction from 'origin' may be queued behind
+  // the current message.
+  template <typename SetT>
+  auto nominate_victim(SetT& set, Agent* origin, DirTState*& inflight) const {
+    DirTState* awaiting_cmd = nullptr;
+    DirTState* other_origin = nullptr;
+    for (auto it = set.begin(); it != set.end(); ++it) {
+      DirTState* tstate = lookup_state_by_line(it->t());
+      if (tstate == nullptr) {
+        if (it->t()->is_evictable()) return it;
+        continue;
+      }
+      if (!it->t()->is_stable()) {
+        if (inflight == nullptr) inflight = tstate;
+      } else if (tstate->origin() != origin) {
+        if (other_origin == nullptr) other_origin = tstate;
+      } else if (awaiting_cmd == nullptr) {
+        awaiting_cmd = tstate;
+      }
+    }
+    if (inflight == nullptr) inflight = other_origin;
+    if (inflight == nullptr) inflight = awaiting_cmd;
+    return set.end();
+  }
+
+  void process_in_flight(DirContext& ctxt, DirCommandList& cl) const {
+    // Lookup transaction table or bail if not found.
+    const ProtocolT* protocol = this->protocol();
+    DirTState* tstate = lookup_state_or_fatal(ctxt.msg()->t());
+    if (const Message* msg = ctxt.mq()->peek();
+        msg->cls() == MessageClass::CohCmd) {
+      // Grab anciliary state on the Coherence Command message.
+      const CohCmdMsg* coh = static_cast<const CohCmdMsg*>(msg);
+      tstate->set_addr(coh->addr());
+      tstate->set_opcode(coh->opcode());
+    }
+    ctxt.set_tstate(tstate);
+    protocol->apply(ctxt, cl);
+  }
+};
+
+template <typename ProtocolT>
+DirAgent::RdisProcessBase* DirAgent::construct_rdis(kernel::Kernel* k,
+                                                    const std::string& name,
+                                                    DirAgent* model) {
+  return new RdisProcess<ProtocolT>(k, name, model);
+}
+
+// Directory agent specialized on the protocol type ProtocolT.
+//
+template <typename ProtocolT>
+class DirAgentT : public DirAgent {
+ public:
+  DirAgentT(kernel::Kernel* k, const DirAgentConfig& config)
+      : DirAgent(k, config, &DirAgent::construct_rdis<ProtocolT>) {}
+};
+
+}  // namespace cc
+
+#endif
@@ -0,0 +1,268 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#include "dram.h"
+
+#include <algorithm>
+
+#include "mem.h"
+#include "stats.h"
+#include "utility.h"
+
+namespace cc {
+
+DramModel::DramModel(const DramConfig& config, cursor_t tck)
+    : config_(config), tck_(tck) {
+  line_bits_ = log2ceil(config_.line_bytes - 1);
+  columns_n_ =
+      std::max<std::uint64_t>(config_.row_bytes / config_.line_bytes, 1);
+  const std::size_t ranks_n = config_.channel_n * config_.rank_n;
+  banks_.resize(ranks_n * config_.bank_n);
+  ranks_.resize(ranks_n);
+  for (Rank& r : ranks_) r.refresh_due = to_time(config_.tREFI);
+  bus_free_.resize(config_.channel_n, 0);
+}
+
+DramCoord DramModel::decode(addr_t addr) const {
+  DramCoord c;
+  std::uint64_t x = addr >> line_bits_;
+  switch (config_.address_map) {
+    case DramAddressMap::RoRaBaChCo: {
+      c.column = x % columns_n_;
+      x /= columns_n_;
+      c.channel = x % config_.channel_n;
+      x /= config_.channel_n;
+      c.bank = x % config_.bank_n;
+      x /= config_.bank_n;
+      c.rank = x % config_.rank_n;
+      x /= config_.rank_n;
+      c.row = x;
+    } break;
+    case DramAddressMap::RoCoRaBaCh: {
+      c.channel = x % config_.channel_n;
+      x /= config_.channel_n;
+      c.bank = x % config_.bank_n;
+      x /= config_.bank_n;
+      c.rank = x % config_.rank_n;
+      x /= config_.rank_n;
+      c.column = x % columns_n_;
+      x /= columns_n_;
+      c.row = x;
+    } break;
+  }
+  if (config_.bank_xor) {
+    // Permutation based interleave: lines of distinct rows which
+    // would otherwise conflict in a bank are spread across banks.
+    c.bank = (c.bank ^ c.row) % config_.bank_n;
+  }
+  return c;
+}
+
+bool DramModel::full(bool is_write) const {
+  return is_write ? (wrq_.size() >= config_.wrq_n)
+                  : (rdq_.size() >= config_.rdq_n);
+}
+
+void DramModel::push(const MemCmdMsg* msg, cursor_t now) {
+  Request r;
+  r.msg = msg;
+  r.is_write = (msg->opcode() == MemCmdOpcode::Write);
+  r.arrival = now;
+  r.coord = decode(msg->addr());
+  if (!has_arrival_) {
+    first_arrival_ = now;
+    has_arrival_ = true;
+  }
+  std::deque<Request>& q = r.is_write ? wrq_ : rdq_;
+  q.push_back(r);
+  if (stats_ != nullptr) {
+    stats_->rdq_occupancy.set(rdq_.size());
+    stats_->wrq_occupancy.set(wrq_.size());
+  }
+}
+
+const DramModel::Request* DramModel::select(cursor_t now) {
+  sel_q_ = nullptr;
+  refresh(now);
+  update_drain_mode();
+
+  // Writes are issued during a drain, or opportunistically whenever
+  // no read can issue.
+  std::deque<Request>* qs[2] = {&rdq_, &wrq_};
+  if (is_draining_) std::swap(qs[0], qs[1]);
+  for (std::deque<Request>* q : qs) {
+    if (q == &wrq_ && !is_draining_ && !rdq_.empty()) continue;
+    if (const int i = select_from(*q, now); i >= 0) {
+      sel_q_ = q;
+      sel_i_ = static_cast<std::size_t>(i);
+      return &(*q)[sel_i_];
+    }
+  }
+  return nullptr;
+}
+
+cursor_t DramModel::issue(cursor_t now) {
+  const Request r = (*sel_q_)[sel_i_];
+  sel_q_->erase(sel_q_->begin() + sel_i_);
+  sel_q_ = nullptr;
+
+  Bank& b = bank(r.coord);
+  // Column command time.
+  cursor_t col = std::max(now, b.ready);
+  if (b.is_open && b.row == r.coord.row) {
+    // Row buffer hit
+    if (stats_ != nullptr) stats_->row_hit_n.inc();
+  } else {
+    cursor_t act = col;
+    if (b.is_open) {
+      // Row buffer conflict; precharge the open row before activation.
+      const cursor_t pre =
+          std::max({col, b.act + to_time(config_.tRAS), b.pre_ready});
+      act = pre + to_time(config_.tRP);
+      if (stats_ != nullptr) stats_->row_conflict_n.inc();
+    } else {
+      if (stats_ != nullptr) stats_->row_miss_n.inc();
+    }
+    b.is_open = true;
+    b.row = r.coord.row;
+    b.act = act;
+    col = act + to_time(config_.tRCD);
+  }
+
+  // Data transfer; serialized on the channel data bus.
+  cursor_t& bus_free = bus_free_[r.coord.channel];
+  const cursor_t data = std::max(col + to_time(config_.tCL), bus_free);
+  const cursor_t done = data + to_time(config_.tBURST);
+  bus_free = done;
+  // Consecutive column commands to the bank are separated by one
+  // burst.
+  b.ready = col + to_time(config_.tBURST);
+  if (r.is_write) {
+    b.pre_ready = std::max(b.pre_ready, done + to_time(config_.tWR));
+  }
+  if (config_.page_policy == DramPagePolicy::Closed) {
+    // Precharge immediately upon completion of the access.
+    const cursor_t pre = std::max({done, b.act + to_time(config_.tRAS),
+                                   b.pre_ready});
+    b.is_open = false;
+    b.ready = pre + to_time(config_.tRP);
+  }
+  latest_done_ = std::max(latest_done_, done);
+
+  if (stats_ != nullptr) {
+    if (r.is_write) {
+      stats_->write_n.inc();
+      stats_->write_latency.add(done - r.arrival);
+    } else {
+      stats_->read_n.inc();
+      stats_->read_latency.add(done - r.arrival);
+    }
+    stats_->bus_busy_n.inc(to_time(config_.tBURST));
+    stats_->record_transfer(config_.line_bytes, first_arrival_, latest_done_);
+    stats_->rdq_occupancy.set(rdq_.size());
+    stats_->wrq_occupancy.set(wrq_.size());
+  }
+  return done;
+}
+
+void DramModel::refresh(cursor_t now) {
+  if (config_.tREFI == 0) return;
+
+  for (std::size_t i = 0; i < ranks_.size(); i++) {
+    Rank& rank = ranks_[i];
+    if (now < rank.refresh_due) continue;
+
+    // All banks of the rank are precharged and then refreshed; the
+    // rank is unavailable for tRFC.
+    Bank* b = &banks_[i * config_.bank_n];
+    cursor_t start = now;
+    for (std::size_t j = 0; j < config_.bank_n; j++) {
+      start = std::max(start, b[j].ready);
+      if (b[j].is_open) {
+        start = std::max({start, b[j].act + to_time(config_.tRAS),
+                          b[j].pre_ready});
+      }
+    }
+    rank.busy_until = start + to_time(config_.tRP) + to_time(config_.tRFC);
+    for (std::size_t j = 0; j < config_.bank_n; j++) {
+      b[j].is_open = false;
+      b[j].ready = rank.busy_until;
+    }
+    rank.refresh_due += to_time(config_.tREFI);
+    if (stats_ != nullptr) stats_->refresh_n.inc();
+  }
+}
+
+void DramModel::update_drain_mode() {
+  if (is_draining_) {
+    // Drain until the low watermark is reached, or indefinitely
+    // whilst there are no reads to service.
+    if (wrq_.empty() ||
+        (wrq_.size() <= config_.wr_drain_lo && !rdq_.empty())) {
+      is_draining_ = false;
+    }
+  } else if (wrq_.size() >= config_.wr_drain_hi) {
+    is_draining_ = true;
+    if (stats_ != nullptr) stats_->write_drain_n.inc();
+  }
+}
+
+int DramModel::select_from(const std::deque<Request>& q, cursor_t now) const {
+  // First-Ready: oldest request which hits the open row of a ready
+  // bank; otherwise, First-Come-First-Served: oldest request to a ready
+  // bank.
+  int oldest_ready = -1;
+  for (std::size_t i = 0; i < q.size(); i++) {
+    const Request& r = q[i];
+    const Bank& b = bank(r.coord);
+    if (now < b.ready || now < rank(r.coord).busy_until) continue;
+
+    if (b.is_open && b.row == r.coord.row) return static_cast<int>(i);
+    if (oldest_ready < 0) oldest_ready = static_cast<int>(i);
+  }
+  return oldest_ready;
+}
+
+DramModel::Bank& DramModel::bank(const DramCoord& c) {
+  return banks_[(c.channel * config_.rank_n + c.rank) * config_.bank_n +
+                c.bank];
+}
+
+const DramModel::Bank& DramModel::bank(const DramCoord& c) const {
+  return banks_[(c.channel * config_.rank_n + c.rank) * config_.bank_n +
+                c.bank];
+}
+
+DramModel::Rank& DramModel::rank(const DramCoord& c) {
+  return ranks_[c.channel * config_.rank_n + c.rank];
+}
+
+const DramModel::Rank& DramModel::rank(const DramCoord& c) const {
+  return ranks_[c.channel * config_.rank_n + c.rank];
+}
+
+}  // namespace cc
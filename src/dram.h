@@ -0,0 +1,192 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#ifndef CC_SRC_DRAM_H
+#define CC_SRC_DRAM_H
+
+#include <deque>
+#include <vector>
+
+#include "cc/cfgs.h"
+#include "cc/types.h"
+
+namespace cc {
+
+// Forwards:
+class MemCmdMsg;
+struct MemStatBlock;
+
+// Decoded DRAM location of a line.
+//
+struct DramCoord {
+  // Channel index
+  std::size_t channel = 0;
+  // Rank index (within channel)
+  std::size_t rank = 0;
+  // Bank index (within rank)
+  std::size_t bank = 0;
+  // Row index (within bank)
+  std::uint64_t row = 0;
+  // Column index; in units of lines (within row)
+  std::uint64_t column = 0;
+};
+
+// Timing model of a DRAM backend: channels of ranks of banks, each
+// bank with a row buffer. Requests are queued in separate read and
+// write queues and are scheduled First-Ready, First-Come-First-Served
+// (FR-FCFS); row buffer hits to ready banks are prioritized over older
+// requests. Writes are buffered until the write queue reaches its high
+// watermark (or no reads are pending), whereupon they are drained in a
+// burst to its low watermark.
+//
+// The model is passive: the owning memory controller pushes requests,
+// and at each epoch selects and issues the next request, which returns
+// the time at which its data transfer completes. All times are in
+// kernel time units.
+//
+class DramModel {
+ public:
+  // Queued request.
+  struct Request {
+    // Originating command.
+    const MemCmdMsg* msg = nullptr;
+    // Command is a write.
+    bool is_write = false;
+    // Time of arrival at the controller.
+    cursor_t arrival = 0;
+    // Decoded location.
+    DramCoord coord;
+  };
+
+  // Construct model where 'tck' is the period of the memory
+  // controller, in which timing parameters are expressed.
+  DramModel(const DramConfig& config, cursor_t tck);
+
+  // Decode line address 'addr' to its DRAM location.
+  DramCoord decode(addr_t addr) const;
+
+  // Accessors:
+  // Read queue occupancy
+  std::size_t rdq_size() const { return rdq_.size(); }
+  // Write queue occupancy
+  std::size_t wrq_size() const { return wrq_.size(); }
+  // No requests are pending.
+  bool empty() const { return rdq_.empty() && wrq_.empty(); }
+  // Queue of 'is_write' requests is full.
+  bool full(bool is_write) const;
+  // Write queue is currently draining.
+  bool is_draining() const { return is_draining_; }
+
+  // Set statistics block (nullptr if statistics are disabled).
+  void set_stats(MemStatBlock* stats) { stats_ = stats; }
+
+  // Enqueue command 'msg' arriving at 'now'.
+  void push(const MemCmdMsg* msg, cursor_t now);
+
+  // Select the next request to be issued at 'now', nullptr if no
+  // request can be issued.
+  const Request* select(cursor_t now);
+
+  // Issue the request previously returned by 'select' at 'now' and
+  // remove it from its queue. Returns the time at which the data
+  // transfer of the request completes.
+  cursor_t issue(cursor_t now);
+
+ private:
+  // Bank state.
+  struct Bank {
+    // Row buffer contains a valid row.
+    bool is_open = false;
+    // Currently open row.
+    std::uint64_t row = 0;
+    // Time of last activation.
+    cursor_t act = 0;
+    // Earliest time of the next command to the bank.
+    cursor_t ready = 0;
+    // Earliest time at which the bank may be precharged.
+    cursor_t pre_ready = 0;
+  };
+
+  // Rank state.
+  struct Rank {
+    // Time at which the next refresh is due.
+    cursor_t refresh_due = 0;
+    // Rank is unavailable until this time (refresh in progress).
+    cursor_t busy_until = 0;
+  };
+
+  // Refresh ranks whose refresh interval has elapsed by 'now'.
+  void refresh(cursor_t now);
+  // Update write drain mode.
+  void update_drain_mode();
+  // FR-FCFS selection from queue 'q' at 'now'; returns index or -1.
+  int select_from(const std::deque<Request>& q, cursor_t now) const;
+  // Bank corresponding to 'c'.
+  Bank& bank(const DramCoord& c);
+  const Bank& bank(const DramCoord& c) const;
+  // Rank corresponding to 'c'.
+  Rank& rank(const DramCoord& c);
+  const Rank& rank(const DramCoord& c) const;
+  // Convert epoch count 'n' to kernel time.
+  cursor_t to_time(time_t n) const { return static_cast<cursor_t>(n) * tck_; }
+
+  // Configuration
+  DramConfig config_;
+  // Controller period.
+  cursor_t tck_ = 1;
+  // Lines per row.
+  std::uint64_t columns_n_ = 1;
+  // Line offset bits.
+  std::size_t line_bits_ = 0;
+  // Pending reads.
+  std::deque<Request> rdq_;
+  // Pending writes.
+  std::deque<Request> wrq_;
+  // Write drain is in progress.
+  bool is_draining_ = false;
+  // Queue and index of the selected request.
+  std::deque<Request>* sel_q_ = nullptr;
+  std::size_t sel_i_ = 0;
+  // Bank states; indexed by [channel][rank][bank].
+  std::vector<Bank> banks_;
+  // Rank states; indexed by [channel][rank].
+  std::vector<Rank> ranks_;
+  // Time at which each channel data bus becomes free.
+  std::vector<cursor_t> bus_free_;
+  // Arrival time of the first request.
+  cursor_t first_arrival_ = 0;
+  // A request has arrived.
+  bool has_arrival_ = false;
+  // Latest data transfer completion time.
+  cursor_t latest_done_ = 0;
+  // Statistics (nullptr if statistics are disabled).
+  MemStatBlock* stats_ = nullptr;
+};
+
+}  // namespace cc
+
+#endif
@@ -52,6 +52,8 @@ const char* to_string(Phase phases) {
       return "Run";
     case Phase::Fini:
       return "Fini";
+    case Phase::Reset:
+      return "Reset";
     default:
       return "Invalid";
   }
@@ -95,6 +97,12 @@ bool RandomSource::random_bool(float true_probability) {
   return dist(mt_);
 }
 
+double RandomSource::uniform_real() {
+  // 53 random bits; mapped onto the mantissa of a double such that
+  // the sequence is identical across standard library implementations.
+  return (mt_() >> 11) * (1.0 / 9007199254740992.0);
+}
+
 void ObjectVisitor::iterate(Object* root) { root->accept(this); }
 
 void Object::set_top() {
@@ -159,14 +167,19 @@ struct Kernel::FrontierItemComparer {
     // TODO: create operators
     if (lhs_time.time > rhs_time.time) return true;
     if (lhs_time.time < rhs_time.time) return false;
-    return lhs_time.delta < rhs_time.delta;
+    if (lhs_time.delta != rhs_time.delta) {
+      return lhs_time.delta < rhs_time.delta;
+    }
+    // Coincident actions retain their order of insertion such that
+    // messages issued back-to-back to a queue arrive in order.
+    return lhs.seq > rhs.seq;
   }
 };
 
 Kernel::Kernel(seed_type seed) : random_source_(seed), Module(this, "kernel") {}
 
 void Kernel::add_action(Time t, Action* a) {
-  eq_.push_back(FrontierItem{t, a});
+  eq_.push_back(FrontierItem{t, a, eq_seq_++});
   std::push_heap(eq_.begin(), eq_.end(), FrontierItemComparer{});
 }
 
@@ -246,6 +259,7 @@ void Kernel::invoke_run(RunMode r, Time t) {
         throw std::runtime_error("Fatal error occurred.");
       }
       time_ = e.time;
+      ++evaluated_n_;
       if (e.action->eval()) {
         e.action->release();
       }
@@ -266,6 +280,30 @@ void Kernel::invoke_fini() {
   visitor.iterate(top());
 }
 
+void Kernel::invoke_reset() {
+  set_phase(Phase::Reset);
+  // Actions constructed before this point are now stale and are
+  // discarded, rather than evaluated, upon notification.
+  ++reset_n_;
+  struct InvokeResetVisitor : ObjectVisitor {
+    void visit(Module* o) override { o->reset(); }
+  };
+  InvokeResetVisitor visitor;
+  visitor.iterate(top());
+  // Flush event queue; persistent actions re-arm themselves upon
+  // discard.
+  while (!eq_.empty()) {
+    const FrontierItem e = eq_.back();
+    eq_.pop_back();
+    e.action->discard();
+  }
+  time_ = Time{};
+  fatal_ = false;
+  evaluated_n_ = 0;
+  eq_seq_ = 0;
+  random_source_ = RandomSource(random_source_.seed());
+}
+
 Object::Object(Kernel* k, const std::string& name) : k_(k), name_(name) {}
 
 Object::~Object() {}
@@ -304,9 +342,16 @@ bool Object::add_child(Object* c) {
   }
   children_.push_back(c);
   c->set_parent(this);
+  // Paths computed before the object was attached are now stale.
+  c->invalidate_path();
   return true;
 }
 
+void Object::invalidate_path() {
+  path_.clear();
+  for (Object* o : children_) o->invalidate_path();
+}
+
 const char* Loggable::Level::str() const {
   switch (level_) {
     case Debug:
@@ -357,10 +402,15 @@ void Loggable::log(const LogMessage& m) const {
   }
 }
 
-Action::Action(Kernel* k, const std::string& name) : Loggable(k, name) {}
+Action::Action(Kernel* k, const std::string& name)
+    : Loggable(k, name), reset_n_(k->reset_n()) {}
 
 void Action::release() { delete this; }
 
+bool Action::stale() const {
+  return !persistent() && (reset_n_ != k()->reset_n());
+}
+
 ProcessHost::ProcessHost(Kernel* k, const std::string& name)
     : Loggable(k, name) {}
 
@@ -404,6 +454,11 @@ void Event::notify() {
   const Time time{current_time.time, current_time.delta + 1};
   const ActionAdder aa(k());
   for (Action* a : as_) {
+    if (a->stale()) {
+      // Action pre-dates the most recent reset; discard.
+      a->discard();
+      continue;
+    }
     aa.add_action(time, a);
   }
   as_.clear();
@@ -428,6 +483,10 @@ void EventOr::finalize() {
       // Do not discard after evaluation as action is reused.
       return false;
     }
+    // Forwarding is a property of the EventOr and outlives a reset.
+    bool persistent() const override { return true; }
+    // Re-arm upon reset.
+    void discard() override { child_->add_notify_action(this); }
 
    private:
     Kernel* k_ = nullptr;
@@ -521,6 +580,11 @@ void SimPhaseRunner::fini() const {
   k_->invoke_fini();
 }
 
+// Invoke reset.
+void SimPhaseRunner::reset() const {
+  k_->invoke_reset();
+}
+
 // Run/Invoke simulation.
 void SimSequencer::run(RunMode r, Time time) const {
   // Build phase is already complete by this stage and it is assume
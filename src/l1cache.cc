@@ -27,6 +27,8 @@
 
 #include "l1cache.h"
 
+#include "l1cache_process.h"
+
 #include "cache.h"
 #include "cpu.h"
 #include "l2cache.h"
@@ -95,6 +97,8 @@ const char* to_string(L1CacheEvent event) {
       return "StoreMiss";
     case L1CacheEvent::InvalidateLine:
       return "InvalidateLine";
+    case L1CacheEvent::InvalidateInFlight:
+      return "InvalidateInFlight";
     case L1CacheEvent::Invalid:
       [[fallthrough]];
     default:
@@ -206,9 +210,11 @@ L1Command* L1CommandBuilder::build_remove_line(addr_t addr) {
 }
 
 L1Command* L1CommandBuilder::build_blocked_on_event(MessageQueue* mq,
-                                                    kernel::Event* e) {
+                                                    kernel::Event* e,
+                                                    BlockReason reason) {
   L1Command* cmd = new L1Command(L1Opcode::MqSetBlockedOnEvent);
   cmd->set_event(e);
+  cmd->set_block_reason(reason);
   return cmd;
 }
 
@@ -419,21 +425,23 @@ class L1CommandInterpreter {
   void execute_mq_set_blocked_on_event(L1CacheContext& ctxt,
                                        const L1Command* cmd) {
     // Message Queue is blocked until event is notified.
-    ctxt.mq()->set_blocked_until(cmd->event());
+    ctxt.mq()->set_blocked_until(cmd->event(), cmd->block_reason());
   }
 
   void execute_mq_set_blocked_on_transaction(L1CacheContext& ctxt,
                                              const L1Command* cmd) {
     // TODO: implement in terms of blocked on event
     L1TState* tstate = ctxt.tstate();
-    ctxt.mq()->set_blocked_until(tstate->transaction_end());
+    ctxt.mq()->set_blocked_until(tstate->transaction_end(),
+                                 BlockReason::TransactionInFlight);
   }
 
   void execute_mq_set_blocked_on_table(L1CacheContext& ctxt,
                                        const L1Command* cmd) {
     // TODO: implement in terms of blocked on event
     TransactionTable<L1TState*>* tt = ctxt.l1cache()->tt();
-    ctxt.mq()->set_blocked_until(tt->non_full_event());
+    ctxt.mq()->set_blocked_until(tt->non_full_event(),
+                                 BlockReason::TableFull);
   }
 
   void execute_msg_dequeue(L1CacheContext& ctxt, const L1Command* cmd,
@@ -464,42 +472,49 @@ class L1CommandInterpreter {
     L1CacheAgent* l1cache = ctxt.l1cache();
     
     L1CacheMonitor* monitor = l1cache->monitor();
-    L1CacheStatistics* statistics = l1cache->statistics();
+    L1CacheStatBlock* stats = l1cache->stats();
+    // Monitor tracks line-aligned addresses.
+    const addr_t addr = line_addr(l1cache, cmd->addr());
     switch (const L1CacheEvent event = cmd->cache_event(); event) {
       case L1CacheEvent::InstallShareable: {
         if (monitor) {
-          monitor->install_line(l1cache, cmd->addr());
+          monitor->install_line(l1cache, addr);
         }
       } break;
       case L1CacheEvent::InstallWriteable: {
         if (monitor) {
-          monitor->install_line(l1cache, cmd->addr(), true);
+          monitor->install_line(l1cache, addr, true);
         }
       } break;
       case L1CacheEvent::LoadHit: {
         if (monitor) {
-          monitor->read_hit(l1cache, cmd->addr());
+          monitor->read_hit(l1cache, addr);
         }
-        if (statistics) {
-          statistics->event(L1CacheStatistics::LoadHit, l1cache);
+        if (stats) {
+          stats->load_hit_n.inc();
         }
       } break;
       case L1CacheEvent::LoadMiss: {
-        if (statistics) {
-          statistics->event(L1CacheStatistics::LoadMiss, l1cache);
+        if (stats) {
+          stats->load_miss_n.inc();
         }
       } break;
       case L1CacheEvent::StoreHit: {
         if (monitor) {
-          monitor->write_hit(l1cache, cmd->addr());
+          monitor->write_hit(l1cache, addr);
         }
-        if (statistics) {
-          statistics->event(L1CacheStatistics::StoreHit, l1cache);
+        if (stats) {
+          stats->store_hit_n.inc();
         }
       } break;
       case L1CacheEvent::StoreMiss: {
-        if (statistics) {
-          statistics->event(L1CacheStatistics::StoreMiss, l1cache);
+        if (stats) {
+          stats->store_miss_n.inc();
+        }
+      } break;
+      case L1CacheEvent::InvalidateInFlight: {
+        if (monitor) {
+          monitor->remove_line(l1cache, addr);
         }
       } break;
       default: {
@@ -508,17 +523,24 @@ class L1CommandInterpreter {
     }
   }
 
+  // Line-aligned address of 'addr'.
+  static addr_t line_addr(L1CacheAgent* l1cache, addr_t addr) {
+    return addr - l1cache->cache()->ah().offset(addr);
+  }
+
   // Derive addr from command opcode.
   void execute_remove_line(L1CacheContext& ctxt, const L1Command* cmd) {
     CacheModel<L1LineState*>* cache = ctxt.l1cache()->cache();
     const CacheAddressHelper ah = cache->ah();
     const addr_t addr = cmd->addr();
     auto set = cache->set(ah.set(addr));
-    if (auto it = set.find(addr); it != set.end()) {
+    if (auto it = set.find(ah.tag(addr)); it != set.end()) {
       set.evict(it);
       // Update monitor state; line is now deleted.
       L1CacheMonitor* monitor = ctxt.l1cache()->monitor();
-      if (monitor) { monitor->remove_line(ctxt.l1cache(), cmd->addr()); }
+      if (monitor) {
+        monitor->remove_line(ctxt.l1cache(), addr - ah.offset(addr));
+      }
     } else {
       throw std::runtime_error("Cannot remove line, line is not present.");
     }
@@ -550,242 +572,105 @@ class L1CommandInterpreter {
   }
 };
 
-//
-//
-class L1CacheAgent::MainProcess : public AgentProcess {
-  using cb = L1CommandBuilder;
-
- public:
-  MainProcess(kernel::Kernel* k, const std::string& name, L1CacheAgent* model)
-      : AgentProcess(k, name), model_(model) {}
-
-  // Initialization
-  void init() override {
-    L1CacheContext ctxt;
-    ctxt.set_process(this);
-    ctxt.set_l1cache(model_);
-    L1CommandList cl;
-    cl.push_back(L1Opcode::WaitOnMsg);
-    execute(ctxt, cl);
-  }
-
-  // Evaluation
-  void eval() override {
-    MQArb* arb = model_->arb();
-
-    // Construct and initialize current processing context.
-    L1CacheContext ctxt;
-    ctxt.set_process(this);
-    ctxt.set_l1cache(model_);
-    ctxt.set_t(arb->tournament());
-    ctxt.set_l1cache(model_);
-    L1CommandList cl;
-
-    // Check if requests are present, if not block until a new message
-    // arrives at the arbiter. Process should ideally not wake in the
-    // absence of requesters.
-    if (!ctxt.t().has_requester()) {
-      cl.push_back(L1Opcode::WaitOnMsg);
-      execute(ctxt, cl);
-      return;
-    }
-
-    // Fetch nominated message queue
-    ctxt.set_mq(ctxt.t().winner());
+L1CacheAgent::MainProcessBase::MainProcessBase(kernel::Kernel* k,
+                                               const std::string& name,
+                                               L1CacheAgent* model)
+    : AgentProcess(k, name), model_(model) {}
 
-    // Dispatch to appropriate handler based upon message class.
-    switch (const MessageClass cls = ctxt.msg()->cls(); cls) {
-      case MessageClass::L1Cmd:
-        process_l1cmd(ctxt, cl);
-        break;
-      case MessageClass::L2CmdRsp:
-        process_l2cmdrsp(ctxt, cl);
-        break;
-      default: {
-        using cc::to_string;
-
-        LogMessage lmsg("Invalid message class received: ");
-        lmsg.append(to_string(cls));
-        lmsg.set_level(Level::Error);
-        log(lmsg);
-      } break;
-    }
+void L1CacheAgent::MainProcessBase::init() {
+  L1CacheContext ctxt;
+  ctxt.set_process(this);
+  ctxt.set_l1cache(model_);
+  L1CommandList cl;
+  cl.push_back(L1Opcode::WaitOnMsg);
+  execute(ctxt, cl);
+}
 
-    LogMessage lm("Execute message: ");
-    lm.append(ctxt.msg()->to_string());
-    lm.set_level(Level::Debug);
-    log(lm);
+void L1CacheAgent::MainProcessBase::check_resources(L1CacheContext& ctxt,
+                                                    L1CommandList& cl) const {
+  using cb = L1CommandBuilder;
 
-    // Check that sufficient resources exist to execute current
-    // command list. If not, command list is permuted to an
-    // appropriate 'wait' list.
-    check_resources(ctxt, cl);
+  // Compute the Agent resources required to execute the command
+  // list given by 'cl'. If the agent has insufficient resources,
+  // the ENTIRE command list must be killed and the agent blocked
+  // awaiting the arrival of sufficient resources. The command list
+  // must execute atomically, otherwise if it was to become blocked
+  // after a partial application and deadlock could occur.
+  const L1Resources res(cl);
 
-    // Execute computed command list
-    execute(ctxt, cl);
-  }
+  // Flag denoting that resource requirements have not been met.
+  bool fail = false;
 
-  void set_cache_line_shared_or_invalid(addr_t addr, bool shared) {
-    L1CommandList cl;
-    L1CacheContext ctxt;
-    ctxt.set_l1cache(model_);
-    ctxt.set_addr(addr);
-    L1Cache* cache = model_->cache();
-    const CacheAddressHelper ah = cache->ah();
-    const auto set = cache->set(ah.set(addr));
-    if (auto it = set.find(ah.tag(addr)); it != set.end()) {
-      ctxt.set_line(it->t());
-      const L1CacheAgentProtocol* protocol = model_->protocol();
-      protocol->set_line_shared_or_invalid(ctxt, cl, shared);
-    } else {
-      LogMessage msg("L2 sets cache line status to ");
-      msg.append(shared ? "Shared" : "Invalid");
-      msg.append(" but line is not present in the cache.");
-      msg.set_level(Level::Fatal);
-      log(msg);
-    }
-    execute(ctxt, cl);
-  }
+  if (TransactionTable<L1TState*>* tt = model_->tt();
+      !tt->has_at_least(res.tt_entry_n())) {
+    // No transaction table entries available. Block Process until
+    // sufficient space has been attained.
 
- private:
-  void process_l1cmd(L1CacheContext& ctxt, L1CommandList& cl) const {
-    const L1CmdMsg* cmd = static_cast<const L1CmdMsg*>(ctxt.msg());
-    L1Cache* cache = model_->cache();
-    const CacheAddressHelper ah = cache->ah();
-    const L1CacheAgentProtocol* protocol = model_->protocol();
-
-    // Construct new instance of Transaction State as command (likely)
-    // starts a new transaction round.
-    L1TState* tstate = new L1TState(k());
-    ctxt.set_tstate(tstate);
-    ctxt.set_owns_tstate(true);
-
-    // Otherwise, no transactions to current line in flight, therefore
-    // query the cache to determine hit/miss status of line_id.
-    const addr_t set_id = ah.set(cmd->addr());
-    L1CacheSet set = cache->set(set_id);
-    if (L1CacheLineIt it = set.find(ah.tag(cmd->addr())); it == set.end()) {
-      // Line for current address has not been found in the set,
-      // therefore a new line must either be installed or, if the set
-      // is currently full, another line must be nominated and
-      // evicted.
-      L1Cache::Evictor evictor;
-      if (const std::pair<L1CacheLineIt, bool> p =
-              evictor.nominate(set.begin(), set.end());
-          p.second) {
-        ctxt.set_addr(ah.addr_from_set_tag(set_id, p.first->tag()));
-        ctxt.set_line(p.first->t());
-        protocol->evict(ctxt, cl);
-      } else {
-        ctxt.set_line(protocol->construct_line());
-        ctxt.set_owns_line(true);
-        protocol->apply(ctxt, cl);
-      }
-    } else {
-      // Line is present in the cache, apply state update.
-      ctxt.set_line(it->t());
-      protocol->apply(ctxt, cl);
-    }
-  }
+    // Destroy prior CommandList and pissue new command to block
+    // current process.
+    cl.clear();
 
-  void process_l2cmdrsp(L1CacheContext& ctxt, L1CommandList& cl) const {
-    Transaction* t = ctxt.msg()->t();
-    TransactionTable<L1TState*>* tt = model_->tt();
-    if (auto it = tt->find(t); it != tt->end()) {
-      const L1CacheAgentProtocol* protocol = model_->protocol();
-      const L1TState* st = it->second;
-      ctxt.set_line(st->line());
-      ctxt.set_tstate(it->second);
-      protocol->apply(ctxt, cl);
-    } else {
-      LogMessage lm("Cannot find transaction table entry for ");
-      lm.append(to_string(t));
-      lm.set_level(Level::Fatal);
-      log(lm);
-    }
+    // Current Message(Queue) becomes belocked on the Transaction
+    // Table.
+    cl.push_back(L1Opcode::MqSetBlockedOnTable);
+    fail = true;
   }
 
-  void check_resources(L1CacheContext& ctxt, L1CommandList& cl) const {
-    // Compute the Agent resources required to execute the command
-    // list given by 'cl'. If the agent has insufficient resources,
-    // the ENTIRE command list must be killed and the agent blocked
-    // awaiting the arrival of sufficient resources. The command list
-    // must execute atomically, otherwise if it was to become blocked
-    // after a partial application and deadlock could occur.
-    const L1Resources res(cl);
-
-    // Flag denoting that resource requirements have not been met.
-    bool fail = false;
+  auto check_mq_capacity = [&](const MessageQueue* mq, std::size_t n) {
+    if (fail) return;
 
-    if (TransactionTable<L1TState*>* tt = model_->tt();
-        !tt->has_at_least(res.tt_entry_n())) {
-      // No transaction table entries available. Block Process until
-      // sufficient space has been attained.
+    if (!mq->has_at_least(n)) {
+      // Insufficient space in L2 command queue.
 
-      // Destroy prior CommandList and pissue new command to block
-      // current process.
+      // Destory old command list.
       cl.clear();
 
-      // Current Message(Queue) becomes belocked on the Transaction
-      // Table.
-      cl.push_back(L1Opcode::MqSetBlockedOnTable);
+      // Message Queue becomes blocked awaiting credit to destination
+      // queue.
+      cl.push_back(cb::build_blocked_on_event(
+          ctxt.mq(), mq->dequeue_event(), BlockReason::QueueFull));
       fail = true;
     }
+  };
 
-    auto check_mq_capacity = [&](const MessageQueue* mq, std::size_t n) {
-      if (fail) return;
+  // Check L2 command queue capacity.
+  check_mq_capacity(model_->l1_l2__cmd_q(), res.l2_cmd_n());
+  // Check CPU response queue capacity
+  check_mq_capacity(model_->l1_cpu__rsp_q(), res.cpu_rsp_n());
 
-      if (!mq->has_at_least(n)) {
-        // Insufficient space in L2 command queue.
-
-        // Destory old command list.
-        cl.clear();
-
-        // Message Queue becomes blocked awaiting credit to destination
-        // queue.
-        cl.push_back(
-            cb::build_blocked_on_event(ctxt.mq(), mq->non_full_event()));
-        fail = true;
-      }
-    };
-
-    // Check L2 command queue capacity.
-    check_mq_capacity(model_->l1_l2__cmd_q(), res.l2_cmd_n());
-    // Check CPU response queue capacity
-    check_mq_capacity(model_->l1_cpu__rsp_q(), res.cpu_rsp_n());
-
-    // Resources have been attained; command list is ready to be
-    // executed and committed to the agent's state.
-    if (fail) {
-      cl.push_back(L1Opcode::WaitNextEpoch);
-    }
+  // Resources have been attained; command list is ready to be
+  // executed and committed to the agent's state.
+  if (fail) {
+    cl.push_back(L1Opcode::WaitNextEpoch);
   }
+}
 
-  void execute(L1CacheContext& ctxt, const L1CommandList& cl) {
-    try {
-      L1CommandInterpreter interpreter;
-      for (const L1Command* cmd : cl) {
-        LogMessage lm("Executing cmd: ");
-        lm.append(cmd->to_string());
-        lm.set_level(Level::Debug);
-        log(lm);
-        interpreter.execute(ctxt, cmd);
-      }
-    } catch (const std::runtime_error& ex) {
-      LogMessage lm("Interpreter encountered an error: ");
-      lm.append(ex.what());
-      lm.set_level(Level::Fatal);
+void L1CacheAgent::MainProcessBase::execute(L1CacheContext& ctxt,
+                                            const L1CommandList& cl) {
+  try {
+    L1CommandInterpreter interpreter;
+    for (const L1Command* cmd : cl) {
+      LogMessage lm("Executing cmd: ");
+      lm.append(cmd->to_string());
+      lm.set_level(Level::Debug);
       log(lm);
+      interpreter.execute(ctxt, cmd);
     }
+  } catch (const std::runtime_error& ex) {
+    LogMessage lm("Interpreter encountered an error: ");
+    lm.append(ex.what());
+    lm.set_level(Level::Fatal);
+    log(lm);
   }
-
-  // Pointer to parent module.
-  L1CacheAgent* model_ = nullptr;
-};
+}
 
 L1CacheAgent::L1CacheAgent(kernel::Kernel* k, const L1CacheAgentConfig& config)
+    : L1CacheAgent(k, config, &construct_main<L1CacheAgentProtocol>) {}
+
+L1CacheAgent::L1CacheAgent(kernel::Kernel* k, const L1CacheAgentConfig& config,
+                           main_factory f)
     : Agent(k, config.name), config_(config) {
-  build();
+  build(f);
 }
 
 L1CacheAgent::~L1CacheAgent() {
@@ -801,7 +686,7 @@ L1CacheAgent::~L1CacheAgent() {
 
 // Construct L1Cache model
 //
-void L1CacheAgent::build() {
+void L1CacheAgent::build(main_factory f) {
   // Construct command request queue
   cpu_l1__cmd_q_ =
       new MessageQueue(k(), "cpu_l1__cmd_q", config_.cpu_l1__cmd_n);
@@ -820,7 +705,7 @@ void L1CacheAgent::build() {
   tt_ = new TransactionTable<L1TState*>(k(), "tt", config_.tt_entries_n);
   add_child_module(tt_);
   // Main thread of execution
-  main_ = new MainProcess(k(), "main", this);
+  main_ = f(k(), "main", this);
   main_->set_epoch(config_.epoch);
   add_child_process(main_);
   // Underlying cache instance.
@@ -835,14 +720,11 @@ void L1CacheAgent::build() {
 void L1CacheAgent::register_monitor(Monitor* monitor) {
   if (monitor == nullptr) return;
 
-  monitor->register_client(this);
+  monitor_index_ = monitor->register_client(this);
   monitor_ = monitor;
 }
 
 void L1CacheAgent::register_statistics(Statistics* statistics) {
-  if (statistics == nullptr) return;
-
-  statistics->register_client(this);
   statistics_ = statistics;
 }
 
@@ -860,6 +742,11 @@ bool L1CacheAgent::elab() {
   arb_->add_requester(cpu_l1__cmd_q_);
   arb_->add_requester(replay__cmd_q_);
   arb_->add_requester(l2_l1__rsp_q_);
+  // Bind statistics block.
+  if (statistics_ != nullptr) {
+    stats_ = statistics_->register_block<L1CacheStatBlock>(path());
+    stats_->bind_cache(cache_->stats());
+  }
   return false;
 }
 
@@ -884,8 +771,16 @@ void L1CacheAgent::drc() {
   }
 }
 
-void L1CacheAgent::set_cache_line_shared_or_invalid(addr_t addr, bool shared) {
-  main_->set_cache_line_shared_or_invalid(addr, shared);
+void L1CacheAgent::reset() {
+  // Reclaim line and transaction state; the table itself, and the
+  // queues, are reset as child modules.
+  cache_->reset([](L1LineState* line) { line->release(); });
+  for (const auto& p : *tt_) p.second->release();
+}
+
+void L1CacheAgent::set_cache_line_shared_or_invalid(addr_t addr, bool shared,
+                                                    bool is_owner) {
+  main_->set_cache_line_shared_or_invalid(addr, shared, is_owner);
 }
 
 }  // namespace cc
@@ -48,7 +48,7 @@ class L1CoherenceAction;
 class Monitor;
 class L1CacheMonitor;
 class Statistics;
-class L1CacheStatistics;
+struct L1CacheStatBlock;
 class L1CacheAgentProtocol;
 
 enum class L1CmdOpcode {
@@ -135,6 +135,10 @@ enum class L1CacheEvent {
   // Line is invalidated.
   InvalidateLine,
 
+  // Line is invalidated whilst a transaction to it is in flight; the
+  // line remains allocated until the transaction completes.
+  InvalidateInFlight,
+
   // Invalid; placehodler
   Invalid
 };
@@ -240,6 +244,9 @@ class L1Command {
   // Command event
   kernel::Event* event() const { return oprands.event; }
 
+  // Reason for which the Message Queue is blocked on event.
+  BlockReason block_reason() const { return oprands.block_reason; }
+
   // Command transaction object.
   Transaction* t() const { return oprands.t; }
 
@@ -255,6 +262,9 @@ class L1Command {
   // Set event oprand.
   void set_event(kernel::Event* event) { oprands.event = event; }
 
+  // Set reason for which the Message Queue is blocked on event.
+  void set_block_reason(BlockReason r) { oprands.block_reason = r; }
+
   // Set transaction oprand.
   void set_t(Transaction* t) { oprands.t = t; }
 
@@ -270,6 +280,7 @@ class L1Command {
     L1CoherenceAction* action;
     addr_t addr;
     kernel::Event* event;
+    BlockReason block_reason;
     Transaction* t;
     L1CacheEvent cache_event;
   } oprands;
@@ -290,7 +301,8 @@ class L1CommandBuilder {
   // Build remove line command from address addr.
   static L1Command* build_remove_line(addr_t addr);
   // Build "blocked on event" command
-  static L1Command* build_blocked_on_event(MessageQueue* mq, kernel::Event* e);
+  static L1Command* build_blocked_on_event(MessageQueue* mq, kernel::Event* e,
+                                           BlockReason reason);
   // Build "start transaction" command
   static L1Command* build_start_transaction(Transaction* t);
   // Build "end transaction" command
@@ -377,7 +389,8 @@ class L1CoherenceAction {
   // Invoke/Execute coherence action
   virtual bool execute() = 0;
 
-  virtual void release() { delete this; }
+  // Release action back to pool, or destruct.
+  virtual void release() const { delete this; }
 
  protected:
   virtual ~L1CoherenceAction() = default;
@@ -533,11 +546,14 @@ class L1CacheContext {
 //
 //
 class L1CacheAgent : public Agent {
+  class MainProcessBase;
+  template <typename>
   class MainProcess;
 
   friend class CpuCluster;
   friend class L2CommandInterpreter;
   friend class L1CommandInterpreter;
+  friend class Monitor;
 
  public:
   L1CacheAgent(kernel::Kernel* k, const L1CacheAgentConfig& config);
@@ -558,8 +574,24 @@ class L1CacheAgent : public Agent {
   MessageQueue* l2_l1__rsp_q() const { return l2_l1__rsp_q_; }
   // Message replay queue.
   MessageQueue* replay__cmd_q() const { return replay__cmd_q_; }
+  // Position of L1 within its parent L2 (and cluster).
+  std::size_t l2_id() const { return l2_id_; }
 
  protected:
+  // Main process factory.
+  using main_factory = MainProcessBase* (*)(kernel::Kernel*,
+                                            const std::string&, L1CacheAgent*);
+
+  // Construct agent where the main process is constructed by 'f'.
+  L1CacheAgent(kernel::Kernel* k, const L1CacheAgentConfig& config,
+               main_factory f);
+
+  // Construct main process specialized on protocol ProtocolT.
+  template <typename ProtocolT>
+  static MainProcessBase* construct_main(kernel::Kernel* k,
+                                         const std::string& name,
+                                         L1CacheAgent* model);
+
   // Accessors:
   // Pointer to current arbiter child instance.
   MQArb* arb() const { return arb_; }
@@ -573,11 +605,13 @@ class L1CacheAgent : public Agent {
   TransactionTable<L1TState*>* tt() const { return tt_; }
   // L1 Cache Monitor instance (if attached).
   L1CacheMonitor* monitor() const { return monitor_; }
-  // L1 Cache Statistics
-  L1CacheStatistics* statistics() const { return statistics_; }
+  // Index of L1 within the monitor (where attached).
+  std::size_t monitor_index() const { return monitor_index_; }
+  // L1 Cache Statistics (nullptr if statistics are disabled).
+  L1CacheStatBlock* stats() const { return stats_; }
 
   // Build Phase:
-  void build();
+  void build(main_factory f);
   // Register Verification Monitor
   void register_monitor(Monitor* monitor);
   // Register L1 cache statistics.
@@ -587,6 +621,8 @@ class L1CacheAgent : public Agent {
   bool elab() override;
   // Set parent L2Cache (Elaboration-Phase)
   void set_l2cache(L2CacheAgent* l2cache) { l2cache_ = l2cache; }
+  // Set position of L1 within its parent L2 (Build-Phase)
+  void set_l2_id(std::size_t l2_id) { l2_id_ = l2_id; }
   // Set CPU (Elaboration-Phase)
   void set_cpu(Cpu* cpu) { cpu_ = cpu; }
   // Set L1 -> L2 Command Queue
@@ -597,13 +633,18 @@ class L1CacheAgent : public Agent {
   // Design Rule Check (DRC) Phase
   virtual void drc() override;
 
+  // Reset Phase
+  void reset() override;
+
   // "Back-door" write-through cache related method(s):
 
   // Set cache line 'addr' to either Shared or Invalid state. Method
   // expects line to reside in cache. Called upon L2 initiated
-  // demotion in response to some inbound snoop command.
+  // demotion in response to some inbound snoop command. 'is_owner'
+  // denotes that the L2 has granted ownership of the line to the L1.
   //
-  void set_cache_line_shared_or_invalid(addr_t addr, bool shared = true);
+  void set_cache_line_shared_or_invalid(addr_t addr, bool shared = true,
+                                        bool is_owner = false);
 
  private:
   // L1 Cache stimulus (models the concept of a processor data path
@@ -618,6 +659,8 @@ class L1CacheAgent : public Agent {
   MessageQueue* l1_l2__cmd_q_ = nullptr;
   // L2 -> L1 Response Queue (L1 owned)
   MessageQueue* l2_l1__rsp_q_ = nullptr;
+  // Position of L1 within its parent L2.
+  std::size_t l2_id_ = 0;
   // L1 -> CPU Response Queue (CPU owned)
   MessageQueue* l1_cpu__rsp_q_ = nullptr;
   // Message servicing arbiter.
@@ -625,7 +668,7 @@ class L1CacheAgent : public Agent {
   // Transaction table.
   TransactionTable<L1TState*>* tt_ = nullptr;
   // Main process of execution.
-  MainProcess* main_ = nullptr;
+  MainProcessBase* main_ = nullptr;
   // Cachpe Instance
   L1Cache* cache_ = nullptr;
   // Pointer to parent L2.
@@ -634,8 +677,12 @@ class L1CacheAgent : public Agent {
   L1CacheAgentProtocol* protocol_ = nullptr;
   // Verification monitor instance.
   L1CacheMonitor* monitor_ = nullptr;
-  // Register statistics
-  L1CacheStatistics* statistics_ = nullptr;
+  // Index of L1 within the monitor.
+  std::size_t monitor_index_ = 0;
+  // Statistics registry
+  Statistics* statistics_ = nullptr;
+  // L1 Cache statistics
+  L1CacheStatBlock* stats_ = nullptr;
   // Cache configuration.
   L1CacheAgentConfig config_;
 };
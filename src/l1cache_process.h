@@ -0,0 +1,238 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#ifndef CC_SRC_L1CACHE_PROCESS_H
+#define CC_SRC_L1CACHE_PROCESS_H
+
+#include "cache.h"
+#include "l1cache.h"
+#include "protocol.h"
+#include "utility.h"
+
+namespace cc {
+
+// Protocol independent component of the L1 main process of
+// execution: initialization, resource checking and command list
+// execution.
+//
+class L1CacheAgent::MainProcessBase : public AgentProcess {
+ public:
+  MainProcessBase(kernel::Kernel* k, const std::string& name,
+                  L1CacheAgent* model);
+
+  // Set cache line 'addr' to either Shared or Invalid state.
+  virtual void set_cache_line_shared_or_invalid(addr_t addr, bool shared,
+                                                bool is_owner) = 0;
+
+ protected:
+  // Initialization
+  void init() override;
+
+  // Permute command list 'cl' to a wait list if the agent has
+  // insufficient resources to execute it.
+  void check_resources(L1CacheContext& ctxt, L1CommandList& cl) const;
+
+  // Execute command list 'cl'.
+  void execute(L1CacheContext& ctxt, const L1CommandList& cl);
+
+  // Pointer to parent module.
+  L1CacheAgent* model_ = nullptr;
+};
+
+// L1 main process of execution specialized on the protocol
+// type. Where ProtocolT is a concrete (final) protocol, calls into the
+// protocol are bound statically and are candidates for inlining;
+// otherwise, ProtocolT is L1CacheAgentProtocol and calls are
+// dispatched virtually.
+//
+template <typename ProtocolT>
+class L1CacheAgent::MainProcess : public L1CacheAgent::MainProcessBase {
+  using cb = L1CommandBuilder;
+
+ public:
+  MainProcess(kernel::Kernel* k, const std::string& name, L1CacheAgent* model)
+      : MainProcessBase(k, name, model) {}
+
+  // Evaluation
+  void eval() override {
+    MQArb* arb = model_->arb();
+
+    // Construct and initialize current processing context.
+    L1CacheContext ctxt;
+    ctxt.set_process(this);
+    ctxt.set_l1cache(model_);
+    ctxt.set_t(arb->tournament());
+    ctxt.set_l1cache(model_);
+    L1CommandList cl;
+
+    // Check if requests are present, if not block until a new message
+    // arrives at the arbiter. Process should ideally not wake in the
+    // absence of requesters.
+    if (!ctxt.t().has_requester()) {
+      cl.push_back(L1Opcode::WaitOnMsg);
+      execute(ctxt, cl);
+      return;
+    }
+
+    // Fetch nominated message queue
+    ctxt.set_mq(ctxt.t().winner());
+
+    // Dispatch to appropriate handler based upon message class.
+    switch (const MessageClass cls = ctxt.msg()->cls(); cls) {
+      case MessageClass::L1Cmd:
+        process_l1cmd(ctxt, cl);
+        break;
+      case MessageClass::L2CmdRsp:
+        process_l2cmdrsp(ctxt, cl);
+        break;
+      default: {
+        using cc::to_string;
+
+        LogMessage lmsg("Invalid message class received: ");
+        lmsg.append(to_string(cls));
+        lmsg.set_level(Level::Error);
+        log(lmsg);
+      } break;
+    }
+
+    LogMessage lm("Execute message: ");
+    lm.append(ctxt.msg()->to_string());
+    lm.set_level(Level::Debug);
+    log(lm);
+
+    // Check that sufficient resources exist to execute current
+    // command list. If not, command list is permuted to an
+    // appropriate 'wait' list.
+    check_resources(ctxt, cl);
+
+    // Execute computed command list
+    execute(ctxt, cl);
+  }
+
+  void set_cache_line_shared_or_invalid(addr_t addr, bool shared,
+                                        bool is_owner) override {
+    L1CommandList cl;
+    L1CacheContext ctxt;
+    ctxt.set_l1cache(model_);
+    ctxt.set_addr(addr);
+    L1Cache* cache = model_->cache();
+    const CacheAddressHelper ah = cache->ah();
+    const auto set = cache->set(ah.set(addr));
+    if (auto it = set.find(ah.tag(addr)); it != set.end()) {
+      ctxt.set_line(it->t());
+      protocol()->set_line_shared_or_invalid(ctxt, cl, shared, is_owner);
+    } else {
+      LogMessage msg("L2 sets cache line status to ");
+      msg.append(shared ? "Shared" : "Invalid");
+      msg.append(" but line is not present in the cache.");
+      msg.set_level(Level::Fatal);
+      log(msg);
+    }
+    execute(ctxt, cl);
+  }
+
+ private:
+  // Protocol instance, as its specialized type.
+  const ProtocolT* protocol() const {
+    return static_cast<const ProtocolT*>(model_->protocol());
+  }
+
+  void process_l1cmd(L1CacheContext& ctxt, L1CommandList& cl) const {
+    const L1CmdMsg* cmd = static_cast<const L1CmdMsg*>(ctxt.msg());
+    L1Cache* cache = model_->cache();
+    const CacheAddressHelper ah = cache->ah();
+    const ProtocolT* protocol = this->protocol();
+
+    // Construct new instance of Transaction State as command (likely)
+    // starts a new transaction round.
+    L1TState* tstate = new L1TState(k());
+    ctxt.set_tstate(tstate);
+    ctxt.set_owns_tstate(true);
+
+    // Otherwise, no transactions to current line in flight, therefore
+    // query the cache to determine hit/miss status of line_id.
+    const addr_t set_id = ah.set(cmd->addr());
+    L1CacheSet set = cache->set(set_id);
+    if (L1CacheLineIt it = set.find(ah.tag(cmd->addr())); it == set.end()) {
+      // Line for current address has not been found in the set,
+      // therefore a new line must either be installed or, if the set
+      // is currently full, another line must be nominated and
+      // evicted.
+      L1Cache::Evictor evictor;
+      if (const std::pair<L1CacheLineIt, bool> p =
+              evictor.nominate(set.begin(), set.end());
+          p.second) {
+        ctxt.set_addr(ah.addr_from_set_tag(set_id, p.first->tag()));
+        ctxt.set_line(p.first->t());
+        protocol->evict(ctxt, cl);
+      } else {
+        ctxt.set_line(protocol->construct_line());
+        ctxt.set_owns_line(true);
+        protocol->apply(ctxt, cl);
+      }
+    } else {
+      // Line is present in the cache, apply state update.
+      ctxt.set_line(it->t());
+      protocol->apply(ctxt, cl);
+    }
+  }
+
+  void process_l2cmdrsp(L1CacheContext& ctxt, L1CommandList& cl) const {
+    Transaction* t = ctxt.msg()->t();
+    TransactionTable<L1TState*>* tt = model_->tt();
+    if (auto it = tt->find(t); it != tt->end()) {
+      const L1TState* st = it->second;
+      ctxt.set_line(st->line());
+      ctxt.set_tstate(it->second);
+      protocol()->apply(ctxt, cl);
+    } else {
+      LogMessage lm("Cannot find transaction table entry for ");
+      lm.append(to_string(t));
+      lm.set_level(Level::Fatal);
+      log(lm);
+    }
+  }
+};
+
+template <typename ProtocolT>
+L1CacheAgent::MainProcessBase* L1CacheAgent::construct_main(
+    kernel::Kernel* k, const std::string& name, L1CacheAgent* model) {
+  return new MainProcess<ProtocolT>(k, name, model);
+}
+
+// L1 cache agent specialized on the protocol type ProtocolT.
+//
+template <typename ProtocolT>
+class L1CacheAgentT : public L1CacheAgent {
+ public:
+  L1CacheAgentT(kernel::Kernel* k, const L1CacheAgentConfig& config)
+      : L1CacheAgent(k, config, &L1CacheAgent::construct_main<ProtocolT>) {}
+};
+
+}  // namespace cc
+
+#endif
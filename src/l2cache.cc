@@ -27,9 +27,12 @@
 
 #include "l2cache.h"
 
+#include "l2cache_process.h"
+
 #include <algorithm>
 
 #include "l1cache.h"
+#include "stats.h"
 #include "utility.h"
 #include "verif.h"
 
@@ -309,19 +312,38 @@ class L2CommandInterpreter {
   void execute_mq_set_blocked_on_transaction(L2CacheContext& ctxt,
                                              const L2Command* cmd) const {
     // Set the blocked status of the current Message Queue.
-    ctxt.mq()->set_blocked_until(ctxt.tstate()->transaction_end());
+    ctxt.mq()->set_blocked_until(ctxt.tstate()->transaction_end(),
+                                 BlockReason::TransactionInFlight);
   }
 
   void execute_mq_set_blocked_on_table(L2CacheContext& ctxt,
                                        const L2Command* cmd) const {
     // Set the blocked status of the current Message Queue.
-    ctxt.mq()->set_blocked_until(model_->tt()->non_full_event());
+    ctxt.mq()->set_blocked_until(model_->tt()->non_full_event(),
+                                 BlockReason::TableFull);
   }
 
   void execute_msg_consume(L2CacheContext& ctxt, const L2Command* cmd) const {
     // Dequeue and release the head message of the currently
     // addressed Message Queue.
     const Message* msg = ctxt.mq()->dequeue();
+    if (msg->cls() == MessageClass::L2Cmd && msg->t() != nullptr) {
+      msg->t()->stamp(TransactionStage::L1Miss, model_->k()->time());
+    }
+    if (L2CacheStatBlock* stats = model_->stats(); stats != nullptr) {
+      switch (msg->cls()) {
+        case MessageClass::L2Cmd: {
+          stats->l1_cmd_n.inc();
+          const L2CmdMsg* cmd = static_cast<const L2CmdMsg*>(msg);
+          if (cmd->opcode() == L2CmdOpcode::L1Put) stats->l1_put_n.inc();
+        } break;
+        case MessageClass::AceSnoop: {
+          stats->snoop_n.inc();
+        } break;
+        default: {
+        } break;
+      }
+    }
     msg->release();
     ctxt.t().advance();
   }
@@ -345,27 +367,27 @@ class L2CommandInterpreter {
 
   void execute_set_l1_lines_shared(L2CacheContext& ctxt,
                                    const L2Command* cmd) const {
-    const std::vector<L1CacheAgent*>& agents = cmd->agents();
-    for (L1CacheAgent* l1cache : ctxt.l2cache()->l1cs_) {
-      if (std::find(agents.begin(), agents.end(), l1cache) != agents.end()) {
-        // Agent in keep-out set.
-        continue;
-      }
-      l1cache->set_cache_line_shared_or_invalid(cmd->addr());
+    const std::vector<L1CacheAgent*>& l1cs = ctxt.l2cache()->l1cs_;
+    for (L1Mask m = cmd->l1s(); m != 0; m &= (m - 1)) {
+      const std::size_t i = __builtin_ctzll(m);
+      const bool is_owner = ((cmd->owners() >> i) & 1) != 0;
+      l1cs[i]->set_cache_line_shared_or_invalid(cmd->addr(), true, is_owner);
     }
   }
 
   void execute_set_l1_lines_invalid(L2CacheContext& ctxt,
                                     const L2Command* cmd) const {
-    const std::vector<L1CacheAgent*>& agents = cmd->agents();
-    for (L1CacheAgent* l1cache : ctxt.l2cache()->l1cs_) {
-      // Search agent 'keep-out' list such that we do not invalidate
-      // agents that we wish to retain, typically L1 which is about to
-      // receive exclusive ownership of the line.
-      if (std::find(agents.begin(), agents.end(), l1cache) != agents.end()) {
-        continue;
-      }
-      l1cache->set_cache_line_shared_or_invalid(cmd->addr(), false);
+    if (L2CacheStatBlock* stats = model_->stats(); stats != nullptr) {
+      stats->recall_n.inc();
+    }
+    // Command applies to the L1 holding the line, less those which
+    // are to retain it (typically the L1 which is about to receive
+    // exclusive ownership of the line).
+    const std::vector<L1CacheAgent*>& l1cs = ctxt.l2cache()->l1cs_;
+    for (L1Mask m = cmd->l1s(); m != 0; m &= (m - 1)) {
+      const std::size_t i = __builtin_ctzll(m);
+      const bool is_owner = ((cmd->owners() >> i) & 1) != 0;
+      l1cs[i]->set_cache_line_shared_or_invalid(cmd->addr(), false, is_owner);
     }
   }
 
@@ -396,266 +418,78 @@ class L2CommandInterpreter {
   L2CacheAgent* model_ = nullptr;
 };
 
-//
-//
-class L2CacheAgent::MainProcess : public AgentProcess {
-  using cb = L2CommandBuilder;
-
- public:
-  MainProcess(kernel::Kernel* k, const std::string& name, L2CacheAgent* model)
-      : AgentProcess(k, name), model_(model) {}
-
-  // Initialization:
-  void init() override {
-    L2CacheContext c;
-    L2CommandList cl;
-    cl.push_back(L2Opcode::WaitOnMsg);
-    execute(c, cl);
-  }
-
-  // Evaluation:
-  void eval() override {
-    MQArb* arb = model_->arb();
-
-    // Construct and initialize current processing context.
-    L2CommandList cl;
-    L2CacheContext ctxt;
-    ctxt.set_t(arb->tournament());
-    ctxt.set_l2cache(model_);
-
-    // Check if requests are present, if not block until a new message
-    // arrives at the arbiter. Process should ideally not wake in the
-    // absence of requesters.
-    if (!ctxt.t().has_requester()) {
-      cl.push_back(L2Opcode::WaitOnMsg);
-      execute(ctxt, cl);
-      return;
-    }
-
-    // Fetch nominated message queue
-    ctxt.set_mq(ctxt.t().winner());
-
-    // Dispatch to appropriate message class
-    const MessageClass cls = ctxt.msg()->cls();
-    switch (cls) {
-      case MessageClass::L2Cmd: {
-        process_l2cmd(ctxt, cl);
-      } break;
-      case MessageClass::AceCmdRsp: {
-        process_acecmdrsp(ctxt, cl);
-      } break;
-      case MessageClass::AceSnoop: {
-        process_acesnoop(ctxt, cl);
-      } break;
-      default: {
-        using cc::to_string;
+L2CacheAgent::MainProcessBase::MainProcessBase(kernel::Kernel* k,
+                                               const std::string& name,
+                                               L2CacheAgent* model)
+    : AgentProcess(k, name), model_(model) {}
 
-        LogMessage lmsg("Invalid message class received: ");
-        lmsg.append(to_string(ctxt.msg()->cls()));
-        lmsg.set_level(Level::Fatal);
-        log(lmsg);
-      } break;
-    }
+void L2CacheAgent::MainProcessBase::init() {
+  L2CacheContext c;
+  L2CommandList cl;
+  cl.push_back(L2Opcode::WaitOnMsg);
+  execute(c, cl);
+}
 
-    LogMessage lm("Execute message: ");
-    lm.append(ctxt.msg()->to_string());
-    lm.set_level(Level::Debug);
-    log(lm);
+void L2CacheAgent::MainProcessBase::check_resources(L2CacheContext& ctxt,
+                                                    L2CommandList& cl) const {
+  const L2Resources res(cl);
 
-    check_resources(ctxt, cl);
-    execute(ctxt, cl);
-  }
+  // Flag denoting that resource requirements have not been met.
+  bool fail = false;
 
-  void set_cache_line_modified(addr_t addr) {
-    L2CommandList cl;
-    L2CacheContext ctxt;
-    ctxt.set_l2cache(model_);
-    const L2CacheAgentProtocol* protocol = model_->protocol();
-    L2CacheModel* cache = model_->cache();
-    const CacheAddressHelper ah = cache->ah();
-
-    L2CacheModelSet set = cache->set(ah.set(addr));
-    if (auto it = set.find(ah.tag(addr));it != set.end()) {
-      ctxt.set_line(it->t());
-      protocol->set_modified_status(ctxt, cl);
-    } else {
-      LogMessage msg(
-          "L1 attempts to set modified state of cache line but "
-          "cache line is not resident in L2.");
-      msg.set_level(Level::Fatal);
-      log(msg);
-    }
-    execute(ctxt, cl);
+  if (L2TTable* tt = model_->tt(); !tt->has_at_least(res.tt_entry_n())) {
+    // Destory prior CommandList.
+    cl.clear();
+    // Message Queue becomes blocks awaiting the availability of an
+    // entry in the transaction table.
+    cl.push_back(L2Opcode::MqSetBlockedOnTable);
+    // Resource requirement not attained.
+    fail = true;
   }
 
- private:
-  void process_l2cmd(L2CacheContext& ctxt, L2CommandList& cl) const {
-    const L2CmdMsg* cmd = static_cast<const L2CmdMsg*>(ctxt.msg());
-    L2CacheModel* cache = model_->cache();
-    const CacheAddressHelper ah = cache->ah();
-    const L2CacheAgentProtocol* protocol = model_->protocol();
-
-    // Command starts new transaction, therefore construct new
-    // transaction table entry; unclear at this point whether
-    // transaction will start, therefore context owns tstate upon
-    // destruction.
-    L2TState* tstate = new L2TState(k());
-    ctxt.set_tstate(tstate);
-    ctxt.set_owns_tstate(true);
-
-    // Cache line state.
-    L2LineState* line = nullptr;
-
-    L2CacheModelSet set = cache->set(ah.set(cmd->addr()));
-    L2CacheModelLineIt it = set.find(ah.tag(cmd->addr()));
-    const bool has_cache_line = (it != set.end());
-    switch (const L2CmdOpcode opcode = cmd->opcode(); opcode) {
-      case L2CmdOpcode::L1GetS:
-      case L2CmdOpcode::L1GetE: {
-        if (!has_cache_line) {
-          // Line for current address has not been found in the set,
-          // therefore a new line must either be installed or, if the set
-          // is currently full, another line must be nominated and
-          // evicted.
-          L2CacheModel::Evictor evictor;
-          if (const std::pair<L2CacheModelLineIt, bool> p =
-                  evictor.nominate(set.begin(), set.end());
-              p.second) {
-            // Eviction required before command can complete.
-            // TODO
-          } else {
-            // Eviction not required for the command to complete.
-            line = protocol->construct_line();
-            ctxt.set_line(line);
-            ctxt.set_owns_line(true);
-            tstate->set_line(line);
-            protocol->apply(ctxt, cl);
-          }
-        } else {
-          // Line is present in the cache, apply state update.
-          line = it->t();
-          ctxt.set_line(line);
-          tstate->set_line(line);
-          protocol->apply(ctxt, cl);
-        }
-      } break;
-      case L2CmdOpcode::L1Put: {
-        if (has_cache_line) {
-          line = it->t();
-          ctxt.set_line(line);
-          tstate->set_line(line);
-          protocol->apply(ctxt, cl);
-        } else {
-          LogMessage msg(
-              "L1 requests eviction of line which is not present "
-              "in L2; simulation assumes inclusive cache model.");
-          msg.set_level(Level::Fatal);
-          log(msg);
-        }
-      } break;
-      default: {
-        // Unknown opcode.
-      } break;
+  // On fail, inject WaitNextEpoch to retry.
+  //
+  // TODO: may wish to extend this with some cost which blocks the
+  // agent for some time. This would serve to model the lookup
+  // penalty associated with a failed transasction.
+  //
+  if (fail) {
+    cl.push_back(L2Opcode::WaitNextEpoch);
+    if (L2CacheStatBlock* stats = model_->stats(); stats != nullptr) {
+      stats->stall_n.inc();
     }
   }
+}
 
-  void process_acecmdrsp(L2CacheContext& ctxt, L2CommandList& cl) const {
-    Transaction* t = ctxt.msg()->t();
-    L2TTable* tt = model_->tt();
-    if (auto it = tt->find(t); it != tt->end()) {
-      const L2CacheAgentProtocol* protocol = model_->protocol();
-      ctxt.set_tstate(it->second);
-      ctxt.set_line(ctxt.tstate()->line());
-      protocol->apply(ctxt, cl);
-    } else {
-      LogMessage lm("Cannot find transaction table entry for ");
-      lm.append(to_string(t));
-      lm.set_level(Level::Fatal);
+void L2CacheAgent::MainProcessBase::execute(L2CacheContext& ctxt,
+                                            const L2CommandList& cl) {
+  try {
+    L2CommandInterpreter interpreter;
+    interpreter.set_l2cache(model_);
+    interpreter.set_process(this);
+    for (const L2Command* cmd : cl) {
+      LogMessage lm("Executing command: ");
+      lm.append(cmd->to_string());
+      lm.set_level(Level::Debug);
       log(lm);
-    }
-  }
-
-  void process_acesnoop(L2CacheContext& ctxt, L2CommandList& cl) const {
-    const bool opt_allow_silent_evictions = false;
-    // Lookup cache line of interest
-    L2CacheModel* cache = model_->cache();
-    const CacheAddressHelper ah = cache->ah();
-    const AceSnpMsg* msg = static_cast<const AceSnpMsg*>(ctxt.msg());
-    ctxt.set_addr(msg->addr());
-    const auto set = cache->set(ah.set(msg->addr()));
-    if (auto it = set.find(ah.tag(msg->addr())); it != set.end()) {
-      // Found line in cache; set constext
-      ctxt.set_line(it->t());
-    } else if (opt_allow_silent_evictions) {
-      //
-      ctxt.set_silently_evicted(true);
-    } else {
-      LogMessage msg(
-          "Expect line to be installed in cache for snoops "
-          "when silent evictions have not be enabled.");
-      msg.set_level(Level::Fatal);
-      log(msg);
-    }
-    ctxt.set_owns_line(false);
-    const L2CacheAgentProtocol* protocol = model_->protocol();
-    protocol->apply(ctxt, cl);
-  }
-
-  void check_resources(L2CacheContext& ctxt, L2CommandList& cl) const {
-    const L2Resources res(cl);
-
-    // Flag denoting that resource requirements have not been met.
-    bool fail = false;
-
-    if (L2TTable* tt = model_->tt(); !tt->has_at_least(res.tt_entry_n())) {
-      // Destory prior CommandList.
-      cl.clear();
-      // Message Queue becomes blocks awaiting the availability of an
-      // entry in the transaction table.
-      cl.push_back(L2Opcode::MqSetBlockedOnTable);
-      // Resource requirement not attained.
-      fail = true;
-    }
-
-    // On fail, inject WaitNextEpoch to retry.
-    //
-    // TODO: may wish to extend this with some cost which blocks the
-    // agent for some time. This would serve to model the lookup
-    // penalty associated with a failed transasction.
-    //
-    if (fail) {
-      cl.push_back(L2Opcode::WaitNextEpoch);
-    }
-  }
-
-  void execute(L2CacheContext& ctxt, const L2CommandList& cl) {
-    try {
-      L2CommandInterpreter interpreter;
-      interpreter.set_l2cache(model_);
-      interpreter.set_process(this);
-      for (const L2Command* cmd : cl) {
-        LogMessage lm("Executing command: ");
-        lm.append(cmd->to_string());
-        lm.set_level(Level::Debug);
-        log(lm);
 
-        interpreter.execute(ctxt, cmd);
-      }
-    } catch (const std::runtime_error& ex) {
-      LogMessage lm("Interpreter encountered an error: ");
-      lm.append(ex.what());
-      lm.set_level(Level::Fatal);
-      log(lm);
+      interpreter.execute(ctxt, cmd);
     }
+  } catch (const std::runtime_error& ex) {
+    LogMessage lm("Interpreter encountered an error: ");
+    lm.append(ex.what());
+    lm.set_level(Level::Fatal);
+    log(lm);
   }
-
-  // Pointer to parent L2.
-  L2CacheAgent* model_ = nullptr;
-};
+}
 
 L2CacheAgent::L2CacheAgent(kernel::Kernel* k, const L2CacheAgentConfig& config)
+    : L2CacheAgent(k, config, &construct_main<L2CacheAgentProtocol>) {}
+
+L2CacheAgent::L2CacheAgent(kernel::Kernel* k, const L2CacheAgentConfig& config,
+                           main_factory f)
     : Agent(k, config.name), config_(config) {
-  build();
+  build(f);
 }
 
 L2CacheAgent::~L2CacheAgent() {
@@ -671,16 +505,8 @@ L2CacheAgent::~L2CacheAgent() {
   delete tt_;
 }
 
-MessageQueue* L2CacheAgent::l2_l1__rsp_q(L1CacheAgent* l1cache) const {
-  MessageQueue* mq = nullptr;
-  if (auto it = l2_l1__rsp_qs_.find(l1cache); it != l2_l1__rsp_qs_.end()) {
-    mq = it->second;
-  } else {
-    LogMessage msg("Cannot find l2_lq__rsp_qs proxy instance for l1cache.");
-    msg.set_level(Level::Fatal);
-    log(msg);
-  }
-  return mq;
+MessageQueue* L2CacheAgent::l2_l1__rsp_q(const L1CacheAgent* l1cache) const {
+  return l2_l1__rsp_qs_[l1cache->l2_id()];
 }
 
 void L2CacheAgent::add_l1c(L1CacheAgent* l1c) {
@@ -691,20 +517,26 @@ void L2CacheAgent::add_l1c(L1CacheAgent* l1c) {
   std::string name = "l1_l2__cmd_q";
   name += to_string(l1cs_.size());
   MessageQueue* l1c_cmdq = new MessageQueue(k(), name, 3);
+  // Issued to by the child L1 only.
+  l1c_cmdq->add_fanin(1);
   l1_l2__cmd_qs_.push_back(l1c_cmdq);
   add_child_module(l1c_cmdq);
+  // Response queue is bound at elaboration.
+  l2_l1__rsp_qs_.push_back(nullptr);
   // Add L1 cache
   l1cs_.push_back(l1c);
 }
 
 // Construct L2 Cache Model
 //
-void L2CacheAgent::build() {
+void L2CacheAgent::build(main_factory f) {
   // CC -> L2 command queue.
   cc_l2__cmd_q_ = new MessageQueue(k(), "cc_l2__cmd_q", 16);
+  cc_l2__cmd_q_->add_fanin(1);
   add_child_module(cc_l2__cmd_q_);
   // CC -> L2 response queue.
   cc_l2__rsp_q_ = new MessageQueue(k(), "cc_l2__rsp_q", 16);
+  cc_l2__rsp_q_->add_fanin(1);
   add_child_module(cc_l2__rsp_q_);
   // Arbiter
   arb_ = new MQArb(k(), "arb");
@@ -713,7 +545,7 @@ void L2CacheAgent::build() {
   tt_ = new L2TTable(k(), "tt", 16);
   add_child_module(tt_);
   // Main thread
-  main_ = new MainProcess(k(), "main", this);
+  main_ = f(k(), "main", this);
   main_->set_epoch(config_.epoch);
   add_child_process(main_);
   // Cache model
@@ -730,6 +562,10 @@ void L2CacheAgent::register_monitor(Monitor* monitor) {
   monitor->register_client(this);
 }
 
+void L2CacheAgent::register_statistics(Statistics* statistics) {
+  statistics_ = statistics;
+}
+
 // Elaborate L2 cache model
 //
 bool L2CacheAgent::elab() {
@@ -739,6 +575,11 @@ bool L2CacheAgent::elab() {
   for (MessageQueue* msgq : l1_l2__cmd_qs_) {
     arb_->add_requester(msgq);
   }
+  // Bind statistics block.
+  if (statistics_ != nullptr) {
+    stats_ = statistics_->register_block<L2CacheStatBlock>(path());
+    stats_->bind_cache(cache_->stats());
+  }
   return false;
 }
 
@@ -748,7 +589,7 @@ void L2CacheAgent::set_l2_cc__cmd_q(MessageQueue* mq) {
 }
 
 void L2CacheAgent::set_l2_l1__rsp_q(L1CacheAgent* l1cache, MessageQueue* mq) {
-  l2_l1__rsp_qs_[l1cache] = mq;
+  l2_l1__rsp_qs_[l1cache->l2_id()] = mq;
 }
 
 void L2CacheAgent::set_l2_cc__snprsp_q(MessageQueue* mq) {
@@ -771,6 +612,26 @@ void L2CacheAgent::drc() {
     LogMessage msg{"L2 has no child L1 cache(s).", Level::Warning};
     log(msg);
   }
+
+  if (l1cs_.size() > 64) {
+    // L1 holding a line are tracked in a single word.
+    LogMessage msg("L2 supports at most 64 child L1 caches.", Level::Fatal);
+    log(msg);
+  }
+
+  for (std::size_t i = 0; i < l1cs_.size(); i++) {
+    if (l1cs_[i]->l2_id() != i || l2_l1__rsp_qs_[i] == nullptr) {
+      LogMessage msg("L1 cache has not been bound: ", Level::Fatal);
+      msg.append(l1cs_[i]->path());
+      log(msg);
+    }
+  }
+}
+
+void L2CacheAgent::reset() {
+  // Reclaim line and transaction state.
+  cache_->reset([](L2LineState* line) { delete line; });
+  for (const auto& p : *tt_) p.second->release();
 }
 
 void L2CacheAgent::set_cache_line_modified(addr_t addr) {
@@ -50,6 +50,12 @@ class CCAgent;
 class L2TState;
 class L2CoherenceAction;
 class Monitor;
+class Statistics;
+struct L2CacheStatBlock;
+
+// Set of child L1 caches, where bit 'i' denotes the L1 at position
+// 'i' within the cluster.
+using L1Mask = std::uint64_t;
 
 //
 //
@@ -225,8 +231,11 @@ class L2Command {
   // Command Coherence action
   L2CoherenceAction* action() const { return oprands.action; }
 
-  // "Agent" keep out list.
-  const std::vector<L1CacheAgent*>& agents() const { return oprands.agents; }
+  // Set of L1 to which the command is applied.
+  L1Mask l1s() const { return oprands.l1s; }
+
+  // Subset of 'l1s' which own the line.
+  L1Mask owners() const { return oprands.owners; }
 
   // Command address
   addr_t addr() const { return oprands.addr; }
@@ -236,8 +245,11 @@ class L2Command {
   // Set command address
   void set_addr(addr_t addr) { oprands.addr = addr; }
 
-  // Agent keep out set.
-  std::vector<L1CacheAgent*>& agents() { return oprands.agents; }
+  // Set L1 to which the command is applied.
+  void set_l1s(L1Mask l1s) { oprands.l1s = l1s; }
+
+  // Set subset of 'l1s' which own the line.
+  void set_owners(L1Mask owners) { oprands.owners = owners; }
 
  private:
 
@@ -245,7 +257,8 @@ class L2Command {
   struct {
     addr_t addr;
     L2CoherenceAction* action;
-    std::vector<L1CacheAgent*> agents;
+    L1Mask l1s;
+    L1Mask owners = 0;
   } oprands;
 
   // Command opcode.
@@ -365,7 +378,8 @@ class L2CoherenceAction {
   // Invoke/Execute coherence action
   virtual bool execute() = 0;
 
-  virtual void release() { delete this; }
+  // Release action back to pool, or destruct.
+  virtual void release() const { delete this; }
 
  protected:
   virtual ~L2CoherenceAction() = default;
@@ -537,6 +551,8 @@ class L2CacheContext {
 //
 //
 class L2CacheAgent : public Agent {
+  class MainProcessBase;
+  template <typename>
   class MainProcess;
 
   friend class CpuCluster;
@@ -552,7 +568,7 @@ class L2CacheAgent : public Agent {
   // L1 Cache Command Queue (n)
   MessageQueue* l1_l2__cmd_q(std::size_t n) const { return l1_l2__cmd_qs_[n]; }
   // L2 -> L1 response queue
-  MessageQueue* l2_l1__rsp_q(L1CacheAgent* l1cache) const;
+  MessageQueue* l2_l1__rsp_q(const L1CacheAgent* l1cache) const;
   // L2 -> CC command queue
   MessageQueue* l2_cc__cmd_q() const { return l2_cc__cmd_q_; }
   // CC -> L2 (Snoop) command queue
@@ -563,6 +579,20 @@ class L2CacheAgent : public Agent {
   MessageQueue* l2_cc__snprsp_q() const { return l2_cc__snprsp_q_; }
 
  protected:
+  // Main process factory.
+  using main_factory = MainProcessBase* (*)(kernel::Kernel*,
+                                            const std::string&, L2CacheAgent*);
+
+  // Construct agent where the main process is constructed by 'f'.
+  L2CacheAgent(kernel::Kernel* k, const L2CacheAgentConfig& config,
+               main_factory f);
+
+  // Construct main process specialized on protocol ProtocolT.
+  template <typename ProtocolT>
+  static MainProcessBase* construct_main(kernel::Kernel* k,
+                                         const std::string& name,
+                                         L2CacheAgent* model);
+
   // Accessors:
   // Pointer to module arbiter instance.
   MQArb* arb() const { return arb_; }
@@ -572,13 +602,17 @@ class L2CacheAgent : public Agent {
   L2CacheAgentProtocol* protocol() const { return protocol_; }
   // Transaction table.
   L2TTable* tt() const { return tt_; }
+  // L2 Cache statistics (nullptr if statistics are disabled).
+  L2CacheStatBlock* stats() const { return stats_; }
 
   // Construction:
-  void build();
+  void build(main_factory f);
   // Add L1 cache child.
   void add_l1c(L1CacheAgent* l1c);
   // Register verification monitor instance.
   void register_monitor(Monitor* monitor);
+  // Register statistics.
+  void register_statistics(Statistics* statistics);
 
   // Elaboration:
   bool elab() override;
@@ -595,6 +629,9 @@ class L2CacheAgent : public Agent {
   // Design Rule Check (DRC) callback
   void drc() override;
 
+  // Reset callback
+  void reset() override;
+
   // "Back-door" write-through cache related method(s):
 
   // Set cache line 'addr' to Modified state. Expects line to be
@@ -612,8 +649,8 @@ class L2CacheAgent : public Agent {
   std::vector<L1CacheAgent*> l1cs_;
   // L1 -> L2 Command Request
   std::vector<MessageQueue*> l1_l2__cmd_qs_;
-  // L2 -> L1 Response queue
-  std::map<L1CacheAgent*, MessageQueue*> l2_l1__rsp_qs_;
+  // L2 -> L1 Response queue (indexed by L1 position).
+  std::vector<MessageQueue*> l2_l1__rsp_qs_;
   // L2 -> CC Command Queue (CC owned)
   MessageQueue* l2_cc__cmd_q_ = nullptr;
   // CC -> L2 Command Queue (L2 owned)
@@ -634,8 +671,12 @@ class L2CacheAgent : public Agent {
   L2CacheAgentProtocol* protocol_ = nullptr;
   // Verification monitor instance.
   Monitor* monitor_ = nullptr;
+  // Statistics registry
+  Statistics* statistics_ = nullptr;
+  // L2 Cache statistics
+  L2CacheStatBlock* stats_ = nullptr;
   // Main process of execution.
-  MainProcess* main_;
+  MainProcessBase* main_ = nullptr;
 };
 
 }  // namespace cc
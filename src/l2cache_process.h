@@ -0,0 +1,314 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#ifndef CC_SRC_L2CACHE_PROCESS_H
+#define CC_SRC_L2CACHE_PROCESS_H
+
+#include "cache.h"
+#include "l2cache.h"
+#include "protocol.h"
+#include "utility.h"
+
+namespace cc {
+
+// Protocol independent component of the L2 main process of
+// execution.
+//
+class L2CacheAgent::MainProcessBase : public AgentProcess {
+ public:
+  MainProcessBase(kernel::Kernel* k, const std::string& name,
+                  L2CacheAgent* model);
+
+  // Set cache line 'addr' to Modified state.
+  virtual void set_cache_line_modified(addr_t addr) = 0;
+
+ protected:
+  // Initialization:
+  void init() override;
+
+  // Permute command list 'cl' to a wait list if the agent has
+  // insufficient resources to execute it.
+  void check_resources(L2CacheContext& ctxt, L2CommandList& cl) const;
+
+  // Execute command list 'cl'.
+  void execute(L2CacheContext& ctxt, const L2CommandList& cl);
+
+  // Pointer to parent L2.
+  L2CacheAgent* model_ = nullptr;
+};
+
+// L2 main process of execution specialized on the protocol type (see
+// L1CacheAgent::MainProcess).
+//
+template <typename ProtocolT>
+class L2CacheAgent::MainProcess : public L2CacheAgent::MainProcessBase {
+  using cb = L2CommandBuilder;
+
+ public:
+  MainProcess(kernel::Kernel* k, const std::string& name, L2CacheAgent* model)
+      : MainProcessBase(k, name, model) {}
+
+  // Evaluation:
+  void eval() override {
+    MQArb* arb = model_->arb();
+
+    // Construct and initialize current processing context.
+    L2CommandList cl;
+    L2CacheContext ctxt;
+    ctxt.set_t(arb->tournament());
+    ctxt.set_l2cache(model_);
+
+    // Check if requests are present, if not block until a new message
+    // arrives at the arbiter. Process should ideally not wake in the
+    // absence of requesters.
+    if (!ctxt.t().has_requester()) {
+      cl.push_back(L2Opcode::WaitOnMsg);
+      execute(ctxt, cl);
+      return;
+    }
+
+    // Fetch nominated message queue
+    ctxt.set_mq(ctxt.t().winner());
+    // Responses take priority over snoops; a snoop to the line may
+    // otherwise overtake the response which completes the line's
+    // transaction.
+    if (MessageQueue* rsp_q = model_->cc_l2__rsp_q();
+        ctxt.mq() == model_->cc_l2__cmd_q() && rsp_q->has_req() &&
+        !rsp_q->blocked()) {
+      ctxt.set_mq(rsp_q);
+    }
+
+    // Dispatch to appropriate message class
+    const MessageClass cls = ctxt.msg()->cls();
+    switch (cls) {
+      case MessageClass::L2Cmd: {
+        process_l2cmd(ctxt, cl);
+      } break;
+      case MessageClass::AceCmdRsp: {
+        process_acecmdrsp(ctxt, cl);
+      } break;
+      case MessageClass::AceSnoop: {
+        process_acesnoop(ctxt, cl);
+      } break;
+      default: {
+        using cc::to_string;
+
+        LogMessage lmsg("Invalid message class received: ");
+        lmsg.append(to_string(ctxt.msg()->cls()));
+        lmsg.set_level(Level::Fatal);
+        log(lmsg);
+      } break;
+    }
+
+    LogMessage lm("Execute message: ");
+    lm.append(ctxt.msg()->to_string());
+    lm.set_level(Level::Debug);
+    log(lm);
+
+    check_resources(ctxt, cl);
+    execute(ctxt, cl);
+  }
+
+  void set_cache_line_modified(addr_t addr) override {
+    L2CommandList cl;
+    L2CacheContext ctxt;
+    ctxt.set_l2cache(model_);
+    const ProtocolT* protocol = this->protocol();
+    L2CacheModel* cache = model_->cache();
+    const CacheAddressHelper ah = cache->ah();
+
+    L2CacheModelSet set = cache->set(ah.set(addr));
+    if (auto it = set.find(ah.tag(addr));it != set.end()) {
+      ctxt.set_line(it->t());
+      protocol->set_modified_status(ctxt, cl);
+    } else {
+      LogMessage msg(
+          "L1 attempts to set modified state of cache line but "
+          "cache line is not resident in L2.");
+      msg.set_level(Level::Fatal);
+      log(msg);
+    }
+    execute(ctxt, cl);
+  }
+
+ private:
+  // Protocol instance, as its specialized type.
+  const ProtocolT* protocol() const {
+    return static_cast<const ProtocolT*>(model_->protocol());
+  }
+
+  void process_l2cmd(L2CacheContext& ctxt, L2CommandList& cl) const {
+    const L2CmdMsg* cmd = static_cast<const L2CmdMsg*>(ctxt.msg());
+    L2CacheModel* cache = model_->cache();
+    const CacheAddressHelper ah = cache->ah();
+    const ProtocolT* protocol = this->protocol();
+
+    // Where a transaction is already in flight to the line (on behalf
+    // of another L1), the command cannot be applied until the line
+    // has attained its final state; block until the transaction ends.
+    if (L2TState* inflight = lookup_inflight(cmd->addr());
+        inflight != nullptr) {
+      ctxt.set_tstate(inflight);
+      ctxt.set_owns_tstate(false);
+      cl.push_back(L2Opcode::MqSetBlockedOnTransaction);
+      cl.push_back(L2Opcode::WaitNextEpoch);
+      return;
+    }
+
+    // Command starts new transaction, therefore construct new
+    // transaction table entry; unclear at this point whether
+    // transaction will start, therefore context owns tstate upon
+    // destruction.
+    L2TState* tstate = new L2TState(k());
+    ctxt.set_tstate(tstate);
+    ctxt.set_owns_tstate(true);
+
+    // Cache line state.
+    L2LineState* line = nullptr;
+
+    L2CacheModelSet set = cache->set(ah.set(cmd->addr()));
+    L2CacheModelLineIt it = set.find(ah.tag(cmd->addr()));
+    const bool has_cache_line = (it != set.end());
+    switch (const L2CmdOpcode opcode = cmd->opcode(); opcode) {
+      case L2CmdOpcode::L1GetS:
+      case L2CmdOpcode::L1GetE: {
+        if (!has_cache_line) {
+          // Line for current address has not been found in the set,
+          // therefore a new line must either be installed or, if the set
+          // is currently full, another line must be nominated and
+          // evicted.
+          L2CacheModel::Evictor evictor;
+          if (const std::pair<L2CacheModelLineIt, bool> p =
+                  evictor.nominate(set.begin(), set.end());
+              p.second) {
+            // Eviction required before command can complete.
+            // TODO
+          } else {
+            // Eviction not required for the command to complete.
+            line = protocol->construct_line();
+            ctxt.set_line(line);
+            ctxt.set_owns_line(true);
+            tstate->set_line(line);
+            protocol->apply(ctxt, cl);
+          }
+        } else {
+          // Line is present in the cache, apply state update.
+          line = it->t();
+          ctxt.set_line(line);
+          tstate->set_line(line);
+          protocol->apply(ctxt, cl);
+        }
+      } break;
+      case L2CmdOpcode::L1Put: {
+        if (has_cache_line) {
+          line = it->t();
+          ctxt.set_line(line);
+          tstate->set_line(line);
+          protocol->apply(ctxt, cl);
+        } else {
+          LogMessage msg(
+              "L1 requests eviction of line which is not present "
+              "in L2; simulation assumes inclusive cache model.");
+          msg.set_level(Level::Fatal);
+          log(msg);
+        }
+      } break;
+      default: {
+        // Unknown opcode.
+      } break;
+    }
+  }
+
+  // Transaction in flight to the line containing 'addr', or nullptr.
+  L2TState* lookup_inflight(addr_t addr) const {
+    const CacheAddressHelper ah = model_->cache()->ah();
+    for (const auto& p : *model_->tt()) {
+      L2TState* tstate = p.second;
+      if ((ah.set(tstate->addr()) == ah.set(addr)) &&
+          (ah.tag(tstate->addr()) == ah.tag(addr))) {
+        return tstate;
+      }
+    }
+    return nullptr;
+  }
+
+  void process_acecmdrsp(L2CacheContext& ctxt, L2CommandList& cl) const {
+    Transaction* t = ctxt.msg()->t();
+    L2TTable* tt = model_->tt();
+    if (auto it = tt->find(t); it != tt->end()) {
+      const ProtocolT* protocol = this->protocol();
+      ctxt.set_tstate(it->second);
+      ctxt.set_line(ctxt.tstate()->line());
+      protocol->apply(ctxt, cl);
+    } else {
+      LogMessage lm("Cannot find transaction table entry for ");
+      lm.append(to_string(t));
+      lm.set_level(Level::Fatal);
+      log(lm);
+    }
+  }
+
+  void process_acesnoop(L2CacheContext& ctxt, L2CommandList& cl) const {
+    // Lookup cache line of interest
+    L2CacheModel* cache = model_->cache();
+    const CacheAddressHelper ah = cache->ah();
+    const AceSnpMsg* msg = static_cast<const AceSnpMsg*>(ctxt.msg());
+    ctxt.set_addr(msg->addr());
+    const auto set = cache->set(ah.set(msg->addr()));
+    if (auto it = set.find(ah.tag(msg->addr())); it != set.end()) {
+      // Found line in cache; set constext
+      ctxt.set_line(it->t());
+    } else {
+      // Line is not present. Where the directory's sharer encoding is
+      // imprecise, agents which do not hold the line may be snooped.
+      ctxt.set_silently_evicted(true);
+    }
+    ctxt.set_owns_line(false);
+    const ProtocolT* protocol = this->protocol();
+    protocol->apply(ctxt, cl);
+  }
+};
+
+
+template <typename ProtocolT>
+L2CacheAgent::MainProcessBase* L2CacheAgent::construct_main(
+    kernel::Kernel* k, const std::string& name, L2CacheAgent* model) {
+  return new MainProcess<ProtocolT>(k, name, model);
+}
+
+// L2 cache agent specialized on the protocol type ProtocolT.
+//
+template <typename ProtocolT>
+class L2CacheAgentT : public L2CacheAgent {
+ public:
+  L2CacheAgentT(kernel::Kernel* k, const L2CacheAgentConfig& config)
+      : L2CacheAgent(k, config, &L2CacheAgent::construct_main<ProtocolT>) {}
+};
+
+}  // namespace cc
+
+#endif
@@ -27,11 +27,11 @@
 
 #include "llc.h"
 
-#include "cpucluster.h"
 #include "dir.h"
 #include "mem.h"
 #include "msg.h"
 #include "noc.h"
+#include "stats.h"
 #include "utility.h"
 
 namespace cc {
@@ -141,33 +141,37 @@ class LLCTState {
 //
 class LLCAgent::RdisProcess : public AgentProcess {
  public:
-  RdisProcess(kernel::Kernel* k, const std::string& name, LLCAgent* model)
-      : AgentProcess(k, name), model_(model) {}
+  RdisProcess(kernel::Kernel* k, const std::string& name, LLCAgent* model,
+              Bank* bank)
+      : AgentProcess(k, name), model_(model), bank_(bank) {}
 
  private:
   // Initialization
   void init() override {
-    MQArb* arb = model_->arb();
+    MQArb* arb = bank_->arb;
     wait_on(arb->request_arrival_event());
   }
 
   // Elaboration
   void eval() override {
-    MQArb* arb = model_->arb();
+    MQArb* arb = bank_->arb;
     MQArbTmt t;
 
     t = arb->tournament();
     if (t.has_requester()) {
-      const Message* msg = t.winner()->dequeue();
-
-      // Check NOC ingress queue credits; assumes that all message
-      // types require a NOC transaction.
+      // Check NOC ingress queue credits before the message is
+      // consumed; assumes that all message types require a NOC
+      // transaction.
       if (CreditCounter* cc = model_->llc_noc__port()->ingress_cc();
           cc->empty()) {
         // Wait until a credit has been replenished.
+        if (LLCStatBlock* stats = model_->stats(); stats != nullptr) {
+          stats->credit_stall_n.inc();
+        }
         wait_on(cc->credit_event());
         return;
       }
+      const Message* msg = t.winner()->dequeue();
 
       LogMessage lm;
       lm.append("Execute message: ");
@@ -205,6 +209,16 @@ class LLCAgent::RdisProcess : public AgentProcess {
 
   void process(const LLCCmdMsg* msg) {
     const LLCCmdOpcode opcode = msg->opcode();
+    if (LLCStatBlock* stats = model_->stats(); stats != nullptr) {
+      if (opcode == LLCCmdOpcode::Fill) stats->fill_n.inc();
+      if (opcode == LLCCmdOpcode::PutLine) stats->put_n.inc();
+      // Further commands are pending on the bank and must wait until
+      // the current access has completed.
+      if (!bank_->dir_llc__cmd_q->empty()) stats->bank_conflict_n.inc();
+    }
+    // Messages emitted upon the bank access are delayed by the bank
+    // access latency.
+    const cursor_t cursor = model_->config().access_latency;
     switch (opcode) {
       case LLCCmdOpcode::Fill: {
         // Message to LLC
@@ -212,8 +226,9 @@ class LLCAgent::RdisProcess : public AgentProcess {
         memcmd->set_origin(model_);
         memcmd->set_opcode(MemCmdOpcode::Read);
         memcmd->set_dest(model_);
+        memcmd->set_addr(msg->addr());
         memcmd->set_t(msg->t());
-        issue_emit_to_noc(model_->mc(), memcmd);
+        issue_emit_to_noc(model_->mc(msg->addr()), memcmd, cursor);
 
         LLCTState* tstate = new LLCTState;
         tstate->set_state(State::FillAwaitMemRsp);
@@ -229,7 +244,7 @@ class LLCAgent::RdisProcess : public AgentProcess {
         DtMsg* dt = Pool<DtMsg>::construct();
         dt->set_origin(model_);
         dt->set_t(msg->t());
-        issue_emit_to_noc(msg->agent(), dt);
+        issue_emit_to_noc(msg->agent(), dt, cursor);
 
         LLCTState* tstate = new LLCTState;
         tstate->set_state(State::PutAwaitCCDtRsp);
@@ -246,6 +261,7 @@ class LLCAgent::RdisProcess : public AgentProcess {
     LLCTState* tstate = lookup_state_or_fatal(msg->t());
     switch (tstate->state()) {
       case State::FillAwaitMemRsp: {
+        msg->t()->stamp(TransactionStage::Fill, k()->time());
         LLCCmdRspMsg* llcrsp = Pool<LLCCmdRspMsg>::construct();
         llcrsp->set_t(msg->t());
         llcrsp->set_opcode(tstate->opcode());
@@ -288,15 +304,16 @@ class LLCAgent::RdisProcess : public AgentProcess {
   }
 
   void install_state_or_fatal(Transaction* t, LLCTState* tstate) {
-    std::map<Transaction*, LLCTState*>* tt = model_->tt();
+    std::map<Transaction*, LLCTState*>* tt = bank_->tt;
     if (auto pp = tt->insert(std::make_pair(t, tstate)); !pp.second) {
       LogMessage msg("Could not install transaction state.");
       msg.set_level(Level::Fatal);
       log(msg);
     }
+    model_->t_bank_[t] = bank_;
   }
   LLCTState* lookup_state_or_fatal(Transaction* t) const {
-    std::map<Transaction*, LLCTState*>* tt = model_->tt();
+    std::map<Transaction*, LLCTState*>* tt = bank_->tt;
     LLCTState* st = nullptr;
     if (auto it = tt->find(t); it != tt->end()) {
       st = it->second;
@@ -310,10 +327,11 @@ class LLCAgent::RdisProcess : public AgentProcess {
     return st;
   }
   void erase_state_or_fatal(Transaction* t) {
-    std::map<Transaction*, LLCTState*>* tt = model_->tt();
+    std::map<Transaction*, LLCTState*>* tt = bank_->tt;
     if (auto it = tt->find(t); it != tt->end()) {
       delete it->second;
       tt->erase(it);
+      model_->t_bank_.erase(t);
     } else {
       LogMessage msg("Transaction not found in table.");
       msg.set_level(Level::Fatal);
@@ -321,7 +339,8 @@ class LLCAgent::RdisProcess : public AgentProcess {
     }
   }
 
-  void issue_emit_to_noc(Agent* dest, const Message* msg) {
+  void issue_emit_to_noc(Agent* dest, const Message* msg,
+                         cursor_t cursor = 0) {
     NocMsg* nocmsg = Pool<NocMsg>::construct();
     nocmsg->set_origin(model_);
     nocmsg->set_dest(dest);
@@ -333,39 +352,57 @@ class LLCAgent::RdisProcess : public AgentProcess {
     cc->debit();
     // Issue to NOC
     MessageQueue* mq = port->ingress();
-    mq->issue(nocmsg);
+    mq->issue(nocmsg, cursor);
   }
 
   // Pointer to owning LLC instance.
   LLCAgent* model_ = nullptr;
+  // Pointer to serviced bank.
+  Bank* bank_ = nullptr;
 };
 
 //
 //
 class LLCNocEndpoint : public NocEndpoint {
  public:
-  LLCNocEndpoint(kernel::Kernel* k, const std::string& name)
-      : NocEndpoint(k, name) {}
-  //
-  void register_endpoint(MessageClass cls, MessageQueue* p) {
-    endpoints_.insert(std::make_pair(cls, p));
-  }
+  LLCNocEndpoint(kernel::Kernel* k, const std::string& name, LLCAgent* model)
+      : NocEndpoint(k, name), model_(model) {}
   //
   MessageQueue* lookup_mq(const Message* msg) const override {
-    if (auto it = endpoints_.find(msg->cls()); it != endpoints_.end()) {
-      return it->second;
-    } else {
-      LogMessage lm("End point not register for class: ");
-      lm.append(cc::to_string(msg->cls()));
-      lm.set_level(Level::Fatal);
-      log(lm);
+    switch (msg->cls()) {
+      case MessageClass::LLCCmd: {
+        // Commands are routed to the bank to which the line is
+        // interleaved.
+        const LLCCmdMsg* cmd = static_cast<const LLCCmdMsg*>(msg);
+        return model_->bank(model_->bank_index(cmd->addr()))->dir_llc__cmd_q;
+      } break;
+      case MessageClass::MemRsp:
+      case MessageClass::DtRsp: {
+        // Responses are routed to the bank on which the associated
+        // command is in flight.
+        if (LLCAgent::Bank* bank = model_->bank_by_t(msg->t());
+            bank != nullptr) {
+          return (msg->cls() == MessageClass::MemRsp) ? bank->mem_llc__rsp_q
+                                                      : bank->cc_llc__rsp_q;
+        }
+        LogMessage lm("Response for transaction not in flight: ");
+        lm.append(msg->to_string());
+        lm.set_level(Level::Fatal);
+        log(lm);
+      } break;
+      default: {
+        LogMessage lm("End point not register for class: ");
+        lm.append(cc::to_string(msg->cls()));
+        lm.set_level(Level::Fatal);
+        log(lm);
+      } break;
     }
     return nullptr;
   }
 
  private:
-  //
-  std::map<MessageClass, MessageQueue*> endpoints_;
+  // Owning LLC instance.
+  LLCAgent* model_ = nullptr;
 };
 
 LLCAgent::LLCAgent(kernel::Kernel* k, const LLCAgentConfig& config)
@@ -374,58 +411,64 @@ LLCAgent::LLCAgent(kernel::Kernel* k, const LLCAgentConfig& config)
 }
 
 LLCAgent::~LLCAgent() {
-  delete dir_llc__cmd_q_;
-  delete mem_llc__rsp_q_;
-  delete arb_;
-  delete rdis_proc_;
-  delete noc_endpoint_;
-  for (MessageQueue* mq : cc_llc__rsp_qs_) {
-    delete mq;
+  for (Bank* bank : banks_) {
+    delete bank->dir_llc__cmd_q;
+    delete bank->mem_llc__rsp_q;
+    delete bank->cc_llc__rsp_q;
+    delete bank->arb;
+    delete bank->rdis_proc;
+    delete bank->tt;
+    delete bank;
   }
-  delete tt_;
+  delete noc_endpoint_;
 }
 
 void LLCAgent::build() {
-  // DIR -> LLC command queue
-  dir_llc__cmd_q_ = new MessageQueue(k(), "dir_llc__cmd_q", 30);
-  add_child_module(dir_llc__cmd_q_);
-  // MEM -> LLC response queue
-  mem_llc__rsp_q_ = new MessageQueue(k(), "mem_llc__rsp_q", 30);
-  add_child_module(mem_llc__rsp_q_);
-  // Construct arbiter
-  arb_ = new MQArb(k(), "arb");
-  add_child_module(arb_);
-  // Construct main thread
-  rdis_proc_ = new RdisProcess(k(), "main", this);
-  rdis_proc_->set_epoch(config_.epoch);
-  add_child_process(rdis_proc_);
+  for (std::size_t i = 0; i < config_.bank_n; i++) {
+    // Bank child modules are suffixed by the bank index only when
+    // banked.
+    const std::string sfx =
+        (config_.bank_n > 1) ? ("_" + std::to_string(i)) : "";
+    Bank* bank = new Bank;
+    // DIR -> LLC command queue
+    bank->dir_llc__cmd_q = new MessageQueue(k(), "dir_llc__cmd_q" + sfx, 30);
+    add_child_module(bank->dir_llc__cmd_q);
+    // MEM -> LLC response queue
+    bank->mem_llc__rsp_q = new MessageQueue(k(), "mem_llc__rsp_q" + sfx, 30);
+    add_child_module(bank->mem_llc__rsp_q);
+    // CC -> LLC response queue
+    bank->cc_llc__rsp_q = new MessageQueue(k(), "cc_llc__rsp_q" + sfx, 30);
+    add_child_module(bank->cc_llc__rsp_q);
+    // Construct arbiter
+    bank->arb = new MQArb(k(), "arb" + sfx);
+    add_child_module(bank->arb);
+    // Construct main thread
+    bank->rdis_proc = new RdisProcess(k(), "main" + sfx, this, bank);
+    bank->rdis_proc->set_epoch(config_.epoch);
+    add_child_process(bank->rdis_proc);
+    // Construct transaction table.
+    bank->tt = new std::map<Transaction*, LLCTState*>;
+    banks_.push_back(bank);
+  }
+  bank_il_ = AddrInterleaver(config_.bank_interleave, config_.bank_n);
   // NOC endpoint
-  noc_endpoint_ = new LLCNocEndpoint(k(), "noc_ep");
+  noc_endpoint_ = new LLCNocEndpoint(k(), "noc_ep", this);
   noc_endpoint_->set_epoch(config_.epoch);
   add_child_module(noc_endpoint_);
-  // Construct transaction table.
-  tt_ = new std::map<Transaction*, LLCTState*>;
 }
 
-void LLCAgent::register_cc(CpuCluster* cc) {
-  const std::string mq_name = cc->name() + "_mq";
-  MessageQueue* mq = new MessageQueue(k(), mq_name, 30);
-  add_child_module(mq);
-  cc_llc__rsp_qs_.push_back(mq);
+void LLCAgent::register_statistics(Statistics* statistics) {
+  statistics_ = statistics;
 }
 
 bool LLCAgent::elab() {
-  arb_->add_requester(dir_llc__cmd_q_);
-  arb_->add_requester(mem_llc__rsp_q_);
-  for (MessageQueue* mq : cc_llc__rsp_qs_) {
-    arb_->add_requester(mq);
+  for (Bank* bank : banks_) {
+    bank->arb->add_requester(bank->dir_llc__cmd_q);
+    bank->arb->add_requester(bank->mem_llc__rsp_q);
+    bank->arb->add_requester(bank->cc_llc__rsp_q);
   }
-
-  //
-  noc_endpoint_->register_endpoint(MessageClass::LLCCmd, dir_llc__cmd_q_);
-  noc_endpoint_->register_endpoint(MessageClass::MemRsp, mem_llc__rsp_q_);
-  for (MessageQueue* mq : cc_llc__rsp_qs_) {
-    noc_endpoint_->register_endpoint(MessageClass::DtRsp, mq);
+  if (statistics_ != nullptr) {
+    stats_ = statistics_->register_block<LLCStatBlock>(path());
   }
   return false;
 }
@@ -436,6 +479,35 @@ void LLCAgent::drc() {
     msg.set_level(Level::Fatal);
     log(msg);
   }
+  if (mcs_.empty()) {
+    LogMessage msg("LLC has no memory controllers bound.");
+    msg.set_level(Level::Fatal);
+    log(msg);
+  }
+  if (banks_.empty()) {
+    LogMessage msg("LLC has no banks.");
+    msg.set_level(Level::Fatal);
+    log(msg);
+  }
+  const InterleaveConfig& il = config_.bank_interleave;
+  auto is_pow2 = [](std::uint64_t x) {
+    return (x != 0) && ((x & (x - 1)) == 0);
+  };
+  if (!is_pow2(il.line_bytes) || !is_pow2(il.page_bytes)) {
+    LogMessage msg(
+        "Bank interleave line and page sizes must be powers of two.");
+    msg.set_level(Level::Fatal);
+    log(msg);
+  }
+}
+
+void LLCAgent::reset() {
+  // Reclaim transaction state.
+  for (Bank* bank : banks_) {
+    for (const auto& p : *bank->tt) delete p.second;
+    bank->tt->clear();
+  }
+  t_bank_.clear();
 }
 
 MessageQueue* LLCAgent::endpoint() const { return noc_endpoint_->ingress_mq(); }
@@ -29,11 +29,13 @@
 #define CC_SRC_LLC_H
 
 #include <map>
+#include <unordered_map>
 
 #include "cc/cfgs.h"
 #include "cc/kernel.h"
 #include "msg.h"
 #include "sim.h"
+#include "utility.h"
 
 namespace cc {
 
@@ -47,6 +49,8 @@ class CpuCluster;
 class NocPort;
 class Stimulus;
 class LLCTState;
+class Statistics;
+struct LLCStatBlock;
 
 //
 //
@@ -154,8 +158,26 @@ class LLCAgent : public Agent {
   class RdisProcess;
 
   friend class SocTop;
+  friend class LLCNocEndpoint;
 
  public:
+  // Bank; an independent pipeline servicing the lines interleaved to
+  // it.
+  struct Bank {
+    // DIR -> LLC command queue (LLC owned)
+    MessageQueue* dir_llc__cmd_q = nullptr;
+    // MEM -> LLC response queue (LLC owned)
+    MessageQueue* mem_llc__rsp_q = nullptr;
+    // CC -> LLC response queue (LLC owned)
+    MessageQueue* cc_llc__rsp_q = nullptr;
+    // Queue selector arbiter
+    MQArb* arb = nullptr;
+    // Request dispatcher process.
+    RdisProcess* rdis_proc = nullptr;
+    // Transaction table.
+    std::map<Transaction*, LLCTState*>* tt = nullptr;
+  };
+
   LLCAgent(kernel::Kernel* k, const LLCAgentConfig& config);
   ~LLCAgent();
 
@@ -167,56 +189,75 @@ class LLCAgent : public Agent {
   MessageQueue* endpoint() const;
   // LLC -> NOC message queue
   NocPort* llc_noc__port() const { return llc_noc__port_; }
-  // Home memory controller
-  MemCntrlAgent* mc() const { return mc_; }
+  // Home memory controller of line 'addr'.
+  MemCntrlAgent* mc(addr_t addr) const { return mcs_[mc_il_.index(addr)]; }
   // Directory model instance.
   DirAgent* dir() const { return dir_; }
+  // Number of banks.
+  std::size_t banks_n() const { return banks_.size(); }
+  // Bank 'i'.
+  const Bank* bank(std::size_t i) const { return banks_[i]; }
+  // Index of the bank to which line 'addr' is interleaved.
+  std::size_t bank_index(addr_t addr) const { return bank_il_.index(addr); }
+  // Bank with transaction 't' in flight, or nullptr.
+  Bank* bank_by_t(Transaction* t) const {
+    if (auto it = t_bank_.find(t); it != t_bank_.end()) return it->second;
+    return nullptr;
+  }
 
  protected:
   // Construction/Build
   void build();
-  //
-  void register_cc(CpuCluster* cc);
+  // Register statistics.
+  void register_statistics(Statistics* statistics);
 
   // Elaboration
   bool elab() override;
   // NOC -> LLC message queue
   void set_llc_noc__port(NocPort* port);
-  // Set memory controller.
-  void set_mc(MemCntrlAgent* mc) { mc_ = mc; }
+  // Set memory controllers; lines are interleaved across controllers
+  // as per 'cfg'.
+  void set_mcs(const std::vector<MemCntrlAgent*>& mcs,
+               const InterleaveConfig& cfg) {
+    mcs_ = mcs;
+    mc_il_ = AddrInterleaver(cfg, mcs.size());
+  }
   // Set owner directory.
   void set_dir(DirAgent* dir) { dir_ = dir; }
 
   // Design Rule Check
   void drc() override;
+  // Reset
+  void reset() override;
   // Accessors:
 
-  // Queue arbiter:
-  MQArb* arb() const { return arb_; }
-  //
-  std::map<Transaction*, LLCTState*>* tt() const { return tt_; }
+  // Bank 'i'.
+  Bank* bank(std::size_t i) { return banks_[i]; }
+  // Statistics (nullptr if statistics are disabled).
+  LLCStatBlock* stats() const { return stats_; }
 
  private:
   // LLC -> NOC command queue (NOC owned)
   NocPort* llc_noc__port_ = nullptr;
-  // DIR -> LLC command queue (LLC owned)
-  MessageQueue* dir_llc__cmd_q_ = nullptr;
-  // MEM -> LLC response queue (LLC owned)
-  MessageQueue* mem_llc__rsp_q_ = nullptr;
-  //
-  std::vector<MessageQueue*> cc_llc__rsp_qs_;
-  // Queue selector arbiter
-  MQArb* arb_ = nullptr;
-  // Home memory controller
-  MemCntrlAgent* mc_ = nullptr;
+  // Banks
+  std::vector<Bank*> banks_;
+  // Line address to bank index map.
+  AddrInterleaver bank_il_;
+  // In flight transaction to servicing bank map; responses carry no
+  // address from which the bank may otherwise be recovered.
+  std::unordered_map<Transaction*, Bank*> t_bank_;
+  // Memory controllers
+  std::vector<MemCntrlAgent*> mcs_;
+  // Line address to memory controller index map.
+  AddrInterleaver mc_il_;
   // Home directory.
   DirAgent* dir_ = nullptr;
-  // Transaction table.
-  std::map<Transaction*, LLCTState*>* tt_ = nullptr;
-  // Request distruction process.
-  RdisProcess* rdis_proc_ = nullptr;
   // NOC endpoint
   LLCNocEndpoint* noc_endpoint_ = nullptr;
+  // Statistics registry
+  Statistics* statistics_ = nullptr;
+  // LLC statistics
+  LLCStatBlock* stats_ = nullptr;
   // LLC Cache configuration
   LLCAgentConfig config_;
 };
@@ -27,7 +27,9 @@
 
 #include "mem.h"
 
+#include "dram.h"
 #include "noc.h"
+#include "stats.h"
 #include "utility.h"
 
 namespace cc {
@@ -67,10 +69,12 @@ MemCmdMsg::MemCmdMsg() : Message(MessageClass::MemCmd) {}
 std::string MemCmdMsg::to_string() const {
   using cc::to_string;
 
+  Hexer h;
   KVListRenderer r;
   render_msg_fields(r);
   r.add_field("opcode", to_string(opcode()));
   r.add_field("dest", dest()->path());
+  r.add_field("addr", h.to_hex(addr()));
   return r.to_string();
 }
 
@@ -127,6 +131,16 @@ class MemCntrlAgent::RequestDispatcherProcess : public AgentProcess {
 
   // Evaluation
   void eval() override {
+    if (model_->dram() != nullptr) {
+      eval_dram();
+    } else {
+      eval_ideal();
+    }
+  }
+
+  // Evaluation without DRAM backend; each command completes in the
+  // epoch in which it is executed.
+  void eval_ideal() {
     MQArb* rdis_arb = model_->rdis_arb();
     MQArbTmt t = rdis_arb->tournament();
 
@@ -136,17 +150,32 @@ class MemCntrlAgent::RequestDispatcherProcess : public AgentProcess {
       return;
     }
 
+    const Message* msg = t.winner()->peek();
+    if (msg->cls() == MessageClass::DtRsp) {
+      // Response to data sourced directly to a requester; the transfer
+      // is complete and no further action is required.
+      t.winner()->dequeue();
+      msg->release();
+      t.advance();
+      wait_epoch();
+      return;
+    }
+
+    const MemCmdMsg* cmdmsg = static_cast<const MemCmdMsg*>(msg);
+    // Reads on behalf of some other agent source the data directly to
+    // that agent, in addition to the response.
+    const bool is_dt = (cmdmsg->opcode() == MemCmdOpcode::Read) &&
+                       (cmdmsg->dest() != cmdmsg->origin());
+
     // Check NOC port credits
     NocPort* port = model_->mem_noc__port();
     CreditCounter* cc = port->ingress_cc();
-    if (cc->empty()) {
+    if (cc->i() < (is_dt ? 2 : 1)) {
       // NOC credits exhausterd; block until credits have been added.
       wait_on(cc->credit_event());
       return;
     }
-
-    const MemCmdMsg* cmdmsg =
-        static_cast<const MemCmdMsg*>(t.winner()->dequeue());
+    t.winner()->dequeue();
 
     LogMessage lm("Execute message: ");
     lm.append(cmdmsg->to_string());
@@ -157,6 +186,12 @@ class MemCntrlAgent::RequestDispatcherProcess : public AgentProcess {
     rspmsg->set_t(cmdmsg->t());
     switch (cmdmsg->opcode()) {
       case MemCmdOpcode::Read: {
+        if (is_dt) {
+          DtMsg* dt = Pool<DtMsg>::construct();
+          dt->set_t(cmdmsg->t());
+          dt->set_origin(model_);
+          issue_emit_to_noc(cmdmsg->dest(), dt);
+        }
         rspmsg->set_opcode(MemRspOpcode::ReadOkay);
       } break;
       case MemCmdOpcode::Write: {
@@ -182,7 +217,90 @@ class MemCntrlAgent::RequestDispatcherProcess : public AgentProcess {
     }
   }
 
-  void issue_emit_to_noc(Agent* dest, const Message* msg) {
+  // Evaluation with DRAM backend; one command is admitted to the DRAM
+  // queues and one request is issued to the DRAM per epoch.
+  void eval_dram() {
+    DramModel* dram = model_->dram();
+    MQArb* rdis_arb = model_->rdis_arb();
+    CreditCounter* cc = model_->mem_noc__port()->ingress_cc();
+    const cursor_t now = k()->time().time;
+
+    // Admit command at the head of the ingress queues.
+    if (MQArbTmt t = rdis_arb->tournament(); t.has_requester()) {
+      const Message* msg = t.winner()->peek();
+      if (msg->cls() == MessageClass::DtRsp) {
+        // Response to data sourced directly to a requester; no further
+        // action is required.
+        t.winner()->dequeue();
+        msg->release();
+        t.advance();
+      } else {
+        const MemCmdMsg* cmdmsg = static_cast<const MemCmdMsg*>(msg);
+        const bool is_write = (cmdmsg->opcode() == MemCmdOpcode::Write);
+        if (!is_write && (cmdmsg->opcode() != MemCmdOpcode::Read)) {
+          LogMessage lmsg("Invalid message opcode received: ");
+          lmsg.append(to_string(cmdmsg->opcode()));
+          lmsg.set_level(Level::Fatal);
+          log(lmsg);
+        }
+        // Writes are posted; they are acknowledged upon admission and
+        // therefore require a NOC credit.
+        if (!dram->full(is_write) && (!is_write || !cc->empty())) {
+          t.winner()->dequeue();
+
+          LogMessage lm("Admit message: ");
+          lm.append(cmdmsg->to_string());
+          lm.set_level(Level::Debug);
+          log(lm);
+
+          dram->push(cmdmsg, now);
+          if (is_write) {
+            MemRspMsg* rspmsg = Pool<MemRspMsg>::construct();
+            rspmsg->set_t(cmdmsg->t());
+            rspmsg->set_opcode(MemRspOpcode::WriteOkay);
+            issue_emit_to_noc(cmdmsg->origin(), rspmsg);
+          }
+          t.advance();
+        }
+      }
+    }
+
+    // Issue the next request to DRAM.
+    if (const DramModel::Request* r = dram->select(now); r != nullptr) {
+      const MemCmdMsg* cmdmsg = r->msg;
+      const bool is_write = r->is_write;
+      // Reads on behalf of some other agent source the data directly
+      // to that agent, in addition to the response.
+      const bool is_dt = !is_write && (cmdmsg->dest() != cmdmsg->origin());
+      const std::size_t credits_n = is_write ? 0 : (is_dt ? 2 : 1);
+      if (cc->i() >= credits_n) {
+        // Responses are emitted upon completion of the data transfer.
+        const cursor_t done = dram->issue(now);
+        if (!is_write) {
+          if (is_dt) {
+            DtMsg* dt = Pool<DtMsg>::construct();
+            dt->set_t(cmdmsg->t());
+            dt->set_origin(model_);
+            issue_emit_to_noc(cmdmsg->dest(), dt, done - now);
+          }
+          MemRspMsg* rspmsg = Pool<MemRspMsg>::construct();
+          rspmsg->set_t(cmdmsg->t());
+          rspmsg->set_opcode(MemRspOpcode::ReadOkay);
+          issue_emit_to_noc(cmdmsg->origin(), rspmsg, done - now);
+        }
+        cmdmsg->release();
+      }
+    }
+
+    if (dram->empty() && !rdis_arb->tournament().has_requester()) {
+      wait_on(rdis_arb->request_arrival_event());
+    } else {
+      wait_epoch();
+    }
+  }
+
+  void issue_emit_to_noc(Agent* dest, const Message* msg,
+                         cursor_t cursor = 0) {
     NocMsg* nocmsg = Pool<NocMsg>::construct();
     nocmsg->set_payload(msg);
     nocmsg->set_origin(model_);
@@ -194,7 +312,7 @@ class MemCntrlAgent::RequestDispatcherProcess : public AgentProcess {
     cc->debit();
     // Issue message to NOC.
     MessageQueue* mq = port->ingress();
-    mq->issue(nocmsg);
+    mq->issue(nocmsg, cursor);
   }
 
   //
@@ -213,9 +331,17 @@ class MemNocEndpoint : public NocEndpoint {
     endpoints_.insert(std::make_pair(agent, proxy));
   }
   //
+  void register_endpoint(MessageClass cls, MessageQueue* mq) {
+    cls_endpoints_.insert(std::make_pair(cls, mq));
+  }
+  //
   MessageQueue* lookup_mq(const Message* msg) const override {
-    if (auto it = endpoints_.find(msg->origin()); it != endpoints_.end()) {
+    if (auto it = cls_endpoints_.find(msg->cls());
+        it != cls_endpoints_.end()) {
       return it->second;
+    } else if (auto jt = endpoints_.find(msg->origin());
+               jt != endpoints_.end()) {
+      return jt->second;
     } else {
       LogMessage lm("End point not register for origin: ");
       lm.append(msg->origin()->path());
@@ -228,10 +354,12 @@ class MemNocEndpoint : public NocEndpoint {
  private:
   //
   std::map<Agent*, MessageQueue*> endpoints_;
+  // Endpoints keyed on message class (irrespective of origin).
+  std::map<MessageClass, MessageQueue*> cls_endpoints_;
 };
 
 MemCntrlAgent::MemCntrlAgent(kernel::Kernel* k, const MemModelConfig& config)
-    : Agent(k, "mem"), config_(config) {
+    : Agent(k, config.name), config_(config) {
   build();
 }
 
@@ -243,7 +371,9 @@ MemCntrlAgent::~MemCntrlAgent() {
     MessageQueue* mq = pp.second;
     delete mq;
   }
+  delete dtrsp_q_;
   delete noc_endpoint_;
+  delete dram_;
 }
 
 void MemCntrlAgent::build() {
@@ -258,6 +388,13 @@ void MemCntrlAgent::build() {
   // Construct arbiter
   rdis_arb_ = new MQArb(k(), "arb");
   add_child_module(rdis_arb_);
+  // Dt response queue
+  dtrsp_q_ = new MessageQueue(k(), "dtrsp_q", 16);
+  add_child_module(dtrsp_q_);
+  // DRAM backend
+  if (config_.dram.enable) {
+    dram_ = new DramModel(config_.dram, config_.epoch);
+  }
 }
 
 void MemCntrlAgent::register_agent(Agent* agent) {
@@ -267,6 +404,10 @@ void MemCntrlAgent::register_agent(Agent* agent) {
   rdis_mq_.insert(std::make_pair(agent, mq));
 }
 
+void MemCntrlAgent::register_statistics(Statistics* statistics) {
+  statistics_ = statistics;
+}
+
 bool MemCntrlAgent::elab() {
   for (const std::pair<Agent*, MessageQueue*>& pp : rdis_mq_) {
     MessageQueue* mq = pp.second;
@@ -276,6 +417,13 @@ bool MemCntrlAgent::elab() {
   for (const std::pair<Agent*, MessageQueue*> pp : rdis_mq_) {
     noc_endpoint_->register_agent(pp.first, pp.second);
   }
+  rdis_arb_->add_requester(dtrsp_q_);
+  noc_endpoint_->register_endpoint(MessageClass::DtRsp, dtrsp_q_);
+
+  if (statistics_ != nullptr) {
+    stats_ = statistics_->register_block<MemStatBlock>(path());
+    if (dram_ != nullptr) dram_->set_stats(stats_);
+  }
 
   return false;
 }
@@ -291,6 +439,40 @@ void MemCntrlAgent::drc() {
     msg.set_level(Level::Fatal);
     log(msg);
   }
+  if (dram_ != nullptr) {
+    const DramConfig& d = config_.dram;
+    auto is_pow2 = [](std::uint64_t x) {
+      return (x != 0) && ((x & (x - 1)) == 0);
+    };
+    if (d.channel_n == 0 || d.rank_n == 0 || d.bank_n == 0) {
+      LogMessage msg("DRAM channel, rank and bank counts must be non-zero.");
+      msg.set_level(Level::Fatal);
+      log(msg);
+    }
+    if (!is_pow2(d.row_bytes) || !is_pow2(d.line_bytes) ||
+        (d.row_bytes < d.line_bytes)) {
+      LogMessage msg("DRAM row and line sizes must be powers of two with ");
+      msg.append("the row no smaller than the line.");
+      msg.set_level(Level::Fatal);
+      log(msg);
+    }
+    if (d.rdq_n == 0 || d.wrq_n == 0 || (d.wr_drain_lo >= d.wr_drain_hi) ||
+        (d.wr_drain_hi > d.wrq_n)) {
+      LogMessage msg("DRAM queues must be non-empty with write drain ");
+      msg.append("watermarks satisfying lo < hi <= wrq_n.");
+      msg.set_level(Level::Fatal);
+      log(msg);
+    }
+  }
+}
+
+void MemCntrlAgent::reset() {
+  if (dram_ != nullptr) {
+    // Close all rows and restart the refresh schedule.
+    delete dram_;
+    dram_ = new DramModel(config_.dram, config_.epoch);
+    dram_->set_stats(stats_);
+  }
 }
 
 MessageQueue* MemCntrlAgent::endpoint() const {
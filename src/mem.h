@@ -38,6 +38,9 @@ namespace cc {
 
 class NocPort;
 class MemNocEndpoint;
+class DramModel;
+class Statistics;
+struct MemStatBlock;
 
 // Memory command opcodes:
 enum class MemCmdOpcode {
@@ -70,9 +73,13 @@ class MemCmdMsg : public Message {
   // Command opcode
   MemCmdOpcode opcode() const { return opcode_; }
 
-  // Command destination agent (of Dt, where applicable)
+  // Command destination agent (of Dt, where applicable). Reads on
+  // behalf of an agent other than the originator transfer the line
+  // directly to the destination agent.
   Agent* dest() const { return dest_; }
 
+  // Line address.
+  addr_t addr() const { return addr_; }
 
   // Setters:
 
@@ -82,12 +89,18 @@ class MemCmdMsg : public Message {
   // Set message destination Agent.
   void set_dest(Agent* dest) { dest_ = dest; }
 
+  // Set line address.
+  void set_addr(addr_t addr) { addr_ = addr; }
+
  private:
   // Command opcode
   MemCmdOpcode opcode_ = MemCmdOpcode::Invalid;
 
   // Destination agent.
   Agent* dest_ = nullptr;
+
+  // Line address.
+  addr_t addr_ = 0;
 };
 
 
@@ -185,6 +198,9 @@ class MemCntrlAgent : public Agent {
   // MEM -> NOC
   NocPort* mem_noc__port() const { return mem_noc__port_; }
 
+  // DRAM backend (nullptr if DRAM timing is disabled).
+  DramModel* dram() const { return dram_; }
+
  protected:
   // Build
   void build();
@@ -192,6 +208,8 @@ class MemCntrlAgent : public Agent {
   // constructs the necessary ingress queues beyond the NOC interface
   // front-end.
   void register_agent(Agent* agent);
+  // Register statistics.
+  void register_statistics(Statistics* statistics);
 
   // Elaboration
   bool elab() override;
@@ -201,10 +219,15 @@ class MemCntrlAgent : public Agent {
   // Design Rule Check (DRC)
   void drc() override;
 
+  // Reset
+  void reset() override;
+
   // Accessors(s)
 
   // RDIS aribter
   MQArb* rdis_arb() const { return rdis_arb_; }
+  // Statistics (nullptr if statistics are disabled).
+  MemStatBlock* stats() const { return stats_; }
 
  private:
   // NOC -> MEM message queue (owned by directory)
@@ -219,6 +242,14 @@ class MemCntrlAgent : public Agent {
   MQArb* rdis_arb_ = nullptr;
   // Request Dispatcher memory queues
   std::map<Agent*, MessageQueue*> rdis_mq_;
+  // Responses to data transfers sourced by the controller.
+  MessageQueue* dtrsp_q_ = nullptr;
+  // DRAM backend
+  DramModel* dram_ = nullptr;
+  // Statistics registry
+  Statistics* statistics_ = nullptr;
+  // Memory controller statistics
+  MemStatBlock* stats_ = nullptr;
   // Configuration
   MemModelConfig config_;
 };
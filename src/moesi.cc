@@ -58,6 +58,31 @@ class MOESIProtocolBuilder : public ProtocolBuilder {
   CCProtocol* create_cc(kernel::Kernel* k) override {
     return moesi::build_cc_protocol(k);
   }
+
+  // Create L1 agent specialized on the MOESI L1 protocol.
+  L1CacheAgent* create_l1_agent(kernel::Kernel* k,
+                                const L1CacheAgentConfig& config) override {
+    return moesi::build_l1_agent(k, config);
+  }
+
+  // Create L2 agent specialized on the MOESI L2 protocol.
+  L2CacheAgent* create_l2_agent(kernel::Kernel* k,
+                                const L2CacheAgentConfig& config) override {
+    return moesi::build_l2_agent(k, config);
+  }
+
+  // Create Directory agent specialized on the MOESI Dir protocol.
+  DirAgent* create_dir_agent(kernel::Kernel* k,
+                             const DirAgentConfig& config) override {
+    return moesi::build_dir_agent(k, config);
+  }
+
+  // Create Cache Controller agent specialized on the MOESI CC
+  // protocol.
+  CCAgent* create_cc_agent(kernel::Kernel* k,
+                           const CCAgentConfig& config) override {
+    return moesi::build_cc_agent(k, config);
+  }
 };
 
 CC_DECLARE_PROTOCOL_BUILDER("moesi", MOESIProtocolBuilder);
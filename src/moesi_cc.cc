@@ -27,6 +27,7 @@
 
 #include "amba.h"
 #include "ccntrl.h"
+#include "ccntrl_process.h"
 #include "dir.h"
 #include "l2cache.h"
 #include "mem.h"
@@ -244,7 +245,7 @@ const char* to_string(CCEgressQueue q) {
 
 //
 //
-class MOESICCProtocol : public CCProtocol {
+class MOESICCProtocol final : public CCProtocol {
   using cb = CCCommandBuilder;
 
  public:
@@ -308,6 +309,12 @@ class MOESICCProtocol : public CCProtocol {
     return true;
   }
 
+  //
+  //
+  bool is_accepted(const CCLineState* line) const override {
+    return !static_cast<const Line*>(line)->awaiting_cohcmdrsp();
+  }
+
   //
   //
   void apply(CCSnpContext& ctxt, CCSnpCommandList& cl) const override {
@@ -478,15 +485,19 @@ class MOESICCProtocol : public CCProtocol {
       issue_msg_to_noc(ctxt, cl, rsp, snpline->origin());
     }
 
+    // The snoop is complete once its response has been issued. The
+    // transaction may then complete at the requester, and its
+    // Transaction be reclaimed, before any data response returns;
+    // the state is therefore not retained until the DtRsp.
+    cl.push_back(CCSnpOpcode::TransactionEnd);
     // Consume and advance
     cl.next_and_do_consume(true);
   }
 
   void eval_msg(CCSnpContext& ctxt, CCSnpCommandList& cl,
                 const DtRspMsg* msg) const {
-    using snpcb = CCSnpCommandBuilder;
-    cl.push_back(CCSnpOpcode::TransactionEnd);
-    // Consume and advance
+    // Response to data sourced directly to a requester; the transfer
+    // is complete and no further action is required.
     cl.next_and_do_consume(true);
   }
 
@@ -651,23 +662,15 @@ class MOESICCProtocol : public CCProtocol {
         // If a credit counter exists for at the destination for the current
         // MessageClass, deduct one credit, otherwise ignore.
         const Message* payload = msg_->payload();
-        // Lookup counter map for current message class.
-        const auto& cntrs_map = cc_->ccntrs_map();
-        if (auto ccntr_map_it = cntrs_map.find(payload->cls());
-            ccntr_map_it != cntrs_map.end()) {
-          // Lookup map to determine if a credit counter for the
-          // destination agent is present.
-          const CCAgent::ccntr_map& agent_counter = ccntr_map_it->second;
-          if (auto it = agent_counter.find(msg_->dest());
-              it != agent_counter.end()) {
-            // Credit counter is present, therefore deduct a credit before
-            // message is issued.
-            CreditCounter* cc = it->second;
-            cc->debit();
-          }
-          // Otherwise, no credit counter can be found for the current
-          // { MessageClass, Agent* } pair, therefore disregard.
+        if (CreditCounter* cc = cc_->cc_by_cls_agent(payload->cls(),
+                                                     msg_->dest());
+            cc != nullptr) {
+          // Credit counter is present, therefore deduct a credit before
+          // message is issued.
+          cc->debit();
         }
+        // Otherwise, no credit counter can be found for the current
+        // { MessageClass, Agent* } pair, therefore disregard.
         // Deduct NOC creidt
         CreditCounter* cc = port_->ingress_cc();
         cc->debit();
@@ -715,4 +718,10 @@ CCProtocol* build_cc_protocol(kernel::Kernel* k) {
   return new MOESICCProtocol(k);
 }
 
+//
+//
+CCAgent* build_cc_agent(kernel::Kernel* k, const CCAgentConfig& config) {
+  return new CCAgentT<MOESICCProtocol>(k, config);
+}
+
 }  // namespace cc::moesi
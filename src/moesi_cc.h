@@ -33,6 +33,8 @@ namespace cc {
 // Forwards:
 class CCProtocol;
 
+class CCAgent;
+struct CCAgentConfig;
 namespace kernel {
 class Kernel;
 }
@@ -41,6 +43,8 @@ namespace moesi {
 
 CCProtocol* build_cc_protocol(kernel::Kernel* k);
 
+CCAgent* build_cc_agent(kernel::Kernel* k, const CCAgentConfig& config);
+
 }  // namespace moesi
 
 }  // namespace cc
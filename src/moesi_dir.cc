@@ -25,15 +25,16 @@
 // POSSIBILITY OF SUCH DAMAGE.
 //========================================================================== //
 
-#include <set>
-
 #include "dir.h"
+#include "dir_process.h"
 #include "llc.h"
 #include "mem.h"
 #include "moesi.h"
+#include "moesi_dir.h"
 #include "noc.h"
 #include "protocol.h"
 #include "sim.h"
+#include "transition.h"
 #include "utility.h"
 
 namespace {
@@ -191,6 +192,7 @@ bool is_stable(State state) {
     case State::S:
     case State::E:
     case State::M:
+    case State::O:
       return true;
     default:
       return false;
@@ -201,7 +203,7 @@ bool is_stable(State state) {
 //
 class LineState : public DirLineState {
  public:
-  LineState() = default;
+  explicit LineState(const SharerDomain* d) : d_(d) {}
 
   // Factory functions to construct Command objects to permute the
   // current line instance.
@@ -238,32 +240,23 @@ class LineState : public DirLineState {
 
   // Current line state.
   State state() const { return state_; }
-  // Current sharer set (full, non-sparse set).
-  const std::set<Agent*>& sharers() const { return sharers_; }
+  // Current sharer set, excluding the owner. Where the sharer
+  // encoding is imprecise, agents which do not share the line may
+  // be present.
+  SharerSet::Agents sharers() const { return sharers_.agents(d_, owner_); }
   // Current owning agent.
   Agent* owner() const { return owner_; }
   // Line resides in a stable state.
-  bool is_stable() const { return true; }
-  // Flag denoting if 'agent' is in the sharer set.
+  bool is_stable() const { return ::is_stable(state_); }
+  // Flag denoting if 'agent' is (possibly) in the sharer set.
   bool is_sharer(Agent* agent) const {
-    return sharers_.find(agent) != sharers_.end();
+    return sharers_.contains(d_, d_->index(agent));
   }
 
   // Delete sharer, from sharer set
-  bool del_sharer(Agent* agent) {
-    bool removed = false;
-    if (auto it = sharers_.find(agent); it != sharers_.end()) {
-      sharers_.erase(it);
-      removed = true;
-    }
-    return removed;
-  }
-  // Add agent to the set of sharers, return false if
-  // already in the sharing set.
-  bool add_sharer(Agent* agent) {
-    auto it = sharers_.insert(agent);
-    return it.second;
-  }
+  void del_sharer(Agent* agent) { sharers_.del(d_, d_->index(agent)); }
+  // Add agent to the set of sharers.
+  void add_sharer(Agent* agent) { sharers_.add(d_, d_->index(agent)); }
   // Set state of line.
   void set_state(State state) { state_ = state; }
   // Set owner of line.
@@ -275,7 +268,9 @@ class LineState : public DirLineState {
   // Owning agent.
   Agent* owner_ = nullptr;
   // Current set of sharers
-  std::set<Agent*> sharers_;
+  SharerSet sharers_;
+  // Sharer domain of owning directory.
+  const SharerDomain* d_ = nullptr;
 };
 
 enum class LineUpdateOpcode {
@@ -317,8 +312,15 @@ const char* to_string(LineUpdateOpcode update) {
 //
 //
 struct LineUpdateAction : public DirCoherenceAction {
-  LineUpdateAction(LineState* line, LineUpdateOpcode update)
-      : line_(line), update_(update) {}
+  LineUpdateAction() = default;
+
+  // Construct action from pool.
+  static LineUpdateAction* construct(LineState* line, LineUpdateOpcode update) {
+    LineUpdateAction* action = Pool<LineUpdateAction>::construct();
+    action->line_ = line;
+    action->update_ = update;
+    return action;
+  }
 
   void set_state(State state) { state_ = state; }
   void set_agent(Agent* agent) { agent_ = agent; }
@@ -383,7 +385,7 @@ struct LineUpdateAction : public DirCoherenceAction {
 
 DirCommand* LineState::build_update_state(State state) {
   LineUpdateAction* action =
-      new LineUpdateAction(this, LineUpdateOpcode::SetState);
+      LineUpdateAction::construct(this, LineUpdateOpcode::SetState);
   action->set_state(state);
   return DirCommandBuilder::from_action(action);
 }
@@ -391,7 +393,7 @@ DirCommand* LineState::build_update_state(State state) {
 // Build Set owner command:
 DirCommand* LineState::build_set_owner(Agent* agent) {
   LineUpdateAction* action =
-      new LineUpdateAction(this, LineUpdateOpcode::SetOwner);
+      LineUpdateAction::construct(this, LineUpdateOpcode::SetOwner);
   action->set_agent(agent);
   return DirCommandBuilder::from_action(action);
 }
@@ -399,14 +401,14 @@ DirCommand* LineState::build_set_owner(Agent* agent) {
 // Build Delete owner command:
 DirCommand* LineState::build_del_owner() {
   LineUpdateAction* action =
-      new LineUpdateAction(this, LineUpdateOpcode::DelOwner);
+      LineUpdateAction::construct(this, LineUpdateOpcode::DelOwner);
   return DirCommandBuilder::from_action(action);
 }
 
 // Build add sharer command:
 DirCommand* LineState::build_add_sharer(Agent* agent) {
   LineUpdateAction* action =
-      new LineUpdateAction(this, LineUpdateOpcode::AddSharer);
+      LineUpdateAction::construct(this, LineUpdateOpcode::AddSharer);
   action->set_agent(agent);
   return DirCommandBuilder::from_action(action);
 }
@@ -414,14 +416,1217 @@ DirCommand* LineState::build_add_sharer(Agent* agent) {
 // Build delete sharer command:
 DirCommand* LineState::build_del_sharer(Agent* agent) {
   LineUpdateAction* action =
-      new LineUpdateAction(this, LineUpdateOpcode::DelSharer);
+      LineUpdateAction::construct(this, LineUpdateOpcode::DelSharer);
   action->set_agent(agent);
   return DirCommandBuilder::from_action(action);
 }
 
+// Directory protocol events.
+//
+enum class Event {
+  // Coherence commands (by opcode)
+  CmdReadShared,
+  CmdReadUnique,
+  CmdCleanUnique,
+  CmdCleanShared,
+  CmdCleanInvalid,
+  CmdMakeUnique,
+  CmdMakeInvalid,
+  CmdWriteBack,
+  CmdWriteClean,
+  CmdEvict,
+
+  // LLC command responses (by LLC command opcode)
+  LLCFill,
+  LLCPutLine,
+
+  // Snoop responses (by opcode of the initiating command)
+  SnpRspReadShared,
+  SnpRspReadUnique,
+  SnpRspCleanUnique,
+  SnpRspCleanShared,
+  SnpRspCleanInvalid,
+  SnpRspMakeUnique,
+  SnpRspMakeInvalid,
+  SnpRspRecall,
+
+  // Line nominated for eviction
+  Recall,
+
+  // Invalid; placeholder
+  Invalid
+};
+
+//
+//
+const char* to_string(Event event) {
+  switch (event) {
+    case Event::CmdReadShared:
+      return "CmdReadShared";
+    case Event::CmdReadUnique:
+      return "CmdReadUnique";
+    case Event::CmdCleanUnique:
+      return "CmdCleanUnique";
+    case Event::CmdCleanShared:
+      return "CmdCleanShared";
+    case Event::CmdCleanInvalid:
+      return "CmdCleanInvalid";
+    case Event::CmdMakeUnique:
+      return "CmdMakeUnique";
+    case Event::CmdMakeInvalid:
+      return "CmdMakeInvalid";
+    case Event::CmdWriteBack:
+      return "CmdWriteBack";
+    case Event::CmdWriteClean:
+      return "CmdWriteClean";
+    case Event::CmdEvict:
+      return "CmdEvict";
+    case Event::LLCFill:
+      return "LLCFill";
+    case Event::LLCPutLine:
+      return "LLCPutLine";
+    case Event::SnpRspReadShared:
+      return "SnpRspReadShared";
+    case Event::SnpRspReadUnique:
+      return "SnpRspReadUnique";
+    case Event::SnpRspCleanUnique:
+      return "SnpRspCleanUnique";
+    case Event::SnpRspCleanShared:
+      return "SnpRspCleanShared";
+    case Event::SnpRspCleanInvalid:
+      return "SnpRspCleanInvalid";
+    case Event::SnpRspMakeUnique:
+      return "SnpRspMakeUnique";
+    case Event::SnpRspMakeInvalid:
+      return "SnpRspMakeInvalid";
+    case Event::SnpRspRecall:
+      return "SnpRspRecall";
+    case Event::Recall:
+      return "Recall";
+    case Event::Invalid:
+      [[fallthrough]];
+    default:
+      return "Invalid";
+  }
+}
+
+// Coherence command event, or Invalid where the command is not
+// supported by the directory.
+Event to_cmd_event(AceCmdOpcode opcode) {
+  switch (opcode) {
+    case AceCmdOpcode::ReadShared:
+      return Event::CmdReadShared;
+    case AceCmdOpcode::ReadUnique:
+      return Event::CmdReadUnique;
+    case AceCmdOpcode::CleanUnique:
+      return Event::CmdCleanUnique;
+    case AceCmdOpcode::CleanShared:
+      return Event::CmdCleanShared;
+    case AceCmdOpcode::CleanInvalid:
+      return Event::CmdCleanInvalid;
+    case AceCmdOpcode::MakeUnique:
+      return Event::CmdMakeUnique;
+    case AceCmdOpcode::MakeInvalid:
+      return Event::CmdMakeInvalid;
+    case AceCmdOpcode::WriteBack:
+      return Event::CmdWriteBack;
+    case AceCmdOpcode::WriteClean:
+      return Event::CmdWriteClean;
+    case AceCmdOpcode::Evict:
+      return Event::CmdEvict;
+    default:
+      return Event::Invalid;
+  }
+}
+
+// Snoop response event, or Invalid where the initiating command does
+// not issue snoops.
+Event to_snp_rsp_event(AceCmdOpcode opcode) {
+  switch (opcode) {
+    case AceCmdOpcode::ReadShared:
+      return Event::SnpRspReadShared;
+    case AceCmdOpcode::ReadUnique:
+      return Event::SnpRspReadUnique;
+    case AceCmdOpcode::CleanUnique:
+      return Event::SnpRspCleanUnique;
+    case AceCmdOpcode::CleanShared:
+      return Event::SnpRspCleanShared;
+    case AceCmdOpcode::CleanInvalid:
+      return Event::SnpRspCleanInvalid;
+    case AceCmdOpcode::MakeUnique:
+      return Event::SnpRspMakeUnique;
+    case AceCmdOpcode::MakeInvalid:
+      return Event::SnpRspMakeInvalid;
+    case AceCmdOpcode::Recall:
+      return Event::SnpRspRecall;
+    default:
+      return Event::Invalid;
+  }
+}
+
+void issue_msg_to_noc(DirContext& ctxt, DirCommandList& cl,
+                      const Message* msg, Agent* dest) {
+  struct EmitMessageToNocAction : DirCoherenceAction {
+    EmitMessageToNocAction() = default;
+
+    std::string to_string() const override {
+      KVListRenderer r;
+      r.add_field("action", "emit message to noc");
+      r.add_field("mq", port_->ingress()->path());
+      r.add_field("msg", msg_->to_string());
+      return r.to_string();
+    }
+
+    void set_port(NocPort* port) { port_ = port; }
+    void set_msg(const NocMsg* msg) { msg_ = msg; }
+    void set_dir(const DirAgent* dir) { dir_ = dir; }
+
+    void set_resources(DirResources& r) const override {
+      // Always require a NOC credit.
+      r.set_noc_credit_n(r.noc_credit_n() + 1);
+
+      const Agent* dest = msg_->dest();
+      const Message* payload = msg_->payload();
+      switch (payload->cls()) {
+        case MessageClass::CohSnp: {
+          r.set_coh_snp_n(dest, r.coh_snp_n(dest) + 1);
+        } break;
+        default: {
+          // No resources required;
+          //
+          // DtRsp, CohSnpRsp are assumed to either have resources
+          // reserved upon issue of their originator commands (Dt,
+          // CohSnp), or are otherwise guarenteed to make forward
+          // progress.
+        } break;
+      }
+    }
+
+    bool execute() override {
+      // If a credit counter exists for at the destination for the current
+      // MessageClass, deduct one credit, otherwise ignore.
+      const Message* payload = msg_->payload();
+      // Lookup counter map for current message class.
+      if (CreditCounter* cc =
+              dir_->cc_by_cls_agent(payload->cls(), msg_->dest());
+          cc != nullptr) {
+        // Credit counter is present, therefore deduct a credit before
+        // message is issued.
+        cc->debit();
+      }
+      // Deduct NOC credit
+      CreditCounter* cc = port_->ingress_cc();
+      cc->debit();
+
+      // Issue message to queue.
+      MessageQueue* mq = port_->ingress();
+      return mq->issue(msg_);
+    }
+
+   private:
+    // Message to issue to NOC.
+    const NocMsg* msg_ = nullptr;
+    // Destination Message Queue
+    NocPort* port_ = nullptr;
+    // Cache controller model
+    const DirAgent* dir_ = nullptr;
+  };
+  // Encapsulate message in NOC transport protocol.
+  NocMsg* nocmsg = Pool<NocMsg>::construct();
+  nocmsg->set_t(msg->t());
+  nocmsg->set_payload(msg);
+  nocmsg->set_origin(ctxt.dir());
+  nocmsg->set_dest(dest);
+  // Issue Message Emit action.
+  EmitMessageToNocAction* action = Pool<EmitMessageToNocAction>::construct();
+  action->set_port(ctxt.dir()->dir_noc__port());
+  action->set_msg(nocmsg);
+  action->set_dir(ctxt.dir());
+  cl.push_back(action);
+}
+
+void issue_add_credit(DirContext& ctxt, DirCommandList& cl, MessageClass cls) {
+  struct AddCreditAction : DirCoherenceAction {
+    AddCreditAction() = default;
+    std::string to_string() const override {
+      KVListRenderer r;
+      r.add_field("action", "add credit");
+      r.add_field("cc", cc_->path());
+      return r.to_string();
+    }
+    void set_cc(CreditCounter* cc) { cc_ = cc; }
+    // No resources required (should always make "forward progress")
+    bool execute() override {
+      cc_->credit();
+      return true;
+    }
+
+   private:
+    CreditCounter* cc_ = nullptr;
+  };
+  const Agent* origin = ctxt.msg()->origin();
+  if (CreditCounter* cc = ctxt.dir()->cc_by_cls_agent(cls, origin);
+      cc != nullptr) {
+    // Counter exists for this edge. Issue credit update aciton.
+    AddCreditAction* action = Pool<AddCreditAction>::construct();
+    action->set_cc(cc);
+    cl.push_back(action);
+  }
+}
+
+// Arguments passed to each transition guard and action.
+//
+struct TransitionArgs {
+  // Current directory context
+  DirContext& ctxt;
+
+  // Command list under construction
+  DirCommandList& cl;
+
+  // Line of interest
+  LineState* line;
+
+  // Current transaction state
+  DirTState* tstate() const { return ctxt.tstate(); }
+
+  // Agent which initiated the current transaction.
+  Agent* origin() const { return ctxt.tstate()->origin(); }
+};
+
+// Transition guards:
+
+// Command originator is the only agent (possibly) holding the line;
+// no other agent need be snooped.
+bool is_origin_sole_holder(const TransitionArgs& a) {
+  if (a.line->owner() != nullptr && a.line->owner() != a.origin()) {
+    return false;
+  }
+  for (Agent* sharer : a.line->sharers()) {
+    if (sharer != a.origin()) return false;
+  }
+  return true;
+}
+
+// Transaction was initiated by a ReadUnique command.
+bool is_read_unique(const TransitionArgs& a) {
+  return a.tstate()->opcode() == AceCmdOpcode::ReadUnique;
+}
+
+// Current snoop response is the final response of the transaction;
+// the overall snoop consensus is known.
+bool is_final(const TransitionArgs& a) {
+  return a.tstate()->is_final_snoop(true);
+}
+
+// Final snoop response; line is retained Shared by some agent.
+bool is_final_shared(const TransitionArgs& a) {
+  return is_final(a) && a.ctxt.is();
+}
+
+// Final snoop response; responsibility for the dirty line is passed.
+bool is_final_dirty(const TransitionArgs& a) {
+  return is_final(a) && a.ctxt.pd();
+}
+
+// Final snoop response; line is retained Shared and is passed dirty.
+bool is_final_shared_dirty(const TransitionArgs& a) {
+  return is_final(a) && a.ctxt.is() && a.ctxt.pd();
+}
+
+// Transition actions:
+
+// Issue command to the LLC and await its response.
+template <LLCCmdOpcode Opcode>
+struct IssueLLCCmd {
+  void operator()(TransitionArgs& a) const {
+    LLCCmdMsg* cmd = Pool<LLCCmdMsg>::construct();
+    cmd->set_t(a.ctxt.msg()->t());
+    cmd->set_opcode(Opcode);
+    cmd->set_addr(a.tstate()->addr());
+    // Line is forwarded to the requesting agent.
+    if constexpr (Opcode == LLCCmdOpcode::PutLine) cmd->set_agent(a.origin());
+    issue_msg_to_noc(a.ctxt, a.cl, cmd, a.ctxt.dir()->llc());
+    // Set flag awaiting LLC response.
+    a.cl.push_back(a.tstate()->build_set_llc_cmd_opcode(Opcode));
+  }
+};
+
+// Construct snoop, on behalf of the originator, to be issued to some
+// agent holding the line.
+CohSnpMsg* construct_snoop(TransitionArgs& a) {
+  CohSnpMsg* snp = Pool<CohSnpMsg>::construct();
+  snp->set_t(a.ctxt.msg()->t());
+  snp->set_addr(a.tstate()->addr());
+  snp->set_origin(a.ctxt.dir());
+  snp->set_agent(a.origin());
+  snp->set_opcode(to_snp_opcode(a.tstate()->opcode()));
+  return snp;
+}
+
+// Snoop owning agent; await one snoop response.
+struct SnoopOwner {
+  void operator()(TransitionArgs& a) const {
+    issue_msg_to_noc(a.ctxt, a.cl, construct_snoop(a), a.line->owner());
+    a.cl.push_back(a.tstate()->build_set_snoop_n(1));
+  }
+};
+
+// Snoop the owner (if present) and all sharers (less the originator,
+// where 'ExceptOrigin'); await a response from each.
+template <bool ExceptOrigin>
+struct SnoopHolders {
+  void operator()(TransitionArgs& a) const {
+    std::size_t snoop_n = 0;
+    if (Agent* owner = a.line->owner(); owner != nullptr) {
+      // Do not snoop to self.
+      if (!ExceptOrigin || owner != a.origin()) {
+        issue_msg_to_noc(a.ctxt, a.cl, construct_snoop(a), owner);
+        ++snoop_n;
+      }
+    }
+    for (Agent* sharer : a.line->sharers()) {
+      // Do not snoop to self.
+      if (ExceptOrigin && sharer == a.origin()) continue;
+
+      issue_msg_to_noc(a.ctxt, a.cl, construct_snoop(a), sharer);
+      ++snoop_n;
+    }
+    // Set expected snoop response count in transaction state object.
+    a.cl.push_back(a.tstate()->build_set_snoop_n(snoop_n));
+  }
+};
+
+// Issue recall (CleanInvalid) to all agents holding the line. All
+// snoop messages emitted by the recall operation, inherit from the
+// transaction of the initiating message. This is probably okay as
+// this can logically be considered to be part of the overall
+// load/store transaction (although this was not the initial
+// intention).
+struct SnoopRecall {
+  void operator()(TransitionArgs& a) const {
+    std::size_t snoop_n = 0;
+    auto issue_recall = [&](Agent* agent) {
+      CohSnpMsg* snp = Pool<CohSnpMsg>::construct();
+      snp->set_t(a.ctxt.msg()->t());
+      snp->set_addr(a.tstate()->addr());
+      snp->set_origin(a.ctxt.dir());
+      snp->set_agent(nullptr);
+      snp->set_opcode(AceSnpOpcode::CleanInvalid);
+      issue_msg_to_noc(a.ctxt, a.cl, snp, agent);
+      ++snoop_n;
+    };
+    if (Agent* owner = a.line->owner(); owner != nullptr) issue_recall(owner);
+    for (Agent* sharer : a.line->sharers()) issue_recall(sharer);
+    // Set snoop response expected count.
+    a.cl.push_back(a.tstate()->build_set_snoop_n(snoop_n));
+  }
+};
+
+// Issue coherence result to the originator where no data is
+// transferred by the directory; 'IS' denotes that the line is
+// retained Shared by some other agent. Snooped agents may
+// nonetheless have forwarded data to the originator, which must
+// await each such transfer.
+template <bool IS>
+struct IssueCohEnd {
+  void operator()(TransitionArgs& a) const {
+    CohEndMsg* end = Pool<CohEndMsg>::construct();
+    end->set_t(a.ctxt.msg()->t());
+    end->set_origin(a.ctxt.dir());
+    end->set_is(IS);
+    end->set_pd(false);
+    end->set_dt_n(a.ctxt.dt_n());
+    issue_msg_to_noc(a.ctxt, a.cl, end, a.origin());
+  }
+};
+
+// Issue coherence result to the originator upon completion of an LLC
+// PutLine. Line cannot be dirty (by definition) if sourced from LLC
+// and only one DT is issued since LLC would not have been queried if
+// an intervention had taken place.
+template <bool IS>
+struct IssueLLCCohEnd {
+  void operator()(TransitionArgs& a) const {
+    CohEndMsg* end = Pool<CohEndMsg>::construct();
+    end->set_t(a.ctxt.msg()->t());
+    end->set_origin(a.ctxt.dir());
+    end->set_is(IS);
+    end->set_pd(false);
+    end->set_dt_n(1);
+    issue_msg_to_noc(a.ctxt, a.cl, end, a.origin());
+  }
+};
+
+// Complete read upon snoop consensus. Where data has been
+// transferred, the originator is now in receipt of some number of
+// lines therefore issue the final response; the originator becomes
+// owner, or a sharer where 'AsSharer'. Otherwise, no data has been
+// transferred and the LLC is instructed to forward the line. In the
+// 'Unique' case the line cannot be retained Shared or Dirty
+// elsewhere.
+template <bool AsSharer, bool Unique>
+struct CompleteRead {
+  void operator()(TransitionArgs& a) const {
+    if (!a.ctxt.dt()) {
+      IssueLLCCmd<LLCCmdOpcode::PutLine>{}(a);
+      return;
+    }
+    CohEndMsg* end = Pool<CohEndMsg>::construct();
+    end->set_t(a.ctxt.msg()->t());
+    end->set_origin(a.ctxt.dir());
+    end->set_is(!Unique && a.ctxt.is());
+    end->set_pd(!Unique && a.ctxt.pd());
+    end->set_dt_n(a.ctxt.dt_n());
+    if constexpr (AsSharer) {
+      a.cl.push_back(a.line->build_add_sharer(a.origin()));
+    } else {
+      a.cl.push_back(a.line->build_set_owner(a.origin()));
+    }
+    issue_msg_to_noc(a.ctxt, a.cl, end, a.origin());
+    a.cl.push_back(DirOpcode::EndTransaction);
+  }
+};
+
+// Account for snoop response.
+struct IncSnoop {
+  void operator()(TransitionArgs& a) const {
+    a.cl.push_back(a.tstate()->build_inc_snoop_i());
+  }
+};
+
+// Responding agent no longer holds the line.
+struct DelResponder {
+  void operator()(TransitionArgs& a) const {
+    a.cl.push_back(a.line->build_del_sharer(a.ctxt.msg()->origin()));
+  }
+};
+
+// Responding agent no longer holds the line unless it is retained
+// Shared.
+struct DelResponderUnlessShared {
+  void operator()(TransitionArgs& a) const {
+    const CohSnpRspMsg* msg = static_cast<const CohSnpRspMsg*>(a.ctxt.msg());
+    if (!msg->is()) {
+      a.cl.push_back(a.line->build_del_sharer(msg->origin()));
+    }
+  }
+};
+
+// Responding agent, either the owner or a sharer, has relinquished
+// the line.
+struct DelRecallResponder {
+  void operator()(TransitionArgs& a) const {
+    if (Agent* origin = a.ctxt.msg()->origin(); origin == a.line->owner()) {
+      a.cl.push_back(a.line->build_del_owner());
+    } else {
+      a.cl.push_back(a.line->build_del_sharer(origin));
+    }
+  }
+};
+
+// Originator becomes owner.
+struct SetOwner {
+  void operator()(TransitionArgs& a) const {
+    a.cl.push_back(a.line->build_set_owner(a.origin()));
+  }
+};
+
+// Originator becomes a sharer.
+struct AddSharer {
+  void operator()(TransitionArgs& a) const {
+    a.cl.push_back(a.line->build_add_sharer(a.origin()));
+  }
+};
+
+// Install new entry in the transaction table.
+struct StartTransaction {
+  void operator()(TransitionArgs& a) const {
+    a.cl.push_back(DirOpcode::StartTransaction);
+  }
+};
+
+// Transaction complete.
+struct EndTransaction {
+  void operator()(TransitionArgs& a) const {
+    a.cl.push_back(DirOpcode::EndTransaction);
+  }
+};
+
+// Remove line from the directory.
+struct RemoveLine {
+  void operator()(TransitionArgs& a) const {
+    a.cl.push_back(DirOpcode::RemoveLine);
+  }
+};
+
+// Block current message until the current transaction has completed.
+struct BlockOnTransaction {
+  void operator()(TransitionArgs& a) const {
+    a.cl.push_back(DirCommandBuilder::build_blocked_on_event(
+        a.ctxt.mq(), a.tstate()->transaction_end(),
+        BlockReason::TransactionInFlight));
+  }
+};
+
+// Advance, but do not consume message.
+struct Advance {
+  void operator()(TransitionArgs& a) const { a.cl.next_and_do_consume(false); }
+};
+
+// Consume message and advance to next.
+struct Consume {
+  void operator()(TransitionArgs& a) const { a.cl.next_and_do_consume(true); }
+};
+
+using DirTransition = Transition<State, Event, TransitionArgs, 5>;
+
+template <typename ActionT>
+constexpr DirTransition::action_type act =
+    &invoke_action<ActionT, TransitionArgs>;
+
+// MOESI directory transition table:
+//
+//  {state, event, guard, guard name, {actions...}, next state}
+//
+// The state update to 'next' is emitted ahead of the transition
+// actions whenever the state changes.
+//
+constexpr std::array<DirTransition, 141> dir_transitions{{
+    //
+    // C4.5.5 ReadShared
+    //
+
+    // Line is not present in the directory; fill line into LLC.
+    {State::I, Event::CmdReadShared, nullptr, nullptr,
+     {act<IssueLLCCmd<LLCCmdOpcode::Fill>>, act<Consume>},
+     State::I_E},
+    // Add requester to sharer list; forward data to requester from
+    // the LLC (as agents may have silently evicted the line).
+    {State::S, Event::CmdReadShared, nullptr, nullptr,
+     {act<IssueLLCCmd<LLCCmdOpcode::PutLine>>, act<Consume>},
+     State::S},
+    // Line resides in a unique state in a single agent. The agent may
+    // relinquish the line or retain it in a shared state. Directory
+    // has no notion of local modified status, therefore when a line
+    // has been installed in the Exclusive state, the directory
+    // asssumes that the line has been modified by the owning agent.
+    {State::M, Event::CmdReadShared, nullptr, nullptr,
+     {act<SnoopOwner>, act<Consume>},
+     State::M_O},
+    {State::O, Event::CmdReadShared, nullptr, nullptr,
+     {act<SnoopOwner>, act<Consume>},
+     State::O_O},
+    {State::E, Event::CmdReadShared, nullptr, nullptr,
+     {act<SnoopOwner>, act<Consume>},
+     State::E_O},
+
+    //
+    // C4.5.6 ReadUnique
+    //
+
+    // Line is not present in the directory; originator becomes owner.
+    {State::I, Event::CmdReadUnique, nullptr, nullptr,
+     {act<IssueLLCCmd<LLCCmdOpcode::Fill>>, act<SetOwner>, act<Consume>},
+     State::I_E},
+    // Owning agent may have line in either the E or the M state.
+    {State::M, Event::CmdReadUnique, nullptr, nullptr,
+     {act<SnoopOwner>, act<Consume>},
+     State::M_ME},
+    {State::E, Event::CmdReadUnique, nullptr, nullptr,
+     {act<SnoopOwner>, act<Consume>},
+     State::E_E},
+    // Originator is the sole holder of the Shared line; no agent need
+    // be snooped and the line is forwarded from the LLC.
+    {State::S, Event::CmdReadUnique, &is_origin_sole_holder,
+     "is_origin_sole_holder",
+     {act<IssueLLCCmd<LLCCmdOpcode::PutLine>>, act<SetOwner>, act<Consume>},
+     State::E},
+    // Owner (if any) forwards the line to the requester; all other
+    // copies are invalidated. Modified state is entered if ownership
+    // of the dirty line is passed to the requester, otherwise
+    // Exclusive.
+    {State::S, Event::CmdReadUnique, nullptr, nullptr,
+     {act<SnoopHolders<true>>, act<Consume>},
+     State::S_ME},
+    {State::O, Event::CmdReadUnique, nullptr, nullptr,
+     {act<SnoopHolders<true>>, act<Consume>},
+     State::O_ME},
+
+    //
+    // C4.6.1 CleanUnique
+    //
+    // Requesting cache has line installed, but not in a state where a
+    // write can be performed. All other copies of the line are
+    // invalidated such that the originator may promote its line to a
+    // Unique state.
+    //
+
+    // The originator's copy has been invalidated since the command was
+    // issued (the line has been evicted from the directory); the line
+    // is sourced from the LLC as for ReadUnique.
+    {State::I, Event::CmdCleanUnique, nullptr, nullptr,
+     {act<IssueLLCCmd<LLCCmdOpcode::Fill>>, act<Consume>},
+     State::I_E},
+    // Command originator is the sole holder of the line; no other
+    // copies require invalidation and the originator becomes owner.
+    {State::S, Event::CmdCleanUnique, &is_origin_sole_holder,
+     "is_origin_sole_holder",
+     {act<IssueCohEnd<false>>, act<SetOwner>, act<EndTransaction>,
+      act<Consume>},
+     State::E},
+    {State::E, Event::CmdCleanUnique, &is_origin_sole_holder,
+     "is_origin_sole_holder",
+     {act<IssueCohEnd<false>>, act<SetOwner>, act<EndTransaction>,
+      act<Consume>},
+     State::E},
+    {State::M, Event::CmdCleanUnique, &is_origin_sole_holder,
+     "is_origin_sole_holder",
+     {act<IssueCohEnd<false>>, act<SetOwner>, act<EndTransaction>,
+      act<Consume>},
+     State::M},
+    {State::O, Event::CmdCleanUnique, &is_origin_sole_holder,
+     "is_origin_sole_holder",
+     {act<IssueCohEnd<false>>, act<SetOwner>, act<EndTransaction>,
+      act<Consume>},
+     State::M},
+    // Owning agent may opt. to transfer ownership of the dirty line to
+    // the requesting agent.
+    {State::S, Event::CmdCleanUnique, nullptr, nullptr,
+     {act<SnoopHolders<true>>, act<Consume>},
+     State::S_E},
+    {State::E, Event::CmdCleanUnique, nullptr, nullptr,
+     {act<SnoopHolders<true>>, act<Consume>},
+     State::E_E},
+    {State::M, Event::CmdCleanUnique, nullptr, nullptr,
+     {act<SnoopHolders<true>>, act<Consume>},
+     State::M_EO},
+    {State::O, Event::CmdCleanUnique, nullptr, nullptr,
+     {act<SnoopHolders<true>>, act<Consume>},
+     State::M_EO},
+
+    //
+    // C4.6.2 CleanShared
+    //
+    // All agents holding the line clean the line; agents may retain
+    // the line in a clean state or may invalidate it.
+    //
+    {State::I, Event::CmdCleanShared, nullptr, nullptr,
+     {act<IssueCohEnd<false>>, act<EndTransaction>, act<Consume>},
+     State::I},
+    // Command originator is the sole holder of the line; there is no
+    // other copy to clean.
+    {State::S, Event::CmdCleanShared, &is_origin_sole_holder,
+     "is_origin_sole_holder",
+     {act<IssueCohEnd<false>>, act<EndTransaction>, act<Consume>},
+     State::S},
+    {State::E, Event::CmdCleanShared, &is_origin_sole_holder,
+     "is_origin_sole_holder",
+     {act<IssueCohEnd<false>>, act<EndTransaction>, act<Consume>},
+     State::E},
+    {State::M, Event::CmdCleanShared, &is_origin_sole_holder,
+     "is_origin_sole_holder",
+     {act<IssueCohEnd<false>>, act<EndTransaction>, act<Consume>},
+     State::M},
+    {State::O, Event::CmdCleanShared, &is_origin_sole_holder,
+     "is_origin_sole_holder",
+     {act<IssueCohEnd<false>>, act<EndTransaction>, act<Consume>},
+     State::O},
+    {State::S, Event::CmdCleanShared, nullptr, nullptr,
+     {act<SnoopHolders<true>>, act<Consume>},
+     State::S_SE},
+    {State::E, Event::CmdCleanShared, nullptr, nullptr,
+     {act<SnoopHolders<true>>, act<Consume>},
+     State::E_SE},
+    {State::M, Event::CmdCleanShared, nullptr, nullptr,
+     {act<SnoopHolders<true>>, act<Consume>},
+     State::M_SE},
+    {State::O, Event::CmdCleanShared, nullptr, nullptr,
+     {act<SnoopHolders<true>>, act<Consume>},
+     State::O_SE},
+
+    //
+    // C4.6.3 CleanInvalid, C4.7.1 MakeUnique, C4.7.2 MakeInvalid
+    //
+    // Invalidate all agents currently holding the line; where no agent
+    // holds the line, the command completes immediately. From the
+    // perspective of the directory, MakeUnique behaves as the
+    // MakeInvalid command.
+    //
+    {State::I, Event::CmdCleanInvalid, nullptr, nullptr,
+     {act<IssueCohEnd<false>>, act<EndTransaction>, act<Consume>},
+     State::I},
+    {State::S, Event::CmdCleanInvalid, nullptr, nullptr,
+     {act<SnoopHolders<false>>, act<Consume>},
+     State::S_I},
+    {State::E, Event::CmdCleanInvalid, nullptr, nullptr,
+     {act<SnoopHolders<false>>, act<Consume>},
+     State::E_I},
+    {State::M, Event::CmdCleanInvalid, nullptr, nullptr,
+     {act<SnoopHolders<false>>, act<Consume>},
+     State::M_I},
+    {State::O, Event::CmdCleanInvalid, nullptr, nullptr,
+     {act<SnoopHolders<false>>, act<Consume>},
+     State::O_I},
+    {State::I, Event::CmdMakeUnique, nullptr, nullptr,
+     {act<IssueCohEnd<false>>, act<EndTransaction>, act<Consume>},
+     State::I},
+    {State::S, Event::CmdMakeUnique, nullptr, nullptr,
+     {act<SnoopHolders<false>>, act<Consume>},
+     State::S_I},
+    {State::E, Event::CmdMakeUnique, nullptr, nullptr,
+     {act<SnoopHolders<false>>, act<Consume>},
+     State::E_I},
+    {State::M, Event::CmdMakeUnique, nullptr, nullptr,
+     {act<SnoopHolders<false>>, act<Consume>},
+     State::M_I},
+    {State::O, Event::CmdMakeUnique, nullptr, nullptr,
+     {act<SnoopHolders<false>>, act<Consume>},
+     State::O_I},
+    {State::I, Event::CmdMakeInvalid, nullptr, nullptr,
+     {act<IssueCohEnd<false>>, act<EndTransaction>, act<Consume>},
+     State::I},
+    {State::S, Event::CmdMakeInvalid, nullptr, nullptr,
+     {act<SnoopHolders<false>>, act<Consume>},
+     State::S_I},
+    {State::E, Event::CmdMakeInvalid, nullptr, nullptr,
+     {act<SnoopHolders<false>>, act<Consume>},
+     State::E_I},
+    {State::M, Event::CmdMakeInvalid, nullptr, nullptr,
+     {act<SnoopHolders<false>>, act<Consume>},
+     State::M_I},
+    {State::O, Event::CmdMakeInvalid, nullptr, nullptr,
+     {act<SnoopHolders<false>>, act<Consume>},
+     State::O_I},
+
+    //
+    // C4.8.4 WriteBack, C4.8.5 WriteClean
+    //
+    // Requesting agent has already written the line to the LLC before
+    // issuing the command to the directory. Upon WriteBack, the line
+    // is no longer resident in the originator. Upon WriteClean, the
+    // line is retained in a clean state (WriteClean does not
+    // invalidate lines present in other caches, therefore Owned lines
+    // return to the Shared state).
+    //
+    {State::M, Event::CmdWriteBack, nullptr, nullptr,
+     {act<IssueCohEnd<false>>, act<RemoveLine>, act<EndTransaction>,
+      act<Consume>},
+     State::I},
+    {State::O, Event::CmdWriteBack, nullptr, nullptr,
+     {act<IssueCohEnd<false>>, act<RemoveLine>, act<EndTransaction>,
+      act<Consume>},
+     State::I},
+    {State::E, Event::CmdWriteBack, nullptr, nullptr,
+     {act<IssueCohEnd<false>>, act<RemoveLine>, act<EndTransaction>,
+      act<Consume>},
+     State::I},
+    {State::E, Event::CmdWriteClean, nullptr, nullptr,
+     {act<IssueCohEnd<false>>, act<EndTransaction>, act<Consume>},
+     State::E},
+    {State::M, Event::CmdWriteClean, nullptr, nullptr,
+     {act<IssueCohEnd<false>>, act<EndTransaction>, act<Consume>},
+     State::E},
+    {State::O, Event::CmdWriteClean, nullptr, nullptr,
+     {act<IssueCohEnd<false>>, act<EndTransaction>, act<Consume>},
+     State::S},
+
+    //
+    // C4.9.1 Evict
+    //
+    // Line is clean; remove the line from the directory. An Evict to
+    // an Invalid line is considered to be spurious.
+    //
+    {State::I, Event::CmdEvict, nullptr, nullptr,
+     {act<IssueCohEnd<false>>, act<RemoveLine>, act<EndTransaction>,
+      act<Consume>},
+     State::I},
+    {State::S, Event::CmdEvict, nullptr, nullptr,
+     {act<IssueCohEnd<false>>, act<RemoveLine>, act<EndTransaction>,
+      act<Consume>},
+     State::I},
+    {State::E, Event::CmdEvict, nullptr, nullptr,
+     {act<IssueCohEnd<false>>, act<RemoveLine>, act<EndTransaction>,
+      act<Consume>},
+     State::I},
+
+    //
+    // LLC command responses:
+    //
+
+    // Initial line installation in LLC; followed by PutLine to
+    // requesting agent.
+    {State::I_E, Event::LLCFill, nullptr, nullptr,
+     {act<IssueLLCCmd<LLCCmdOpcode::PutLine>>},
+     State::I_E},
+    // On Put completion, transaction is now complete. ReadUnique line
+    // cannot be Shared.
+    {State::I_E, Event::LLCPutLine, &is_read_unique, "is_read_unique",
+     {act<IssueLLCCohEnd<false>>, act<EndTransaction>},
+     State::E},
+    {State::E, Event::LLCPutLine, &is_read_unique, "is_read_unique",
+     {act<SetOwner>, act<IssueLLCCohEnd<false>>, act<EndTransaction>},
+     State::E},
+    {State::M, Event::LLCPutLine, &is_read_unique, "is_read_unique",
+     {act<SetOwner>, act<IssueLLCCohEnd<false>>, act<EndTransaction>},
+     State::E},
+    // Snooped owner no longer held the line (no data was transferred);
+    // the requester receives the line from the LLC in the Exclusive
+    // state.
+    {State::E, Event::LLCPutLine, nullptr, nullptr,
+     {act<SetOwner>, act<IssueLLCCohEnd<false>>, act<EndTransaction>},
+     State::E},
+    // LLC has been queried because the line is not present in any
+    // agent; the requester receives the line in the Exclusive state.
+    {State::I_E, Event::LLCPutLine, nullptr, nullptr,
+     {act<SetOwner>, act<IssueLLCCohEnd<false>>, act<EndTransaction>},
+     State::E},
+    // LLC has been queried because the line is presently in the
+    // Shared state. Nominally, an agent could forward the clean line
+    // through intervention, but we cannot assume the agent has the
+    // line as it may have been silently evicted.
+    {State::S, Event::LLCPutLine, nullptr, nullptr,
+     {act<AddSharer>, act<IssueLLCCohEnd<true>>, act<EndTransaction>},
+     State::S},
+
+    //
+    // Snoop responses:
+    //
+    // Each response is accounted for; once the final response has been
+    // received, the overall consensus is known and the transaction
+    // completes.
+    //
+
+    // ReadShared
+    {State::M_O, Event::SnpRspReadShared, &is_final_shared_dirty,
+     "is_final_shared_dirty",
+     {act<DelResponderUnlessShared>, act<IncSnoop>,
+      act<CompleteRead<false, false>>},
+     State::O},
+    {State::M_O, Event::SnpRspReadShared, &is_final_shared, "is_final_shared",
+     {act<DelResponderUnlessShared>, act<IncSnoop>,
+      act<CompleteRead<true, false>>},
+     State::S},
+    {State::M_O, Event::SnpRspReadShared, &is_final_dirty, "is_final_dirty",
+     {act<DelResponderUnlessShared>, act<IncSnoop>,
+      act<CompleteRead<false, false>>},
+     State::M},
+    {State::M_O, Event::SnpRspReadShared, &is_final, "is_final",
+     {act<DelResponderUnlessShared>, act<IncSnoop>,
+      act<CompleteRead<false, false>>},
+     State::E},
+    {State::M_O, Event::SnpRspReadShared, nullptr, nullptr,
+     {act<DelResponderUnlessShared>, act<IncSnoop>},
+     State::M_O},
+    {State::O_O, Event::SnpRspReadShared, &is_final_shared_dirty,
+     "is_final_shared_dirty",
+     {act<DelResponderUnlessShared>, act<IncSnoop>,
+      act<CompleteRead<false, false>>},
+     State::O},
+    {State::O_O, Event::SnpRspReadShared, &is_final_shared, "is_final_shared",
+     {act<DelResponderUnlessShared>, act<IncSnoop>,
+      act<CompleteRead<true, false>>},
+     State::S},
+    {State::O_O, Event::SnpRspReadShared, &is_final_dirty, "is_final_dirty",
+     {act<DelResponderUnlessShared>, act<IncSnoop>,
+      act<CompleteRead<false, false>>},
+     State::M},
+    {State::O_O, Event::SnpRspReadShared, &is_final, "is_final",
+     {act<DelResponderUnlessShared>, act<IncSnoop>,
+      act<CompleteRead<false, false>>},
+     State::E},
+    {State::O_O, Event::SnpRspReadShared, nullptr, nullptr,
+     {act<DelResponderUnlessShared>, act<IncSnoop>},
+     State::O_O},
+    {State::E_O, Event::SnpRspReadShared, &is_final_shared_dirty,
+     "is_final_shared_dirty",
+     {act<DelResponderUnlessShared>, act<IncSnoop>,
+      act<CompleteRead<false, false>>},
+     State::O},
+    {State::E_O, Event::SnpRspReadShared, &is_final_shared, "is_final_shared",
+     {act<DelResponderUnlessShared>, act<IncSnoop>,
+      act<CompleteRead<true, false>>},
+     State::S},
+    {State::E_O, Event::SnpRspReadShared, &is_final_dirty, "is_final_dirty",
+     {act<DelResponderUnlessShared>, act<IncSnoop>,
+      act<CompleteRead<false, false>>},
+     State::M},
+    {State::E_O, Event::SnpRspReadShared, &is_final, "is_final",
+     {act<DelResponderUnlessShared>, act<IncSnoop>,
+      act<CompleteRead<false, false>>},
+     State::E},
+    {State::E_O, Event::SnpRspReadShared, nullptr, nullptr,
+     {act<DelResponderUnlessShared>, act<IncSnoop>},
+     State::E_O},
+
+    // ReadUnique; responding agents relinquish the line.
+    {State::S_ME, Event::SnpRspReadUnique, &is_final_dirty, "is_final_dirty",
+     {act<DelResponder>, act<IncSnoop>, act<CompleteRead<false, true>>},
+     State::M},
+    {State::S_ME, Event::SnpRspReadUnique, &is_final, "is_final",
+     {act<DelResponder>, act<IncSnoop>, act<CompleteRead<false, true>>},
+     State::E},
+    {State::S_ME, Event::SnpRspReadUnique, nullptr, nullptr,
+     {act<DelResponder>, act<IncSnoop>},
+     State::S_ME},
+    {State::O_ME, Event::SnpRspReadUnique, &is_final_dirty, "is_final_dirty",
+     {act<DelResponder>, act<IncSnoop>, act<CompleteRead<false, true>>},
+     State::M},
+    {State::O_ME, Event::SnpRspReadUnique, &is_final, "is_final",
+     {act<DelResponder>, act<IncSnoop>, act<CompleteRead<false, true>>},
+     State::E},
+    {State::O_ME, Event::SnpRspReadUnique, nullptr, nullptr,
+     {act<DelResponder>, act<IncSnoop>},
+     State::O_ME},
+    {State::M_ME, Event::SnpRspReadUnique, &is_final_dirty, "is_final_dirty",
+     {act<DelResponder>, act<IncSnoop>, act<CompleteRead<false, true>>},
+     State::M},
+    {State::M_ME, Event::SnpRspReadUnique, &is_final, "is_final",
+     {act<DelResponder>, act<IncSnoop>, act<CompleteRead<false, true>>},
+     State::E},
+    {State::M_ME, Event::SnpRspReadUnique, nullptr, nullptr,
+     {act<DelResponder>, act<IncSnoop>},
+     State::M_ME},
+    {State::E_E, Event::SnpRspReadUnique, &is_final_dirty, "is_final_dirty",
+     {act<DelResponder>, act<IncSnoop>, act<CompleteRead<false, true>>},
+     State::M},
+    {State::E_E, Event::SnpRspReadUnique, &is_final, "is_final",
+     {act<DelResponder>, act<IncSnoop>, act<CompleteRead<false, true>>},
+     State::E},
+    {State::E_E, Event::SnpRspReadUnique, nullptr, nullptr,
+     {act<DelResponder>, act<IncSnoop>},
+     State::E_E},
+
+    // CleanUnique; "Clean" command therefore as no data is transferred
+    // the IsShared/PassDirty fields are cleared as per. C4.6.1.
+    {State::S_E, Event::SnpRspCleanUnique, &is_final, "is_final",
+     {act<DelResponder>, act<IncSnoop>, act<IssueCohEnd<false>>,
+      act<SetOwner>, act<EndTransaction>},
+     State::E},
+    {State::S_E, Event::SnpRspCleanUnique, nullptr, nullptr,
+     {act<DelResponder>, act<IncSnoop>},
+     State::S_E},
+    {State::E_E, Event::SnpRspCleanUnique, &is_final, "is_final",
+     {act<DelResponder>, act<IncSnoop>, act<IssueCohEnd<false>>,
+      act<SetOwner>, act<EndTransaction>},
+     State::E},
+    {State::E_E, Event::SnpRspCleanUnique, nullptr, nullptr,
+     {act<DelResponder>, act<IncSnoop>},
+     State::E_E},
+    {State::M_EO, Event::SnpRspCleanUnique, &is_final, "is_final",
+     {act<DelResponder>, act<IncSnoop>, act<IssueCohEnd<false>>,
+      act<SetOwner>, act<EndTransaction>},
+     State::M},
+    {State::M_EO, Event::SnpRspCleanUnique, nullptr, nullptr,
+     {act<DelResponder>, act<IncSnoop>},
+     State::M_EO},
+
+    // CleanShared; on completion, line is clean.
+    {State::S_SE, Event::SnpRspCleanShared, &is_final_shared,
+     "is_final_shared",
+     {act<DelResponderUnlessShared>, act<IncSnoop>, act<IssueCohEnd<true>>,
+      act<EndTransaction>},
+     State::S},
+    {State::S_SE, Event::SnpRspCleanShared, &is_final, "is_final",
+     {act<DelResponderUnlessShared>, act<IncSnoop>, act<IssueCohEnd<false>>,
+      act<EndTransaction>},
+     State::E},
+    {State::S_SE, Event::SnpRspCleanShared, nullptr, nullptr,
+     {act<DelResponderUnlessShared>, act<IncSnoop>},
+     State::S_SE},
+    {State::E_SE, Event::SnpRspCleanShared, &is_final_shared,
+     "is_final_shared",
+     {act<DelResponderUnlessShared>, act<IncSnoop>, act<IssueCohEnd<true>>,
+      act<EndTransaction>},
+     State::S},
+    {State::E_SE, Event::SnpRspCleanShared, &is_final, "is_final",
+     {act<DelResponderUnlessShared>, act<IncSnoop>, act<IssueCohEnd<false>>,
+      act<EndTransaction>},
+     State::E},
+    {State::E_SE, Event::SnpRspCleanShared, nullptr, nullptr,
+     {act<DelResponderUnlessShared>, act<IncSnoop>},
+     State::E_SE},
+    {State::M_SE, Event::SnpRspCleanShared, &is_final_shared,
+     "is_final_shared",
+     {act<DelResponderUnlessShared>, act<IncSnoop>, act<IssueCohEnd<true>>,
+      act<EndTransaction>},
+     State::S},
+    {State::M_SE, Event::SnpRspCleanShared, &is_final, "is_final",
+     {act<DelResponderUnlessShared>, act<IncSnoop>, act<IssueCohEnd<false>>,
+      act<EndTransaction>},
+     State::E},
+    {State::M_SE, Event::SnpRspCleanShared, nullptr, nullptr,
+     {act<DelResponderUnlessShared>, act<IncSnoop>},
+     State::M_SE},
+    {State::O_SE, Event::SnpRspCleanShared, &is_final_shared,
+     "is_final_shared",
+     {act<DelResponderUnlessShared>, act<IncSnoop>, act<IssueCohEnd<true>>,
+      act<EndTransaction>},
+     State::S},
+    {State::O_SE, Event::SnpRspCleanShared, &is_final, "is_final",
+     {act<DelResponderUnlessShared>, act<IncSnoop>, act<IssueCohEnd<false>>,
+      act<EndTransaction>},
+     State::E},
+    {State::O_SE, Event::SnpRspCleanShared, nullptr, nullptr,
+     {act<DelResponderUnlessShared>, act<IncSnoop>},
+     State::O_SE},
+
+    // CleanInvalid, MakeInvalid; line is always invalid in the
+    // responding agent and is ultimately removed from the directory.
+    {State::S_I, Event::SnpRspCleanInvalid, &is_final, "is_final",
+     {act<DelResponder>, act<IncSnoop>, act<IssueCohEnd<false>>,
+      act<RemoveLine>, act<EndTransaction>},
+     State::I},
+    {State::S_I, Event::SnpRspCleanInvalid, nullptr, nullptr,
+     {act<DelResponder>, act<IncSnoop>},
+     State::S_I},
+    {State::E_I, Event::SnpRspCleanInvalid, &is_final, "is_final",
+     {act<DelResponder>, act<IncSnoop>, act<IssueCohEnd<false>>,
+      act<RemoveLine>, act<EndTransaction>},
+     State::I},
+    {State::E_I, Event::SnpRspCleanInvalid, nullptr, nullptr,
+     {act<DelResponder>, act<IncSnoop>},
+     State::E_I},
+    {State::M_I, Event::SnpRspCleanInvalid, &is_final, "is_final",
+     {act<DelResponder>, act<IncSnoop>, act<IssueCohEnd<false>>,
+      act<RemoveLine>, act<EndTransaction>},
+     State::I},
+    {State::M_I, Event::SnpRspCleanInvalid, nullptr, nullptr,
+     {act<DelResponder>, act<IncSnoop>},
+     State::M_I},
+    {State::O_I, Event::SnpRspCleanInvalid, &is_final, "is_final",
+     {act<DelResponder>, act<IncSnoop>, act<IssueCohEnd<false>>,
+      act<RemoveLine>, act<EndTransaction>},
+     State::I},
+    {State::O_I, Event::SnpRspCleanInvalid, nullptr, nullptr,
+     {act<DelResponder>, act<IncSnoop>},
+     State::O_I},
+    {State::S_I, Event::SnpRspMakeInvalid, &is_final, "is_final",
+     {act<DelResponder>, act<IncSnoop>, act<IssueCohEnd<false>>,
+      act<RemoveLine>, act<EndTransaction>},
+     State::I},
+    {State::S_I, Event::SnpRspMakeInvalid, nullptr, nullptr,
+     {act<DelResponder>, act<IncSnoop>},
+     State::S_I},
+    {State::E_I, Event::SnpRspMakeInvalid, &is_final, "is_final",
+     {act<DelResponder>, act<IncSnoop>, act<IssueCohEnd<false>>,
+      act<RemoveLine>, act<EndTransaction>},
+     State::I},
+    {State::E_I, Event::SnpRspMakeInvalid, nullptr, nullptr,
+     {act<DelResponder>, act<IncSnoop>},
+     State::E_I},
+    {State::M_I, Event::SnpRspMakeInvalid, &is_final, "is_final",
+     {act<DelResponder>, act<IncSnoop>, act<IssueCohEnd<false>>,
+      act<RemoveLine>, act<EndTransaction>},
+     State::I},
+    {State::M_I, Event::SnpRspMakeInvalid, nullptr, nullptr,
+     {act<DelResponder>, act<IncSnoop>},
+     State::M_I},
+    {State::O_I, Event::SnpRspMakeInvalid, &is_final, "is_final",
+     {act<DelResponder>, act<IncSnoop>, act<IssueCohEnd<false>>,
+      act<RemoveLine>, act<EndTransaction>},
+     State::I},
+    {State::O_I, Event::SnpRspMakeInvalid, nullptr, nullptr,
+     {act<DelResponder>, act<IncSnoop>},
+     State::O_I},
+
+    // MakeUnique; originator now has Exclusive access to the line and
+    // will, presumably, perform a full line write. From the
+    // perspective of the directory, Exclusive is synonymous with
+    // Modified.
+    {State::S_I, Event::SnpRspMakeUnique, &is_final, "is_final",
+     {act<DelResponder>, act<IncSnoop>, act<IssueCohEnd<false>>,
+      act<RemoveLine>, act<EndTransaction>},
+     State::E},
+    {State::S_I, Event::SnpRspMakeUnique, nullptr, nullptr,
+     {act<DelResponder>, act<IncSnoop>},
+     State::S_I},
+    {State::E_I, Event::SnpRspMakeUnique, &is_final, "is_final",
+     {act<DelResponder>, act<IncSnoop>, act<IssueCohEnd<false>>,
+      act<RemoveLine>, act<EndTransaction>},
+     State::E},
+    {State::E_I, Event::SnpRspMakeUnique, nullptr, nullptr,
+     {act<DelResponder>, act<IncSnoop>},
+     State::E_I},
+    {State::M_I, Event::SnpRspMakeUnique, &is_final, "is_final",
+     {act<DelResponder>, act<IncSnoop>, act<IssueCohEnd<false>>,
+      act<RemoveLine>, act<EndTransaction>},
+     State::E},
+    {State::M_I, Event::SnpRspMakeUnique, nullptr, nullptr,
+     {act<DelResponder>, act<IncSnoop>},
+     State::M_I},
+    {State::O_I, Event::SnpRspMakeUnique, &is_final, "is_final",
+     {act<DelResponder>, act<IncSnoop>, act<IssueCohEnd<false>>,
+      act<RemoveLine>, act<EndTransaction>},
+     State::E},
+    {State::O_I, Event::SnpRspMakeUnique, nullptr, nullptr,
+     {act<DelResponder>, act<IncSnoop>},
+     State::O_I},
+
+    // Recall; upon completion, no coherence response is emitted since
+    // the operation was not initiated by a coherence command. The line
+    // is deleted and the transaction ends, which then causes the
+    // originating message to become unblocked.
+    {State::S_I, Event::SnpRspRecall, &is_final, "is_final",
+     {act<DelRecallResponder>, act<IncSnoop>, act<RemoveLine>,
+      act<EndTransaction>},
+     State::I},
+    {State::S_I, Event::SnpRspRecall, nullptr, nullptr,
+     {act<DelRecallResponder>, act<IncSnoop>},
+     State::S_I},
+    {State::E_I, Event::SnpRspRecall, &is_final, "is_final",
+     {act<DelRecallResponder>, act<IncSnoop>, act<RemoveLine>,
+      act<EndTransaction>},
+     State::I},
+    {State::E_I, Event::SnpRspRecall, nullptr, nullptr,
+     {act<DelRecallResponder>, act<IncSnoop>},
+     State::E_I},
+    {State::M_I, Event::SnpRspRecall, &is_final, "is_final",
+     {act<DelRecallResponder>, act<IncSnoop>, act<RemoveLine>,
+      act<EndTransaction>},
+     State::I},
+    {State::M_I, Event::SnpRspRecall, nullptr, nullptr,
+     {act<DelRecallResponder>, act<IncSnoop>},
+     State::M_I},
+    {State::O_I, Event::SnpRspRecall, &is_final, "is_final",
+     {act<DelRecallResponder>, act<IncSnoop>, act<RemoveLine>,
+      act<EndTransaction>},
+     State::I},
+    {State::O_I, Event::SnpRspRecall, nullptr, nullptr,
+     {act<DelRecallResponder>, act<IncSnoop>},
+     State::O_I},
+
+    //
+    // Recall
+    //
+    // Line nominated for eviction is invalidated in all agents. The
+    // current message is blocked until the recall has completed.
+    //
+    {State::S, Event::Recall, nullptr, nullptr,
+     {act<StartTransaction>, act<SnoopRecall>, act<BlockOnTransaction>,
+      act<Advance>},
+     State::S_I},
+    {State::E, Event::Recall, nullptr, nullptr,
+     {act<StartTransaction>, act<SnoopRecall>, act<BlockOnTransaction>,
+      act<Advance>},
+     State::E_I},
+    {State::M, Event::Recall, nullptr, nullptr,
+     {act<StartTransaction>, act<SnoopRecall>, act<BlockOnTransaction>,
+      act<Advance>},
+     State::M_I},
+    {State::O, Event::Recall, nullptr, nullptr,
+     {act<StartTransaction>, act<SnoopRecall>, act<BlockOnTransaction>,
+      act<Advance>},
+     State::O_I},
+}};
+
+constexpr TransitionTable<DirTransition, dir_transitions.size(),
+                          static_cast<std::size_t>(State::O_SE) + 1,
+                          static_cast<std::size_t>(Event::Invalid)>
+    dir_table{dir_transitions};
+
 //
 //
-class MOESIDirProtocol : public DirProtocol {
+class MOESIDirProtocol final : public DirProtocol {
   using cb = DirCommandBuilder;
 
  public:
@@ -430,7 +1635,7 @@ class MOESIDirProtocol : public DirProtocol {
   //
   //
   DirLineState* construct_line() const override {
-    LineState* line = new LineState;
+    LineState* line = new LineState(sharer_domain());
     return line;
   }
 
@@ -451,6 +1656,9 @@ class MOESIDirProtocol : public DirProtocol {
       case MessageClass::CohSnpRsp: {
         apply(ctxt, cl, static_cast<const CohSnpRspMsg*>(ctxt.msg()));
       } break;
+      case MessageClass::MemRsp: {
+        apply(ctxt, cl, static_cast<const MemRspMsg*>(ctxt.msg()));
+      } break;
       default: {
         LogMessage msg("Invalid message class received!");
         msg.set_level(Level::Fatal);
@@ -461,79 +1669,14 @@ class MOESIDirProtocol : public DirProtocol {
 
   // Recall currently nominated line.
   void recall(DirContext& ctxt, DirCommandList& cl) const override {
-    DirTState* tstate = ctxt.tstate();
-    LineState* line = static_cast<LineState*>(tstate->line());
-
-    // New "recall" transaction started.
-    cl.push_back(DirOpcode::StartTransaction);
-
-    // All snoop messages emitted by the recall operation, inherit
-    // from the transaction of the initiating message. This is
-    // probably okay as this can logically be considered to be part
-    // of the overall load/store transaction (although this was not
-    // the initial intention).
-    const Message* msg = ctxt.mq()->peek();
-
     // Set current operation: recall.
-    tstate->set_opcode(AceCmdOpcode::Recall);
-
-    // Issue recall message to CleanInvalid to all agents with the line.
-    CohSnpMsg* snp = nullptr;
-    std::size_t snoop_n = 0;
-
-    // Issue CleanInvalid to owner, if defined.
-    if (Agent* owner = line->owner(); owner != nullptr) {
-      snp = Pool<CohSnpMsg>::construct();
-      snp->set_t(msg->t());
-      snp->set_addr(ctxt.addr());
-      snp->set_origin(ctxt.dir());
-      snp->set_agent(nullptr);
-      snp->set_opcode(AceSnpOpcode::CleanInvalid);
-      issue_msg_to_noc(ctxt, cl, snp, owner);
-
-      ++snoop_n;
-    }
-
-    for (Agent* sharer : line->sharers()) {
-      snp = Pool<CohSnpMsg>::construct();
-      snp->set_t(msg->t());
-      snp->set_addr(ctxt.addr());
-      snp->set_origin(ctxt.dir());
-      snp->set_agent(nullptr);
-      snp->set_opcode(AceSnpOpcode::CleanInvalid);
-      issue_msg_to_noc(ctxt, cl, snp, sharer);
-
-      ++snoop_n;
-    }
-
-    // Set snoop response expected count.
-    cl.push_back(tstate->build_set_snoop_n(snoop_n));
-
-    // Compute next state
-    State next_state = State::X;
-    const State state = line->state();
-    switch (state) {
-      case State::S: { next_state = State::S_I; } break;
-      case State::M: { next_state = State::M_I; } break;
-      case State::E: { next_state = State::E_I; } break;
-      case State::O: { next_state = State::O_I; } break;
-      default: {
-        // TBD: if line is present in a transition state, need to stop
-        // the recall operation until line has reached an evictable state.
-      }
-    }
-    if (next_state != state) {
-      cl.push_back(line->build_update_state(next_state));
-    }
-
-    // The current message is blocked until the current recall
-    // operation, has completed.
-    cl.push_back(DirCommandBuilder::build_blocked_on_event(
-        ctxt.mq(), tstate->transaction_end()));
-    // Advance, but do not consume message.
-    cl.next_and_do_consume(false);
+    ctxt.tstate()->set_opcode(AceCmdOpcode::Recall);
+    // TBD: if line is present in a transition state, need to stop the
+    // recall operation until line has reached an evictable state.
+    dispatch(ctxt, cl, Event::Recall);
   }
 
+ private:
   void apply(DirContext& ctxt, DirCommandList& cl, const CohSrtMsg* msg) const {
     cl.push_back(DirOpcode::StartTransaction);
     // Consume and advance
@@ -555,1128 +1698,67 @@ class MOESIDirProtocol : public DirProtocol {
     rsp->set_origin(ctxt.dir());
     issue_msg_to_noc(ctxt, cl, rsp, msg->origin());
 
-    //
-    const AceCmdOpcode opcode = tstate->opcode();
-    switch (opcode) {
-      case AceCmdOpcode::ReadNoSnoop: {
-        handle_cmd_read_no_snoop(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::ReadOnce: {
-        handle_cmd_read_once(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::ReadClean: {
-        handle_cmd_read_clean(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::ReadNotSharedDirty: {
-        handle_cmd_read_not_shared_dirty(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::ReadShared: {
-        handle_cmd_read_shared(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::ReadUnique: {
-        handle_cmd_read_unique(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::CleanUnique: {
-        handle_cmd_clean_unique(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::CleanShared: {
-        handle_cmd_clean_shared(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::CleanInvalid: {
-        handle_cmd_clean_invalid(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::MakeUnique: {
-        handle_cmd_make_unique(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::MakeInvalid: {
-        handle_cmd_make_invalid(ctxt, cl, msg);
-      } break;
+    if (ctxt.dir()->config().is_null_filter) {
+      // Null Filter; command is handled irrespective of line state.
+      handle_nf_cmd(ctxt, cl, msg);
+      return;
+    }
+
+    switch (const AceCmdOpcode opcode = msg->opcode(); opcode) {
+      case AceCmdOpcode::ReadNoSnoop:
       case AceCmdOpcode::WriteNoSnoop: {
-        handle_cmd_write_no_snoop(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::WriteUnique: {
-        handle_cmd_write_unique(ctxt, cl, msg);
+        // The directory should never see non-cached commands. Instead,
+        // the requesting agent should issue to the command directly
+        // into the interconnect where it is directed to either a
+        // memory controller or a peripheral/accelerator.
+        std::string reason = "Directory has received a non-cached command: ";
+        reason += to_string(opcode);
+        cl.raise_error(reason);
       } break;
+      case AceCmdOpcode::ReadOnce:
+      case AceCmdOpcode::ReadClean:
+      case AceCmdOpcode::ReadNotSharedDirty:
+      case AceCmdOpcode::WriteUnique:
       case AceCmdOpcode::WriteLineUnique: {
-        handle_cmd_write_line_unique(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::WriteBack: {
-        handle_cmd_write_back(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::WriteClean: {
-        handle_cmd_write_clean(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::Evict: {
-        handle_cmd_evict(ctxt, cl, msg);
+        cl.raise_error("Not implemented");
       } break;
       default: {
-        // Unknown opcode; raise error.
-        std::string reason = "Unsupported opcode received: ";
-        reason += to_string(opcode);
-        cl.raise_error(reason);
+        if (const Event event = to_cmd_event(opcode); event != Event::Invalid) {
+          dispatch(ctxt, cl, event);
+        } else {
+          // Unknown opcode; raise error.
+          std::string reason = "Unsupported opcode received: ";
+          reason += to_string(opcode);
+          cl.raise_error(reason);
+        }
       } break;
     }
   }
 
-  // C4.5.1 ReadNoSnoop
-  void handle_cmd_read_no_snoop(DirContext& ctxt, DirCommandList& cl,
-                                const CohCmdMsg* msg) const {
-    // The directory should never see non-cached commands. Instead,
-    // the requesting agent should issue to the command directly into
-    // the interconnect where it is directed to either a memory
-    // controller or a peripheral/accelerator.
-    cl.raise_error("Directory has received a non-cached command: "
-                   "ReadNoSnoop");
+  void apply(DirContext& ctxt, DirCommandList& cl,
+             const LLCCmdRspMsg* msg) const {
+    DirTState* tstate = ctxt.tstate();
+    switch (tstate->opcode()) {
+      case AceCmdOpcode::ReadShared:
+      case AceCmdOpcode::ReadUnique:
+      case AceCmdOpcode::CleanUnique: {
+        if (tstate->llc_cmd_opcode() == LLCCmdOpcode::Fill) {
+          dispatch(ctxt, cl, Event::LLCFill);
+        } else if (tstate->llc_cmd_opcode() == LLCCmdOpcode::PutLine) {
+          dispatch(ctxt, cl, Event::LLCPutLine);
+        }
+      } break;
+      default: {
+        // LLC Resp is not expected.
+      } break;
+    }
+    cl.next_and_do_consume(true);
   }
 
-  // C4.5.2 ReadOnce
   //
-  // Requesting agent receives a "snapshot" of the cache line; the
-  // cache line is fetched from memory, however nominally it is not
-  // retained by the agent for reuse (received in Shared state),
-  // however it may be retained by the agent, if already present in
-  // the cache.
   //
-  void handle_cmd_read_once(DirContext& ctxt, DirCommandList& cl,
-                            const CohCmdMsg* msg) const {
-    LineState* line = static_cast<LineState*>(ctxt.tstate()->line());
-    switch (line->state()) {
-      case State::I:
-      case State::S:
-      case State::E:
-      case State::M:
-      case State::O:
-      default: {
-        cl.raise_error("Not implemented");
-      } break;
-    }
-  }
-
-  // C4.5.3 ReadClean
-  //
-  //
-  //
-  void handle_cmd_read_clean(DirContext& ctxt, DirCommandList& cl,
-                             const CohCmdMsg* msg) const {
-    LineState* line = static_cast<LineState*>(ctxt.tstate()->line());
-    switch (line->state()) {
-      case State::I:
-      case State::S:
-      case State::E:
-      case State::M:
-      case State::O:
-      default: {
-        cl.raise_error("Not implemented");
-      } break;
-    }
-  }
-
-  // C4.5.4 ReadNotSharedDirty
-  //
-  //
-  //
-  void handle_cmd_read_not_shared_dirty(DirContext& ctxt,
-                                        DirCommandList& cl,
-                                        const CohCmdMsg* msg) const {
-    LineState* line = static_cast<LineState*>(ctxt.tstate()->line());
-    switch (line->state()) {
-      case State::I:
-      case State::S:
-      case State::E:
-      case State::M:
-      case State::O:
-      default: {
-        cl.raise_error("Not implemented");
-      } break;
-    }
-  }
-
-  // C4.5.5 ReadShared
-  //
-  //
-  void handle_cmd_read_shared(DirContext& ctxt, DirCommandList& cl,
-                              const CohCmdMsg* msg) const {
-    DirTState* tstate = ctxt.tstate();
-    LineState* line = static_cast<LineState*>(ctxt.tstate()->line());
-    const State state = line->state();
-    switch (state) {
-      case State::I: {
-        // Line is not present in the directory
-        LLCCmdMsg* cmd = Pool<LLCCmdMsg>::construct();
-        cmd->set_t(msg->t());
-        cmd->set_opcode(LLCCmdOpcode::Fill);
-        cmd->set_addr(msg->addr());
-
-        // Issue Fill command to LLC.
-        issue_msg_to_noc(ctxt, cl, cmd, ctxt.dir()->llc());
-        // Update state
-        cl.push_back(line->build_update_state(State::I_E));
-
-        // Set flag awaiting LLC response
-        cl.push_back(tstate->build_set_llc_cmd_opcode(cmd->opcode()));
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      case State::S: {
-        // Add requester to sharer list; forward data to requester
-        // from either LLC or nominated sharing cache
-        // (complication in the presence of silent evictions).
-
-        // Instruct LLC to forward line (presently in the S-state)
-        // to the requesting agent.
-        LLCCmdMsg* cmd = Pool<LLCCmdMsg>::construct();
-        cmd->set_t(msg->t());
-        cmd->set_opcode(LLCCmdOpcode::PutLine);
-        cmd->set_addr(tstate->addr());
-        cmd->set_agent(tstate->origin());
-        issue_msg_to_noc(ctxt, cl, cmd, ctxt.dir()->llc());
-        // Set flag awaiting LLC response
-        cl.push_back(tstate->build_set_llc_cmd_opcode(cmd->opcode()));
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      case State::M:
-      case State::O:
-      case State::E: {
-        // Line resides in the exclusive state, meaning that a
-        // single agent has it in either the E or M state. We
-        // therefore wish for the agent to relinquish control of
-        // the line by either updating LLC and demoting the line
-        // to S, or in the ReadShared case, transfering ownership
-        // to the requesting agent.
-        //
-        CohSnpMsg* snp = Pool<CohSnpMsg>::construct();
-        snp->set_t(msg->t());
-        snp->set_addr(msg->addr());
-        snp->set_origin(ctxt.dir());
-        snp->set_agent(msg->origin());
-        // ReadShared; owning agent can relinquish the line or
-        // retain it in the shared state.
-        snp->set_opcode(to_snp_opcode(msg->opcode()));
-        issue_msg_to_noc(ctxt, cl, snp, line->owner());
-
-        // Issue one snoop; therefore await one snoop response
-        cl.push_back(tstate->build_set_snoop_n(1));
-
-        // Directory has no notion of local modified status,
-        // therefore when a line has been installed in the
-        // Exclusive state, the directory asssumes that the cache
-        // line has been modified by the owning agent.
-        State next_state = State::X;
-        switch (state) {
-          case State::M: { next_state = State::M_O; } break;
-          case State::O: { next_state = State::O_O; } break;
-          case State::E: { next_state = State::E_O; } break;
-          default:         next_state = State::X;
-        }
-        cl.push_back(line->build_update_state(next_state));
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      default: {
-        cl.raise_error("Not implemented");
-      } break;
-    }
-  }
-
-  // C4.5.6 ReadUnique
-  //
-  void handle_cmd_read_unique(DirContext& ctxt, DirCommandList& cl,
-                              const CohCmdMsg* msg) const {
-    DirTState* tstate = ctxt.tstate();
-    LineState* line = static_cast<LineState*>(tstate->line());
-    const State state = line->state();
-    switch (state) {
-      case State::I: {
-        // Line is not present in the directory
-        LLCCmdMsg* cmd = Pool<LLCCmdMsg>::construct();
-        cmd->set_t(msg->t());
-        cmd->set_opcode(LLCCmdOpcode::Fill);
-        cmd->set_addr(msg->addr());
-
-        // Issue Fill command to LLC.
-        issue_msg_to_noc(ctxt, cl, cmd, ctxt.dir()->llc());
-        // Originator becomes owner.
-        cl.push_back(line->build_set_owner(msg->origin()));
-        // Set flag awaiting LLC response.
-        cl.push_back(tstate->build_set_llc_cmd_opcode(cmd->opcode()));
-        // Update state
-        cl.push_back(line->build_update_state(State::I_E));
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      case State::M:
-      case State::E: {
-        // Owning cache may have line in either the E or the M
-        // state; would nominally expected for the line to have
-        // been promoted to the M state by the time some other
-        // cache requests the line, but this is necessarily the
-        // case.
-        CohSnpMsg* snp = Pool<CohSnpMsg>::construct();
-        snp->set_t(msg->t());
-        snp->set_addr(msg->addr());
-        snp->set_origin(ctxt.dir());
-        snp->set_agent(msg->origin());
-        snp->set_opcode(AceSnpOpcode::ReadUnique);
-        issue_msg_to_noc(ctxt, cl, snp, line->owner());
-
-        // Transition to Exclusive state from current Shared/Exclusive
-        // state.
-        State next_state = State::X;
-        switch (state) {
-          case State::M: { next_state = State::M_ME; } break;
-          case State::E: { next_state = State::E_E; } break;
-          default:         next_state = State::X;
-        }
-        // Update state
-        cl.push_back(line->build_update_state(next_state));
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      case State::S:
-      case State::O: {
-        // Requesting cache does not have line installed and
-        // requests line in a Unique state (presumably to carry
-        // out a Store command). Some other cache has line in
-        // Ownership state, and there may be some number of other
-        // caches with the line in a Shared state.
-        //
-        // Options:
-        //
-        // 1. Owning cache transfers ownership to requesting cache;
-        //    all caches except for requester is invalidated.
-        //
-        // 2. Owning cache writes line back to memory and signals
-        //    that it no longer has the line installed. Line
-        //    must then be sourced from memory.
-        //
-        CohSnpMsg* snp = nullptr;
-        std::size_t snoop_n = 0;
-
-        // Issue snoop to owner. Owner should forwarded line to
-        // requesting agent and relinquish ownership of the line.
-        if (Agent* owner = line->owner(); owner != nullptr) {
-          snp = Pool<CohSnpMsg>::construct();
-          snp->set_t(msg->t());
-          snp->set_addr(msg->addr());
-          snp->set_origin(ctxt.dir());
-          snp->set_agent(msg->origin());
-          snp->set_opcode(to_snp_opcode(ctxt.tstate()->opcode()));
-          issue_msg_to_noc(ctxt, cl, snp, owner);
-
-          ++snoop_n;
-        }
-
-        for (Agent* sharer : line->sharers()) {
-          // Do not snoop to self.
-          if (sharer == ctxt.tstate()->origin()) continue;
-          
-          snp = Pool<CohSnpMsg>::construct();
-          snp->set_t(msg->t());
-          snp->set_addr(msg->addr());
-          snp->set_origin(ctxt.dir());
-          snp->set_agent(msg->origin());
-          snp->set_opcode(to_snp_opcode(ctxt.tstate()->opcode()));
-          issue_msg_to_noc(ctxt, cl, snp, sharer);
-
-          ++snoop_n;
-        }
-
-        // Set expected snoop response count in transaction state
-        // object.
-        cl.push_back(tstate->build_set_snoop_n(snoop_n));
-        // Update state:
-        //
-        // Owner -> Modified or Exclusive.
-        //
-        // Modified state is entered if upon concensus of the
-        // coherence operation, owner ship has been passed by the
-        // owning agent to the requester. The Exclusive state is
-        // entered if ownership is not passed.
-        const State next_state =
-            (state == State::S) ? State::S_ME : State::O_ME;
-        cl.push_back(line->build_update_state(next_state));
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      default: {
-        cl.raise_error("Not implemented");
-      } break;        
-    }
-  }
-
-  // C4.6.1 CleanUnique
-  //
-  // Requesting cache has line installed in its cache, but not in a
-  // state where a write can be performed (Shared, SC or Owned, SD).
-  // The CleanUnique command is issued such that all other copies of
-  // lines in the system are invalidated and that line in the
-  // originator is promoted to the an Exclusive state (Exclusive, UC or
-  // Modified, UD).
-  //
-  void handle_cmd_clean_unique(DirContext& ctxt, DirCommandList& cl,
-                               const CohCmdMsg* msg) const {
-    DirTState* tstate = ctxt.tstate();
-    LineState* line = static_cast<LineState*>(tstate->line());
-    const State state = line->state();
-    switch (line->state()) {
-      case State::I: {
-        // CleanUnique can be issued by agent in Invalid state
-        // although this is not typical. In this case, the transaction
-        // ends immediately as no snoops are required.
-        CohEndMsg* end = Pool<CohEndMsg>::construct();
-        end->set_t(msg->t());
-        end->set_origin(ctxt.dir());
-        // "the {IsShared/PassDirty} response must be deasserted"
-        end->set_is(false);
-        end->set_pd(false);
-        // Issue response back to originator.
-        issue_msg_to_noc(ctxt, cl, end, ctxt.tstate()->origin());
-        // Transaction is now complete.
-        cl.push_back(DirOpcode::EndTransaction);
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      case State::S:
-      case State::E:
-      case State::M:
-      case State::O: {
-        // Issue invalidation snoops to sharing agents
-        std::size_t snoop_n = 0;
-        CohSnpMsg* snp = nullptr;
-
-        // Issue invalidation snoop (CleanInvalid) to owning agent (if
-        // applicable).
-        if (Agent* owner = line->owner(); owner != nullptr) {
-          // If command originator is currently the owner, skip the
-          // invalidation snoop.
-          if (owner == msg->origin()) break;
-          
-          // Issue snoop.
-          snp = Pool<CohSnpMsg>::construct();
-          snp->set_t(msg->t());
-          snp->set_addr(msg->addr());
-          snp->set_origin(ctxt.dir());
-          snp->set_agent(msg->origin());
-          snp->set_opcode(to_snp_opcode(msg->opcode()));
-          // Issue snoop to interconnect
-          issue_msg_to_noc(ctxt, cl, snp, owner);
-          ++snoop_n;
-        }
-
-        // Issue invalidation snoops (CleanInvalid) to sharing agents.
-        for (Agent* agent : line->sharers()) {
-          // Do not sent message to originator as agent must retain
-          // line, as per. requirements.
-          if (agent == msg->origin()) continue;
-
-          // Issue snoop.
-          snp = Pool<CohSnpMsg>::construct();
-          snp->set_t(msg->t());
-          snp->set_addr(msg->addr());
-          snp->set_origin(ctxt.dir());
-          snp->set_agent(msg->origin());
-          snp->set_opcode(to_snp_opcode(msg->opcode()));
-          issue_msg_to_noc(ctxt, cl, snp, agent);
-          ++snoop_n;
-        }
-
-        // Set expected snoop response count in transaction state
-        // object.
-        cl.push_back(tstate->build_set_snoop_n(snoop_n));
-        // issue_set_snoop_n(ctxt, cl, snoop_n);
-
-        State next_state = State::X;
-        switch (state) {
-          // Transition from clean state to exclusive
-          case State::S: { next_state = State::S_E; } break;
-          case State::E: { next_state = State::E_E; } break;
-
-          // Transition to Exclusive of Owned state depending upon
-          // whether the owning agent performs a writeback to memory
-          // before forwarding the line. Owning agent can potentially
-          // opt. to transfer ownership a the dirty line to the
-          // requesting agent.
-          case State::M: { next_state = State::M_EO; } break;
-          case State::O: { next_state = State::M_EO; } break;
-          default:         next_state = State::X;
-        }
-        cl.push_back(line->build_update_state(next_state));
-
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      default: {
-        cl.raise_error("Not implemented");
-      } break;        
-    }
-  }
-
-  // C4.6.2 CleanShared
-  //
-  // Command instructs all agents holding the line to clean the
-  // line. Agents may choose to retain the line is a clean state
-  // (Shared, SC or Exclusive, UC) or may choose to invalidate (after
-  // a prior writeback operation when applicable). As the transaction
-  // does not snoop the requesting agent, the requestor must the line
-  // in a clean state before issuing the CleanShared command.
-  //
-  void handle_cmd_clean_shared(DirContext& ctxt, DirCommandList& cl,
-                               const CohCmdMsg* msg) const {
-    DirTState* tstate = ctxt.tstate();
-    LineState* line = static_cast<LineState*>(tstate->line());
-    const State state = line->state();
-    switch (line->state()) {
-      case State::I: {
-        // CleanUnique can be issued by agent in Invalid state
-        // although this is not typical. In this case, the transaction
-        // ends immediately as no snoops are required.
-        CohEndMsg* end = Pool<CohEndMsg>::construct();
-        end->set_t(msg->t());
-        end->set_origin(ctxt.dir());
-        // "the {IsShared/PassDirty} response must be deasserted"
-        end->set_is(false);
-        end->set_pd(false);
-        // Issue response back to originator.
-        issue_msg_to_noc(ctxt, cl, end, ctxt.tstate()->origin());
-        // Transaction is now complete.
-        cl.push_back(DirOpcode::EndTransaction);
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      case State::S:
-      case State::E:
-      case State::M:
-      case State::O: {
-        // Issue invalidation snoops to sharing agents
-        std::size_t snoop_n = 0;
-        CohSnpMsg* snp = nullptr;
-
-        // Issue invalidation snoop (CleanInvalid) to owning agent (if
-        // applicable).
-        if (Agent* owner = line->owner(); owner != nullptr) {
-          // If command originator is currently the owner, skip the
-          // invalidation snoop.
-          if (owner == msg->origin()) break;
-          
-          // Issue snoop.
-          snp = Pool<CohSnpMsg>::construct();
-          snp->set_t(msg->t());
-          snp->set_addr(msg->addr());
-          snp->set_origin(ctxt.dir());
-          snp->set_agent(msg->origin());
-          snp->set_opcode(to_snp_opcode(msg->opcode()));
-          // Issue snoop to interconnect
-          issue_msg_to_noc(ctxt, cl, snp, owner);
-          ++snoop_n;
-        }
-
-        // Issue invalidation snoops (CleanInvalid) to sharing agents.
-        for (Agent* agent : line->sharers()) {
-          // Do not sent message to originator as agent must retain
-          // line, as per. requirements.
-          if (agent == msg->origin()) continue;
-
-          // Issue snoop.
-          snp = Pool<CohSnpMsg>::construct();
-          snp->set_t(msg->t());
-          snp->set_addr(msg->addr());
-          snp->set_origin(ctxt.dir());
-          snp->set_agent(msg->origin());
-          snp->set_opcode(to_snp_opcode(msg->opcode()));
-          issue_msg_to_noc(ctxt, cl, snp, agent);
-          ++snoop_n;
-        }
-
-        // Set expected snoop response count in transaction state
-        // object.
-        cl.push_back(tstate->build_set_snoop_n(snoop_n));
-        // issue_set_snoop_n(ctxt, cl, snoop_n);
-
-        State next_state = State::X;
-        switch (state) {
-          // Transition from clean state to Shared or Exclusive (where
-          // requester is the cache in the Exclusive state).
-          case State::S: { next_state = State::S_SE; } break;
-          case State::E: { next_state = State::E_SE; } break;
-
-          // Transition from Dirty state to Shared to Exclusve state
-          // depending upon whether the Owning agent decides to
-          // retain the line after its writeback).
-          case State::M: { next_state = State::M_SE; } break;
-          case State::O: { next_state = State::O_SE; } break;
-          default:         next_state = State::X;
-        }
-        cl.push_back(line->build_update_state(next_state));
-
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      default: {
-        cl.raise_error("Not implemented");
-      } break;        
-    }
-  }
-
-  // C4.6.3 CleanInvalid
-  //
-  // For all agents holding the line, invalidate the line such that
-  // upon completion of the command no cache is holding the line and
-  // main memory is holding a valid and upto date copy.
-  //
-  void handle_cmd_clean_invalid(DirContext& ctxt, DirCommandList& cl,
-                                const CohCmdMsg* msg) const {
-    DirTState* tstate = ctxt.tstate();
-    LineState* line = static_cast<LineState*>(tstate->line());
-    const State state = line->state();
-    switch (state) {
-      case State::I: {
-        // No lines have the cache, command is effectively a nop
-        // and therefore completes immediately.
-        CohEndMsg* end = Pool<CohEndMsg>::construct();
-        end->set_t(msg->t());
-        end->set_origin(ctxt.dir());
-        // "the {IsShared/PassDirty} response must be deasserted"
-        end->set_is(false);
-        end->set_pd(false);
-        // Issue response back to originator.
-        issue_msg_to_noc(ctxt, cl, end, ctxt.tstate()->origin());
-        // Transaction is now complete.
-        cl.push_back(DirOpcode::EndTransaction);
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      case State::S:
-      case State::E:
-      case State::M:
-      case State::O: {
-        // Otherwise, issue invalidation snoops (MakeInvalid) to the
-        // Owner (if present), and sharers (if present).
-        std::size_t snoop_n = 0;
-        CohSnpMsg* snp = nullptr;
-        if (Agent* owner = line->owner(); owner != nullptr) {
-          // Issue invalidation to owner
-          snp = Pool<CohSnpMsg>::construct();
-          snp->set_t(msg->t());
-          snp->set_addr(msg->addr());
-          snp->set_origin(ctxt.dir());
-          snp->set_agent(ctxt.tstate()->origin());
-          snp->set_opcode(to_snp_opcode(msg->opcode()));
-          // Issue to interconnect
-          issue_msg_to_noc(ctxt, cl, snp, owner);
-          ++snoop_n;
-        }
-        for (Agent* sharer : line->sharers()) {
-          // Issue invalidation to sharer
-          snp = Pool<CohSnpMsg>::construct();
-          snp->set_t(msg->t());
-          snp->set_addr(msg->addr());
-          snp->set_origin(ctxt.dir());
-          snp->set_agent(ctxt.tstate()->origin());
-          snp->set_opcode(to_snp_opcode(msg->opcode()));
-          // Issue to interconnect
-          issue_msg_to_noc(ctxt, cl, snp, sharer);
-          ++snoop_n;
-        }
-        // Set expected number of snoop responses.
-        cl.push_back(tstate->build_set_snoop_n(snoop_n));
-        // Compute next state (transition to invalid)
-        State next_state = State::X;
-        switch (state) {
-          case State::S: { next_state = State::S_I; } break;
-          case State::E: { next_state = State::E_I; } break;
-          case State::M: { next_state = State::M_I; } break;
-          case State::O: { next_state = State::O_I; } break;
-          default:         next_state = State::X;
-        }
-        cl.push_back(line->build_update_state(next_state));
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      default: {
-        cl.raise_error("Not implemented");
-      } break;        
-    }
-  }
-
-  // C4.7.1 Make Unique
-  //
-  // Invalidate all copies of the line in all agents aside from the
-  // command initiator. From the perspective of the directory, this
-  // command behaves as the MakeInvalid command. The major difference
-  // between the two commands is at the L2, where the line remains
-  // installed in the originator, which then performs a full-cache
-  // line write. We therefore piggy-back the MakeInvalid
-  // implementation.
-  //
-  void handle_cmd_make_unique(DirContext& ctxt, DirCommandList& cl,
-                              const CohCmdMsg* msg) const {
-    handle_cmd_make_invalid(ctxt, cl, msg);
-  }
-
-  // C4.7.2 Make Invalid
-  //
-  // Invalidate all agents currently holding the line regardless of
-  // state (owning/sharing). Command assumes that the initiating
-  // agent had previously invalidate the line held in its cache,
-  // therefore a snoop is not issued to the originator.
-  // 
-  void handle_cmd_make_invalid(DirContext& ctxt, DirCommandList& cl,
-                               const CohCmdMsg* msg) const {
-    DirTState* tstate = ctxt.tstate();
-    LineState* line = static_cast<LineState*>(ctxt.tstate()->line());
-    const State state = line->state();
-    switch (state) {
-      case State::I: {
-        // No lines have the cache, command is effectively a nop
-        // and therefore completes immediately.
-        CohEndMsg* end = Pool<CohEndMsg>::construct();
-        end->set_t(msg->t());
-        end->set_origin(ctxt.dir());
-        // "the {IsShared/PassDirty} response must be deasserted"
-        end->set_is(false);
-        end->set_pd(false);
-        // Issue response back to originator.
-        issue_msg_to_noc(ctxt, cl, end, ctxt.tstate()->origin());
-        // Transaction is now complete.
-        cl.push_back(DirOpcode::EndTransaction);
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      case State::S:
-      case State::E:
-      case State::M:
-      case State::O: {
-        // Otherwise, issue invalidation snoops (MakeInvalid) to the
-        // Owner (if present), and sharers (if present).
-        std::size_t snoop_n = 0;
-        CohSnpMsg* snp = nullptr;
-        if (Agent* owner = line->owner(); owner != nullptr) {
-          // Issue invalidation to owner
-          snp = Pool<CohSnpMsg>::construct();
-          snp->set_t(msg->t());
-          snp->set_addr(msg->addr());
-          snp->set_origin(ctxt.dir());
-          snp->set_agent(ctxt.tstate()->origin());
-          snp->set_opcode(to_snp_opcode(msg->opcode()));
-          // Issue to interconnect
-          issue_msg_to_noc(ctxt, cl, snp, owner);
-          ++snoop_n;
-        }
-        for (Agent* sharer : line->sharers()) {
-          // Issue invalidation to sharer
-          snp = Pool<CohSnpMsg>::construct();
-          snp->set_t(msg->t());
-          snp->set_addr(msg->addr());
-          snp->set_origin(ctxt.dir());
-          snp->set_agent(ctxt.tstate()->origin());
-          snp->set_opcode(to_snp_opcode(msg->opcode()));
-          // Issue to interconnect
-          issue_msg_to_noc(ctxt, cl, snp, sharer);
-          ++snoop_n;
-        }
-        // Set expected number of snoop responses.
-        cl.push_back(tstate->build_set_snoop_n(snoop_n));
-        // Compute next state (transition to invalid)
-        State next_state = State::X;
-        switch (state) {
-          case State::S: { next_state = State::S_I; } break;
-          case State::E: { next_state = State::E_I; } break;
-          case State::M: { next_state = State::M_I; } break;
-          case State::O: { next_state = State::O_I; } break;
-          default:         next_state = State::X;
-        }
-        cl.push_back(line->build_update_state(next_state));
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      default: {
-        cl.raise_error("Invalid state");
-      } break;
-    }
-  }
-
-  // C4.8.1
-  //
-  // Agent issues a write to a non-cacheable region of memory. As the
-  // line is non-cachable, this command should never reach the
-  // directory and should be handled externally by the system
-  // interconnect.
-  //
-  void handle_cmd_write_no_snoop(DirContext& ctxt, DirCommandList& cl,
-                                 const CohCmdMsg* msg) const {
-    // The directory should never see non-cached commands. Instead,
-    // the requesting agent should issue to the command directly into
-    // the interconnect where it is directed to either a memory
-    // controller or a peripheral/accelerator.
-    cl.raise_error("Directory has received a non-cached command: "
-                   "ReadNoSnoop");
-  }
-
-  // C4.8.2
-  //
-  // Write line from the clean S or E states. Typically used by
-  // non-cachable agents who are writing to a cacheable region of
-  // memory.
-  //
-  // Salient point:
-  // 
-  // "In the case of master holding a line in a Clean state while
-  // performing a WriteUnique transaction, the cache line must be
-  // updated to the new value when the WriteUnique transaction
-  // response is received."
-  //
-  // This point requires that the WriteUnique be held in a speculative
-  // state until the response has been received. The command can only
-  // write from a Clean state, which means that the line itself is the
-  // most recent value in the system, the Write operation therefore
-  // only removes the Uniqueness of the line. Which is why, I guess,
-  // the line update is held of until the response. The agent must
-  // response to snoops to the line when the WriteUnique is in
-  // progress.
-  //
-  void handle_cmd_write_unique(DirContext& ctxt, DirCommandList& cl,
-                               const CohCmdMsg* msg) const {
-    LineState* line = static_cast<LineState*>(ctxt.tstate()->line());
-    switch (line->state()) {
-      case State::I:
-      case State::S:
-      case State::E:
-      case State::M:
-      case State::O:
-      default: {
-        cl.raise_error("Not implemented");
-      } break;        
-    }
-  }
-
-  // C4.8.3
-  void handle_cmd_write_line_unique(DirContext& ctxt, DirCommandList& cl,
-                                    const CohCmdMsg* msg) const {
-    LineState* line = static_cast<LineState*>(ctxt.tstate()->line());
-    switch (line->state()) {
-      case State::I:
-      case State::S:
-      case State::E:
-      case State::M:
-      case State::O:
-      default: {
-        cl.raise_error("Not implemented");
-      } break;        
-    }
-  }
-
-  // C4.8.4 Writeback
-  //
-  // Agent issues a WriteBack to main memory such that the line
-  // contained by the LLC is up to date. Upon completion of the
-  // command, the line is invalidated and is no longer resident in the
-  // originators cache.
-  //
-  // Command presupposes that requesting agent has already written
-  // line to appropriate location in LLC before issuing the command to
-  // the directory. The directory itself is not responsible for
-  // forwarding the data to the LLC.
-  //
-  void handle_cmd_write_back(DirContext& ctxt, DirCommandList& cl,
-                             const CohCmdMsg* msg) const {
-    LineState* line = static_cast<LineState*>(ctxt.tstate()->line());
-    const State state = line->state();
-    switch (line->state()) {
-      case State::I:
-      case State::S: {
-        // Writeback cannot be issued by agent when line is in the
-        // Invalid or Shared states; line must be unique in a cache.
-        using cc::to_string;
-        std::string reason;
-        reason += "Writeback issued by agent: ";
-        reason += msg->origin()->path();
-        reason += " but directory indicates that line is presently in the: ";
-        reason += to_string(state);
-        reason += " state.";
-        cl.raise_error(reason);
-      } break;
-      case State::M:
-      case State::O:
-      case State::E: {
-        // Form coherence result; line is now invalid.  Agent cache
-        // controller must have first issued to the Dt to LLC and have
-        // received its response before issuing the WriteBack to the
-        // directory.
-        CohEndMsg* end = Pool<CohEndMsg>::construct();
-        end->set_t(msg->t());
-        end->set_dt_n(0);
-        issue_msg_to_noc(ctxt, cl, end, msg->origin());
-        // Line becomes idle.
-        cl.push_back(line->build_update_state(State::I));
-        // Perhaps the line can be retained by the LLC but be simply
-        // non-resident in any of the child caches. 
-        cl.push_back(DirOpcode::RemoveLine);
-        cl.push_back(DirOpcode::EndTransaction);
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      default: {
-        cl.raise_error("Not implemented");
-      } break;        
-    }
-  }
-
-  // C4.8.5
-  //
-  // Agent issues a WriteClean to such that the corresponding line in
-  // LLC is up to date. The agent retains its own copy of the cache
-  // line, but in a Clean (E, S) state.
-  //
-  // As in the Writeback case, except that the line is retained upon
-  // completion of the command.
-  //
-  void handle_cmd_write_clean(DirContext& ctxt, DirCommandList& cl,
-                              const CohCmdMsg* msg) const {
-    LineState* line = static_cast<LineState*>(ctxt.tstate()->line());
-    const State state = line->state();
-    switch (state) {
-      case State::I:
-      case State::S: {
-        // Writeback cannot be issued by agent when line is in the
-        // Invalid or Shared states; line must be unique in a cache.
-        using cc::to_string;
-        std::string reason;
-        reason += "Writeclean issued by agent: ";
-        reason += msg->origin()->path();
-        reason += " but directory indicates that line is presently in the: ";
-        reason += to_string(state);
-        reason += " state.";
-        cl.raise_error(reason);
-      } break;
-      case State::E:
-      case State::M:
-      case State::O: {
-        // Form coherence result; line is now invalid.  Agent cache
-        // controller must have first issued to the Dt to LLC and have
-        // received its response before issuing the WriteBack to the
-        // directory.
-        CohEndMsg* end = Pool<CohEndMsg>::construct();
-        end->set_t(msg->t());
-        end->set_dt_n(0);
-        // Issue coherence end message back to originator.
-        issue_msg_to_noc(ctxt, cl, end, ctxt.tstate()->origin());
-        // Line becomes idle.
-        State next_state = State::X;
-        switch (state) {
-          // Line returns to Clean state from Unique, which is
-          // Exclusive.
-          case State::E: { next_state = State::E; } break;
-          case State::M: { next_state = State::E; } break;
-          // WriteClean does not invalidate lines present in other caches,
-          // therefore line returns back to Shared state.
-          case State::O: { next_state = State::S; } break;
-          default:       { next_state = State::X; } break;
-        }
-        cl.push_back(line->build_update_state(next_state));
-        // Transaction is complete
-        cl.push_back(DirOpcode::EndTransaction);
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      default: {
-        cl.raise_error("Not implemented");
-      } break;        
-    }
-  }
-
-  // C4.9.1 Evict
-  void handle_cmd_evict(DirContext& ctxt, DirCommandList& cl,
-                        const CohCmdMsg* msg) const {
-    LineState* line = static_cast<LineState*>(ctxt.tstate()->line());
-    switch (line->state()) {
-      case State::I:
-        // The spec does not specifically mention what happens in this
-        // case as one cannot explicitly evict a line which has not
-        // been installed in the cache. In this case, we simply ignore
-        // the command and consider it to be spurious.
-        [[fallthrough]];
-      case State::S:
-      case State::E: {
-        // Line is installed in the Exclusive state within the
-        // requester's cache. As the line is exclusive, remove the
-        // from the directory cache and issue a response.
-
-        // Issue coherence response, line has now been removed from cache.
-        CohEndMsg* end = Pool<CohEndMsg>::construct();
-        end->set_t(msg->t());
-        // No data transfer associated with Evict transaction.
-        end->set_dt_n(0);
-        issue_msg_to_noc(ctxt, cl, end, msg->origin());
-
-        // TODO; del sharer/owner
-
-        // Line becomes idle.
-        cl.push_back(line->build_update_state(State::I));
-        cl.push_back(DirOpcode::RemoveLine);
-        cl.push_back(DirOpcode::EndTransaction);
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      case State::M:
-      case State::O: {
-        using cc::to_string;
-
-        // Cannot evict a line which is current in a modified state.
-        std::string reason = "Agent: ";
-        reason += msg->origin()->path();
-        reason += " evicts cache line: ";
-        reason += to_string(msg->addr());
-        reason += " but line is currently in modified state: ";
-        reason += to_string(line->state());
-        cl.raise_error(reason);
-      } break;
-      default: {
-        cl.raise_error("Not implemented");
-      } break;        
-    }
-  }
-
-  void apply(DirContext& ctxt, DirCommandList& cl, const LLCCmdRspMsg* msg) const {
-    const AceCmdOpcode opcode = ctxt.tstate()->opcode();
-    switch (opcode) {
-      case AceCmdOpcode::ReadShared: {
-        handle_llc_read_shared(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::ReadUnique: {
-        handle_llc_read_unique(ctxt, cl, msg);
-      } break;
-      default: {
-        // LLC Resp is not expected.
-      } break;
-    }
-    cl.next_and_do_consume(true);
-  }
-
-  // TODO; rationalize
-  void handle_llc_read_shared(DirContext& ctxt, DirCommandList& cl,
-                              const LLCCmdRspMsg* msg) const {
-    LineState* line = static_cast<LineState*>(ctxt.tstate()->line());
-    DirTState* tstate = ctxt.tstate();
-    const LLCCmdOpcode opcode = tstate->llc_cmd_opcode();
-    switch (opcode) {
-      case LLCCmdOpcode::Fill: {
-        // Initial line installation in LLC; followed by PutLine to
-        // requesting agent.
-
-        // Issue Forward command to LLC to send newly installed line
-        // to requesting agent.
-        LLCCmdMsg* cmd = Pool<LLCCmdMsg>::construct();
-        cmd->set_t(msg->t());
-        cmd->set_opcode(LLCCmdOpcode::PutLine);
-        cmd->set_addr(tstate->addr());
-        cmd->set_agent(tstate->origin());
-        issue_msg_to_noc(ctxt, cl, cmd, ctxt.dir()->llc());
-        // Set flag indicating that we are waiting Put response.
-        cl.push_back(tstate->build_set_llc_cmd_opcode(cmd->opcode()));
-      } break;
-      case LLCCmdOpcode::PutLine: {
-        // On Put completion, transaction is now complete.
-
-        // Issue coherence result to command originator.
-        CohEndMsg* end = Pool<CohEndMsg>::construct();
-        end->set_t(msg->t());
-        end->set_origin(ctxt.dir());
-        // Cannot be dirty (by definition) if sourced from LLC.
-        end->set_pd(false);
-        // Only one DT since LLC would not have been queried if
-        // an intervention had taken place.
-        end->set_dt_n(1);
-        // Compute next state:
-        State next_state = State::X;
-        const State state = line->state();
-        switch(line->state()) {
-          case State::I_E: {
-            // LLC has been queried because the line is presently
-            // invalid (not present in any L2). The requester
-            // therefore receives the line in the Exclusive state.
-            end->set_is(false);
-            cl.push_back(line->build_set_owner(tstate->origin()));
-            next_state = State::E;
-          } break;
-          case State::S: {
-            // LLC has been queried because the line is presently in
-            // the Shared state. Nominally, we could request an agent
-            // to forward the clean line to the requesting agent
-            // through intervention, but this adds a bit more
-            // complexity as we cannot assume the agent has the line
-            // as it may have been silently evicted.
-            end->set_is(true);
-            cl.push_back(line->build_add_sharer(tstate->origin()));
-            next_state = State::S;
-          } break;
-          default: {
-            // Invalid state
-          } break;
-        }
-        // Issue coherence result response.
-        issue_msg_to_noc(ctxt, cl, end, tstate->origin());
-        // Update state
-        cl.push_back(line->build_update_state(next_state));
-        // Transaction ends
-        cl.push_back(DirOpcode::EndTransaction);
-      } break;
-      default: {
-      } break;
-    }
-  }
-
-  void handle_llc_read_unique(DirContext& ctxt, DirCommandList& cl,
-                              const LLCCmdRspMsg* msg) const {
-    LineState* line = static_cast<LineState*>(ctxt.tstate()->line());
-    DirTState* tstate = ctxt.tstate();
-    const LLCCmdOpcode opcode = tstate->llc_cmd_opcode();
-    switch (opcode) {
-      case LLCCmdOpcode::Fill: {
-        // Initial line installation in LLC; followed by PutLine to
-        // requesting agent.
-
-        // Issue Forward command to LLC to send newly installed line
-        // to requesting agent.
-        LLCCmdMsg* cmd = Pool<LLCCmdMsg>::construct();
-        cmd->set_t(msg->t());
-        cmd->set_opcode(LLCCmdOpcode::PutLine);
-        cmd->set_addr(tstate->addr());
-        cmd->set_agent(tstate->origin());
-        issue_msg_to_noc(ctxt, cl, cmd, ctxt.dir()->llc());
-        // Set flag indicating that we are waiting Put response.
-        cl.push_back(tstate->build_set_llc_cmd_opcode(cmd->opcode()));
-      } break;
-      case LLCCmdOpcode::PutLine: {
-        // On Put completion, transaction is now complete.
-
-        // Issue coherence result to command originator.
-        CohEndMsg* end = Pool<CohEndMsg>::construct();
-        end->set_t(msg->t());
-        end->set_origin(ctxt.dir());
-        // Cannot be Shared as ReadUnique
-        end->set_is(false);
-        // May have been passes as dirty
-        end->set_pd(ctxt.pd());
-        // Only one DT since LLC would not have been queried if
-        // an intervention had taken place.
-        end->set_dt_n(1);
-        issue_msg_to_noc(ctxt, cl, end, tstate->origin());
-        // Update state
-        const State next_state = end->pd() ? State::M : State::E;
-        cl.push_back(line->build_update_state(next_state));
-        // Transaction ends
-        cl.push_back(DirOpcode::EndTransaction);
-      } break;
-      default: {
-        // Error out.
-      } break;
-    }
-  }
-
-  //
-  //
-  void apply(DirContext& ctxt, DirCommandList& cl, const CohSnpRspMsg* msg) const {
+  void apply(DirContext& ctxt, DirCommandList& cl,
+             const CohSnpRspMsg* msg) const {
     DirTState* tstate = ctxt.tstate();
 
     // Update snoop response concensus.
@@ -1701,69 +1783,18 @@ class MOESIDirProtocol : public DirProtocol {
     ctxt.set_dt_n(tstate->dt_i() + (msg->dt() ? 1 : 0));
     ctxt.set_pd_n(tstate->pd_i() + (msg->pd() ? 1 : 0));
     ctxt.set_is_n(tstate->is_i() + (msg->is() ? 1 : 0));
-    
-    const AceCmdOpcode opcode = ctxt.tstate()->opcode();
-    switch (opcode) {
-      case AceCmdOpcode::ReadNoSnoop: {
-        handle_snp_read_no_snoop(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::ReadOnce: {
-        handle_snp_read_once(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::ReadClean: {
-        handle_snp_read_clean(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::ReadNotSharedDirty: {
-        handle_snp_read_not_shared_dirty(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::ReadShared: {
-        handle_snp_read_shared(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::ReadUnique: {
-        handle_snp_read_unique(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::CleanUnique: {
-        handle_snp_clean_unique(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::CleanShared: {
-        handle_snp_clean_shared(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::CleanInvalid: {
-        handle_snp_clean_invalid(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::MakeUnique: {
-        handle_snp_make_unique(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::MakeInvalid: {
-        handle_snp_make_invalid(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::WriteNoSnoop: {
-        handle_snp_write_no_snoop(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::WriteUnique: {
-        handle_snp_write_unique(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::WriteLineUnique: {
-        handle_snp_write_line_unique(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::WriteBack: {
-        handle_snp_write_back(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::WriteClean: {
-        handle_snp_write_clean(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::Evict: {
-        handle_snp_evict(ctxt, cl, msg);
-      } break;
-      case AceCmdOpcode::Recall: {
-        handle_snp_recall(ctxt, cl, msg);
-      } break;
-      default: {
-        // Unknown opcode; raise error.
-        std::string reason = "Unsupported opcode received: ";
-        reason += to_string(opcode);
-        cl.raise_error(reason);
-      } break;
+
+    if (ctxt.dir()->config().is_null_filter) {
+      // Null Filter; response is handled irrespective of line state.
+      handle_nf_snp(ctxt, cl, msg);
+    } else if (const Event event = to_snp_rsp_event(tstate->opcode());
+               event != Event::Invalid) {
+      dispatch(ctxt, cl, event);
+    } else {
+      // Command should not issue a Snoop therefore we so not expect a
+      // snoop response.
+      cl.raise_error("Snoop response raised for command which does "
+                     "not issue a snoop command");
     }
 
     // Update (Snoop) Credit Counter.
@@ -1772,577 +1803,164 @@ class MOESIDirProtocol : public DirProtocol {
     cl.next_and_do_consume(true);
   }
 
-  void handle_snp_read_no_snoop(DirContext& ctxt, DirCommandList& cl,
-                                const CohSnpRspMsg* msg) const {
-    // No snoops associated with ReadNoSnoop
-    cl.raise_error("Unexpected snoop received.");
-  }
-
-  void handle_snp_read_once(DirContext& ctxt, DirCommandList& cl,
-                            const CohSnpRspMsg* msg) const {
-  }
-
-  void handle_snp_read_clean(DirContext& ctxt, DirCommandList& cl,
-                             const CohSnpRspMsg* msg) const {
-  }
-
-  void handle_snp_read_not_shared_dirty(DirContext& ctxt, DirCommandList& cl,
-                                        const CohSnpRspMsg* msg) const {
-  }
-
-  void handle_snp_read_shared(DirContext& ctxt, DirCommandList& cl,
-                              const CohSnpRspMsg* msg) const {
-    DirTState* tstate = ctxt.tstate();
-    
-    LineState* line = static_cast<LineState*>(tstate->line());
+  // Lookup and apply transition for 'event' in the line's current
+  // state. Events for which no transition is defined raise an error.
+  void dispatch(DirContext& ctxt, DirCommandList& cl, Event event) const {
+    LineState* line = static_cast<LineState*>(ctxt.tstate()->line());
+    TransitionArgs args{ctxt, cl, line};
     const State state = line->state();
-    switch (state) {
-      case State::M_O:
-      case State::O_O:
-      case State::E_O: {
-        if (!msg->is()) {
-          // Responding agent is no longer Sharing line. Line
-          // has been removed from its cache.
-          cl.push_back(line->build_del_sharer(msg->origin()));
-        }
+    const DirTransition* t = dir_table.lookup(state, event, args);
+    if (t == nullptr) {
+      std::string reason = "Invalid state transition; event: ";
+      reason += to_string(event);
+      reason += " in state: ";
+      reason += to_string(state);
+      cl.raise_error(reason);
+      return;
+    }
 
-        // Wait until final concensus can be reached.
-        if (!tstate->is_final_snoop(true)) return;
-
-        // Compute next state
-        State next_state = State::X;
-        if      (!ctxt.is() && !ctxt.pd()) { next_state = State::E; }
-        else if (!ctxt.is() &&  ctxt.pd()) { next_state = State::M; }
-        else if ( ctxt.is() && !ctxt.pd()) { next_state = State::S; }
-        else                               { next_state = State::O; }
-        
-        if (ctxt.dt()) {
-          // Data has been transfered; the originator is now in
-          // receipt of some number of lines. Now compute the final
-          // coherence result and issue final response.
-
-          CohEndMsg* end = Pool<CohEndMsg>::construct();
-          end->set_t(msg->t());
-          end->set_origin(ctxt.dir());
-          end->set_is(ctxt.is());
-          end->set_pd(ctxt.pd());
-          end->set_dt_n(ctxt.dt_n());
-
-          switch (next_state) {
-            case State::E: {
-              // Requesting agent becomes owner.
-              cl.push_back(line->build_set_owner(tstate->origin()));
-            } break;
-            case State::M: {
-              // Requesting agent becomes owner.
-              cl.push_back(line->build_set_owner(tstate->origin()));
-            } break;
-            case State::S: {
-              // Requester becomes Sharer.
-              cl.push_back(line->build_add_sharer(tstate->origin()));
-            } break;
-            case State::O: {
-              // Requester becomes Owner; responder retains Shared.
-              cl.push_back(line->build_set_owner(tstate->origin()));
-            }
-            default: {
-            } break;
-          }
-          // Issue response to originator.
-          issue_msg_to_noc(ctxt, cl, end, tstate->origin());
-          // Transaction ends
-          cl.push_back(DirOpcode::EndTransaction);
-        } else {
-          // No data transfer, therefore DIR must issue fill to
-          // LLC.
-          LLCCmdMsg* cmd = Pool<LLCCmdMsg>::construct();
-          cmd->set_t(msg->t());
-          cmd->set_opcode(LLCCmdOpcode::PutLine);
-          cmd->set_addr(tstate->addr());
-          cmd->set_agent(tstate->origin());
-          // Issue LLC request; now awaiting LLC response before
-          // final coherence result can be issued to originator.
-          issue_msg_to_noc(ctxt, cl, cmd, ctxt.dir()->llc());
-          // Now awaiting an LLC response, set flag
-          cl.push_back(tstate->build_set_llc_cmd_opcode(cmd->opcode()));
-        }
-        // Update state
-        cl.push_back(line->build_update_state(next_state));
-      } break;
-      default: {
-        cl.raise_error("Invalid state transition.");
-      } break;
+    if (t->next != state) {
+      cl.push_back(line->build_update_state(t->next));
     }
+    t->invoke(args);
   }
 
-  // cmd:ReadUnique -> snp:ReadUnique
+  // Null Filter
   //
-  void handle_snp_read_unique(DirContext& ctxt, DirCommandList& cl,
-                              const CohSnpRspMsg* msg) const {
+  // The directory retains no line state beyond the lifetime of a
+  // transaction. Coherent commands are broadcast as snoops to all
+  // other cache controllers; where no agent forwards the line, it is
+  // sourced directly from the home memory controller. Writebacks are
+  // issued to the memory controller before the transaction completes.
+  //
+  void handle_nf_cmd(DirContext& ctxt, DirCommandList& cl,
+                     const CohCmdMsg* msg) const {
     DirTState* tstate = ctxt.tstate();
+    switch (msg->opcode()) {
+      case AceCmdOpcode::ReadShared:
+      case AceCmdOpcode::ReadUnique:
+      case AceCmdOpcode::CleanUnique: {
+        // Broadcast snoop to all agents, except the originator.
+        const SharerDomain* d = sharer_domain();
+        std::size_t snoop_n = 0;
+        for (std::size_t i = 0; i < d->agents_n(); i++) {
+          Agent* agent = d->agent(i);
+          if (agent == msg->origin()) continue;
 
-    LineState* line = static_cast<LineState*>(tstate->line());
-    const State state = line->state();
-    switch (state) {
-      case State::S_ME:
-      case State::O_ME:
-      case State::M_ME:
-      case State::E_E: {
-        // ASSERT(msg->is() == false)
-        // Remove responding agent from sharer set.
-        cl.push_back(line->build_del_sharer(msg->origin()));
-
-        // Wait until final concensus can be reached.
-        if (!tstate->is_final_snoop(true)) return;
-
-        const State next_state = ctxt.pd() ? State::M : State::E;
-        if (ctxt.dt()) {
-          CohEndMsg* end = Pool<CohEndMsg>::construct();
-          end->set_t(msg->t());
-          end->set_origin(ctxt.dir());
-          end->set_is(false);
-          end->set_dt_n(ctxt.dt_n());
-          end->set_pd(next_state == State::O);
-
-          // Requesting agent becomes owner.
-          cl.push_back(line->build_set_owner(tstate->origin()));
-
-          // Issue completed response to the requester.
-          issue_msg_to_noc(ctxt, cl, end, tstate->origin());
-
-          // Transaction ends at this point, as the final state of
-          // the line is now known. The requesters cache controller
-          // now awaits 1 DT either from responding agent or the
-          // LLC.
-          cl.push_back(DirOpcode::EndTransaction);
+          CohSnpMsg* snp = Pool<CohSnpMsg>::construct();
+          snp->set_t(msg->t());
+          snp->set_addr(msg->addr());
+          snp->set_origin(ctxt.dir());
+          snp->set_agent(msg->origin());
+          snp->set_opcode(to_snp_opcode(msg->opcode()));
+          issue_msg_to_noc(ctxt, cl, snp, agent);
+          ++snoop_n;
+        }
+        if (snoop_n == 0) {
+          // No other agents; consensus is immediately reached.
+          handle_nf_consensus(ctxt, cl, msg->t());
         } else {
-          // Data was not transfers to the requesting agent. In this
-          // case, the owning agent must have explicitly written back
-          // back its line before forming the snoop response. Ideally,
-          // the responding agent would have relinquished the line
-          // before responding, but the ACE specification does not
-          // require this behavior.
-
-          // Instruct the LLC to forward the cache line to the
-          // requesting agent.
-          LLCCmdMsg* llc = Pool<LLCCmdMsg>::construct();
-          llc->set_t(msg->t());
-          llc->set_opcode(LLCCmdOpcode::PutLine);
-          llc->set_addr(tstate->addr());
-          llc->set_agent(tstate->origin());
-          issue_msg_to_noc(ctxt, cl, llc, ctxt.dir()->llc());
-
-          // Set flag indicating that we are now awaiting a LLC
-          // response.
-          cl.push_back(tstate->build_set_llc_cmd_opcode(llc->opcode()));
+          // Set expected snoop response count in transaction state
+          // object.
+          cl.push_back(tstate->build_set_snoop_n(snoop_n));
         }
-        cl.push_back(line->build_update_state(next_state));
       } break;
-      default: {
-        cl.raise_error("Invalid state transition.");
+      case AceCmdOpcode::WriteBack:
+      case AceCmdOpcode::WriteClean: {
+        // Write line back to memory; transaction completes upon the
+        // memory response.
+        MemCmdMsg* cmd = Pool<MemCmdMsg>::construct();
+        cmd->set_t(msg->t());
+        cmd->set_origin(ctxt.dir());
+        cmd->set_opcode(MemCmdOpcode::Write);
+        cmd->set_dest(ctxt.dir());
+        cmd->set_addr(msg->addr());
+        issue_msg_to_noc(ctxt, cl, cmd, ctxt.dir()->mc(msg->addr()));
       } break;
-    }
-  }
-
-  // Cmd: CleanUnique -> Snp: CleanInvalid
-  void handle_snp_clean_unique(DirContext& ctxt, DirCommandList& cl,
-                               const CohSnpRspMsg* msg) const {
-    DirTState* tstate = ctxt.tstate();
-
-    LineState* line = static_cast<LineState*>(tstate->line());
-    const State state = line->state();
-    switch (state) {
-      case State::S_E:
-      case State::E_E:
-      case State::M_EO: {
-        // ASSERT(msg->is() == false)
-        // Line has been removed from cache; remove from sharers
-        cl.push_back(line->build_del_sharer(msg->origin()));
-
-        // Wait until final concensus can be reached.
-        if (!tstate->is_final_snoop(true)) return;
-
-        // Final response, therefore send completed coherence
-        // response back to requester to terminate the
-        // transaction.
-        CohEndMsg* end = Pool<CohEndMsg>::construct();
-        end->set_t(msg->t());
-        end->set_origin(ctxt.dir());
-        // "Clean" instruction, therefore as no data is transferred
-        // these fields are cleared as per. C4.6.1
-        end->set_is(false);
-        end->set_pd(false);
-        issue_msg_to_noc(ctxt, cl, end, tstate->origin());
-
-        // Transaction is complete once overall transaction
-        // response has been computed.
-        cl.push_back(DirOpcode::EndTransaction);
+      case AceCmdOpcode::Evict: {
+        // Line is clean; nothing to be done.
+        issue_nf_end(ctxt, cl, msg->t(), 0, false, false);
       } break;
       default: {
-        cl.raise_error("Invalid state transition.");
+        // Unknown opcode; raise error.
+        std::string reason = "Unsupported opcode received by Null Filter: ";
+        reason += to_string(msg->opcode());
+        cl.raise_error(reason);
+        return;
       } break;
     }
+    // Consume and advance
+    cl.next_and_do_consume(true);
   }
 
-  void handle_snp_clean_shared(DirContext& ctxt, DirCommandList& cl,
-                               const CohSnpRspMsg* msg) const {
+  void handle_nf_snp(DirContext& ctxt, DirCommandList& cl,
+                     const CohSnpRspMsg* msg) const {
     DirTState* tstate = ctxt.tstate();
-    LineState* line = static_cast<LineState*>(tstate->line());
-    const State state = line->state();
-    switch (state) {
-      case State::S_SE:
-      case State::E_SE:
-      case State::M_SE:
-      case State::O_SE: {
-
-        if (!msg->is()) {
-          // Responding agent is no longer Sharing line. Line
-          // has been removed from its cache.
-          cl.push_back(line->build_del_sharer(msg->origin()));
-        }
+    // Account for response and wait until final concensus can be
+    // reached.
+    cl.push_back(tstate->build_inc_snoop_i());
+    if (!tstate->is_final_snoop(true)) return;
 
-        // Wait until final concensus can be reached.
-        if (!tstate->is_final_snoop(true)) return;
-        
-        // Final snoop response received; issue final coherence
-        // concensus.
-        CohEndMsg* end = Pool<CohEndMsg>::construct();
-        end->set_t(msg->t());
-        end->set_origin(ctxt.dir());
-        end->set_pd(false);
-        end->set_is(ctxt.is());
-        issue_msg_to_noc(ctxt, cl, end, tstate->origin());
-        // On completion, line is clean.
-        const State next_state = ctxt.is() ? State::S : State::E;
-        cl.push_back(line->build_update_state(next_state));
-        // Transaction is complete
-        cl.push_back(DirOpcode::EndTransaction);
-      } break;
-      default: {
-        cl.raise_error("Invalid state transition.");
-      } break;
-    }
+    handle_nf_consensus(ctxt, cl, msg->t());
   }
 
-  void handle_snp_clean_invalid(DirContext& ctxt, DirCommandList& cl,
-                                const CohSnpRspMsg* msg) const {
+  // All snoop responses have been received (counts in 'ctxt').
+  void handle_nf_consensus(DirContext& ctxt, DirCommandList& cl,
+                           Transaction* t) const {
     DirTState* tstate = ctxt.tstate();
-
-    LineState* line = static_cast<LineState*>(tstate->line());
-    const State state = line->state();
-    switch (state) {
-      case State::S_I:
-      case State::E_I:
-      case State::M_I:
-      case State::O_I: {
-        // Remove agent from sharer set; line is always invalid
-        // in responding agents cache after CleanInvalid
-        cl.push_back(line->build_del_sharer(msg->origin()));
-
-        // Wait until final concensus can be reached.
-        if (!tstate->is_final_snoop(true)) return;
-
-        // Final snoop response received; issue final coherence
-        // concensus.
-        CohEndMsg* end = Pool<CohEndMsg>::construct();
-        end->set_t(msg->t());
-        end->set_origin(ctxt.dir());
-        // "the {IsShared/PassDirty} response must be deasserted"
-        end->set_pd(false);
-        end->set_is(false);
-        issue_msg_to_noc(ctxt, cl, end, tstate->origin());
-        // Update final line state
-        cl.push_back(line->build_update_state(State::I));
-        // Delete line
-        cl.push_back(DirOpcode::RemoveLine);
-        // Transaction is complete
-        cl.push_back(DirOpcode::EndTransaction);
-      } break;
-      default: {
-        cl.raise_error("Invalid state transition.");
-      } break;
+    if (ctxt.dt() || (tstate->opcode() == AceCmdOpcode::CleanUnique)) {
+      // Line has been forwarded by some agent, or no data is required.
+      issue_nf_end(ctxt, cl, t, ctxt.dt_n(), ctxt.is(), ctxt.pd());
+    } else {
+      // Line is not present in any agent; source from memory. Data is
+      // transferred directly to the originator.
+      MemCmdMsg* cmd = Pool<MemCmdMsg>::construct();
+      cmd->set_t(t);
+      cmd->set_origin(ctxt.dir());
+      cmd->set_opcode(MemCmdOpcode::Read);
+      cmd->set_dest(tstate->origin());
+      cmd->set_addr(tstate->addr());
+      issue_msg_to_noc(ctxt, cl, cmd, ctxt.dir()->mc(tstate->addr()));
     }
   }
 
-  void handle_snp_make_unique(DirContext& ctxt, DirCommandList& cl,
-                              const CohSnpRspMsg* msg) const {
+  void apply(DirContext& ctxt, DirCommandList& cl, const MemRspMsg* msg) const {
     DirTState* tstate = ctxt.tstate();
-
-    LineState* line = static_cast<LineState*>(tstate->line());
-    const State state = line->state();
-    switch (state) {
-      case State::S_I:
-      case State::E_I:
-      case State::M_I:
-      case State::O_I: {
-
-        // Remove agent from sharer set.
-        cl.push_back(line->build_del_sharer(msg->origin()));
-
-        // Wait until final concensus can be reached.
-        if (!tstate->is_final_snoop(true)) return;
-
-        // Final snoop response received; issue final coherence
-        // concensus.
-        CohEndMsg* end = Pool<CohEndMsg>::construct();
-        end->set_t(msg->t());
-        end->set_origin(ctxt.dir());
-        end->set_pd(false);
-        end->set_is(false);
-        issue_msg_to_noc(ctxt, cl, end, tstate->origin());
-        // Update final line state; originator now has Exclusive
-        // access to the line and will, presumably, perform a full
-        // line write. From the perspective of the directory,
-        // Exclusive is synonymous with Modified.
-        cl.push_back(line->build_update_state(State::E));
-        // Originator is now the owner.
-        cl.push_back(line->build_set_owner(line->owner()));
-        // Delete line
-        cl.push_back(DirOpcode::RemoveLine);
-        // Transaction is complete
-        cl.push_back(DirOpcode::EndTransaction);
-      } break;
-      default: {
-        cl.raise_error("Invalid state transition.");
+    switch (msg->opcode()) {
+      case MemRspOpcode::ReadOkay: {
+        msg->t()->stamp(TransactionStage::Fill, ctxt.dir()->k()->time());
+        // Line has been sourced by memory; other agents may retain the
+        // line as shared.
+        issue_nf_end(ctxt, cl, msg->t(), 1, tstate->is_i() > 0, false);
       } break;
-    }
-  }
-
-  void handle_snp_make_invalid(DirContext& ctxt, DirCommandList& cl,
-                               const CohSnpRspMsg* msg) const {
-    DirTState* tstate = ctxt.tstate();
-    LineState* line = static_cast<LineState*>(tstate->line());
-    const State state = line->state();
-    switch (state) {
-      case State::S_I:
-      case State::E_I:
-      case State::M_I:
-      case State::O_I: {
-        // Remove agent from sharer set
-        cl.push_back(line->build_del_sharer(msg->origin()));
-
-        // Wait until final concensus can be reached.
-        if (!tstate->is_final_snoop(true)) return;
-
-        // Final snoop response received; issue final coherence
-        // concensus.
-        CohEndMsg* end = Pool<CohEndMsg>::construct();
-        end->set_t(msg->t());
-        end->set_origin(ctxt.dir());
-        end->set_pd(false);
-        end->set_is(false);
-        issue_msg_to_noc(ctxt, cl, end, tstate->origin());
-        // Update final line state
-        cl.push_back(line->build_update_state(State::I));
-        // Delete line
-        cl.push_back(DirOpcode::RemoveLine);
-        // Transaction is complete
-        cl.push_back(DirOpcode::EndTransaction);
+      case MemRspOpcode::WriteOkay: {
+        issue_nf_end(ctxt, cl, msg->t(), 0, false, false);
       } break;
       default: {
-        cl.raise_error("Invalid state transition.");
+        cl.raise_error("Unexpected memory response received.");
+        return;
       } break;
     }
+    // Consume and advance
+    cl.next_and_do_consume(true);
   }
 
-  void handle_snp_write_no_snoop(DirContext& ctxt, DirCommandList& cl,
-                                 const CohSnpRspMsg* msg) const {
-    // Command should not issue a Snoop therefore we so not expect
-    // a snoop response.
-    cl.raise_error("Snoop response raised for command which does "
-                   "not issue a snoop command");
-  }
-
-  void handle_snp_write_unique(DirContext& ctxt, DirCommandList& cl,
-                               const CohSnpRspMsg* msg) const {
-    // Command should not issue a Snoop therefore we so not expect
-    // a snoop response.
-    cl.raise_error("Snoop response raised for command which does "
-                   "not issue a snoop command");
-  }
-
-  void handle_snp_write_line_unique(DirContext& ctxt, DirCommandList& cl,
-                                    const CohSnpRspMsg* msg) const {
-    // Command should not issue a Snoop therefore we so not expect
-    // a snoop response.
-    cl.raise_error("Snoop response raised for command which does "
-                   "not issue a snoop command");
-  }
-
-  void handle_snp_write_back(DirContext& ctxt, DirCommandList& cl,
-                             const CohSnpRspMsg* msg) const {
-    // Command should not issue a Snoop therefore we so not expect
-    // a snoop response.
-    cl.raise_error("Snoop response raised for command which does "
-                   "not issue a snoop command");
-  }
-
-  void handle_snp_write_clean(DirContext& ctxt, DirCommandList& cl,
-                              const CohSnpRspMsg* msg) const {
-    // Command should not issue a Snoop therefore we so not expect
-    // a snoop response.
-    cl.raise_error("Snoop response raised for command which does "
-                   "not issue a snoop command");
-  }
-
-  void handle_snp_evict(DirContext& ctxt, DirCommandList& cl,
-                        const CohSnpRspMsg* msg) const {
-    // Command should not issue a Snoop therefore we so not expect
-    // a snoop response.
-    cl.raise_error("Snoop response raised for command which does "
-                   "not issue a snoop command");
-  }
-
-
-  void handle_snp_recall(DirContext& ctxt, DirCommandList& cl,
-                        const CohSnpRspMsg* msg) const {
+  // Issue final coherence response to originator and end transaction.
+  void issue_nf_end(DirContext& ctxt, DirCommandList& cl, Transaction* t,
+                    std::size_t dt_n, bool is, bool pd) const {
     DirTState* tstate = ctxt.tstate();
-    LineState* line = static_cast<LineState*>(tstate->line());
-    const State state = line->state();
-    switch (state) {
-      case State::S_I:
-      case State::M_I:
-      case State::E_I:
-      case State::O_I: {
-        Agent* origin = msg->origin();
-        if (origin == line->owner()) {
-          // Message originated from designated line owner, remove
-          cl.push_back(line->build_del_owner());
-        } else {
-          // Message originated from line sharer
-          cl.push_back(line->build_del_sharer(origin));
-        }
-
-        // Wait until final concensus can be reached.
-        if (!tstate->is_final_snoop(true)) return;
-
-        // Upon completion, no coherence response is emitted since the
-        // original operation was not initiated by an initial
-        // coherence command. Instead, we simply delete the line and
-        // end the transaction; which then causes the originate
-        // message to become unblocked.
-
-        // Line becomes invalid
-        cl.push_back(line->build_update_state(State::I));
-        // Delete line
-        cl.push_back(DirOpcode::RemoveLine);
-        // (Recall) Transaction is now complete
-        cl.push_back(DirOpcode::EndTransaction);
-      } break;
-      default: {
-      } break;
-    }
-  }
-
-  void issue_add_credit(DirContext& ctxt, DirCommandList& cl,
-                        MessageClass cls) const {
-    struct AddCreditAction : DirCoherenceAction {
-      AddCreditAction() = default;
-      std::string to_string() const override {
-        KVListRenderer r;
-        r.add_field("action", "add credit");
-        r.add_field("cc", cc_->path());
-        return r.to_string();
-      }
-      void set_cc(CreditCounter* cc) { cc_ = cc; }
-      // No resources required (should always make "forward progress")
-      bool execute() override {
-        cc_->credit();
-        return true;
-      }
-
-     private:
-      CreditCounter* cc_ = nullptr;
-    };
-    const Agent* origin = ctxt.msg()->origin();
-    if (CreditCounter* cc = ctxt.dir()->cc_by_cls_agent(cls, origin);
-        cc != nullptr) {
-      // Counter exists for this edge. Issue credit update aciton.
-      AddCreditAction* action = new AddCreditAction;
-      action->set_cc(cc);
-      cl.push_back(action);
-    }
-  }
-
-  void issue_msg_to_noc(DirContext& ctxt, DirCommandList& cl,
-                        const Message* msg, Agent* dest) const {
-    struct EmitMessageToNocAction : DirCoherenceAction {
-      EmitMessageToNocAction() = default;
-
-      std::string to_string() const override {
-        KVListRenderer r;
-        r.add_field("action", "emit message to noc");
-        r.add_field("mq", port_->ingress()->path());
-        r.add_field("msg", msg_->to_string());
-        return r.to_string();
-      }
-
-      void set_port(NocPort* port) { port_ = port; }
-      void set_msg(const NocMsg* msg) { msg_ = msg; }
-      void set_dir(const DirAgent* dir) { dir_ = dir; }
-
-      void set_resources(DirResources& r) const override {
-        // Always require a NOC credit.
-        r.set_noc_credit_n(r.noc_credit_n() + 1);
-
-        const Agent* dest = msg_->dest();
-        const Message* payload = msg_->payload();
-        switch (payload->cls()) {
-          case MessageClass::CohSnp: {
-            r.set_coh_snp_n(dest, r.coh_snp_n(dest) + 1);
-          } break;
-          default: {
-            // No resources required;
-            //
-            // DtRsp, CohSnpRsp are assumed to either have resources
-            // reserved upon issue of their originator commands (Dt,
-            // CohSnp), or are otherwise guarenteed to make forward
-            // progress.
-          } break;
-        }
-      }
-
-      bool execute() override {
-        // If a credit counter exists for at the destination for the current
-        // MessageClass, deduct one credit, otherwise ignore.
-        const Message* payload = msg_->payload();
-        // Lookup counter map for current message class.
-        if (CreditCounter* cc =
-                dir_->cc_by_cls_agent(payload->cls(), msg_->dest());
-            cc != nullptr) {
-          // Credit counter is present, therefore deduct a credit before
-          // message is issued.
-          cc->debit();
-        }
-        // Deduct NOC credit
-        CreditCounter* cc = port_->ingress_cc();
-        cc->debit();
-
-        // Issue message to queue.
-        MessageQueue* mq = port_->ingress();
-        return mq->issue(msg_);
-      }
-
-     private:
-      // Message to issue to NOC.
-      const NocMsg* msg_ = nullptr;
-      // Destination Message Queue
-      NocPort* port_ = nullptr;
-      // Cache controller model
-      const DirAgent* dir_ = nullptr;
-    };
-    // Encapsulate message in NOC transport protocol.
-    NocMsg* nocmsg = Pool<NocMsg>::construct();
-    nocmsg->set_t(msg->t());
-    nocmsg->set_payload(msg);
-    nocmsg->set_origin(ctxt.dir());
-    nocmsg->set_dest(dest);
-    // Issue Message Emit action.
-    EmitMessageToNocAction* action = new EmitMessageToNocAction;
-    action->set_port(ctxt.dir()->dir_noc__port());
-    action->set_msg(nocmsg);
-    action->set_dir(ctxt.dir());
-    cl.push_back(action);
+    CohEndMsg* end = Pool<CohEndMsg>::construct();
+    end->set_t(t);
+    end->set_origin(ctxt.dir());
+    end->set_dt_n(dt_n);
+    // Shared/PassDirty are meaningful solely for ReadShared;
+    // otherwise, the originator installs the line uniquely.
+    const bool is_shared = (tstate->opcode() == AceCmdOpcode::ReadShared);
+    end->set_is(is_shared && is);
+    end->set_pd(is_shared && pd);
+    issue_msg_to_noc(ctxt, cl, end, tstate->origin());
+    // Transaction ends.
+    cl.push_back(DirOpcode::EndTransaction);
   }
 };
 
@@ -2354,4 +1972,14 @@ DirProtocol* build_dir_protocol(kernel::Kernel* k) {
   return new MOESIDirProtocol(k);
 }
 
+//
+//
+DirAgent* build_dir_agent(kernel::Kernel* k, const DirAgentConfig& config) {
+  return new DirAgentT<MOESIDirProtocol>(k, config);
+}
+
+//
+//
+std::string render_dir_transitions() { return render_transitions(dir_table); }
+
 }  // namespace cc::moesi
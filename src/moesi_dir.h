@@ -28,10 +28,14 @@
 #ifndef CC_SRC_MOESI_DIR_H
 #define CC_SRC_MOESI_DIR_H
 
+#include <string>
+
 namespace cc {
 
 class DirProtocol;
 
+class DirAgent;
+struct DirAgentConfig;
 namespace kernel {
 class Kernel;
 }
@@ -40,6 +44,12 @@ namespace moesi {
 
 DirProtocol* build_dir_protocol(kernel::Kernel* k);
 
+DirAgent* build_dir_agent(kernel::Kernel* k, const DirAgentConfig& config);
+
+// Render the directory protocol transition table as a machine-readable
+// list of {state, event, guard, next} records.
+std::string render_dir_transitions();
+
 }  // namespace moesi
 
 }  // namespace cc
@@ -27,8 +27,11 @@
 
 #include "cc/kernel.h"
 #include "l1cache.h"
+#include "l1cache_process.h"
 #include "l2cache.h"
+#include "moesi_l1.h"
 #include "protocol.h"
+#include "transition.h"
 #include "utility.h"
 
 namespace {
@@ -144,8 +147,14 @@ class MOESIL1LineState : public L1LineState {
     }
   }
 
+  // Stable state to which the fill in flight has been demoted by the
+  // L2 (see set_line_shared_or_invalid), or X.
+  State demoted() const { return demoted_; }
+  void set_demoted(State demoted) { demoted_ = demoted; }
+
  private:
   State state_ = State::I;
+  State demoted_ = State::X;
 };
 
 enum class L1EgressQueue { L2CmdQ, CpuRspQ, Invalid };
@@ -163,9 +172,437 @@ const char* to_string(L1EgressQueue q) {
   }
 }
 
+
+// L1 protocol events.
+//
+enum class Event {
+  // CPU -> L1 Load command
+  CpuLoad,
+
+  // CPU -> L1 Store command
+  CpuStore,
+
+  // L2 -> L1 command response
+  L2CmdRsp,
+
+  // Line nominated for eviction
+  Evict,
+
+  // Invalid; placeholder
+  Invalid
+};
+
+//
+//
+const char* to_string(Event event) {
+  switch (event) {
+    case Event::CpuLoad:
+      return "CpuLoad";
+    case Event::CpuStore:
+      return "CpuStore";
+    case Event::L2CmdRsp:
+      return "L2CmdRsp";
+    case Event::Evict:
+      return "Evict";
+    case Event::Invalid:
+      [[fallthrough]];
+    default:
+      return "Invalid";
+  }
+}
+
+// Action to issue a message to one of the L1's egress queues. Actions
+// are constructed on every transition and are therefore recycled
+// through their Pool.
+//
+struct EmitMessageActionProxy : public L1CoherenceAction {
+  EmitMessageActionProxy() = default;
+
+  std::string to_string() const override {
+    KVListRenderer r;
+    r.add_field("action", "emit message");
+    r.add_field("mq", mq_->path());
+    r.add_field("msg", msg_->to_string());
+    return r.to_string();
+  }
+
+  void set_eq(L1EgressQueue eq) { eq_ = eq; }
+  void set_mq(MessageQueue* mq) { mq_ = mq; }
+  void set_msg(const Message* msg) { msg_ = msg; }
+
+  void set_resources(L1Resources& r) const override {
+    switch (eq_) {
+      case L1EgressQueue::L2CmdQ: {
+        r.set_l2_cmd_n(1 + r.l2_cmd_n());
+      } break;
+      case L1EgressQueue::CpuRspQ: {
+        r.set_cpu_rsp_n(1 + r.cpu_rsp_n());
+      } break;
+      default: {
+        // No cost
+      } break;
+    }
+  }
+
+  //
+  bool execute() override { return mq_->issue(msg_); }
+
+ private:
+  //
+  L1EgressQueue eq_ = L1EgressQueue::Invalid;
+  //
+  MessageQueue* mq_ = nullptr;
+  //
+  const Message* msg_ = nullptr;
+};
+
+// Action to update the state of a line.
+//
+struct UpdateStateAction : public L1CoherenceAction {
+  UpdateStateAction() = default;
+
+  std::string to_string() const override {
+    using cc::to_string;
+
+    KVListRenderer r;
+    r.add_field("action", "update state");
+    r.add_field("current", to_string(line_->state()));
+    r.add_field("next", to_string(state_));
+    return r.to_string();
+  }
+
+  void set_line(MOESIL1LineState* line) { line_ = line; }
+  void set_state(State state) { state_ = state; }
+
+  void set_resources(L1Resources& r) const override {
+    // No resources required for state update.
+  }
+
+  bool execute() override {
+    line_->set_state(state_);
+    // Demotion applies only to the fill in flight.
+    if (line_->is_stable()) line_->set_demoted(State::X);
+    return true;
+  }
+
+ private:
+  MOESIL1LineState* line_ = nullptr;
+  State state_ = State::X;
+};
+
+// Action to record the L2's demotion of a fill in flight.
+//
+struct DemoteFillAction : public L1CoherenceAction {
+  DemoteFillAction() = default;
+
+  std::string to_string() const override {
+    using cc::to_string;
+
+    KVListRenderer r;
+    r.add_field("action", "demote fill");
+    r.add_field("current", to_string(line_->state()));
+    r.add_field("demoted", to_string(demoted_));
+    return r.to_string();
+  }
+
+  void set_line(MOESIL1LineState* line) { line_ = line; }
+  void set_demoted(State demoted) { demoted_ = demoted; }
+
+  void set_resources(L1Resources& r) const override {
+    // No resources required for state update.
+  }
+
+  bool execute() override {
+    line_->set_demoted(demoted_);
+    return true;
+  }
+
+ private:
+  MOESIL1LineState* line_ = nullptr;
+  State demoted_ = State::X;
+};
+
+void issue_msg_to_queue(L1EgressQueue eq, L1CommandList& cl,
+                        L1CacheContext& ctxt, const Message* msg) {
+  EmitMessageActionProxy* action = Pool<EmitMessageActionProxy>::construct();
+  action->set_eq(eq);
+  action->set_msg(msg);
+  switch (eq) {
+    case L1EgressQueue::L2CmdQ: {
+      action->set_mq(ctxt.l1cache()->l1_l2__cmd_q());
+    } break;
+    case L1EgressQueue::CpuRspQ: {
+      action->set_mq(ctxt.l1cache()->l1_cpu__rsp_q());
+    } break;
+    default: {
+    } break;
+  }
+  cl.push_back(action);
+}
+
+void issue_update_state(L1CommandList& cl, MOESIL1LineState* line,
+                        State state) {
+  UpdateStateAction* action = Pool<UpdateStateAction>::construct();
+  action->set_line(line);
+  action->set_state(state);
+  cl.push_back(action);
+}
+
+void issue_demote_fill(L1CommandList& cl, MOESIL1LineState* line,
+                       State demoted) {
+  DemoteFillAction* action = Pool<DemoteFillAction>::construct();
+  action->set_line(line);
+  action->set_demoted(demoted);
+  cl.push_back(action);
+}
+
+// Arguments passed to each transition guard and action.
+//
+struct TransitionArgs {
+  // Current L1 context
+  L1CacheContext& ctxt;
+
+  // Command list under construction
+  L1CommandList& cl;
+
+  // Line of interest
+  MOESIL1LineState* line;
+};
+
+// Transition guards:
+
+// L2 has retained the line in a shared state.
+bool is_shared(const TransitionArgs& a) {
+  return static_cast<const L2CmdRspMsg*>(a.ctxt.msg())->is() ||
+         (a.line->demoted() == State::S);
+}
+
+// L2 has invalidated the line whilst its fill was in flight.
+bool is_invalidated(const TransitionArgs& a) {
+  return (a.line->demoted() == State::I);
+}
+
+// Transition actions:
+
+// Issue command to the owning L2.
+template <L2CmdOpcode Opcode>
+struct IssueL2Cmd {
+  void operator()(TransitionArgs& a) const {
+    L2CmdMsg* cmd = Pool<L2CmdMsg>::construct();
+    cmd->set_t(a.ctxt.msg()->t());
+    cmd->set_addr(a.ctxt.tstate()->addr());
+    cmd->set_opcode(Opcode);
+    cmd->set_l1cache(a.ctxt.l1cache());
+    issue_msg_to_queue(L1EgressQueue::L2CmdQ, a.cl, a.ctxt, cmd);
+  }
+};
+
+// Issue command response to CPU; the command commits.
+struct IssueCpuRsp {
+  void operator()(TransitionArgs& a) const {
+    L1CmdRspMsg* rsp = Pool<L1CmdRspMsg>::construct();
+    rsp->set_t(a.ctxt.msg()->t());
+    issue_msg_to_queue(L1EgressQueue::CpuRspQ, a.cl, a.ctxt, rsp);
+  }
+};
+
+// Raise cache event at the current transaction address.
+template <L1CacheEvent E>
+struct RaiseEvent {
+  void operator()(TransitionArgs& a) const {
+    a.cl.push_back(
+        L1CommandBuilder::build_cache_event(E, a.ctxt.tstate()->addr()));
+  }
+};
+
+// In the non-blocking cache, the transaction state takes ownership of
+// the message at the head of the command queue as this is
+// subsequently dequeued to prevent head-of-line blocking.
+struct SetReplay {
+  void operator()(TransitionArgs& a) const {
+    if (!a.ctxt.l1cache()->config().is_blocking_cache) {
+      L1TState* tstate = a.ctxt.tstate();
+      tstate->set_do_replay(true);
+      tstate->set_msg(a.ctxt.msg());
+    }
+  }
+};
+
+// Install new entry in the transaction table.
+struct StartTransaction {
+  void operator()(TransitionArgs& a) const {
+    const L1CacheAgentConfig& config = a.ctxt.l1cache()->config();
+    a.cl.transaction_start(a.ctxt.msg()->t(), config.is_blocking_cache);
+  }
+};
+
+// Complete transaction; wake all blocked Message Queues and delete
+// context.
+struct EndTransaction {
+  void operator()(TransitionArgs& a) const {
+    a.cl.transaction_end(a.ctxt.msg()->t());
+  }
+};
+
+// Remove line from the cache.
+struct RemoveLine {
+  void operator()(TransitionArgs& a) const {
+    const addr_t addr = a.ctxt.tstate()->addr();
+    a.cl.push_back(L1CommandBuilder::build_remove_line(addr));
+  }
+};
+
+// Write through to L2 such that L2 sees the transition to M
+// immediately.
+struct SetL2LineModified {
+  void operator()(TransitionArgs& a) const {
+    a.cl.push_back(L1Opcode::SetL2LineModified);
+  }
+};
+
+// Consume message and advance to next.
+struct Consume {
+  void operator()(TransitionArgs& a) const { a.cl.next_and_do_consume(true); }
+};
+
+using L1Transition = Transition<State, Event, TransitionArgs>;
+
+template <typename ActionT>
+constexpr L1Transition::action_type act =
+    &invoke_action<ActionT, TransitionArgs>;
+
+// MOESI L1 transition table:
+//
+//  {state, event, guard, guard name, {actions...}, next state}
+//
+// The state update to 'next' is emitted ahead of the transition
+// actions whenever the state changes.
+//
+constexpr std::array<L1Transition, 22> l1_transitions{{
+    // Miss; request line from L2.
+    {State::I, Event::CpuLoad, nullptr, nullptr,
+     {act<RaiseEvent<L1CacheEvent::LoadMiss>>,
+      act<IssueL2Cmd<L2CmdOpcode::L1GetS>>, act<SetReplay>,
+      act<StartTransaction>},
+     State::IS},
+    {State::I, Event::CpuStore, nullptr, nullptr,
+     {act<RaiseEvent<L1CacheEvent::StoreMiss>>,
+      act<IssueL2Cmd<L2CmdOpcode::L1GetE>>, act<SetReplay>,
+      act<StartTransaction>},
+     State::IE},
+
+    // LD to line in S-state can complete immediately. ST must first
+    // promote the line to the E-state before it can complete.
+    {State::S, Event::CpuLoad, nullptr, nullptr,
+     {act<IssueCpuRsp>, act<RaiseEvent<L1CacheEvent::LoadHit>>,
+      act<Consume>},
+     State::S},
+    {State::S, Event::CpuStore, nullptr, nullptr,
+     {act<IssueL2Cmd<L2CmdOpcode::L1GetE>>, act<StartTransaction>,
+      act<RaiseEvent<L1CacheEvent::StoreMiss>>},
+     State::SE},
+
+    // LD/ST to line in the E-state complete immediately, but ST
+    // promotes the line to the M-state.
+    {State::E, Event::CpuLoad, nullptr, nullptr,
+     {act<IssueCpuRsp>, act<RaiseEvent<L1CacheEvent::LoadHit>>,
+      act<Consume>},
+     State::E},
+    {State::E, Event::CpuStore, nullptr, nullptr,
+     {act<IssueCpuRsp>, act<SetL2LineModified>,
+      act<RaiseEvent<L1CacheEvent::StoreHit>>, act<Consume>},
+     State::M},
+
+    // LD/ST to line in the M-state commit immediately.
+    {State::M, Event::CpuLoad, nullptr, nullptr,
+     {act<IssueCpuRsp>, act<RaiseEvent<L1CacheEvent::LoadHit>>,
+      act<Consume>},
+     State::M},
+    {State::M, Event::CpuStore, nullptr, nullptr,
+     {act<IssueCpuRsp>, act<RaiseEvent<L1CacheEvent::StoreHit>>,
+      act<Consume>},
+     State::M},
+
+    // Fill completes; install line. The L2 may have demoted the line
+    // whilst the fill was in flight, in which case the fill completes
+    // in the demoted state; an invalidated fill is installed and
+    // immediately removed, and the command replays as a miss.
+    {State::IS, Event::L2CmdRsp, &is_invalidated, "is_invalidated",
+     {act<RaiseEvent<L1CacheEvent::InstallShareable>>, act<RemoveLine>,
+      act<EndTransaction>, act<Consume>},
+     State::I},
+    {State::IS, Event::L2CmdRsp, &is_shared, "is_shared",
+     {act<RaiseEvent<L1CacheEvent::InstallShareable>>, act<EndTransaction>,
+      act<Consume>},
+     State::S},
+    {State::IS, Event::L2CmdRsp, nullptr, nullptr,
+     {act<RaiseEvent<L1CacheEvent::InstallWriteable>>, act<EndTransaction>,
+      act<Consume>},
+     State::E},
+    {State::IE, Event::L2CmdRsp, &is_invalidated, "is_invalidated",
+     {act<RaiseEvent<L1CacheEvent::InstallShareable>>, act<RemoveLine>,
+      act<EndTransaction>, act<Consume>},
+     State::I},
+    {State::IE, Event::L2CmdRsp, &is_shared, "is_shared",
+     {act<RaiseEvent<L1CacheEvent::InstallShareable>>, act<EndTransaction>,
+      act<Consume>},
+     State::S},
+    {State::IE, Event::L2CmdRsp, nullptr, nullptr,
+     {act<RaiseEvent<L1CacheEvent::InstallWriteable>>, act<EndTransaction>,
+      act<Consume>},
+     State::E},
+    {State::SE, Event::L2CmdRsp, &is_shared, "is_shared",
+     {act<EndTransaction>, act<Consume>},
+     State::S},
+    {State::SE, Event::L2CmdRsp, nullptr, nullptr,
+     {act<RaiseEvent<L1CacheEvent::InstallWriteable>>, act<EndTransaction>,
+      act<Consume>},
+     State::E},
+
+    // Shared/Modifed/Exclusive -> Invalid
+    //
+    // Edge entered upon an eviction from L1 cache. As L1 is
+    // write-through to L2, L2 maintains a recent up to date copy of
+    // the line and this transaction therefore serves as notification
+    // that the line has been evicted from L1. In the case of SI, L1
+    // may optionally silently evict the line without L2 notification,
+    // in which the message is never sent.
+    {State::SI, Event::L2CmdRsp, nullptr, nullptr,
+     {act<RemoveLine>, act<EndTransaction>,
+      act<RaiseEvent<L1CacheEvent::InvalidateLine>>, act<Consume>},
+     State::I},
+    {State::EI, Event::L2CmdRsp, nullptr, nullptr,
+     {act<RemoveLine>, act<EndTransaction>,
+      act<RaiseEvent<L1CacheEvent::InvalidateLine>>, act<Consume>},
+     State::I},
+    {State::MI, Event::L2CmdRsp, nullptr, nullptr,
+     {act<RemoveLine>, act<EndTransaction>,
+      act<RaiseEvent<L1CacheEvent::InvalidateLine>>, act<Consume>},
+     State::I},
+
+    // Evict line present in the Exclusive or Modified state. L2
+    // already has the most recent upto date copy of the line,
+    // therefore no data needs to be written-back, however L2 is
+    // informed such that it may (conditionally) inform the home
+    // directory that the line is no longer present in the cache (when
+    // silent evictions are not allowed). The transaction starts as the
+    // response from L2 must be awaited before the line is removed.
+    {State::E, Event::Evict, nullptr, nullptr,
+     {act<IssueL2Cmd<L2CmdOpcode::L1Put>>, act<StartTransaction>},
+     State::EI},
+    {State::M, Event::Evict, nullptr, nullptr,
+     {act<IssueL2Cmd<L2CmdOpcode::L1Put>>, act<StartTransaction>},
+     State::MI},
+}};
+
+constexpr TransitionTable<L1Transition, l1_transitions.size(),
+                          static_cast<std::size_t>(State::X) + 1,
+                          static_cast<std::size_t>(Event::Invalid)>
+    l1_table{l1_transitions};
+
 //
 //
-class MOESIL1CacheProtocol : public L1CacheAgentProtocol {
+class MOESIL1CacheProtocol final : public L1CacheAgentProtocol {
   using cb = L1CommandBuilder;
 
  public:
@@ -187,10 +624,28 @@ class MOESIL1CacheProtocol : public L1CacheAgentProtocol {
     switch (cls) {
       case MessageClass::L1Cmd: {
         // CPU -> L1 command:
-        apply(ctxt, cl, line, static_cast<const L1CmdMsg*>(ctxt.msg()));
+        const L1CmdMsg* msg = static_cast<const L1CmdMsg*>(ctxt.msg());
+        // Update Transaction State with data snooped from command
+        // message.
+        L1TState* tstate = ctxt.tstate();
+        tstate->set_line(ctxt.line());
+        tstate->set_addr(msg->addr());
+        tstate->set_opcode(msg->opcode());
+
+        switch (msg->opcode()) {
+          case L1CmdOpcode::CpuLoad: {
+            dispatch(ctxt, cl, line, Event::CpuLoad);
+          } break;
+          case L1CmdOpcode::CpuStore: {
+            dispatch(ctxt, cl, line, Event::CpuStore);
+          } break;
+          default: {
+            // Invalid command.
+          } break;
+        }
       } break;
       case MessageClass::L2CmdRsp: {
-        apply(ctxt, cl, line, static_cast<const L2CmdRspMsg*>(ctxt.msg()));
+        dispatch(ctxt, cl, line, Event::L2CmdRsp);
       } break;
       default: {
         // Unknown message class; error
@@ -201,9 +656,6 @@ class MOESIL1CacheProtocol : public L1CacheAgentProtocol {
   //
   //
   void evict(L1CacheContext& ctxt, L1CommandList& cl) const override {
-    // Current invoke L1 cache instance configuration.
-    const L1CacheAgentConfig& config = ctxt.l1cache()->config();
-
     // Update Transaction State with data snooped from command message.
     L1TState* tstate = ctxt.tstate();
     // Address becomes eviction address
@@ -212,46 +664,40 @@ class MOESIL1CacheProtocol : public L1CacheAgentProtocol {
     tstate->set_line(ctxt.line());
 
     MOESIL1LineState* line = static_cast<MOESIL1LineState*>(ctxt.line());
-    const State state = line->state();
-    switch (state) {
-      case State::M:
-        // As in the Exclusive state, L2 already has the most recent
-        // upto date copy of the line therefore we just need to inform
-        // L2 that the line is being removed from the cache, and it
-        // will itself perform the writeback.
-      case State::E: {
-        // Evict line present in the Exclusive state. L2 should
-        // already have a recent upto date copy of the cache line,
-        // therefore no actual data needs to be written-back, however
-        // we inform L2 so that it may (conditionally) inform the home
-        // directory that the line is no longer present in the cache
-        // (when silent evictions are not allowed).
-
-        // Issue command notification to L2.
-        Transaction* t = ctxt.msg()->t();
-        L2CmdMsg* cmd = Pool<L2CmdMsg>::construct();
-        cmd->set_t(t);
-        cmd->set_addr(ctxt.addr());
-        cmd->set_opcode(L2CmdOpcode::L1Put);
-        cmd->set_l1cache(ctxt.l1cache());
-        issue_msg_to_queue(L1EgressQueue::L2CmdQ, cl, ctxt, cmd);
-        // Line transition to Invalid state.
-        const State next_state = (state == State::M) ? State::MI : State::EI;
-        issue_update_state(cl, line, next_state);
-        // Start new transaction as we are awaiting the response from
-        // L2 before the line is evicted from the cache.
-        cl.transaction_start(t, config.is_blocking_cache);
-      } break;
-      default: {
-      } break;
-    }
+    dispatch(ctxt, cl, line, Event::Evict);
   }
 
   //
   //
   void set_line_shared_or_invalid(L1CacheContext& ctxt, L1CommandList& cl,
-                                  bool shared) const override {
+                                  bool shared, bool is_owner) const override {
     MOESIL1LineState* line = static_cast<MOESIL1LineState*>(ctxt.line());
+    if (!line->is_stable()) {
+      // Transaction in flight to the line is ordered after the L2's
+      // update; the line is retained until the transaction completes
+      // (an invalidated upgrade completes as a fill). Where the L2 has
+      // already responded (the L1 holds the line in the L2 whilst its
+      // fill is in flight), the fill is demoted.
+      switch (line->state()) {
+        case State::SE: {
+          if (!shared) {
+            issue_update_state(cl, line, State::IE);
+            cl.push_back(cb::build_cache_event(
+                L1CacheEvent::InvalidateInFlight, ctxt.addr()));
+          }
+          if (is_owner) {
+            issue_demote_fill(cl, line, shared ? State::S : State::I);
+          }
+        } break;
+        case State::IS:
+        case State::IE: {
+          issue_demote_fill(cl, line, shared ? State::S : State::I);
+        } break;
+        default: {
+        } break;
+      }
+      return;
+    }
     issue_update_state(cl, line, shared ? State::S : State::I);
     if (!shared) {
       cl.push_back(cb::build_remove_line(ctxt.addr()));
@@ -259,331 +705,19 @@ class MOESIL1CacheProtocol : public L1CacheAgentProtocol {
   }
 
  private:
-  void apply(L1CacheContext& ctxt, L1CommandList& cl, MOESIL1LineState* line,
-             const L1CmdMsg* msg) const {
-    // Current invoke L1 cache instance.
-    const L1CacheAgentConfig& config = ctxt.l1cache()->config();
-
-    // Update Transaction State with data snooped from command message.
-    L1TState* tstate = ctxt.tstate();
-    tstate->set_line(ctxt.line());
-    tstate->set_addr(msg->addr());
-    tstate->set_opcode(msg->opcode());
-
-    const State state = line->state();
-    switch (state) {
-      case State::I: {
-        // Emit request to L2.
-        L2CmdMsg* l2cmdmsg = Pool<L2CmdMsg>::construct();
-        l2cmdmsg->set_t(msg->t());
-        l2cmdmsg->set_addr(msg->addr());
-        switch (msg->opcode()) {
-          case L1CmdOpcode::CpuLoad: {
-            // Update state I -> IS
-            issue_update_state(cl, line, State::IS);
-            // Issue GetS
-            l2cmdmsg->set_opcode(L2CmdOpcode::L1GetS);
-            // Raise Event
-            cl.push_back(cb::build_cache_event(L1CacheEvent::LoadMiss,
-                                               msg->addr()));
-          } break;
-          case L1CmdOpcode::CpuStore: {
-            // Update state I -> IE
-            issue_update_state(cl, line, State::IE);
-            // Issue GetS
-            l2cmdmsg->set_opcode(L2CmdOpcode::L1GetE);
-            // Raise Event
-            cl.push_back(cb::build_cache_event(L1CacheEvent::StoreMiss,
-                                               msg->addr()));
-          } break;
-          default: {
-          } break;
-        }
-        l2cmdmsg->set_l1cache(ctxt.l1cache());
-        // Issue L2 command
-        issue_msg_to_queue(L1EgressQueue::L2CmdQ, cl, ctxt, l2cmdmsg);
-
-        // In the non-blocking cache, the transaction state takes
-        // ownership of the message at the head of the command queue
-        // as this is subsequently dequeued to prevent head-of-line
-        // blocking.
-        if (!config.is_blocking_cache) {
-          tstate->set_do_replay(true);
-          tstate->set_msg(msg);
-        }
-
-        // Message is stalled on lookup transaction.
-        // Install new entry in transaction table as the transaction
-        // has now started and commands are inflight. The transaction
-        // itself is not complete at this point.
-        cl.transaction_start(msg->t(), config.is_blocking_cache);
-      } break;
-      case State::S: {
-        // Line is present in the cache.
-        switch (msg->opcode()) {
-          case L1CmdOpcode::CpuLoad: {
-            // LD to line in S-state can complete immediately. Forward
-            // the response to the CPU.
-            L1CmdRspMsg* rsp = Pool<L1CmdRspMsg>::construct();
-            rsp->set_t(msg->t());
-            issue_msg_to_queue(L1EgressQueue::CpuRspQ, cl, ctxt, rsp);
-            // Raise event
-            cl.push_back(cb::build_cache_event(L1CacheEvent::LoadHit, msg->addr()));
-            // Advance to next
-            cl.next_and_do_consume(true);
-          } break;
-          case L1CmdOpcode::CpuStore: {
-            // Store instruction to line in S-state. Line must be promoted to
-            // the E state before the transaction can complete.
-
-            // Issue GetE message to owning L2 cache.
-            L2CmdMsg* l2cmdmsg = Pool<L2CmdMsg>::construct();
-            l2cmdmsg->set_t(msg->t());
-            l2cmdmsg->set_addr(msg->addr());
-            l2cmdmsg->set_opcode(L2CmdOpcode::L1GetE);
-            l2cmdmsg->set_l1cache(ctxt.l1cache());
-            // Issue L2 command
-            // issue_msg(cl, ctxt.l1cache()->l1_l2__cmd_q(), l2cmdmsg);
-            issue_msg_to_queue(L1EgressQueue::L2CmdQ, cl, ctxt, l2cmdmsg);
-            // Start new transaction
-            cl.transaction_start(msg->t(), config.is_blocking_cache);
-            // Raise Event
-            cl.push_back(cb::build_cache_event(L1CacheEvent::StoreMiss,
-                                               msg->addr()));
-            // State transitions to SE state.
-            issue_update_state(cl, line, State::SE);
-          } break;
-          default: {
-            // Invalid command.
-          } break;
-        }
-      } break;
-      case State::M: {
-        switch (msg->opcode()) {
-          case L1CmdOpcode::CpuLoad: {
-            // Ld from M-state; commits immediately
-            L1CmdRspMsg* rsp = Pool<L1CmdRspMsg>::construct();
-            rsp->set_t(msg->t());
-            // Issue response to CPU.
-            issue_msg_to_queue(L1EgressQueue::CpuRspQ, cl, ctxt, rsp);
-            // Raise event
-            cl.push_back(cb::build_cache_event(L1CacheEvent::LoadHit, msg->addr()));
-            // Advance to next and consume
-            cl.next_and_do_consume(true);
-          } break;
-          case L1CmdOpcode::CpuStore: {
-            // St to M-state; commits immediate.
-            L1CmdRspMsg* rsp = Pool<L1CmdRspMsg>::construct();
-            rsp->set_t(msg->t());
-            // Issue response to CPU.
-            issue_msg_to_queue(L1EgressQueue::CpuRspQ, cl, ctxt, rsp);
-            // Raise event
-            cl.push_back(cb::build_cache_event(L1CacheEvent::StoreHit, msg->addr()));
-            // Advance to next and consume
-            cl.next_and_do_consume(true);
-          } break;
-          default: {
-          } break;
-        }
-      } break;
-      case State::E: {
-        switch (msg->opcode()) {
-          case L1CmdOpcode::CpuLoad: {
-            // Load to line in the exclusive state; instruction can complete
-            // successfully.
-            L1CmdRspMsg* rsp = Pool<L1CmdRspMsg>::construct();
-            rsp->set_t(msg->t());
-            issue_msg_to_queue(L1EgressQueue::CpuRspQ, cl, ctxt, rsp);
-            // Raise event
-            cl.push_back(cb::build_cache_event(L1CacheEvent::LoadHit, msg->addr()));
-            // Advance to next and consume
-            cl.next_and_do_consume(true);
-          } break;
-          case L1CmdOpcode::CpuStore: {
-            // Store to line the exclusive state; instruction can complete
-            // but line must transition to the modified state.
-            L1CmdRspMsg* rsp = Pool<L1CmdRspMsg>::construct();
-            rsp->set_t(msg->t());
-            issue_msg_to_queue(L1EgressQueue::CpuRspQ, cl, ctxt, rsp);
-            issue_update_state(cl, line, State::M);
-            // Write through to L2. such that L2 sees the transition
-            // to M immediately.
-            cl.push_back(L1Opcode::SetL2LineModified);
-            // Raise event
-            cl.push_back(cb::build_cache_event(L1CacheEvent::StoreHit, msg->addr()));
-            // Advance to next and consume
-            cl.next_and_do_consume(true);
-          } break;
-          default: {
-            // Unknown CPU command.
-          } break;
-        }
-      } break;
-      default: {
-        // Invalid state
-      } break;
-    }
-  }
-
-  void apply(L1CacheContext& ctxt, L1CommandList& cl, MOESIL1LineState* line,
-             const L2CmdRspMsg* msg) const {
-    Transaction* t = msg->t();
-    const addr_t addr = ctxt.tstate()->addr();
+  // Lookup and apply transition for 'event' in the line's current
+  // state. Events for which no transition is defined are ignored.
+  void dispatch(L1CacheContext& ctxt, L1CommandList& cl,
+                MOESIL1LineState* line, Event event) const {
+    TransitionArgs args{ctxt, cl, line};
     const State state = line->state();
-    switch (state) {
-      case State::IS: {
-        // Update state
-        const State next_state = msg->is() ? State::S : State::E;
-        issue_update_state(cl, line, next_state);
-
-        // Update transaction table; wake all blocked Message Queues
-        // and delete context.
-        const L1CacheEvent l1event = (next_state == State::S) ?
-                                     L1CacheEvent::InstallShareable :
-                                     L1CacheEvent::InstallWriteable;
-        cl.push_back(cb::build_cache_event(l1event, addr));
-        cl.transaction_end(t);
-        // Advance to next and consume
-        cl.next_and_do_consume(true);
-      } break;
-      case State::IE: {
-        // Update state
-        issue_update_state(cl, line, State::E);
-        // Raise event
-        cl.push_back(cb::build_cache_event(L1CacheEvent::InstallWriteable, addr));
-        // Update transaction table; wake all blocked Message Queues
-        // and delete context.
-        cl.transaction_end(t);
-        // Advance to next and consume
-        cl.next_and_do_consume(true);
-      } break;
-      case State::SE: {
-        // Line is installed in 'E' state.
-        issue_update_state(cl, line, State::E);
-        // Update transaction table; wake all blocked Message Queues
-        // and delete context.
-        cl.push_back(cb::build_cache_event(L1CacheEvent::InstallWriteable, addr));
-        cl.transaction_end(t);
-        // Advance to next and consume
-        cl.next_and_do_consume(true);
-      } break;
-      case State::SI:
-      case State::MI:
-      case State::EI: {
-        // Shared/Modifed/Exclusive -> Invalid
-        //
-        // Edge entered upon an eviction from L1 cache. As L1 is
-        // write-through to L2, L2 maintains a recent up to date copy
-        // of the line and this transaction therefore serves as
-        // notification that the line has been evicted from L1. In the
-        // case of SI, L1 may optionally silently evict the line
-        // without L2 notification, in which the message is never
-        // sent.
-
-        // Transition back to Invalid state and evict line.
-        issue_update_state(cl, line, State::I);
-        // Remove line from cache as now invalid.
-        cl.push_back(cb::build_remove_line(addr));
-        // Transaction ends
-        cl.transaction_end(t);
-        // Raise line is invalidate line.
-        cl.push_back(cb::build_cache_event(L1CacheEvent::InvalidateLine, addr));
-        // Advance to next and consume
-        cl.next_and_do_consume(true);
-      } break;
-      default: {
-        // Invalid state
-      } break;
-    }
-  }
-
-  void issue_msg_to_queue(L1EgressQueue eq, L1CommandList& cl,
-                          L1CacheContext& ctxt, const Message* msg) const {
-    struct EmitMessageActionProxy : public L1CoherenceAction {
-      EmitMessageActionProxy() = default;
-
-      std::string to_string() const override {
-        KVListRenderer r;
-        r.add_field("action", "emit message");
-        r.add_field("mq", mq_->path());
-        r.add_field("msg", msg_->to_string());
-        return r.to_string();
-      }
-
-      void set_eq(L1EgressQueue eq) { eq_ = eq; }
-      void set_mq(MessageQueue* mq) { mq_ = mq; }
-      void set_msg(const Message* msg) { msg_ = msg; }
-
-      void set_resources(L1Resources& r) const override {
-        switch (eq_) {
-          case L1EgressQueue::L2CmdQ: {
-            r.set_l2_cmd_n(1 + r.l2_cmd_n());
-          } break;
-          case L1EgressQueue::CpuRspQ: {
-            r.set_cpu_rsp_n(1 + r.cpu_rsp_n());
-          } break;
-          default: {
-            // No cost
-          } break;
-        }
+    if (const L1Transition* t = l1_table.lookup(state, event, args);
+        t != nullptr) {
+      if (t->next != state) {
+        issue_update_state(cl, line, t->next);
       }
-
-      //
-      bool execute() override { return mq_->issue(msg_); }
-
-     private:
-      //
-      L1EgressQueue eq_ = L1EgressQueue::Invalid;
-      //
-      MessageQueue* mq_ = nullptr;
-      //
-      const Message* msg_ = nullptr;
-    };
-
-    EmitMessageActionProxy* action = new EmitMessageActionProxy;
-    action->set_eq(eq);
-    action->set_msg(msg);
-    switch (eq) {
-      case L1EgressQueue::L2CmdQ: {
-        action->set_mq(ctxt.l1cache()->l1_l2__cmd_q());
-      } break;
-      case L1EgressQueue::CpuRspQ: {
-        action->set_mq(ctxt.l1cache()->l1_cpu__rsp_q());
-      } break;
-      default: {
-      } break;
+      t->invoke(args);
     }
-    cl.push_back(action);
-  }
-
-  void issue_update_state(L1CommandList& cl, MOESIL1LineState* line,
-                          State state) const {
-    struct UpdateStateAction : public L1CoherenceAction {
-      UpdateStateAction(MOESIL1LineState* line, State state)
-          : line_(line), state_(state) {}
-      std::string to_string() const override {
-        using cc::to_string;
-
-        KVListRenderer r;
-        r.add_field("action", "update state");
-        r.add_field("current", to_string(line_->state()));
-        r.add_field("next", to_string(state_));
-        return r.to_string();
-      }
-      void set_resources(L1Resources& r) const override {
-        // No resources required for state update.
-      }
-      bool execute() override {
-        line_->set_state(state_);
-        return true;
-      }
-
-     private:
-      MOESIL1LineState* line_ = nullptr;
-      State state_;
-    };
-    L1CoherenceAction* action = new UpdateStateAction(line, state);
-    cl.push_back(action);
   }
 };
 
@@ -597,4 +731,15 @@ L1CacheAgentProtocol* build_l1_protocol(kernel::Kernel* k) {
   return new MOESIL1CacheProtocol(k);
 }
 
+//
+//
+L1CacheAgent* build_l1_agent(kernel::Kernel* k,
+                             const L1CacheAgentConfig& config) {
+  return new L1CacheAgentT<MOESIL1CacheProtocol>(k, config);
+}
+
+//
+//
+std::string render_l1_transitions() { return render_transitions(l1_table); }
+
 }  // namespace cc::moesi
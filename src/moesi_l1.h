@@ -28,9 +28,13 @@
 #ifndef CC_SRC_MOESI_L1_H
 #define CC_SRC_MOESI_L1_H
 
+#include <string>
+
 namespace cc {
 
 class L1CacheAgentProtocol;
+class L1CacheAgent;
+struct L1CacheAgentConfig;
 namespace kernel {
 class Kernel;
 }
@@ -39,6 +43,13 @@ namespace moesi {
 
 L1CacheAgentProtocol* build_l1_protocol(kernel::Kernel* k);
 
+L1CacheAgent* build_l1_agent(kernel::Kernel* k,
+                             const L1CacheAgentConfig& config);
+
+// Render the L1 protocol transition table as a machine-readable list
+// of {state, event, guard, next} records.
+std::string render_l1_transitions();
+
 }  // namespace moesi
 
 }  // namespace cc
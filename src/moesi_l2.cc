@@ -25,13 +25,14 @@
 // POSSIBILITY OF SUCH DAMAGE.
 //========================================================================== //
 
-#include <set>
-
 #include "amba.h"
 #include "l1cache.h"
 #include "l2cache.h"
+#include "l2cache_process.h"
 #include "moesi.h"
+#include "moesi_l2.h"
 #include "protocol.h"
+#include "transition.h"
 #include "utility.h"
 
 namespace {
@@ -54,6 +55,9 @@ enum class State {
   // Shared
   S,
 
+  // Shared -> Exclusive
+  S_E,
+
   // Exclusive
   E,
 
@@ -90,6 +94,8 @@ const char* to_string(State state) {
       return "I_E";
     case State::S:
       return "S";
+    case State::S_E:
+      return "S_E";
     case State::E:
       return "E";
     case State::E_I:
@@ -154,18 +160,18 @@ class LineState : public L2LineState {
   L2Command* build_update_state(State state);
 
   // Build command to set owner
-  L2Command* build_set_owner(Agent* agent);
+  L2Command* build_set_owner(L1CacheAgent* l1cache);
   
   // Build command to delete owner
   L2Command* build_del_owner();
 
   // Build command to add sharer
-  L2Command* build_add_sharer(Agent* agent);
+  L2Command* build_add_sharer(L1CacheAgent* l1cache);
 
-  // Builder command to delete sharer
-  L2Command* build_del_sharer(Agent* agent);
+  // Builder command to delete sharers
+  L2Command* build_del_sharers(L1Mask l1s);
 
-  // Builder command to clear sharer set
+  // Builder command to clear sharer set (the owner is retained)
   L2Command* build_clr_sharer();
 
 
@@ -178,10 +184,10 @@ class LineState : public L2LineState {
   State state() const { return state_; }
 
   // Curent line owner (or nullptr if no owner)
-  Agent* owner() const { return owner_; }
+  L1CacheAgent* owner() const { return owner_; }
 
-  // Current sharing Agent set.
-  const std::set<Agent*>& sharers() const { return sharers_; }
+  // Set of L1 holding the line (the owner and sharers).
+  L1Mask l1s() const { return l1s_; }
 
 
   // Setters:
@@ -195,35 +201,33 @@ class LineState : public L2LineState {
   // immediate writeback.
   bool has_owner() const { return owner_ != nullptr; }
 
-  // Set owning agent
-  void set_owner(Agent* owner) { owner_ = owner; }
-
-  // Add agent to sharer list
-  bool add_sharer(Agent* agent) {
-    auto p = sharers_.insert(agent);
-    return p.second;
+  // Set owning L1; owner is also a holder of the line.
+  void set_owner(L1CacheAgent* owner) {
+    owner_ = owner;
+    if (owner_ != nullptr) l1s_ |= l1_bit(owner_);
   }
 
-  // Delete agent from sharer list
-  bool del_sharer(Agent* agent) {
-    bool success = false;
-    if (auto it = sharers_.find(agent); it != sharers_.end()) {
-      sharers_.erase(it);
-      success = true;
-    }
-    return success;
-  }
+  // Add L1 set to holders of the line.
+  void add_sharers(L1Mask l1s) { l1s_ |= l1s; }
 
-  // Clear sharer set
-  void clr_sharer() { sharers_.clear(); }
+  // Delete L1 set from holders of the line.
+  void del_sharers(L1Mask l1s) { l1s_ &= ~l1s; }
+
+  // Clear sharer set; only the owner (if any) retains the line.
+  void clr_sharer() { l1s_ = (owner_ != nullptr) ? l1_bit(owner_) : 0; }
+
+  // L1 set denoting 'l1cache' alone.
+  static L1Mask l1_bit(const L1CacheAgent* l1cache) {
+    return L1Mask{1} << l1cache->l2_id();
+  }
 
  private:
   // Current line state
   State state_ = State::I;
-  // Current owning agent
-  Agent* owner_ = nullptr;
-  // Current sharers
-  std::set<Agent*> sharers_;
+  // Current owning L1
+  L1CacheAgent* owner_ = nullptr;
+  // L1 presently holding the line.
+  L1Mask l1s_ = 0;
 };
 
 
@@ -241,8 +245,8 @@ enum class LineUpdateOpcode {
   // Add agent to sharer set
   AddSharer,
 
-  // Delete sharer agent from sharer set
-  DelSharer,
+  // Delete agents from sharer set
+  DelSharers,
 
   // Clear sharer set
   ClrSharer,
@@ -263,8 +267,8 @@ const char* to_string(LineUpdateOpcode opcode) {
       return "DelOwner";
     case LineUpdateOpcode::AddSharer:
       return "AddSharer";
-    case LineUpdateOpcode::DelSharer:
-      return "DelSharer";
+    case LineUpdateOpcode::DelSharers:
+      return "DelSharers";
     case LineUpdateOpcode::ClrSharer:
       return "ClrSharer";
     case LineUpdateOpcode::Invalid:
@@ -278,8 +282,15 @@ const char* to_string(LineUpdateOpcode opcode) {
 // state.
 //
 struct LineUpdateAction : public L2CoherenceAction {
-  LineUpdateAction(LineState* line, LineUpdateOpcode opcode)
-      : line_(line), opcode_(opcode) {}
+  LineUpdateAction() = default;
+
+  // Construct action from pool.
+  static LineUpdateAction* construct(LineState* line, LineUpdateOpcode opcode) {
+    LineUpdateAction* action = Pool<LineUpdateAction>::construct();
+    action->line_ = line;
+    action->opcode_ = opcode;
+    return action;
+  }
 
   std::string to_string() const override {
     using cc::to_string;
@@ -299,9 +310,11 @@ struct LineUpdateAction : public L2CoherenceAction {
       } break;
       case LineUpdateOpcode::AddSharer: {
         r.add_field("action", "add_sharer");
+        r.add_field("l1s", Hexer{}.to_hex(l1s_));
       } break;
-      case LineUpdateOpcode::DelSharer: {
-        r.add_field("action", "del_sharer");
+      case LineUpdateOpcode::DelSharers: {
+        r.add_field("action", "del_sharers");
+        r.add_field("l1s", Hexer{}.to_hex(l1s_));
       } break;
       case LineUpdateOpcode::ClrSharer: {
         r.add_field("action", "clr_sharer");
@@ -314,7 +327,8 @@ struct LineUpdateAction : public L2CoherenceAction {
 
   // Setters
   void set_state(State state) { state_ = state; }
-  void set_agent(Agent* agent) { agent_ = agent; }
+  void set_l1cache(L1CacheAgent* l1cache) { l1cache_ = l1cache; }
+  void set_l1s(L1Mask l1s) { l1s_ = l1s; }
 
   bool execute() override {
     switch (opcode_) {
@@ -322,16 +336,16 @@ struct LineUpdateAction : public L2CoherenceAction {
         line_->set_state(state_);
       } break;
       case LineUpdateOpcode::SetOwner: {
-        line_->set_owner(agent_);
+        line_->set_owner(l1cache_);
       } break;
       case LineUpdateOpcode::DelOwner: {
         line_->set_owner(nullptr);
       } break;
       case LineUpdateOpcode::AddSharer: {
-        line_->add_sharer(agent_);
+        line_->add_sharers(l1s_);
       } break;
-      case LineUpdateOpcode::DelSharer: {
-        line_->del_sharer(agent_);
+      case LineUpdateOpcode::DelSharers: {
+        line_->del_sharers(l1s_);
       } break;
       case LineUpdateOpcode::ClrSharer: {
         line_->clr_sharer();
@@ -349,61 +363,835 @@ struct LineUpdateAction : public L2CoherenceAction {
   LineUpdateOpcode opcode_ = LineUpdateOpcode::Invalid;
   // Set update
   State state_ = State::X;
-  // Agent of interest
-  Agent* agent_ = nullptr;
+  // L1 of interest
+  L1CacheAgent* l1cache_ = nullptr;
+  // L1 set of interest
+  L1Mask l1s_ = 0;
 };
 
 
 // Build command to update line state:
 L2Command* LineState::build_update_state(State state) {
   LineUpdateAction* update =
-      new LineUpdateAction(this, LineUpdateOpcode::SetState);
+      LineUpdateAction::construct(this, LineUpdateOpcode::SetState);
   update->set_state(state);
   return L2CommandBuilder::from_action(update);
 }
 
 // Build command to set owner
-L2Command* LineState::build_set_owner(Agent* agent) {
+L2Command* LineState::build_set_owner(L1CacheAgent* l1cache) {
   LineUpdateAction* update =
-      new LineUpdateAction(this, LineUpdateOpcode::SetOwner);
-  update->set_agent(agent);
+      LineUpdateAction::construct(this, LineUpdateOpcode::SetOwner);
+  update->set_l1cache(l1cache);
   return L2CommandBuilder::from_action(update);
 }
   
 // Build command to delete owner
 L2Command* LineState::build_del_owner() {
   LineUpdateAction* update =
-      new LineUpdateAction(this, LineUpdateOpcode::DelOwner);
+      LineUpdateAction::construct(this, LineUpdateOpcode::DelOwner);
   return L2CommandBuilder::from_action(update);
 }
 
 // Build command to add sharer
-L2Command* LineState::build_add_sharer(Agent* agent) {
+L2Command* LineState::build_add_sharer(L1CacheAgent* l1cache) {
   LineUpdateAction* update =
-      new LineUpdateAction(this, LineUpdateOpcode::AddSharer);
-  update->set_agent(agent);
+      LineUpdateAction::construct(this, LineUpdateOpcode::AddSharer);
+  update->set_l1s(l1_bit(l1cache));
   return L2CommandBuilder::from_action(update);
 }
 
-// Builder command to delete sharer
-L2Command* LineState::build_del_sharer(Agent* agent) {
+// Builder command to delete sharers
+L2Command* LineState::build_del_sharers(L1Mask l1s) {
   LineUpdateAction* update =
-      new LineUpdateAction(this, LineUpdateOpcode::DelSharer);
-  update->set_agent(agent);
+      LineUpdateAction::construct(this, LineUpdateOpcode::DelSharers);
+  update->set_l1s(l1s);
   return L2CommandBuilder::from_action(update);
 }
 
 // Builder command to clear sharer set
 L2Command* LineState::build_clr_sharer() {
   LineUpdateAction* update =
-      new LineUpdateAction(this, LineUpdateOpcode::ClrSharer);
+      LineUpdateAction::construct(this, LineUpdateOpcode::ClrSharer);
   return L2CommandBuilder::from_action(update);
 }
 
 
+// L2 protocol events.
+//
+enum class Event {
+  // L1 -> L2 GetS command
+  L1GetS,
+
+  // L1 -> L2 GetE command
+  L1GetE,
+
+  // L1 -> L2 Put command
+  L1Put,
+
+  // CC -> L2 command response
+  AceCmdRsp,
+
+  // CC -> L2 snoops
+  SnpReadOnce,
+  SnpReadClean,
+  SnpReadShared,
+  SnpReadNotSharedDirty,
+  SnpReadUnique,
+  SnpCleanInvalid,
+  SnpMakeInvalid,
+
+  // L1 has written to a line which it holds writeable.
+  SetModified,
+
+  // Invalid; placeholder
+  Invalid
+};
+
+//
 //
+const char* to_string(Event event) {
+  switch (event) {
+    case Event::L1GetS:
+      return "L1GetS";
+    case Event::L1GetE:
+      return "L1GetE";
+    case Event::L1Put:
+      return "L1Put";
+    case Event::AceCmdRsp:
+      return "AceCmdRsp";
+    case Event::SnpReadOnce:
+      return "SnpReadOnce";
+    case Event::SnpReadClean:
+      return "SnpReadClean";
+    case Event::SnpReadShared:
+      return "SnpReadShared";
+    case Event::SnpReadNotSharedDirty:
+      return "SnpReadNotSharedDirty";
+    case Event::SnpReadUnique:
+      return "SnpReadUnique";
+    case Event::SnpCleanInvalid:
+      return "SnpCleanInvalid";
+    case Event::SnpMakeInvalid:
+      return "SnpMakeInvalid";
+    case Event::SetModified:
+      return "SetModified";
+    case Event::Invalid:
+      [[fallthrough]];
+    default:
+      return "Invalid";
+  }
+}
+
+// Action to issue a message to one of the L2's egress queues.
 //
-class MOESIL2CacheProtocol : public L2CacheAgentProtocol {
+struct EmitMessageActionProxy : public L2CoherenceAction {
+  EmitMessageActionProxy() = default;
+
+  std::string to_string() const override {
+    KVListRenderer r;
+    r.add_field("action", "emit message");
+    r.add_field("mq", mq_->path());
+    r.add_field("msg", msg_->to_string());
+    return r.to_string();
+  }
+
+  // Setters:
+  void set_eq(L2EgressQueue eq) { eq_ = eq; }
+  void set_mq(MessageQueue* mq) { mq_ = mq; }
+  void set_msg(const Message* msg) { msg_ = msg; }
+
+  void set_resources(L2Resources& r) const override {
+    switch (eq_) {
+      case L2EgressQueue::CCCmdQ: {
+        r.set_cc_cmd_n(r.cc_cmd_n() + 1);
+      } break;
+      case L2EgressQueue::CCSnpRspQ: {
+        r.set_cc_snp_rsp_n(r.cc_snp_rsp_n() + 1);
+      } break;
+      case L2EgressQueue::L1RspQ: {
+        r.set_l1_rsp_n(r.l1_rsp_n() + 1);
+      } break;
+      default: {
+        // No resource requirement.
+      } break;
+    }
+  }
+  //
+  bool execute() override { return mq_->issue(msg_); }
+
+ private:
+  // EgressQueue Id (for resource calculation).
+  L2EgressQueue eq_ = L2EgressQueue::Invalid;
+  // Destination Message Queue.
+  MessageQueue* mq_ = nullptr;
+  // Message to be issued.
+  const Message* msg_ = nullptr;
+};
+
+void issue_msg_to_queue(L2EgressQueue eq, L2CommandList& cl,
+                        L2CacheContext& ctxt, const Message* msg) {
+  // Construct "issue" message action to be performance message
+  // issue L1/CC to agent.
+  EmitMessageActionProxy* action = Pool<EmitMessageActionProxy>::construct();
+  action->set_eq(eq);
+  action->set_msg(msg);
+  switch (eq) {
+    case L2EgressQueue::CCCmdQ: {
+      action->set_mq(ctxt.l2cache()->l2_cc__cmd_q());
+    } break;
+    case L2EgressQueue::CCSnpRspQ: {
+      action->set_mq(ctxt.l2cache()->l2_cc__snprsp_q());
+    } break;
+    case L2EgressQueue::L1RspQ: {
+      // Response is returned to the L1 which initiated the
+      // transaction.
+      action->set_mq(ctxt.l2cache()->l2_l1__rsp_q(ctxt.tstate()->l1cache()));
+    } break;
+    default: {
+    } break;
+  }
+  // Schedule current issue action in current command list.
+  cl.push_back(L2CommandBuilder::from_action(action));
+}
+
+template <typename... AGENT>
+void issue_set_l1_invalid_except(L2CommandList& cl, LineState* line,
+                                 addr_t addr, AGENT... excluded) {
+  // Issue L1 invalidate of current line to the L1 holding the line,
+  // less the set of keep out agents. The command therefore allows
+  // agent to retain the line whereas all other will be invalidated.
+  const L1Mask l1s =
+      line->l1s() & ~(L1Mask{0} | ... | LineState::l1_bit(excluded));
+  L2Command* cmd = L2CommandBuilder::from_opcode(L2Opcode::SetL1LinesInvalid);
+  cmd->set_addr(addr);
+  cmd->set_l1s(l1s);
+  if (line->has_owner()) {
+    cmd->set_owners(l1s & LineState::l1_bit(line->owner()));
+  }
+  cl.push_back(cmd);
+  // Invalidated L1 no longer hold the line.
+  if (l1s != 0) cl.push_back(line->build_del_sharers(l1s));
+}
+
+template <typename... AGENT>
+void issue_set_l1_shared_except(L2CommandList& cl, LineState* line,
+                                addr_t addr, AGENT... excluded) {
+  // Demote L1 lines to Shared except Agents contains with in the
+  // excluded set; demoted L1 continue to hold the line.
+  const L1Mask l1s =
+      line->l1s() & ~(L1Mask{0} | ... | LineState::l1_bit(excluded));
+  L2Command* cmd = L2CommandBuilder::from_opcode(L2Opcode::SetL1LinesShared);
+  cmd->set_addr(addr);
+  cmd->set_l1s(l1s);
+  if (line->has_owner()) {
+    cmd->set_owners(l1s & LineState::l1_bit(line->owner()));
+  }
+  cl.push_back(cmd);
+}
+
+// Arguments passed to each transition guard and action.
+//
+struct TransitionArgs {
+  // Current L2 context
+  L2CacheContext& ctxt;
+
+  // Command list under construction
+  L2CommandList& cl;
+
+  // Line of interest
+  LineState* line;
+
+  // L1 which initiated the current transaction.
+  L1CacheAgent* requester() const { return ctxt.tstate()->l1cache(); }
+};
+
+// Transition guards:
+
+// Line is returned Shared and Dirty; L2 becomes the line's owner.
+bool is_shared_dirty(const TransitionArgs& a) {
+  const AceCmdRspMsg* rsp = static_cast<const AceCmdRspMsg*>(a.ctxt.msg());
+  return rsp->is() && rsp->pd();
+}
+
+// Line is returned Unique and Clean.
+bool is_unique_clean(const TransitionArgs& a) {
+  const AceCmdRspMsg* rsp = static_cast<const AceCmdRspMsg*>(a.ctxt.msg());
+  return !rsp->is() && !rsp->pd();
+}
+
+// Responsibility to writeback the line has been passed to the L2.
+bool is_pass_dirty(const TransitionArgs& a) {
+  return static_cast<const AceCmdRspMsg*>(a.ctxt.msg())->pd();
+}
+
+// Transaction was initiated by an L1 eviction.
+bool is_put(const TransitionArgs& a) {
+  return a.ctxt.tstate()->opcode() == L2CmdOpcode::L1Put;
+}
+
+// Transition actions:
+
+// Issue ACE command to the cache controller.
+template <AceCmdOpcode Opcode>
+struct IssueAceCmd {
+  void operator()(TransitionArgs& a) const {
+    AceCmdMsg* msg = Pool<AceCmdMsg>::construct();
+    msg->set_t(a.ctxt.msg()->t());
+    msg->set_addr(a.ctxt.addr());
+    msg->set_opcode(Opcode);
+    issue_msg_to_queue(L2EgressQueue::CCCmdQ, a.cl, a.ctxt, msg);
+  }
+};
+
+// Issue command response to the requesting L1; 'IsShared' denotes
+// that the line is to be installed in the Shared state.
+template <bool IsShared>
+struct IssueL1Rsp {
+  void operator()(TransitionArgs& a) const {
+    L2CmdRspMsg* rsp = Pool<L2CmdRspMsg>::construct();
+    rsp->set_t(a.ctxt.msg()->t());
+    rsp->set_is(IsShared);
+    issue_msg_to_queue(L2EgressQueue::L1RspQ, a.cl, a.ctxt, rsp);
+  }
+};
+
+// Issue snoop response to the cache controller; flags as per. the
+// AMBA CRRESP encoding.
+template <bool DT, bool PD, bool IS, bool WU>
+struct IssueSnpRsp {
+  void operator()(TransitionArgs& a) const {
+    AceSnpRspMsg* rsp = Pool<AceSnpRspMsg>::construct();
+    rsp->set_t(a.ctxt.msg()->t());
+    rsp->set_dt(DT);
+    rsp->set_pd(PD);
+    rsp->set_is(IS);
+    rsp->set_wu(WU);
+    issue_msg_to_queue(L2EgressQueue::CCSnpRspQ, a.cl, a.ctxt, rsp);
+  }
+};
+
+// Snoop response where no data is transferred.
+using IssueSnpRspNoData = IssueSnpRsp<false, false, false, false>;
+
+// Requester is added to the set of sharers.
+struct AddSharer {
+  void operator()(TransitionArgs& a) const {
+    a.cl.push_back(a.line->build_add_sharer(a.requester()));
+  }
+};
+
+// Requester becomes the owner.
+struct SetOwner {
+  void operator()(TransitionArgs& a) const {
+    a.cl.push_back(a.line->build_set_owner(a.requester()));
+  }
+};
+
+// Owning L1 relinquishes ownership.
+struct DelOwner {
+  void operator()(TransitionArgs& a) const {
+    a.cl.push_back(a.line->build_del_owner());
+  }
+};
+
+// Clear the sharer set; the owner retains the line.
+struct ClrSharer {
+  void operator()(TransitionArgs& a) const {
+    a.cl.push_back(a.line->build_clr_sharer());
+  }
+};
+
+// Invalidate the line in child L1 (less the requester, where
+// 'ExceptRequester').
+template <bool ExceptRequester>
+struct InvalidateL1 {
+  void operator()(TransitionArgs& a) const {
+    if constexpr (ExceptRequester) {
+      issue_set_l1_invalid_except(a.cl, a.line, a.ctxt.addr(),
+                                  a.requester());
+    } else {
+      issue_set_l1_invalid_except(a.cl, a.line, a.ctxt.addr());
+    }
+  }
+};
+
+// Demote the line to Shared in child L1 (less the requester, where
+// 'ExceptRequester').
+template <bool ExceptRequester>
+struct DemoteL1 {
+  void operator()(TransitionArgs& a) const {
+    if constexpr (ExceptRequester) {
+      issue_set_l1_shared_except(a.cl, a.line, a.ctxt.addr(), a.requester());
+    } else {
+      issue_set_l1_shared_except(a.cl, a.line, a.ctxt.addr());
+    }
+  }
+};
+
+// Install new entry in the transaction table as the transaction has
+// now started and commands are inflight.
+struct StartTransaction {
+  void operator()(TransitionArgs& a) const {
+    a.cl.push_back(L2Opcode::StartTransaction);
+  }
+};
+
+// Transaction complete.
+struct EndTransaction {
+  void operator()(TransitionArgs& a) const {
+    a.cl.push_back(L2Opcode::EndTransaction);
+  }
+};
+
+// Remove line from the cache.
+struct RemoveLine {
+  void operator()(TransitionArgs& a) const {
+    a.cl.push_back(L2Opcode::RemoveLine);
+  }
+};
+
+// Consume message and advance to next.
+struct Consume {
+  void operator()(TransitionArgs& a) const { a.cl.next_and_do_consume(true); }
+};
+
+using L2Transition = Transition<State, Event, TransitionArgs, 5>;
+
+template <typename ActionT>
+constexpr L2Transition::action_type act =
+    &invoke_action<ActionT, TransitionArgs>;
+
+// MOESI L2 transition table:
+//
+//  {state, event, guard, guard name, {actions...}, next state}
+//
+// The state update to 'next' is emitted ahead of the transition
+// actions whenever the state changes. Snoops which arrive whilst the
+// line is in a transitional state are trapped in limbo and are
+// answered without data.
+//
+constexpr std::array<L2Transition, 91> l2_transitions{{
+    //
+    // L1 commands:
+    //
+
+    // Line not present; request line from home directory. Message is
+    // stalled on lookup transaction.
+    {State::I, Event::L1GetS, nullptr, nullptr,
+     {act<IssueAceCmd<AceCmdOpcode::ReadShared>>, act<StartTransaction>,
+      act<Consume>},
+     State::I_S},
+    {State::I, Event::L1GetE, nullptr, nullptr,
+     {act<IssueAceCmd<AceCmdOpcode::ReadUnique>>, act<StartTransaction>,
+      act<Consume>},
+     State::I_E},
+
+    // Line is presently Shared in multiple L1 and possibly in other
+    // clusters. Requester requests line in Exclusive state; as in the
+    // Owned state, a CleanUnique command first invalidates the copies
+    // held elsewhere in the system, after which all other L1 copies
+    // are invalidated. (TODO: might be some advantage to model the
+    // relative cost of transport delay in both the have and have-not
+    // line cases).
+    {State::S, Event::L1GetS, nullptr, nullptr,
+     {act<AddSharer>, act<IssueL1Rsp<true>>, act<Consume>},
+     State::S},
+    {State::S, Event::L1GetE, nullptr, nullptr,
+     {act<IssueAceCmd<AceCmdOpcode::CleanUnique>>, act<StartTransaction>,
+      act<Consume>},
+     State::S_E},
+    {State::S, Event::L1Put, nullptr, nullptr,
+     {act<IssueL1Rsp<false>>, act<Consume>},
+     State::S},
+
+    // L2 has line in Owning state, but must first promote the line to
+    // the exclusive state. L2 already has the line, therefore simply
+    // issue a CleanUnique command to invalidate other copies within
+    // the system. Upon L1GetS, L2 has a dirty copy of the line and
+    // can immediately service the request. As in the Shared state,
+    // the line is retained upon Put.
+    {State::O, Event::L1GetS, nullptr, nullptr,
+     {act<AddSharer>, act<IssueL1Rsp<true>>, act<Consume>},
+     State::O},
+    {State::O, Event::L1GetE, nullptr, nullptr,
+     {act<IssueAceCmd<AceCmdOpcode::CleanUnique>>, act<StartTransaction>,
+      act<Consume>},
+     State::O_E},
+    {State::O, Event::L1Put, nullptr, nullptr,
+     {act<IssueL1Rsp<false>>, act<Consume>},
+     State::O},
+
+    // Demote line in owner to Shared state, add requester to set of
+    // sharers.
+    {State::E, Event::L1GetS, nullptr, nullptr,
+     {act<DemoteL1<true>>, act<DelOwner>, act<AddSharer>,
+      act<IssueL1Rsp<true>>, act<Consume>},
+     State::S},
+    {State::E, Event::L1GetE, nullptr, nullptr,
+     {act<InvalidateL1<true>>, act<SetOwner>, act<IssueL1Rsp<false>>,
+      act<Consume>},
+     State::E},
+    // Issue eviction notification to home directory. Line is not
+    // modified therefore no Write command is required; await receipt
+    // of AceCmdRspMsg for the Evict.
+    {State::E, Event::L1Put, nullptr, nullptr,
+     {act<IssueAceCmd<AceCmdOpcode::Evict>>, act<StartTransaction>,
+      act<Consume>},
+     State::E_I},
+
+    // As the cache is write-through, L2 already has an up-to date copy
+    // of the modified data. Upon GetS, the owner is demoted to Shared
+    // and relinquishes ownership and the line becomes Owned (still
+    // dirty with respect to memory). Upon GetE, other copies are
+    // invalidated and the requester becomes owner.
+    {State::M, Event::L1GetS, nullptr, nullptr,
+     {act<DemoteL1<true>>, act<IssueL1Rsp<true>>, act<DelOwner>,
+      act<AddSharer>, act<Consume>},
+     State::O},
+    {State::M, Event::L1GetE, nullptr, nullptr,
+     {act<IssueL1Rsp<false>>, act<InvalidateL1<true>>, act<SetOwner>,
+      act<ClrSharer>, act<Consume>},
+     State::M},
+    // The Put operation simply informs L2 that L1 is removing its
+    // line; hardware may choose to retain the line in the modified
+    // state, but without a designated L1 owner. For simplicity, the
+    // line is written back on the Put.
+    {State::M, Event::L1Put, nullptr, nullptr,
+     {act<IssueAceCmd<AceCmdOpcode::WriteBack>>, act<StartTransaction>,
+      act<Consume>},
+     State::M_I},
+
+    //
+    // Cache controller command responses:
+    //
+
+    // Fill completes; requester holds the line as owner where
+    // installed writeable.
+    {State::I_S, Event::AceCmdRsp, &is_shared_dirty, "is_shared_dirty",
+     {act<IssueL1Rsp<false>>, act<SetOwner>, act<EndTransaction>,
+      act<Consume>},
+     State::O},
+    {State::I_S, Event::AceCmdRsp, &is_unique_clean, "is_unique_clean",
+     {act<IssueL1Rsp<false>>, act<SetOwner>, act<EndTransaction>,
+      act<Consume>},
+     State::E},
+    {State::I_S, Event::AceCmdRsp, nullptr, nullptr,
+     {act<IssueL1Rsp<true>>, act<AddSharer>, act<EndTransaction>,
+      act<Consume>},
+     State::S},
+    // Ownership if receiving dirty data, otherwise Exclusive.
+    {State::I_E, Event::AceCmdRsp, &is_pass_dirty, "is_pass_dirty",
+     {act<IssueL1Rsp<false>>, act<SetOwner>, act<EndTransaction>,
+      act<Consume>},
+     State::O},
+    {State::I_E, Event::AceCmdRsp, nullptr, nullptr,
+     {act<IssueL1Rsp<false>>, act<SetOwner>, act<EndTransaction>,
+      act<Consume>},
+     State::E},
+    // Requester becomes owner; invalidate all other copies of the
+    // line.
+    {State::S_E, Event::AceCmdRsp, nullptr, nullptr,
+     {act<IssueL1Rsp<false>>, act<InvalidateL1<true>>, act<SetOwner>,
+      act<EndTransaction>, act<Consume>},
+     State::E},
+    {State::O_E, Event::AceCmdRsp, nullptr, nullptr,
+     {act<IssueL1Rsp<false>>, act<InvalidateL1<true>>, act<SetOwner>,
+      act<EndTransaction>, act<Consume>},
+     State::E},
+    // Eviction (Evict or WriteBack) completes; inform requester (as
+    // per. AMBA spec. an empty "dummy" response message is returned).
+    // The line is also subsequently removed from the cache.
+    {State::E_I, Event::AceCmdRsp, &is_put, "is_put",
+     {act<IssueL1Rsp<false>>, act<RemoveLine>, act<EndTransaction>,
+      act<Consume>},
+     State::I},
+    {State::M_I, Event::AceCmdRsp, &is_put, "is_put",
+     {act<IssueL1Rsp<false>>, act<RemoveLine>, act<EndTransaction>,
+      act<Consume>},
+     State::I},
+
+    //
+    // C5.3.1 ReadOnce
+    //
+    // Initiating master reads line from target cache but does not
+    // intend to retain a cached copy. As a simplifying factor, we
+    // choose to retain ownership of the line and simply pass the line
+    // in the Shared state when applicable.
+    //
+    {State::I, Event::SnpReadOnce, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<Consume>},
+     State::I},
+    {State::S, Event::SnpReadOnce, nullptr, nullptr,
+     {act<IssueSnpRsp<true, false, true, false>>, act<Consume>},
+     State::S},
+    {State::E, Event::SnpReadOnce, nullptr, nullptr,
+     {act<IssueSnpRsp<true, false, true, false>>, act<Consume>},
+     State::S},
+    {State::M, Event::SnpReadOnce, nullptr, nullptr,
+     {act<IssueSnpRsp<true, false, true, false>>, act<Consume>},
+     State::O},
+    {State::O, Event::SnpReadOnce, nullptr, nullptr,
+     {act<IssueSnpRsp<true, false, true, false>>, act<Consume>},
+     State::O},
+
+    //
+    // C5.3.2 ReadClean, ReadNotSharedDirty
+    //
+    // Bias behavior to retain line over passing ownership.
+    //
+    {State::I, Event::SnpReadClean, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<Consume>},
+     State::I},
+    {State::S, Event::SnpReadClean, nullptr, nullptr,
+     {act<IssueSnpRsp<false, false, true, false>>, act<Consume>},
+     State::S},
+    {State::E, Event::SnpReadClean, nullptr, nullptr,
+     {act<IssueSnpRsp<false, false, true, false>>, act<Consume>},
+     State::S},
+    {State::M, Event::SnpReadClean, nullptr, nullptr,
+     {act<IssueSnpRsp<false, false, true, false>>, act<Consume>},
+     State::O},
+    {State::O, Event::SnpReadClean, nullptr, nullptr,
+     {act<IssueSnpRsp<false, false, true, false>>, act<Consume>},
+     State::O},
+    {State::I, Event::SnpReadNotSharedDirty, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<Consume>},
+     State::I},
+    {State::S, Event::SnpReadNotSharedDirty, nullptr, nullptr,
+     {act<IssueSnpRsp<false, false, true, false>>, act<Consume>},
+     State::S},
+    {State::E, Event::SnpReadNotSharedDirty, nullptr, nullptr,
+     {act<IssueSnpRsp<false, false, true, false>>, act<Consume>},
+     State::S},
+    {State::M, Event::SnpReadNotSharedDirty, nullptr, nullptr,
+     {act<IssueSnpRsp<false, false, true, false>>, act<Consume>},
+     State::O},
+    {State::O, Event::SnpReadNotSharedDirty, nullptr, nullptr,
+     {act<IssueSnpRsp<false, false, true, false>>, act<Consume>},
+     State::O},
+    {State::I_S, Event::SnpReadNotSharedDirty, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<Consume>},
+     State::I_S},
+    {State::I_E, Event::SnpReadNotSharedDirty, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<Consume>},
+     State::I_E},
+    {State::E_I, Event::SnpReadNotSharedDirty, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<Consume>},
+     State::E_I},
+    {State::M_I, Event::SnpReadNotSharedDirty, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<Consume>},
+     State::M_I},
+    {State::S_E, Event::SnpReadNotSharedDirty, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<Consume>},
+     State::S_E},
+    {State::O_E, Event::SnpReadNotSharedDirty, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<Consume>},
+     State::O_E},
+
+    //
+    // C5.3.2 ReadShared
+    //
+    // Line is retained, where present, and demoted to a shared state
+    // both here and in the child L1. The Modified line is retained as
+    // owner.
+    //
+    {State::I, Event::SnpReadShared, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<Consume>},
+     State::I},
+    {State::S, Event::SnpReadShared, nullptr, nullptr,
+     {act<IssueSnpRsp<true, false, true, false>>, act<Consume>},
+     State::S},
+    {State::E, Event::SnpReadShared, nullptr, nullptr,
+     {act<IssueSnpRsp<true, false, true, true>>, act<DemoteL1<false>>,
+      act<Consume>},
+     State::S},
+    {State::M, Event::SnpReadShared, nullptr, nullptr,
+     {act<IssueSnpRsp<true, false, true, true>>, act<DemoteL1<false>>,
+      act<Consume>},
+     State::O},
+    {State::O, Event::SnpReadShared, nullptr, nullptr,
+     {act<IssueSnpRsp<true, false, true, false>>, act<Consume>},
+     State::O},
+    {State::I_S, Event::SnpReadShared, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<Consume>},
+     State::I_S},
+    {State::I_E, Event::SnpReadShared, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<Consume>},
+     State::I_E},
+    {State::E_I, Event::SnpReadShared, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<Consume>},
+     State::E_I},
+    {State::M_I, Event::SnpReadShared, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<Consume>},
+     State::M_I},
+    {State::S_E, Event::SnpReadShared, nullptr, nullptr,
+     {act<IssueSnpRsp<true, false, true, false>>, act<Consume>},
+     State::S_E},
+    {State::O_E, Event::SnpReadShared, nullptr, nullptr,
+     {act<IssueSnpRsp<true, false, true, false>>, act<Consume>},
+     State::O_E},
+
+    //
+    // C.5.3.3 ReadUnique
+    //
+    // Line is passed to the initiator; final state is Invalid.
+    //
+    // Where a transaction is in flight, the line is retained until the
+    // command response arrives: the command is ordered after the snoop
+    // at the home directory and completes as though issued from
+    // Invalid (an outstanding CleanUnique becomes a fill).
+    //
+    {State::I, Event::SnpReadUnique, nullptr, nullptr,
+     {act<IssueSnpRsp<true, false, false, true>>, act<RemoveLine>,
+      act<InvalidateL1<false>>, act<Consume>},
+     State::I},
+    {State::S, Event::SnpReadUnique, nullptr, nullptr,
+     {act<IssueSnpRsp<true, false, false, true>>, act<RemoveLine>,
+      act<InvalidateL1<false>>, act<Consume>},
+     State::I},
+    {State::E, Event::SnpReadUnique, nullptr, nullptr,
+     {act<IssueSnpRsp<true, false, false, true>>, act<RemoveLine>,
+      act<InvalidateL1<false>>, act<Consume>},
+     State::I},
+    {State::M, Event::SnpReadUnique, nullptr, nullptr,
+     {act<IssueSnpRsp<true, true, false, true>>, act<RemoveLine>,
+      act<InvalidateL1<false>>, act<Consume>},
+     State::I},
+    {State::O, Event::SnpReadUnique, nullptr, nullptr,
+     {act<IssueSnpRsp<true, true, false, true>>, act<RemoveLine>,
+      act<InvalidateL1<false>>, act<Consume>},
+     State::I},
+    {State::I_S, Event::SnpReadUnique, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<InvalidateL1<false>>, act<Consume>},
+     State::I_S},
+    {State::I_E, Event::SnpReadUnique, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<InvalidateL1<false>>, act<Consume>},
+     State::I_E},
+    {State::E_I, Event::SnpReadUnique, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<InvalidateL1<false>>, act<Consume>},
+     State::E_I},
+    {State::M_I, Event::SnpReadUnique, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<InvalidateL1<false>>, act<Consume>},
+     State::M_I},
+    {State::S_E, Event::SnpReadUnique, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<InvalidateL1<false>>, act<Consume>},
+     State::I_E},
+    {State::O_E, Event::SnpReadUnique, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<InvalidateL1<false>>, act<Consume>},
+     State::I_E},
+
+    //
+    // C5.3.4 CleanInvalid
+    //
+    // Specificiation recommends that data is transferred only if
+    // present in the dirty state. (The cache would typically not be
+    // snooped in the dirty case as this would be the initiating agent
+    // in the system for the command).
+    //
+    // Transient states are handled as per. ReadUnique.
+    //
+    {State::I, Event::SnpCleanInvalid, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<RemoveLine>, act<InvalidateL1<false>>,
+      act<Consume>},
+     State::I},
+    {State::S, Event::SnpCleanInvalid, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<RemoveLine>, act<InvalidateL1<false>>,
+      act<Consume>},
+     State::I},
+    {State::E, Event::SnpCleanInvalid, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<RemoveLine>, act<InvalidateL1<false>>,
+      act<Consume>},
+     State::I},
+    {State::M, Event::SnpCleanInvalid, nullptr, nullptr,
+     {act<IssueSnpRsp<true, true, false, false>>, act<RemoveLine>,
+      act<InvalidateL1<false>>, act<Consume>},
+     State::I},
+    {State::O, Event::SnpCleanInvalid, nullptr, nullptr,
+     {act<IssueSnpRsp<true, true, false, false>>, act<RemoveLine>,
+      act<InvalidateL1<false>>, act<Consume>},
+     State::I},
+    {State::I_S, Event::SnpCleanInvalid, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<InvalidateL1<false>>, act<Consume>},
+     State::I_S},
+    {State::I_E, Event::SnpCleanInvalid, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<InvalidateL1<false>>, act<Consume>},
+     State::I_E},
+    {State::E_I, Event::SnpCleanInvalid, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<InvalidateL1<false>>, act<Consume>},
+     State::E_I},
+    {State::M_I, Event::SnpCleanInvalid, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<InvalidateL1<false>>, act<Consume>},
+     State::M_I},
+    {State::S_E, Event::SnpCleanInvalid, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<InvalidateL1<false>>, act<Consume>},
+     State::I_E},
+    {State::O_E, Event::SnpCleanInvalid, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<InvalidateL1<false>>, act<Consume>},
+     State::I_E},
+
+    //
+    // C5.3.5 MakeInvalid
+    //
+    // Specification recommands that data is NOT transferred.
+    //
+    // Transient states are handled as per. ReadUnique.
+    //
+    {State::I, Event::SnpMakeInvalid, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<RemoveLine>, act<InvalidateL1<false>>,
+      act<Consume>},
+     State::I},
+    {State::S, Event::SnpMakeInvalid, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<RemoveLine>, act<InvalidateL1<false>>,
+      act<Consume>},
+     State::I},
+    {State::E, Event::SnpMakeInvalid, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<RemoveLine>, act<InvalidateL1<false>>,
+      act<Consume>},
+     State::I},
+    {State::M, Event::SnpMakeInvalid, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<RemoveLine>, act<InvalidateL1<false>>,
+      act<Consume>},
+     State::I},
+    {State::O, Event::SnpMakeInvalid, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<RemoveLine>, act<InvalidateL1<false>>,
+      act<Consume>},
+     State::I},
+    {State::I_S, Event::SnpMakeInvalid, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<InvalidateL1<false>>, act<Consume>},
+     State::I_S},
+    {State::I_E, Event::SnpMakeInvalid, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<InvalidateL1<false>>, act<Consume>},
+     State::I_E},
+    {State::E_I, Event::SnpMakeInvalid, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<InvalidateL1<false>>, act<Consume>},
+     State::E_I},
+    {State::M_I, Event::SnpMakeInvalid, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<InvalidateL1<false>>, act<Consume>},
+     State::M_I},
+    {State::S_E, Event::SnpMakeInvalid, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<InvalidateL1<false>>, act<Consume>},
+     State::I_E},
+    {State::O_E, Event::SnpMakeInvalid, nullptr, nullptr,
+     {act<IssueSnpRspNoData>, act<InvalidateL1<false>>, act<Consume>},
+     State::I_E},
+
+    //
+    // L1 writes to a line which it holds writeable (write-through).
+    //
+    {State::E, Event::SetModified, nullptr, nullptr, {}, State::M},
+    {State::O, Event::SetModified, nullptr, nullptr, {}, State::M},
+    {State::M, Event::SetModified, nullptr, nullptr, {}, State::M},
+}};
+
+constexpr TransitionTable<L2Transition, l2_transitions.size(),
+                          static_cast<std::size_t>(State::X) + 1,
+                          static_cast<std::size_t>(Event::Invalid)>
+    l2_table{l2_transitions};
+
+//
+//
+class MOESIL2CacheProtocol final : public L2CacheAgentProtocol {
  public:
   MOESIL2CacheProtocol(kernel::Kernel* k)
       : L2CacheAgentProtocol(k, "moesil2") {}
@@ -418,19 +1206,39 @@ class MOESIL2CacheProtocol : public L2CacheAgentProtocol {
   //
   //
   void apply(L2CacheContext& ctxt, L2CommandList& cl) const override {
-    LineState* line = static_cast<LineState*>(ctxt.line());
     const Message* msg = ctxt.msg();
-    const MessageClass cls = msg->cls();
-    switch (cls) {
+    switch (msg->cls()) {
       case MessageClass::L2Cmd: {
-        // CPU -> L1 command:
-        apply(ctxt, cl, line, static_cast<const L2CmdMsg*>(ctxt.msg()));
+        // L1 -> L2 command:
+        const L2CmdMsg* cmd = static_cast<const L2CmdMsg*>(msg);
+        // Update Transaction State with data snooped from command
+        // message.
+        L2TState* tstate = ctxt.tstate();
+        tstate->set_addr(cmd->addr());
+        tstate->set_l1cache(cmd->l1cache());
+        tstate->set_opcode(cmd->opcode());
+        ctxt.set_addr(cmd->addr());
+        switch (cmd->opcode()) {
+          case L2CmdOpcode::L1GetS: {
+            dispatch(ctxt, cl, Event::L1GetS);
+          } break;
+          case L2CmdOpcode::L1GetE: {
+            dispatch(ctxt, cl, Event::L1GetE);
+          } break;
+          case L2CmdOpcode::L1Put: {
+            dispatch(ctxt, cl, Event::L1Put);
+          } break;
+          default: {
+            // Invalid command.
+          } break;
+        }
       } break;
       case MessageClass::AceCmdRsp: {
-        apply(ctxt, cl, line, static_cast<const AceCmdRspMsg*>(ctxt.msg()));
+        ctxt.set_addr(ctxt.tstate()->addr());
+        dispatch(ctxt, cl, Event::AceCmdRsp);
       } break;
       case MessageClass::AceSnoop: {
-        apply(ctxt, cl, line, static_cast<const AceSnpMsg*>(ctxt.msg()));
+        apply_snoop(ctxt, cl, static_cast<const AceSnpMsg*>(msg));
       } break;
       default: {
         // Unknown message class; error
@@ -446,472 +1254,56 @@ class MOESIL2CacheProtocol : public L2CacheAgentProtocol {
 
   void set_modified_status(L2CacheContext& ctxt,
                            L2CommandList& cl) const override {
-    LineState* line = static_cast<LineState*>(ctxt.line());
-    switch (line->state()) {
-      case State::M: {
-        LogMessage msg(
-            "Attempt to set modified status of line already in M state.");
-        msg.set_level(Level::Warning);
-        log(msg);
-      }
-        [[fallthrough]];
-      case State::O:
-      case State::E: {
-        // Set modified status of line; should really be in the E
-        // state.  Still valid if performed from the M state but
-        // redundant and suggests that something has gone awry.
-        cl.push_back(line->build_update_state(State::M));
-      } break;
-      default: {
-        LogMessage msg("Unable to set modified state; line is not owned.");
-        msg.set_level(Level::Fatal);
-        log(msg);
-      } break;
+    // Set modified status of line; should really be in the E state.
+    // Still valid if performed from the M state but redundant and
+    // suggests that something has gone awry.
+    const LineState* line = static_cast<const LineState*>(ctxt.line());
+    if (line->state() == State::M) {
+      LogMessage msg(
+          "Attempt to set modified status of line already in M state.");
+      msg.set_level(Level::Warning);
+      log(msg);
     }
-  }
-
- private:
-  void apply(L2CacheContext& ctxt, L2CommandList& cl, LineState* line,
-             const L2CmdMsg* cmd) const {
-    // Update Transaction State with data snooped from command message.
-    L2TState* tstate = ctxt.tstate();
-    tstate->set_addr(cmd->addr());
-    tstate->set_l1cache(cmd->l1cache());
-    tstate->set_opcode(cmd->opcode());
-
-    // Lookup L2 to L1 response queue keyed on origin agent.
-    MessageQueue* l2_l1__rsp_q =
-        ctxt.l2cache()->l2_l1__rsp_q(tstate->l1cache());
-
-    const L2CmdOpcode opcode = cmd->opcode();
-    const State state = line->state();
-    switch (state) {
-      case State::I: {
-        AceCmdMsg* msg = Pool<AceCmdMsg>::construct();
-        msg->set_t(cmd->t());
-        msg->set_addr(cmd->addr());
-        switch (opcode) {
-          case L2CmdOpcode::L1GetS: {
-            // State I; requesting GetS (ie. Shared); issue ReadShared
-            msg->set_opcode(AceCmdOpcode::ReadShared);
-            // Update state
-            cl.push_back(line->build_update_state(State::I_S));
-          } break;
-          case L2CmdOpcode::L1GetE: {
-            // State I; requesting GetE (i.e. Exclusive); issue ReadShared
-            msg->set_opcode(AceCmdOpcode::ReadUnique);
-            // Update state
-            cl.push_back(line->build_update_state(State::I_E));
-          } break;
-          default: {
-          } break;
-        }
-        // Issue ACE command to the cache controller.
-        issue_msg_to_queue(L2EgressQueue::CCCmdQ, cl, ctxt, msg, tstate);
-        // Message is stalled on lookup transaction.
-        // Install new entry in transaction table as the transaction
-        // has now started and commands are inflight. The transaction
-        // itself is not complete at this point.
-        cl.push_back(L2Opcode::StartTransaction);
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      case State::S: {
-        L2CmdRspMsg* msg = Pool<L2CmdRspMsg>::construct();
-        msg->set_t(cmd->t());
-        switch (opcode) {
-          case L2CmdOpcode::L1GetS: {
-            // Add agent to set of sharers
-            cl.push_back(line->build_add_sharer(tstate->l1cache()));
-            // L2 line remains in Shared state
-          } break;
-          case L2CmdOpcode::L1GetE: {
-            // Line is presently Shared in multiple L1. Requester
-            // requests line in Exclusive state. Requester may or may
-            // not already have the line in the Shared state. (TODO:
-            // might be some advantage to model the relative cost of
-            // transport delay in both the have and have-not line
-            // cases).
-            // Requester becomes owner
-            cl.push_back(line->build_set_owner(tstate->l1cache()));
-            // Invalid all other copies of line.
-            issue_set_l1_invalid_except(cl, ctxt.addr(), tstate->l1cache());
-            // Line becomes Exclusive
-            cl.push_back(line->build_update_state(State::E));
-          } break;
-          default: {
-          } break;
-        }
-        // Issue response back to requester.
-        issue_msg_to_queue(L2EgressQueue::L1RspQ, cl, ctxt, msg, tstate);
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      case State::O: {
-        switch (opcode) {
-          case L2CmdOpcode::L1GetS: {
-            // L2 currently has a dirty copy of the line in its cache
-            // and can therefore immediately service a request for a
-            // line in the S state. Issue response and add requester
-            // to set of sharers.
-
-            // TODO: sharer state.
-            // TODO: L1 should be in the context state at this point.
-
-          } break;
-          case L2CmdOpcode::L1GetE: {
-            // L2 has line in Owning state, but must first promote the
-            // line to the exclusive state. L2 already has the data it
-            // requires
-
-            // L2 already has the line, therefore simply issue a
-            // CleanUnique command to invalidate other copies within
-            // the system.
-            AceCmdMsg* msg = Pool<AceCmdMsg>::construct();
-            msg->set_t(cmd->t());
-            msg->set_addr(cmd->addr());
-            msg->set_opcode(AceCmdOpcode::CleanUnique);
-            issue_msg_to_queue(L2EgressQueue::CCCmdQ, cl, ctxt, msg);
-            // Update state: transitional Owner to Exclusive.
-            cl.push_back(line->build_update_state(State::O_E));
-            // Command initiates a transaction, therefore consume the
-            // message and install a new transaction object in the
-            // transaction table.
-            cl.push_back(L2Opcode::StartTransaction);
-            // Consume and advance
-            cl.next_and_do_consume(true);
-          } break;
-          default: {
-          } break;
-        }
-      } break;
-      case State::E: {
-        const bool requester_is_owner = false;
-        if (!requester_is_owner) {
-          switch (opcode) {
-            case L2CmdOpcode::L1GetS: {
-              // Demote line in owner to Shared state, add requester to
-              // set of sharers
-              L2CmdRspMsg* msg = Pool<L2CmdRspMsg>::construct();
-              msg->set_t(cmd->t());
-              // L1 lines become sharers
-              issue_set_l1_shared_except(cl, ctxt.addr(), tstate->l1cache());
-              // Requester becomes sharer.
-              msg->set_is(true);
-              // No longer owning, therefore delete owner pointer.
-              cl.push_back(line->build_del_owner());
-              cl.push_back(line->build_add_sharer(tstate->l1cache()));
-              // Line becomes Shared
-              cl.push_back(line->build_update_state(State::S));
-              // Issue response to L1.
-              issue_msg_to_queue(L2EgressQueue::L1RspQ, cl, ctxt, msg, tstate);
-            } break;
-            case L2CmdOpcode::L1GetE: {
-              L2CmdRspMsg* msg = Pool<L2CmdRspMsg>::construct();
-              msg->set_t(cmd->t());
-              // Requester becomes owner
-              msg->set_is(false);
-              // L1 lines become sharers
-              issue_set_l1_invalid_except(cl, ctxt.addr(), tstate->l1cache());
-              // Requester becomes owner
-              cl.push_back(line->build_set_owner(tstate->l1cache()));
-              // Line remains in Exclusive state
-              // Issue response to L1.
-              issue_msg_to_queue(L2EgressQueue::L1RspQ, cl, ctxt, msg, tstate);
-            } break;
-            case L2CmdOpcode::L1Put: {
-              const bool opt_silently_evict = false;
-              if (!opt_silently_evict) {
-                // Issue eviction notification to home directory. Line
-                // is not modified therefore no Write command is
-                // required.
-                // Issue Evict command to home directory.
-                AceCmdMsg* msg = Pool<AceCmdMsg>::construct();
-                msg->set_t(cmd->t());
-                msg->set_addr(cmd->addr());
-                msg->set_opcode(AceCmdOpcode::Evict);
-                issue_msg_to_queue(L2EgressQueue::CCCmdQ, cl, ctxt, msg);
-                // Transition to Exclusive -> Invalid state; awaiting
-                // receipt of AceCmdRspMsg for the Evict.
-                cl.push_back(line->build_update_state(State::E_I));
-                // Current command commits:
-                cl.push_back(L2Opcode::StartTransaction);
-              } else {
-                // Silently evict the cache line; line is clean with
-                // respect to memory therefore no writeback required.
-              }
-            } break;
-            default: {
-              // Unknown command
-            } break;
-          }
-          // Consume and advance
-          cl.next_and_do_consume(true);
-        } else {
-          // Otherwise, somehow received a message from the owner
-          // which (although unexpected) probably okay if not
-          // redundant. Command completes immediately as it is simply
-          // a NOP.
-          L2CmdRspMsg* msg = Pool<L2CmdRspMsg>::construct();
-          msg->set_t(cmd->t());
-          issue_msg_to_queue(L2EgressQueue::L1RspQ, cl, ctxt, msg, tstate);
-          // Consume and advance
-          cl.next_and_do_consume(true);
-        }
-      } break;
-      case State::M: {
-        const bool requester_is_owner = false;
-        if (!requester_is_owner) {
-          switch (opcode) {
-            case L2CmdOpcode::L1GetS: {
-              // Requester requests line in the Shared state. Owning
-              // agent can retain line, but must demote the line from
-              // the Modified to Shared state. As the cache is
-              // write-through, L2 already has an up-to date copy of
-              // the modified data therefore we can simply modify the
-              // state in the owners L1.
-
-              // Issue response to requester.
-              L2CmdRspMsg* msg = Pool<L2CmdRspMsg>::construct();
-              msg->set_t(cmd->t());
-              msg->set_is(true);
-              issue_msg_to_queue(L2EgressQueue::L1RspQ, cl, ctxt, msg, tstate);
-              // Current owner L1 relinqushes ownership.
-              cl.push_back(line->build_del_owner());
-              // Add current requester to set of sharers for this
-              // line.
-              cl.push_back(line->build_add_sharer(tstate->l1cache()));
-              // State becomes Owned (still dirty with respect to
-              // memory).
-              cl.push_back(line->build_update_state(State::O));
-            } break;
-            case L2CmdOpcode::L1GetE: {
-              // Requester requests line in the Exclusive
-              // state. Owning cache must relinquish line and invalid
-              // its copy. Again, as the cache is write-through, L2
-              // already has the most recent state in its memory.
-              // Line is owned by requester
-
-              // Issue response to requester.
-              L2CmdRspMsg* msg = Pool<L2CmdRspMsg>::construct();
-              msg->set_t(cmd->t());
-              msg->set_is(false);
-              issue_msg_to_queue(L2EgressQueue::L1RspQ, cl, ctxt, msg, tstate);
-              // Invalidate L1 copies.
-              issue_set_l1_invalid_except(cl, ctxt.addr(), tstate->l1cache());
-              // Requester becomes owner
-              cl.push_back(line->build_set_owner(tstate->l1cache()));
-              // State remains modified.
-              cl.push_back(line->build_clr_sharer());
-            } break;
-            case L2CmdOpcode::L1Put: {
-              // The line is Modified and therefore resides in only
-              // one L1.
-              //
-              // Discussion:
-              //
-              // The Put operation simply informs L2 that L1 is
-              // removing its line, it does not necessarily invoke a
-              // writeback operation as hardware may choose to retain
-              // the line in the modified state, but without a
-              // designated L1 owner. Only once the line is itself
-              // evicted from L2 will the line be written back. For
-              // simplicity, we choose to evict the line on tht Put.
-              //
-              const bool writeback_on_put = true;
-              if (writeback_on_put) {
-                // Issue Writeback transaction to home directory.
-                AceCmdMsg* msg = Pool<AceCmdMsg>::construct();
-                msg->set_t(cmd->t());
-                msg->set_addr(cmd->addr());
-                msg->set_opcode(AceCmdOpcode::WriteBack);
-                issue_msg_to_queue(L2EgressQueue::CCCmdQ, cl, ctxt, msg,
-                                   tstate);
-                // Update state Modified -> Invalid
-                cl.push_back(line->build_update_state(State::M_I));
-                // Current command commits:
-                cl.push_back(L2Opcode::StartTransaction);
-              } else {
-                // Retain line, but L1 is no longer an owner. Line is
-                // now orphaned and owned by the L2.
-                cl.push_back(line->build_del_owner());
-              }
-            } break;
-            default: {
-            } break;
-          }
-          // Consume and advance
-          cl.next_and_do_consume(true);
-        } else {
-          // Otherwise, requester is currently owner.
-          L2CmdRspMsg* msg = Pool<L2CmdRspMsg>::construct();
-          msg->set_t(cmd->t());
-          issue_msg_to_queue(L2EgressQueue::L1RspQ, cl, ctxt, msg, tstate);
-          // Consume and advance
-          cl.next_and_do_consume(true);
-        }
-      } break;
-      default: {
-      } break;
+    if (!dispatch(ctxt, cl, Event::SetModified)) {
+      LogMessage msg("Unable to set modified state; line is not owned.");
+      msg.set_level(Level::Fatal);
+      log(msg);
     }
   }
 
-  void apply(L2CacheContext& ctxt, L2CommandList& cl, LineState* line,
-             const AceCmdRspMsg* msg) const {
-    L2TState* tstate = ctxt.tstate();
-    // Lookup L2 to L1 response queue keyed on origin agent.
-    MessageQueue* l2_l1__rsp_q =
-        ctxt.l2cache()->l2_l1__rsp_q(tstate->l1cache());
-
-    const L2CmdOpcode opcode = tstate->opcode();
-    const State state = line->state();
-    switch (state) {
-      case State::I_S: {
-        L2CmdRspMsg* rsp = Pool<L2CmdRspMsg>::construct();
-        rsp->set_t(msg->t());
-        // Always sending to the zeroth L1
-        issue_msg_to_queue(L2EgressQueue::L1RspQ, cl, ctxt, rsp, tstate);
-        // Compute final line state
-        const bool is = msg->is(), pd = msg->pd();
-        if (is && pd) {
-          rsp->set_is(false);
-          cl.push_back(line->build_update_state(State::O));
-        } else if (!is && !pd) {
-          rsp->set_is(false);
-          cl.push_back(line->build_update_state(State::E));
-        } else {
-          rsp->set_is(true);
-          cl.push_back(line->build_update_state(State::S));
-        }
-        // Transaction complete
-        cl.push_back(L2Opcode::EndTransaction);
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      case State::I_E: {
-        // Transition to Exclusive state
-        L2CmdRspMsg* rsp = Pool<L2CmdRspMsg>::construct();
-        rsp->set_t(msg->t());
-        rsp->set_is(false);
-        // Always sending to the zeroth L1
-        issue_msg_to_queue(L2EgressQueue::L1RspQ, cl, ctxt, rsp, tstate);
-        // Compute final line state
-        if (msg->is()) {
-          // Throw error cannot receive in the shared state.
-        }
-        // Compute next state; expect !is_shared, Ownership if recieving
-        // dirty data otherwise Exclusive.
-        const State next_state = msg->pd() ? State::O : State::E;
-        cl.push_back(line->build_update_state(next_state));
-        // Transaction complete
-        cl.push_back(L2Opcode::EndTransaction);
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      case State::O_E: {
-        // TODO: should perform some additional qualificiation on the command
-        // type.
-
-        L2CmdRspMsg* rsp = Pool<L2CmdRspMsg>::construct();
-        rsp->set_t(msg->t());
-        // Always sending to the zeroth L1
-        issue_msg_to_queue(L2EgressQueue::L1RspQ, cl, ctxt, rsp, tstate);
-        // Update state
-        cl.push_back(line->build_update_state(State::E));
-        // Transaction complete
-        cl.push_back(L2Opcode::EndTransaction);
-        // Consume and advance
-        cl.next_and_do_consume(true);
-      } break;
-      case State::E_I: {
-        // Exclusive -> Invalid:
-        //
-        // Edge from Exclusive to Invalid state; in response from an
-        // eviction request from a line in the Exclusive state. Edge
-        // cannot be entered from a Write{Back,Clean} transaction as
-        // this would imply that the line was dirty.
-        //
-        // Response received from home directory indicating that line
-        // has now been evicted.
-        switch (opcode) {
-          case L2CmdOpcode::L1Put: {
-            // Inform L2 requestor (as per. AMBA spec. a empty "dummy"
-            // response message is returned."
-            L2CmdRspMsg* rsp = Pool<L2CmdRspMsg>::construct();
-            rsp->set_t(msg->t());
-            issue_msg_to_queue(L2EgressQueue::L1RspQ, cl, ctxt, rsp, tstate);
-
-            // Line becomes Invalid in the cache. The line is also
-            // subsequently removed from the cache.
-            cl.push_back(line->build_update_state(State::I));
-            cl.push_back(L2Opcode::RemoveLine);
-
-            // Transaction ends
-            cl.push_back(L2Opcode::EndTransaction);
-            // Consume and advance
-            cl.next_and_do_consume(true);
-          } break;
-          default: {
-          } break;
-        }
-      } break;
-      case State::M_I: {
-        // Modified -> Invalid
-        //
-        // In response to a WriteBack transaction.
-        switch (opcode) {
-          case L2CmdOpcode::L1Put: {
-            // Inform L2 requestor (as per. AMBA spec. a empty "dummy"
-            // response message is returned."
-            L2CmdRspMsg* rsp = Pool<L2CmdRspMsg>::construct();
-            rsp->set_t(msg->t());
-            issue_msg_to_queue(L2EgressQueue::L1RspQ, cl, ctxt, rsp, tstate);
-
-            // Line becomes Invalid in the cache. The line is also
-            // subsequently removed from the cache.
-            cl.push_back(line->build_update_state(State::I));
-            cl.push_back(L2Opcode::RemoveLine);
-
-            // Transaction ends
-            cl.push_back(L2Opcode::EndTransaction);
-            // Consume and advance
-            cl.next_and_do_consume(true);
-          } break;
-          default: {
-          } break;
-        }
-      } break;
-      default: {
-      } break;
-    }
-  }
-
-  void apply(L2CacheContext& ctxt, L2CommandList& cl, LineState* line,
-             const AceSnpMsg* msg) const {
+ private:
+  void apply_snoop(L2CacheContext& ctxt, L2CommandList& cl,
+                   const AceSnpMsg* msg) const {
     ctxt.set_addr(msg->addr());
-    const AceSnpOpcode opcode = msg->opcode();
-    switch (opcode) {
+    if (ctxt.silently_evicted()) {
+      // Line is not present in the cache.
+      handle_snp_absent(ctxt, cl, msg);
+      return;
+    }
+    switch (msg->opcode()) {
       case AceSnpOpcode::ReadOnce: {
+        dispatch(ctxt, cl, Event::SnpReadOnce);
       } break;
       case AceSnpOpcode::ReadClean: {
+        dispatch(ctxt, cl, Event::SnpReadClean);
       } break;
       case AceSnpOpcode::ReadShared: {
-        handle_snp_read_shared(ctxt, cl, msg);
+        dispatch(ctxt, cl, Event::SnpReadShared);
       } break;
       case AceSnpOpcode::ReadNotSharedDirty: {
-        handle_snp_read_not_shared_dirty(ctxt, cl, msg);
+        dispatch(ctxt, cl, Event::SnpReadNotSharedDirty);
       } break;
       case AceSnpOpcode::ReadUnique: {
-        handle_snp_read_unique(ctxt, cl, msg);
+        dispatch(ctxt, cl, Event::SnpReadUnique);
       } break;
       case AceSnpOpcode::CleanInvalid: {
-        handle_snp_clean_invalid(ctxt, cl, msg);
+        dispatch(ctxt, cl, Event::SnpCleanInvalid);
       } break;
       case AceSnpOpcode::MakeInvalid: {
-        handle_snp_make_invalid(ctxt, cl, msg);
+        dispatch(ctxt, cl, Event::SnpMakeInvalid);
       } break;
       case AceSnpOpcode::CleanShared: {
-        handle_snp_clean_shared(ctxt, cl, msg);
+        // TODO
       } break;
       default: {
         LogMessage lm("Unknown opcode received: ");
@@ -922,475 +1314,36 @@ class MOESIL2CacheProtocol : public L2CacheAgentProtocol {
     }
   }
 
-    // C5.3.1 ReadOnce
-  //
-  // Initiating master reads line from target cache but does not
-  // intend to retain a cached copy.
-  //
-  // This command can pass ownership of the cache line to the
-  // intiating agent. The spec. recommends that the line be
-  // transferred and that if dirty, the line passed in a clean
-  // state. This incurs some added complexity. Instead, as a
-  // simplifying factor, we choose to retain ownership of the line and
-  // simply pass the line in the Shared state when applicable.
-  //
-  void handle_snp_read_once(L2CacheContext& ctxt, L2CommandList& cl,
-                            const AceSnpMsg* msg) const {
-    LineState* line = static_cast<LineState*>(ctxt.line());
-
-    // "If the snooped master has a copy of the cache line, then this
-    // specification recommends that data is transferred. If the
-    // snooped master has the cache line in a Dirty state, then data
-    // must be transferred."
-    AceSnpRspMsg* rsp = Pool<AceSnpRspMsg>::construct();
-    rsp->set_t(msg->t());
-    State next_state = State::X;
-    const State state = line->state();
-    switch (state) {
-      case State::I: {
-        rsp->set_dt(false);
-      } break;
-      case State::S: {
-        rsp->set_dt(true);
-        rsp->set_is(true);
-      } break;
-      case State::M: {
-        // Spec. implies we should emit a Write{Clean, Back} here and
-        // reject current message until operation has completed.
-        
-        // Snooped agent becomes owner.
-        next_state = State::O;
-        rsp->set_dt(true);
-        rsp->set_is(true);
-      } break;
-      case State::O: {
-        // Spec. implies we should emit a Write{Clean, Back} here and
-        // reject current message until operation has completed.
-
-        rsp->set_dt(true);
-        rsp->set_is(true);
-      } break;
-      case State::E: {
-        // Snooped agent becomes sharer; line remains clean
-        next_state = State::S;
-        rsp->set_dt(true);
-        rsp->set_is(true);
-      } break;
-      default: {
-        // Otherwise, trapped in transitional state limbo. Must block
-        // until prior transaction has completed.
-      } break;
-    }
-    if (next_state != state) {
-      // Transition to new state.
-      cl.push_back(line->build_update_state(next_state));
-    }
-    // Issue message
-    issue_msg_to_queue(L2EgressQueue::CCSnpRspQ, cl, ctxt, rsp);
-    // Consume and advance
-    cl.next_and_do_consume(true);
-  }
-
-  // C5.3.2 ReadClean
-  //
-  // "For a ReadClean snoop transaction, if the responsibility for
-  // writing the cache line back to main memory is being passed to the
-  // interconnect, as indicated by the PassDirty snoop response being
-  // asserted, the cache line is written back to main memory
-  // immediately. This specification recommends that the cache line
-  // remains Dirty in the snooped cache."
-  //
-  void handle_snp_read_clean(L2CacheContext& ctxt, L2CommandList& cl,
-                             const AceSnpMsg* msg) const {
-    LineState* line = static_cast<LineState*>(ctxt.line());
-
-    // Bias behavior to retain line over passing ownership.
+  // Snoop to a line which is not present; respond without data such
+  // that the directory removes the agent from the line's sharers.
+  void handle_snp_absent(L2CacheContext& ctxt, L2CommandList& cl,
+                         const AceSnpMsg* msg) const {
     AceSnpRspMsg* rsp = Pool<AceSnpRspMsg>::construct();
     rsp->set_t(msg->t());
-    State next_state = State::X;
-    const State state = line->state();
-    switch (state) {
-      case State::I: {
-        rsp->set_dt(false);
-      } break;
-      case State::S: {
-        rsp->set_is(true);
-      } break;
-      case State::M: {
-        next_state = State::O;
-        rsp->set_is(true);
-      } break;
-      case State::O: {
-        rsp->set_is(true);
-      } break;
-      case State::E: {
-        next_state = State::S;
-        rsp->set_is(true);
-      } break;
-      default: {
-      } break;
-    }
-    if (next_state != state) {
-      // Transition to new state.
-      cl.push_back(line->build_update_state(next_state));
-    }
-    // Issue message
-    issue_msg_to_queue(L2EgressQueue::CCSnpRspQ, cl, ctxt, rsp);
-    // Consume and advance
-    cl.next_and_do_consume(true);
-  }
-
-  // C5.3.2 ReadShared
-  void handle_snp_read_shared(L2CacheContext& ctxt, L2CommandList& cl,
-                              const AceSnpMsg* msg) const {
-    LineState* line = static_cast<LineState*>(ctxt.line());
-    AceSnpRspMsg* rsp = Pool<AceSnpRspMsg>::construct();
-    rsp->set_t(msg->t());
-    // In the siliently evicted case, there is no line.
-    const State state = ctxt.silently_evicted() ? State::I : line->state();
-    switch (state) {
-      case State::I: {
-        // Dir thinks cache has the line, but it doesn't. Line
-        // must have been siliently evicted.
-        rsp->set_dt(false);
-      } break;
-      case State::E: {
-        // Demote to S or evict (I); dt or not dt.
-        const bool retain = true;
-        const bool dt = true;
-        if (retain) {
-          rsp->set_dt(dt);
-          rsp->set_pd(false);
-          rsp->set_is(true);
-          rsp->set_wu(true);
-          // Demote line to Shared state.
-          cl.push_back(line->build_update_state(State::S));
-          // Denote child L1 caches to Shared State, too.
-          issue_set_l1_shared_except(cl, msg->addr());
-        } else {
-          // Relinquish line.
-          rsp->set_dt(true);
-          rsp->set_pd(false);
-          rsp->set_is(false);
-          rsp->set_wu(true);
-          // Demote line to S state.
-          cl.push_back(line->build_update_state(State::I));
-          // Delete line from cache
-          cl.push_back(L2Opcode::RemoveLine);
-          // Invalidate L1 child caches
-          issue_set_l1_invalid_except(cl, msg->addr());
-        }
-      } break;
-      case State::S: {
-        // Retain S or evict (I); dt or not dt.
-        const bool retain = true;
-        const bool dt = true;
-
-        rsp->set_dt(dt);
-        rsp->set_pd(false);
-        rsp->set_is(retain);
-        rsp->set_wu(false);
-        if (!retain) {
-          // Cache has opted to relinquish line; it could have
-          // opted to retain it.
-          // Update state line becomes invalid,
-          cl.push_back(line->build_update_state(State::I));
-          // Delete line from cache
-          cl.push_back(L2Opcode::RemoveLine);
-          // Invalid L1
-          issue_set_l1_invalid_except(cl, msg->addr());
-        }
-      } break;
-      case State::M: {
-        // Options:
-        //
-        //  1. Retain as owner
-        //
-        //  2. Evict and pass ownership.
-
-        const bool retain_as_owner = true;
-
-        if (retain_as_owner) {
-          rsp->set_dt(true);
-          rsp->set_pd(false);
-          rsp->set_is(true);
-          rsp->set_wu(true);
-
-          cl.push_back(line->build_update_state(State::O));
-
-          // Write-through cache, demote lines back to shared
-          // state.
-          issue_set_l1_shared_except(cl, msg->addr());
-        } else {
-          rsp->set_dt(true);
-          rsp->set_pd(true);
-          rsp->set_is(false);
-          rsp->set_wu(true);
-
-          cl.push_back(line->build_update_state(State::I));
-          cl.push_back(L2Opcode::RemoveLine);
-
-          // Write-through cache, therefore immediately evict
-          // lines from child L1 cache.
-          issue_set_l1_invalid_except(cl, msg->addr());
-        }
-      } break;
-      default: {
-        // TODO: decide what to do here.
-      } break;
-    }
+    rsp->set_dt(false);
+    rsp->set_pd(false);
+    rsp->set_is(false);
+    rsp->set_wu(false);
     // Issue response to CC.
-    L2CacheAgent* l2cache = ctxt.l2cache();
     issue_msg_to_queue(L2EgressQueue::CCSnpRspQ, cl, ctxt, rsp);
     // Consume and advance
     cl.next_and_do_consume(true);
   }
 
-  // C5.3.2 ReadSharedNotDirty
-  //
-  // As in ReadShared case, but with the added constraint that the
-  // intiating master cannot accept the line in a dirty, ownership
-  // state.
-  //
-  void handle_snp_read_not_shared_dirty(L2CacheContext& ctxt,
-                                        L2CommandList& cl,
-                                        const AceSnpMsg* msg) const {
+  // Lookup and apply transition for 'event' in the line's current
+  // state. Returns false if no transition is defined.
+  bool dispatch(L2CacheContext& ctxt, L2CommandList& cl, Event event) const {
     LineState* line = static_cast<LineState*>(ctxt.line());
-
-    // Bias behavior to retain line over passing ownership.
-    AceSnpRspMsg* rsp = Pool<AceSnpRspMsg>::construct();
-    rsp->set_t(msg->t());
-    State next_state = State::X;
+    TransitionArgs args{ctxt, cl, line};
     const State state = line->state();
-    switch (state) {
-      case State::I: {
-        rsp->set_dt(false);
-      } break;
-      case State::S: {
-        rsp->set_is(true);
-      } break;
-      case State::M: {
-        next_state = State::O;
-        rsp->set_is(true);
-      } break;
-      case State::O: {
-        rsp->set_is(true);
-      } break;
-      case State::E: {
-        next_state = State::S;
-        rsp->set_is(true);
-      } break;
-      default: {
-      } break;
-    }
-    if (next_state != state) {
-      // Transition to new state.
-      cl.push_back(line->build_update_state(next_state));
-    }
-    // Issue message
-    issue_msg_to_queue(L2EgressQueue::CCSnpRspQ, cl, ctxt, rsp);
-    // Consume and advance
-    cl.next_and_do_consume(true);
-  }  
-
-  // C.5.3.3 ReadUnique
-  //
-  //
-  void handle_snp_read_unique(L2CacheContext& ctxt, L2CommandList& cl,
-                              const AceSnpMsg* msg) const {
-    LineState* line = static_cast<LineState*>(ctxt.line());
-    AceSnpRspMsg* rsp = Pool<AceSnpRspMsg>::construct();
-    rsp->set_t(msg->t());
-    // C5.3.3 ReadUnique
-    switch (line->state()) {
-      case State::I:
-      case State::S:
-      case State::E: {
-        rsp->set_dt(true);
-        rsp->set_pd(false);
-        rsp->set_is(false);
-        rsp->set_wu(true);
-      } break;
-      case State::O:
-      case State::M: {
-        rsp->set_dt(true);
-        rsp->set_pd(true);
-        rsp->set_is(false);
-        rsp->set_wu(true);
-        // Transition back to invalid state, line is gone.
-      } break;
-      default: {
-        // TODO: figure out transient states.
-      } break;
-    }
-    // Issue response to CC.
-    L2CacheAgent* l2cache = ctxt.l2cache();
-    issue_msg_to_queue(L2EgressQueue::CCSnpRspQ, cl, ctxt, rsp);
-    // Final state is Invalid
-    cl.push_back(line->build_update_state(State::I));
-    cl.push_back(L2Opcode::RemoveLine);
-    issue_set_l1_invalid_except(cl, msg->addr());
-    // Consume and advance
-    cl.next_and_do_consume(true);
-  }
-
-  // C5.3.4 CleanInvalid
-  //
-  // Specificiation recommends that data is transferred only if
-  // present in the dirty state. (The cache would typically not
-  // be snooped in the dirty case as this would be the
-  // initiating agent in the system for the command).
-  void handle_snp_clean_invalid(L2CacheContext& ctxt, L2CommandList& cl,
-                                const AceSnpMsg* msg) const {
-    handle_snp_make_invalid(ctxt, cl, msg);
-  }
-
-  // C5.3.5 MakeInvalid
-  //
-  // Specification recommands that data is NOT transferred.
-  void handle_snp_make_invalid(L2CacheContext& ctxt, L2CommandList& cl,
-                               const AceSnpMsg* msg) const {
-    LineState* line = static_cast<LineState*>(ctxt.line());
-    // Form snoop response
-    AceSnpRspMsg* rsp = Pool<AceSnpRspMsg>::construct();
-    rsp->set_t(msg->t());
-    switch (const State state = line->state(); state) {
-      case State::O:
-      case State::M: {
-        if (msg->opcode() != AceSnpOpcode::MakeInvalid) {
-          // Transfer data in the CleanInvalid case.
-          rsp->set_dt(true);
-          rsp->set_pd(true);
-        }
-      } [[fallthrough]];
-      case State::I:
-      case State::S:
-      case State::E: {
-        cl.push_back(line->build_update_state(State::I));
-      } break;
-      default: {
-        // TODO
-      } break;
-    }
-    // Issue response to CC.
-    issue_msg_to_queue(L2EgressQueue::CCSnpRspQ, cl, ctxt, rsp);
-    // Final state is Invalid
-    cl.push_back(line->build_update_state(State::I));
-    cl.push_back(L2Opcode::RemoveLine);
-    issue_set_l1_invalid_except(cl, msg->addr());
-    // Consume and advance
-    cl.next_and_do_consume(true);
-  }
-
-  void handle_snp_clean_shared(L2CacheContext& ctxt, L2CommandList& cl,
-                               const AceSnpMsg* msg) const {
-  }
-
-  template <typename... AGENT>
-  void issue_set_l1_invalid_except(L2CommandList& cl, addr_t addr,
-                                   AGENT... excluded) const {
-    // Issue L1 invalidate of current line, but add "agent" to set of
-    // keep out agents. The command therefore allows agent to retain
-    // the line whereas all other will be invalidated.
-    L2Command* cmd = L2CommandBuilder::from_opcode(L2Opcode::SetL1LinesInvalid);
-    cmd->set_addr(addr);
-    if constexpr (sizeof...(excluded) != 0) {
-      std::vector<L1CacheAgent*>& agents = cmd->agents();
-      for (const auto& agent : {excluded...}) {
-        agents.push_back(agent);
-      }
-    }
-    cl.push_back(cmd);
-  }
+    const L2Transition* t = l2_table.lookup(state, event, args);
+    if (t == nullptr) return false;
 
-  template <typename... AGENT>
-  void issue_set_l1_shared_except(L2CommandList& cl, addr_t addr,
-                                  AGENT... excluded) const {
-    // Demote L1 lines to Shared except Agents contains with in the
-    // excluded set.
-    L2Command* cmd = L2CommandBuilder::from_opcode(L2Opcode::SetL1LinesShared);
-    cmd->set_addr(addr);
-    if constexpr (sizeof...(excluded) != 0) {
-      std::vector<L1CacheAgent*>& agents = cmd->agents();
-      for (const auto& agent : {excluded...}) {
-        agents.push_back(agent);
-      }
+    if (t->next != state) {
+      cl.push_back(line->build_update_state(t->next));
     }
-    cl.push_back(cmd);
-  }
-
-  void issue_msg_to_queue(L2EgressQueue eq, L2CommandList& cl,
-                          L2CacheContext& ctxt, const Message* msg,
-                          L2TState* tstate = nullptr) const {
-    struct EmitMessageActionProxy : L2CoherenceAction {
-      EmitMessageActionProxy() = default;
-
-      std::string to_string() const override {
-        KVListRenderer r;
-        r.add_field("action", "emit message");
-        r.add_field("mq", mq_->path());
-        r.add_field("msg", msg_->to_string());
-        return r.to_string();
-      }
-
-      // Setters:
-      void set_eq(L2EgressQueue eq) { eq_ = eq; }
-      void set_mq(MessageQueue* mq) { mq_ = mq; }
-      void set_msg(const Message* msg) { msg_ = msg; }
-
-      void set_resources(L2Resources& r) const override {
-        switch (eq_) {
-          case L2EgressQueue::CCCmdQ: {
-            r.set_cc_cmd_n(r.cc_cmd_n() + 1);
-          } break;
-          case L2EgressQueue::CCSnpRspQ: {
-            r.set_cc_snp_rsp_n(r.cc_snp_rsp_n() + 1);
-          } break;
-          case L2EgressQueue::L1RspQ: {
-            r.set_l1_rsp_n(r.l1_rsp_n() + 1);
-          } break;
-          default: {
-            // No resource requirement.
-          } break;
-        }
-      }
-      //
-      bool execute() override { return mq_->issue(msg_); }
-
-     private:
-      // EgressQueue Id (for resource calculation).
-      L2EgressQueue eq_ = L2EgressQueue::Invalid;
-      // Destination Message Queue.
-      MessageQueue* mq_ = nullptr;
-      // Message to be issued.
-      const Message* msg_ = nullptr;
-    };
-
-    // Construct "issue" message action to be performance message
-    // issue L1/CC to agent.
-    EmitMessageActionProxy* action = new EmitMessageActionProxy;
-    action->set_eq(eq);
-    action->set_msg(msg);
-    MessageQueue* mq = nullptr;
-    switch (eq) {
-      case L2EgressQueue::CCCmdQ: {
-        mq = ctxt.l2cache()->l2_cc__cmd_q();
-      } break;
-      case L2EgressQueue::CCSnpRspQ: {
-        mq = ctxt.l2cache()->l2_cc__snprsp_q();
-      } break;
-      case L2EgressQueue::L1RspQ: {
-        mq = ctxt.l2cache()->l2_l1__rsp_q(tstate->l1cache());
-      } break;
-      default: {
-        LogMessage lm("Unknown Egress Queue: ");
-        lm.append(to_string(eq));
-        log(lm);
-      } break;
-    }
-    action->set_mq(mq);
-    // Schedule current issue action in current command list.
-    cl.push_back(L2CommandBuilder::from_action(action));
+    t->invoke(args);
+    return true;
   }
 };
 
@@ -1402,4 +1355,15 @@ L2CacheAgentProtocol* build_l2_protocol(kernel::Kernel* k) {
   return new MOESIL2CacheProtocol(k);
 }
 
+//
+//
+L2CacheAgent* build_l2_agent(kernel::Kernel* k,
+                             const L2CacheAgentConfig& config) {
+  return new L2CacheAgentT<MOESIL2CacheProtocol>(k, config);
+}
+
+//
+//
+std::string render_l2_transitions() { return render_transitions(l2_table); }
+
 }  // namespace cc::moesi
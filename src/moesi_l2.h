@@ -28,10 +28,14 @@
 #ifndef CC_SRC_MOESI_L2_H
 #define CC_SRC_MOESI_L2_H
 
+#include <string>
+
 namespace cc {
 
 class L2CacheAgentProtocol;
 
+class L2CacheAgent;
+struct L2CacheAgentConfig;
 namespace kernel {
 class Kernel;
 }
@@ -40,6 +44,13 @@ namespace moesi {
 
 L2CacheAgentProtocol* build_l2_protocol(kernel::Kernel* k);
 
+L2CacheAgent* build_l2_agent(kernel::Kernel* k,
+                             const L2CacheAgentConfig& config);
+
+// Render the L2 protocol transition table as a machine-readable list
+// of {state, event, guard, next} records.
+std::string render_l2_transitions();
+
 }  // namespace moesi
 
 }  // namespace cc
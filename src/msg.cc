@@ -27,12 +27,37 @@
 
 #include "msg.h"
 
+#include <algorithm>
+#include <memory>
 #include <sstream>
 
 #include "utility.h"
 
 namespace cc {
 
+const char* to_string(TransactionStage stage) {
+  switch (stage) {
+    case TransactionStage::L1Miss:
+      return "L1Miss";
+    case TransactionStage::L2Miss:
+      return "L2Miss";
+    case TransactionStage::CohSrt:
+      return "CohSrt";
+    case TransactionStage::DirAccept:
+      return "DirAccept";
+    case TransactionStage::SnoopIssue:
+      return "SnoopIssue";
+    case TransactionStage::Fill:
+      return "Fill";
+    case TransactionStage::CohEnd:
+      return "CohEnd";
+    case TransactionStage::L1Rsp:
+      return "L1Rsp";
+    default:
+      return "Invalid";
+  }
+}
+
 const char* to_string(MessageClass cls) {
   switch (cls) {
     case MessageClass::Invalid:
@@ -125,11 +150,93 @@ MessageClass to_cmd_type(MessageClass cls) {
 
 std::size_t to_epoch_cost(MessageClass cls) { return 1; }
 
-Transaction::Transaction() {
+Transaction::Transaction() { assign_tid(); }
+
+void Transaction::release() const {
+  if (slab_ == nullptr) {
+    delete this;
+    return;
+  }
+  // Slot storage is owned by the slab; return the slot rather than
+  // destruct.
+  Transaction* t = const_cast<Transaction*>(this);
+  if (slab_->is_inflight(t)) slab_->free(t);
+}
+
+void Transaction::assign_tid() {
   static std::size_t tid_counter = 0;
   tid_ = tid_counter++;
 }
 
+TransactionSlab::~TransactionSlab() {
+  for (Transaction* chunk : chunks_) {
+    delete[] chunk;
+  }
+}
+
+void TransactionSlab::reserve(std::size_t n) {
+  if (n <= slots_.size()) return;
+
+  const std::size_t chunk_n = n - slots_.size();
+  Transaction* chunk = new Transaction[chunk_n];
+  chunks_.push_back(chunk);
+  // Thread new slots onto the free list, in handle order.
+  for (std::size_t i = chunk_n; i > 0; i--) {
+    Transaction* t = std::addressof(chunk[i - 1]);
+    t->handle_ = static_cast<transaction_handle_t>(slots_.size() + i - 1);
+    t->slab_ = this;
+    t->next_ = free_;
+    free_ = t;
+  }
+  for (std::size_t i = 0; i < chunk_n; i++) {
+    slots_.push_back(std::addressof(chunk[i]));
+  }
+}
+
+Transaction* TransactionSlab::allocate() {
+  if (free_ == nullptr) {
+    // Slab exhausted; double capacity.
+    reserve(std::max<std::size_t>(1, 2 * slots_.size()));
+  }
+  Transaction* t = free_;
+  free_ = t->next_;
+  t->assign_tid();
+  t->start_time_ = kernel::Time{};
+  t->stamped_ = 0;
+  t->inflight_ = true;
+  // Append to in-flight list.
+  t->prev_ = tail_;
+  t->next_ = nullptr;
+  if (tail_ != nullptr) {
+    tail_->next_ = t;
+  } else {
+    head_ = t;
+  }
+  tail_ = t;
+  ++inflight_n_;
+  return t;
+}
+
+void TransactionSlab::free(Transaction* t) {
+  // Unlink from in-flight list.
+  if (t->prev_ != nullptr) {
+    t->prev_->next_ = t->next_;
+  } else {
+    head_ = t->next_;
+  }
+  if (t->next_ != nullptr) {
+    t->next_->prev_ = t->prev_;
+  } else {
+    tail_ = t->prev_;
+  }
+  --inflight_n_;
+  // Return to free list.
+  t->inflight_ = false;
+  t->prev_ = nullptr;
+  t->next_ = free_;
+  free_ = t;
+}
+
 std::string Transaction::to_string() const {
   using std::to_string;
 
@@ -28,7 +28,10 @@
 #ifndef CC_SRC_MSG_H
 #define CC_SRC_MSG_H
 
+#include <array>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "cc/kernel.h"
 #include "cc/types.h"
@@ -180,6 +183,10 @@ enum class MessageClass {
   DtRsp
 };
 
+// Number of message classes.
+inline constexpr std::size_t message_class_n =
+    static_cast<std::size_t>(MessageClass::DtRsp) + 1;
+
 // Convert MessageClass type to a human-readable string.
 const char* to_string(MessageClass cls);
 
@@ -243,12 +250,55 @@ class Message {
   Agent* origin_ = nullptr;
 };
 
+// Dense transaction handle: the index of the transaction within the
+// slab of its originating CPU, and therefore bounded by the number of
+// transactions which may be in flight at that CPU. Tables private to
+// a single CPU may be indexed directly by handle. Handles are not
+// unique across CPU; consumers which observe transactions from more
+// than one CPU qualify the handle by the CPU index (as in the
+// verification Monitor events), whereas 'tid' remains globally unique.
+using transaction_handle_t = std::uint32_t;
+
+// Points in the memory hierarchy at which a transaction is
+// time-stamped, in the order in which they are typically encountered.
+//
+enum class TransactionStage {
+  // L2 accepts command from L1 (L1 miss).
+  L1Miss,
+  // Cache controller accepts command from L2 (L2 miss).
+  L2Miss,
+  // Directory accepts coherence start.
+  CohSrt,
+  // Directory accepts coherence command.
+  DirAccept,
+  // Cache controller accepts snoop from directory.
+  SnoopIssue,
+  // LLC receives fill from memory.
+  Fill,
+  // Cache controller accepts coherence end.
+  CohEnd,
+  // CPU receives response from L1.
+  L1Rsp,
+
+  // Stage count (not a stage).
+  Invalid
+};
+
+// Convert TransactionStage to a human-readable string.
+const char* to_string(TransactionStage stage);
+
+class TransactionSlab;
+
 //
 //
 class Transaction {
+  friend class TransactionSlab;
+
  public:
   Transaction();
-  virtual void release() const { delete this; }
+  // Return transaction to its owning slab, or destruct if the
+  // transaction was not allocated from a slab.
+  virtual void release() const;
 
   // Construct human-readable version of Transaction object.
   virtual std::string to_string() const;
@@ -256,19 +306,120 @@ class Transaction {
   // Accessors:
   kernel::Time start_time() const { return start_time_; }
   std::size_t tid() const { return tid_; }
+  transaction_handle_t handle() const { return handle_; }
+  // Transaction has been time-stamped at 'stage'.
+  bool has_stamp(TransactionStage stage) const {
+    return (stamped_ & bit(stage)) != 0;
+  }
+  // Time at which transaction was stamped at 'stage'.
+  kernel::Time::time_type stamp(TransactionStage stage) const {
+    return stamps_[static_cast<std::size_t>(stage)];
+  }
 
   // Setters:
   void set_start_time(kernel::Time time) { start_time_ = time; }
+  // Time-stamp transaction at 'stage'; only the first arrival at a
+  // stage is retained.
+  void stamp(TransactionStage stage, kernel::Time time) {
+    if (has_stamp(stage)) return;
+    stamps_[static_cast<std::size_t>(stage)] = time.time;
+    stamped_ |= bit(stage);
+  }
 
  protected:
   // Protect destructor (call 'release' to destruct).
   virtual ~Transaction() = default;
 
  private:
+  // Assign next globally unique transaction ID.
+  void assign_tid();
+
+  // Stage mask bit.
+  static std::uint32_t bit(TransactionStage stage) {
+    return 1u << static_cast<std::uint32_t>(stage);
+  }
+
   // Transaction start time-stamp
   kernel::Time start_time_;
+  // Per-stage time-stamps (valid where stamped).
+  std::array<kernel::Time::time_type,
+             static_cast<std::size_t>(TransactionStage::Invalid)>
+      stamps_;
+  // Mask of stamped stages.
+  std::uint32_t stamped_ = 0;
   // Transaction ID (globally unique)
   std::size_t tid_;
+  // Transaction handle (unique to originating CPU).
+  transaction_handle_t handle_ = 0;
+  // Transaction is in-flight.
+  bool inflight_ = false;
+  // Owning slab (or nullptr if not allocated from a slab).
+  TransactionSlab* slab_ = nullptr;
+  // Intrusive list linkage; in-flight list when in-flight, otherwise
+  // free list (next only).
+  Transaction* prev_ = nullptr;
+  Transaction* next_ = nullptr;
+};
+
+// Slab of Transaction instances from which a CPU allocates its
+// transactions. Slots are allocated in chunks which are never
+// relocated such that both the Transaction address and its handle are
+// stable for the lifetime of the slab. Allocation, release and lookup
+// by handle are constant time and, once the slab has been reserved to
+// the maximum number of in-flight transactions, allocation-free.
+//
+class TransactionSlab {
+ public:
+  TransactionSlab() = default;
+  ~TransactionSlab();
+
+  TransactionSlab(const TransactionSlab&) = delete;
+  TransactionSlab& operator=(const TransactionSlab&) = delete;
+
+  // Number of slots.
+  std::size_t capacity() const { return slots_.size(); }
+
+  // Number of in-flight transactions.
+  std::size_t inflight_n() const { return inflight_n_; }
+
+  // Oldest in-flight transaction, or nullptr if none; iterate through
+  // subsequent in-flight transactions using 'next_inflight'.
+  Transaction* inflight_head() const { return head_; }
+
+  // In-flight transaction subsequent to 't', or nullptr if none.
+  static Transaction* next_inflight(const Transaction* t) { return t->next_; }
+
+  // Lookup transaction by handle.
+  Transaction* lookup(transaction_handle_t h) const { return slots_[h]; }
+
+  // Flag indicating that 't' is an in-flight transaction of the slab.
+  bool is_inflight(const Transaction* t) const {
+    return t->handle_ < slots_.size() && slots_[t->handle_] == t &&
+           t->inflight_;
+  }
+
+  // Grow the slab to at least 'n' slots.
+  void reserve(std::size_t n);
+
+  // Allocate a new in-flight transaction; the slab grows should it be
+  // exhausted.
+  Transaction* allocate();
+
+  // Return in-flight transaction 't' to the slab.
+  void free(Transaction* t);
+
+ private:
+  // Slot storage (chunked, never relocated; owning).
+  std::vector<Transaction*> chunks_;
+  // Handle -> Slot mapping.
+  std::vector<Transaction*> slots_;
+  // Free list.
+  Transaction* free_ = nullptr;
+  // In-flight list (head is oldest, tail is youngest).
+  Transaction* head_ = nullptr;
+  Transaction* tail_ = nullptr;
+  // Number of in-flight transactions.
+  std::size_t inflight_n_ = 0;
 };
 
 }  // namespace cc
@@ -30,6 +30,7 @@
 #include <sstream>
 
 #include "primitives.h"
+#include "stats.h"
 #include "utility.h"
 #include "verif.h"
 
@@ -103,6 +104,9 @@ class NocModel::MainProcess : public AgentProcess {
         const NocTimingModel* tm = model_->tm();
         const time_t cost = tm->cost(nocmsg->origin(), nocmsg->dest());
         egress->issue(nocmsg, cost);
+        if (NocStatBlock* stats = model_->stats(); stats != nullptr) {
+          stats->forward_n.inc();
+        }
 
         // Return credit back to Ingress port
         CreditCounter* cc = origin_port->ingress_cc();
@@ -133,8 +137,10 @@ class NocModel::MainProcess : public AgentProcess {
   NocModel* model_ = nullptr;
 };
 
-NocPort::NocPort(kernel::Kernel* k, const std::string& name) : Module(k, name) {
-  build();
+NocPort::NocPort(kernel::Kernel* k, const std::string& name,
+                 std::size_t ingress_n)
+    : Module(k, name) {
+  build(ingress_n);
 }
 
 NocPort::~NocPort() {
@@ -142,9 +148,9 @@ NocPort::~NocPort() {
   delete ingress_cc_;
 }
 
-void NocPort::build() {
+void NocPort::build(std::size_t ingress_n) {
   // Construct owned ingress queue; egress is owned by the agent itself.
-  ingress_ = new MessageQueue(k(), "ingress", 10);
+  ingress_ = new MessageQueue(k(), "ingress", ingress_n);
   add_child_module(ingress_);
   // Credit counter denoting Ingress Queue capacity.
   ingress_cc_ = new CreditCounter(k(), "ingress_cc");
@@ -191,7 +197,16 @@ class NocEndpoint::MainProcess : public AgentProcess {
 
     // Forward message message to destination queue and discard
     // encapsulation/transport message.
-    proxy->issue(msg);
+    if (!proxy->issue(msg)) {
+      // Destination queues are sized such that they cannot overflow;
+      // the message would otherwise be silently discarded.
+      LogMessage lmsg("Destination queue overflow: ");
+      lmsg.append(proxy->path());
+      lmsg.append(" message: ");
+      lmsg.append(msg->to_string());
+      lmsg.set_level(Level::Fatal);
+      log(lmsg);
+    }
     nocmsg->release();
 
     // Set conditions for subsequent re-evaluations.
@@ -282,7 +297,7 @@ void NocModel::register_agent(Agent* agent) {
   // duplicates may exist when agents with the same name, but
   // different paths, are registers with the NOC.
   const std::string port_name = flatten_path(agent->path());
-  NocPort* port = new NocPort(k(), port_name);
+  NocPort* port = new NocPort(k(), port_name, config_.ingress_q_n);
   add_child_module(port);
   // Install in port table.
   ports_.insert(std::make_pair(agent, port));
@@ -294,11 +309,18 @@ void NocModel::register_monitor(Monitor* monitor) {
   monitor->register_client(this);
 }
 
+void NocModel::register_statistics(Statistics* statistics) {
+  statistics_ = statistics;
+}
+
 bool NocModel::elab() {
   for (std::pair<Agent*, NocPort*> pp : ports_) {
     NocPort* port = pp.second;
     arb_->add_requester(port->ingress());
   }
+  if (statistics_ != nullptr) {
+    stats_ = statistics_->register_block<NocStatBlock>(path());
+  }
   return false;
 }
 
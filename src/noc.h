@@ -41,6 +41,8 @@ namespace cc {
 class MessageQueue;
 class MessageQueueArbiter;
 class Monitor;
+class Statistics;
+struct NocStatBlock;
 
 class NocMsg : public Message {
   template <typename>
@@ -71,7 +73,7 @@ class NocPort : public kernel::Module {
   friend class SocTop;
 
  public:
-  NocPort(kernel::Kernel* k, const std::string& name);
+  NocPort(kernel::Kernel* k, const std::string& name, std::size_t ingress_n);
   ~NocPort();
 
   // Ingress Message Queue (Owned by port)
@@ -85,7 +87,7 @@ class NocPort : public kernel::Module {
 
  private:
   // Build phase:
-  void build();
+  void build(std::size_t ingress_n);
 
   // Elaboration phase:
   void set_egress(MessageQueue* egress) { egress_ = egress; }
@@ -186,6 +188,8 @@ class NocModel : public Agent {
   void register_agent(Agent* agent);
   // Register verification monitor.
   void register_monitor(Monitor* monitor);
+  // Register statistics.
+  void register_statistics(Statistics* statistics);
 
   // Elaboration Phase
   bool elab() override;
@@ -201,6 +205,8 @@ class NocModel : public Agent {
   MQArb* arb() const { return arb_; }
   // Timing Model
   const NocTimingModel* tm() const { return tm_; }
+  // Statistics (nullptr if statistics are disabled).
+  NocStatBlock* stats() const { return stats_; }
 
  private:
   // Queue selection arbiter
@@ -211,6 +217,10 @@ class NocModel : public Agent {
   MainProcess* main_ = nullptr;
   // Verification monitor
   Monitor* monitor_ = nullptr;
+  // Statistics registry
+  Statistics* statistics_ = nullptr;
+  // NOC statistics
+  NocStatBlock* stats_ = nullptr;
   // Timing model
   const NocTimingModel* tm_ = nullptr;
   // NOC Configuration
@@ -59,14 +59,16 @@ class Clock : public kernel::Module {
 
 // Class type used to model the behavior of a queue type data
 // structure with events corresponding to enqueue and dequeue events
-// where necessary.
+// where necessary. Entries are held in a ring whose storage is
+// rounded up to a power of two such that pointers wrap by masking;
+// the capacity of the queue remains exactly 'n'.
 //
 template <typename T>
 class Queue : public kernel::Module {
  public:
   Queue(kernel::Kernel* k, const std::string& name, std::size_t n)
       : kernel::Module(k, name) {
-    ts_.resize(n);
+    resize_storage(n);
     reset_state();
 
     enqueue_event_ = new kernel::Event(k, "enqueue_event");
@@ -82,7 +84,7 @@ class Queue : public kernel::Module {
   }
 
   // The capacity of the queue.
-  std::size_t n() const { return ts_.size(); }
+  std::size_t n() const { return n_; }
   // The number of free entries in the queue.
   std::size_t free() const { return n() - size(); }
   // The occupancy of the queue.
@@ -105,7 +107,7 @@ class Queue : public kernel::Module {
     if (full()) return false;
 
     ts_[wr_ptr_] = t;
-    if (++wr_ptr_ == n()) wr_ptr_ = 0;
+    wr_ptr_ = (wr_ptr_ + 1) & mask_;
 
     // If was empty, not empty after an enqueue therefore notify,
     // awaitees waiting for the queue become non-empty.
@@ -125,6 +127,15 @@ class Queue : public kernel::Module {
     return true;
   }
 
+  // Peek 'i'-th entry from the head of the queue; returns true on
+  // success.
+  bool peek(std::size_t i, T& t) const {
+    if (i >= size()) return false;
+
+    t = ts_[(rd_ptr_ + i) & mask_];
+    return true;
+  }
+
   // Dequeue entry from queue; returns false on success.
   bool dequeue(T& t) {
     if (empty()) return false;
@@ -135,7 +146,7 @@ class Queue : public kernel::Module {
     // event to indicate transition away from full state.
     if (full()) non_full_event_->notify();
 
-    if (++rd_ptr_ == n()) rd_ptr_ = 0;
+    rd_ptr_ = (rd_ptr_ + 1) & mask_;
     empty_ = (--size_ == 0);
     full_ = false;
 
@@ -145,14 +156,27 @@ class Queue : public kernel::Module {
 
   // Resize queue to 'n'.
   void resize(std::size_t n) {
-    ts_.resize(n);
+    resize_storage(n);
     reset_state();
   }
 
+  // Discard queue contents (without notification).
+  void reset() override { reset_state(); }
+
  private:
+  void resize_storage(std::size_t n) {
+    std::size_t storage_n = 1;
+    while (storage_n < n) storage_n <<= 1;
+    n_ = n;
+    mask_ = storage_n - 1;
+    ts_.resize(storage_n);
+    // Release excess capacity retained from a prior (larger) size.
+    ts_.shrink_to_fit();
+  }
+
   void reset_state() {
     empty_ = true;
-    full_ = false;
+    full_ = (n_ == 0);
     wr_ptr_ = 0;
     rd_ptr_ = 0;
     size_ = 0;
@@ -165,6 +189,10 @@ class Queue : public kernel::Module {
   // Total number of entries in the queue; some integer smaller than
   // or equal to the total capacity of the queue.
   std::size_t size_;
+  // Capacity of the queue.
+  std::size_t n_ = 0;
+  // Pointer wrap mask (storage size less one).
+  std::size_t mask_ = 0;
   // Underlying queue state.
   std::vector<T> ts_;
 
@@ -280,6 +308,8 @@ class Arbiter : public kernel::Module {
 
   void drc() override {}
 
+  void reset() override { idx_ = 0; }
+
   //
   kernel::EventOr* request_arrival_event_ = nullptr;
   // Current arbitration index.
@@ -288,10 +318,70 @@ class Arbiter : public kernel::Module {
   std::vector<T*> ts_;
 };
 
+// Occupancy instrumentation of a Table.
+//
+struct TableStats {
+  // Total time for which the table was full.
+  std::uint64_t full_time = 0;
+};
+
+// Key/Value type-agnostic view of a Table (for instrumentation).
+//
+class TableBase : public kernel::Module {
+ public:
+  TableBase(kernel::Kernel* k, const std::string& name, std::size_t n)
+      : Module(k, name), n_(n) {}
+
+  // Table capacity.
+  std::size_t n() const { return n_; }
+  // Number of occupied entries.
+  virtual std::size_t size() const = 0;
+  // Occupancy instrumentation.
+  const TableStats& stats() const { return stats_; }
+
+  // Discard table contents and instrumentation; values are not
+  // released and must have been reclaimed by the owner beforehand.
+  void reset() override {
+    clear();
+    full_since_ = 0;
+    stats_ = TableStats{};
+  }
+
+  // Finalization; account the full interval which remains open at the
+  // end of simulation.
+  void fini() {
+    if (size() != n()) return;
+    // Interval is closed at the current time and restarted such that
+    // repeated finalization does not double count.
+    const kernel::Time::time_type now = k()->time().time;
+    stats_.full_time += now - full_since_;
+    full_since_ = now;
+  }
+
+ protected:
+  // Discard table contents.
+  virtual void clear() = 0;
+
+  // Instrumentation; table has transitioned to full.
+  void mark_full() { full_since_ = k()->time().time; }
+  // Instrumentation; table has transitioned out of full.
+  void mark_not_full() {
+    stats_.full_time += k()->time().time - full_since_;
+  }
+
+ private:
+  // Table size.
+  std::size_t n_;
+  // Time at which table last became full.
+  kernel::Time::time_type full_since_ = 0;
+  // Occupancy instrumentation.
+  TableStats stats_;
+};
+
 //
 //
 template <typename K, typename V>
-class Table : public kernel::Module {
+class Table : public TableBase {
   using table_type = std::map<K, V>;
 
  public:
@@ -299,7 +389,7 @@ class Table : public kernel::Module {
   using const_iterator = typename table_type::const_iterator;
 
   Table(kernel::Kernel* k, const std::string& name, std::size_t n)
-      : Module(k, name), n_(n) {
+      : TableBase(k, name, n) {
     non_full_event_ = new kernel::Event(k, "non_full_event");
   }
 
@@ -308,8 +398,7 @@ class Table : public kernel::Module {
   kernel::Event* non_full_event() const { return non_full_event_; }
 
   // Accessors:
-  std::size_t n() const { return n_; }
-  std::size_t size() const { return m_.size(); }
+  std::size_t size() const override { return m_.size(); }
 
   bool full() const { return size() == n(); }
 
@@ -327,7 +416,11 @@ class Table : public kernel::Module {
   const iterator find(K k) const { return m_.find(k); }
 
   //
-  virtual void install(K k, V v) { m_.insert_or_assign(k, v); }
+  virtual void install(K k, V v) {
+    const bool was_full = full();
+    m_.insert_or_assign(k, v);
+    if (!was_full && full()) mark_full();
+  }
 
   //
   virtual void remove(K k) {
@@ -335,14 +428,16 @@ class Table : public kernel::Module {
     if (auto it = m_.find(k); it != m_.end()) {
       m_.erase(it);
       if (was_full) {
+        mark_not_full();
         non_full_event_->notify();
       }
     }
   }
 
+ protected:
+  void clear() override { m_.clear(); }
+
  private:
-  // Table size.
-  std::size_t n_;
   // Table state.
   table_type m_;
   //
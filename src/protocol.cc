@@ -34,6 +34,7 @@
 #include "noc.h"
 #include "sim.h"
 #include "utility.h"
+#include <algorithm>
 
 namespace cc {
 
@@ -103,6 +104,26 @@ std::string CohSnpRspMsg::to_string() const {
   return r.to_string();
 }
 
+L1CacheAgent* ProtocolBuilder::create_l1_agent(
+    kernel::Kernel* k, const L1CacheAgentConfig& config) {
+  return new L1CacheAgent(k, config);
+}
+
+L2CacheAgent* ProtocolBuilder::create_l2_agent(
+    kernel::Kernel* k, const L2CacheAgentConfig& config) {
+  return new L2CacheAgent(k, config);
+}
+
+DirAgent* ProtocolBuilder::create_dir_agent(kernel::Kernel* k,
+                                            const DirAgentConfig& config) {
+  return new DirAgent(k, config);
+}
+
+CCAgent* ProtocolBuilder::create_cc_agent(kernel::Kernel* k,
+                                          const CCAgentConfig& config) {
+  return new CCAgent(k, config);
+}
+
 using pbr = ProtocolBuilderRegistry;
 
 // Coherence protocol registry
@@ -167,6 +188,193 @@ L2CacheAgentProtocol::L2CacheAgentProtocol(kernel::Kernel* k,
 CCProtocol::CCProtocol(kernel::Kernel* k, const std::string& name)
     : Module(k, name) {}
 
+namespace {
+
+// Limited pointer encoding: pointer count in bits [0, 3), overflow
+// flag in bit 3, and pointers of 'lp_bits' from bit 4.
+constexpr std::size_t lp_bits = 15;
+constexpr std::size_t lp_max_n = 4;
+constexpr SharerSet::word_type lp_overflow = 0x8;
+
+std::size_t lp_count(SharerSet::word_type w) { return w & 0x7; }
+
+std::size_t lp_ptr(SharerSet::word_type w, std::size_t k) {
+  return (w >> (4 + k * lp_bits)) & ((SharerSet::word_type{1} << lp_bits) - 1);
+}
+
+SharerSet::word_type lp_set_ptr(SharerSet::word_type w, std::size_t k,
+                                std::size_t i) {
+  const std::size_t shift = 4 + k * lp_bits;
+  const SharerSet::word_type m = ((SharerSet::word_type{1} << lp_bits) - 1)
+                                 << shift;
+  return (w & ~m) | (static_cast<SharerSet::word_type>(i) << shift);
+}
+
+// Limited pointer encoding is precise (has not overflowed).
+bool lp_is_precise(const SharerDomain* d, SharerSet::word_type w) {
+  return (d->encoding() == SharerEncoding::LimitedPointer) &&
+         ((w & lp_overflow) == 0);
+}
+
+}  // namespace
+
+std::size_t SharerDomain::group_n() const {
+  if (encoding_ != SharerEncoding::CoarseVector) return 1;
+  if (group_n_ != 0) return group_n_;
+  return std::max<std::size_t>(1, (agents_.size() + 63) / 64);
+}
+
+std::size_t SharerDomain::index(const Agent* agent) const {
+  const auto it = indices_.find(agent);
+  return (it != indices_.end()) ? it->second : agents_.size();
+}
+
+void SharerDomain::set_encoding(SharerEncoding encoding, std::size_t pointer_n,
+                                std::size_t group_n) {
+  encoding_ = encoding;
+  pointer_n_ = pointer_n;
+  group_n_ = group_n;
+}
+
+std::size_t SharerDomain::register_agent(Agent* agent) {
+  if (auto it = indices_.find(agent); it != indices_.end()) return it->second;
+  indices_.insert(std::make_pair(agent, agents_.size()));
+  agents_.push_back(agent);
+  return agents_.size() - 1;
+}
+
+const char* SharerDomain::validate() const {
+  const std::size_t n = agents_.size();
+  switch (encoding_) {
+    case SharerEncoding::FullMap: {
+      if (n > 64) return "Full-map sharer encoding supports at most 64 agents.";
+    } break;
+    case SharerEncoding::LimitedPointer: {
+      if ((pointer_n_ == 0) || (pointer_n_ > lp_max_n)) {
+        return "Limited-pointer sharer encoding supports between 1 and 4 "
+               "pointers.";
+      }
+      if (n > (std::size_t{1} << lp_bits)) {
+        return "Limited-pointer sharer encoding supports at most 32768 "
+               "agents.";
+      }
+    } break;
+    case SharerEncoding::CoarseVector: {
+      if ((n + group_n() - 1) / group_n() > 64) {
+        return "Coarse-vector sharer group is insufficient to represent all "
+               "agents.";
+      }
+    } break;
+  }
+  return nullptr;
+}
+
+Agent* SharerSet::Agents::iterator::operator*() const {
+  if (lp_is_precise(r_->d_, r_->w_)) {
+    return r_->d_->agent(lp_ptr(r_->w_, pos_));
+  }
+  return r_->d_->agent(pos_);
+}
+
+void SharerSet::Agents::iterator::skip() {
+  const SharerDomain* d = r_->d_;
+  const word_type w = r_->w_;
+  const std::size_t end = r_->end_pos();
+  for (; pos_ < end; pos_++) {
+    bool is_member = true;
+    switch (d->encoding()) {
+      case SharerEncoding::FullMap: {
+        const word_type rem = (pos_ < 64) ? (w >> pos_) : 0;
+        if (rem == 0) {
+          pos_ = end;
+          return;
+        }
+        // Advance to next set bit.
+        while (((w >> pos_) & 1) == 0) pos_++;
+      } break;
+      case SharerEncoding::CoarseVector: {
+        is_member = ((w >> (pos_ / d->group_n())) & 1) != 0;
+      } break;
+      case SharerEncoding::LimitedPointer: {
+        // Either a precise pointer, or broadcast to all agents.
+      } break;
+    }
+    if (is_member && (**this != r_->except_)) return;
+  }
+}
+
+std::size_t SharerSet::Agents::end_pos() const {
+  if (w_ == 0) return 0;
+  if (lp_is_precise(d_, w_)) return lp_count(w_);
+  return d_->agents_n();
+}
+
+bool SharerSet::contains(const SharerDomain* d, std::size_t i) const {
+  switch (d->encoding()) {
+    case SharerEncoding::FullMap: {
+      return ((w_ >> i) & 1) != 0;
+    }
+    case SharerEncoding::CoarseVector: {
+      return ((w_ >> (i / d->group_n())) & 1) != 0;
+    }
+    case SharerEncoding::LimitedPointer: {
+      if ((w_ & lp_overflow) != 0) return true;
+      for (std::size_t k = 0; k < lp_count(w_); k++) {
+        if (lp_ptr(w_, k) == i) return true;
+      }
+      return false;
+    }
+  }
+  return false;
+}
+
+void SharerSet::add(const SharerDomain* d, std::size_t i) {
+  switch (d->encoding()) {
+    case SharerEncoding::FullMap: {
+      w_ |= word_type{1} << i;
+    } break;
+    case SharerEncoding::CoarseVector: {
+      w_ |= word_type{1} << (i / d->group_n());
+    } break;
+    case SharerEncoding::LimitedPointer: {
+      if (contains(d, i)) break;
+      const std::size_t n = lp_count(w_);
+      if (n < d->pointer_n()) {
+        w_ = lp_set_ptr(w_, n, i);
+        w_ = (w_ & ~word_type{0x7}) | (n + 1);
+      } else {
+        // Pointers exhausted; line is thereafter broadcast.
+        w_ = lp_overflow;
+      }
+    } break;
+  }
+}
+
+void SharerSet::del(const SharerDomain* d, std::size_t i) {
+  switch (d->encoding()) {
+    case SharerEncoding::FullMap: {
+      w_ &= ~(word_type{1} << i);
+    } break;
+    case SharerEncoding::CoarseVector: {
+      // Other agents in the group may share the line, therefore the
+      // bit can be cleared only where the group is a single agent.
+      if (d->group_n() == 1) w_ &= ~(word_type{1} << i);
+    } break;
+    case SharerEncoding::LimitedPointer: {
+      if ((w_ & lp_overflow) != 0) break;
+      const std::size_t n = lp_count(w_);
+      for (std::size_t k = 0; k < n; k++) {
+        if (lp_ptr(w_, k) != i) continue;
+        // Replace with final pointer.
+        w_ = lp_set_ptr(w_, k, lp_ptr(w_, n - 1));
+        w_ = lp_set_ptr(w_, n - 1, 0);
+        w_ = (w_ & ~word_type{0x7}) | (n - 1);
+        break;
+      }
+    } break;
+  }
+}
+
 DirProtocol::DirProtocol(kernel::Kernel* k, const std::string& name)
     : Module(k, name) {}
 
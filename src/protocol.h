@@ -28,12 +28,15 @@
 #ifndef CC_SRC_PROTOCOL_H
 #define CC_SRC_PROTOCOL_H
 
+#include <cstdint>
 #include <deque>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "amba.h"
+#include "cc/cfgs.h"
 #include "cc/types.h"
 #include "msg.h"
 
@@ -58,6 +61,16 @@ class DirContext;
 class MessageQueue;
 class Agent;
 
+// Agent Forwards:
+class L1CacheAgent;
+class L2CacheAgent;
+class DirAgent;
+class CCAgent;
+struct L1CacheAgentConfig;
+struct L2CacheAgentConfig;
+struct DirAgentConfig;
+struct CCAgentConfig;
+
 //
 //
 class CohSrtMsg : public Message {
@@ -280,7 +293,7 @@ class L1CacheAgentProtocol : public kernel::Module {
   //
   //
   virtual void set_line_shared_or_invalid(L1CacheContext& c, L1CommandList& cl,
-                                          bool shared) const = 0;
+                                          bool shared, bool is_owner) const = 0;
 };
 
 //
@@ -339,6 +352,139 @@ class L2CacheAgentProtocol : public kernel::Module {
                                    L2CommandList& cl) const = 0;
 };
 
+// Dense index of the agents (cache controllers) tracked by a
+// directory, and the encoding of sharer sets over that index.
+//
+class SharerDomain {
+ public:
+  SharerDomain() = default;
+
+  // Sharer set encoding.
+  SharerEncoding encoding() const { return encoding_; }
+
+  // Precise pointers per line (LimitedPointer).
+  std::size_t pointer_n() const { return pointer_n_; }
+
+  // Agents per bit (CoarseVector).
+  std::size_t group_n() const;
+
+  // Number of registered agents.
+  std::size_t agents_n() const { return agents_.size(); }
+
+  // Agent at index 'i'.
+  Agent* agent(std::size_t i) const { return agents_[i]; }
+
+  // Index of 'agent', or agents_n() where not registered.
+  std::size_t index(const Agent* agent) const;
+
+  // Set encoding.
+  void set_encoding(SharerEncoding encoding, std::size_t pointer_n,
+                    std::size_t group_n);
+
+  // Register agent; returns its index.
+  std::size_t register_agent(Agent* agent);
+
+  // Reason for which the registered agents cannot be represented by
+  // the encoding, or nullptr.
+  const char* validate() const;
+
+ private:
+  // Sharer set encoding.
+  SharerEncoding encoding_ = SharerEncoding::FullMap;
+
+  // Precise pointers per line (LimitedPointer).
+  std::size_t pointer_n_ = 4;
+
+  // Agents per bit (CoarseVector); zero where derived.
+  std::size_t group_n_ = 0;
+
+  // Agents by index.
+  std::vector<Agent*> agents_;
+
+  // Index by agent.
+  std::unordered_map<const Agent*, std::size_t> indices_;
+};
+
+// Set of agents sharing a line, encoded in a single word according to
+// the encoding of some domain. Imprecise encodings over-approximate
+// the set: an agent, once added, is retained until it can be precisely
+// removed, but agents which have never been added may be reported.
+//
+class SharerSet {
+ public:
+  using word_type = std::uint64_t;
+
+  // Range over the agents (possibly) in the set.
+  class Agents {
+   public:
+    class iterator {
+     public:
+      iterator(const Agents* r, std::size_t pos) : r_(r), pos_(pos) {
+        skip();
+      }
+
+      Agent* operator*() const;
+      iterator& operator++() {
+        pos_++;
+        skip();
+        return *this;
+      }
+      bool operator!=(const iterator& it) const { return pos_ != it.pos_; }
+
+     private:
+      // Advance to the next position denoting a member.
+      void skip();
+
+      // Owning range.
+      const Agents* r_ = nullptr;
+      // Agent index (or pointer slot for precise limited pointers).
+      std::size_t pos_ = 0;
+    };
+
+    Agents(const SharerDomain* d, word_type w, const Agent* except)
+        : d_(d), w_(w), except_(except) {}
+
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, end_pos()); }
+
+   private:
+    // Position beyond final member.
+    std::size_t end_pos() const;
+
+    // Sharer domain.
+    const SharerDomain* d_ = nullptr;
+    // Encoded set.
+    word_type w_ = 0;
+    // Agent excluded from the range (or nullptr).
+    const Agent* except_ = nullptr;
+  };
+
+  // Encoded set.
+  word_type word() const { return w_; }
+
+  // Set is empty.
+  bool empty() const { return w_ == 0; }
+
+  // Agent at index 'i' is (possibly) in the set.
+  bool contains(const SharerDomain* d, std::size_t i) const;
+
+  // Add agent at index 'i'.
+  void add(const SharerDomain* d, std::size_t i);
+
+  // Delete agent at index 'i'; retained where the encoding cannot
+  // represent its removal.
+  void del(const SharerDomain* d, std::size_t i);
+
+  // Agents (possibly) in the set, excluding 'except'.
+  Agents agents(const SharerDomain* d, const Agent* except = nullptr) const {
+    return Agents(d, w_, except);
+  }
+
+ private:
+  // Encoded set.
+  word_type w_ = 0;
+};
+
 //
 //
 class DirLineState {
@@ -384,6 +530,12 @@ class DirProtocol : public kernel::Module {
   DirProtocol(kernel::Kernel* k, const std::string& name);
   virtual ~DirProtocol() = default;
 
+  // Sharer domain of owning directory.
+  const SharerDomain* sharer_domain() const { return sharer_domain_; }
+
+  // Set sharer domain of owning directory.
+  void set_sharer_domain(const SharerDomain* d) { sharer_domain_ = d; }
+
   //
   //
   virtual DirLineState* construct_line() const = 0;
@@ -395,6 +547,10 @@ class DirProtocol : public kernel::Module {
   //
   //
   virtual void recall(DirContext& ctxt, DirCommandList& cl) const = 0;
+
+ private:
+  // Sharer domain of owning directory.
+  const SharerDomain* sharer_domain_ = nullptr;
 };
 
 //
@@ -448,6 +604,10 @@ class CCProtocol : public kernel::Module {
   //
   virtual bool is_complete(CCContext& ctxt, CCCommandList& cl) const = 0;
 
+  // Transaction associated with 'line' has been accepted by its home
+  // directory.
+  virtual bool is_accepted(const CCLineState* line) const = 0;
+
   //
   //
   virtual void apply(CCSnpContext& ctxt, CCSnpCommandList& cl) const = 0;
@@ -470,6 +630,25 @@ class ProtocolBuilder {
 
   // Create an instance of a Cache Controller protocol.
   virtual CCProtocol* create_cc(kernel::Kernel*) = 0;
+
+  // Create an instance of an L1 cache agent. By default, the agent
+  // dispatches to the protocol virtually; builders of concrete
+  // protocols may override to return an agent specialized on the
+  // protocol type (L1CacheAgentT).
+  virtual L1CacheAgent* create_l1_agent(kernel::Kernel* k,
+                                        const L1CacheAgentConfig& config);
+
+  // Create an instance of an L2 cache agent.
+  virtual L2CacheAgent* create_l2_agent(kernel::Kernel* k,
+                                        const L2CacheAgentConfig& config);
+
+  // Create an instance of a Directory agent.
+  virtual DirAgent* create_dir_agent(kernel::Kernel* k,
+                                     const DirAgentConfig& config);
+
+  // Create an instance of a Cache Controller agent.
+  virtual CCAgent* create_cc_agent(kernel::Kernel* k,
+                                   const CCAgentConfig& config);
 };
 
 //
@@ -33,11 +33,33 @@
 
 namespace cc {
 
+const char* to_string(BlockReason reason) {
+  switch (reason) {
+    case BlockReason::TableFull:
+      return "TableFull";
+    case BlockReason::Credits:
+      return "Credits";
+    case BlockReason::QueueFull:
+      return "QueueFull";
+    case BlockReason::TransactionInFlight:
+      return "TransactionInFlight";
+    case BlockReason::Other:
+      return "Other";
+    default:
+      return "Invalid";
+  }
+}
+
+std::uint64_t MessageQueueStats::total_blocked_time() const {
+  std::uint64_t t = 0;
+  for (std::uint64_t bt : blocked_time) t += bt;
+  return t;
+}
+
 MessageQueue::MessageQueue(kernel::Kernel* k, const std::string& name,
                            std::size_t n)
     : Agent(k, name) {
-  // TEMPORARY override N
-  build(100);
+  build(n);
 }
 
 MessageQueue::~MessageQueue() { delete q_; }
@@ -50,37 +72,55 @@ std::string MessageQueue::to_string() const {
   return r.to_string();
 }
 
-bool MessageQueue::has_at_least(std::size_t n) const { return q_->free() >= n; }
+bool MessageQueue::has_at_least(std::size_t n) const {
+  // Entries of messages issued but not yet enqueued are accounted as
+  // occupied.
+  return q_->free() >= n + inflight_n_;
+}
 
 bool MessageQueue::issue(const Message* msg, cursor_t cursor) {
   struct EnqueueAction : kernel::Action {
-    EnqueueAction(kernel::Kernel* k, Queue<const Message*>* q,
-                  const Message* msg)
-        : Action(k, "enqueue_action"), q_(q), msg_(msg) {}
+    EnqueueAction(kernel::Kernel* k, MessageQueue* mq, const Message* msg)
+        : Action(k, "enqueue_action"), mq_(mq), msg_(msg) {}
     bool eval() override {
-      if (!q_->enqueue(msg_)) {
+      Queue<const Message*>* q = mq_->q_;
+      --mq_->inflight_n_;
+      mq_->stats_.occupancy.add(q->size());
+      if (!q->enqueue(msg_)) {
         LogMessage lm("Attempt to push new message to full queue.");
         lm.set_level(Level::Fatal);
         log(lm);
       }
+      if (q->full()) mq_->full_since_ = k()->time().time;
       return true;
     }
+    void discard() override {
+      // Message has not arrived; reclaim.
+      msg_->release();
+      release();
+    }
 
    private:
-    Queue<const Message*>* q_ = nullptr;
+    MessageQueue* mq_ = nullptr;
     const Message* msg_;
   };
 
   if (full()) return false;
+  ++inflight_n_;
   // Issue action:
   const kernel::Time execute_time = k()->time() + kernel::Time{cursor, 0};
 
   const kernel::ActionAdder aa(k());
-  aa.add_action(execute_time, new EnqueueAction(k(), q_, msg));
+  aa.add_action(execute_time, new EnqueueAction(k(), this, msg));
 
   return true;
 }
 
+void MessageQueue::add_credits(std::size_t n) {
+  credit_n_ += n;
+  resize(q_->n() + n);
+}
+
 void MessageQueue::resize(std::size_t n) {
   if (!empty()) {
     // Cannot call resize when there are outstanding entries within
@@ -92,15 +132,76 @@ void MessageQueue::resize(std::size_t n) {
     msg.set_level(Level::Fatal);
     log(msg);
   }
+  if (n < credit_n_) {
+    // Entries reserved for credited traffic cannot be reclaimed.
+    LogMessage msg("Attempt to resize Message Queue below its credits: ");
+    msg.append(std::to_string(credit_n_));
+    msg.set_level(Level::Fatal);
+    log(msg);
+  }
   q_->resize(n);
 }
 
-void MessageQueue::set_blocked_until(kernel::Event* event) {
+void MessageQueue::reset() {
+  const Message* msg = nullptr;
+  while (q_->dequeue(msg)) msg->release();
+  inflight_n_ = 0;
+  blocked_ = false;
+  blocked_reason_ = BlockReason::Other;
+  blocked_since_ = 0;
+  full_since_ = 0;
+  stats_ = MessageQueueStats{};
+}
+
+void MessageQueue::drc() {
+  if (n() == 0) {
+    // Queue can never accept a message.
+    LogMessage msg("Message Queue has zero capacity.", Level::Fatal);
+    log(msg);
+  }
+  if ((credit_n_ == 0) && (n() < fanin_n_)) {
+    // Issue to the queue is not governed by credits; the queue can
+    // overflow unless it can accept a message from each originator.
+    LogMessage msg("Message Queue could overflow; capacity: ");
+    msg.append(std::to_string(n()));
+    msg.append(" fan-in: ");
+    msg.append(std::to_string(fanin_n_));
+    msg.set_level(Level::Fatal);
+    log(msg);
+  }
+}
+
+void MessageQueue::fini() {
+  // Intervals are closed at the current time and restarted such that
+  // repeated finalization does not double count.
+  const kernel::Time::time_type now = k()->time().time;
+  if (q_->full()) {
+    stats_.full_time += now - full_since_;
+    full_since_ = now;
+  }
+  if (blocked()) {
+    const std::size_t r = static_cast<std::size_t>(blocked_reason_);
+    stats_.blocked_time[r] += now - blocked_since_;
+    blocked_since_ = now;
+  }
+}
+
+void MessageQueue::set_blocked_until(kernel::Event* event,
+                                     BlockReason reason) {
   struct UnblockAction : kernel::Action {
     UnblockAction(kernel::Kernel* k, MessageQueue* mq)
         : Action(k, "unblock_action"), mq_(mq) {}
     bool eval() override {
+      const std::size_t r = static_cast<std::size_t>(mq_->blocked_reason_);
+      mq_->stats_.blocked_time[r] += k()->time().time - mq_->blocked_since_;
       mq_->set_blocked(false);
+      if (!mq_->empty()) {
+        // Queue was non-empty throughout the blocked interval, hence
+        // its arbiter has seen no arrival; re-announce the pending
+        // message such that an agent which has since suspended awaiting
+        // a request is awoken.
+        mq_->non_empty_event()->notify();
+      }
       return true;
     }
 
@@ -109,6 +210,9 @@ void MessageQueue::set_blocked_until(kernel::Event* event) {
   };
   // Message queue is now blocked
   set_blocked(true);
+  blocked_reason_ = reason;
+  blocked_since_ = k()->time().time;
+  stats_.blocked_n[static_cast<std::size_t>(reason)]++;
   // Add notify action to 'awaking' event; which then rescinds the
   // blocked state.
   event->add_notify_action(new UnblockAction(k(), this));
@@ -125,8 +229,15 @@ const Message* MessageQueue::peek() const {
   return msg;
 }
 
+const Message* MessageQueue::peek(std::size_t i) const {
+  const Message* msg = nullptr;
+  q_->peek(i, msg);
+  return msg;
+}
+
 const Message* MessageQueue::dequeue() {
   const Message* msg = nullptr;
+  if (q_->full()) stats_.full_time += k()->time().time - full_since_;
   if (!q_->dequeue(msg)) {
     const LogMessage lm("Attempt to dequeue Message failed.", Level::Fatal);
     log(lm);
@@ -213,6 +324,7 @@ void CreditCounter::credit() {
     log(msg);
   }
   // Add credit
+  if (i_ == 0) stats_.empty_time += k()->time().time - empty_since_;
   ++i_;
   // Notify awaitees
   credit_event_->notify();
@@ -229,7 +341,25 @@ void CreditCounter::debit() {
     log(msg);
   }
   // Deduct credit
-  --i_;
+  if (--i_ == 0) {
+    empty_since_ = k()->time().time;
+    ++stats_.exhausted_n;
+  }
+}
+
+void CreditCounter::reset() {
+  i_ = n_;
+  empty_since_ = 0;
+  stats_ = CreditCounterStats{};
+}
+
+void CreditCounter::fini() {
+  if (i_ != 0) return;
+  // Interval is closed at the current time and restarted such that
+  // repeated finalization does not double count.
+  const kernel::Time::time_type now = k()->time().time;
+  stats_.empty_time += now - empty_since_;
+  empty_since_ = now;
 }
 
 }  // namespace cc
@@ -28,8 +28,14 @@
 #ifndef CC_SRC_SIM_H
 #define CC_SRC_SIM_H
 
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
 #include "msg.h"
 #include "primitives.h"
+#include "stats.h"
 
 namespace cc {
 
@@ -80,11 +86,153 @@ class AgentProcess : public kernel::Process {
 
 class MessageQueue;
 
+// Cause for which a Message Queue has been blocked.
+//
+enum class BlockReason {
+  // Transaction table full.
+  TableFull,
+  // Awaiting credits.
+  Credits,
+  // Downstream Message Queue full.
+  QueueFull,
+  // Awaiting completion of an in-flight transaction.
+  TransactionInFlight,
+  // Unspecified.
+  Other,
+
+  // Reason count (not a reason).
+  Invalid
+};
+
+// Convert BlockReason to a human-readable string.
+const char* to_string(BlockReason reason);
+
+// Back-pressure instrumentation of a Message Queue.
+//
+struct MessageQueueStats {
+  // Number of reasons.
+  static constexpr std::size_t reasons_n =
+      static_cast<std::size_t>(BlockReason::Invalid);
+
+  // Total time blocked, by reason.
+  std::array<std::uint64_t, reasons_n> blocked_time{};
+  // Number of times blocked, by reason.
+  std::array<std::uint64_t, reasons_n> blocked_n{};
+  // Total time full.
+  std::uint64_t full_time = 0;
+  // Occupancy observed by each arriving message.
+  Histogram occupancy;
+
+  // Total time blocked (all reasons).
+  std::uint64_t total_blocked_time() const;
+};
+
+// Back-pressure instrumentation of a Credit Counter.
+//
+struct CreditCounterStats {
+  // Total time for which no credits were available.
+  std::uint64_t empty_time = 0;
+  // Number of debits which exhausted the available credits.
+  std::uint64_t exhausted_n = 0;
+};
+
 //
 //
 class Agent : public kernel::Module {
  public:
+  // Identifier of an agent to which no id has been assigned.
+  static constexpr std::size_t npos = ~std::size_t{0};
+
   Agent(kernel::Kernel* k, const std::string& name);
+
+  // Dense identifier, unique amongst the agents of the SoC, used to
+  // index per-agent tables (npos where unassigned).
+  std::size_t id() const { return id_; }
+
+  // Set identifier (build/elab only).
+  void set_id(std::size_t id) { id_ = id; }
+
+ private:
+  // Dense identifier.
+  std::size_t id_ = npos;
+};
+
+// Per-agent counts accumulated over a command list. Command lists
+// address few agents, therefore entries are held in a flat list and
+// searched linearly.
+//
+class AgentCounts {
+ public:
+  using value_type = std::pair<const Agent*, std::size_t>;
+  using const_iterator = std::vector<value_type>::const_iterator;
+
+  AgentCounts() = default;
+
+  const_iterator begin() const { return v_.begin(); }
+  const_iterator end() const { return v_.end(); }
+
+  // Count associated with 'agent', or zero.
+  std::size_t count(const Agent* agent) const {
+    for (const value_type& p : v_) {
+      if (p.first == agent) return p.second;
+    }
+    return 0;
+  }
+
+  // Set count associated with 'agent'.
+  void set(const Agent* agent, std::size_t n) {
+    for (value_type& p : v_) {
+      if (p.first == agent) {
+        p.second = n;
+        return;
+      }
+    }
+    v_.push_back(std::make_pair(agent, n));
+  }
+
+ private:
+  // {Agent, count} pairs.
+  std::vector<value_type> v_;
+};
+
+// Table of entries keyed on {MessageClass, Agent}, stored as flat
+// per-class arrays indexed by the dense agent id. Absent entries are
+// nullptr.
+//
+template <typename T>
+class AgentClassTable {
+ public:
+  AgentClassTable() = default;
+
+  // Lookup entry for {cls, agent}, or nullptr.
+  T* lookup(MessageClass cls, const Agent* agent) const {
+    if (agent == nullptr) return nullptr;
+    const std::vector<T*>& row = rows_[static_cast<std::size_t>(cls)];
+    const std::size_t id = agent->id();
+    return (id < row.size()) ? row[id] : nullptr;
+  }
+
+  // Install entry for {cls, agent}; agent must have been assigned an
+  // id.
+  void install(MessageClass cls, const Agent* agent, T* t) {
+    std::vector<T*>& row = rows_[static_cast<std::size_t>(cls)];
+    if (agent->id() >= row.size()) row.resize(agent->id() + 1, nullptr);
+    row[agent->id()] = t;
+  }
+
+  // Invoke 'fn' on every installed entry.
+  template <typename FN>
+  void for_each(FN&& fn) const {
+    for (const std::vector<T*>& row : rows_) {
+      for (T* t : row) {
+        if (t != nullptr) fn(t);
+      }
+    }
+  }
+
+ private:
+  // Entries by class, then agent id.
+  std::array<std::vector<T*>, message_class_n> rows_;
 };
 
 //
@@ -100,14 +248,22 @@ class MessageQueue : public Agent {
 
   // Total number of entries in the queue.
   std::size_t n() const { return q_->n(); }
-  // Queue has at least 'n' available entries.
+  // Number of occupied entries in the queue.
+  std::size_t size() const { return q_->size(); }
+  // Queue has at least 'n' available entries, excluding entries
+  // reserved by messages in flight to the queue.
   bool has_at_least(std::size_t n) const;
   // Queue is empty.
   bool empty() const { return q_->empty(); }
+  // Number of messages issued to the queue which have yet to be
+  // enqueued.
+  std::size_t inflight_n() const { return inflight_n_; }
   // Queue is full.
   bool full() const { return q_->full(); }
   // Flag indicating that the current agent is blocked.
   bool blocked() const { return blocked_; }
+  // Back-pressure instrumentation.
+  const MessageQueueStats& stats() const { return stats_; }
 
   // Event notified when Message Queue transitions from empty to
   // non-empty state.
@@ -124,24 +280,61 @@ class MessageQueue : public Agent {
   bool has_req() const;
   // Peek head message, nullptr on empty.
   const Message* peek() const;
+  // Peek 'i'-th message from head, nullptr where the queue holds no
+  // more than 'i' messages.
+  const Message* peek(std::size_t i) const;
   // Dequeue head message from queue.
   const Message* dequeue();
-  // Set blocked status of Message Queue until notified by event.
-  void set_blocked_until(kernel::Event* event);
+  // Set blocked status of Message Queue until notified by event;
+  // 'reason' is retained for instrumentation.
+  void set_blocked_until(kernel::Event* event,
+                         BlockReason reason = BlockReason::Other);
   // Issue message to queue after 'epoch' agent epochs.
   bool issue(const Message* msg, cursor_t cursor = 0);
+  // Entries reserved for credited traffic.
+  std::size_t credit_n() const { return credit_n_; }
+  // Grow queue by 'n' entries reserved for traffic whose issue is
+  // governed by credits held at the originator (build/elab only).
+  void add_credits(std::size_t n);
+  // Originators which may issue to the queue without holding a credit.
+  std::size_t fanin_n() const { return fanin_n_; }
+  // Register 'n' further originators which may issue to the queue
+  // without holding a credit (build/elab only).
+  void add_fanin(std::size_t n) { fanin_n_ += n; }
   // Resize queue (build/elab only)
   void resize(std::size_t n);
+  // Release queued messages and clear blocked state and
+  // instrumentation.
+  void reset() override;
+  // Design Rule Check (DRC)
+  void drc() override;
+  // Finalization; account full and blocked intervals which remain
+  // open at the end of simulation.
+  void fini();
 
  private:
   // Construct module
   void build(std::size_t n);
   // Queue primitive.
   Queue<const Message*>* q_ = nullptr;
+  // Messages issued to the queue which have yet to be enqueued.
+  std::size_t inflight_n_ = 0;
+  // Entries reserved for credited traffic.
+  std::size_t credit_n_ = 0;
+  // Originators which may issue to the queue without holding a credit.
+  std::size_t fanin_n_ = 0;
   // Set blocked status of requestor.
   void set_blocked(bool blocked) { blocked_ = blocked; }
   // Flag indicating that the current requestor is blocked.
   bool blocked_ = false;
+  // Reason for which requestor is currently blocked.
+  BlockReason blocked_reason_ = BlockReason::Other;
+  // Time at which requestor became blocked.
+  kernel::Time::time_type blocked_since_ = 0;
+  // Time at which queue became full.
+  kernel::Time::time_type full_since_ = 0;
+  // Back-pressure instrumentation.
+  MessageQueueStats stats_;
 };
 
 //
@@ -186,6 +379,8 @@ class CreditCounter : public kernel::Module {
   kernel::Event* credit_event() const { return credit_event_; }
   // Empty status (no credits available)
   bool empty() const { return i() == 0; }
+  // Back-pressure instrumentation.
+  const CreditCounterStats& stats() const { return stats_; }
   // Full status (no outstanding credits).
   bool full() const { return i() == n(); }
 
@@ -203,11 +398,22 @@ class CreditCounter : public kernel::Module {
   // Debit counter
   void debit();
 
+  // Restore full credit count and clear instrumentation.
+  void reset() override;
+
+  // Finalization; account the empty interval which remains open at
+  // the end of simulation.
+  void fini();
+
  private:
   // Credit "credited" event.
   kernel::Event* credit_event_ = nullptr;
   // Credit counter.
   std::size_t n_ = 0, i_ = 0;
+  // Time at which credits were last exhausted.
+  kernel::Time::time_type empty_since_ = 0;
+  // Back-pressure instrumentation.
+  CreditCounterStats stats_;
 };
 
 }  // namespace cc
@@ -74,12 +74,16 @@ void SocTop::build(const SocConfig& cfg) {
   if (cfg.enable_verif) {
     // Self-checking module; install monitor.
     monitor_ = new Monitor(k(), "monitor");
+    monitor_->set_async(cfg.verif_async);
     add_child_module(monitor_);
   }
 
   if (cfg.enable_stats) {
     // Attach statistics:
     statistics_ = new Statistics(k(), "statistics");
+    statistics_->set_json_filename(cfg.stats_json_filename);
+    statistics_->set_csv_filename(cfg.stats_csv_filename);
+    statistics_->set_sampler_config(cfg.sampler);
     add_child_module(statistics_);
   }
   
@@ -90,11 +94,13 @@ void SocTop::build(const SocConfig& cfg) {
   // Construct interconnect:
   noc_ = new NocModel(k(), cfg.noccfg);
   noc_->register_monitor(monitor_);
+  noc_->register_statistics(statistics_);
   add_child_module(noc_);
 
   // Construct memory controller (s)
   for (const MemModelConfig& mcfg : cfg.mcfgs) {
     MemCntrlAgent* mm = new MemCntrlAgent(k(), mcfg);
+    mm->register_statistics(statistics_);
     noc_->register_agent(mm);
     add_child_module(mm);
     mms_.push_back(mm);
@@ -114,8 +120,9 @@ void SocTop::build(const SocConfig& cfg) {
 
   // Construct child directories
   for (const DirAgentConfig& dcfg : cfg.dcfgs) {
-    DirAgent* dm = new DirAgent(k(), dcfg);
+    DirAgent* dm = dcfg.pbuilder->create_dir_agent(k(), dcfg);
     dm->register_monitor(monitor_);
+    dm->register_statistics(statistics_);
     noc_->register_agent(dm);
     add_child_module(dm);
     dms_.push_back(dm);
@@ -123,6 +130,7 @@ void SocTop::build(const SocConfig& cfg) {
     if (!dcfg.is_null_filter) {
       // Construct corresponding LLC
       LLCAgent* llc = new LLCAgent(k(), dcfg.llcconfig);
+      llc->register_statistics(statistics_);
       // Register LLC with memory controllers; assumes that all LLC can
       // reach all Memory Controllers which may or may not be the case
       // in a real system.
@@ -138,13 +146,33 @@ void SocTop::build(const SocConfig& cfg) {
       // Dir is Null filter, it must therefore interact
       // directly with the memory controller to initiate
       // lookups/writebacks to main memory.
-      // TODO
+      for (MemCntrlAgent* mm : mms_) {
+        mm->register_agent(dm);
+      }
     }
 
     for (CpuCluster* cluster : ccs_) {
       dm->register_command_queue(cluster->cc());
     }
   }
+
+  build_agent_ids();
+}
+
+void SocTop::build_agent_ids() {
+  // Agents exchanging credits or messages across the interconnect
+  // are assigned a dense id such that per-agent tables (credit
+  // counters, endpoint queues) may be flat arrays. The CPU cluster is
+  // numbered in addition to its cache controller as Dt credits are
+  // registered against the cluster.
+  std::size_t id = 0;
+  for (MemCntrlAgent* mm : mms_) mm->set_id(id++);
+  for (CpuCluster* cpuc : ccs_) {
+    cpuc->set_id(id++);
+    cpuc->cc()->set_id(id++);
+  }
+  for (DirAgent* dm : dms_) dm->set_id(id++);
+  for (LLCAgent* llc : llcs_) llc->set_id(id++);
 }
 
 bool SocTop::elab() {
@@ -177,8 +205,9 @@ bool SocTop::elab() {
       do_retry = true;
     } break;
     case 1: {
-      // Second pass; update credit counters.
+      // Second pass; update credit counters and queue fan-in.
       elab_credit_counts();
+      elab_fanin_counts();
       do_retry = true;
     } break;
     case 2: {
@@ -219,8 +248,8 @@ void SocTop::elab_bind_ports() {
     const DirAgentConfig& cfg = dm->config();
     if (!cfg.is_null_filter) {
       LLCAgent* llc = dm->llc();
-      // Bind memory controller
-      llc->set_mc(mms_.front());
+      // Bind memory controllers
+      llc->set_mcs(mms_, cfg_.mem_interleave);
       // Bind directory
       llc->set_dir(dm);
       //
@@ -230,6 +259,9 @@ void SocTop::elab_bind_ports() {
       llc_port->set_egress(llc->endpoint());
       // LLC -> NOC
       llc->set_llc_noc__port(llc_port);
+    } else {
+      // Bind memory controllers
+      dm->set_mcs(mms_, cfg_.mem_interleave);
     }
   }
   for (MemCntrlAgent* mm : mms_) {
@@ -240,25 +272,24 @@ void SocTop::elab_bind_ports() {
     mm->set_mem_noc__port(port);
   }
   // Construct directory mapper
-  dm_ = new SingleDirMapper(*dms_.begin());
+  if (dms_.size() == 1) {
+    dm_ = new SingleDirMapper(dms_.front());
+  } else {
+    dm_ = new InterleavedDirMapper(dms_, cfg_.dir_interleave);
+  }
   for (CpuCluster* cc : ccs_) {
     cc->set_dm(dm_);
   }
-  // Register CC <-> LLC ports
-  for (DirAgent* dm : dms_) {
-    LLCAgent* llc = dm->llc();
-    for (CpuCluster* cc : ccs_) {
-      llc->register_cc(cc);
-    }
-  }
 }
 
 void SocTop::elab_credit_counts() {
+  // Each Message Queue targeted by credited traffic is sized to its
+  // configured (local) depth plus the total number of credits that can
+  // target it, such that the queue can never overflow whilst
+  // originators respect their credits. Design Rule Check subsequently
+  // fails elaboration for any queue whose capacity is insufficient.
   MessageQueue* mq = nullptr;
 
-  // Map of credits allocated to a given Message Queue.
-  std::map<MessageQueue*, std::size_t> mqcredits;
-
   // Update CPU Cluster to Directory credit paths.
   for (CpuCluster* cpuc : ccs_) {
     CCAgent* cc = cpuc->cc();
@@ -273,7 +304,7 @@ void SocTop::elab_credit_counts() {
                                   dcfg.coh_srt_credits_n);
       mq = dm->mq_by_msg_cls(MessageClass::CohSrt, cc);
       if (mq != nullptr) {
-        mqcredits[mq] += dcfg.coh_cmd_credits_n;
+        mq->add_credits(dcfg.coh_srt_credits_n);
       }
 
       // Coherence command message
@@ -281,7 +312,19 @@ void SocTop::elab_credit_counts() {
                                   dcfg.coh_cmd_credits_n);
       mq = dm->mq_by_msg_cls(MessageClass::CohCmd, cc);
       if (mq != nullptr) {
-        mqcredits[mq] += dcfg.coh_cmd_credits_n;
+        mq->add_credits(dcfg.coh_cmd_credits_n);
+      }
+
+      // Each CohEnd (CohCmdRsp) returned to the Cpu Cluster releases
+      // one of its CohSrt (CohCmd) credits; the responses which may be
+      // outstanding from the directory are bounded by those credits.
+      mq = cc->mq_by_msg_cls(MessageClass::CohEnd);
+      if (mq != nullptr) {
+        mq->add_credits(dcfg.coh_srt_credits_n);
+      }
+      mq = cc->mq_by_msg_cls(MessageClass::CohCmdRsp);
+      if (mq != nullptr) {
+        mq->add_credits(dcfg.coh_cmd_credits_n);
       }
     }
 
@@ -296,7 +339,14 @@ void SocTop::elab_credit_counts() {
                                   ccfg.dt_credits_n);
       mq = cpuc_dest->cc()->mq_by_msg_cls(MessageClass::Dt);
       if (mq != nullptr) {
-        mqcredits[mq] += ccfg.dt_credits_n;
+        mq->add_credits(ccfg.dt_credits_n);
+      }
+
+      // Likewise, each DtRsp returned by the destination releases a
+      // Dt credit.
+      mq = cc->mq_by_msg_cls(MessageClass::DtRsp);
+      if (mq != nullptr) {
+        mq->add_credits(ccfg.dt_credits_n);
       }
     }
   }
@@ -310,17 +360,37 @@ void SocTop::elab_credit_counts() {
       dm->register_credit_counter(MessageClass::CohSnp, cc, ccfg.snp_credits_n);
       mq = cc->mq_by_msg_cls(MessageClass::CohSnp);
       if (mq != nullptr) {
-        mqcredits[mq] += ccfg.snp_credits_n;
+        mq->add_credits(ccfg.snp_credits_n);
       }
     }
   }
+}
 
-  // Now that credit counters have been set, update the capacity of
-  // the destination Message Queues.
-  for (const auto& mqcredit : mqcredits) {
-    mq = mqcredit.first;
-    const std::size_t credits = mqcredit.second;
-    mq->resize(credits);
+void SocTop::elab_fanin_counts() {
+  // Queues which are not governed by credits must accept a message
+  // from each originator which may issue to them. Queues local to an
+  // agent are annotated upon construction; the fan-in of queues
+  // reached through the NOC is a function of the topology. (Responses
+  // to the Cpu Cluster are bounded by the credits of the commands
+  // which elicit them; see elab_credit_counts).
+  std::vector<MessageQueue*> endpoints;
+  for (CpuCluster* cpuc : ccs_) {
+    endpoints.push_back(cpuc->noc_cc__msg_q());
+  }
+  for (DirAgent* dm : dms_) {
+    endpoints.push_back(dm->endpoint());
+    if (!dm->config().is_null_filter) {
+      endpoints.push_back(dm->llc()->endpoint());
+    }
+  }
+  for (MemCntrlAgent* mm : mms_) {
+    endpoints.push_back(mm->endpoint());
+  }
+  // An endpoint may receive from any other agent on the NOC; its
+  // ingress queue is grown where necessary.
+  for (MessageQueue* mq : endpoints) {
+    mq->add_fanin(endpoints.size() - 1);
+    if (mq->n() < mq->fanin_n()) mq->resize(mq->fanin_n());
   }
 }
 
@@ -356,6 +426,37 @@ void SocTop::drc() {
     LogMessage msg("No CPU clusters have been defined.", Level::Fatal);
     log(msg);
   }
+
+  auto is_pow2 = [](std::uint64_t x) {
+    return (x != 0) && ((x & (x - 1)) == 0);
+  };
+  for (const InterleaveConfig* il :
+       {&cfg_.dir_interleave, &cfg_.mem_interleave}) {
+    if (!is_pow2(il->line_bytes) || !is_pow2(il->page_bytes)) {
+      LogMessage msg("Interleave line and page sizes must be powers of two.",
+                     Level::Fatal);
+      log(msg);
+    }
+  }
+
+  // Lines homed to a directory share the directory interleave index;
+  // where the banks of its LLC are selected by the same function, only
+  // a subset of the banks are ever accessed.
+  auto is_same = [](const InterleaveConfig& a, const InterleaveConfig& b) {
+    return (a.type == b.type) && (a.line_bytes == b.line_bytes) &&
+           (a.page_bytes == b.page_bytes);
+  };
+  for (const DirAgentConfig& dcfg : cfg_.dcfgs) {
+    const LLCAgentConfig& llccfg = dcfg.llcconfig;
+    if ((cfg_.dcfgs.size() > 1) && !dcfg.is_null_filter &&
+        (llccfg.bank_n > 1) &&
+        is_same(cfg_.dir_interleave, llccfg.bank_interleave)) {
+      LogMessage msg("LLC bank interleave matches the directory interleave; "
+                     "some banks are unused: ", Level::Warning);
+      msg.append(dcfg.name);
+      log(msg);
+    }
+  }
 }
 
 Soc::Soc(const SocConfig& cfg) { build(cfg); }
@@ -367,8 +468,11 @@ Soc::~Soc() {
 
 void Soc::initialize() {
   kernel::SimPhaseRunner runner(kernel_);
-  runner.elab();
-  runner.drc();
+  if (!elaborated_) {
+    runner.elab();
+    runner.drc();
+    elaborated_ = true;
+  }
   runner.init();
 }
 
@@ -382,6 +486,11 @@ void Soc::finalize() {
   runner.fini();
 }
 
+void Soc::reset() {
+  kernel::SimPhaseRunner runner(kernel_);
+  runner.reset();
+}
+
 void Soc::build(const SocConfig& cfg) {
   // Construct simulation kernel
   kernel_ = new kernel::Kernel(1);
@@ -26,31 +26,509 @@
 //========================================================================== //
 
 #include "stats.h"
-#include "l1cache.h"
-#include "l2cache.h"
-#include "cpu.h"
-#include "dir.h"
-#include "ccntrl.h"
+#include "cache.h"
+#include "primitives.h"
+#include "sim.h"
+#include "utility.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <utility>
 
 namespace cc {
 
-std::string CpuStatisticsState::to_string() const {
-  using std::to_string;
-  KVListRenderer r;
-  r.add_field("transaction_count", to_string(transaction_count));
-  return r.to_string();
+namespace {
+
+// Summary of histogram 'h' as (suffix, value) fields.
+std::vector<std::pair<std::string, std::string> > summarize(
+    const Histogram& h) {
+  std::ostringstream mean;
+  mean << h.mean();
+  return {{"_n", std::to_string(h.n())},
+          {"_mean", mean.str()},
+          {"_p50", std::to_string(h.quantile(0.5))},
+          {"_p99", std::to_string(h.quantile(0.99))},
+          {"_p999", std::to_string(h.quantile(0.999))},
+          {"_max", std::to_string(h.max())}};
+}
+
+// Paths of the writers of line 'l'.
+std::vector<std::string> writer_paths(const HotLineTracker::Line& l) {
+  std::vector<std::string> paths;
+  for (const HotLineTracker::Writer& w : l.writers) {
+    paths.push_back(w.agent->path());
+  }
+  return paths;
+}
+
+}  // namespace
+
+double Histogram::mean() const {
+  return (n_ == 0) ? 0 : static_cast<double>(sum_) / n_;
+}
+
+std::uint64_t Histogram::quantile(double q) const {
+  if (n_ == 0) return 0;
+
+  // Rank of sample at quantile.
+  std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(q * n_));
+  rank = std::min(std::max<std::uint64_t>(rank, 1), n_);
+
+  std::uint64_t cum = 0;
+  for (std::size_t i = 0; i < buckets_n; i++) {
+    const std::uint64_t c = buckets_[i];
+    if (cum + c < rank) {
+      cum += c;
+      continue;
+    }
+    if (i == 0) return 0;
+    // Interpolate within bucket [2^(i-1), 2^i).
+    const long double lo = std::ldexp(1.0L, i - 1);
+    const long double hi = std::ldexp(1.0L, i) - 1;
+    const long double v = lo + (hi - lo) * (rank - cum) / c;
+    const std::uint64_t r = static_cast<std::uint64_t>(v);
+    return std::min(std::max(r, min()), max_);
+  }
+  return max_;
+}
+
+void Histogram::add(std::uint64_t v) {
+  std::size_t i = 0;
+  for (std::uint64_t x = v; x != 0; x >>= 1) i++;
+  buckets_[i]++;
+  if (n_ == 0 || v < min_) min_ = v;
+  if (v > max_) max_ = v;
+  sum_ += v;
+  n_++;
+}
+
+CountMinSketch::CountMinSketch(std::size_t width, std::size_t depth)
+    : width_(width), depth_(depth), counts_(width * depth, 0) {}
+
+std::uint64_t CountMinSketch::add(std::uint64_t key, std::uint64_t n) {
+  std::uint64_t est = std::numeric_limits<std::uint64_t>::max();
+  for (std::size_t row = 0; row < depth_; row++) {
+    std::uint64_t& c = counts_[row * width_ + index(row, key)];
+    c += n;
+    est = std::min(est, c);
+  }
+  return est;
+}
+
+std::uint64_t CountMinSketch::estimate(std::uint64_t key) const {
+  std::uint64_t est = std::numeric_limits<std::uint64_t>::max();
+  for (std::size_t row = 0; row < depth_; row++) {
+    est = std::min(est, counts_[row * width_ + index(row, key)]);
+  }
+  return est;
+}
+
+void CountMinSketch::reset() { std::fill(counts_.begin(), counts_.end(), 0); }
+
+std::size_t CountMinSketch::index(std::size_t row, std::uint64_t key) const {
+  // SplitMix64 finalizer, seeded per row.
+  std::uint64_t x = key + (row + 1) * 0x9E3779B97F4A7C15ull;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+  x = x ^ (x >> 31);
+  return static_cast<std::size_t>(x % width_);
+}
+
+bool HotLineTracker::Line::is_false_sharing() const {
+  if (writers.size() < 2) return false;
+  std::uint64_t seen = 0;
+  for (const Writer& w : writers) {
+    if ((seen & w.offsets) != 0) return false;
+    seen |= w.offsets;
+  }
+  return true;
 }
 
-std::string L1CacheStatisticsState::to_string() const {
-  using std::to_string;
-  KVListRenderer r;
-  r.add_field("store_hit_n", to_string(store_hit_n));
-  r.add_field("store_miss_n", to_string(store_miss_n));
-  r.add_field("load_hit_n", to_string(load_hit_n));
-  r.add_field("load_miss_n", to_string(load_miss_n));
-  return r.to_string();
+HotLineTracker::HotLineTracker(std::size_t k, std::size_t writers_table_n)
+    : k_(k), writers_(writers_table_n) {
+  heap_.reserve(k_);
 }
 
+bool HotLineTracker::record(addr_t addr, addr_t offset, const Agent* agent,
+                            bool is_write, std::size_t snoop_n) {
+  const std::uint64_t mask = offset_mask(offset);
+  LastWriter& lw = writers_[(addr >> offset_bits_) % writers_.size()];
+  // Prior writer of the line, if known.
+  const Writer prior = (lw.addr == addr) ? lw.w : Writer{};
+  const bool migrated =
+      is_write && prior.agent != nullptr && prior.agent != agent;
+  if (is_write) {
+    if (lw.addr != addr || lw.w.agent != agent) {
+      lw = LastWriter{addr, Writer{agent, 0}};
+    }
+    lw.w.offsets |= mask;
+  }
+
+  const std::uint64_t events = snoop_n + (migrated ? 1 : 0);
+  if (events == 0) return migrated;
+
+  Line* l = touch(addr, sketch_.add(addr, events));
+  if (l == nullptr) return migrated;
+
+  if (l->writers.empty() && prior.agent != nullptr && prior.agent != agent) {
+    // Newly retained; seed writers from the prior writer.
+    l->writers.push_back(prior);
+  }
+  l->snoop_n += snoop_n;
+  if (migrated) l->migration_n++;
+  if (is_write) {
+    l->invalidation_n += snoop_n;
+    auto it = std::find_if(l->writers.begin(), l->writers.end(),
+                           [&](const Writer& w) { return w.agent == agent; });
+    if (it != l->writers.end()) {
+      it->offsets |= mask;
+    } else if (l->writers.size() < writers_n) {
+      l->writers.push_back(Writer{agent, mask});
+    }
+  }
+  return migrated;
+}
+
+std::vector<HotLineTracker::Line> HotLineTracker::top() const {
+  std::vector<Line> lines = heap_;
+  std::stable_sort(
+      lines.begin(), lines.end(),
+      [](const Line& a, const Line& b) { return a.score > b.score; });
+  return lines;
+}
+
+void HotLineTracker::reset() {
+  sketch_.reset();
+  heap_.clear();
+  std::fill(writers_.begin(), writers_.end(), LastWriter{});
+}
+
+HotLineTracker::Line* HotLineTracker::touch(addr_t addr,
+                                            std::uint64_t score) {
+  auto cmp = [](const Line& a, const Line& b) { return a.score > b.score; };
+  auto make_line = [&]() {
+    Line l;
+    l.addr = addr;
+    l.score = score;
+    return l;
+  };
+  auto it = std::find_if(heap_.begin(), heap_.end(),
+                         [&](const Line& l) { return l.addr == addr; });
+  if (it != heap_.end()) {
+    // Retained; score only increases, restore heap order.
+    it->score = score;
+    std::make_heap(heap_.begin(), heap_.end(), cmp);
+  } else if (heap_.size() < k_) {
+    heap_.push_back(make_line());
+    std::push_heap(heap_.begin(), heap_.end(), cmp);
+  } else if (k_ != 0 && score > heap_.front().score) {
+    // Displace least contended line.
+    std::pop_heap(heap_.begin(), heap_.end(), cmp);
+    heap_.back() = make_line();
+    std::push_heap(heap_.begin(), heap_.end(), cmp);
+  } else {
+    return nullptr;
+  }
+  it = std::find_if(heap_.begin(), heap_.end(),
+                    [&](const Line& l) { return l.addr == addr; });
+  return &*it;
+}
+
+std::uint64_t HotLineTracker::offset_mask(addr_t offset) const {
+  // Fold offsets of lines wider than 64B into 64 buckets.
+  const std::size_t shift = (offset_bits_ > 6) ? (offset_bits_ - 6) : 0;
+  return std::uint64_t{1} << ((offset >> shift) & 63);
+}
+
+void StatBlock::accept(StatVisitor* visitor) const {
+  for (const Entry& e : entries_) {
+    switch (e.kind) {
+      case Kind::Counter: {
+        visitor->visit(e.name, static_cast<const Counter*>(e.p)->value());
+      } break;
+      case Kind::Count: {
+        visitor->visit(e.name, *static_cast<const std::uint64_t*>(e.p));
+      } break;
+      case Kind::Gauge: {
+        visitor->visit(e.name, *static_cast<const Gauge*>(e.p));
+      } break;
+      case Kind::Histogram: {
+        visitor->visit(e.name, *static_cast<const Histogram*>(e.p));
+      } break;
+      case Kind::HotLines: {
+        visitor->visit(e.name, *static_cast<const HotLineTracker*>(e.p));
+      } break;
+    }
+  }
+}
+
+void StatBlock::reset() {
+  // Statistics are registered by const pointer for rendering, but are
+  // members of the (mutable) derived block or owning primitive.
+  for (const Entry& e : entries_) {
+    switch (e.kind) {
+      case Kind::Counter: {
+        *const_cast<Counter*>(static_cast<const Counter*>(e.p)) = Counter{};
+      } break;
+      case Kind::Count: {
+        *const_cast<std::uint64_t*>(static_cast<const std::uint64_t*>(e.p)) =
+            0;
+      } break;
+      case Kind::Gauge: {
+        *const_cast<Gauge*>(static_cast<const Gauge*>(e.p)) = Gauge{};
+      } break;
+      case Kind::Histogram: {
+        *const_cast<Histogram*>(static_cast<const Histogram*>(e.p)) =
+            Histogram{};
+      } break;
+      case Kind::HotLines: {
+        const_cast<HotLineTracker*>(static_cast<const HotLineTracker*>(e.p))
+            ->reset();
+      } break;
+    }
+  }
+}
+
+void StatBlock::add(const std::string& name, const Counter* c) {
+  entries_.push_back(Entry{name, Kind::Counter, c});
+}
+
+void StatBlock::add(const std::string& name, const std::uint64_t* n) {
+  entries_.push_back(Entry{name, Kind::Count, n});
+}
+
+void StatBlock::add(const std::string& name, const Gauge* g) {
+  entries_.push_back(Entry{name, Kind::Gauge, g});
+}
+
+void StatBlock::add(const std::string& name, const Histogram* h) {
+  entries_.push_back(Entry{name, Kind::Histogram, h});
+}
+
+void StatBlock::add(const std::string& name, const HotLineTracker* h) {
+  entries_.push_back(Entry{name, Kind::HotLines, h});
+}
+
+CpuStatBlock::CpuStatBlock(const std::string& path) : StatBlock(path) {
+  add("issue_n", &issue_n);
+  add("retire_n", &retire_n);
+  add("ld_latency", &ld_latency);
+  add("st_latency", &st_latency);
+  add("l1_hit_latency", &l1_hit_latency);
+  add("l2_hit_latency", &l2_hit_latency);
+  add("c2c_latency", &c2c_latency);
+  add("mem_latency", &mem_latency);
+  add("dir_latency", &dir_latency);
+  for (std::size_t i = 0; i < stage_latency.size(); i++) {
+    const std::string stage = to_string(static_cast<TransactionStage>(i));
+    add("stage_" + stage, &stage_latency[i]);
+  }
+}
+
+void CpuStatBlock::record_latency(const Transaction* t, bool is_ld) {
+  using Stage = TransactionStage;
+  const kernel::Time::time_type start = t->start_time().time;
+  const kernel::Time::time_type end = t->stamp(Stage::L1Rsp);
+  const std::uint64_t latency = end - start;
+
+  // By opcode
+  (is_ld ? ld_latency : st_latency).add(latency);
+
+  // By point at which the transaction was serviced.
+  if (!t->has_stamp(Stage::L1Miss)) {
+    l1_hit_latency.add(latency);
+  } else if (!t->has_stamp(Stage::L2Miss)) {
+    l2_hit_latency.add(latency);
+  } else if (t->has_stamp(Stage::Fill)) {
+    mem_latency.add(latency);
+  } else if (t->has_stamp(Stage::SnoopIssue)) {
+    c2c_latency.add(latency);
+  } else {
+    dir_latency.add(latency);
+  }
+
+  // By stage; latency relative to the prior stage reached.
+  kernel::Time::time_type prior = start;
+  for (std::size_t i = 0; i < stage_latency.size(); i++) {
+    const Stage stage = static_cast<Stage>(i);
+    if (!t->has_stamp(stage)) continue;
+    const kernel::Time::time_type time = t->stamp(stage);
+    stage_latency[i].add(time - prior);
+    prior = time;
+  }
+}
+
+L1CacheStatBlock::L1CacheStatBlock(const std::string& path)
+    : StatBlock(path) {
+  add("load_hit_n", &load_hit_n);
+  add("load_miss_n", &load_miss_n);
+  add("store_hit_n", &store_hit_n);
+  add("store_miss_n", &store_miss_n);
+}
+
+void L1CacheStatBlock::bind_cache(const CacheStatistics& stats) {
+  add("eviction_n", &stats.evictions);
+}
+
+L2CacheStatBlock::L2CacheStatBlock(const std::string& path)
+    : StatBlock(path) {
+  add("l1_cmd_n", &l1_cmd_n);
+  add("l1_put_n", &l1_put_n);
+  add("snoop_n", &snoop_n);
+  add("recall_n", &recall_n);
+  add("stall_n", &stall_n);
+}
+
+void L2CacheStatBlock::bind_cache(const CacheStatistics& stats) {
+  add("eviction_n", &stats.evictions);
+}
+
+CCStatBlock::CCStatBlock(const std::string& path) : StatBlock(path) {
+  add("cmd_n", &cmd_n);
+  add("snoop_n", &snoop_n);
+  add("credit_stall_n", &credit_stall_n);
+  add("queue_stall_n", &queue_stall_n);
+}
+
+DirStatBlock::DirStatBlock(const std::string& path) : StatBlock(path) {
+  add("cmd_n", &cmd_n);
+  add("writeback_n", &writeback_n);
+  add("snoop_rsp_n", &snoop_rsp_n);
+  add("llc_rsp_n", &llc_rsp_n);
+  add("credit_stall_n", &credit_stall_n);
+  add("table_stall_n", &table_stall_n);
+  add("migration_n", &migration_n);
+  add("invalidation_n", &invalidation_n);
+  add("invalidation_fanout", &invalidation_fanout);
+  add("hot_lines", &hot_lines);
+}
+
+void DirStatBlock::bind_cache(const CacheStatistics& stats) {
+  add("eviction_n", &stats.evictions);
+}
+
+void DirStatBlock::record_transaction(addr_t addr, addr_t offset,
+                                      const Agent* agent, bool is_write,
+                                      std::size_t snoop_n) {
+  if (is_write) {
+    invalidation_n.inc(snoop_n);
+    invalidation_fanout.add(snoop_n);
+  }
+  if (hot_lines.record(addr, offset, agent, is_write, snoop_n)) {
+    migration_n.inc();
+  }
+}
+
+NocStatBlock::NocStatBlock(const std::string& path) : StatBlock(path) {
+  add("forward_n", &forward_n);
+}
+
+LLCStatBlock::LLCStatBlock(const std::string& path) : StatBlock(path) {
+  add("fill_n", &fill_n);
+  add("put_n", &put_n);
+  add("credit_stall_n", &credit_stall_n);
+  add("bank_conflict_n", &bank_conflict_n);
+}
+
+MemStatBlock::MemStatBlock(const std::string& path) : StatBlock(path) {
+  add("read_n", &read_n);
+  add("write_n", &write_n);
+  add("row_hit_n", &row_hit_n);
+  add("row_miss_n", &row_miss_n);
+  add("row_conflict_n", &row_conflict_n);
+  add("refresh_n", &refresh_n);
+  add("write_drain_n", &write_drain_n);
+  add("bytes_n", &bytes_n);
+  add("bus_busy_n", &bus_busy_n);
+  add("bandwidth", &bandwidth);
+  add("read_latency", &read_latency);
+  add("write_latency", &write_latency);
+  add("rdq_occupancy", &rdq_occupancy);
+  add("wrq_occupancy", &wrq_occupancy);
+}
+
+void MemStatBlock::record_transfer(std::uint64_t bytes, cursor_t start,
+                                   cursor_t done) {
+  bytes_n.inc(bytes);
+  if (done > start) bandwidth = (bytes_n.value() * 1000) / (done - start);
+}
+
+MessageQueueStatBlock::MessageQueueStatBlock(const std::string& path,
+                                             const MessageQueueStats& stats)
+    : PrimitiveStatBlock(path) {
+  for (std::size_t i = 0; i < MessageQueueStats::reasons_n; i++) {
+    const std::string reason = to_string(static_cast<BlockReason>(i));
+    add("blocked_time_" + reason, &stats.blocked_time[i]);
+    add("blocked_n_" + reason, &stats.blocked_n[i]);
+  }
+  add("full_time", &stats.full_time);
+  add("occupancy", &stats.occupancy);
+}
+
+CreditCounterStatBlock::CreditCounterStatBlock(
+    const std::string& path, const CreditCounterStats& stats)
+    : PrimitiveStatBlock(path) {
+  add("empty_time", &stats.empty_time);
+  add("exhausted_n", &stats.exhausted_n);
+}
+
+TableStatBlock::TableStatBlock(const std::string& path,
+                               const TableStats& stats)
+    : PrimitiveStatBlock(path) {
+  add("full_time", &stats.full_time);
+}
+
+//
+//
+class Statistics::SamplerProcess : public kernel::Process {
+ public:
+  SamplerProcess(kernel::Kernel* k, const std::string& name, Statistics* s)
+      : Process(k, name), s_(s) {}
+
+ private:
+  // Initialization
+  void init() override {
+    const time_t interval = s_->sampler_config_.interval;
+    if (interval == 0) return;
+
+    s_->sampler_init();
+    wait_for(interval_time());
+  }
+
+  // Evaluation
+  void eval() override {
+    s_->sample(k()->time().time);
+    // Reschedule only while other actions remain; otherwise, the
+    // sampler alone would sustain the simulation indefinitely.
+    if (k()->events_n() != 0) {
+      wait_for(interval_time());
+    }
+  }
+
+  // Finalization
+  void fini() override {
+    if (s_->sampler_config_.interval == 0) return;
+
+    // Final sample at end of simulation.
+    s_->sample(k()->time().time);
+    s_->sampler_flush();
+  }
+
+  // Sample interval as a kernel time; interval is non-negative (drc).
+  kernel::Time interval_time() const {
+    return kernel::Time{
+        static_cast<kernel::Time::time_type>(s_->sampler_config_.interval),
+        0};
+  }
+
+  // Owning statistics module.
+  Statistics* s_ = nullptr;
+};
+
 Statistics::Statistics(kernel::Kernel* k, const std::string& name)
     : Module(k, name) {
   struct ReporterProcess : kernel::Process {
@@ -60,7 +538,11 @@ Statistics::Statistics(kernel::Kernel* k, const std::string& name)
     void set_statistics(Statistics* s) { s_ = s; }
 
     // Callbacks
+    void init() override {
+      s_->register_primitives();
+    }
     void fini() override {
+      s_->finalize_primitives();
       s_->report_statistics();
     }
     
@@ -72,117 +554,446 @@ Statistics::Statistics(kernel::Kernel* k, const std::string& name)
   r->set_statistics(this);
   reporter_ = r;
   add_child_process(r);
+
+  sampler_ = new SamplerProcess(k, "sampler", this);
+  add_child_process(sampler_);
 }
 
 Statistics::~Statistics() {
-  // Destruct CPU statistics
-  for (const std::pair<Cpu*, CpuStatisticsState*>& p : cpu_stats_) {
-    delete p.second;
-  }
-  // Destruct L1 cache statistics
-  for (const std::pair<L1CacheAgent*, L1CacheStatisticsState*>& p : l1c_stats_) {
-    delete p.second;
-  }
   delete reporter_;
+  delete sampler_;
 }
 
-const CpuStatisticsState* Statistics::cpu_state(Cpu* cpu) const {
-  const CpuStatisticsState* cstate = nullptr;
-  if (auto it = cpu_stats_.find(cpu); it != cpu_stats_.end()) {
-    cstate = it->second;
+void Statistics::drc() {
+  if (sampler_config_.interval < 0) {
+    LogMessage msg("Sampler interval must be non-negative.", Level::Fatal);
+    log(msg);
+  }
+  if (sampler_config_.interval != 0) {
+    if (sampler_config_.filename.empty()) {
+      LogMessage msg("Sampler output filename has not been set.",
+                     Level::Fatal);
+      log(msg);
+    }
+    if (sampler_config_.depth == 0) {
+      LogMessage msg("Sampler depth must be non-zero.", Level::Fatal);
+      log(msg);
+    }
   }
-  return cstate;
 }
 
-const L1CacheStatisticsState* Statistics::l1c_state(L1CacheAgent* l1c) const {
-  const L1CacheStatisticsState* lstate = nullptr;
-  if (auto it = l1c_stats_.find(l1c); it != l1c_stats_.end()) {
-    lstate = it->second;
-  }
-  return lstate;
+void Statistics::reset() {
+  for (const auto& p : blocks_) p.second->reset();
+  // Series are rediscovered, and the sampler output reopened, upon
+  // initialization.
+  series_.clear();
+  samples_n_ = 0;
+  if (sampler_os_.is_open()) sampler_os_.close();
 }
 
-// Register CPU instance
-void Statistics::register_client(Cpu* cpu) {
-  cpus_.insert(cpu);
+void Statistics::register_primitives() {
+  if (primitives_registered_) return;
+
+  struct PrimitiveVisitor : kernel::ObjectVisitor {
+    explicit PrimitiveVisitor(Statistics* s) : s_(s) {}
+    void visit(kernel::Module* m) override {
+      // Modules may be reachable from more than one parent.
+      if (!visited_.insert(m).second) return;
 
-  cpu_stats_[cpu] = new CpuStatisticsState;
+      if (const MessageQueue* mq = dynamic_cast<const MessageQueue*>(m)) {
+        s_->register_block<MessageQueueStatBlock>(mq->path(), mq->stats());
+        s_->mqs_.push_back(mq);
+      } else if (const CreditCounter* cc =
+                     dynamic_cast<const CreditCounter*>(m)) {
+        s_->register_block<CreditCounterStatBlock>(cc->path(), cc->stats());
+        s_->ccntrs_.push_back(cc);
+      } else if (const TableBase* t = dynamic_cast<const TableBase*>(m)) {
+        s_->register_block<TableStatBlock>(t->path(), t->stats());
+        s_->tables_.push_back(t);
+      }
+    }
+    Statistics* s_ = nullptr;
+    std::set<const kernel::Module*> visited_;
+  };
+  PrimitiveVisitor visitor(this);
+  visitor.iterate(k()->top());
+  primitives_registered_ = true;
 }
 
-// Register L1 cache instance
-void Statistics::register_client(L1CacheAgent* l1c) {
-  l1cs_.insert(l1c);
+void Statistics::finalize_primitives() {
+  struct FinalizeVisitor : kernel::ObjectVisitor {
+    void visit(kernel::Module* m) override {
+      // Modules may be reachable from more than one parent.
+      if (!visited_.insert(m).second) return;
 
-  l1c_stats_[l1c] = new L1CacheStatisticsState;
+      if (MessageQueue* mq = dynamic_cast<MessageQueue*>(m)) {
+        mq->fini();
+      } else if (CreditCounter* cc = dynamic_cast<CreditCounter*>(m)) {
+        cc->fini();
+      } else if (TableBase* t = dynamic_cast<TableBase*>(m)) {
+        t->fini();
+      }
+    }
+    std::set<const kernel::Module*> visited_;
+  };
+  FinalizeVisitor visitor;
+  visitor.iterate(k()->top());
 }
 
-// Register L2 cache instance
-void Statistics::register_client(L2CacheAgent* l2c) {
+std::vector<const MessageQueue*> Statistics::bottlenecks(
+    std::size_t n) const {
+  auto score = [](const MessageQueue* mq) {
+    return mq->stats().total_blocked_time() + mq->stats().full_time;
+  };
+  std::vector<const MessageQueue*> mqs;
+  for (const MessageQueue* mq : mqs_) {
+    if (score(mq) != 0) mqs.push_back(mq);
+  }
+  std::stable_sort(mqs.begin(), mqs.end(),
+                   [&](const MessageQueue* a, const MessageQueue* b) {
+                     return score(a) > score(b);
+                   });
+  if (mqs.size() > n) mqs.resize(n);
+  return mqs;
 }
 
-// Register NOC agent instance.
-void Statistics::register_client(NocModel* noc) {
-}
+void Statistics::sampler_init() {
+  using Kind = Series::Kind;
 
-// Register Directory agent instance.
-void Statistics::register_client(DirAgent* dir) {
-}
+  register_primitives();
 
-// Register Cache Controller agent instance.
-void Statistics::register_client(CCAgent* cc) {
-}
+  // Scalar statistics of all registered blocks.
+  for (const auto& p : blocks_) {
+    for (const StatBlock::Entry& e : p.second->entries_) {
+      const std::string name = p.first + "." + e.name;
+      switch (e.kind) {
+        case StatBlock::Kind::Counter: {
+          series_.push_back(Series{name, Kind::Counter, e.p});
+        } break;
+        case StatBlock::Kind::Count: {
+          series_.push_back(Series{name, Kind::Count, e.p});
+        } break;
+        case StatBlock::Kind::Gauge: {
+          series_.push_back(Series{name, Kind::Gauge, e.p});
+        } break;
+        default: {
+          // Distributions are not sampled.
+        } break;
+      }
+    }
+  }
 
-void Statistics::start_transaction_event(Cpu* cpu) {
-}
+  // Occupancy of Message Queues, Credit Counters and Tables.
+  for (const MessageQueue* mq : mqs_) {
+    series_.push_back(Series{mq->path() + ".occupancy", Kind::MessageQueue,
+                             mq});
+  }
+  for (const CreditCounter* cc : ccntrs_) {
+    series_.push_back(Series{cc->path() + ".credits", Kind::CreditCounter,
+                             cc});
+  }
+  for (const TableBase* t : tables_) {
+    series_.push_back(Series{t->path() + ".fill", Kind::Table, t});
+  }
 
-void Statistics::end_transaction_event(Cpu* cpu) {
-  if (auto it = cpu_stats_.find(cpu); it != cpu_stats_.end()) {
-    CpuStatisticsState* s = it->second;
-    s->transaction_count++;
-  } else {
-    // CPU not found; error out.
+  // Kernel event queue depth.
+  series_.push_back(Series{"kernel.events_n", Kind::Events, k()});
+
+  // Retain selected series.
+  const std::vector<std::string>& select = sampler_config_.select;
+  if (!select.empty()) {
+    auto is_selected = [&](const Series& s) {
+      for (const std::string& prefix : select) {
+        if (s.name.compare(0, prefix.size(), prefix) == 0) return true;
+      }
+      return false;
+    };
+    series_.erase(std::remove_if(series_.begin(), series_.end(),
+                                 [&](const Series& s) {
+                                   return !is_selected(s);
+                                 }),
+                  series_.end());
   }
+
+  samples_.resize((series_.size() + 1) * sampler_config_.depth);
+  samples_n_ = 0;
+
+  sampler_os_.open(sampler_config_.filename);
+  sampler_os_ << "time";
+  for (const Series& s : series_) sampler_os_ << "," << s.name;
+  sampler_os_ << "\n";
 }
 
-void Statistics::event(L1CacheStatistics::Event event, L1CacheAgent* l1c) {
-  if (auto it = l1c_stats_.find(l1c); it != l1c_stats_.end()) {
-    L1CacheStatisticsState* s = it->second;
-    switch (event) {
-      case L1CacheStatistics::StoreHit: {
-        s->store_hit_n++;
+void Statistics::sample(kernel::Time::time_type time) {
+  using Kind = Series::Kind;
+
+  if (samples_n_ == sampler_config_.depth) sampler_flush();
+
+  const std::size_t depth = sampler_config_.depth;
+  std::int64_t* row = samples_.data() + samples_n_;
+  row[0] = static_cast<std::int64_t>(time);
+  for (std::size_t i = 0; i < series_.size(); i++) {
+    const Series& s = series_[i];
+    std::int64_t v = 0;
+    switch (s.kind) {
+      case Kind::Counter: {
+        v = static_cast<const Counter*>(s.p)->value();
+      } break;
+      case Kind::Count: {
+        v = *static_cast<const std::uint64_t*>(s.p);
+      } break;
+      case Kind::Gauge: {
+        v = static_cast<const Gauge*>(s.p)->value();
       } break;
-      case L1CacheStatistics::LoadHit: {
-        s->load_hit_n++;
+      case Kind::MessageQueue: {
+        v = static_cast<const MessageQueue*>(s.p)->size();
       } break;
-      case L1CacheStatistics::StoreMiss: {
-        s->store_miss_n++;
+      case Kind::CreditCounter: {
+        v = static_cast<const CreditCounter*>(s.p)->i();
       } break;
-      case L1CacheStatistics::LoadMiss: {
-        s->load_miss_n++;
+      case Kind::Table: {
+        v = static_cast<const TableBase*>(s.p)->size();
+      } break;
+      case Kind::Events: {
+        v = static_cast<const kernel::Kernel*>(s.p)->events_n();
       } break;
     }
-  } else {
-    // 
+    row[(i + 1) * depth] = v;
+  }
+  samples_n_++;
+}
+
+void Statistics::sampler_flush() {
+  const std::size_t depth = sampler_config_.depth;
+  for (std::size_t r = 0; r < samples_n_; r++) {
+    sampler_os_ << samples_[r];
+    for (std::size_t i = 0; i < series_.size(); i++) {
+      sampler_os_ << "," << samples_[(i + 1) * depth + r];
+    }
+    sampler_os_ << "\n";
+  }
+  sampler_os_.flush();
+  samples_n_ = 0;
+}
+
+const StatBlock* Statistics::lookup(const std::string& path) const {
+  const StatBlock* b = nullptr;
+  if (auto it = blocks_.find(path); it != blocks_.end()) {
+    b = it->second.get();
+  }
+  return b;
+}
+
+namespace {
+
+// Object hierarchy node; a block is attached to the node at its path.
+struct PathNode {
+  std::map<std::string, PathNode> children;
+  const StatBlock* block = nullptr;
+};
+
+// Render node 'n' as a JSON object: the statistics of its block
+// followed by its children.
+void write_json_node(std::ostream& os, const PathNode& n, std::size_t depth) {
+  struct JsonVisitor : StatVisitor {
+    JsonVisitor(std::ostream& os, std::size_t depth, bool& first)
+        : os_(os), indent_(2 * depth, ' '), first_(first) {}
+    void visit(const std::string& name, std::uint64_t value) override {
+      emit(name, std::to_string(value));
+    }
+    void visit(const std::string& name, const Gauge& g) override {
+      emit(name, std::to_string(g.value()));
+      emit(name + "_max", std::to_string(g.max()));
+    }
+    void visit(const std::string& name, const Histogram& h) override {
+      for (const auto& f : summarize(h)) emit(name + f.first, f.second);
+    }
+    void visit(const std::string& name, const HotLineTracker& h) override {
+      std::ostringstream ss;
+      ss << "[";
+      const char* sep = "";
+      for (const HotLineTracker::Line& l : h.top()) {
+        ss << sep << "{\"addr\": " << l.addr << ", \"score\": " << l.score
+           << ", \"migration_n\": " << l.migration_n
+           << ", \"invalidation_n\": " << l.invalidation_n
+           << ", \"snoop_n\": " << l.snoop_n << ", \"writers\": [";
+        const char* wsep = "";
+        for (const std::string& w : writer_paths(l)) {
+          ss << wsep << "\"" << w << "\"";
+          wsep = ", ";
+        }
+        ss << "], \"false_sharing\": "
+           << (l.is_false_sharing() ? "true" : "false") << "}";
+        sep = ", ";
+      }
+      ss << "]";
+      emit(name, ss.str());
+    }
+    void emit(const std::string& name, const std::string& value) {
+      os_ << (first_ ? "\n" : ",\n") << indent_ << "\"" << name
+          << "\": " << value;
+      first_ = false;
+    }
+    std::ostream& os_;
+    std::string indent_;
+    bool& first_;
+  };
+
+  bool first = true;
+  os << "{";
+  if (n.block != nullptr) {
+    JsonVisitor v(os, depth + 1, first);
+    n.block->accept(&v);
+  }
+  for (const auto& p : n.children) {
+    os << (first ? "\n" : ",\n") << std::string(2 * (depth + 1), ' ')
+       << "\"" << p.first << "\": ";
+    write_json_node(os, p.second, depth + 1);
+    first = false;
+  }
+  os << "\n" << std::string(2 * depth, ' ') << "}";
+}
+
+}  // namespace
+
+void Statistics::write_json(std::ostream& os) const {
+  PathNode root;
+  for (const auto& p : blocks_) {
+    std::vector<std::string> path;
+    split(std::back_inserter(path), p.first);
+    PathNode* n = &root;
+    for (const std::string& s : path) {
+      n = &n->children[s];
+    }
+    n->block = p.second.get();
+  }
+  write_json_node(os, root, 0);
+  os << "\n";
+}
+
+void Statistics::write_csv(std::ostream& os) const {
+  struct CsvVisitor : StatVisitor {
+    CsvVisitor(std::ostream& os, const std::string& path)
+        : os_(os), path_(path) {}
+    void visit(const std::string& name, std::uint64_t value) override {
+      os_ << path_ << "," << name << "," << value << "\n";
+    }
+    void visit(const std::string& name, const Gauge& g) override {
+      os_ << path_ << "," << name << "," << g.value() << "\n";
+      os_ << path_ << "," << name << "_max," << g.max() << "\n";
+    }
+    void visit(const std::string& name, const Histogram& h) override {
+      for (const auto& f : summarize(h)) {
+        os_ << path_ << "," << name << f.first << "," << f.second << "\n";
+      }
+    }
+    std::ostream& os_;
+    const std::string& path_;
+  };
+
+  os << "path,name,value\n";
+  for (const auto& p : blocks_) {
+    CsvVisitor v(os, p.first);
+    p.second->accept(&v);
   }
 }
 
 void Statistics::report_statistics() const {
-  // Report CPu stastics
-  for (const auto& p : cpu_stats_) {
-    LogMessage msg("CPU statistics path ");
-    msg.append(p.first->path());
+  struct KVVisitor : StatVisitor {
+    void visit(const std::string& name, std::uint64_t value) override {
+      r.add_field(name, std::to_string(value));
+    }
+    void visit(const std::string& name, const Gauge& g) override {
+      r.add_field(name, std::to_string(g.value()));
+      r.add_field(name + "_max", std::to_string(g.max()));
+    }
+    void visit(const std::string& name, const Histogram& h) override {
+      // Empty histograms are elided from the log.
+      if (h.n() == 0) return;
+      for (const auto& f : summarize(h)) r.add_field(name + f.first, f.second);
+    }
+    KVListRenderer r;
+  };
+
+  for (const auto& p : blocks_) {
+    // Primitives are summarized by the bottleneck report below.
+    if (dynamic_cast<const PrimitiveStatBlock*>(p.second.get()) != nullptr) {
+      continue;
+    }
+    KVVisitor v;
+    p.second->accept(&v);
+    LogMessage msg("Statistics ");
+    msg.append(p.first);
     msg.append(": ");
-    msg.append(p.second->to_string());
+    msg.append(v.r.to_string());
     log(msg);
   }
-  // Report L1 Cache statistics
-  for (const auto& p : l1c_stats_) {
-    LogMessage msg("L1 Cache statistics ");
-    msg.append(p.first->path());
+
+  // Bottleneck report: queues ranked by time blocked or full.
+  std::size_t rank = 1;
+  for (const MessageQueue* mq : bottlenecks(10)) {
+    const MessageQueueStats& stats = mq->stats();
+    KVListRenderer r;
+    r.add_field("blocked_time", std::to_string(stats.total_blocked_time()));
+    for (std::size_t i = 0; i < MessageQueueStats::reasons_n; i++) {
+      if (stats.blocked_time[i] == 0) continue;
+      r.add_field(to_string(static_cast<BlockReason>(i)),
+                  std::to_string(stats.blocked_time[i]));
+    }
+    r.add_field("full_time", std::to_string(stats.full_time));
+    r.add_field("occupancy_p99", std::to_string(stats.occupancy.quantile(0.99)));
+    r.add_field("occupancy_max", std::to_string(stats.occupancy.max()));
+    LogMessage msg("Bottleneck ");
+    msg.append(std::to_string(rank++));
+    msg.append(" ");
+    msg.append(mq->path());
     msg.append(": ");
-    msg.append(p.second->to_string());
+    msg.append(r.to_string());
     log(msg);
   }
+
+  // Hot line report: most contended lines of each tracker.
+  struct HotLineVisitor : StatVisitor {
+    void visit(const std::string& name, std::uint64_t value) override {}
+    void visit(const std::string& name, const Gauge& g) override {}
+    void visit(const std::string& name, const Histogram& h) override {}
+    void visit(const std::string& name, const HotLineTracker& h) override {
+      lines = h.top();
+    }
+    std::vector<HotLineTracker::Line> lines;
+  };
+  for (const auto& p : blocks_) {
+    HotLineVisitor v;
+    p.second->accept(&v);
+    std::size_t rank = 1;
+    for (const HotLineTracker::Line& l : v.lines) {
+      Hexer h;
+      KVListRenderer r;
+      r.add_field("addr", h.to_hex(l.addr));
+      r.add_field("score", std::to_string(l.score));
+      r.add_field("migration_n", std::to_string(l.migration_n));
+      r.add_field("invalidation_n", std::to_string(l.invalidation_n));
+      r.add_field("snoop_n", std::to_string(l.snoop_n));
+      const std::vector<std::string> writers = writer_paths(l);
+      r.add_field("writers", join(writers.begin(), writers.end(), ","));
+      r.add_field("false_sharing", to_string(l.is_false_sharing()));
+      LogMessage msg("Hot line ");
+      msg.append(std::to_string(rank++));
+      msg.append(" ");
+      msg.append(p.first);
+      msg.append(": ");
+      msg.append(r.to_string());
+      log(msg);
+    }
+  }
+  if (!json_filename_.empty()) {
+    std::ofstream ofs(json_filename_);
+    write_json(ofs);
+  }
+  if (!csv_filename_.empty()) {
+    std::ofstream ofs(csv_filename_);
+    write_csv(ofs);
+  }
 }
 
 } // namespace cc
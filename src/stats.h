@@ -28,157 +28,670 @@
 #ifndef CC_SRC_STATS_H
 #define CC_SRC_STATS_H
 
+#include "cc/cfgs.h"
 #include "cc/kernel.h"
-#include <set>
+#include "cc/types.h"
+#include "msg.h"
+#include <array>
+#include <cstdint>
+#include <fstream>
 #include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace cc {
 
-class Cpu;
-class L1CacheAgent;
-class L2CacheAgent;
-class NocModel;
-class DirAgent;
-class CCAgent;
+class Agent;
+struct CacheStatistics;
+struct MessageQueueStats;
+struct CreditCounterStats;
+struct TableStats;
+class MessageQueue;
+class CreditCounter;
+class TableBase;
 
+// Monotonically increasing event count.
+//
+class Counter {
+ public:
+  Counter() = default;
+
+  // Current count.
+  std::uint64_t value() const { return n_; }
+
+  // Increment count by 'n'.
+  void inc(std::uint64_t n = 1) { n_ += n; }
+
+ private:
+  // Count
+  std::uint64_t n_ = 0;
+};
+
+// Instantaneous level which additionally retains its high-water mark.
+//
+class Gauge {
+ public:
+  Gauge() = default;
+
+  // Current level
+  std::int64_t value() const { return v_; }
+
+  // High-water mark.
+  std::int64_t max() const { return max_; }
+
+  // Set current level.
+  void set(std::int64_t v) {
+    v_ = v;
+    if (v_ > max_) max_ = v_;
+  }
+
+  // Increment current level by 'n'.
+  void inc(std::int64_t n = 1) { set(v_ + n); }
+
+  // Decrement current level by 'n'.
+  void dec(std::int64_t n = 1) { set(v_ - n); }
+
+ private:
+  // Current level
+  std::int64_t v_ = 0;
+  // High-water mark
+  std::int64_t max_ = 0;
+};
+
+// Distribution of (latency) samples in logarithmically sized buckets:
+// bucket 0 holds zero and bucket i holds [2^(i-1), 2^i). Quantiles are
+// estimated by interpolation within the bucket in which they fall and
+// are therefore exact to within a factor of two.
+//
+class Histogram {
+ public:
+  // Number of buckets.
+  static constexpr std::size_t buckets_n = 65;
+
+  Histogram() = default;
+
+  // Number of samples.
+  std::uint64_t n() const { return n_; }
+
+  // Sum of samples.
+  std::uint64_t sum() const { return sum_; }
+
+  // Minimum sample (zero if empty).
+  std::uint64_t min() const { return (n_ == 0) ? 0 : min_; }
+
+  // Maximum sample.
+  std::uint64_t max() const { return max_; }
+
+  // Mean sample (zero if empty).
+  double mean() const;
+
+  // Count of samples in bucket 'i'.
+  std::uint64_t bucket(std::size_t i) const { return buckets_[i]; }
+
+  // Estimate of the sample at quantile 'q' in [0, 1].
+  std::uint64_t quantile(double q) const;
 
-struct CpuStatistics {
-  // Start transaction
-  virtual void start_transaction_event(Cpu* cpu) = 0;
+  // Add sample 'v'.
+  void add(std::uint64_t v);
 
-  // End transaction
-  virtual void end_transaction_event(Cpu* cpu) = 0;
+ private:
+  // Samples by bucket.
+  std::array<std::uint64_t, buckets_n> buckets_{};
+  // Sample count
+  std::uint64_t n_ = 0;
+  // Sample sum
+  std::uint64_t sum_ = 0;
+  // Minimum sample
+  std::uint64_t min_ = 0;
+  // Maximum sample
+  std::uint64_t max_ = 0;
 };
 
+// Approximate per-key event counts in bounded memory: 'depth' rows of
+// 'width' counters, each row indexed by an independent hash of the
+// key. The estimate of a key is the minimum of its counters and
+// therefore never under-counts; over-counting is bounded by the
+// collisions within the least contended row.
+//
+class CountMinSketch {
+ public:
+  explicit CountMinSketch(std::size_t width = 1024, std::size_t depth = 4);
+
+  // Add 'n' to the count of 'key'; return the updated estimate.
+  std::uint64_t add(std::uint64_t key, std::uint64_t n = 1);
 
-struct CpuStatisticsState {
-  // Convert to humand-readable format.
-  std::string to_string() const;
-  
-  // Total number of transaction that have completed.
-  std::size_t transaction_count = 0;
+  // Estimated count of 'key'.
+  std::uint64_t estimate(std::uint64_t key) const;
+
+  // Clear all counts.
+  void reset();
+
+ private:
+  // Index of the counter of 'key' in 'row'.
+  std::size_t index(std::size_t row, std::uint64_t key) const;
+
+  // Counters per row.
+  std::size_t width_;
+  // Row count
+  std::size_t depth_;
+  // Counters (row-major).
+  std::vector<std::uint64_t> counts_;
 };
 
+// Coherence activity by cache line, retaining detail for the 'k' most
+// contended lines only. Contention (ownership migrations and snoops) of
+// every line is counted in a Count-Min sketch; a line enters the top-k
+// min-heap once its estimate exceeds that of the least contended line
+// retained. Migrations are detected against the last writer of a line
+// recorded in a direct-mapped table, and are therefore approximate
+// where lines alias in the table.
+//
+class HotLineTracker {
+ public:
+  // Maximum number of distinct writers retained per line.
+  static constexpr std::size_t writers_n = 8;
+
+  // Agent which has written a line, and the byte offsets (in 64
+  // buckets per line) at which it has written.
+  struct Writer {
+    const Agent* agent = nullptr;
+    std::uint64_t offsets = 0;
+  };
+
+  // Retained line.
+  struct Line {
+    // Line-aligned address
+    addr_t addr = 0;
+    // Estimated contention (migrations and snoops)
+    std::uint64_t score = 0;
+    // Ownership migrations (since retained)
+    std::uint64_t migration_n = 0;
+    // Invalidating snoops (since retained)
+    std::uint64_t invalidation_n = 0;
+    // Snoops (since retained)
+    std::uint64_t snoop_n = 0;
+    // Writers of the line.
+    std::vector<Writer> writers;
+
+    // Line is likely falsely shared: it has been written by more than
+    // one agent, but no byte offset has been written by more than one.
+    bool is_false_sharing() const;
+  };
+
+  explicit HotLineTracker(std::size_t k = 16,
+                          std::size_t writers_table_n = 4096);
+
+  // Set the number of line offset bits (the line size).
+  void set_offset_bits(std::size_t offset_bits) { offset_bits_ = offset_bits; }
+
+  // Record coherence transaction by 'agent' to byte 'offset' of the line
+  // at 'addr' which required 'snoop_n' snoops; the line has been
+  // acquired for writing where 'is_write'. Return true if ownership of
+  // the line has migrated from another agent.
+  bool record(addr_t addr, addr_t offset, const Agent* agent, bool is_write,
+              std::size_t snoop_n);
 
+  // Retained lines, most contended first.
+  std::vector<Line> top() const;
 
-struct L1CacheStatistics {
-  enum Event {
-    StoreHit, LoadHit, StoreMiss, LoadMiss
+  // Discard all retained lines and contention history.
+  void reset();
+
+ private:
+  // Last writer of a line.
+  struct LastWriter {
+    addr_t addr = 0;
+    Writer w;
   };
 
-  virtual void event(Event event, L1CacheAgent* l1c) = 0;
+  // Update the score of line 'addr' to 'score', retaining the line if
+  // it is now amongst the 'k' most contended; return the retained line
+  // or nullptr.
+  Line* touch(addr_t addr, std::uint64_t score);
+
+  // Offset bucket mask of byte 'offset'.
+  std::uint64_t offset_mask(addr_t offset) const;
+
+  // Number of retained lines
+  std::size_t k_;
+  // Line offset bits.
+  std::size_t offset_bits_ = 6;
+  // Contention sketch
+  CountMinSketch sketch_;
+  // Retained lines; min-heap on score.
+  std::vector<Line> heap_;
+  // Last writer table (direct-mapped on line).
+  std::vector<LastWriter> writers_;
 };
 
-struct L1CacheStatisticsState {
-  // Convert to humand-readable format.
-  std::string to_string() const;
-  
-  // Total number of store hits
-  std::size_t store_hit_n = 0;
+// Visitor over the statistics of a StatBlock.
+//
+struct StatVisitor {
+  virtual ~StatVisitor() = default;
+
+  // Visit counter 'name'.
+  virtual void visit(const std::string& name, std::uint64_t value) = 0;
 
-  // Total number of store misses.
-  std::size_t store_miss_n = 0;
+  // Visit gauge 'name'.
+  virtual void visit(const std::string& name, const Gauge& g) = 0;
 
-  // Total number of load hits
-  std::size_t load_hit_n = 0;
+  // Visit histogram 'name'.
+  virtual void visit(const std::string& name, const Histogram& h) = 0;
 
-  // total number of load misses.
-  std::size_t load_miss_n = 0;
+  // Visit hot line tracker 'name' (ignored by default).
+  virtual void visit(const std::string& name, const HotLineTracker& h) {}
 };
 
+// Collection of named statistics belonging to the object at 'path'. An
+// agent derives its own block, defining statistics as members and
+// registering each by name upon construction. The agent retains a
+// pointer to its block such that statistics are updated in place,
+// without lookup.
+//
+class StatBlock {
+  friend class Statistics;
 
-class Statistics : public kernel::Module,
-                   public CpuStatistics,
-                   public L1CacheStatistics {
  public:
-  Statistics(kernel::Kernel* k, const std::string& name);
-  virtual ~Statistics();
+  explicit StatBlock(const std::string& path) : path_(path) {}
+  virtual ~StatBlock() = default;
 
-  // Accumulated statistics:
+  // Path of owning object.
+  const std::string& path() const { return path_; }
 
-  // CPU statistics:
-  const CpuStatisticsState* cpu_state(Cpu* cpu) const;
+  // Visit registered statistics, in order of registration.
+  void accept(StatVisitor* visitor) const;
 
-  // L1 statistics
-  const L1CacheStatisticsState* l1c_state(L1CacheAgent* l1c) const;
+  // Return registered statistics to their initial state.
+  void reset();
 
-  
-  // Registration methods:
-  
-  // Register CPU instance.
-  void register_client(Cpu* cpu);
+ protected:
+  // Register counter 'c' as 'name'.
+  void add(const std::string& name, const Counter* c);
 
-  // Register L1 cache instance.
-  void register_client(L1CacheAgent* l1c);
+  // Register externally maintained count 'n' as 'name'.
+  void add(const std::string& name, const std::uint64_t* n);
 
-  // Register L2 cache instance.
-  void register_client(L2CacheAgent* l2c);
+  // Register gauge 'g' as 'name'.
+  void add(const std::string& name, const Gauge* g);
 
-  // Register NOC agent instance.
-  void register_client(NocModel* noc);
+  // Register histogram 'h' as 'name'.
+  void add(const std::string& name, const Histogram* h);
 
-  // Register Directory agent instance.
-  void register_client(DirAgent* dir);
+  // Register hot line tracker 'h' as 'name'.
+  void add(const std::string& name, const HotLineTracker* h);
 
-  // Register Cache Controller agent instance.
-  void register_client(CCAgent* cc);
+ private:
+  // Statistic kind
+  enum class Kind { Counter, Count, Gauge, Histogram, HotLines };
+
+  // Registered statistic.
+  struct Entry {
+    std::string name;
+    Kind kind;
+    const void* p;
+  };
 
+  // Path of owning object.
+  std::string path_;
+  // Registered statistics
+  std::vector<Entry> entries_;
+};
 
-  // CPU statistics:
-  //
+// CPU statistics.
+//
+struct CpuStatBlock : StatBlock {
+  explicit CpuStatBlock(const std::string& path);
+
+  // Record the latency of retired transaction 't' (a Load where
+  // 'is_ld', otherwise a Store).
+  void record_latency(const Transaction* t, bool is_ld);
+
+  // Transactions issued.
+  Counter issue_n;
+  // Transactions retired.
+  Counter retire_n;
+  // Load latency
+  Histogram ld_latency;
+  // Store latency
+  Histogram st_latency;
+  // Latency of transactions which hit in the L1
+  Histogram l1_hit_latency;
+  // Latency of transactions which hit in the L2
+  Histogram l2_hit_latency;
+  // Latency of transactions serviced by a peer cache (snooped)
+  Histogram c2c_latency;
+  // Latency of transactions serviced by memory
+  Histogram mem_latency;
+  // Latency of transactions serviced by the directory alone (upgrades)
+  Histogram dir_latency;
+  // Latency from the previous stage to each stage, by stage.
+  std::array<Histogram, static_cast<std::size_t>(TransactionStage::Invalid)>
+      stage_latency;
+};
 
-  // Start transaction
-  void start_transaction_event(Cpu* cpu) override;
+// L1 cache statistics.
+//
+struct L1CacheStatBlock : StatBlock {
+  explicit L1CacheStatBlock(const std::string& path);
+
+  // Bind cache model statistics.
+  void bind_cache(const CacheStatistics& stats);
+
+  // Load hits
+  Counter load_hit_n;
+  // Load misses
+  Counter load_miss_n;
+  // Store hits
+  Counter store_hit_n;
+  // Store misses
+  Counter store_miss_n;
+};
 
-  // End transaction
-  void end_transaction_event(Cpu* cpu) override;
+// L2 cache statistics.
+//
+struct L2CacheStatBlock : StatBlock {
+  explicit L2CacheStatBlock(const std::string& path);
+
+  // Bind cache model statistics.
+  void bind_cache(const CacheStatistics& stats);
+
+  // Commands received from child L1
+  Counter l1_cmd_n;
+  // Writebacks (Puts) received from child L1
+  Counter l1_put_n;
+  // Snoops received from cache controller
+  Counter snoop_n;
+  // Recalls (invalidations) of lines in child L1
+  Counter recall_n;
+  // Stalls awaiting resources (queue slots, table entries)
+  Counter stall_n;
+};
 
-  // L1 Cache statistics:
-  //
-  void event(L1CacheStatistics::Event event, L1CacheAgent* agent) override;
+// Cache controller statistics.
+//
+struct CCStatBlock : StatBlock {
+  explicit CCStatBlock(const std::string& path);
+
+  // Commands received from L2
+  Counter cmd_n;
+  // Snoops received from directories
+  Counter snoop_n;
+  // Stalls awaiting credits
+  Counter credit_stall_n;
+  // Stalls awaiting L2 queue slots
+  Counter queue_stall_n;
+};
 
-  
-  // Write hit
-  // void write_hit_event(L1CacheAgent* l1c) override;
+// Directory statistics.
+//
+struct DirStatBlock : StatBlock {
+  explicit DirStatBlock(const std::string& path);
+
+  // Bind cache model statistics.
+  void bind_cache(const CacheStatistics& stats);
+
+  // Record completed coherence transaction by 'agent' to byte 'offset'
+  // of the line at 'addr' which required 'snoop_n' snoops; the line
+  // has been acquired for writing where 'is_write'.
+  void record_transaction(addr_t addr, addr_t offset, const Agent* agent,
+                          bool is_write, std::size_t snoop_n);
+
+  // Coherence commands received
+  Counter cmd_n;
+  // Coherence writebacks (WriteBack/Evict) received
+  Counter writeback_n;
+  // Snoop responses received
+  Counter snoop_rsp_n;
+  // LLC responses received
+  Counter llc_rsp_n;
+  // Stalls awaiting credits
+  Counter credit_stall_n;
+  // Stalls awaiting transaction table entries
+  Counter table_stall_n;
+  // Ownership migrations (line written by an agent other than its
+  // previous writer)
+  Counter migration_n;
+  // Invalidating snoops issued
+  Counter invalidation_n;
+  // Invalidating snoops issued per write transaction
+  Histogram invalidation_fanout;
+  // Most contended lines
+  HotLineTracker hot_lines;
+};
 
-  // Read hit
-  //void read_hit_event(L1CacheAgent* l1c) override;
-  
+// NOC statistics.
+//
+struct NocStatBlock : StatBlock {
+  explicit NocStatBlock(const std::string& path);
 
-  // L2 Cache statistics:
-  //
-  // TBD
+  // Messages forwarded
+  Counter forward_n;
+};
 
-  // NOC statistics:
-  //
-  // TBD
+// LLC statistics.
+//
+struct LLCStatBlock : StatBlock {
+  explicit LLCStatBlock(const std::string& path);
+
+  // Fills from memory
+  Counter fill_n;
+  // Lines transferred to requesting agents
+  Counter put_n;
+  // Stalls awaiting NOC credits
+  Counter credit_stall_n;
+  // Commands arriving at a bank with further commands pending
+  Counter bank_conflict_n;
+};
 
-  // Directory statistics:
-  //
-  // TBD
+// Memory controller statistics.
+//
+struct MemStatBlock : StatBlock {
+  explicit MemStatBlock(const std::string& path);
+
+  // Record transfer of a line whose data transfer completed at
+  // 'done'; first command arrived at the controller at 'start'.
+  void record_transfer(std::uint64_t bytes, cursor_t start, cursor_t done);
+
+  // Reads serviced
+  Counter read_n;
+  // Writes serviced
+  Counter write_n;
+  // Accesses to the open row (row buffer hits)
+  Counter row_hit_n;
+  // Accesses to a bank with no open row
+  Counter row_miss_n;
+  // Accesses to a bank with some other row open (bank conflicts)
+  Counter row_conflict_n;
+  // Rank refreshes
+  Counter refresh_n;
+  // Write drain episodes
+  Counter write_drain_n;
+  // Bytes transferred
+  Counter bytes_n;
+  // Time during which channel data buses are occupied
+  Counter bus_busy_n;
+  // Achieved bandwidth; bytes per 1000 time units, from the arrival of
+  // the first command to the completion of the latest transfer
+  std::uint64_t bandwidth = 0;
+  // Read latency; arrival to completion of data transfer
+  Histogram read_latency;
+  // Write latency; arrival to completion of data transfer
+  Histogram write_latency;
+  // Read queue occupancy
+  Gauge rdq_occupancy;
+  // Write queue occupancy
+  Gauge wrq_occupancy;
+};
 
-  // Cache Controller statistics:
-  //
-  // TBD
+// Instrumentation of a simulation primitive (Message Queue, Credit
+// Counter or Table). Primitive blocks are rendered to JSON and CSV,
+// but are summarized in the log by the bottleneck report alone.
+//
+struct PrimitiveStatBlock : StatBlock {
+  explicit PrimitiveStatBlock(const std::string& path) : StatBlock(path) {}
+};
 
+// Message Queue back-pressure statistics.
+//
+struct MessageQueueStatBlock : PrimitiveStatBlock {
+  MessageQueueStatBlock(const std::string& path,
+                        const MessageQueueStats& stats);
+};
+
+// Credit Counter statistics.
+//
+struct CreditCounterStatBlock : PrimitiveStatBlock {
+  CreditCounterStatBlock(const std::string& path,
+                         const CreditCounterStats& stats);
+};
+
+// Table statistics.
+//
+struct TableStatBlock : PrimitiveStatBlock {
+  TableStatBlock(const std::string& path, const TableStats& stats);
+};
+
+// Statistics registry: the set of StatBlock in the simulation, keyed
+// by object path. Upon finalization, statistics are reported to the
+// log and optionally rendered as JSON (nested by path) and CSV.
+//
+// Where configured, a sampler additionally records a time-series of
+// the scalar statistics, Message Queue occupancies, credit levels,
+// table fills and the kernel event count at a fixed interval.
+//
+class Statistics : public kernel::Module {
+  class SamplerProcess;
+
+ public:
+  Statistics(kernel::Kernel* k, const std::string& name);
+  virtual ~Statistics();
+
+  // Configure time-series sampler.
+  void set_sampler_config(const SamplerConfig& config) {
+    sampler_config_ = config;
+  }
+
+  // Render statistics as JSON to file 'fn' upon finalization.
+  void set_json_filename(const std::string& fn) { json_filename_ = fn; }
+
+  // Render statistics as CSV to file 'fn' upon finalization.
+  void set_csv_filename(const std::string& fn) { csv_filename_ = fn; }
+
+  // Register block of type 'T' for the object at 'path', or return
+  // the block already registered. Arguments 'args' are forwarded to
+  // the block constructor following 'path'.
+  template <typename T, typename... Args>
+  T* register_block(const std::string& path, Args&&... args) {
+    std::unique_ptr<StatBlock>& b = blocks_[path];
+    if (!b) b = std::make_unique<T>(path, std::forward<Args>(args)...);
+    return static_cast<T*>(b.get());
+  }
+
+  // Message Queues ranked by time spent blocked or full (descending);
+  // at most 'n', omitting queues which never stalled. Valid after
+  // initialization.
+  std::vector<const MessageQueue*> bottlenecks(std::size_t n) const;
+
+  // Lookup block by path; nullptr if not registered.
+  const StatBlock* lookup(const std::string& path) const;
+
+  // Render statistics as JSON, nested by path.
+  void write_json(std::ostream& os) const;
+
+  // Render statistics as CSV; one row (path, name, value) per
+  // statistic.
+  void write_csv(std::ostream& os) const;
+
+  // Design Rule Check
+  void drc() override;
+
+  // Reset all registered blocks; the sampler restarts upon the next
+  // initialization.
+  void reset() override;
 
  private:
+  // Sampled series.
+  struct Series {
+    enum class Kind {
+      Counter,
+      Count,
+      Gauge,
+      MessageQueue,
+      CreditCounter,
+      Table,
+      Events
+    };
+
+    std::string name;
+    Kind kind;
+    const void* p;
+  };
+
+  // Report statistics (finalization).
   void report_statistics() const;
-  
-  // Set of register CPU instances.
-  std::set<Cpu*> cpus_;
-  
-  // CPU instance -> statistics map
-  std::map<Cpu*, CpuStatisticsState*> cpu_stats_;
 
-  // Set of registered L1 cache instances
-  std::set<L1CacheAgent*> l1cs_;
+  // Register blocks of all Message Queues, Credit Counters and Tables
+  // in the simulation (initialization; idempotent).
+  void register_primitives();
+
+  // Finalize Message Queue, Credit Counter and Table instrumentation
+  // (close intervals which remain open) before reporting.
+  void finalize_primitives();
+
+  // Discover sampled series and emit sampler header.
+  void sampler_init();
 
-  // L1 Cache -> statistic map
-  std::map<L1CacheAgent*, L1CacheStatisticsState*> l1c_stats_;
+  // Record sample of all series at time 'time'.
+  void sample(kernel::Time::time_type time);
+
+  // Write retained samples to file.
+  void sampler_flush();
+
+  // Registered blocks (ordered by path).
+  std::map<std::string, std::unique_ptr<StatBlock> > blocks_;
+
+  // JSON output filename.
+  std::string json_filename_;
+
+  // CSV output filename.
+  std::string csv_filename_;
 
   // Reporter process
   kernel::Process* reporter_ = nullptr;
+
+  // Primitive blocks have been registered.
+  bool primitives_registered_ = false;
+
+  // Message Queues in the simulation.
+  std::vector<const MessageQueue*> mqs_;
+
+  // Credit Counters in the simulation.
+  std::vector<const CreditCounter*> ccntrs_;
+
+  // Tables in the simulation.
+  std::vector<const TableBase*> tables_;
+
+  // Sampler configuration.
+  SamplerConfig sampler_config_;
+
+  // Sampler process (where enabled).
+  SamplerProcess* sampler_ = nullptr;
+
+  // Sampled series.
+  std::vector<Series> series_;
+
+  // Retained samples; column-major ('depth' rows per column) with
+  // sample time in the first column.
+  std::vector<std::int64_t> samples_;
+
+  // Number of retained samples.
+  std::size_t samples_n_ = 0;
+
+  // Sampler output.
+  std::ofstream sampler_os_;
 };
 
 } // namespace cc
@@ -27,9 +27,19 @@
 
 #include "cc/stimulus.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <algorithm>
+#include <cmath>
 #include <deque>
 #include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <vector>
 
 #include "cpu.h"
 
@@ -79,6 +89,9 @@ class DequeueContext : public StimulusContext {
     return true;
   }
 
+  // Number of pending frontiers.
+  std::size_t size() const { return fs_.size(); }
+
   // Stimulus: Consume current head of queue, or NOP if already
   // exhausted.
   void issue() override {
@@ -94,6 +107,8 @@ class DequeueContext : public StimulusContext {
     }
     fs_.push_back(f);
   }
+  // Discard pending frontiers.
+  void clear() { fs_.clear(); }
 
  private:
   // Pending frontiers
@@ -107,6 +122,11 @@ void Stimulus::issue(StimulusContext* context) { ++issue_n_; }
 
 void Stimulus::retire(StimulusContext* context) { ++retire_n_; }
 
+void Stimulus::reset() {
+  issue_n_ = 0;
+  retire_n_ = 0;
+}
+
 StimulusConfig TraceStimulus::from_string(const std::string& s) {
   StimulusConfig cfg;
   cfg.type = StimulusType::Trace;
@@ -119,8 +139,6 @@ TraceStimulus::TraceStimulus(kernel::Kernel* k, const StimulusConfig& config)
   build();
 }
 
-TraceStimulus::~TraceStimulus() { delete is_; }
-
 void TraceStimulus::build() { is_ = config().is; }
 
 bool TraceStimulus::elab() {
@@ -128,9 +146,64 @@ bool TraceStimulus::elab() {
   return false;
 }
 
-void TraceStimulus::drc() {}
+void TraceStimulus::drc() {
+  if (config().streaming && config().lookahead_n == 0) {
+    LogMessage msg("Streaming trace requires a non-zero look-ahead window.");
+    msg.set_level(Level::Fatal);
+    log(msg);
+  }
+}
 
-void TraceStimulus::parse_tracefile() {
+// Buffered reader over the trace input stream. Characters are fetched
+// from the underlying stream in large chunks rather than one at a
+// time.
+//
+class TraceReader {
+ public:
+  // Chunk size (in bytes) of each read from the underlying stream.
+  static constexpr std::size_t chunk_n = 64 * 1024;
+
+  explicit TraceReader(std::istream* is) : is_(is), buf_(chunk_n) {}
+
+  // Flag denoting that the stream has been exhausted.
+  bool eof() { return !fill(); }
+
+  // Character at the head of the stream (without consumption), or
+  // '\0' if the stream has been exhausted.
+  char peek() { return fill() ? buf_[pos_] : '\0'; }
+
+  // Consume character at the head of the stream, or '\0' if the
+  // stream has been exhausted.
+  char get() { return fill() ? buf_[pos_++] : '\0'; }
+
+ private:
+  // Refill buffer from stream if it has been drained; return false if
+  // no further characters are available.
+  bool fill() {
+    if (pos_ < len_) return true;
+    if (is_ == nullptr || !is_->good()) return false;
+
+    is_->read(buf_.data(), buf_.size());
+    len_ = static_cast<std::size_t>(is_->gcount());
+    pos_ = 0;
+    return len_ != 0;
+  }
+
+  // Underlying stream.
+  std::istream* is_ = nullptr;
+  // Chunk buffer.
+  std::vector<char> buf_;
+  // Current position in buffer.
+  std::size_t pos_ = 0;
+  // Valid characters in buffer.
+  std::size_t len_ = 0;
+};
+
+// Trace scanner state; retained across calls to
+// TraceStimulus::parse_next such that the trace can be parsed
+// incrementally.
+//
+struct TraceStimulus::Scanner {
   using time_type = kernel::Time::time_type;
 
   // Scanner states
@@ -140,13 +213,16 @@ void TraceStimulus::parse_tracefile() {
     InTime,
     InCmdIndex,
     InCmdOpcode,
-    InCmdAddr
+    InCmdAddr,
+    InCmdFlags
   };
+
+  explicit Scanner(std::istream* is) : reader(is) {}
+
+  // Buffered trace reader.
+  TraceReader reader;
   // Current scanner state.
   State state = State::Scanning;
-  // Current location in tracefile.
-  line_ = 0;
-  col_ = -1;
   // Current scanner context (some accumulated string).
   std::string ctxt;
   // Current scanner time cursor.
@@ -156,28 +232,94 @@ void TraceStimulus::parse_tracefile() {
     std::size_t cpu_index;
     CpuOpcode opcode;
     addr_t addr;
+    bool dep;
   } cmd_ctxt;
+  // Resolved index to context* mapping.
+  std::vector<DequeueContext*> ctxt_table;
+  // Trace has been exhausted.
+  bool exhausted = false;
+};
 
+// Defined after TraceStimulus::Scanner, which must be a complete type
+// at the point of deletion.
+TraceStimulus::~TraceStimulus() {
+  delete scanner_;
+  delete is_;
+}
+
+void TraceStimulus::parse_tracefile() {
+  scanner_ = new Scanner(is_);
+  // Current location in tracefile.
+  line_ = 0;
+  col_ = -1;
   // Resolve index to context* mapping.
-  const std::vector<DequeueContext*> ctxt_table = compute_index_table();
-  // Start scanning file.
-  while (!is_->eof()) {
+  scanner_->ctxt_table = compute_index_table();
+
+  if (!config().streaming) {
+    // Materialize complete trace.
+    while (parse_next()) {
+    }
+  } else {
+    // Prime look-ahead window of each context.
+    for (DequeueContext* ctxt : scanner_->ctxt_table) {
+      if (ctxt != nullptr) refill(ctxt);
+    }
+  }
+}
+
+void TraceStimulus::refill(DequeueContext* ctxt) {
+  // Commands are interleaved across contexts in the trace, therefore
+  // commands destined to other contexts are enqueued as they are
+  // encountered. Their windows remain bounded by the relative skew
+  // between CPU in the trace.
+  while (ctxt->size() < config().lookahead_n && parse_next()) {
+  }
+}
+
+void TraceStimulus::issue(StimulusContext* context) {
+  Stimulus::issue(context);
+
+  if (!config().streaming) return;
+
+  // Refill once the window has drained to half occupancy such that
+  // the scanner is invoked once per batch of commands.
+  DequeueContext* ctxt = static_cast<DequeueContext*>(context);
+  if (ctxt->size() <= config().lookahead_n / 2) {
+    refill(ctxt);
+  }
+}
+
+bool TraceStimulus::parse_next() {
+  using State = Scanner::State;
+  using time_type = Scanner::time_type;
+
+  Scanner* s = scanner_;
+  if (s->exhausted) return false;
+
+  TraceReader& reader = s->reader;
+  State& state = s->state;
+  std::string& ctxt = s->ctxt;
+  auto& cmd_ctxt = s->cmd_ctxt;
+  const std::vector<DequeueContext*>& ctxt_table = s->ctxt_table;
+  while (!reader.eof()) {
     // Advance column
     col_++;
 
-    char c = is_->get();
+    char c = reader.get();
 
     // Skip whitespace
     if (c == ' ') continue;
 
     // Check for comment
-    if (c == '/' && is_->peek() == '/') {
-      is_->get();
+    if (c == '/' && reader.peek() == '/') {
+      reader.get();
       state = State::InLineComment;
       continue;
     }
 
     if (c == '\n') {
+      // Flag denoting that a command was enqueued by the directive.
+      bool enqueued = false;
       // New line terminates current directive.
       switch (state) {
         case State::InLineComment: {
@@ -190,22 +332,39 @@ void TraceStimulus::parse_tracefile() {
           // Advance scanner time cursor.
           time_type time_delta = std::stoi(ctxt);
           ctxt.clear();
-          current_time += time_delta;
+          s->current_time += time_delta;
           // Discard ctxt.
           ctxt.clear();
         } break;
-        case State::InCmdAddr: {
-          std::size_t num_chars = 0;
-          // Auto-detect radix.
-          cmd_ctxt.addr = std::stoi(ctxt, &num_chars, 0);
+        case State::InCmdAddr:
+        case State::InCmdFlags: {
+          if (state == State::InCmdAddr) {
+            std::size_t num_chars = 0;
+            // Auto-detect radix.
+            cmd_ctxt.addr = std::stoi(ctxt, &num_chars, 0);
+            cmd_ctxt.dep = false;
+          } else if (ctxt == "DEP") {
+            cmd_ctxt.dep = true;
+          } else {
+            LogMessage msg("Invalid command flag \'");
+            msg.append(ctxt);
+            msg.append("\' at (");
+            msg.append(std::to_string(line_));
+            msg.append(", ");
+            msg.append(std::to_string(col_));
+            msg.append(")");
+            msg.set_level(Level::Fatal);
+            log(msg);
+          }
           ctxt.clear();
           // Issue completed command to CPU stimulus context.
           Frontier f;
-          f.time = kernel::Time{current_time, 0};
-          f.cmd = Command(cmd_ctxt.opcode, cmd_ctxt.addr);
+          f.time = kernel::Time{s->current_time, 0};
+          f.cmd = Command(cmd_ctxt.opcode, cmd_ctxt.addr, cmd_ctxt.dep);
           DequeueContext* ctxt = ctxt_table[cmd_ctxt.cpu_index];
           if (ctxt != nullptr) {
             ctxt->push_back(f);
+            enqueued = true;
           } else {
             LogMessage msg("Invalid CPU index detected at (");
             msg.append(std::to_string(line_));
@@ -232,6 +391,8 @@ void TraceStimulus::parse_tracefile() {
       // Advance line count.
       col_ = -1;
       line_++;
+      // Yield on completion of each command.
+      if (enqueued) return true;
     } else if (state != State::InLineComment) {
       // Otherwise, currently accumulating current directive.
       switch (state) {
@@ -285,6 +446,19 @@ void TraceStimulus::parse_tracefile() {
           }
         } break;
         case State::InCmdAddr: {
+          if (c == ',') {
+            std::size_t num_chars = 0;
+            // Auto-detect radix.
+            cmd_ctxt.addr = std::stoi(ctxt, &num_chars, 0);
+            // Advance to (optional) flags.
+            ctxt.clear();
+            state = State::InCmdFlags;
+          } else {
+            // Still accumulating (delimited by newline.)
+            ctxt += c;
+          }
+        } break;
+        case State::InCmdFlags: {
           // Still accumulating (delimited by newline.)
           ctxt += c;
         } break;
@@ -296,7 +470,7 @@ void TraceStimulus::parse_tracefile() {
             case 'C': {
               state = State::InCmdIndex;
               // Discard ':' prefix.
-              c = is_->get();
+              c = reader.get();
               if (c != ':') {
                 LogMessage msg("Expecting \':\' at (");
                 msg.append(std::to_string(line_));
@@ -323,6 +497,8 @@ void TraceStimulus::parse_tracefile() {
     msg.set_level(Level::Fatal);
     log(msg);
   }
+  s->exhausted = true;
+  return false;
 }
 
 std::vector<DequeueContext*> TraceStimulus::compute_index_table() {
@@ -346,8 +522,9 @@ std::vector<DequeueContext*> TraceStimulus::compute_index_table() {
     std::string path;
   } item;
   bool done = false;
-  while (!done && !is_->eof()) {
-    const char c = is_->peek();
+  TraceReader& reader = scanner_->reader;
+  while (!done && !reader.eof()) {
+    const char c = reader.peek();
     ++col_;
 
     // Skip whitespace
@@ -419,7 +596,7 @@ std::vector<DequeueContext*> TraceStimulus::compute_index_table() {
     }
 
     if (!done) {
-      is_->get();
+      reader.get();
     }
   }
 
@@ -466,6 +643,688 @@ StimulusContext* TraceStimulus::register_cpu(Cpu* cpu) {
   return ctxt;
 }
 
+namespace {
+
+// Binary trace magic and version.
+const char binary_trace_magic[] = {'C', 'C', 'T', 'B'};
+const std::uint8_t binary_trace_version = 2;
+
+// Decode unsigned LEB128 varint at 'p' into 'v'; returns false if the
+// varint overruns 'end'.
+bool decode_varint(const std::uint8_t*& p, const std::uint8_t* end,
+                   std::uint64_t& v) {
+  v = 0;
+  for (unsigned shift = 0; p != end && shift < 64; shift += 7) {
+    const std::uint8_t b = *p++;
+    v |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+    if ((b & 0x80) == 0) return true;
+  }
+  return false;
+}
+
+// Encode 'v' as unsigned LEB128 varint appended to 'out'.
+void encode_varint(std::string& out, std::uint64_t v) {
+  while (v >= 0x80) {
+    out.push_back(static_cast<char>((v & 0x7F) | 0x80));
+    v >>= 7;
+  }
+  out.push_back(static_cast<char>(v));
+}
+
+// Zigzag mapping of signed to unsigned (and back) such that small
+// negative deltas encode compactly.
+std::uint64_t zigzag_encode(std::int64_t v) {
+  return (static_cast<std::uint64_t>(v) << 1) ^
+         static_cast<std::uint64_t>(v >> 63);
+}
+
+std::int64_t zigzag_decode(std::uint64_t v) {
+  return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+}
+
+}  // namespace
+
+// Stimulus context decoding command records directly from a per-CPU
+// stream of a binary trace.
+//
+class BinaryTraceContext : public StimulusContext {
+ public:
+  BinaryTraceContext(Stimulus* parent, kernel::Kernel* k,
+                     const std::string& name)
+      : StimulusContext(parent, k, name) {}
+
+  // Bind stream [begin, end) and decode its first record.
+  void set_stream(const std::uint8_t* begin, const std::uint8_t* end) {
+    cur_ = begin;
+    end_ = end;
+    decode();
+  }
+
+  // Stimulus: Flag indicate that stimulus is complete
+  bool done() const override { return !valid_; }
+
+  // Stimulus: Return the next "Frontier" object to be processed,
+  // returning false if all stimulus has been consumed.
+  bool front(Frontier& f) const override {
+    if (!valid_) return false;
+
+    f = f_;
+    return true;
+  }
+
+  // Stimulus: Consume current head of stream, or NOP if already
+  // exhausted.
+  void issue() override {
+    if (valid_) {
+      decode();
+    }
+    StimulusContext::issue();
+  }
+
+ private:
+  // Decode record at the current stream position.
+  void decode() {
+    valid_ = false;
+    if (cur_ == end_) return;
+
+    std::uint64_t h, a;
+    if (!decode_varint(cur_, end_, h) || !decode_varint(cur_, end_, a)) {
+      LogMessage msg("Binary trace record overruns stream.");
+      msg.set_level(Level::Fatal);
+      log(msg);
+      return;
+    }
+    time_ += h >> 2;
+    addr_ += zigzag_decode(a);
+    f_.time = kernel::Time{time_, 0};
+    f_.cmd = Command((h & 1) ? CpuOpcode::Store : CpuOpcode::Load, addr_,
+                     (h & 2) != 0);
+    valid_ = true;
+  }
+
+  // Current stream position.
+  const std::uint8_t* cur_ = nullptr;
+  // End of stream.
+  const std::uint8_t* end_ = nullptr;
+  // Time of prior record.
+  kernel::Time::time_type time_ = 0;
+  // Address of prior record.
+  addr_t addr_ = 0;
+  // Decoded record at the head of the stream.
+  Frontier f_;
+  // Head record is valid (stream has not been exhausted).
+  bool valid_ = false;
+};
+
+StimulusConfig BinaryTraceStimulus::from_string(const std::string& s) {
+  StimulusConfig cfg;
+  cfg.type = StimulusType::BinaryTrace;
+  cfg.is = new std::istringstream(s);
+  return cfg;
+}
+
+BinaryTraceStimulus::BinaryTraceStimulus(kernel::Kernel* k,
+                                         const StimulusConfig& config)
+    : Stimulus(k, config) {
+  build();
+}
+
+BinaryTraceStimulus::~BinaryTraceStimulus() {
+  if (is_mapped_) {
+    ::munmap(const_cast<std::uint8_t*>(base_), len_);
+  }
+  delete is_;
+}
+
+void BinaryTraceStimulus::build() { is_ = config().is; }
+
+bool BinaryTraceStimulus::elab() {
+  map_tracefile();
+  parse_header();
+  return false;
+}
+
+void BinaryTraceStimulus::drc() {}
+
+void BinaryTraceStimulus::map_tracefile() {
+  const std::string& filename = config().filename;
+  if (filename.empty()) {
+    // Trace is held in stream; read in its entirety.
+    if (is_ != nullptr) {
+      std::ostringstream ss;
+      ss << is_->rdbuf();
+      image_ = ss.str();
+    }
+    base_ = reinterpret_cast<const std::uint8_t*>(image_.data());
+    len_ = image_.size();
+    return;
+  }
+
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  struct stat st;
+  if (fd < 0 || ::fstat(fd, &st) != 0) {
+    LogMessage msg("Cannot open binary trace: ");
+    msg.append(filename);
+    msg.set_level(Level::Fatal);
+    log(msg);
+    if (fd >= 0) ::close(fd);
+    return;
+  }
+  len_ = static_cast<std::size_t>(st.st_size);
+  if (len_ != 0) {
+    void* p = ::mmap(nullptr, len_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p != MAP_FAILED) {
+      // Records are consumed front to back.
+      ::madvise(p, len_, MADV_SEQUENTIAL);
+      base_ = static_cast<const std::uint8_t*>(p);
+      is_mapped_ = true;
+    } else {
+      LogMessage msg("Cannot map binary trace: ");
+      msg.append(filename);
+      msg.set_level(Level::Fatal);
+      log(msg);
+      len_ = 0;
+    }
+  }
+  // Mapping persists beyond the closure of the file descriptor.
+  ::close(fd);
+}
+
+void BinaryTraceStimulus::parse_header() {
+  const std::uint8_t* p = base_;
+  const std::uint8_t* end = base_ + len_;
+
+  auto fail = [&](const char* reason) {
+    LogMessage msg("Malformed binary trace header: ");
+    msg.append(reason);
+    msg.set_level(Level::Fatal);
+    log(msg);
+  };
+
+  // Validate magic and version.
+  if (len_ < sizeof(binary_trace_magic) + 1 ||
+      !std::equal(std::begin(binary_trace_magic), std::end(binary_trace_magic),
+                  reinterpret_cast<const char*>(p))) {
+    fail("bad magic");
+    return;
+  }
+  p += sizeof(binary_trace_magic);
+  if (*p++ != binary_trace_version) {
+    fail("unsupported version");
+    return;
+  }
+
+  // Parse CPU path map.
+  std::uint64_t cpu_n = 0;
+  if (!decode_varint(p, end, cpu_n)) {
+    fail("truncated cpu count");
+    return;
+  }
+  std::vector<std::pair<std::string, std::uint64_t> > streams;
+  for (std::uint64_t i = 0; i < cpu_n; i++) {
+    std::uint64_t path_len = 0, stream_len = 0;
+    if (!decode_varint(p, end, path_len) ||
+        static_cast<std::uint64_t>(end - p) < path_len) {
+      fail("truncated cpu path");
+      return;
+    }
+    std::string path(reinterpret_cast<const char*>(p), path_len);
+    p += path_len;
+    if (!decode_varint(p, end, stream_len)) {
+      fail("truncated stream length");
+      return;
+    }
+    streams.push_back(std::make_pair(path, stream_len));
+  }
+
+  // Bind streams to their associated contexts.
+  for (const auto& stream : streams) {
+    const std::string& cpu_path = stream.first;
+    const std::uint64_t stream_len = stream.second;
+    if (static_cast<std::uint64_t>(end - p) < stream_len) {
+      fail("truncated stream");
+      return;
+    }
+    auto it = std::find_if(cpumap_.begin(), cpumap_.end(), [&](const auto& c) {
+      return c.first->path() == cpu_path;
+    });
+    if (it != cpumap_.end()) {
+      it->second->set_stream(p, p + stream_len);
+    } else {
+      // CPU with path was not found.
+      LogMessage msg("Cannot find cpu path: ");
+      msg.append(cpu_path);
+      msg.set_level(Level::Fatal);
+      log(msg);
+    }
+    p += stream_len;
+  }
+}
+
+StimulusContext* BinaryTraceStimulus::register_cpu(Cpu* cpu) {
+  BinaryTraceContext* ctxt =
+      new BinaryTraceContext(this, k(), "stimulus_context");
+  cpumap_.insert(std::make_pair(cpu, ctxt));
+  return ctxt;
+}
+
+void convert_trace_to_binary(std::istream& is, std::ostream& os) {
+  // Command record.
+  struct Record {
+    kernel::Time::time_type time;
+    bool is_store;
+    bool dep;
+    addr_t addr;
+  };
+  // Index -> CPU path map.
+  std::map<std::size_t, std::string> paths;
+  // Index -> Per-CPU commands.
+  std::map<std::size_t, std::vector<Record> > records;
+  // Current time cursor.
+  kernel::Time::time_type current_time = 0;
+
+  std::string line;
+  std::size_t line_n = 0;
+  auto fail = [&](const std::string& reason) {
+    throw StimulusException(reason + " at line " + std::to_string(line_n));
+  };
+  while (std::getline(is, line)) {
+    ++line_n;
+    // Discard comments and whitespace.
+    if (auto pos = line.find("//"); pos != std::string::npos) {
+      line.erase(pos);
+    }
+    line.erase(std::remove(line.begin(), line.end(), ' '), line.end());
+    if (line.empty()) continue;
+
+    try {
+      switch (line[0]) {
+        case 'M': {
+          // M:INDEX,PATH
+          const std::size_t comma = line.find(',');
+          if (line.size() < 2 || line[1] != ':' ||
+              comma == std::string::npos) {
+            fail("Malformed map directive");
+          }
+          paths[std::stoul(line.substr(2, comma - 2))] =
+              line.substr(comma + 1);
+        } break;
+        case '+': {
+          // +DELTA
+          current_time += std::stoull(line.substr(1));
+        } break;
+        case 'C': {
+          // C:INDEX,{LD,ST},ADDR[,DEP]
+          const std::size_t c0 = line.find(',');
+          const std::size_t c1 =
+              (c0 == std::string::npos) ? c0 : line.find(',', c0 + 1);
+          if (line.size() < 2 || line[1] != ':' || c1 == std::string::npos) {
+            fail("Malformed command directive");
+          }
+          const std::string opcode = line.substr(c0 + 1, c1 - c0 - 1);
+          if (opcode != "LD" && opcode != "ST") {
+            fail("Invalid opcode '" + opcode + "'");
+          }
+          const std::size_t c2 = line.find(',', c1 + 1);
+          Record r;
+          r.time = current_time;
+          r.is_store = (opcode == "ST");
+          r.dep = false;
+          if (c2 != std::string::npos) {
+            const std::string flag = line.substr(c2 + 1);
+            if (flag != "DEP") {
+              fail("Invalid command flag '" + flag + "'");
+            }
+            r.dep = true;
+          }
+          r.addr = std::stoull(line.substr(c1 + 1, c2 - c1 - 1), nullptr, 0);
+          records[std::stoul(line.substr(2, c0 - 2))].push_back(r);
+        } break;
+        default: {
+          fail("Malformed trace file");
+        } break;
+      }
+    } catch (const std::logic_error& ex) {
+      // Integer conversion failure.
+      fail(std::string{"Invalid integer ("} + ex.what() + ")");
+    }
+  }
+  for (const auto& index_records : records) {
+    if (paths.find(index_records.first) == paths.end()) {
+      throw StimulusException("No CPU path mapped for index " +
+                              std::to_string(index_records.first));
+    }
+  }
+
+  // Emit header.
+  std::string header{std::begin(binary_trace_magic),
+                     std::end(binary_trace_magic)};
+  header.push_back(static_cast<char>(binary_trace_version));
+  encode_varint(header, paths.size());
+  std::string body;
+  for (const auto& index_path : paths) {
+    // Encode per-CPU stream.
+    std::string stream;
+    kernel::Time::time_type time = 0;
+    addr_t addr = 0;
+    if (auto it = records.find(index_path.first); it != records.end()) {
+      for (const Record& r : it->second) {
+        encode_varint(stream, ((r.time - time) << 2) | (r.dep ? 2 : 0) |
+                                  (r.is_store ? 1 : 0));
+        encode_varint(stream, zigzag_encode(static_cast<std::int64_t>(
+                                  r.addr - addr)));
+        time = r.time;
+        addr = r.addr;
+      }
+    }
+    const std::string& path = index_path.second;
+    encode_varint(header, path.size());
+    header += path;
+    encode_varint(header, stream.size());
+    body += stream;
+  }
+  os.write(header.data(), header.size());
+  os.write(body.data(), body.size());
+}
+
+// Stimulus context generating commands on the fly from a synthetic
+// workload specification.
+//
+class SyntheticContext : public StimulusContext {
+  using time_type = kernel::Time::time_type;
+
+ public:
+  SyntheticContext(Stimulus* parent, kernel::Kernel* k, const std::string& name)
+      : StimulusContext(parent, k, name) {}
+
+  // Bind workload specification 'spec', where 'index' is the ordinal
+  // of the CPU in the specification, and generate the first command.
+  void set_spec(const StimulusConfig& scfg, const SyntheticCpuConfig& spec,
+                std::size_t index) {
+    scfg_ = std::addressof(scfg);
+    spec_ = spec;
+    index_ = index;
+    rewind();
+  }
+
+  // Return to the start of the sequence: re-seed the random source,
+  // clear generator state and generate the first command. NOP if no
+  // specification has been bound.
+  void rewind() {
+    if (scfg_ == nullptr) return;
+
+    // Decorrelate per-CPU sequences; each is a function of the seed
+    // and the CPU ordinal alone, and therefore independent of the
+    // order in which CPU consume their stimulus.
+    rnd_ = kernel::RandomSource(scfg_->seed + index_ * 0x9E3779B97F4A7C15ull);
+    shared_ = decltype(shared_){};
+    private_ = decltype(private_){};
+    generated_n_ = 0;
+    time_ = 0;
+    pending_store_ = false;
+    pending_addr_ = 0;
+    generate();
+  }
+
+  // Stimulus: Flag indicate that stimulus is complete
+  bool done() const override { return !valid_; }
+
+  // Stimulus: Return the next "Frontier" object to be processed,
+  // returning false if all stimulus has been consumed.
+  bool front(Frontier& f) const override {
+    if (!valid_) return false;
+
+    f = f_;
+    return true;
+  }
+
+  // Stimulus: Consume current command and generate the next, or NOP
+  // if already exhausted.
+  void issue() override {
+    if (valid_) {
+      generate();
+    }
+    StimulusContext::issue();
+  }
+
+ private:
+  // Per-region address generator state.
+  struct Region {
+    // Base address.
+    addr_t base = 0;
+    // Number of lines.
+    std::uint64_t lines_n = 1;
+    // Strided/PointerChase cursor.
+    std::uint64_t cursor = 0;
+  };
+
+  // Generate next command.
+  void generate() {
+    valid_ = false;
+    if (spec_.command_n != 0 && generated_n_ == spec_.command_n) return;
+
+    ++generated_n_;
+    time_ += arrival();
+
+    CpuOpcode opcode = CpuOpcode::Load;
+    addr_t addr = 0;
+    if (pending_store_) {
+      // Complete prior read-modify-write.
+      opcode = CpuOpcode::Store;
+      addr = pending_addr_;
+      pending_store_ = false;
+    } else if (rnd_.uniform_real() < spec_.shared_fraction) {
+      addr = select_addr(shared_region());
+      switch (spec_.sharing) {
+        case SharingPattern::Producer: {
+          opcode = CpuOpcode::Store;
+        } break;
+        case SharingPattern::Consumer: {
+          opcode = CpuOpcode::Load;
+        } break;
+        case SharingPattern::Migratory: {
+          opcode = CpuOpcode::Load;
+          pending_store_ = true;
+          pending_addr_ = addr;
+        } break;
+        default: {
+          opcode = select_opcode();
+        } break;
+      }
+    } else {
+      addr = select_addr(private_region());
+      opcode = select_opcode();
+    }
+    f_.time = kernel::Time{time_, 0};
+    f_.cmd = Command{opcode, addr};
+    valid_ = true;
+  }
+
+  // Shared region (common to all CPU).
+  Region& shared_region() {
+    if (!shared_.lines_n_valid) {
+      shared_.r.base = scfg_->shared_base;
+      shared_.r.lines_n = lines_in(scfg_->shared_bytes);
+      shared_.lines_n_valid = true;
+    }
+    return shared_.r;
+  }
+
+  // Private region (unique to the CPU).
+  Region& private_region() {
+    if (!private_.lines_n_valid) {
+      private_.r.base = scfg_->private_base + index_ * scfg_->private_bytes;
+      private_.r.lines_n = lines_in(scfg_->private_bytes);
+      private_.lines_n_valid = true;
+    }
+    return private_.r;
+  }
+
+  // Number of (whole) lines in 'bytes'; at least one.
+  std::uint64_t lines_in(std::uint64_t bytes) const {
+    return std::max<std::uint64_t>(1, bytes / scfg_->line_bytes);
+  }
+
+  // Select Load or Store according to store ratio.
+  CpuOpcode select_opcode() {
+    return (rnd_.uniform_real() < spec_.store_ratio) ? CpuOpcode::Store
+                                                     : CpuOpcode::Load;
+  }
+
+  // Select line address within region 'r' according to the address
+  // distribution.
+  addr_t select_addr(Region& r) {
+    std::uint64_t line = 0;
+    switch (spec_.addr_dist) {
+      case AddrDistribution::Uniform: {
+        line = static_cast<std::uint64_t>(rnd_.uniform_real() * r.lines_n);
+      } break;
+      case AddrDistribution::Zipf: {
+        // Inverse transform of the (continuous) bounded power-law
+        // distribution over [1, lines_n + 1).
+        const double n1 = static_cast<double>(r.lines_n) + 1.0;
+        const double u = rnd_.uniform_real();
+        const double s = spec_.zipf_s;
+        double x;
+        if (std::abs(s - 1.0) < 1e-6) {
+          x = std::pow(n1, u);
+        } else {
+          const double e = 1.0 - s;
+          x = std::pow(1.0 + u * (std::pow(n1, e) - 1.0), 1.0 / e);
+        }
+        line = static_cast<std::uint64_t>(x) - 1;
+      } break;
+      case AddrDistribution::Strided: {
+        line = r.cursor;
+        const std::uint64_t stride =
+            std::max<std::uint64_t>(1, spec_.stride / scfg_->line_bytes);
+        r.cursor = (r.cursor + stride) % r.lines_n;
+      } break;
+      case AddrDistribution::PointerChase: {
+        line = r.cursor;
+        // Full-period LCG over the next power-of-two; values outside
+        // of the region are skipped such that every line is visited
+        // exactly once per traversal.
+        std::uint64_t m = 1;
+        while (m < r.lines_n) m <<= 1;
+        do {
+          r.cursor = (r.cursor * 6364136223846793005ull +
+                      1442695040888963407ull) & (m - 1);
+        } while (r.cursor >= r.lines_n);
+      } break;
+    }
+    line = std::min(line, r.lines_n - 1);
+    return r.base + line * scfg_->line_bytes;
+  }
+
+  // Compute next inter-arrival time according to the arrival
+  // distribution.
+  time_type arrival() {
+    const double mean = static_cast<double>(spec_.arrival_mean);
+    switch (spec_.arrival_dist) {
+      case ArrivalDistribution::Uniform: {
+        return static_cast<time_type>(rnd_.uniform_real() * (2 * mean + 1));
+      } break;
+      case ArrivalDistribution::Exponential: {
+        return static_cast<time_type>(-mean *
+                                      std::log(1.0 - rnd_.uniform_real()));
+      } break;
+      default: {
+        return spec_.arrival_mean;
+      } break;
+    }
+  }
+
+  // Stimulus configuration.
+  const StimulusConfig* scfg_ = nullptr;
+  // Workload specification.
+  SyntheticCpuConfig spec_;
+  // Ordinal of CPU in specification.
+  std::size_t index_ = 0;
+  // Context random source.
+  kernel::RandomSource rnd_;
+  // Lazily initialized regions.
+  struct {
+    Region r;
+    bool lines_n_valid = false;
+  } shared_, private_;
+  // Number of commands generated.
+  std::size_t generated_n_ = 0;
+  // Time of current command.
+  time_type time_ = 0;
+  // Store pending to complete read-modify-write (Migratory).
+  bool pending_store_ = false;
+  // Address of pending store.
+  addr_t pending_addr_ = 0;
+  // Generated command at the head of the context.
+  Frontier f_;
+  // Head command is valid (stimulus has not been exhausted).
+  bool valid_ = false;
+};
+
+SyntheticStimulus::SyntheticStimulus(kernel::Kernel* k,
+                                     const StimulusConfig& config)
+    : Stimulus(k, config) {}
+
+bool SyntheticStimulus::elab() {
+  // Binding a specification generates the first command, which is a
+  // function of the line size. A zero line size is rejected in drc,
+  // therefore defer binding such that elaboration completes.
+  if (config().line_bytes == 0) return false;
+
+  const std::vector<SyntheticCpuConfig>& specs = config().synthetic;
+  for (std::size_t i = 0; i < specs.size(); i++) {
+    const SyntheticCpuConfig& spec = specs[i];
+    auto it = std::find_if(cpumap_.begin(), cpumap_.end(), [&](const auto& c) {
+      return c.first->path() == spec.cpu;
+    });
+    if (it != cpumap_.end()) {
+      it->second->set_spec(config(), spec, i);
+    } else {
+      // CPU with path was not found.
+      LogMessage msg("Cannot find cpu path: ");
+      msg.append(spec.cpu);
+      msg.set_level(Level::Fatal);
+      log(msg);
+    }
+  }
+  return false;
+}
+
+void SyntheticStimulus::drc() {
+  if (config().line_bytes == 0) {
+    LogMessage msg("Synthetic stimulus line size must be non-zero.");
+    msg.set_level(Level::Fatal);
+    log(msg);
+  }
+  auto check_fraction = [&](const SyntheticCpuConfig& spec, float f,
+                            const char* name) {
+    if (f < 0.0f || f > 1.0f) {
+      LogMessage msg("Synthetic stimulus ");
+      msg.append(name);
+      msg.append(" is not in [0, 1] for cpu: ");
+      msg.append(spec.cpu);
+      msg.set_level(Level::Fatal);
+      log(msg);
+    }
+  };
+  for (const SyntheticCpuConfig& spec : config().synthetic) {
+    check_fraction(spec, spec.store_ratio, "store_ratio");
+    check_fraction(spec, spec.shared_fraction, "shared_fraction");
+  }
+}
+
+void SyntheticStimulus::reset() {
+  Stimulus::reset();
+  for (const auto& p : cpumap_) p.second->rewind();
+}
+
+StimulusContext* SyntheticStimulus::register_cpu(Cpu* cpu) {
+  SyntheticContext* ctxt = new SyntheticContext(this, k(), "stimulus_context");
+  cpumap_.insert(std::make_pair(cpu, ctxt));
+  return ctxt;
+}
+
 ProgrammaticStimulus::ProgrammaticStimulus(kernel::Kernel* k,
                                            const StimulusConfig& config)
     : Stimulus(k, config) {}
@@ -493,11 +1352,11 @@ std::uint64_t ProgrammaticStimulus::get_cpu_id(const Cpu* cpu) {
 }
 
 void ProgrammaticStimulus::push_stimulus(std::uint64_t cpu_id, CpuOpcode opcode,
-                                         addr_t addr) {
+                                         addr_t addr, bool dep) {
   if (auto it = context_map_.find(cpu_id); it != context_map_.end()) {
     Frontier f;
     f.time = kernel::Time{cursor_};
-    f.cmd = Command{opcode, addr};
+    f.cmd = Command{opcode, addr, dep};
     DequeueContext* context = it->second;
     context->push_back(f);
   } else {
@@ -506,6 +1365,12 @@ void ProgrammaticStimulus::push_stimulus(std::uint64_t cpu_id, CpuOpcode opcode,
   }
 }
 
+void ProgrammaticStimulus::reset() {
+  Stimulus::reset();
+  cursor_ = 0;
+  for (const auto& p : context_map_) p.second->clear();
+}
+
 Stimulus* stimulus_builder(kernel::Kernel* k, const StimulusConfig& cfg) {
   Stimulus* s = nullptr;
   switch (cfg.type) {
@@ -515,6 +1380,12 @@ Stimulus* stimulus_builder(kernel::Kernel* k, const StimulusConfig& cfg) {
     case StimulusType::Trace: {
       s = new TraceStimulus(k, cfg);
     } break;
+    case StimulusType::BinaryTrace: {
+      s = new BinaryTraceStimulus(k, cfg);
+    } break;
+    case StimulusType::Synthetic: {
+      s = new SyntheticStimulus(k, cfg);
+    } break;
     default: {
       // Unknown Stimulus type.
     } break;
@@ -0,0 +1,187 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#ifndef CC_SRC_TRANSITION_H
+#define CC_SRC_TRANSITION_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "utility.h"
+
+namespace cc {
+
+// Declarative protocol transition. Upon 'event' whilst in 'state',
+// and where 'guard' holds (a null guard always holds), the 'actions'
+// are invoked in order and the line advances to 'next'. Actions are
+// stateless; all per-invocation state is passed by way of ArgsT.
+//
+template <typename StateT, typename EventT, typename ArgsT,
+          std::size_t ActionN = 4>
+struct Transition {
+  using state_type = StateT;
+  using event_type = EventT;
+  using args_type = ArgsT;
+  using guard_type = bool (*)(const ArgsT&);
+  using action_type = void (*)(ArgsT&);
+
+  // Current state
+  StateT state;
+
+  // Event initiating transition
+  EventT event;
+
+  // Guard predicate (nullptr for unconditional transitions)
+  guard_type guard;
+
+  // Guard name (for tooling)
+  const char* guard_name;
+
+  // Actions, in order of invocation; unused slots are nullptr.
+  std::array<action_type, ActionN> actions;
+
+  // Next state
+  StateT next;
+
+  // Invoke transition actions.
+  void invoke(ArgsT& args) const {
+    for (action_type action : actions) {
+      if (action == nullptr) break;
+      action(args);
+    }
+  }
+};
+
+// Adapt a stateless function object to a transition action.
+//
+template <typename ActionT, typename ArgsT>
+void invoke_action(ArgsT& args) {
+  ActionT{}(args);
+}
+
+// Transition table compiled from some list of declarative
+// transitions. Rows are indexed by {state, event} at compile time
+// such that lookup reduces to a jump to a (typically unary) list of
+// candidate rows, which are evaluated in their order of declaration.
+//
+template <typename TransitionT, std::size_t RowN, std::size_t StateN,
+          std::size_t EventN>
+class TransitionTable {
+  using state_type = typename TransitionT::state_type;
+  using event_type = typename TransitionT::event_type;
+  using args_type = typename TransitionT::args_type;
+
+  static constexpr std::size_t key_n = StateN * EventN;
+
+ public:
+  using const_iterator = typename std::array<TransitionT, RowN>::const_iterator;
+
+  constexpr explicit TransitionTable(const std::array<TransitionT, RowN>& rows)
+      : rows_(rows) {
+    // Counting sort of rows by {state, event}; stable such that guards
+    // retain their declaration order.
+    for (std::size_t i = 0; i < RowN; i++) {
+      ++begin_[key(rows_[i].state, rows_[i].event) + 1];
+    }
+    for (std::size_t k = 0; k < key_n; k++) {
+      begin_[k + 1] += begin_[k];
+    }
+    std::array<std::uint16_t, key_n + 1> next = begin_;
+    for (std::size_t i = 0; i < RowN; i++) {
+      order_[next[key(rows_[i].state, rows_[i].event)]++] =
+          static_cast<std::uint16_t>(i);
+    }
+  }
+
+  // Number of transitions in table.
+  constexpr std::size_t size() const { return RowN; }
+
+  // Iterators over table rows, in declaration order.
+  const_iterator begin() const { return rows_.begin(); }
+  const_iterator end() const { return rows_.end(); }
+
+  // Row at index 'i'.
+  constexpr const TransitionT& row(std::size_t i) const { return rows_[i]; }
+
+  // Number of rows defined for {state, event}.
+  constexpr std::size_t count(state_type state, event_type event) const {
+    const std::size_t k = key(state, event);
+    return begin_[k + 1] - begin_[k];
+  }
+
+  // Lookup the first transition for {state, event} whose guard
+  // holds, or nullptr if no such transition is defined.
+  const TransitionT* lookup(state_type state, event_type event,
+                            const args_type& args) const {
+    const std::size_t k = key(state, event);
+    for (std::size_t i = begin_[k]; i < begin_[k + 1]; i++) {
+      const TransitionT& t = rows_[order_[i]];
+      if (t.guard == nullptr || t.guard(args)) return &t;
+    }
+    return nullptr;
+  }
+
+ private:
+  static constexpr std::size_t key(state_type state, event_type event) {
+    return static_cast<std::size_t>(state) * EventN +
+           static_cast<std::size_t>(event);
+  }
+
+  // Transitions, in declaration order.
+  std::array<TransitionT, RowN> rows_{};
+
+  // Offset into 'order_' of the first row for each key.
+  std::array<std::uint16_t, key_n + 1> begin_{};
+
+  // Row indices sorted by key.
+  std::array<std::uint16_t, RowN> order_{};
+};
+
+// Render transition table as a machine-readable list of
+// {state, event, guard, next} records.
+//
+template <typename TableT>
+std::string render_transitions(const TableT& table) {
+  using cc::to_string;
+
+  ArrayRenderer a;
+  for (const auto& t : table) {
+    KVListRenderer r;
+    r.add_field("state", to_string(t.state));
+    r.add_field("event", to_string(t.event));
+    r.add_field("guard", t.guard_name == nullptr ? "<NONE>" : t.guard_name);
+    r.add_field("next", to_string(t.next));
+    a.add_item(r.to_string());
+  }
+  return a.to_string();
+}
+
+}  // namespace cc
+
+#endif
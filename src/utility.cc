@@ -26,12 +26,47 @@
 //========================================================================== //
 
 #include "utility.h"
+#include "cc/cfgs.h"
 
 #include <algorithm>
 #include <sstream>
 
 namespace cc {
 
+namespace {
+
+// Log2 of power-of-two 'x'.
+std::size_t log2_exact(std::uint64_t x) {
+  std::size_t n = 0;
+  while (x > 1) {
+    x >>= 1;
+    n++;
+  }
+  return n;
+}
+
+}  // namespace
+
+AddrInterleaver::AddrInterleaver(const InterleaveConfig& cfg, std::size_t n)
+    : n_(std::max<std::size_t>(n, 1)) {
+  const bool is_page = (cfg.type == InterleaveType::Page);
+  shift_ = log2_exact(is_page ? cfg.page_bytes : cfg.line_bytes);
+  is_xor_ = (cfg.type == InterleaveType::Xor);
+  // Fold in chunks sufficient to select amongst 'n' agents.
+  while ((std::size_t{1} << bits_) < n_) bits_++;
+}
+
+std::size_t AddrInterleaver::index(addr_t addr) const {
+  std::uint64_t x = addr >> shift_;
+  if (is_xor_) {
+    const std::uint64_t m = (std::uint64_t{1} << bits_) - 1;
+    std::uint64_t h = 0;
+    for (; x != 0; x >>= bits_) h ^= (x & m);
+    x = h;
+  }
+  return static_cast<std::size_t>(x % n_);
+}
+
 std::string ArrayRenderer::to_string() const {
   std::string r;
   r += "[";
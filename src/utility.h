@@ -65,6 +65,33 @@ T mask(std::size_t bits) {
   return (t << bits) - 1;
 }
 
+struct InterleaveConfig;
+
+// Map of line address to one of 'n' agents according to some
+// interleave configuration.
+//
+class AddrInterleaver {
+ public:
+  AddrInterleaver() = default;
+  AddrInterleaver(const InterleaveConfig& cfg, std::size_t n);
+
+  // Agent count.
+  std::size_t n() const { return n_; }
+
+  // Index of agent (in [0, n)) to which 'addr' maps.
+  std::size_t index(addr_t addr) const;
+
+ private:
+  // Address is XOR-folded before selection.
+  bool is_xor_ = false;
+  // Shift to discard intra-granule offset.
+  std::size_t shift_ = 0;
+  // Width (in bits) of each XOR-fold chunk.
+  std::size_t bits_ = 1;
+  // Agent count.
+  std::size_t n_ = 1;
+};
+
 //
 //
 class ArrayRenderer {
@@ -30,69 +30,251 @@
 #include "l2cache.h"
 #include "cpu.h"
 #include "log.h"
+#include "msg.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <thread>
 
 namespace cc {
 
-class LineState {
-  template <typename>
-  friend class PooledItem;
+namespace {
 
-  LineState() = default;
- public:
-  virtual ~LineState() = default;
-  virtual void release() const = 0;
+// Initial line table capacity (records).
+constexpr std::size_t initial_lines_n = 1024;
 
-  // Accessors:
+// Checker ring capacity (records); power-of-two.
+constexpr std::size_t checker_ring_n = 1 << 16;
 
-  // Cache line address
-  addr_t addr() const { return addr_; }
+// Bitset test of bit 'i'.
+bool test_bit(const std::uint64_t* words, std::size_t i) {
+  return ((words[i >> 6] >> (i & 63)) & 1) != 0;
+}
 
-  // Owning agent.
-  L1CacheAgent* owner_l1c() const { return owning_l1c_; }
+// Bitset set of bit 'i'.
+void set_bit(std::uint64_t* words, std::size_t i) {
+  words[i >> 6] |= std::uint64_t{1} << (i & 63);
+}
 
-  // Sharer set.
-  const std::set<L1CacheAgent*>& sharer_l1cs() const { return sharing_l1c_; }
+// Bitset clear of bit 'i'.
+void clear_bit(std::uint64_t* words, std::size_t i) {
+  words[i >> 6] &= ~(std::uint64_t{1} << (i & 63));
+}
 
-  // Setters:
+// Bitset has any bit set, excluding bit 'i'.
+bool any_except(const std::uint64_t* words, std::size_t n, std::size_t i) {
+  std::uint64_t any = 0;
+  for (std::size_t w = 0; w < n; w++) {
+    const std::uint64_t m = std::uint64_t{w == (i >> 6)} << (i & 63);
+    any |= words[w] & ~m;
+  }
+  return any != 0;
+}
 
-  // Set address:
-  void set_addr(addr_t addr) { addr_ = addr; }
+// Hash of line address 'addr' into table of 'n' (power-of-two) records.
+std::size_t line_hash(addr_t addr, std::size_t n) {
+  return static_cast<std::size_t>((addr * 0x9E3779B97F4A7C15ull) >> 32) &
+         (n - 1);
+}
 
-  // Set owning L1 instance.
-  void set_owner(L1CacheAgent* owning_l1c) { owning_l1c_ = owning_l1c; }
+}  // namespace
 
-  // Sharer set
-  std::set<L1CacheAgent*>& sharer_l1c() { return sharing_l1c_; }
-  
+// Background checker; single-producer (simulation thread),
+// single-consumer (checker thread) ring of event records.
+//
+class Monitor::Checker {
+ public:
+  explicit Checker(Monitor* m)
+      : m_(m), ring_(checker_ring_n) {
+    thread_ = std::thread([this]() { run(); });
+  }
+
+  ~Checker() { stop(); }
+
+  // Violation has been detected.
+  bool failed() const { return failed_.load(std::memory_order_acquire); }
+
+  // Offending record and violated invariant (where failed).
+  const Event& failure() const { return failure_; }
+  const char* why() const { return why_; }
+
+  // Post event; blocks while ring is full. Returns false if checker
+  // has failed (and therefore no longer consumes events).
+  bool post(const Event& e) {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_cache_ == ring_.size()) {
+      head_cache_ = head_.load(std::memory_order_seq_cst);
+      if (tail - head_cache_ == ring_.size()) {
+        std::unique_lock<std::mutex> lk(mu_);
+        producer_waiting_.store(true, std::memory_order_seq_cst);
+        non_full_.wait(lk, [&]() {
+          head_cache_ = head_.load(std::memory_order_seq_cst);
+          return (tail - head_cache_ != ring_.size()) || failed();
+        });
+        producer_waiting_.store(false, std::memory_order_relaxed);
+        if (tail - head_cache_ == ring_.size()) return false;
+      }
+    }
+    ring_[tail & (ring_.size() - 1)] = e;
+    tail_.store(tail + 1, std::memory_order_seq_cst);
+    // Wake the consumer only if it has blocked on an empty ring.
+    if (consumer_waiting_.load(std::memory_order_seq_cst)) {
+      const std::lock_guard<std::mutex> lk(mu_);
+      non_empty_.notify_one();
+    }
+    return true;
+  }
+
+  // Drain outstanding events and join checker thread.
+  void stop() {
+    if (!thread_.joinable()) return;
+    {
+      const std::lock_guard<std::mutex> lk(mu_);
+      stop_.store(true, std::memory_order_seq_cst);
+      non_empty_.notify_one();
+    }
+    thread_.join();
+  }
 
  private:
+  // Checker thread of execution.
+  void run() {
+    std::size_t head = head_.load(std::memory_order_relaxed);
+    while (true) {
+      std::size_t tail = tail_.load(std::memory_order_acquire);
+      if (head == tail) {
+        // Block until events are posted, or until stop is requested.
+        // Stop only once all events posted before the request have
+        // been consumed.
+        std::unique_lock<std::mutex> lk(mu_);
+        consumer_waiting_.store(true, std::memory_order_seq_cst);
+        non_empty_.wait(lk, [&]() {
+          tail = tail_.load(std::memory_order_seq_cst);
+          return (tail != head) || stop_.load(std::memory_order_seq_cst);
+        });
+        consumer_waiting_.store(false, std::memory_order_relaxed);
+        if (tail == head) return;
+      }
+      for (; head != tail; head++) {
+        const Event& e = ring_[head & (ring_.size() - 1)];
+        if (const char* why = m_->apply(e); why != nullptr) {
+          failure_ = e;
+          why_ = why;
+          const std::lock_guard<std::mutex> lk(mu_);
+          failed_.store(true, std::memory_order_release);
+          non_full_.notify_one();
+          return;
+        }
+      }
+      head_.store(head, std::memory_order_seq_cst);
+      // Wake the producer only if it has blocked on a full ring.
+      if (producer_waiting_.load(std::memory_order_seq_cst)) {
+        const std::lock_guard<std::mutex> lk(mu_);
+        non_full_.notify_one();
+      }
+    }
+  }
+
+  // Owning monitor.
+  Monitor* m_ = nullptr;
+
+  // Event records.
+  std::vector<Event> ring_;
+
+  // Consumer position.
+  alignas(64) std::atomic<std::size_t> head_{0};
+
+  // Producer position.
+  alignas(64) std::atomic<std::size_t> tail_{0};
+
+  // Producer's (stale) copy of the consumer position.
+  std::size_t head_cache_ = 0;
+
+  // Guards the blocking of either thread.
+  std::mutex mu_;
+
+  // Notified when the ring becomes non-empty, or upon stop.
+  std::condition_variable non_empty_;
 
-  // Current owning L1 cache; sharing set must be empty.
-  L1CacheAgent* owning_l1c_ = nullptr;
+  // Notified when the ring becomes non-full, or upon failure.
+  std::condition_variable non_full_;
 
-  // The set of sharing L1 caches.
-  std::set<L1CacheAgent*> sharing_l1c_;
+  // Consumer is blocked on an empty ring.
+  std::atomic<bool> consumer_waiting_{false};
 
-  // Line address;
-  addr_t addr_;
+  // Producer is blocked on a full ring.
+  std::atomic<bool> producer_waiting_{false};
+
+  // Stop requested.
+  std::atomic<bool> stop_{false};
+
+  // Violation detected.
+  std::atomic<bool> failed_{false};
+
+  // Offending record.
+  Event failure_;
+
+  // Violated invariant.
+  const char* why_ = nullptr;
+
+  // Checker thread.
+  std::thread thread_;
+};
+
+// Starts the checker thread upon initialization and drains it upon
+// finalization.
+//
+class Monitor::CheckerProcess : public kernel::Process {
+ public:
+  CheckerProcess(kernel::Kernel* k, const std::string& name, Monitor* m)
+      : Process(k, name), m_(m) {}
+
+ private:
+  // Initialization
+  void init() override { m_->start_checker(); }
+
+  // Finalization
+  void fini() override { m_->stop_checker(); }
+
+  // Owning monitor.
+  Monitor* m_ = nullptr;
 };
 
 Monitor::Monitor(kernel::Kernel* k, const std::string& name)
     : Module(k, name) {
+  checker_process_ = new CheckerProcess(k, "checker", this);
+  add_child_process(checker_process_);
+}
+
+Monitor::~Monitor() {
+  checker_.reset();
+  delete checker_process_;
 }
 
 // Register CPU instance
-void Monitor::register_client(Cpu* cpu) {
-  if (auto it = cpus_.insert(cpu); !it.second) {
-    LOG_FATAL("Attempt to re-register CPU instance.");
+std::size_t Monitor::register_client(Cpu* cpu) {
+  for (const Cpu* c : cpus_) {
+    if (c == cpu) LOG_FATAL("Attempt to re-register CPU instance.");
   }
+  cpus_.push_back(cpu);
+  ts_.emplace_back();
+  return cpus_.size() - 1;
 }
 
 // Register L1 cache instance
-void Monitor::register_client(L1CacheAgent* l1c) {
-  if (auto it = l1cs_.insert(l1c); !it.second) {
-    LOG_FATAL("Attempt to re-register L1 cache instance.");
+std::size_t Monitor::register_client(L1CacheAgent* l1c) {
+  for (const L1CacheAgent* l : l1cs_) {
+    if (l == l1c) LOG_FATAL("Attempt to re-register L1 cache instance.");
+  }
+  if (words_n_ != 0) {
+    // Sharer bitsets are sized upon installation of the first line.
+    LOG_FATAL("Attempt to register L1 cache instance after simulation "
+              "has commenced.");
   }
+  l1cs_.push_back(l1c);
+  return l1cs_.size() - 1;
 }
 
 // Register L2 cache instance
@@ -125,122 +307,303 @@ void Monitor::register_client(CCAgent* cc) {
 
 // Notify start of transaction.
 void Monitor::start_transaction_event(Cpu* cpu, Transaction* t) {
-  if (auto it = cpus_.find(cpu); it == cpus_.end()) {
-    LOG_FATAL("Unknown CPU instance.");
-  }
-  if (auto it = ts_.insert(t); !it.second) {
-    // Transaction could not be inserted, currently already present in
-    // the transaction set. Attempt to reissuing transaction which
-    // is already in flight.
-    LOG_FATAL("Attempt to register transaction which is already in flight.");
-  }
+  dispatch(Event{k()->time(), EventKind::StartTransaction, cpu_index(cpu),
+                 t->handle()});
 }
 
 // Notify end of transaction.
 void Monitor::end_transaction_event(Cpu* cpu, Transaction* t) {
-  if (auto it = cpus_.find(cpu); it == cpus_.end()) {
-    LOG_FATAL("Unknown CPU instance.");
+  dispatch(Event{k()->time(), EventKind::EndTransaction, cpu_index(cpu),
+                 t->handle()});
+}
+
+void Monitor::read_hit(L1CacheAgent* l1c, addr_t addr) {
+  dispatch(Event{k()->time(), EventKind::ReadHit, l1c_index(l1c), addr});
+}
+
+void Monitor::write_hit(L1CacheAgent* l1c, addr_t addr) {
+  dispatch(Event{k()->time(), EventKind::WriteHit, l1c_index(l1c), addr});
+}
+
+void Monitor::install_line(L1CacheAgent* l1c, addr_t addr,
+                           bool is_writeable) {
+  const EventKind kind = is_writeable ? EventKind::InstallLineWriteable
+                                      : EventKind::InstallLine;
+  dispatch(Event{k()->time(), kind, l1c_index(l1c), addr});
+}
+
+void Monitor::remove_line(L1CacheAgent* l1c, addr_t addr) {
+  dispatch(Event{k()->time(), EventKind::RemoveLine, l1c_index(l1c), addr});
+}
+
+void Monitor::dispatch(const Event& e) {
+  if (checker_ == nullptr) {
+    // Synchronous; check in place.
+    if (const char* why = apply(e); why != nullptr) raise(e, why);
+    return;
   }
-  if (auto it = ts_.find(t); it != ts_.end()) {
-    ts_.erase(it);
-  } else {
+  if (checker_->failed() || !checker_->post(e)) {
+    // Prior event has violated an invariant; raise on simulation
+    // thread.
+    checker_->stop();
+    const Event failure = checker_->failure();
+    const char* why = checker_->why();
+    checker_.reset();
+    raise(failure, why);
+  }
+}
+
+const char* Monitor::apply(const Event& e) {
+  switch (e.kind) {
+    case EventKind::StartTransaction:
+      return check_start_transaction(e.id, e.arg);
+    case EventKind::EndTransaction:
+      return check_end_transaction(e.id, e.arg);
+    case EventKind::ReadHit:
+      return check_read_hit(e.id, e.arg);
+    case EventKind::WriteHit:
+      return check_write_hit(e.id, e.arg);
+    case EventKind::InstallLine:
+      return check_install_line(e.id, e.arg, false);
+    case EventKind::InstallLineWriteable:
+      return check_install_line(e.id, e.arg, true);
+    case EventKind::RemoveLine:
+      return check_remove_line(e.id, e.arg);
+  }
+  return "Unknown monitor event.";
+}
+
+void Monitor::raise(const Event& e, const char* why) {
+  const bool is_cpu = (e.kind == EventKind::StartTransaction) ||
+                      (e.kind == EventKind::EndTransaction);
+  std::stringstream ss;
+  ss << why << " (";
+  switch (e.kind) {
+    case EventKind::StartTransaction:
+      ss << "start_transaction";
+      break;
+    case EventKind::EndTransaction:
+      ss << "end_transaction";
+      break;
+    case EventKind::ReadHit:
+      ss << "read_hit";
+      break;
+    case EventKind::WriteHit:
+      ss << "write_hit";
+      break;
+    case EventKind::InstallLine:
+      ss << "install_line";
+      break;
+    case EventKind::InstallLineWriteable:
+      ss << "install_line (writeable)";
+      break;
+    case EventKind::RemoveLine:
+      ss << "remove_line";
+      break;
+  }
+  ss << " by " << (is_cpu ? cpus_[e.id]->path() : l1cs_[e.id]->path());
+  ss << (is_cpu ? ", transaction " : ", addr 0x") << std::hex << e.arg
+     << std::dec << " at " << e.time << ")";
+  LogMessage msg(ss.str(), Level::Fatal);
+  log(msg);
+}
+
+void Monitor::start_checker() {
+  if (is_async_) checker_ = std::make_unique<Checker>(this);
+}
+
+void Monitor::stop_checker() {
+  if (checker_ == nullptr) return;
+
+  checker_->stop();
+  if (checker_->failed()) {
+    const Event failure = checker_->failure();
+    const char* why = checker_->why();
+    checker_.reset();
+    raise(failure, why);
+  }
+  checker_.reset();
+}
+
+void Monitor::reset() {
+  // Drain outstanding asynchronous checks, raising any violation,
+  // before the behavioral state is cleared; the checker is restarted
+  // upon initialization.
+  stop_checker();
+  for (std::vector<std::uint64_t>& ts : ts_) {
+    std::fill(ts.begin(), ts.end(), 0);
+  }
+  std::fill(line_used_.begin(), line_used_.end(), false);
+  std::fill(line_owners_.begin(), line_owners_.end(), npos);
+  std::fill(sharers_.begin(), sharers_.end(), 0);
+  lines_n_ = 0;
+}
+
+const char* Monitor::check_start_transaction(std::uint32_t cpu,
+                                             std::uint64_t h) {
+  std::vector<std::uint64_t>& ts = ts_[cpu];
+  if ((h >> 6) >= ts.size()) ts.resize((h >> 6) + 1, 0);
+  if (test_bit(ts.data(), h)) {
+    // Transaction is already present in the transaction set.
+    // Attempt to reissuing transaction which is already in flight.
+    return "Attempt to register transaction which is already in flight.";
+  }
+  set_bit(ts.data(), h);
+  return nullptr;
+}
+
+const char* Monitor::check_end_transaction(std::uint32_t cpu,
+                                           std::uint64_t h) {
+  std::vector<std::uint64_t>& ts = ts_[cpu];
+  if ((h >> 6) >= ts.size() || !test_bit(ts.data(), h)) {
     // Transaction is not present; perhaps perviously consumed?
-    LOG_FATAL("Attempt to deregister invalid transaction.");
+    return "Attempt to deregister invalid transaction.";
   }
+  clear_bit(ts.data(), h);
+  return nullptr;
 }
 
-void Monitor::read_hit(L1CacheAgent* l1c, addr_t addr) {
-  // TODO: Verify that line is aligned.
-  if (auto line_it = line_registry_.find(addr); line_it != line_registry_.end()) {
-    LineState* lstate = line_it->second;
-    if (lstate->owner_l1c() != l1c && (lstate->sharer_l1cs().count(l1c) == 0)) {
-      // Cache is neither the owner, nor in the sharer set; it should
-      // therefore not have the line installed in the cache.
-      LOG_FATAL("Read hit to line; but line should not be present in "
-                "indicate cache instance.");
-    }
-  } else {
+const char* Monitor::check_read_hit(std::uint32_t id, addr_t addr) const {
+  const std::uint32_t i = find_line(addr);
+  if (i == npos) {
     // Line is not presently registered, cannot therefore hit to
     // the line in the cache.
-    LOG_FATAL("Line is not present in behavorial model.");
+    return "Line is not present in behavorial model.";
   }
+  // Cache must either be the owner or in the sharer set; otherwise
+  // it should not have the line installed in the cache.
+  const bool is_owner = (line_owners_[i] == id);
+  if (!(is_owner | test_bit(sharers(i), id))) {
+    return "Read hit to line; but line should not be present in "
+           "indicate cache instance.";
+  }
+  return nullptr;
 }
 
-void Monitor::write_hit(L1CacheAgent* l1c, addr_t addr) {
-  // TODO: Verify that line is aligned.
-  if (auto line_it = line_registry_.find(addr); line_it != line_registry_.end()) {
-    LineState* lstate = line_it->second;
-    if (lstate->owner_l1c() != l1c) {
-      LOG_FATAL("Write hit to line; but line is not in a writeable state "
-                "in the indicated cache instance.");
-    }
-  } else {
+const char* Monitor::check_write_hit(std::uint32_t id, addr_t addr) const {
+  const std::uint32_t i = find_line(addr);
+  if (i == npos) {
     // Line is not presently registered, cannot therefore hit to
     // the line in the cache.
-    LOG_FATAL("Line is not present in behavorial model.");
+    return "Line is not present in behavorial model.";
   }
+  if (line_owners_[i] != id) {
+    return "Write hit to line; but line is not in a writeable state "
+           "in the indicated cache instance.";
+  }
+  return nullptr;
 }
 
-void Monitor::install_line(L1CacheAgent* l1c, addr_t addr,
-                           bool is_writeable) {
-  // TODO: Verify that line is aligned.
-  LineState* lstate = nullptr;
-  if (auto line_it = line_registry_.find(addr); line_it == line_registry_.end()) {
-    lstate = Pool<LineState>::construct();
-    lstate->set_addr(addr);
-    line_registry_[addr] = lstate;
-  } else {
-    lstate = line_it->second;
-  }
+const char* Monitor::check_install_line(std::uint32_t id, addr_t addr,
+                                        bool is_writeable) {
+  const std::uint32_t i = find_or_install_line(addr);
+  std::uint64_t* s = sharers(i);
   if (is_writeable) {
-    // Current L1 becomes owner of the line.
-    lstate->set_owner(l1c);
+    // Single-Writer: no other cache may own or share the line.
+    const std::uint32_t owner = line_owners_[i];
+    if (((owner != npos) & (owner != id)) | any_except(s, words_n_, id)) {
+      return "Install writeable line; but line is present in another "
+             "cache instance.";
+    }
+    // Current L1 becomes owner of the line; an upgrade from the
+    // shared state retires the L1's entry in the sharer set.
+    clear_bit(s, id);
+    line_owners_[i] = id;
   } else {
     // Otherwise, L1 becomes a sharer of the line.
-    auto& sharer_set = lstate->sharer_l1c();
-    if (auto set_it = sharer_set.insert(l1c); !set_it.second) {
+    if (test_bit(s, id)) {
       // L1 Cache is alreayd present in sharer set; cannot re-install.
-      LOG_FATAL("L1C is already present in associated sharer set.");
+      return "L1C is already present in associated sharer set.";
     }
+    set_bit(s, id);
   }
-  
+  return nullptr;
 }
-                    
-void Monitor::remove_line(L1CacheAgent* l1c, addr_t addr) {
-  // TODO: Verify that line is aligned.
-  LineState* lstate = nullptr;
-  if (auto line_it = line_registry_.find(addr); line_it != line_registry_.end()) {
-    lstate = line_it->second;
-    if (lstate->owner_l1c() == l1c) {
-      // L1 is current designated owner. Delete,
-      lstate->set_owner(nullptr);
-    } else {
-      // Otherwise, expect to be present in the sharer set.
-      auto& sharer_set = lstate->sharer_l1c();
-      if (auto set_it = sharer_set.find(l1c); set_it != sharer_set.end()) {
-        sharer_set.erase(set_it);
-      } else {
-        // Line is not present in sharer set;
-        LOG_FATAL("Expect to find L1C in line's sharer set, but cache has "
-                  "not been registered.");
-      }
-    }
-  } else {
+
+const char* Monitor::check_remove_line(std::uint32_t id, addr_t addr) {
+  const std::uint32_t i = find_line(addr);
+  if (i == npos) {
     // Line does not appear to be installed in Monitor's state.
-    LOG_FATAL("Attempt to uninstall a line which is not present in "
-              "Monitors state table (has line already been removed?).");
+    return "Attempt to uninstall a line which is not present in "
+           "Monitors state table (has line already been removed?).";
+  }
+  if (line_owners_[i] == id) {
+    // L1 is current designated owner. Delete,
+    line_owners_[i] = npos;
+  } else if (std::uint64_t* s = sharers(i); test_bit(s, id)) {
+    // Otherwise, expect to be present in the sharer set.
+    clear_bit(s, id);
+  } else {
+    // Line is not present in sharer set;
+    return "Expect to find L1C in line's sharer set, but cache has "
+           "not been registered.";
   }
+  return nullptr;
+}
 
-  // Check line state
-  if (lstate != nullptr) {
-    const bool has_no_owner = lstate->owner_l1c() == nullptr;
-    const bool has_no_sharers = lstate->sharer_l1c().empty();
-    if (has_no_owner && has_no_sharers) {
-      // Fault on this; debug.
-      // lstate->release();
-    }
+std::uint32_t Monitor::cpu_index(const Cpu* cpu) const {
+  const std::size_t id = cpu->monitor_index();
+  if (id >= cpus_.size() || cpus_[id] != cpu) {
+    LOG_FATAL("Unknown CPU instance.");
   }
+  return static_cast<std::uint32_t>(id);
 }
 
-} // namespace cc
+std::uint32_t Monitor::l1c_index(const L1CacheAgent* l1c) const {
+  const std::size_t id = l1c->monitor_index();
+  if (id >= l1cs_.size() || l1cs_[id] != l1c) {
+    LOG_FATAL("Unknown L1 cache instance.");
+  }
+  return static_cast<std::uint32_t>(id);
+}
+
+std::uint32_t Monitor::find_line(addr_t addr) const {
+  const std::size_t n = line_addrs_.size();
+  if (n == 0) return npos;
+  for (std::size_t i = line_hash(addr, n);; i = (i + 1) & (n - 1)) {
+    if (!line_used_[i]) return npos;
+    if (line_addrs_[i] == addr) return static_cast<std::uint32_t>(i);
+  }
+}
+
+std::uint32_t Monitor::find_or_install_line(addr_t addr) {
+  if (const std::uint32_t i = find_line(addr); i != npos) return i;
+
+  // Maintain load factor at or below one half.
+  if (2 * (lines_n_ + 1) > line_addrs_.size()) grow_lines();
 
+  const std::size_t n = line_addrs_.size();
+  std::size_t i = line_hash(addr, n);
+  while (line_used_[i]) i = (i + 1) & (n - 1);
+  line_addrs_[i] = addr;
+  line_used_[i] = true;
+  lines_n_++;
+  return static_cast<std::uint32_t>(i);
+}
+
+void Monitor::grow_lines() {
+  if (words_n_ == 0) {
+    words_n_ = std::max<std::size_t>(1, (l1cs_.size() + 63) / 64);
+  }
+
+  const std::size_t n = std::max(initial_lines_n, 2 * line_addrs_.size());
+  std::vector<addr_t> addrs(n);
+  std::vector<bool> used(n, false);
+  std::vector<std::uint32_t> owners(n, npos);
+  std::vector<std::uint64_t> sharers(n * words_n_, 0);
+  for (std::size_t j = 0; j < line_addrs_.size(); j++) {
+    if (!line_used_[j]) continue;
+    std::size_t i = line_hash(line_addrs_[j], n);
+    while (used[i]) i = (i + 1) & (n - 1);
+    addrs[i] = line_addrs_[j];
+    used[i] = true;
+    owners[i] = line_owners_[j];
+    std::copy_n(&sharers_[j * words_n_], words_n_, &sharers[i * words_n_]);
+  }
+  line_addrs_ = std::move(addrs);
+  line_used_ = std::move(used);
+  line_owners_ = std::move(owners);
+  sharers_ = std::move(sharers);
+}
+
+} // namespace cc
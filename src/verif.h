@@ -28,8 +28,11 @@
 #ifndef CC_SRC_VERIF_H
 #define CC_SRC_VERIF_H
 
-#include <string>
+#include <cstdint>
+#include <memory>
 #include <set>
+#include <string>
+#include <vector>
 
 #include "cc/kernel.h"
 #include "cc/types.h"
@@ -44,8 +47,6 @@ class DirAgent;
 class CCAgent;
 class Transaction;
 
-class LineState;
-
 // CPU Monitor Interface:
 //
 struct CpuMonitor {
@@ -82,20 +83,39 @@ struct L1CacheMonitor {
 // "invariants" (conditions that must be true for correctness to be
 // maintained).
 //
+// CPU and L1 caches are assigned a dense index upon registration
+// (retained by the client) such that per-event state is held in flat
+// arrays: the sharers of a line are a bitset over L1 indices, lines
+// are held in an open-addressing table, and in-flight transactions
+// are a bitset per CPU over transaction handles.
+//
+// Where asynchronous, events are posted as compact records to a
+// single-producer/single-consumer ring and checked on a dedicated
+// thread, which runs concurrently with the simulation. A violation is
+// raised (with the offending record) on the simulation thread upon the
+// next event, or upon finalization.
+//
 class Monitor : public kernel::Module,
                 public CpuMonitor,
                 public L1CacheMonitor {
  public:
   Monitor(kernel::Kernel* k, const std::string& name);
-  virtual ~Monitor() = default;
+  virtual ~Monitor();
+
+  // Offload checks to a background checker thread.
+  bool is_async() const { return is_async_; }
+  void set_async(bool is_async) { is_async_ = is_async; }
+
+  // Discard behavioral state (Reset-Phase).
+  void reset() override;
 
   // Registration methods:
   
-  // Register CPU instance.
-  void register_client(Cpu* cpu);
+  // Register CPU instance; returns CPU index.
+  std::size_t register_client(Cpu* cpu);
 
-  // Register L1 cache instance.
-  void register_client(L1CacheAgent* l1c);
+  // Register L1 cache instance; returns L1 index.
+  std::size_t register_client(L1CacheAgent* l1c);
 
   // Register L2 cache instance.
   void register_client(L2CacheAgent* l2c);
@@ -146,14 +166,89 @@ class Monitor : public kernel::Module,
 
 
  private:
-  // Current inflight transaction set.
-  std::set<Transaction*> ts_;
-
-  // Set of registered CPU
-  std::set<Cpu*> cpus_;
-
-  // Set of registered L1 caches
-  std::set<L1CacheAgent*> l1cs_;
+  class CheckerProcess;
+  class Checker;
+
+  // Sentinel denoting absence of a line record or owner.
+  static constexpr std::uint32_t npos = ~std::uint32_t{0};
+
+  // Monitored event kind.
+  enum class EventKind : std::uint32_t {
+    StartTransaction,
+    EndTransaction,
+    ReadHit,
+    WriteHit,
+    InstallLine,
+    InstallLineWriteable,
+    RemoveLine
+  };
+
+  // Compact record of a monitored event.
+  struct Event {
+    // Simulation time at which event occurred.
+    kernel::Time time;
+    // Event kind.
+    EventKind kind;
+    // Index of originating client (CPU or L1 as per kind).
+    std::uint32_t id;
+    // Line address or transaction handle (as per kind).
+    std::uint64_t arg;
+  };
+
+  // Check (synchronously) or post (asynchronously) event 'e'.
+  void dispatch(const Event& e);
+
+  // Apply event 'e' to behavioral state; returns violated invariant
+  // or nullptr.
+  const char* apply(const Event& e);
+
+  // Raise violation 'why' incurred by event 'e'.
+  void raise(const Event& e, const char* why);
+
+  // Start checker thread (where asynchronous).
+  void start_checker();
+
+  // Drain and stop checker thread; raise any outstanding violation.
+  void stop_checker();
+
+  // Invariant checks; return violated invariant or nullptr.
+  const char* check_start_transaction(std::uint32_t cpu, std::uint64_t h);
+  const char* check_end_transaction(std::uint32_t cpu, std::uint64_t h);
+  const char* check_read_hit(std::uint32_t id, addr_t addr) const;
+  const char* check_write_hit(std::uint32_t id, addr_t addr) const;
+  const char* check_install_line(std::uint32_t id, addr_t addr,
+                                 bool is_writeable);
+  const char* check_remove_line(std::uint32_t id, addr_t addr);
+
+  // Index of registered CPU 'cpu'; fatal if not registered.
+  std::uint32_t cpu_index(const Cpu* cpu) const;
+
+  // Index of registered L1 'l1c'; fatal if not registered.
+  std::uint32_t l1c_index(const L1CacheAgent* l1c) const;
+
+  // Record of line 'addr', or npos if not present.
+  std::uint32_t find_line(addr_t addr) const;
+
+  // Record of line 'addr', installed where not present.
+  std::uint32_t find_or_install_line(addr_t addr);
+
+  // Double the capacity of the line table.
+  void grow_lines();
+
+  // Sharer bitset of line record 'i'.
+  std::uint64_t* sharers(std::uint32_t i) { return &sharers_[i * words_n_]; }
+  const std::uint64_t* sharers(std::uint32_t i) const {
+    return &sharers_[i * words_n_];
+  }
+
+  // In-flight transactions; per CPU bitset over transaction handles.
+  std::vector<std::vector<std::uint64_t> > ts_;
+
+  // Registered CPU (by index)
+  std::vector<Cpu*> cpus_;
+
+  // Registered L1 caches (by index)
+  std::vector<L1CacheAgent*> l1cs_;
 
   // Set of registered L2 caches
   std::set<L2CacheAgent*> l2cs_;
@@ -167,8 +262,35 @@ class Monitor : public kernel::Module,
   // Set of registered Cache Controllers
   std::set<CCAgent*> ccs_;
 
-  // Cache line registry.
-  std::map<addr_t, LineState*> line_registry_;
+  // Cache line registry; open-addressing (linear probing) table of
+  // line records of power-of-two capacity. Records are never removed.
+
+  // Line address, by record.
+  std::vector<addr_t> line_addrs_;
+
+  // Record is occupied, by record.
+  std::vector<bool> line_used_;
+
+  // Owning L1 index (or npos), by record.
+  std::vector<std::uint32_t> line_owners_;
+
+  // Sharer bitsets ('words_n_' words per record).
+  std::vector<std::uint64_t> sharers_;
+
+  // Number of occupied records.
+  std::size_t lines_n_ = 0;
+
+  // Words per sharer bitset (fixed upon first line installation).
+  std::size_t words_n_ = 0;
+
+  // Checks are offloaded to background thread.
+  bool is_async_ = false;
+
+  // Background checker (where asynchronous and running).
+  std::unique_ptr<Checker> checker_;
+
+  // Start/stop checker process.
+  CheckerProcess* checker_process_ = nullptr;
 };
 
 
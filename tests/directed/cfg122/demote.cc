@@ -0,0 +1,133 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#include "test/builder.h"
+#include "test/top.h"
+#include "test/checker.h"
+#include "cc/stimulus.h"
+#include "src/l1cache.h"
+#include "gtest/gtest.h"
+#include <vector>
+
+namespace {
+
+struct Op {
+  std::size_t cpu;
+  cc::CpuOpcode opcode;
+};
+
+// Issue 'ops' to a distinct line for each offset in ['0', 'offset_n');
+// the i-th operation is issued 'offset' * i cycles after the first.
+// The offsets sweep the window in which the L2 may demote or
+// invalidate an L1 whose fill is in flight.
+void run_sweep(const std::vector<Op>& ops, std::size_t offset_n) {
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(2);
+  cb.set_cpu_n(2);
+
+  cc::StimulusConfig stimulus_config;
+  stimulus_config.type = cc::StimulusType::Programmatic;
+  cb.set_stimulus(stimulus_config);
+
+  const cc::SocConfig cfg = cb.construct();
+  test::TbTop top(cfg);
+
+  std::vector<const cc::L1CacheAgent*> l1cs;
+  for (std::size_t i = 0; i < cb.cc_n() * cb.cpu_n(); i++) {
+    const std::string path = test::path_l1c_by_cpu_id(cfg, i);
+    l1cs.push_back(top.lookup_by_path<cc::L1CacheAgent>(path));
+  }
+
+  cc::ProgrammaticStimulus* stimulus =
+      static_cast<cc::ProgrammaticStimulus*>(top.stimulus());
+  std::vector<cc::addr_t> addrs;
+  for (std::size_t offset = 0; offset < offset_n; offset++) {
+    const cc::addr_t addr = offset * 0x40;
+    stimulus->advance_cursor(1000);
+    for (std::size_t i = 0; i < ops.size(); i++) {
+      if (i != 0) stimulus->advance_cursor(offset);
+      stimulus->push_stimulus(ops[i].cpu, ops[i].opcode, addr);
+    }
+    addrs.push_back(addr);
+  }
+
+  top.run_all();
+  EXPECT_FALSE(top.fatal());
+
+  // Single-Writer: at most one L1 holds each line writeable, and then
+  // no other L1 holds the line.
+  for (cc::addr_t addr : addrs) {
+    std::size_t writeable_n = 0;
+    std::size_t hit_n = 0;
+    for (const cc::L1CacheAgent* l1c : l1cs) {
+      const test::L1Checker checker(l1c);
+      if (checker.is_writeable(addr)) ++writeable_n;
+      if (checker.is_hit(addr)) ++hit_n;
+    }
+    EXPECT_LE(writeable_n, 1);
+    if (writeable_n != 0) EXPECT_EQ(hit_n, 1);
+  }
+
+  // Validate that all transactions have retired at end-of-sim.
+  EXPECT_EQ(stimulus->issue_n(), ops.size() * offset_n);
+  EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
+}
+
+} // namespace
+
+TEST(Cfg122, FillDemotedByLocalLoad) {
+  // An L1 obtains the line Exclusive; a second L1 in the cluster reads
+  // the line whilst the first L1's fill may yet be in flight, demoting
+  // the first L1 to Shared.
+  run_sweep({{0, cc::CpuOpcode::Store},
+             {1, cc::CpuOpcode::Load}}, 60);
+}
+
+TEST(Cfg122, FillInvalidatedBySnoop) {
+  // A cluster reads the line and a second cluster writes the line
+  // whilst the fill may yet be in flight to the first L1; the snoop
+  // invalidates the line in the L2 and the fill completes invalidated.
+  run_sweep({{0, cc::CpuOpcode::Load},
+             {1, cc::CpuOpcode::Load},
+             {2, cc::CpuOpcode::Store}}, 60);
+}
+
+TEST(Cfg122, UpgradeInvalidatedBySnoop) {
+  // Both L1 in a cluster hold the line Shared; one upgrades whilst the
+  // other cluster writes the line. The upgrade may be invalidated in
+  // flight, in which case it completes as a fill.
+  run_sweep({{0, cc::CpuOpcode::Load},
+             {1, cc::CpuOpcode::Load},
+             {0, cc::CpuOpcode::Store},
+             {3, cc::CpuOpcode::Store}}, 60);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,87 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#include "test/builder.h"
+#include "test/top.h"
+#include "test/checker.h"
+#include "cc/stimulus.h"
+#include "src/l1cache.h"
+#include "src/stats.h"
+#include "gtest/gtest.h"
+
+TEST(Cfg141, Dram) {
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(4);
+  cb.set_cpu_n(1);
+
+  cc::StimulusConfig stimulus_config;
+  stimulus_config.type = cc::StimulusType::Programmatic;
+  cb.set_stimulus(stimulus_config);
+
+  cc::SocConfig cfg = cb.construct();
+  cfg.mcfgs[0].dram.enable = true;
+  test::TbTop top(cfg);
+
+  cc::ProgrammaticStimulus* stimulus =
+      static_cast<cc::ProgrammaticStimulus*>(top.stimulus());
+  // Each CPU fills a distinct line; all lines reside in the same DRAM
+  // row.
+  stimulus->advance_cursor(200);
+  for (std::size_t cpu = 0; cpu < 4; cpu++) {
+    stimulus->push_stimulus(cpu, cc::CpuOpcode::Load, cpu * 64);
+  }
+
+  // Run to exhaustion
+  top.run_all();
+
+  for (std::size_t cpu = 0; cpu < 4; cpu++) {
+    const cc::L1CacheAgent* l1c = top.lookup_by_path<cc::L1CacheAgent>(
+        test::path_l1c_by_cpu_id(cfg, cpu));
+    const test::L1Checker checker(l1c);
+    EXPECT_TRUE(checker.is_hit(cpu * 64));
+  }
+  EXPECT_EQ(stimulus->issue_n(), 4);
+  EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
+
+  const cc::Statistics* statistics =
+      top.lookup_by_path<cc::Statistics>("top.statistics");
+  const cc::MemStatBlock* mem =
+      static_cast<const cc::MemStatBlock*>(statistics->lookup("top.mem"));
+  ASSERT_NE(mem, nullptr);
+  EXPECT_EQ(mem->read_n.value(), 4);
+  // The first access activates the row; subsequent accesses hit.
+  EXPECT_EQ(mem->row_miss_n.value(), 1);
+  EXPECT_EQ(mem->row_hit_n.value(), 3);
+  EXPECT_EQ(mem->row_conflict_n.value(), 0);
+  EXPECT_EQ(mem->bytes_n.value(), 4 * 64);
+  // Access to the closed row incurs activation, CAS latency and burst
+  // at the controller epoch.
+  const cc::DramConfig& dram = cfg.mcfgs[0].dram;
+  EXPECT_GE(mem->read_latency.max(),
+            (dram.tRCD + dram.tCL + dram.tBURST) * cfg.mcfgs[0].epoch);
+}
@@ -0,0 +1,167 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#include <vector>
+
+#include "test/builder.h"
+#include "test/top.h"
+#include "test/checker.h"
+#include "cc/stimulus.h"
+#include "src/l1cache.h"
+#include "src/llc.h"
+#include "src/stats.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+// Outcome of a run.
+struct RunResult {
+  // End-of-simulation time.
+  cc::cursor_t time = 0;
+  // LLC bank conflicts.
+  std::uint64_t bank_conflict_n = 0;
+  // Total Load latency of CPU 0.
+  std::uint64_t ld_latency = 0;
+};
+
+// CPU 'i' loads 'addrs[i]' coincidently against a two bank LLC with
+// access latency 'access_latency'.
+RunResult run_loads(const std::vector<cc::addr_t>& addrs,
+                    cc::cursor_t access_latency) {
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(4);
+  cb.set_cpu_n(1);
+
+  cc::StimulusConfig stimulus_config;
+  stimulus_config.type = cc::StimulusType::Programmatic;
+  cb.set_stimulus(stimulus_config);
+
+  cc::SocConfig cfg = cb.construct();
+  cfg.dcfgs[0].llcconfig.bank_n = 2;
+  cfg.dcfgs[0].llcconfig.access_latency = access_latency;
+  test::TbTop top(cfg);
+
+  cc::ProgrammaticStimulus* stimulus =
+      static_cast<cc::ProgrammaticStimulus*>(top.stimulus());
+  stimulus->advance_cursor(200);
+  for (std::size_t cpu = 0; cpu < addrs.size(); cpu++) {
+    stimulus->push_stimulus(cpu, cc::CpuOpcode::Load, addrs[cpu]);
+  }
+
+  top.run_all();
+  EXPECT_EQ(stimulus->issue_n(), addrs.size());
+  EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
+
+  const cc::Statistics* statistics =
+      top.lookup_by_path<cc::Statistics>("top.statistics");
+  const cc::LLCStatBlock* llcs =
+      static_cast<const cc::LLCStatBlock*>(statistics->lookup("top.llc"));
+
+  RunResult r;
+  r.time = top.time();
+  r.bank_conflict_n = llcs->bank_conflict_n.value();
+  const cc::CpuStatBlock* cpus = static_cast<const cc::CpuStatBlock*>(
+      statistics->lookup("top.cluster0.cpu0"));
+  r.ld_latency = cpus->ld_latency.sum();
+  return r;
+}
+
+}  // namespace
+
+TEST(Cfg141, LLCBanks) {
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(4);
+  cb.set_cpu_n(1);
+
+  cc::StimulusConfig stimulus_config;
+  stimulus_config.type = cc::StimulusType::Programmatic;
+  cb.set_stimulus(stimulus_config);
+
+  cc::SocConfig cfg = cb.construct();
+  cfg.dcfgs[0].llcconfig.bank_n = 2;
+  cfg.dcfgs[0].llcconfig.access_latency = 20;
+  test::TbTop top(cfg);
+
+  const cc::LLCAgent* llc = top.lookup_by_path<cc::LLCAgent>("top.llc");
+  ASSERT_NE(llc, nullptr);
+  EXPECT_EQ(llc->banks_n(), 2);
+  // Consecutive lines are interleaved across banks, each of which
+  // has its own command queue.
+  EXPECT_NE(llc->bank_index(0), llc->bank_index(64));
+  EXPECT_NE(top.lookup_by_path<cc::kernel::Module>("top.llc.dir_llc__cmd_q_0"),
+            nullptr);
+  EXPECT_NE(top.lookup_by_path<cc::kernel::Module>("top.llc.dir_llc__cmd_q_1"),
+            nullptr);
+
+  cc::ProgrammaticStimulus* stimulus =
+      static_cast<cc::ProgrammaticStimulus*>(top.stimulus());
+  // Each CPU fills a distinct line; lines alternate between banks.
+  stimulus->advance_cursor(200);
+  for (std::size_t cpu = 0; cpu < 4; cpu++) {
+    stimulus->push_stimulus(cpu, cc::CpuOpcode::Load, cpu * 64);
+  }
+
+  // Run to exhaustion
+  top.run_all();
+
+  for (std::size_t cpu = 0; cpu < 4; cpu++) {
+    const cc::L1CacheAgent* l1c = top.lookup_by_path<cc::L1CacheAgent>(
+        test::path_l1c_by_cpu_id(cfg, cpu));
+    const test::L1Checker checker(l1c);
+    EXPECT_TRUE(checker.is_hit(cpu * 64));
+  }
+  EXPECT_EQ(stimulus->issue_n(), 4);
+  EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
+
+  const cc::Statistics* statistics =
+      top.lookup_by_path<cc::Statistics>("top.statistics");
+  const cc::LLCStatBlock* llcs =
+      static_cast<const cc::LLCStatBlock*>(statistics->lookup("top.llc"));
+  EXPECT_EQ(llcs->fill_n.value(), 4);
+}
+
+TEST(Cfg141, LLCBankLatency) {
+  // The memory read issued upon a Fill is delayed by the bank access
+  // latency; the line is returned by memory to the directory directly,
+  // therefore the fill incurs a single access.
+  const RunResult r0 = run_loads({0}, 0);
+  const RunResult r20 = run_loads({0}, 20);
+  EXPECT_EQ(r20.ld_latency - r0.ld_latency, 20);
+  EXPECT_EQ(r20.time - r0.time, 20);
+}
+
+TEST(Cfg141, LLCBankConflict) {
+  // Lines interleaved to the same bank contend for its command queue.
+  const RunResult same = run_loads({0, 128, 256, 384}, 20);
+  EXPECT_GT(same.bank_conflict_n, 0);
+
+  // Lines interleaved to distinct banks do not.
+  const RunResult distinct = run_loads({0, 64}, 20);
+  EXPECT_EQ(distinct.bank_conflict_n, 0);
+}
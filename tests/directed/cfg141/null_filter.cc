@@ -0,0 +1,87 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#include "test/builder.h"
+#include "test/top.h"
+#include "test/checker.h"
+#include "cc/stimulus.h"
+#include "src/l1cache.h"
+#include "src/stats.h"
+#include "gtest/gtest.h"
+
+TEST(Cfg141, NullFilter) {
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(4);
+  cb.set_cpu_n(1);
+
+  cc::StimulusConfig stimulus_config;
+  stimulus_config.type = cc::StimulusType::Programmatic;
+  cb.set_stimulus(stimulus_config);
+
+  cc::SocConfig cfg = cb.construct();
+  cfg.dcfgs[0].is_null_filter = true;
+  test::TbTop top(cfg);
+
+  // No LLC is constructed for a Null Filter directory.
+  EXPECT_EQ(top.lookup_by_path<cc::kernel::Module>("top.llc"), nullptr);
+
+  // Address of interest
+  const cc::addr_t addr = 0;
+
+  cc::ProgrammaticStimulus* stimulus =
+      static_cast<cc::ProgrammaticStimulus*>(top.stimulus());
+  // CPU0 sources the line from memory; CPU1 from CPU0.
+  stimulus->advance_cursor(200);
+  stimulus->push_stimulus(0, cc::CpuOpcode::Load, addr);
+  stimulus->advance_cursor(200);
+  stimulus->push_stimulus(1, cc::CpuOpcode::Load, addr);
+  // CPU2 invalidates all other copies.
+  stimulus->advance_cursor(200);
+  stimulus->push_stimulus(2, cc::CpuOpcode::Store, addr);
+
+  // Run to exhaustion
+  top.run_all();
+
+  for (std::size_t cpu = 0; cpu < 4; cpu++) {
+    const cc::L1CacheAgent* l1c = top.lookup_by_path<cc::L1CacheAgent>(
+        test::path_l1c_by_cpu_id(cfg, cpu));
+    const test::L1Checker checker(l1c);
+    EXPECT_EQ(checker.is_hit(addr), cpu == 2);
+  }
+  EXPECT_EQ(stimulus->issue_n(), 3);
+  EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
+
+  // Each command is broadcast to all agents but the requester,
+  // irrespective of whether the agent holds the line.
+  const cc::Statistics* statistics =
+      top.lookup_by_path<cc::Statistics>("top.statistics");
+  const cc::DirStatBlock* dir =
+      static_cast<const cc::DirStatBlock*>(statistics->lookup("top.dir0"));
+  EXPECT_EQ(dir->snoop_rsp_n.value(), 3 * 3);
+  EXPECT_EQ(dir->llc_rsp_n.value(), 0);
+}
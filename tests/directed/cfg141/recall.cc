@@ -201,6 +201,63 @@ TEST(Cfg141, RecallModified) {
   EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
 }
 
+TEST(Cfg141, RecallInFlight) {
+  // Commands to the lines of a full directory set coincide with
+  // commands which require a line in the same set to be recalled; a
+  // line is recalled only once no transaction is in flight to it.
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(4);
+  cb.set_cpu_n(1);
+
+  cc::StimulusConfig stimulus_config;
+  stimulus_config.type = cc::StimulusType::Programmatic;
+  cb.set_stimulus(stimulus_config);
+
+  const cc::SocConfig cfg = cb.construct();
+  test::TbTop top(cfg);
+
+  const cc::DirAgent* dir = top.lookup_by_path<cc::DirAgent>("top.dir0");
+  ASSERT_TRUE(dir != nullptr);
+  const cc::CacheAddressHelper dir_ah = dir->cache()->ah();
+  const cc::addr_t stride = dir_ah.line_span() * dir_ah.sets_n();
+
+  cc::ProgrammaticStimulus* stimulus =
+      static_cast<cc::ProgrammaticStimulus*>(top.stimulus());
+
+  // Populate the set.
+  std::size_t transactions_n = 0;
+  for (std::size_t i = 0; i < dir_ah.ways_n(); i++) {
+    stimulus->advance_cursor(200);
+    stimulus->push_stimulus(i % cb.cc_n(), cc::CpuOpcode::Load, i * stride);
+    ++transactions_n;
+  }
+
+  // Each round, every CPU writes a line presently in the set whilst
+  // another requests a new line to the set.
+  cc::addr_t addr = dir_ah.ways_n() * stride;
+  for (std::size_t round = 0; round < 8; round++) {
+    stimulus->advance_cursor(200 + round);
+    for (std::size_t cpu = 0; cpu < cb.cc_n(); cpu++) {
+      stimulus->push_stimulus(cpu, cc::CpuOpcode::Store,
+                              ((cpu + round) % dir_ah.ways_n()) * stride);
+      stimulus->push_stimulus((cpu + 1) % cb.cc_n(), cc::CpuOpcode::Load,
+                              addr);
+      addr += stride;
+      transactions_n += 2;
+    }
+  }
+
+  top.run_all();
+  EXPECT_FALSE(top.fatal());
+
+  // Validate expected transaction count.
+  EXPECT_EQ(stimulus->issue_n(), transactions_n);
+
+  // Validate that all transactions have retired at end-of-sim.
+  EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,114 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#include "test/builder.h"
+#include "test/top.h"
+#include "test/checker.h"
+#include "cc/stimulus.h"
+#include "src/l1cache.h"
+#include "src/stats.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+// Each CPU loads a distinct line, then stores to the line of its
+// neighbour.
+void push_scenario(cc::ProgrammaticStimulus* stimulus, std::size_t cpu_n) {
+  stimulus->advance_cursor(200);
+  for (std::size_t cpu = 0; cpu < cpu_n; cpu++) {
+    stimulus->push_stimulus(cpu, cc::CpuOpcode::Load, cpu * 64);
+  }
+  stimulus->advance_cursor(200);
+  for (std::size_t cpu = 0; cpu < cpu_n; cpu++) {
+    const std::size_t neighbour = (cpu + 1) % cpu_n;
+    stimulus->push_stimulus(cpu, cc::CpuOpcode::Store, neighbour * 64);
+  }
+}
+
+}  // namespace
+
+TEST(Cfg141, Reset) {
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(4);
+  cb.set_cpu_n(1);
+
+  cc::StimulusConfig stimulus_config;
+  stimulus_config.type = cc::StimulusType::Programmatic;
+  cb.set_stimulus(stimulus_config);
+
+  const cc::SocConfig cfg = cb.construct();
+  test::TbTop top(cfg);
+
+  cc::ProgrammaticStimulus* stimulus =
+      static_cast<cc::ProgrammaticStimulus*>(top.stimulus());
+  const cc::Statistics* statistics =
+      top.lookup_by_path<cc::Statistics>("top.statistics");
+  auto l1c_by_cpu = [&](std::size_t cpu) {
+    return top.lookup_by_path<cc::L1CacheAgent>(
+        test::path_l1c_by_cpu_id(cfg, cpu));
+  };
+
+  // First scenario.
+  push_scenario(stimulus, 4);
+  top.run_all();
+  const cc::cursor_t first_time = top.time();
+  EXPECT_EQ(stimulus->issue_n(), 8);
+  EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
+  for (std::size_t cpu = 0; cpu < 4; cpu++) {
+    const test::L1Checker checker(l1c_by_cpu(cpu));
+    EXPECT_TRUE(checker.is_hit(((cpu + 1) % 4) * 64));
+  }
+
+  // Reset returns the model to its post-elaboration state.
+  top.reset();
+  EXPECT_EQ(top.time(), 0);
+  EXPECT_EQ(stimulus->issue_n(), 0);
+  EXPECT_EQ(stimulus->retire_n(), 0);
+  for (std::size_t cpu = 0; cpu < 4; cpu++) {
+    const test::L1Checker checker(l1c_by_cpu(cpu));
+    EXPECT_FALSE(checker.is_hit(cpu * 64));
+    EXPECT_FALSE(checker.is_hit(((cpu + 1) % 4) * 64));
+  }
+  const cc::LLCStatBlock* llcs =
+      static_cast<const cc::LLCStatBlock*>(statistics->lookup("top.llc"));
+  ASSERT_NE(llcs, nullptr);
+  EXPECT_EQ(llcs->fill_n.value(), 0);
+
+  // Identical scenario against the same (cold) model retraces the
+  // first run exactly.
+  push_scenario(stimulus, 4);
+  top.run_all();
+  EXPECT_EQ(top.time(), first_time);
+  EXPECT_EQ(stimulus->issue_n(), 8);
+  EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
+  EXPECT_EQ(llcs->fill_n.value(), 4);
+  for (std::size_t cpu = 0; cpu < 4; cpu++) {
+    const test::L1Checker checker(l1c_by_cpu(cpu));
+    EXPECT_TRUE(checker.is_hit(((cpu + 1) % 4) * 64));
+  }
+}
@@ -0,0 +1,112 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#include "test/builder.h"
+#include "test/top.h"
+#include "test/checker.h"
+#include "cc/stimulus.h"
+#include "src/l1cache.h"
+#include "src/stats.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+// CPUs [0, loader_n) Load some line, after which CPU3 Stores to the
+// same line. Returns the number of snoop responses received by the
+// directory (including the snoop to the owner on the second Load;
+// further Loads are sourced without snooping).
+std::size_t run(cc::SharerEncoding encoding, std::size_t pointer_n,
+                std::size_t group_n, std::size_t loader_n = 2) {
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(4);
+  cb.set_cpu_n(1);
+
+  cc::StimulusConfig stimulus_config;
+  stimulus_config.type = cc::StimulusType::Programmatic;
+  cb.set_stimulus(stimulus_config);
+
+  cc::SocConfig cfg = cb.construct();
+  cfg.dcfgs[0].sharer_encoding = encoding;
+  cfg.dcfgs[0].sharer_pointer_n = pointer_n;
+  cfg.dcfgs[0].sharer_group_n = group_n;
+  test::TbTop top(cfg);
+
+  // Address of interest
+  const cc::addr_t addr = 0;
+
+  cc::ProgrammaticStimulus* stimulus =
+      static_cast<cc::ProgrammaticStimulus*>(top.stimulus());
+  for (std::size_t cpu = 0; cpu < loader_n; cpu++) {
+    stimulus->advance_cursor(200);
+    stimulus->push_stimulus(cpu, cc::CpuOpcode::Load, addr);
+  }
+  stimulus->advance_cursor(200);
+  stimulus->push_stimulus(3, cc::CpuOpcode::Store, addr);
+
+  // Run to exhaustion
+  top.run_all();
+
+  // Final writer holds the line exclusively, irrespective of the
+  // precision of the sharer set.
+  for (std::size_t cpu = 0; cpu < 4; cpu++) {
+    const cc::L1CacheAgent* l1c = top.lookup_by_path<cc::L1CacheAgent>(
+        test::path_l1c_by_cpu_id(cfg, cpu));
+    const test::L1Checker checker(l1c);
+    EXPECT_EQ(checker.is_hit(addr), cpu == 3);
+  }
+  EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
+
+  const cc::Statistics* statistics =
+      top.lookup_by_path<cc::Statistics>("top.statistics");
+  const cc::DirStatBlock* dir =
+      static_cast<const cc::DirStatBlock*>(statistics->lookup("top.dir0"));
+  return dir->snoop_rsp_n.value();
+}
+
+} // namespace
+
+TEST(Cfg141, SharersFullMap) {
+  // Precise; owner and sharer alone are snooped.
+  EXPECT_EQ(run(cc::SharerEncoding::FullMap, 0, 0), 3);
+  EXPECT_EQ(run(cc::SharerEncoding::FullMap, 0, 0, 3), 4);
+}
+
+TEST(Cfg141, SharersLimitedPointer) {
+  // Sharer fits within pointers; precise.
+  EXPECT_EQ(run(cc::SharerEncoding::LimitedPointer, 1, 0), 3);
+  // Pointers overflow; broadcast to all but the requester, which
+  // reaches the same agents as only the requester is absent.
+  EXPECT_EQ(run(cc::SharerEncoding::LimitedPointer, 1, 0, 3), 4);
+}
+
+TEST(Cfg141, SharersCoarseVector) {
+  // Groups {0, 1}, {2, 3}; sharer occupies the owner's group.
+  EXPECT_EQ(run(cc::SharerEncoding::CoarseVector, 0, 2), 3);
+  // Single group; CPU2, which never held the line, is also snooped.
+  EXPECT_EQ(run(cc::SharerEncoding::CoarseVector, 0, 4), 4);
+}
@@ -0,0 +1,166 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#include "test/builder.h"
+#include "test/top.h"
+#include "test/checker.h"
+#include "cc/stimulus.h"
+#include "src/l1cache.h"
+#include "gtest/gtest.h"
+#include <vector>
+
+namespace {
+
+std::vector<const cc::L1CacheAgent*> lookup_l1cs(const test::TbTop& top,
+                                                 const cc::SocConfig& cfg) {
+  std::vector<const cc::L1CacheAgent*> l1cs;
+  for (std::size_t i = 0; i < cfg.ccls.size(); i++) {
+    const std::string path = test::path_l1c_by_cpu_id(cfg, i);
+    l1cs.push_back(top.lookup_by_path<cc::L1CacheAgent>(path));
+  }
+  return l1cs;
+}
+
+cc::SocConfig construct_cfg() {
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(4);
+  cb.set_cpu_n(1);
+
+  cc::StimulusConfig stimulus_config;
+  stimulus_config.type = cc::StimulusType::Programmatic;
+  cb.set_stimulus(stimulus_config);
+  return cb.construct();
+}
+
+} // namespace
+
+TEST(Cfg141, SharedUpgrade) {
+  // Line is Shared by two clusters; a Store by the first promotes
+  // its line (L2 S + L1GetE) through a CleanUnique to the home
+  // directory, which invalidates the copy held by the other cluster.
+  const cc::SocConfig cfg = construct_cfg();
+  test::TbTop top(cfg);
+  const std::vector<const cc::L1CacheAgent*> l1cs = lookup_l1cs(top, cfg);
+
+  cc::ProgrammaticStimulus* stimulus =
+      static_cast<cc::ProgrammaticStimulus*>(top.stimulus());
+  const cc::addr_t addr = 0;
+  stimulus->advance_cursor(200);
+  stimulus->push_stimulus(0, cc::CpuOpcode::Load, addr);
+  stimulus->advance_cursor(200);
+  stimulus->push_stimulus(1, cc::CpuOpcode::Load, addr);
+  stimulus->advance_cursor(200);
+  stimulus->push_stimulus(0, cc::CpuOpcode::Store, addr);
+
+  top.run_all();
+  EXPECT_FALSE(top.fatal());
+
+  // Requester holds the line writeable; the other copy is invalidated.
+  const test::L1Checker checker0(l1cs[0]);
+  EXPECT_TRUE(checker0.is_writeable(addr));
+  const test::L1Checker checker1(l1cs[1]);
+  EXPECT_FALSE(checker1.is_hit(addr));
+
+  // Validate that all transactions have retired at end-of-sim.
+  EXPECT_EQ(stimulus->issue_n(), 3);
+  EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
+}
+
+TEST(Cfg141, SharedUpgradeThenShare) {
+  // As above, but a third cluster subsequently reads the line. The
+  // directory must have recorded the upgraded cluster as owner such
+  // that it is snooped and demoted.
+  const cc::SocConfig cfg = construct_cfg();
+  test::TbTop top(cfg);
+  const std::vector<const cc::L1CacheAgent*> l1cs = lookup_l1cs(top, cfg);
+
+  cc::ProgrammaticStimulus* stimulus =
+      static_cast<cc::ProgrammaticStimulus*>(top.stimulus());
+  const cc::addr_t addr = 0;
+  stimulus->advance_cursor(200);
+  stimulus->push_stimulus(0, cc::CpuOpcode::Load, addr);
+  stimulus->advance_cursor(200);
+  stimulus->push_stimulus(1, cc::CpuOpcode::Load, addr);
+  stimulus->advance_cursor(200);
+  stimulus->push_stimulus(0, cc::CpuOpcode::Store, addr);
+  stimulus->advance_cursor(200);
+  stimulus->push_stimulus(2, cc::CpuOpcode::Load, addr);
+
+  top.run_all();
+  EXPECT_FALSE(top.fatal());
+
+  const test::L1Checker checker0(l1cs[0]);
+  EXPECT_TRUE(checker0.is_readable(addr));
+  EXPECT_FALSE(checker0.is_writeable(addr));
+  const test::L1Checker checker2(l1cs[2]);
+  EXPECT_TRUE(checker2.is_readable(addr));
+  EXPECT_FALSE(checker2.is_writeable(addr));
+
+  EXPECT_EQ(stimulus->issue_n(), 4);
+  EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
+}
+
+TEST(Cfg141, SharedUpgradeContended) {
+  // Clusters holding the line Shared upgrade concurrently; each
+  // CleanUnique but the first finds its copy invalidated and completes
+  // as a fill. Exactly one cluster holds the line writeable on
+  // completion.
+  const cc::SocConfig cfg = construct_cfg();
+  test::TbTop top(cfg);
+  const std::vector<const cc::L1CacheAgent*> l1cs = lookup_l1cs(top, cfg);
+
+  cc::ProgrammaticStimulus* stimulus =
+      static_cast<cc::ProgrammaticStimulus*>(top.stimulus());
+  const cc::addr_t addr = 0;
+  for (std::size_t cpu = 0; cpu < l1cs.size(); cpu++) {
+    stimulus->advance_cursor(200);
+    stimulus->push_stimulus(cpu, cc::CpuOpcode::Load, addr);
+  }
+  stimulus->advance_cursor(200);
+  for (std::size_t cpu = 0; cpu < l1cs.size(); cpu++) {
+    stimulus->push_stimulus(cpu, cc::CpuOpcode::Store, addr);
+  }
+
+  top.run_all();
+  EXPECT_FALSE(top.fatal());
+
+  std::size_t writeable_n = 0;
+  for (const cc::L1CacheAgent* l1c : l1cs) {
+    const test::L1Checker checker(l1c);
+    if (checker.is_writeable(addr)) ++writeable_n;
+  }
+  EXPECT_EQ(writeable_n, 1);
+
+  EXPECT_EQ(stimulus->issue_n(), 2 * l1cs.size());
+  EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
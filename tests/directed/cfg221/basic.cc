@@ -0,0 +1,174 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#include "test/builder.h"
+#include "test/top.h"
+#include "test/checker.h"
+#include "cc/stimulus.h"
+#include "src/l1cache.h"
+#include "src/llc.h"
+#include "src/mem.h"
+#include "src/stats.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+// Commands received by directory 'path'.
+std::size_t dir_cmd_n(const test::TbTop& top, const std::string& path) {
+  const cc::Statistics* statistics =
+      top.lookup_by_path<cc::Statistics>("top.statistics");
+  const cc::DirStatBlock* dir =
+      static_cast<const cc::DirStatBlock*>(statistics->lookup(path));
+  return dir->cmd_n.value();
+}
+
+} // namespace
+
+// LineInterleave
+// ==============
+//
+// Description
+// -----------
+//
+// CPU0 issues Load instructions to consecutive lines; lines are
+// interleaved across directories and memory controllers by line.
+//
+// Expected Behavior
+// -----------------
+//
+// Commands are distributed evenly across both directories; all
+// lines are installed in CPU0's L1.
+//
+TEST(Cfg221, LineInterleave) {
+  test::ConfigBuilder cb;
+  cb.set_dir_n(2);
+  cb.set_cc_n(2);
+  cb.set_cpu_n(1);
+  cb.set_mem_n(2);
+
+  cc::StimulusConfig stimulus_config;
+  stimulus_config.type = cc::StimulusType::Programmatic;
+  cb.set_stimulus(stimulus_config);
+
+  const cc::SocConfig cfg = cb.construct();
+
+  test::TbTop top(cfg);
+
+  // Stimulus: loads to consecutive lines.
+  cc::ProgrammaticStimulus* stimulus =
+      static_cast<cc::ProgrammaticStimulus*>(top.stimulus());
+  for (cc::addr_t addr = 0; addr < 4 * 64; addr += 64) {
+    stimulus->advance_cursor(200);
+    stimulus->push_stimulus(0, cc::CpuOpcode::Load, addr);
+  }
+
+  // Run to exhaustion
+  top.run_all();
+
+  const cc::L1CacheAgent* l1c =
+      top.lookup_by_path<cc::L1CacheAgent>(test::path_l1c_by_cpu_id(cfg, 0));
+  const test::L1Checker checker(l1c);
+  for (cc::addr_t addr = 0; addr < 4 * 64; addr += 64) {
+    EXPECT_TRUE(checker.is_hit(addr));
+  }
+
+  // Each directory is home to every other line.
+  EXPECT_EQ(dir_cmd_n(top, "top.dir0"), 2);
+  EXPECT_EQ(dir_cmd_n(top, "top.dir1"), 2);
+
+  // Each LLC interleaves lines across memory controllers.
+  const cc::LLCAgent* llc = top.lookup_by_path<cc::LLCAgent>("top.llc0");
+  EXPECT_NE(llc->mc(0), llc->mc(64));
+  EXPECT_EQ(llc->mc(0), llc->mc(128));
+
+  // Validate that all transactions have retired at end-of-sim.
+  EXPECT_EQ(stimulus->issue_n(), 4);
+  EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
+}
+
+// PageInterleave
+// ==============
+//
+// Description
+// -----------
+//
+// CPU0 and CPU1 Store to lines in consecutive pages; pages are
+// interleaved across directories.
+//
+// Expected Behavior
+// -----------------
+//
+// All lines within a page are homed at the same directory; the final
+// writer owns each line.
+//
+TEST(Cfg221, PageInterleave) {
+  test::ConfigBuilder cb;
+  cb.set_dir_n(2);
+  cb.set_cc_n(2);
+  cb.set_cpu_n(1);
+
+  cc::InterleaveConfig il;
+  il.type = cc::InterleaveType::Page;
+  cb.set_dir_interleave(il);
+
+  cc::StimulusConfig stimulus_config;
+  stimulus_config.type = cc::StimulusType::Programmatic;
+  cb.set_stimulus(stimulus_config);
+
+  const cc::SocConfig cfg = cb.construct();
+
+  test::TbTop top(cfg);
+
+  // Stimulus: two lines in each of two pages; CPU1 writes last.
+  cc::ProgrammaticStimulus* stimulus =
+      static_cast<cc::ProgrammaticStimulus*>(top.stimulus());
+  const std::vector<cc::addr_t> addrs = {0, 64, 4096, 4096 + 64};
+  for (std::size_t cpu : {0, 1}) {
+    for (cc::addr_t addr : addrs) {
+      stimulus->advance_cursor(200);
+      stimulus->push_stimulus(cpu, cc::CpuOpcode::Store, addr);
+    }
+  }
+
+  // Run to exhaustion
+  top.run_all();
+
+  const cc::L1CacheAgent* l1c =
+      top.lookup_by_path<cc::L1CacheAgent>(test::path_l1c_by_cpu_id(cfg, 1));
+  const test::L1Checker checker(l1c);
+  for (cc::addr_t addr : addrs) {
+    EXPECT_TRUE(checker.is_hit(addr));
+    EXPECT_TRUE(checker.is_writeable(addr));
+  }
+
+  // Each directory is home to one page (two lines, two writers).
+  EXPECT_EQ(dir_cmd_n(top, "top.dir0"), 4);
+  EXPECT_EQ(dir_cmd_n(top, "top.dir1"), 4);
+
+  // Validate that all transactions have retired at end-of-sim.
+  EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
+}
@@ -41,6 +41,9 @@ TEST(Cache, AddressHelper) {
   EXPECT_EQ(helper.line_bits(), 10);
   EXPECT_EQ(helper.offset(0xFFFFF), 0x3F);
   EXPECT_EQ(helper.set(0xFFFFFFF), 0x3FF);
+  // Line-aligned address is recovered from its {Set, Tag} tuple.
+  const cc::addr_t a = 0x10078740;
+  EXPECT_EQ(helper.addr_from_set_tag(helper.set(a), helper.tag(a)), a);
 }
 
 TEST(Cache, Basic) {
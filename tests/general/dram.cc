@@ -0,0 +1,222 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#include "dram.h"
+#include "mem.h"
+#include "stats.h"
+#include "utility.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+cc::DramConfig make_config() {
+  cc::DramConfig cfg;
+  cfg.enable = true;
+  cfg.channel_n = 1;
+  cfg.rank_n = 1;
+  cfg.bank_n = 8;
+  cfg.row_bytes = 8192;
+  cfg.line_bytes = 64;
+  cfg.tRCD = 10;
+  cfg.tCL = 10;
+  cfg.tRP = 10;
+  cfg.tRAS = 20;
+  cfg.tWR = 5;
+  cfg.tBURST = 4;
+  // Disable refresh.
+  cfg.tREFI = 0;
+  return cfg;
+}
+
+const cc::MemCmdMsg* make_cmd(cc::MemCmdOpcode opcode, cc::addr_t addr) {
+  cc::MemCmdMsg* msg = cc::Pool<cc::MemCmdMsg>::construct();
+  msg->set_opcode(opcode);
+  msg->set_addr(addr);
+  return msg;
+}
+
+}  // namespace
+
+TEST(Dram, AddressMap) {
+  cc::DramConfig cfg = make_config();
+  cfg.channel_n = 2;
+
+  // Row:Rank:Bank:Channel:Column; consecutive lines share a row.
+  cfg.address_map = cc::DramAddressMap::RoRaBaChCo;
+  const cc::DramModel rrbcc(cfg, 1);
+  EXPECT_EQ(rrbcc.decode(0x0000).column, 0);
+  EXPECT_EQ(rrbcc.decode(0x0040).column, 1);
+  EXPECT_EQ(rrbcc.decode(0x0040).bank, 0);
+  EXPECT_EQ(rrbcc.decode(0x2000).channel, 1);
+  EXPECT_EQ(rrbcc.decode(0x4000).bank, 1);
+  EXPECT_EQ(rrbcc.decode(0x20000).row, 1);
+
+  // Row:Column:Rank:Bank:Channel; consecutive lines alternate between
+  // channels and then banks.
+  cfg.address_map = cc::DramAddressMap::RoCoRaBaCh;
+  const cc::DramModel rcrbc(cfg, 1);
+  EXPECT_EQ(rcrbc.decode(0x0040).channel, 1);
+  EXPECT_EQ(rcrbc.decode(0x0080).channel, 0);
+  EXPECT_EQ(rcrbc.decode(0x0080).bank, 1);
+  EXPECT_EQ(rcrbc.decode(0x0400).column, 1);
+
+  // XOR bank hashing spreads rows which would otherwise conflict.
+  cfg.address_map = cc::DramAddressMap::RoRaBaChCo;
+  cfg.bank_xor = true;
+  const cc::DramModel xored(cfg, 1);
+  EXPECT_NE(xored.decode(0x00000).bank, xored.decode(0x40000).bank);
+}
+
+TEST(Dram, RowBufferTiming) {
+  cc::DramModel dram(make_config(), 1);
+  cc::MemStatBlock stats("mem");
+  dram.set_stats(&stats);
+
+  // Row miss: tRCD + tCL + tBURST
+  dram.push(make_cmd(cc::MemCmdOpcode::Read, 0x0000), 0);
+  ASSERT_NE(dram.select(0), nullptr);
+  EXPECT_EQ(dram.issue(0), 24);
+
+  // Bank is busy until the burst has completed.
+  dram.push(make_cmd(cc::MemCmdOpcode::Read, 0x0040), 4);
+  EXPECT_EQ(dram.select(4), nullptr);
+
+  // Row hit: tCL + tBURST, serialized behind the prior burst.
+  ASSERT_NE(dram.select(14), nullptr);
+  EXPECT_EQ(dram.issue(14), 28);
+
+  // Row conflict: precharge no earlier than tRAS after activation,
+  // then tRP + tRCD + tCL + tBURST.
+  dram.push(make_cmd(cc::MemCmdOpcode::Read, 0x10000), 18);
+  ASSERT_NE(dram.select(18), nullptr);
+  EXPECT_EQ(dram.issue(18), 54);
+
+  EXPECT_TRUE(dram.empty());
+  EXPECT_EQ(stats.row_miss_n.value(), 1);
+  EXPECT_EQ(stats.row_hit_n.value(), 1);
+  EXPECT_EQ(stats.row_conflict_n.value(), 1);
+  EXPECT_EQ(stats.read_n.value(), 3);
+  EXPECT_EQ(stats.bytes_n.value(), 3 * 64);
+  EXPECT_EQ(stats.read_latency.max(), 36);
+}
+
+TEST(Dram, ClosedPage) {
+  cc::DramConfig cfg = make_config();
+  cfg.page_policy = cc::DramPagePolicy::Closed;
+  cc::DramModel dram(cfg, 1);
+  cc::MemStatBlock stats("mem");
+  dram.set_stats(&stats);
+
+  // Row is precharged after each access; no access hits.
+  dram.push(make_cmd(cc::MemCmdOpcode::Read, 0x0000), 0);
+  dram.push(make_cmd(cc::MemCmdOpcode::Read, 0x0040), 0);
+  ASSERT_NE(dram.select(0), nullptr);
+  EXPECT_EQ(dram.issue(0), 24);
+  // Precharge: max(24, tRAS) + tRP
+  EXPECT_EQ(dram.select(33), nullptr);
+  ASSERT_NE(dram.select(34), nullptr);
+  EXPECT_EQ(dram.issue(34), 58);
+  EXPECT_EQ(stats.row_miss_n.value(), 2);
+  EXPECT_EQ(stats.row_hit_n.value(), 0);
+}
+
+TEST(Dram, FrFcfs) {
+  cc::DramModel dram(make_config(), 1);
+
+  // Open row 0 of bank 0.
+  dram.push(make_cmd(cc::MemCmdOpcode::Read, 0x0000), 0);
+  dram.select(0);
+  dram.issue(0);
+
+  // An older request to some other row is bypassed by a younger
+  // request which hits the open row.
+  const cc::MemCmdMsg* conflict = make_cmd(cc::MemCmdOpcode::Read, 0x10000);
+  const cc::MemCmdMsg* hit = make_cmd(cc::MemCmdOpcode::Read, 0x0080);
+  dram.push(conflict, 1);
+  dram.push(hit, 2);
+  const cc::DramModel::Request* r = dram.select(100);
+  ASSERT_NE(r, nullptr);
+  EXPECT_EQ(r->msg, hit);
+  dram.issue(100);
+  r = dram.select(200);
+  ASSERT_NE(r, nullptr);
+  EXPECT_EQ(r->msg, conflict);
+  dram.issue(200);
+}
+
+TEST(Dram, WriteDrain) {
+  cc::DramConfig cfg = make_config();
+  cfg.wr_drain_hi = 2;
+  cfg.wr_drain_lo = 0;
+  cc::DramModel dram(cfg, 1);
+  cc::MemStatBlock stats("mem");
+  dram.set_stats(&stats);
+
+  // Writes below the high watermark are deferred behind reads.
+  const cc::MemCmdMsg* rd = make_cmd(cc::MemCmdOpcode::Read, 0x0000);
+  dram.push(make_cmd(cc::MemCmdOpcode::Write, 0x4000), 0);
+  dram.push(rd, 0);
+  const cc::DramModel::Request* r = dram.select(0);
+  ASSERT_NE(r, nullptr);
+  EXPECT_EQ(r->msg, rd);
+  EXPECT_FALSE(dram.is_draining());
+
+  // Upon reaching the high watermark, writes are prioritized.
+  dram.push(make_cmd(cc::MemCmdOpcode::Write, 0x8000), 0);
+  r = dram.select(0);
+  ASSERT_NE(r, nullptr);
+  EXPECT_TRUE(r->is_write);
+  EXPECT_TRUE(dram.is_draining());
+  dram.issue(0);
+  ASSERT_NE(dram.select(1), nullptr);
+  dram.issue(1);
+  EXPECT_EQ(stats.write_n.value(), 2);
+  EXPECT_EQ(stats.write_drain_n.value(), 1);
+
+  // Drained; the deferred read is serviced.
+  r = dram.select(2);
+  ASSERT_NE(r, nullptr);
+  EXPECT_EQ(r->msg, rd);
+  EXPECT_FALSE(dram.is_draining());
+}
+
+TEST(Dram, Refresh) {
+  cc::DramConfig cfg = make_config();
+  cfg.tREFI = 100;
+  cfg.tRFC = 50;
+  cc::DramModel dram(cfg, 1);
+  cc::MemStatBlock stats("mem");
+  dram.set_stats(&stats);
+
+  // Rank is unavailable whilst refreshing: tRP + tRFC.
+  dram.push(make_cmd(cc::MemCmdOpcode::Read, 0x0000), 100);
+  EXPECT_EQ(dram.select(100), nullptr);
+  EXPECT_EQ(dram.select(159), nullptr);
+  ASSERT_NE(dram.select(160), nullptr);
+  EXPECT_EQ(stats.refresh_n.value(), 1);
+}
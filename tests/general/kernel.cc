@@ -112,6 +112,50 @@ TEST(Kernel, RandomEventScheduling) {
   top.validate();
 }
 
+TEST(Kernel, CoincidentActionsAreFifo) {
+  // Actions scheduled at the same time (and delta) are evaluated in
+  // the order in which they were added.
+  struct Top : cc::kernel::TopModule {
+
+    struct OrderAction : public cc::kernel::Action {
+      OrderAction(cc::kernel::Kernel* k, std::vector<std::size_t>* order,
+                  std::size_t id)
+          : cc::kernel::Action(k, "OrderAction"), order_(order), id_(id) {}
+      bool eval() override {
+        order_->push_back(id_);
+        // Discard after evaluation.
+        return true;
+      }
+      std::vector<std::size_t>* order_ = nullptr;
+      std::size_t id_;
+    };
+
+    Top(cc::kernel::Kernel* k) : cc::kernel::TopModule(k, "top") {
+      cc::kernel::ActionAdder aa(k);
+      // Interleave actions at an earlier time such that the heap is
+      // reordered between insertions.
+      for (std::size_t i = 0; i < 64; i++) {
+        aa.add_action(cc::kernel::Time{100, 0}, new OrderAction(k, &order, i));
+        aa.add_action(cc::kernel::Time{50, 0}, new OrderAction(k, &early, i));
+      }
+    }
+    void validate() {
+      ASSERT_EQ(order.size(), 64);
+      ASSERT_EQ(early.size(), 64);
+      for (std::size_t i = 0; i < order.size(); i++) {
+        EXPECT_EQ(order[i], i);
+        EXPECT_EQ(early[i], i);
+      }
+    }
+    std::vector<std::size_t> order;
+    std::vector<std::size_t> early;
+  };
+  cc::kernel::Kernel k;
+  Top top(&k);
+  cc::kernel::SimSequencer{&k}.run();
+  top.validate();
+}
+
 TEST(Kernel, FatalError) {
   struct TopModule : cc::kernel::TopModule {
     struct RaiseErrorProcess : cc::kernel::Process {
@@ -0,0 +1,421 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#include "msg.h"
+#include "sim.h"
+#include "ccntrl.h"
+#include "dir.h"
+#include "mem.h"
+#include "utility.h"
+#include <set>
+#include "cc/soc.h"
+#include "gtest/gtest.h"
+#include "test/builder.h"
+
+TEST(Msg, TransactionSlab) {
+  cc::TransactionSlab ts;
+  ts.reserve(2);
+  EXPECT_EQ(ts.capacity(), 2);
+
+  cc::Transaction* t0 = ts.allocate();
+  cc::Transaction* t1 = ts.allocate();
+  // Handles are dense and identify the transaction.
+  EXPECT_NE(t0->handle(), t1->handle());
+  EXPECT_LT(t0->handle(), 2);
+  EXPECT_LT(t1->handle(), 2);
+  EXPECT_EQ(ts.lookup(t0->handle()), t0);
+  EXPECT_EQ(ts.lookup(t1->handle()), t1);
+  EXPECT_EQ(ts.inflight_n(), 2);
+  EXPECT_TRUE(ts.is_inflight(t0));
+
+  // In-flight list is ordered oldest-first.
+  EXPECT_EQ(ts.inflight_head(), t0);
+  EXPECT_EQ(cc::TransactionSlab::next_inflight(t0), t1);
+  EXPECT_EQ(cc::TransactionSlab::next_inflight(t1), nullptr);
+
+  // Released slot is reused (with a fresh transaction ID) without
+  // growing the slab.
+  const std::size_t tid0 = t0->tid();
+  const cc::transaction_handle_t h0 = t0->handle();
+  ts.free(t0);
+  EXPECT_FALSE(ts.is_inflight(t0));
+  EXPECT_EQ(ts.inflight_head(), t1);
+  cc::Transaction* t2 = ts.allocate();
+  EXPECT_EQ(t2->handle(), h0);
+  EXPECT_NE(t2->tid(), tid0);
+  EXPECT_EQ(ts.capacity(), 2);
+
+  // Exhausted slab grows; prior transactions are not relocated.
+  cc::Transaction* t3 = ts.allocate();
+  EXPECT_GT(ts.capacity(), 2);
+  EXPECT_EQ(ts.lookup(t1->handle()), t1);
+  EXPECT_EQ(ts.lookup(t3->handle()), t3);
+
+  std::set<cc::transaction_handle_t> hs;
+  for (cc::Transaction* t = ts.inflight_head(); t != nullptr;
+       t = cc::TransactionSlab::next_inflight(t)) {
+    hs.insert(t->handle());
+  }
+  EXPECT_EQ(hs.size(), 3);
+  EXPECT_EQ(ts.inflight_n(), 3);
+
+  // Release returns the slot to the slab.
+  const cc::transaction_handle_t h3 = t3->handle();
+  t3->release();
+  EXPECT_FALSE(ts.is_inflight(t3));
+  EXPECT_EQ(ts.inflight_n(), 2);
+  EXPECT_EQ(ts.allocate()->handle(), h3);
+}
+
+TEST(Msg, AgentClassTable) {
+  cc::kernel::Kernel k;
+  cc::Agent a0(&k, "a0"), a1(&k, "a1"), a2(&k, "a2");
+  a0.set_id(0);
+  a1.set_id(5);
+  EXPECT_EQ(a2.id(), cc::Agent::npos);
+
+  int x = 0, y = 1;
+  cc::AgentClassTable<int> t;
+  t.install(cc::MessageClass::CohSrt, &a0, &x);
+  t.install(cc::MessageClass::CohSnp, &a1, &y);
+  EXPECT_EQ(t.lookup(cc::MessageClass::CohSrt, &a0), &x);
+  EXPECT_EQ(t.lookup(cc::MessageClass::CohSnp, &a1), &y);
+  // Absent {class, agent} pairs, unassigned agents and null agents.
+  EXPECT_EQ(t.lookup(cc::MessageClass::CohCmd, &a0), nullptr);
+  EXPECT_EQ(t.lookup(cc::MessageClass::CohSrt, &a1), nullptr);
+  EXPECT_EQ(t.lookup(cc::MessageClass::CohSrt, &a2), nullptr);
+  EXPECT_EQ(t.lookup(cc::MessageClass::CohSrt, nullptr), nullptr);
+
+  std::size_t n = 0;
+  t.for_each([&](int*) { ++n; });
+  EXPECT_EQ(n, 2);
+}
+
+TEST(Msg, AgentCounts) {
+  cc::kernel::Kernel k;
+  cc::Agent a0(&k, "a0"), a1(&k, "a1");
+  cc::AgentCounts c;
+  EXPECT_EQ(c.count(&a0), 0);
+  c.set(&a0, 1);
+  c.set(&a1, 2);
+  c.set(&a0, c.count(&a0) + 1);
+  EXPECT_EQ(c.count(&a0), 2);
+  EXPECT_EQ(c.count(&a1), 2);
+  EXPECT_EQ(std::distance(c.begin(), c.end()), 2);
+}
+
+TEST(Msg, ActionResources) {
+  // Resource requirements of coherence actions are accumulated over
+  // the command list.
+  struct DirAction : cc::DirCoherenceAction {
+    explicit DirAction(const cc::Agent* a) : a_(a) {}
+    std::string to_string() const override { return "DirAction"; }
+    void set_resources(cc::DirResources& r) const override {
+      r.set_noc_credit_n(2);
+      r.set_coh_snp_n(a_, 1);
+    }
+    bool execute() override { return true; }
+    const cc::Agent* a_;
+  };
+  struct CCAction : cc::CCCoherenceAction {
+    explicit CCAction(const cc::Agent* a) : a_(a) {}
+    std::string to_string() const override { return "CCAction"; }
+    void set_resources(cc::CCResources& r) const override {
+      r.set_noc_credit_n(1);
+      r.set_coh_srt_n(a_, 1);
+    }
+    bool execute() override { return true; }
+    const cc::Agent* a_;
+  };
+
+  cc::kernel::Kernel k;
+  cc::Agent a0(&k, "a0"), a1(&k, "a1");
+  a0.set_id(0);
+  a1.set_id(1);
+
+  cc::DirCommandList dir_cl;
+  dir_cl.push_back(new DirAction(&a0));
+  dir_cl.push_back(new DirAction(&a0));
+  dir_cl.push_back(new DirAction(&a1));
+  const cc::DirResources dir_r(dir_cl);
+  EXPECT_EQ(dir_r.noc_credit_n(), 6);
+  EXPECT_EQ(dir_r.coh_snp_n(&a0), 2);
+  EXPECT_EQ(dir_r.coh_snp_n(&a1), 1);
+  EXPECT_EQ(dir_r.snoop_issue_n(), 3);
+
+  cc::CCCommandList cc_cl;
+  cc_cl.push_back(new CCAction(&a0));
+  const cc::CCResources cc_r(cc_cl);
+  EXPECT_EQ(cc_r.noc_credit_n(), 1);
+  EXPECT_EQ(cc_r.coh_srt_n(&a0), 1);
+  EXPECT_EQ(cc_r.coh_srt_n(&a1), 0);
+}
+
+TEST(Msg, MessageQueueCredits) {
+  cc::kernel::Kernel k;
+  cc::MessageQueue mq(&k, "mq", 2);
+  EXPECT_EQ(mq.n(), 2);
+
+  // Credited entries extend the configured depth.
+  mq.add_credits(3);
+  EXPECT_EQ(mq.n(), 5);
+  EXPECT_EQ(mq.credit_n(), 3);
+  EXPECT_TRUE(mq.has_at_least(5));
+
+  // Credited entries cannot be reclaimed.
+  EXPECT_THROW(mq.resize(2), std::runtime_error);
+  EXPECT_TRUE(k.fatal());
+}
+
+TEST(Msg, MessageQueueFanin) {
+  cc::kernel::Kernel k;
+  cc::MessageQueue mq(&k, "mq", 2);
+  mq.add_fanin(2);
+  EXPECT_EQ(mq.fanin_n(), 2);
+  mq.drc();
+  EXPECT_FALSE(k.fatal());
+
+  // Uncredited queue which cannot accept a message from each of its
+  // originators fails DRC.
+  mq.add_fanin(1);
+  EXPECT_THROW(mq.drc(), std::runtime_error);
+  EXPECT_TRUE(k.fatal());
+}
+
+TEST(Msg, MessageQueueFini) {
+  // Queue remains blocked at the end of simulation; the open interval
+  // is accounted upon finalization.
+  struct Top : cc::kernel::TopModule {
+    struct FiniAction : cc::kernel::Action {
+      FiniAction(cc::kernel::Kernel* k, cc::MessageQueue* mq)
+          : cc::kernel::Action(k, "fini_action"), mq_(mq) {}
+      bool eval() override {
+        mq_->fini();
+        // Repeated finalization does not double count.
+        mq_->fini();
+        return true;
+      }
+      cc::MessageQueue* mq_;
+    };
+
+    explicit Top(cc::kernel::Kernel* k)
+        : cc::kernel::TopModule(k, "top"), mq(k, "mq", 1), event(k, "e") {
+      mq.set_blocked_until(&event, cc::BlockReason::TransactionInFlight);
+      cc::kernel::ActionAdder aa(k);
+      aa.add_action(cc::kernel::Time{100, 0}, new FiniAction(k, &mq));
+    }
+    cc::MessageQueue mq;
+    cc::kernel::Event event;
+  };
+  cc::kernel::Kernel k;
+  Top top(&k);
+  cc::kernel::SimSequencer{&k}.run();
+
+  EXPECT_TRUE(top.mq.blocked());
+  EXPECT_EQ(top.mq.stats().total_blocked_time(), 100);
+}
+
+TEST(Msg, CreditCounterAndTableFini) {
+  // Credits remain exhausted, and the table full, at the end of
+  // simulation; the open intervals are accounted upon finalization.
+  struct Top : cc::kernel::TopModule {
+    struct FillAction : cc::kernel::Action {
+      FillAction(cc::kernel::Kernel* k, cc::CreditCounter* ccntr,
+                 cc::Table<int, int>* t)
+          : cc::kernel::Action(k, "fill_action"), ccntr_(ccntr), t_(t) {}
+      bool eval() override {
+        ccntr_->debit();
+        t_->install(0, 0);
+        return true;
+      }
+      cc::CreditCounter* ccntr_;
+      cc::Table<int, int>* t_;
+    };
+    struct FiniAction : cc::kernel::Action {
+      FiniAction(cc::kernel::Kernel* k, cc::CreditCounter* ccntr,
+                 cc::Table<int, int>* t)
+          : cc::kernel::Action(k, "fini_action"), ccntr_(ccntr), t_(t) {}
+      bool eval() override {
+        ccntr_->fini();
+        t_->fini();
+        // Repeated finalization does not double count.
+        ccntr_->fini();
+        t_->fini();
+        return true;
+      }
+      cc::CreditCounter* ccntr_;
+      cc::Table<int, int>* t_;
+    };
+
+    explicit Top(cc::kernel::Kernel* k)
+        : cc::kernel::TopModule(k, "top"), ccntr(k, "ccntr"), t(k, "t", 1) {
+      ccntr.set_n(1);
+      cc::kernel::ActionAdder aa(k);
+      aa.add_action(cc::kernel::Time{10, 0}, new FillAction(k, &ccntr, &t));
+      aa.add_action(cc::kernel::Time{100, 0}, new FiniAction(k, &ccntr, &t));
+    }
+    cc::CreditCounter ccntr;
+    cc::Table<int, int> t;
+  };
+  cc::kernel::Kernel k;
+  Top top(&k);
+  cc::kernel::SimSequencer{&k}.run();
+
+  EXPECT_TRUE(top.ccntr.empty());
+  EXPECT_EQ(top.ccntr.stats().empty_time, 90);
+  EXPECT_TRUE(top.t.full());
+  EXPECT_EQ(top.t.stats().full_time, 90);
+}
+
+TEST(Msg, MessageQueueUnblockRenotifies) {
+  // A message arrives whilst the queue is blocked; upon unblock the
+  // pending message is re-announced such that an agent which has since
+  // suspended awaiting the queue is awoken.
+  struct Top : cc::kernel::TopModule {
+    struct IssueAction : cc::kernel::Action {
+      IssueAction(cc::kernel::Kernel* k, cc::MessageQueue* mq)
+          : cc::kernel::Action(k, "issue_action"), mq_(mq) {}
+      bool eval() override {
+        mq_->issue(cc::Pool<cc::DtRspMsg>::construct());
+        return true;
+      }
+      cc::MessageQueue* mq_;
+    };
+    struct CountAction : cc::kernel::Action {
+      CountAction(cc::kernel::Kernel* k, std::size_t* n)
+          : cc::kernel::Action(k, "count_action"), n_(n) {}
+      bool eval() override {
+        ++*n_;
+        return true;
+      }
+      std::size_t* n_;
+    };
+    struct AwaitAction : cc::kernel::Action {
+      AwaitAction(cc::kernel::Kernel* k, cc::MessageQueue* mq,
+                  std::size_t* woken_n)
+          : cc::kernel::Action(k, "await_action"), mq_(mq),
+            woken_n_(woken_n) {}
+      bool eval() override {
+        // Queue is non-empty; suspend awaiting the next arrival.
+        mq_->non_empty_event()->add_notify_action(
+            new CountAction(k(), woken_n_));
+        return true;
+      }
+      cc::MessageQueue* mq_;
+      std::size_t* woken_n_;
+    };
+    struct NotifyAction : cc::kernel::Action {
+      NotifyAction(cc::kernel::Kernel* k, cc::kernel::Event* e)
+          : cc::kernel::Action(k, "notify_action"), e_(e) {}
+      bool eval() override {
+        e_->notify();
+        return true;
+      }
+      cc::kernel::Event* e_;
+    };
+
+    explicit Top(cc::kernel::Kernel* k)
+        : cc::kernel::TopModule(k, "top"), mq(k, "mq", 2), event(k, "e") {
+      mq.set_blocked_until(&event, cc::BlockReason::TransactionInFlight);
+      cc::kernel::ActionAdder aa(k);
+      aa.add_action(cc::kernel::Time{10, 0}, new IssueAction(k, &mq));
+      aa.add_action(cc::kernel::Time{50, 0},
+                    new AwaitAction(k, &mq, &woken_n));
+      aa.add_action(cc::kernel::Time{100, 0}, new NotifyAction(k, &event));
+    }
+    cc::MessageQueue mq;
+    cc::kernel::Event event;
+    std::size_t woken_n = 0;
+  };
+  cc::kernel::Kernel k;
+  Top top(&k);
+  cc::kernel::SimSequencer{&k}.run();
+
+  EXPECT_FALSE(top.mq.blocked());
+  EXPECT_TRUE(top.mq.has_req());
+  EXPECT_EQ(top.woken_n, 1);
+}
+
+TEST(Msg, SocQueueSizing) {
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(2);
+  cb.set_cpu_n(1);
+
+  cc::StimulusConfig stimulus_config;
+  stimulus_config.type = cc::StimulusType::Programmatic;
+  cb.set_stimulus(stimulus_config);
+
+  const cc::SocConfig cfg = cb.construct();
+
+  cc::kernel::Kernel k;
+  cc::SocTop top(&k, cfg);
+  cc::kernel::SimSequencer{&k}.run();
+  EXPECT_FALSE(k.fatal());
+
+  // Directory command queue: configured depth plus the CohSrt and
+  // CohCmd credits held by its cache controller.
+  const cc::DirAgentConfig& dcfg = cfg.dcfgs.front();
+  const cc::MessageQueue* cmdq = static_cast<const cc::MessageQueue*>(
+      top.find_path(cfg.name + "." + dcfg.name + ".cmdq0"));
+  ASSERT_NE(cmdq, nullptr);
+  EXPECT_EQ(cmdq->credit_n(),
+            dcfg.coh_srt_credits_n + dcfg.coh_cmd_credits_n);
+  EXPECT_EQ(cmdq->n(), dcfg.cmd_queue_n + cmdq->credit_n());
+
+  // Cache controller response queues: bounded by the credits of the
+  // commands which elicit them (CohSrt/CohCmd to each directory, Dt
+  // to each other cluster).
+  const cc::CpuClusterConfig& cccfg = cfg.ccls.front();
+  const std::string cc_path =
+      cfg.name + "." + cccfg.name + "." + cccfg.cc_config.name;
+  const cc::MessageQueue* rspq = static_cast<const cc::MessageQueue*>(
+      top.find_path(cc_path + ".dir_cc__rsp_q"));
+  ASSERT_NE(rspq, nullptr);
+  std::size_t rsp_credit_n = 0;
+  for (const cc::DirAgentConfig& d : cfg.dcfgs) {
+    rsp_credit_n += d.coh_srt_credits_n + d.coh_cmd_credits_n;
+  }
+  EXPECT_EQ(rspq->credit_n(), rsp_credit_n);
+  const cc::MessageQueue* dtrspq = static_cast<const cc::MessageQueue*>(
+      top.find_path(cc_path + ".cc_cc__rsp_q"));
+  ASSERT_NE(dtrspq, nullptr);
+  EXPECT_EQ(dtrspq->credit_n(),
+            cccfg.cc_config.dt_credits_n * (cfg.ccls.size() - 1));
+
+  // Endpoint queues accept a message from each other agent on the NOC.
+  const cc::MessageQueue* epq = static_cast<const cc::MessageQueue*>(
+      top.find_path(cfg.name + "." + dcfg.name + ".noc_ep.ingress_mq"));
+  ASSERT_NE(epq, nullptr);
+  EXPECT_GT(epq->fanin_n(), 0);
+  EXPECT_GE(epq->n(), epq->fanin_n());
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -291,6 +291,30 @@ TEST(Primitives, QueueBurst) {
   top->validate();
 }
 
+TEST(Primitives, QueueCapacity) {
+  cc::kernel::Kernel k;
+  // Capacity is exact, irrespective of the (power-of-two) storage.
+  cc::Queue<int> q(&k, "q", 3);
+  EXPECT_EQ(q.n(), 3);
+  for (int i = 0; i < 3; i++) EXPECT_TRUE(q.enqueue(i));
+  EXPECT_TRUE(q.full());
+  EXPECT_FALSE(q.enqueue(3));
+
+  // Order is retained as the pointers wrap.
+  int expected = 0, next = 3, actual = 0;
+  for (int i = 0; i < 16; i++) {
+    EXPECT_TRUE(q.dequeue(actual));
+    EXPECT_EQ(actual, expected++);
+    EXPECT_TRUE(q.enqueue(next++));
+    EXPECT_TRUE(q.full());
+  }
+
+  q.resize(5);
+  EXPECT_EQ(q.n(), 5);
+  EXPECT_TRUE(q.empty());
+  EXPECT_EQ(q.free(), 5);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,441 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#include "stats.h"
+#include "sim.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "cc/kernel.h"
+#include "cc/soc.h"
+#include "cc/stimulus.h"
+#include "gtest/gtest.h"
+#include "test/builder.h"
+
+namespace {
+
+struct TestStatBlock : cc::StatBlock {
+  explicit TestStatBlock(const std::string& path) : cc::StatBlock(path) {
+    add("a_n", &a_n);
+    add("b_n", &b_n);
+    add("occ", &occ);
+  }
+
+  cc::Counter a_n;
+  std::uint64_t b_n = 0;
+  cc::Gauge occ;
+};
+
+// Return value of statistic 'name' in block 'b' (or -1 if absent).
+std::int64_t find(const cc::StatBlock* b, const std::string& name) {
+  struct Finder : cc::StatVisitor {
+    void visit(const std::string& n, std::uint64_t value) override {
+      if (n == name) r = value;
+    }
+    void visit(const std::string& n, const cc::Gauge& g) override {
+      if (n == name) r = g.value();
+    }
+    void visit(const std::string& n, const cc::Histogram& h) override {
+      if (n == name) r = h.n();
+    }
+    std::string name;
+    std::int64_t r = -1;
+  } f;
+  f.name = name;
+  b->accept(&f);
+  return f.r;
+}
+
+}  // namespace
+
+TEST(Stats, Registry) {
+  cc::kernel::Kernel k;
+  cc::Statistics stats(&k, "statistics");
+
+  TestStatBlock* x = stats.register_block<TestStatBlock>("top.x");
+  TestStatBlock* y = stats.register_block<TestStatBlock>("top.y.z");
+  // Re-registration returns the original block.
+  EXPECT_EQ(stats.register_block<TestStatBlock>("top.x"), x);
+  EXPECT_EQ(stats.lookup("top.y.z"), y);
+  EXPECT_EQ(stats.lookup("top.w"), nullptr);
+
+  x->a_n.inc(3);
+  x->b_n = 5;
+  y->occ.inc(4);
+  y->occ.dec(3);
+  EXPECT_EQ(find(x, "a_n"), 3);
+  EXPECT_EQ(find(x, "b_n"), 5);
+  EXPECT_EQ(y->occ.value(), 1);
+  EXPECT_EQ(y->occ.max(), 4);
+
+  std::stringstream csv;
+  stats.write_csv(csv);
+  EXPECT_EQ(csv.str(),
+            "path,name,value\n"
+            "top.x,a_n,3\n"
+            "top.x,b_n,5\n"
+            "top.x,occ,0\n"
+            "top.x,occ_max,0\n"
+            "top.y.z,a_n,0\n"
+            "top.y.z,b_n,0\n"
+            "top.y.z,occ,1\n"
+            "top.y.z,occ_max,4\n");
+
+  std::stringstream json;
+  stats.write_json(json);
+  EXPECT_EQ(json.str(),
+            "{\n"
+            "  \"top\": {\n"
+            "    \"x\": {\n"
+            "      \"a_n\": 3,\n"
+            "      \"b_n\": 5,\n"
+            "      \"occ\": 0,\n"
+            "      \"occ_max\": 0\n"
+            "    },\n"
+            "    \"y\": {\n"
+            "      \"z\": {\n"
+            "        \"a_n\": 0,\n"
+            "        \"b_n\": 0,\n"
+            "        \"occ\": 1,\n"
+            "        \"occ_max\": 4\n"
+            "      }\n"
+            "    }\n"
+            "  }\n"
+            "}\n");
+}
+
+TEST(Stats, Histogram) {
+  cc::Histogram h;
+  EXPECT_EQ(h.quantile(0.5), 0);
+
+  for (std::uint64_t i = 1; i <= 1000; i++) h.add(i);
+  EXPECT_EQ(h.n(), 1000);
+  EXPECT_EQ(h.min(), 1);
+  EXPECT_EQ(h.max(), 1000);
+  EXPECT_DOUBLE_EQ(h.mean(), 500.5);
+  // Buckets are powers of two.
+  EXPECT_EQ(h.bucket(1), 1);
+  EXPECT_EQ(h.bucket(2), 2);
+  EXPECT_EQ(h.bucket(10), 489);
+  // Quantile estimates are within a factor of two.
+  for (double q : {0.5, 0.99, 0.999}) {
+    const double exact = q * 1000;
+    EXPECT_GE(h.quantile(q), exact / 2);
+    EXPECT_LE(h.quantile(q), exact * 2);
+  }
+  EXPECT_EQ(h.quantile(1.0), 1000);
+
+  // Single sample; all quantiles are the sample.
+  cc::Histogram s;
+  s.add(300);
+  EXPECT_EQ(s.quantile(0.5), 300);
+  EXPECT_EQ(s.quantile(0.999), 300);
+}
+
+TEST(Stats, HotLines) {
+  cc::CountMinSketch sketch(64, 4);
+  for (std::uint64_t key = 0; key < 256; key++) sketch.add(key);
+  const std::uint64_t est = sketch.add(1000, 10);
+  EXPECT_EQ(est, sketch.estimate(1000));
+  // Estimates never under-count.
+  EXPECT_GE(est, 10);
+  for (std::uint64_t key = 0; key < 256; key++) {
+    EXPECT_GE(sketch.estimate(key), 1);
+  }
+
+  // Retain two lines: 0x40 (most contended), then 0x80; 0xC0 is
+  // never amongst the two most contended.
+  cc::HotLineTracker hl(2);
+  cc::kernel::Kernel k;
+  const cc::Agent agent_a(&k, "a");
+  const cc::Agent agent_b(&k, "b");
+  const cc::Agent* a = &agent_a;
+  const cc::Agent* b = &agent_b;
+  EXPECT_FALSE(hl.record(0x40, 0, a, true, 0));
+  EXPECT_TRUE(hl.record(0x40, 8, b, true, 1));
+  EXPECT_TRUE(hl.record(0x40, 0, a, true, 1));
+  EXPECT_FALSE(hl.record(0x80, 0, a, false, 2));
+  EXPECT_FALSE(hl.record(0xC0, 0, a, false, 1));
+  const std::vector<cc::HotLineTracker::Line> top = hl.top();
+  ASSERT_EQ(top.size(), 2);
+  EXPECT_EQ(top[0].addr, 0x40);
+  EXPECT_EQ(top[0].score, 4);
+  EXPECT_EQ(top[0].migration_n, 2);
+  EXPECT_EQ(top[0].invalidation_n, 2);
+  ASSERT_EQ(top[0].writers.size(), 2);
+  // Writers at disjoint offsets.
+  EXPECT_TRUE(top[0].is_false_sharing());
+  EXPECT_EQ(top[1].addr, 0x80);
+  EXPECT_FALSE(top[1].is_false_sharing());
+
+  // A common offset is true sharing.
+  hl.record(0x40, 8, a, true, 1);
+  EXPECT_FALSE(hl.top()[0].is_false_sharing());
+}
+
+TEST(Stats, Soc) {
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(2);
+  cb.set_cpu_n(1);
+
+  cc::StimulusConfig stimulus_config;
+  stimulus_config.type = cc::StimulusType::Programmatic;
+  cb.set_stimulus(stimulus_config);
+
+  const cc::SocConfig cfg = cb.construct();
+
+  cc::kernel::Kernel k;
+  cc::SocTop top(&k, cfg);
+
+  cc::ProgrammaticStimulus* stimulus =
+      static_cast<cc::ProgrammaticStimulus*>(top.stimulus());
+  stimulus->advance_cursor(200);
+  stimulus->push_stimulus(0, cc::CpuOpcode::Load, 0);
+  stimulus->advance_cursor(200);
+  stimulus->push_stimulus(1, cc::CpuOpcode::Store, 0);
+
+  cc::kernel::SimSequencer{&k}.run();
+
+  // Each agent has registered its block under its full path.
+  const cc::Statistics* stats = top.statistics();
+  ASSERT_NE(stats, nullptr);
+  for (const char* path : {"top.cluster0.cpu0", "top.cluster0.l1cache0",
+                           "top.cluster0.l2cache", "top.cluster0.ccntrl",
+                           "top.cluster1.ccntrl", "top.dir0", "top.llc",
+                           "top.noc"}) {
+    EXPECT_NE(stats->lookup(path), nullptr) << path;
+  }
+  EXPECT_EQ(find(stats->lookup("top.cluster0.cpu0"), "retire_n"), 1);
+  EXPECT_EQ(find(stats->lookup("top.cluster1.cpu0"), "retire_n"), 1);
+  EXPECT_EQ(find(stats->lookup("top.cluster0.l1cache0"), "load_miss_n"), 1);
+  EXPECT_EQ(find(stats->lookup("top.cluster1.l1cache0"), "store_miss_n"), 1);
+  // Store invalidates the line previously loaded by cluster0.
+  EXPECT_EQ(find(stats->lookup("top.cluster0.ccntrl"), "snoop_n"), 1);
+  EXPECT_EQ(find(stats->lookup("top.cluster0.l2cache"), "recall_n"), 1);
+  EXPECT_EQ(find(stats->lookup("top.dir0"), "cmd_n"), 2);
+  EXPECT_EQ(find(stats->lookup("top.dir0"), "snoop_rsp_n"), 1);
+  EXPECT_EQ(find(stats->lookup("top.llc"), "fill_n"), 1);
+  EXPECT_GT(find(stats->lookup("top.noc"), "forward_n"), 0);
+
+  // Latency: cluster0 load is serviced by memory; cluster1 store
+  // is serviced by a snoop of cluster0.
+  const cc::StatBlock* cpu0 = stats->lookup("top.cluster0.cpu0");
+  EXPECT_EQ(find(cpu0, "ld_latency"), 1);
+  EXPECT_EQ(find(cpu0, "st_latency"), 0);
+  EXPECT_EQ(find(cpu0, "mem_latency"), 1);
+  EXPECT_EQ(find(cpu0, "stage_L1Miss"), 1);
+  EXPECT_EQ(find(cpu0, "stage_Fill"), 1);
+  EXPECT_EQ(find(cpu0, "stage_SnoopIssue"), 0);
+  const cc::StatBlock* cpu1 = stats->lookup("top.cluster1.cpu0");
+  EXPECT_EQ(find(cpu1, "st_latency"), 1);
+  EXPECT_EQ(find(cpu1, "c2c_latency"), 1);
+  EXPECT_EQ(find(cpu1, "stage_SnoopIssue"), 1);
+}
+
+TEST(Stats, Sampler) {
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(1);
+  cb.set_cpu_n(1);
+
+  cc::StimulusConfig stimulus_config;
+  stimulus_config.type = cc::StimulusType::Programmatic;
+  cb.set_stimulus(stimulus_config);
+
+  cc::SocConfig cfg = cb.construct();
+  const std::string fn = testing::TempDir() + "stats_sampler.csv";
+  cfg.sampler.interval = 50;
+  cfg.sampler.filename = fn;
+  cfg.sampler.select = {"top.cluster0.cpu0.issue_n",
+                        "top.cluster0.cpu0.retire_n",
+                        "top.cluster0.cpu0.cpu_l1__cmd_q.occupancy",
+                        "top.cluster0.l1cache0.tt.fill", "kernel."};
+  // Small depth; exercises flush of retained samples.
+  cfg.sampler.depth = 2;
+
+  {
+    cc::kernel::Kernel k;
+    cc::SocTop top(&k, cfg);
+
+    cc::ProgrammaticStimulus* stimulus =
+        static_cast<cc::ProgrammaticStimulus*>(top.stimulus());
+    for (int i = 0; i < 4; i++) {
+      stimulus->advance_cursor(200);
+      stimulus->push_stimulus(0, cc::CpuOpcode::Load, i * 64);
+    }
+
+    cc::kernel::SimSequencer{&k}.run();
+  }
+
+  std::ifstream is(fn);
+  std::string line;
+  ASSERT_TRUE(std::getline(is, line));
+  EXPECT_EQ(line,
+            "time,top.cluster0.cpu0.issue_n,top.cluster0.cpu0.retire_n,"
+            "top.cluster0.cpu0.cpu_l1__cmd_q.occupancy,"
+            "top.cluster0.l1cache0.tt.fill,kernel.events_n");
+
+  // Samples are periodic (excepting the final sample) and counts are
+  // monotonic.
+  std::vector<std::vector<std::int64_t>> rows;
+  while (std::getline(is, line)) {
+    std::vector<std::int64_t> row;
+    std::stringstream ss(line);
+    for (std::string v; std::getline(ss, v, ',');) row.push_back(std::stoll(v));
+    ASSERT_EQ(row.size(), 6);
+    rows.push_back(row);
+  }
+  ASSERT_GT(rows.size(), 10);
+  for (std::size_t i = 1; i < rows.size(); i++) {
+    if (i + 1 < rows.size()) {
+      EXPECT_EQ(rows[i][0] - rows[i - 1][0], 50);
+    }
+    EXPECT_GE(rows[i][1], rows[i - 1][1]);
+    EXPECT_GE(rows[i][2], rows[i - 1][2]);
+  }
+  EXPECT_EQ(rows.back()[1], 4);
+  EXPECT_EQ(rows.back()[2], 4);
+  std::remove(fn.c_str());
+}
+
+TEST(Stats, SamplerNegativeInterval) {
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(1);
+  cb.set_cpu_n(1);
+
+  cc::StimulusConfig stimulus_config;
+  stimulus_config.type = cc::StimulusType::Programmatic;
+  cb.set_stimulus(stimulus_config);
+
+  cc::SocConfig cfg = cb.construct();
+  cfg.sampler.interval = -1;
+  cfg.sampler.filename = testing::TempDir() + "stats_sampler_neg.csv";
+
+  // Rejected in drc.
+  cc::kernel::Kernel k;
+  cc::SocTop top(&k, cfg);
+  EXPECT_THROW(cc::kernel::SimSequencer{&k}.run(), std::runtime_error);
+}
+
+TEST(Stats, BackPressure) {
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(2);
+  cb.set_cpu_n(1);
+
+  cc::StimulusConfig stimulus_config;
+  stimulus_config.type = cc::StimulusType::Programmatic;
+  cb.set_stimulus(stimulus_config);
+
+  const cc::SocConfig cfg = cb.construct();
+
+  cc::kernel::Kernel k;
+  cc::SocTop top(&k, cfg);
+
+  // Coincident stores to the same line from both clusters; commands
+  // to the line are serialized behind the in-flight transaction.
+  cc::ProgrammaticStimulus* stimulus =
+      static_cast<cc::ProgrammaticStimulus*>(top.stimulus());
+  stimulus->advance_cursor(200);
+  for (int i = 0; i < 4; i++) {
+    stimulus->push_stimulus(0, cc::CpuOpcode::Store, 0);
+    stimulus->push_stimulus(1, cc::CpuOpcode::Store, 0);
+  }
+
+  cc::kernel::SimSequencer{&k}.run();
+
+  const cc::Statistics* stats = top.statistics();
+  const std::vector<const cc::MessageQueue*> mqs = stats->bottlenecks(4);
+  ASSERT_FALSE(mqs.empty());
+  EXPECT_LE(mqs.size(), 4);
+  auto score = [](const cc::MessageQueue* mq) {
+    return mq->stats().total_blocked_time() + mq->stats().full_time;
+  };
+  for (std::size_t i = 1; i < mqs.size(); i++) {
+    EXPECT_GE(score(mqs[i - 1]), score(mqs[i]));
+  }
+
+  // Blocking is attributed to the in-flight transaction and is
+  // reported in the queue's block.
+  std::uint64_t tif_time = 0;
+  for (const cc::MessageQueue* mq : stats->bottlenecks(100)) {
+    const cc::StatBlock* b = stats->lookup(mq->path());
+    ASSERT_NE(b, nullptr);
+    tif_time += find(b, "blocked_time_TransactionInFlight");
+    EXPECT_EQ(find(b, "occupancy"), mq->stats().occupancy.n());
+  }
+  EXPECT_GT(tif_time, 0);
+}
+
+TEST(Stats, FalseSharing) {
+  // Clusters alternately store to offsets 'off0' and 'off1' of line 0.
+  auto run = [](cc::addr_t off0, cc::addr_t off1) {
+    test::ConfigBuilder cb;
+    cb.set_dir_n(1);
+    cb.set_cc_n(2);
+    cb.set_cpu_n(1);
+
+    cc::StimulusConfig stimulus_config;
+    stimulus_config.type = cc::StimulusType::Programmatic;
+    cb.set_stimulus(stimulus_config);
+
+    const cc::SocConfig cfg = cb.construct();
+
+    cc::kernel::Kernel k;
+    cc::SocTop top(&k, cfg);
+
+    cc::ProgrammaticStimulus* stimulus =
+        static_cast<cc::ProgrammaticStimulus*>(top.stimulus());
+    for (int i = 0; i < 3; i++) {
+      stimulus->advance_cursor(200);
+      stimulus->push_stimulus(0, cc::CpuOpcode::Store, off0);
+      stimulus->advance_cursor(200);
+      stimulus->push_stimulus(1, cc::CpuOpcode::Store, off1);
+    }
+
+    cc::kernel::SimSequencer{&k}.run();
+
+    const cc::DirStatBlock* dir = static_cast<const cc::DirStatBlock*>(
+        top.statistics()->lookup("top.dir0"));
+    // Ownership passes between clusters upon each store.
+    EXPECT_EQ(dir->migration_n.value(), 5);
+    EXPECT_EQ(dir->invalidation_n.value(), 5);
+    EXPECT_EQ(dir->invalidation_fanout.n(), 6);
+    EXPECT_EQ(dir->invalidation_fanout.max(), 1);
+
+    const std::vector<cc::HotLineTracker::Line> lines = dir->hot_lines.top();
+    EXPECT_EQ(lines.size(), 1);
+    if (lines.empty()) return false;
+    EXPECT_EQ(lines.front().addr, 0);
+    EXPECT_EQ(lines.front().writers.size(), 2);
+    return lines.front().is_false_sharing();
+  };
+  EXPECT_TRUE(run(0, 8));
+  EXPECT_FALSE(run(0, 0));
+}
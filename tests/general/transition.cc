@@ -0,0 +1,137 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#include "transition.h"
+
+#include <string>
+
+#include "moesi_dir.h"
+#include "moesi_l2.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+enum class State { A, B, C, X };
+
+enum class Event { Go, Stop, Invalid };
+
+const char* to_string(State state) {
+  switch (state) {
+    case State::A: return "A";
+    case State::B: return "B";
+    case State::C: return "C";
+    default:       return "X";
+  }
+}
+
+const char* to_string(Event event) {
+  switch (event) {
+    case Event::Go:   return "Go";
+    case Event::Stop: return "Stop";
+    default:          return "Invalid";
+  }
+}
+
+struct Args {
+  bool flag = false;
+  std::string trace;
+};
+
+bool is_flag(const Args& args) { return args.flag; }
+
+template <char C>
+struct Append {
+  void operator()(Args& args) const { args.trace.push_back(C); }
+};
+
+using T = cc::Transition<State, Event, Args, 2>;
+
+template <typename A>
+constexpr T::action_type act = &cc::invoke_action<A, Args>;
+
+constexpr std::array<T, 4> rows{{
+    {State::A, Event::Go, &is_flag, "is_flag", {act<Append<'f'>>, nullptr},
+     State::C},
+    {State::B, Event::Stop, nullptr, nullptr, {act<Append<'s'>>, nullptr},
+     State::A},
+    {State::A, Event::Go, nullptr, nullptr,
+     {act<Append<'a'>>, act<Append<'b'>>}, State::B},
+    {State::C, Event::Stop, nullptr, nullptr, {nullptr, nullptr}, State::A},
+}};
+
+constexpr cc::TransitionTable<T, rows.size(), 4, 2> table{rows};
+
+// Index is computed at compile time.
+static_assert(table.count(State::A, Event::Go) == 2);
+static_assert(table.count(State::B, Event::Go) == 0);
+
+}  // namespace
+
+TEST(Transition, Lookup) {
+  Args args;
+  const T* t = table.lookup(State::A, Event::Go, args);
+  ASSERT_NE(t, nullptr);
+  EXPECT_EQ(t->next, State::B);
+  t->invoke(args);
+  EXPECT_EQ(args.trace, "ab");
+
+  EXPECT_EQ(table.lookup(State::B, Event::Go, args), nullptr);
+}
+
+TEST(Transition, GuardOrder) {
+  // Guarded row is declared first and is therefore evaluated first.
+  Args args;
+  args.flag = true;
+  const T* t = table.lookup(State::A, Event::Go, args);
+  ASSERT_NE(t, nullptr);
+  EXPECT_EQ(t->next, State::C);
+  t->invoke(args);
+  EXPECT_EQ(args.trace, "f");
+}
+
+TEST(Transition, Render) {
+  const std::string s = cc::render_transitions(table);
+  EXPECT_NE(s.find("is_flag"), std::string::npos);
+  EXPECT_NE(s.find("Stop"), std::string::npos);
+}
+
+TEST(Transition, ProtocolTables) {
+  // L2 and directory protocols are expressed as transition tables.
+  const std::string l2 = cc::moesi::render_l2_transitions();
+  EXPECT_NE(l2.find("SnpReadUnique"), std::string::npos);
+  EXPECT_NE(l2.find("is_pass_dirty"), std::string::npos);
+
+  const std::string dir = cc::moesi::render_dir_transitions();
+  EXPECT_NE(dir.find("SnpRspReadShared"), std::string::npos);
+  EXPECT_NE(dir.find("is_final_shared_dirty"), std::string::npos);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
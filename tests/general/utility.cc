@@ -26,8 +26,10 @@
 //========================================================================== //
 
 #include "utility.h"
+#include "cc/cfgs.h"
 
 #include "gtest/gtest.h"
+#include <set>
 #include <string>
 #include <vector>
 
@@ -53,6 +55,35 @@ TEST(Utility, Split) {
   EXPECT_EQ(actual, expected);
 }
 
+TEST(Utility, AddrInterleaver) {
+  cc::InterleaveConfig cfg;
+
+  // Line: consecutive lines map to consecutive agents.
+  const cc::AddrInterleaver line(cfg, 4);
+  for (cc::addr_t i = 0; i < 16; i++) {
+    EXPECT_EQ(line.index(i * 64), i % 4);
+    EXPECT_EQ(line.index(i * 64 + 63), i % 4);
+  }
+
+  // Page: all lines in a page map to the same agent.
+  cfg.type = cc::InterleaveType::Page;
+  const cc::AddrInterleaver page(cfg, 3);
+  EXPECT_EQ(page.index(0), page.index(4095));
+  EXPECT_EQ(page.index(4096), 1);
+  EXPECT_EQ(page.index(3 * 4096), 0);
+
+  // Xor: a power-of-two stride which aliases to a single agent under
+  // line interleave is spread across all agents.
+  cfg.type = cc::InterleaveType::Xor;
+  const cc::AddrInterleaver x(cfg, 4);
+  std::set<std::size_t> is;
+  for (cc::addr_t i = 0; i < 16; i++) {
+    EXPECT_EQ(line.index(i * 4 * 64), 0);
+    is.insert(x.index(i * 4 * 64));
+  }
+  EXPECT_EQ(is.size(), 4);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
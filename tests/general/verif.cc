@@ -0,0 +1,149 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#include "verif.h"
+#include "l1cache.h"
+#include "cc/kernel.h"
+#include "cc/soc.h"
+#include "cc/stimulus.h"
+#include "gtest/gtest.h"
+#include "test/builder.h"
+
+namespace {
+
+cc::SocConfig construct_cfg(bool verif_async) {
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(2);
+  cb.set_cpu_n(1);
+
+  cc::StimulusConfig stimulus_config;
+  stimulus_config.type = cc::StimulusType::Programmatic;
+  cb.set_stimulus(stimulus_config);
+
+  cc::SocConfig cfg = cb.construct();
+  cfg.verif_async = verif_async;
+  return cfg;
+}
+
+} // namespace
+
+TEST(Verif, Async) {
+  const cc::SocConfig cfg = construct_cfg(true);
+  cc::kernel::Kernel k;
+  cc::SocTop top(&k, cfg);
+  ASSERT_NE(top.monitor(), nullptr);
+  EXPECT_TRUE(top.monitor()->is_async());
+
+  // Clusters alternately store to the same line.
+  cc::ProgrammaticStimulus* stimulus =
+      static_cast<cc::ProgrammaticStimulus*>(top.stimulus());
+  for (int i = 0; i < 8; i++) {
+    stimulus->advance_cursor(200);
+    stimulus->push_stimulus(i % 2, cc::CpuOpcode::Store, 0);
+  }
+
+  cc::kernel::SimSequencer{&k}.run();
+  EXPECT_FALSE(k.fatal());
+  EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
+}
+
+TEST(Verif, Violation) {
+  for (bool verif_async : {false, true}) {
+    const cc::SocConfig cfg = construct_cfg(verif_async);
+    cc::kernel::Kernel k;
+    cc::SocTop top(&k, cfg);
+    cc::kernel::SimPhaseRunner runner(&k);
+    runner.elab();
+    runner.drc();
+    runner.init();
+
+    // Read hit to a line which has never been installed.
+    cc::L1CacheAgent* l1c = static_cast<cc::L1CacheAgent*>(
+        top.find_path(test::path_l1c_by_cpu_id(cfg, 0)));
+    ASSERT_NE(l1c, nullptr);
+    if (verif_async) {
+      // Violation is raised upon drain of the checker.
+      top.monitor()->read_hit(l1c, 0x1000);
+      EXPECT_THROW(runner.fini(), std::runtime_error);
+    } else {
+      EXPECT_THROW(top.monitor()->read_hit(l1c, 0x1000),
+                   std::runtime_error);
+    }
+    EXPECT_TRUE(k.fatal());
+  }
+}
+
+TEST(Verif, ResetDrains) {
+  const cc::SocConfig cfg = construct_cfg(true);
+  cc::kernel::Kernel k;
+  cc::SocTop top(&k, cfg);
+  cc::kernel::SimPhaseRunner runner(&k);
+  runner.elab();
+  runner.drc();
+  runner.init();
+
+  cc::L1CacheAgent* l1c = static_cast<cc::L1CacheAgent*>(
+      top.find_path(test::path_l1c_by_cpu_id(cfg, 0)));
+  ASSERT_NE(l1c, nullptr);
+  // Outstanding check is not discarded upon reset; the violation is
+  // raised once the checker has drained.
+  top.monitor()->read_hit(l1c, 0x1000);
+  EXPECT_THROW(top.monitor()->reset(), std::runtime_error);
+  EXPECT_TRUE(k.fatal());
+}
+
+TEST(Verif, UpgradeRetiresSharer) {
+  const cc::SocConfig cfg = construct_cfg(false);
+  cc::kernel::Kernel k;
+  cc::SocTop top(&k, cfg);
+  cc::kernel::SimPhaseRunner runner(&k);
+  runner.elab();
+  runner.drc();
+  runner.init();
+
+  cc::L1CacheAgent* l1c0 = static_cast<cc::L1CacheAgent*>(
+      top.find_path(test::path_l1c_by_cpu_id(cfg, 0)));
+  cc::L1CacheAgent* l1c1 = static_cast<cc::L1CacheAgent*>(
+      top.find_path(test::path_l1c_by_cpu_id(cfg, 1)));
+  ASSERT_NE(l1c0, nullptr);
+  ASSERT_NE(l1c1, nullptr);
+
+  // L1 installs the line Shared, upgrades to writeable and is then
+  // evicted; the line no longer resides in any cache.
+  cc::Monitor* monitor = top.monitor();
+  monitor->install_line(l1c0, 0x1000, false);
+  monitor->install_line(l1c0, 0x1000, true);
+  monitor->remove_line(l1c0, 0x1000);
+
+  // Another L1 may therefore install the line writeable, and the
+  // original L1 may subsequently re-install the line.
+  EXPECT_NO_THROW(monitor->install_line(l1c1, 0x1000, true));
+  EXPECT_NO_THROW(monitor->remove_line(l1c1, 0x1000));
+  EXPECT_NO_THROW(monitor->install_line(l1c0, 0x1000, false));
+  EXPECT_FALSE(k.fatal());
+}
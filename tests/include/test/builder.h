@@ -45,6 +45,9 @@ class ConfigBuilder {
   // Current Cluster count
   std::size_t cc_n() const { return cc_n_; }
 
+  // Current Memory Controller count
+  std::size_t mem_n() const { return mem_n_; }
+
 
   // Set CPU count (replicating per Cluster).
   void set_cpu_n(std::size_t n) { cpu_n_ = n; }
@@ -55,9 +58,25 @@ class ConfigBuilder {
   // Set Cpu Cluster count
   void set_cc_n(std::size_t n) { cc_n_ = n; }
 
+  // Set Memory Controller count
+  void set_mem_n(std::size_t n) { mem_n_ = n; }
+
+  // Set directory interleave configuration.
+  void set_dir_interleave(const cc::InterleaveConfig& c) {
+    dir_interleave_ = c;
+  }
+
+  // Set memory controller interleave configuration.
+  void set_mem_interleave(const cc::InterleaveConfig& c) {
+    mem_interleave_ = c;
+  }
+
   // Set stimulus configuration.
   void set_stimulus(const cc::StimulusConfig& s) { stimulus_config_ = s; }
 
+  // Set CPU configuration (replicated for each CPU).
+  void set_cpu_config(const cc::CpuConfig& c) { cpu_config_ = c; }
+
 
   // Construct SOC configuration.
   cc::SocConfig construct() const;
@@ -75,8 +94,20 @@ class ConfigBuilder {
   // CPU cluster count.
   std::size_t cc_n_ = 1;
 
+  // Memory controller count.
+  std::size_t mem_n_ = 1;
+
+  // Directory interleave configuration.
+  cc::InterleaveConfig dir_interleave_;
+
+  // Memory controller interleave configuration.
+  cc::InterleaveConfig mem_interleave_;
+
   // Stimulus Configuration
   cc::StimulusConfig stimulus_config_;
+
+  // CPU Configuration
+  cc::CpuConfig cpu_config_;
 };
 
 // Compute CPU path in object model by ID.
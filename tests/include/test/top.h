@@ -47,6 +47,9 @@ class TbTop {
 
   cc::cursor_t time() const { return soc_->time(); }
 
+  // Simulation has terminated on a fatal error.
+  bool fatal() const { return soc_->fatal(); }
+
   // Invoke simulation initialization.
   void initialize();
 
@@ -57,6 +60,9 @@ class TbTop {
   // Finalize/Terminate simulation.
   void finalize();
 
+  // Return to post-elaboration state.
+  void reset();
+
   // Invoke: initialization, Run and Finalization
   void run_all(cc::kernel::RunMode r = cc::kernel::RunMode::ToExhaustion,
                cc::kernel::Time time = cc::kernel::Time{});
@@ -0,0 +1,225 @@
+//========================================================================== //
+// Copyright (c) 2020, Stephen Henry
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//========================================================================== //
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "test/builder.h"
+#include "cc/kernel.h"
+#include "cc/soc.h"
+#include "cc/stimulus.h"
+#include "src/cpu.h"
+#include "test/top.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+// Text trace common to tests.
+const char* trace =
+    // Map CPU ID to location in object hierarchy.
+    "M:0,top.cluster0.cpu0\n"
+    "M:1,top.cluster1.cpu0\n"
+    // Advance 200 time-units
+    "+200\n"
+    "C:0,LD,0x1000\n"
+    "+200\n"
+    "C:1,LD,0x1000\n"
+    "+200\n"
+    "C:0,LD,0x1040 // Comment\n"
+    "+200\n"
+    "C:1,LD,0x1040,DEP\n"
+    "+200\n"
+    "C:0,LD,0x1080\n"
+    ;
+
+std::string to_binary(const std::string& text) {
+  std::istringstream is(text);
+  std::ostringstream os;
+  cc::convert_trace_to_binary(is, os);
+  return os.str();
+}
+
+// Run configuration to exhaustion and validate transaction counts.
+void run_and_validate(const cc::StimulusConfig& stimulus_config,
+                      std::size_t expected_n) {
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(2);
+  cb.set_cpu_n(1);
+  cb.set_stimulus(stimulus_config);
+
+  const cc::SocConfig cfg = cb.construct();
+
+  cc::kernel::Kernel k;
+  cc::SocTop top(&k, cfg);
+
+  // Run to exhaustion
+  cc::kernel::SimSequencer{&k}.run();
+
+  // Validation.
+
+  cc::Stimulus* stimulus = top.stimulus();
+
+  // Validate expected transaction count.
+  EXPECT_EQ(stimulus->issue_n(), expected_n);
+
+  // Validate that all transactions have retired at end-of-sim.
+  EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
+}
+
+// Consume the stream bound to the CPU at 'path' and validate it against
+// 'expected'.
+void validate_stream(const test::TbTop& top, const std::string& path,
+                     const std::vector<cc::Frontier>& expected) {
+  cc::Cpu* cpu = top.lookup_by_path<cc::Cpu>(path);
+  ASSERT_NE(cpu, nullptr);
+  cc::StimulusContext* ctxt = cpu->stimulus();
+  ASSERT_NE(ctxt, nullptr);
+
+  for (const cc::Frontier& e : expected) {
+    cc::Frontier f;
+    ASSERT_TRUE(ctxt->front(f));
+    EXPECT_EQ(f.time.time, e.time.time);
+    EXPECT_EQ(f.cmd.opcode(), e.cmd.opcode());
+    EXPECT_EQ(f.cmd.addr(), e.cmd.addr());
+    EXPECT_EQ(f.cmd.dep(), e.cmd.dep());
+    ctxt->issue();
+  }
+  // Stream is exhausted.
+  cc::Frontier f;
+  EXPECT_FALSE(ctxt->front(f));
+  EXPECT_TRUE(ctxt->done());
+}
+
+}  // namespace
+
+TEST(BinaryTrace, Convert) {
+  const std::string bin = to_binary(trace);
+
+  // Magic
+  EXPECT_EQ(bin.substr(0, 4), "CCTB");
+  // Binary trace is substantially smaller than its text equivalent;
+  // the header (CPU paths) dominates for such a short trace.
+  EXPECT_LT(bin.size(), std::string{trace}.size() / 2);
+}
+
+TEST(BinaryTrace, ConvertMalformed) {
+  // Invalid opcode
+  EXPECT_THROW(to_binary("M:0,top.cluster0.cpu0\nC:0,XX,0\n"),
+               cc::StimulusException);
+  // Command to unmapped CPU
+  EXPECT_THROW(to_binary("C:0,LD,0\n"), cc::StimulusException);
+  // Unknown directive
+  EXPECT_THROW(to_binary("X\n"), cc::StimulusException);
+}
+
+TEST(BinaryTrace, ConvertDependent) {
+  // Load-to-use dependence marker is retained.
+  const std::string plain = to_binary("M:0,top.cluster0.cpu0\nC:0,LD,0\n");
+  const std::string dep = to_binary("M:0,top.cluster0.cpu0\nC:0,LD,0,DEP\n");
+  EXPECT_NE(plain, dep);
+  // Invalid flag
+  EXPECT_THROW(to_binary("M:0,top.cluster0.cpu0\nC:0,LD,0,XX\n"),
+               cc::StimulusException);
+}
+
+TEST(BinaryTrace, RoundTrip) {
+  // Commands are interleaved across CPUs, addresses descend (negative
+  // deltas, including to below the initial address), and stores and
+  // load-to-use markers are mixed.
+  const char* text =
+      "M:0,top.cluster0.cpu0\n"
+      "M:1,top.cluster1.cpu0\n"
+      "+100\n"
+      "C:0,LD,0x10000\n"
+      "C:1,ST,0x2040\n"
+      "+50\n"
+      "C:0,ST,0xffc0,DEP\n"
+      "+25\n"
+      "C:1,LD,0x40,DEP\n"
+      "C:0,LD,0x0\n"
+      "+1000\n"
+      "C:0,ST,0x7fffffc0\n"
+      "C:1,ST,0x1000,DEP\n"
+      "+1\n"
+      "C:0,LD,0x80,DEP\n"
+      ;
+
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(2);
+  cb.set_cpu_n(1);
+  cb.set_stimulus(cc::BinaryTraceStimulus::from_string(to_binary(text)));
+
+  test::TbTop top(cb.construct());
+  top.initialize();
+
+  using cc::Command;
+  using cc::CpuOpcode;
+  using cc::Frontier;
+  using cc::kernel::Time;
+
+  validate_stream(top, "top.cluster0.cpu0", {
+      Frontier{Time{100}, Command{CpuOpcode::Load, 0x10000}},
+      Frontier{Time{150}, Command{CpuOpcode::Store, 0xffc0, true}},
+      Frontier{Time{175}, Command{CpuOpcode::Load, 0x0}},
+      Frontier{Time{1175}, Command{CpuOpcode::Store, 0x7fffffc0}},
+      Frontier{Time{1176}, Command{CpuOpcode::Load, 0x80, true}},
+    });
+  validate_stream(top, "top.cluster1.cpu0", {
+      Frontier{Time{100}, Command{CpuOpcode::Store, 0x2040}},
+      Frontier{Time{175}, Command{CpuOpcode::Load, 0x40, true}},
+      Frontier{Time{1175}, Command{CpuOpcode::Store, 0x1000, true}},
+    });
+}
+
+TEST(BinaryTrace, Cfg121_FromString) {
+  run_and_validate(cc::BinaryTraceStimulus::from_string(to_binary(trace)), 5);
+}
+
+TEST(BinaryTrace, Cfg121_Mapped) {
+  const std::string filename = testing::TempDir() + "cfg121.cctb";
+  {
+    std::ofstream os(filename, std::ios::binary);
+    const std::string bin = to_binary(trace);
+    os.write(bin.data(), bin.size());
+  }
+
+  cc::StimulusConfig stimulus_config;
+  stimulus_config.type = cc::StimulusType::BinaryTrace;
+  stimulus_config.filename = filename;
+  run_and_validate(stimulus_config, 5);
+
+  std::remove(filename.c_str());
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
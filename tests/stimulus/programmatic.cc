@@ -126,6 +126,76 @@ TEST(Programmatic, Cfg111_BadCpuID) {
                cc::StimulusException);
 }
 
+namespace {
+
+// Issue 'n' coincident Loads to distinct lines from a single CPU and
+// return the end-of-simulation time.
+cc::kernel::Time run_coincident_loads(const cc::CpuConfig& cpu_config,
+                                      std::size_t n, bool dep = false) {
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(1);
+  cb.set_cpu_n(1);
+  cb.set_cpu_config(cpu_config);
+
+  cc::StimulusConfig stimulus_config;
+  stimulus_config.type = cc::StimulusType::Programmatic;
+  cb.set_stimulus(stimulus_config);
+
+  const cc::SocConfig cfg = cb.construct();
+
+  cc::kernel::Kernel k;
+  cc::SocTop top(&k, cfg);
+
+  cc::ProgrammaticStimulus* stimulus =
+      static_cast<cc::ProgrammaticStimulus*>(top.stimulus());
+  stimulus->advance_cursor(200);
+  for (std::size_t i = 0; i < n; i++) {
+    stimulus->push_stimulus(0, cc::CpuOpcode::Load, i * 64, dep);
+  }
+
+  // Run to exhaustion
+  cc::kernel::SimSequencer{&k}.run();
+
+  // Validate expected transaction count.
+  EXPECT_EQ(stimulus->issue_n(), n);
+
+  // Validate that all transactions have retired at end-of-sim.
+  EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
+
+  return k.time();
+}
+
+}  // namespace
+
+// Commands within the MLP window issue concurrently; commands beyond
+// it await retirement (and the subsequent think time).
+//
+TEST(Programmatic, Cfg111_ClosedLoopMLP) {
+  cc::CpuConfig cpu_config;
+  cpu_config.closed_loop = true;
+  cpu_config.think_time = 1000;
+
+  // All commands issue at 200, retire well before think time elapses.
+  cpu_config.mlp_n = 3;
+  EXPECT_LT(run_coincident_loads(cpu_config, 3).time, 200 + 1000);
+
+  // Two think intervals are incurred between three commands.
+  cpu_config.mlp_n = 1;
+  EXPECT_GE(run_coincident_loads(cpu_config, 3).time, 200 + 2 * 1000);
+}
+
+// Load-to-use dependent commands serialize regardless of the MLP
+// window.
+//
+TEST(Programmatic, Cfg111_ClosedLoopDependent) {
+  cc::CpuConfig cpu_config;
+  cpu_config.closed_loop = true;
+  cpu_config.mlp_n = 3;
+  cpu_config.think_time = 1000;
+
+  EXPECT_GE(run_coincident_loads(cpu_config, 3, true).time, 200 + 2 * 1000);
+}
 
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
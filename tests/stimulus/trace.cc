@@ -112,6 +112,97 @@ TEST(Trace, Cfg121_SimpleRead) {
   EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
 }
 
+TEST(Trace, Cfg111_ClosedLoopDependent) {
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(1);
+  cb.set_cpu_n(1);
+
+  cc::CpuConfig cpu_config;
+  cpu_config.closed_loop = true;
+  cb.set_cpu_config(cpu_config);
+
+  // Define stimulus:
+  const char* trace =
+      // Map CPU ID to location in object hierarchy.
+      "M:0,top.cluster0.cpu0\n"
+      // Advance 200 time-units
+      "+200\n"
+      // CPU 0 issues Load instruction to address 0x0.
+      "C:0,LD,0\n"
+      // CPU 0 issues Load to address 0x40 dependent upon prior Load.
+      "C:0,LD,0x40,DEP\n"
+      ;
+
+  cc::StimulusConfig stimulus_config = cc::TraceStimulus::from_string(trace);
+  cb.set_stimulus(stimulus_config);
+
+  const cc::SocConfig cfg = cb.construct();
+
+  cc::kernel::Kernel k;
+  cc::SocTop top(&k, cfg);
+
+  // Run to exhaustion
+  cc::kernel::SimSequencer{&k}.run();
+
+  // Validation.
+
+  cc::Stimulus* stimulus = top.stimulus();
+
+  // Validate expected transaction count.
+  EXPECT_EQ(stimulus->issue_n(), 2);
+
+  // Validate that all transactions have retired at end-of-sim.
+  EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
+}
+
+TEST(Trace, Cfg121_Streaming) {
+  test::ConfigBuilder cb;
+  cb.set_dir_n(1);
+  cb.set_cc_n(2);
+  cb.set_cpu_n(1);
+
+  // Define stimulus:
+  const char* trace =
+      // Map CPU ID to location in object hierarchy.
+      "M:0,top.cluster0.cpu0\n"
+      "M:1,top.cluster1.cpu0\n"
+      "+200\n"
+      "C:0,LD,0\n"
+      "+200\n"
+      "C:1,LD,0\n"
+      "+200\n"
+      "C:0,LD,64\n"
+      "+200\n"
+      "C:1,LD,64\n"
+      "+200\n"
+      "C:0,LD,128\n"
+      ;
+
+  cc::StimulusConfig stimulus_config = cc::TraceStimulus::from_string(trace);
+  // Minimal look-ahead window; trace is refilled upon each issue.
+  stimulus_config.streaming = true;
+  stimulus_config.lookahead_n = 1;
+  cb.set_stimulus(stimulus_config);
+
+  const cc::SocConfig cfg = cb.construct();
+
+  cc::kernel::Kernel k;
+  cc::SocTop top(&k, cfg);
+
+  // Run to exhaustion
+  cc::kernel::SimSequencer{&k}.run();
+
+  // Validation.
+
+  cc::Stimulus* stimulus = top.stimulus();
+
+  // Validate expected transaction count.
+  EXPECT_EQ(stimulus->issue_n(), 5);
+
+  // Validate that all transactions have retired at end-of-sim.
+  EXPECT_EQ(stimulus->issue_n(), stimulus->retire_n());
+}
 
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
@@ -55,7 +55,7 @@ cc::SocConfig ConfigBuilder::construct() const {
       l1c_config.pbuilder = pb;
       cpuc_cfg.l1c_configs.push_back(l1c_config);
 
-      cc::CpuConfig cpu_config;
+      cc::CpuConfig cpu_config = cpu_config_;
       cpu_config.name += std::to_string(cpu);
       cpuc_cfg.cpu_configs.push_back(cpu_config);
     }
@@ -63,18 +63,26 @@ cc::SocConfig ConfigBuilder::construct() const {
     cfg.ccls.push_back(cpuc_cfg);
   }
 
-  // Defined Memory controller
-  cc::MemModelConfig mcfg;
-  cfg.mcfgs.push_back(mcfg);
+  // Defined Memory controller(s); names are unique where more than
+  // one controller is present.
+  for (std::size_t m = 0; m < mem_n_; m++) {
+    cc::MemModelConfig mcfg;
+    if (mem_n_ > 1) mcfg.name += std::to_string(m);
+    cfg.mcfgs.push_back(mcfg);
+  }
+  cfg.mem_interleave = mem_interleave_;
 
   // Define Directory model
   for (std::size_t d = 0; d < dir_n_; d++) {
     cc::DirAgentConfig dcfg;
     dcfg.name += std::to_string(d);
     dcfg.pbuilder = pb;
+    // LLC names are unique where more than one directory is present.
+    if (dir_n_ > 1) dcfg.llcconfig.name += std::to_string(d);
 
     cfg.dcfgs.push_back(dcfg);
   }
+  cfg.dir_interleave = dir_interleave_;
 
   // Define NOC configuration.
   cfg.noccfg = construct_noc(cfg);
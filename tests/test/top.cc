@@ -52,6 +52,11 @@ void TbTop::finalize() {
   soc_->finalize();
 }
 
+// Return to post-elaboration state.
+void TbTop::reset() {
+  soc_->reset();
+}
+
 // Invoke: initialization, Run and Finalization
 void TbTop::run_all(cc::kernel::RunMode r, cc::kernel::Time time) {
   initialize();